@@ -2,8 +2,10 @@
 #ifndef included_PackData
 #define included_PackData
 
+#include <cstddef>
 #include <map>
 #include <set>
+#include <string>
 #include <vector>
 
 
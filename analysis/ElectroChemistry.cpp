@@ -93,9 +93,17 @@ void ElectroChemistryAnalyzer::Basic(ScaLBL_IonModel &Ion, ScaLBL_Poisson &Poiss
 				}
 			}
 		}
-		rho_avg_global[ion]=Dm->Comm.sumReduce(  rho_avg_local[ion]) / Volume;
-		rho_mu_avg_global[ion]=Dm->Comm.sumReduce(  rho_mu_avg_local[ion]) / Volume;
-		rho_psi_avg_global[ion]=Dm->Comm.sumReduce(  rho_psi_avg_local[ion]) / Volume;
+	}
+	/* one reduction for all species */
+	Utilities::MPI::Accumulator sums( Dm->Comm );
+	sums.sum( rho_avg_global, rho_avg_local, Ion.number_ion_species );
+	sums.sum( rho_mu_avg_global, rho_mu_avg_local, Ion.number_ion_species );
+	sums.sum( rho_psi_avg_global, rho_psi_avg_local, Ion.number_ion_species );
+	sums.reduce();
+	for (size_t ion=0; ion<Ion.number_ion_species; ion++){
+		rho_avg_global[ion] /= Volume;
+		rho_mu_avg_global[ion] /= Volume;
+		rho_psi_avg_global[ion] /= Volume;
 
 		if (rho_avg_global[ion] > 0.0){
 		  rho_mu_avg_global[ion] /= rho_avg_global[ion];
@@ -115,9 +123,10 @@ void ElectroChemistryAnalyzer::Basic(ScaLBL_IonModel &Ion, ScaLBL_Poisson &Poiss
 				}
 			}
 		}
-		rho_mu_fluctuation_global[ion]=Dm->Comm.sumReduce(  rho_mu_fluctuation_local[ion]);
-		rho_psi_fluctuation_global[ion]=Dm->Comm.sumReduce(  rho_psi_fluctuation_local[ion]);
 	}
+	sums.sum( rho_mu_fluctuation_global, rho_mu_fluctuation_local, Ion.number_ion_species );
+	sums.sum( rho_psi_fluctuation_global, rho_psi_fluctuation_local, Ion.number_ion_species );
+	sums.reduce();
 	
 	if (Dm->rank()==0){	
 		fprintf(TIMELOG,"%i ",timestep); 
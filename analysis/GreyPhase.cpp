@@ -112,27 +112,31 @@ void GreyPhaseAnalysis::Basic(){
 			}
 		}
 	}
-	Oil.M=Dm->Comm.sumReduce(  Oil_local.M);
-	Oil.Px=Dm->Comm.sumReduce(  Oil_local.Px);
-	Oil.Py=Dm->Comm.sumReduce(  Oil_local.Py);
-	Oil.Pz=Dm->Comm.sumReduce(  Oil_local.Pz);
+	Utilities::MPI::Accumulator sums( Dm->Comm );
+	sums.sum( Oil.M, Oil_local.M );
+	sums.sum( Oil.Px, Oil_local.Px );
+	sums.sum( Oil.Py, Oil_local.Py );
+	sums.sum( Oil.Pz, Oil_local.Pz );
 				
-	Water.M=Dm->Comm.sumReduce(  Water_local.M);
-	Water.Px=Dm->Comm.sumReduce(  Water_local.Px);
-	Water.Py=Dm->Comm.sumReduce(  Water_local.Py);
-	Water.Pz=Dm->Comm.sumReduce(  Water_local.Pz);
+	sums.sum( Water.M, Water_local.M );
+	sums.sum( Water.Px, Water_local.Px );
+	sums.sum( Water.Py, Water_local.Py );
+	sums.sum( Water.Pz, Water_local.Pz );
 
 
 	//Oil.p /= Oil.M;	
 	//Water.p /= Water.M;
-	count_w=Dm->Comm.sumReduce(  count_w);
-	count_n=Dm->Comm.sumReduce(  count_n);
+	sums.sum( count_w, count_w );
+	sums.sum( count_n, count_n );
+	sums.sum( Water.p, Water_local.p );
+	sums.sum( Oil.p, Oil_local.p );
+	sums.reduce();
 	if (count_w > 0.0)
-		Water.p=Dm->Comm.sumReduce(  Water_local.p) / count_w;
+		Water.p /= count_w;
 	else 
 		Water.p = 0.0;
 	if (count_n > 0.0)
-		Oil.p=Dm->Comm.sumReduce(  Oil_local.p) / count_n;
+		Oil.p /= count_n;
 	else 
 		Oil.p = 0.0;
 
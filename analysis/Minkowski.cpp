@@ -139,13 +139,13 @@ void Minkowski::ComputeScalar(const DoubleArray& Field, const double isovalue)
 	// convert X for 2D manifold to 3D object
 	Xi *= 0.5;
 	
-	Dm->Comm.barrier();
 	// Phase averages
-	Vi_global = Dm->Comm.sumReduce( Vi );
-	Xi_global = Dm->Comm.sumReduce( Xi );
-	Ai_global = Dm->Comm.sumReduce( Ai );
-	Ji_global = Dm->Comm.sumReduce( Ji );
-	Dm->Comm.barrier();
+	Utilities::MPI::Accumulator sums( Dm->Comm );
+	sums.sum( Vi_global, Vi );
+	sums.sum( Xi_global, Xi );
+	sums.sum( Ai_global, Ai );
+	sums.sum( Ji_global, Ji );
+	sums.reduce();
     PROFILE_STOP("ComputeScalar");
 }
 
@@ -291,38 +291,42 @@ void SubPhase::Basic(){
 		}
 	}
 	//printf("wetting interaction = %f, count = %f\n",total_wetting_interaction,count_wetting_interaction);
-	total_wetting_interaction_global=Dm->Comm.sumReduce(  total_wetting_interaction);
-	count_wetting_interaction_global=Dm->Comm.sumReduce(  count_wetting_interaction);
+	Utilities::MPI::Accumulator sums( Dm->Comm );
+	sums.sum( total_wetting_interaction_global, total_wetting_interaction );
+	sums.sum( count_wetting_interaction_global, count_wetting_interaction );
 	
-	gwb.V=Dm->Comm.sumReduce(  wb.V);
-	gnb.V=Dm->Comm.sumReduce(  nb.V);
-	gwb.M=Dm->Comm.sumReduce(  wb.M);
-	gnb.M=Dm->Comm.sumReduce(  nb.M);
-	gwb.Px=Dm->Comm.sumReduce(  wb.Px);
-	gwb.Py=Dm->Comm.sumReduce(  wb.Py);
-	gwb.Pz=Dm->Comm.sumReduce(  wb.Pz);
-	gnb.Px=Dm->Comm.sumReduce(  nb.Px);
-	gnb.Py=Dm->Comm.sumReduce(  nb.Py);
-	gnb.Pz=Dm->Comm.sumReduce(  nb.Pz);
+	sums.sum( gwb.V, wb.V );
+	sums.sum( gnb.V, nb.V );
+	sums.sum( gwb.M, wb.M );
+	sums.sum( gnb.M, nb.M );
+	sums.sum( gwb.Px, wb.Px );
+	sums.sum( gwb.Py, wb.Py );
+	sums.sum( gwb.Pz, wb.Pz );
+	sums.sum( gnb.Px, nb.Px );
+	sums.sum( gnb.Py, nb.Py );
+	sums.sum( gnb.Pz, nb.Pz );
 	
-	giwn.Mw=Dm->Comm.sumReduce(  iwn.Mw);
-	giwn.Pwx=Dm->Comm.sumReduce(  iwn.Pwx);
-	giwn.Pwy=Dm->Comm.sumReduce(  iwn.Pwy);
-	giwn.Pwz=Dm->Comm.sumReduce(  iwn.Pwz);
+	sums.sum( giwn.Mw, iwn.Mw );
+	sums.sum( giwn.Pwx, iwn.Pwx );
+	sums.sum( giwn.Pwy, iwn.Pwy );
+	sums.sum( giwn.Pwz, iwn.Pwz );
 	
-	giwn.Mn=Dm->Comm.sumReduce(  iwn.Mn);
-	giwn.Pnx=Dm->Comm.sumReduce(  iwn.Pnx);
-	giwn.Pny=Dm->Comm.sumReduce(  iwn.Pny);
-	giwn.Pnz=Dm->Comm.sumReduce(  iwn.Pnz);
+	sums.sum( giwn.Mn, iwn.Mn );
+	sums.sum( giwn.Pnx, iwn.Pnx );
+	sums.sum( giwn.Pny, iwn.Pny );
+	sums.sum( giwn.Pnz, iwn.Pnz );
 	
-	count_w=Dm->Comm.sumReduce(  count_w);
-	count_n=Dm->Comm.sumReduce(  count_n);
+	sums.sum( count_w, count_w );
+	sums.sum( count_n, count_n );
+	sums.sum( gwb.p, wb.p );
+	sums.sum( gnb.p, nb.p );
+	sums.reduce();
 	if (count_w > 0.0)
-		gwb.p=Dm->Comm.sumReduce(  wb.p) / count_w;
+		gwb.p /= count_w;
 	else 
 		gwb.p = 0.0;
 	if (count_n > 0.0)
-		gnb.p=Dm->Comm.sumReduce(  nb.p) / count_n;
+		gnb.p /= count_n;
 	else 
 		gnb.p = 0.0;
 
@@ -500,12 +504,7 @@ void SubPhase::Full(){
 			}
 		}
 	}
- 	Dm->CommunicateMeshHalo(DelPhi);
- 	
- 	
- 	Dm->CommunicateMeshHalo(Vel_x);
- 	Dm->CommunicateMeshHalo(Vel_y);
- 	Dm->CommunicateMeshHalo(Vel_z);
+ 	Dm->CommunicateMeshHalo(DelPhi,Vel_x,Vel_y,Vel_z);
 	for (int k=1; k<Nz-1; k++){
 		for (int j=1; j<Ny-1; j++){
 			for (int i=1; i<Nx-1; i++){
@@ -571,14 +570,15 @@ void SubPhase::Full(){
 	nd.X -= nc.X;
 
 	// compute global entities
-	gnc.V=Dm->Comm.sumReduce(  nc.V);
-	gnc.A=Dm->Comm.sumReduce(  nc.A);
-	gnc.H=Dm->Comm.sumReduce(  nc.H);
-	gnc.X=Dm->Comm.sumReduce(  nc.X);
-	gnd.V=Dm->Comm.sumReduce(  nd.V);
-	gnd.A=Dm->Comm.sumReduce(  nd.A);
-	gnd.H=Dm->Comm.sumReduce(  nd.H);
-	gnd.X=Dm->Comm.sumReduce(  nd.X);
+	Utilities::MPI::Accumulator geometry( Dm->Comm );
+	geometry.sum( gnc.V, nc.V );
+	geometry.sum( gnc.A, nc.A );
+	geometry.sum( gnc.H, nc.H );
+	geometry.sum( gnc.X, nc.X );
+	geometry.sum( gnd.V, nd.V );
+	geometry.sum( gnd.A, nd.A );
+	geometry.sum( gnd.H, nd.H );
+	geometry.sum( gnd.X, nd.X );
 	gnd.Nc = nd.Nc;
  	// wetting
 	for (k=0; k<Nz; k++){
@@ -618,14 +618,14 @@ void SubPhase::Full(){
 	wd.H -= wc.H;
 	wd.X -= wc.X;
 	// compute global entities
-	gwc.V=Dm->Comm.sumReduce(  wc.V);
-	gwc.A=Dm->Comm.sumReduce(  wc.A);
-	gwc.H=Dm->Comm.sumReduce(  wc.H);
-	gwc.X=Dm->Comm.sumReduce(  wc.X);
-	gwd.V=Dm->Comm.sumReduce(  wd.V);
-	gwd.A=Dm->Comm.sumReduce(  wd.A);
-	gwd.H=Dm->Comm.sumReduce(  wd.H);
-	gwd.X=Dm->Comm.sumReduce(  wd.X);
+	geometry.sum( gwc.V, wc.V );
+	geometry.sum( gwc.A, wc.A );
+	geometry.sum( gwc.H, wc.H );
+	geometry.sum( gwc.X, wc.X );
+	geometry.sum( gwd.V, wd.V );
+	geometry.sum( gwd.A, wd.A );
+	geometry.sum( gwd.H, wd.H );
+	geometry.sum( gwd.X, wd.X );
 	gwd.Nc = wd.Nc;
 	
  	/*  Set up geometric analysis of interface region */
@@ -653,21 +653,23 @@ void SubPhase::Full(){
 	iwn.A = morph_i->A(); 
 	iwn.H = morph_i->H(); 
 	iwn.X = morph_i->X(); 
-	giwn.V=Dm->Comm.sumReduce(  iwn.V);
-	giwn.A=Dm->Comm.sumReduce(  iwn.A);
-	giwn.H=Dm->Comm.sumReduce(  iwn.H);
-	giwn.X=Dm->Comm.sumReduce(  iwn.X);
+	geometry.sum( giwn.V, iwn.V );
+	geometry.sum( giwn.A, iwn.A );
+	geometry.sum( giwn.H, iwn.H );
+	geometry.sum( giwn.X, iwn.X );
 	// measure only the connected part
 	iwnc.Nc = morph_i->MeasureConnectedPathway();
 	iwnc.V = morph_i->V(); 
 	iwnc.A = morph_i->A(); 
 	iwnc.H = morph_i->H(); 
 	iwnc.X = morph_i->X(); 
-	giwnc.V=Dm->Comm.sumReduce(  iwnc.V);
-	giwnc.A=Dm->Comm.sumReduce(  iwnc.A);
-	giwnc.H=Dm->Comm.sumReduce(  iwnc.H);
-	giwnc.X=Dm->Comm.sumReduce(  iwnc.X);
+	geometry.sum( giwnc.V, iwnc.V );
+	geometry.sum( giwnc.A, iwnc.A );
+	geometry.sum( giwnc.H, iwnc.H );
+	geometry.sum( giwnc.X, iwnc.X );
 	giwnc.Nc = iwnc.Nc;
+	// the geometric sums complete while the transport measures are computed
+	geometry.start();
 
 	double vol_nc_bulk = 0.0;
 	double vol_wc_bulk = 0.0;
@@ -781,59 +783,60 @@ void SubPhase::Full(){
 		}
 	}
 
-	gnd.M=Dm->Comm.sumReduce(  nd.M);
-	gnd.Px=Dm->Comm.sumReduce(  nd.Px);
-	gnd.Py=Dm->Comm.sumReduce(  nd.Py);
-	gnd.Pz=Dm->Comm.sumReduce(  nd.Pz);
-	gnd.K=Dm->Comm.sumReduce(  nd.K);
-	gnd.visc=Dm->Comm.sumReduce(  nd.visc);
-
-	gwd.M=Dm->Comm.sumReduce(  wd.M);
-	gwd.Px=Dm->Comm.sumReduce(  wd.Px);
-	gwd.Py=Dm->Comm.sumReduce(  wd.Py);
-	gwd.Pz=Dm->Comm.sumReduce(  wd.Pz);
-	gwd.K=Dm->Comm.sumReduce(  wd.K);
-	gwd.visc=Dm->Comm.sumReduce(  wd.visc);
+	Utilities::MPI::Accumulator sums( Dm->Comm );
+	sums.sum( gnd.M, nd.M );
+	sums.sum( gnd.Px, nd.Px );
+	sums.sum( gnd.Py, nd.Py );
+	sums.sum( gnd.Pz, nd.Pz );
+	sums.sum( gnd.K, nd.K );
+	sums.sum( gnd.visc, nd.visc );
+
+	sums.sum( gwd.M, wd.M );
+	sums.sum( gwd.Px, wd.Px );
+	sums.sum( gwd.Py, wd.Py );
+	sums.sum( gwd.Pz, wd.Pz );
+	sums.sum( gwd.K, wd.K );
+	sums.sum( gwd.visc, wd.visc );
 	
-	gnc.M=Dm->Comm.sumReduce(  nc.M);
-	gnc.Px=Dm->Comm.sumReduce(  nc.Px);
-	gnc.Py=Dm->Comm.sumReduce(  nc.Py);
-	gnc.Pz=Dm->Comm.sumReduce(  nc.Pz);
-	gnc.K=Dm->Comm.sumReduce(  nc.K);
-	gnc.visc=Dm->Comm.sumReduce(  nc.visc);
-
-	gwc.M=Dm->Comm.sumReduce(  wc.M);
-	gwc.Px=Dm->Comm.sumReduce(  wc.Px);
-	gwc.Py=Dm->Comm.sumReduce(  wc.Py);
-	gwc.Pz=Dm->Comm.sumReduce(  wc.Pz);
-	gwc.K=Dm->Comm.sumReduce(  wc.K);
-	gwc.visc=Dm->Comm.sumReduce(  wc.visc);
-
-	giwn.Mn=Dm->Comm.sumReduce(  iwn.Mn);
-	giwn.Pnx=Dm->Comm.sumReduce(  iwn.Pnx);
-	giwn.Pny=Dm->Comm.sumReduce(  iwn.Pny);
-	giwn.Pnz=Dm->Comm.sumReduce(  iwn.Pnz);
-	giwn.Kn=Dm->Comm.sumReduce(  iwn.Kn);
-	giwn.Mw=Dm->Comm.sumReduce(  iwn.Mw);
-	giwn.Pwx=Dm->Comm.sumReduce(  iwn.Pwx);
-	giwn.Pwy=Dm->Comm.sumReduce(  iwn.Pwy);
-	giwn.Pwz=Dm->Comm.sumReduce(  iwn.Pwz);
-	giwn.Kw=Dm->Comm.sumReduce(  iwn.Kw);
+	sums.sum( gnc.M, nc.M );
+	sums.sum( gnc.Px, nc.Px );
+	sums.sum( gnc.Py, nc.Py );
+	sums.sum( gnc.Pz, nc.Pz );
+	sums.sum( gnc.K, nc.K );
+	sums.sum( gnc.visc, nc.visc );
+
+	sums.sum( gwc.M, wc.M );
+	sums.sum( gwc.Px, wc.Px );
+	sums.sum( gwc.Py, wc.Py );
+	sums.sum( gwc.Pz, wc.Pz );
+	sums.sum( gwc.K, wc.K );
+	sums.sum( gwc.visc, wc.visc );
+
+	sums.sum( giwn.Mn, iwn.Mn );
+	sums.sum( giwn.Pnx, iwn.Pnx );
+	sums.sum( giwn.Pny, iwn.Pny );
+	sums.sum( giwn.Pnz, iwn.Pnz );
+	sums.sum( giwn.Kn, iwn.Kn );
+	sums.sum( giwn.Mw, iwn.Mw );
+	sums.sum( giwn.Pwx, iwn.Pwx );
+	sums.sum( giwn.Pwy, iwn.Pwy );
+	sums.sum( giwn.Pwz, iwn.Pwz );
+	sums.sum( giwn.Kw, iwn.Kw );
 	
-	gifs.Mn= Dm->Comm.sumReduce(  ifs.Mn);
-	gifs.Pnx=Dm->Comm.sumReduce(  ifs.Pnx);
-	gifs.Pny=Dm->Comm.sumReduce(  ifs.Pny);
-	gifs.Pnz=Dm->Comm.sumReduce(  ifs.Pnz);
-	gifs.Mw= Dm->Comm.sumReduce(  ifs.Mw);
-	gifs.Pwx=Dm->Comm.sumReduce(  ifs.Pwx);
-	gifs.Pwy=Dm->Comm.sumReduce(  ifs.Pwy);
-	gifs.Pwz=Dm->Comm.sumReduce(  ifs.Pwz);	
+	sums.sum( gifs.Mn, ifs.Mn );
+	sums.sum( gifs.Pnx, ifs.Pnx );
+	sums.sum( gifs.Pny, ifs.Pny );
+	sums.sum( gifs.Pnz, ifs.Pnz );
+	sums.sum( gifs.Mw, ifs.Mw );
+	sums.sum( gifs.Pwx, ifs.Pwx );
+	sums.sum( gifs.Pwy, ifs.Pwy );
+	sums.sum( gifs.Pwz, ifs.Pwz );	
 	
 	// pressure averaging
-	gnc.p=Dm->Comm.sumReduce(  nc.p);
-	gnd.p=Dm->Comm.sumReduce(  nd.p);
-	gwc.p=Dm->Comm.sumReduce(  wc.p);
-	gwd.p=Dm->Comm.sumReduce(  wd.p);
+	sums.sum( gnc.p, nc.p );
+	sums.sum( gnd.p, nd.p );
+	sums.sum( gwc.p, wc.p );
+	sums.sum( gwd.p, wd.p );
 
 	if (vol_wc_bulk > 0.0)
 		wc.p = wc.p /vol_wc_bulk;
@@ -844,11 +847,13 @@ void SubPhase::Full(){
 	if (vol_nd_bulk > 0.0)
 		nd.p = nd.p /vol_nd_bulk;
 
-	vol_wc_bulk=Dm->Comm.sumReduce(  vol_wc_bulk);
-	vol_wd_bulk=Dm->Comm.sumReduce(  vol_wd_bulk);
-	vol_nc_bulk=Dm->Comm.sumReduce(  vol_nc_bulk);
-	vol_nd_bulk=Dm->Comm.sumReduce(  vol_nd_bulk);
-	
+	sums.sum( vol_wc_bulk, vol_wc_bulk );
+	sums.sum( vol_wd_bulk, vol_wd_bulk );
+	sums.sum( vol_nc_bulk, vol_nc_bulk );
+	sums.sum( vol_nd_bulk, vol_nd_bulk );
+	sums.reduce();
+	geometry.finish();
+
 	if (vol_wc_bulk > 0.0)
 		gwc.p = gwc.p /vol_wc_bulk;
 	if (vol_nc_bulk > 0.0)
@@ -86,6 +86,50 @@
 
 #define PI 3.14159265359
 
+TwoPhaseBlock::TwoPhaseBlock():
+	n_nw_pts(0), n_ns_pts(0), n_ws_pts(0), n_nws_pts(0), n_local_sol_pts(0), n_local_nws_pts(0),
+	n_nw_tris(0), n_ns_tris(0), n_ws_tris(0), n_nws_seg(0), n_local_sol_tris(0)
+{
+	// Same scratch sizes as the TwoPhase members
+	CubeValues.resize(2,2,2);
+	nw_tris.resize(3,20);
+	ns_tris.resize(3,20);
+	ws_tris.resize(3,20);
+	nws_seg.resize(2,20);
+	local_sol_tris.resize(3,18);
+	nw_pts=DTMutableList<Point>(20);
+	ns_pts=DTMutableList<Point>(20);
+	ws_pts=DTMutableList<Point>(20);
+	nws_pts=DTMutableList<Point>(20);
+	local_nws_pts=DTMutableList<Point>(20);
+	local_sol_pts=DTMutableList<Point>(20);
+	Values.resize(20);
+	DistanceValues.resize(20);
+	KGwns_values.resize(20);
+	KNwns_values.resize(20);
+	InterfaceSpeed.resize(20);
+	NormalVector.resize(60);
+	van.resize(3);
+	vaw.resize(3);
+	vawn.resize(3);
+	vawns.resize(3);
+	Gwn.resize(6);
+	Gns.resize(6);
+	Gws.resize(6);
+	Reset();
+}
+
+void TwoPhaseBlock::Reset()
+{
+	awn = ans = aws = lwns = As = dummy = 0.0;
+	wp_volume = nwp_volume = vol_w = vol_n = pan = paw = 0.0;
+	Jwn = Kwn = KNwns = KGwns = efawns = trawn = trJwn = trRwn = 0.0;
+	wwndnw = wwnsdnwn = Jwnwwndnw = 0.0;
+	euler = Kn = Jn = An = 0.0;
+	van.fill(0); vaw.fill(0); vawn.fill(0); vawns.fill(0);
+	Gwn.fill(0); Gns.fill(0); Gws.fill(0);
+}
+
 // Constructor
 TwoPhase::TwoPhase(std::shared_ptr <Domain> dm):
 	n_nw_pts(0), n_ns_pts(0), n_ws_pts(0), n_nws_pts(0), n_local_sol_pts(0), n_local_nws_pts(0),
@@ -106,6 +150,10 @@ TwoPhase::TwoPhase(std::shared_ptr <Domain> dm):
 	Volume=(Nx-2)*(Ny-2)*(Nz-2)*Dm->nprocx()*Dm->nprocy()*Dm->nprocz()*1.0;
 
 	TempID = new char[Nx*Ny*Nz];
+
+	// ComputeLocal works on z-slabs of block_size planes
+	block_size = 4;
+	blocks.resize( LocalBlocks() );
 	
 	wet_morph = std::shared_ptr<Minkowski>(new Minkowski(Dm));
 	nonwet_morph = std::shared_ptr<Minkowski>(new Minkowski(Dm));
@@ -387,11 +435,7 @@ void TwoPhase::UpdateSolid()
 	//...........................................................................
 	pmmc_MeshGradient(SDs,SDs_x,SDs_y,SDs_z,Nx,Ny,Nz);
 	//...........................................................................
-	Dm->CommunicateMeshHalo(SDs_x);
-	//...........................................................................
-	Dm->CommunicateMeshHalo(SDs_y);
-	//...........................................................................
-	Dm->CommunicateMeshHalo(SDs_z);
+	Dm->CommunicateMeshHalo(SDs_x,SDs_y,SDs_z);
 	//...........................................................................
 }
 
@@ -407,20 +451,11 @@ void TwoPhase::UpdateMeshValues()
 	//...........................................................................
 	// Gradient of the phase indicator field
 	//...........................................................................
-	Dm->CommunicateMeshHalo(SDn_x);
-	//...........................................................................
-	Dm->CommunicateMeshHalo(SDn_y);
+	Dm->CommunicateMeshHalo(SDn_x,SDn_y,SDn_z,SDs);
 	//...........................................................................
-	Dm->CommunicateMeshHalo(SDn_z);
-	//...........................................................................
-	Dm->CommunicateMeshHalo(SDs);
 	pmmc_MeshGradient(SDs,SDs_x,SDs_y,SDs_z,Nx,Ny,Nz);
 	//...........................................................................
-	Dm->CommunicateMeshHalo(SDs_x);
-	//...........................................................................
-	Dm->CommunicateMeshHalo(SDs_y);
-	//...........................................................................
-	Dm->CommunicateMeshHalo(SDs_z);
+	Dm->CommunicateMeshHalo(SDs_x,SDs_y,SDs_z);
 	//...........................................................................
 	// Compute the mesh curvature of the phase indicator field
 	pmmc_MeshCurvature(SDn, MeanCurvature, GaussCurvature, Nx, Ny, Nz);
@@ -429,19 +464,7 @@ void TwoPhase::UpdateMeshValues()
 	// Map Phase_tplus and Phase_tminus
 	for (int n=0; n<Nx*Ny*Nz; n++)	dPdt(n) = 0.125*(Phase_tplus(n) - Phase_tminus(n));
 	//...........................................................................
-	Dm->CommunicateMeshHalo(Press);
-	//...........................................................................
-	Dm->CommunicateMeshHalo(Vel_x);
-	//...........................................................................
-	Dm->CommunicateMeshHalo(Vel_y);
-	//...........................................................................
-	Dm->CommunicateMeshHalo(Vel_z);
-	//...........................................................................
-	Dm->CommunicateMeshHalo(MeanCurvature);
-	//...........................................................................
-	Dm->CommunicateMeshHalo(GaussCurvature);
-	//...........................................................................
-	Dm->CommunicateMeshHalo(DelPhi);
+	Dm->CommunicateMeshHalo(Press,Vel_x,Vel_y,Vel_z,MeanCurvature,GaussCurvature,DelPhi);
 	//...........................................................................
 	// Initializing the blob ID
 	for (k=0; k<Nz; k++){
@@ -464,11 +487,8 @@ void TwoPhase::UpdateMeshValues()
 		}
 	}
 }
-void TwoPhase::ComputeLocal()
+void TwoPhase::LocalRange(int &imin, int &jmin, int &kmin, int &kmax) const
 {
-	int i,j,k,n,imin,jmin,kmin,kmax;
-	int cube[8][3] = {{0,0,0},{1,0,0},{0,1,0},{1,1,0},{0,0,1},{1,0,1},{0,1,1},{1,1,1}};
-
 	// If external boundary conditions are set, do not average over the inlet
 	kmin=1; kmax=Nz-1;
 	if (Dm->BoundaryCondition > 0 && Dm->kproc() == 0) kmin=4;
@@ -479,8 +499,56 @@ void TwoPhase::ComputeLocal()
 	if (Dm->inlet_layers_x > 0) imin = Dm->inlet_layers_x;
 	if (Dm->inlet_layers_y > 0) jmin = Dm->inlet_layers_y;
 	if (Dm->inlet_layers_z > 0) kmin = Dm->inlet_layers_z;
-		
-	for (k=kmin; k<kmax; k++){
+}
+
+int TwoPhase::LocalBlocks() const
+{
+	int imin,jmin,kmin,kmax;
+	LocalRange(imin,jmin,kmin,kmax);
+	if (kmax <= kmin) return 0;
+	return (kmax-kmin+block_size-1)/block_size;
+}
+
+void TwoPhase::ComputeLocal()
+{
+	int N = LocalBlocks();
+	for (int b=0; b<N; b++) ComputeLocalBlock(b);
+	ReduceLocalBlocks();
+}
+
+void TwoPhase::ComputeLocalBlock(int block)
+{
+	int i,j,k,n,imin,jmin,kmin,kmax;
+	int cube[8][3] = {{0,0,0},{1,0,0},{0,1,0},{1,1,0},{0,0,1},{1,0,1},{0,1,1},{1,1,1}};
+
+	LocalRange(imin,jmin,kmin,kmax);
+	int kfirst = kmin + block*block_size;
+	int klast = min(kmax,kfirst+block_size);
+
+	// Each block only touches its own scratch space and partial sums
+	TwoPhaseBlock &B = blocks[block];
+	B.Reset();
+	int &n_nw_pts=B.n_nw_pts, &n_ns_pts=B.n_ns_pts, &n_ws_pts=B.n_ws_pts, &n_nws_pts=B.n_nws_pts;
+	int &n_local_sol_pts=B.n_local_sol_pts, &n_local_nws_pts=B.n_local_nws_pts;
+	int &n_nw_tris=B.n_nw_tris, &n_ns_tris=B.n_ns_tris, &n_ws_tris=B.n_ws_tris;
+	int &n_nws_seg=B.n_nws_seg, &n_local_sol_tris=B.n_local_sol_tris;
+	DTMutableList<Point> &nw_pts=B.nw_pts, &ns_pts=B.ns_pts, &ws_pts=B.ws_pts, &nws_pts=B.nws_pts;
+	DTMutableList<Point> &local_sol_pts=B.local_sol_pts, &local_nws_pts=B.local_nws_pts;
+	IntArray &nw_tris=B.nw_tris, &ns_tris=B.ns_tris, &ws_tris=B.ws_tris, &nws_seg=B.nws_seg, &local_sol_tris=B.local_sol_tris;
+	DoubleArray &CubeValues=B.CubeValues, &Values=B.Values, &DistanceValues=B.DistanceValues;
+	DoubleArray &KGwns_values=B.KGwns_values, &KNwns_values=B.KNwns_values;
+	DoubleArray &InterfaceSpeed=B.InterfaceSpeed, &NormalVector=B.NormalVector;
+	DoubleArray &van=B.van, &vaw=B.vaw, &vawn=B.vawn, &vawns=B.vawns;
+	DoubleArray &Gwn=B.Gwn, &Gns=B.Gns, &Gws=B.Gws;
+	double &awn=B.awn, &ans=B.ans, &aws=B.aws, &lwns=B.lwns, &As=B.As, &dummy=B.dummy;
+	double &wp_volume=B.wp_volume, &nwp_volume=B.nwp_volume, &vol_w=B.vol_w, &vol_n=B.vol_n;
+	double &pan=B.pan, &paw=B.paw;
+	double &Jwn=B.Jwn, &Kwn=B.Kwn, &KNwns=B.KNwns, &KGwns=B.KGwns, &efawns=B.efawns;
+	double &trawn=B.trawn, &trJwn=B.trJwn, &trRwn=B.trRwn;
+	double &wwndnw=B.wwndnw, &wwnsdnwn=B.wwnsdnwn, &Jwnwwndnw=B.Jwnwwndnw;
+	double &euler=B.euler, &Kn=B.Kn, &Jn=B.Jn, &An=B.An;
+
+	for (k=kfirst; k<klast; k++){
 		for (j=jmin; j<Ny-1; j++){
 			for (i=imin; i<Nx-1; i++){
 				//...........................................................................
@@ -601,6 +669,29 @@ void TwoPhase::ComputeLocal()
 			}
 		}
 	}
+}
+
+void TwoPhase::ReduceLocalBlocks()
+{
+	int i,j,k,n;
+	// Add the partial sums in block order (independent of how the blocks were scheduled)
+	for (size_t b=0; b<blocks.size(); b++){
+		const TwoPhaseBlock &B = blocks[b];
+		awn += B.awn; ans += B.ans; aws += B.aws; lwns += B.lwns; As += B.As;
+		wp_volume += B.wp_volume; nwp_volume += B.nwp_volume;
+		vol_w += B.vol_w; vol_n += B.vol_n; pan += B.pan; paw += B.paw;
+		Jwn += B.Jwn; Kwn += B.Kwn; KNwns += B.KNwns; KGwns += B.KGwns; efawns += B.efawns;
+		trawn += B.trawn; trJwn += B.trJwn; trRwn += B.trRwn;
+		wwndnw += B.wwndnw; wwnsdnwn += B.wwnsdnwn; Jwnwwndnw += B.Jwnwwndnw;
+		euler += B.euler; Kn += B.Kn; Jn += B.Jn; An += B.An;
+		for (int d=0; d<3; d++){
+			van(d) += B.van(d); vaw(d) += B.vaw(d);
+			vawn(d) += B.vawn(d); vawns(d) += B.vawns(d);
+		}
+		for (int d=0; d<6; d++){
+			Gwn(d) += B.Gwn(d); Gns(d) += B.Gns(d); Gws(d) += B.Gws(d);
+		}
+	}
 
 	Array <char> phase_label(Nx,Ny,Nz);
 	Array <double> phase_distance(Nx,Ny,Nz);
@@ -1109,48 +1200,43 @@ void TwoPhase::Reduce()
 	int i;
 	double iVol_global=1.0/Volume;
 	//...........................................................................
-	Dm->Comm.barrier();
-	nwp_volume_global = Dm->Comm.sumReduce( nwp_volume );
-	wp_volume_global = Dm->Comm.sumReduce( wp_volume );
-	awn_global = Dm->Comm.sumReduce( awn );
-	ans_global = Dm->Comm.sumReduce( ans );
-	aws_global = Dm->Comm.sumReduce( aws );
-	lwns_global = Dm->Comm.sumReduce( lwns );
-	As_global = Dm->Comm.sumReduce( As );
-	Jwn_global = Dm->Comm.sumReduce( Jwn );
-	Kwn_global = Dm->Comm.sumReduce( Kwn );
-	KGwns_global = Dm->Comm.sumReduce( KGwns );
-	KNwns_global = Dm->Comm.sumReduce( KNwns );
-	efawns_global = Dm->Comm.sumReduce( efawns );
-	wwndnw_global = Dm->Comm.sumReduce( wwndnw );
-	wwnsdnwn_global = Dm->Comm.sumReduce( wwnsdnwn );
-	Jwnwwndnw_global = Dm->Comm.sumReduce( Jwnwwndnw );
+	// all averages are completed by one allreduce
+	Utilities::MPI::Accumulator sums( Dm->Comm );
+	sums.sum( nwp_volume_global, nwp_volume );
+	sums.sum( wp_volume_global, wp_volume );
+	sums.sum( awn_global, awn );
+	sums.sum( ans_global, ans );
+	sums.sum( aws_global, aws );
+	sums.sum( lwns_global, lwns );
+	sums.sum( As_global, As );
+	sums.sum( Jwn_global, Jwn );
+	sums.sum( Kwn_global, Kwn );
+	sums.sum( KGwns_global, KGwns );
+	sums.sum( KNwns_global, KNwns );
+	sums.sum( efawns_global, efawns );
+	sums.sum( wwndnw_global, wwndnw );
+	sums.sum( wwnsdnwn_global, wwnsdnwn );
+	sums.sum( Jwnwwndnw_global, Jwnwwndnw );
 	// Phase averages
-	vol_w_global = Dm->Comm.sumReduce( vol_w );
-	vol_n_global = Dm->Comm.sumReduce( vol_n );
-	paw_global = Dm->Comm.sumReduce( paw );
-	pan_global = Dm->Comm.sumReduce( pan );
-	for (int idx=0; idx<3; idx++)
-		vaw_global(idx) = Dm->Comm.sumReduce( vaw(idx) );
-	for (int idx=0; idx<3; idx++)
-		van_global(idx) = Dm->Comm.sumReduce( van(idx));
-	for (int idx=0; idx<3; idx++)
-		vawn_global(idx) = Dm->Comm.sumReduce( vawn(idx) );
-	for (int idx=0; idx<3; idx++)
-		vawns_global(idx) = Dm->Comm.sumReduce( vawns(idx) );
-	for (int idx=0; idx<6; idx++){
-		Gwn_global(idx) = Dm->Comm.sumReduce( Gwn(idx) );
-		Gns_global(idx) = Dm->Comm.sumReduce( Gns(idx) );
-		Gws_global(idx) = Dm->Comm.sumReduce( Gws(idx) );
-	}
-	trawn_global = Dm->Comm.sumReduce( trawn );
-	trJwn_global = Dm->Comm.sumReduce( trJwn );
-	trRwn_global = Dm->Comm.sumReduce( trRwn );
-	euler_global = Dm->Comm.sumReduce( euler );
-	An_global = Dm->Comm.sumReduce( An );
-	Jn_global = Dm->Comm.sumReduce( Jn );
-	Kn_global = Dm->Comm.sumReduce( Kn );
-	Dm->Comm.barrier();
+	sums.sum( vol_w_global, vol_w );
+	sums.sum( vol_n_global, vol_n );
+	sums.sum( paw_global, paw );
+	sums.sum( pan_global, pan );
+	sums.sum( vaw_global.data(), vaw.data(), 3 );
+	sums.sum( van_global.data(), van.data(), 3 );
+	sums.sum( vawn_global.data(), vawn.data(), 3 );
+	sums.sum( vawns_global.data(), vawns.data(), 3 );
+	sums.sum( Gwn_global.data(), Gwn.data(), 6 );
+	sums.sum( Gns_global.data(), Gns.data(), 6 );
+	sums.sum( Gws_global.data(), Gws.data(), 6 );
+	sums.sum( trawn_global, trawn );
+	sums.sum( trJwn_global, trJwn );
+	sums.sum( trRwn_global, trRwn );
+	sums.sum( euler_global, euler );
+	sums.sum( An_global, An );
+	sums.sum( Jn_global, Jn );
+	sums.sum( Kn_global, Kn );
+	sums.reduce();
 
 	// Normalize the phase averages
 	// (density of both components = 1.0)
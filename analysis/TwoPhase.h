@@ -34,6 +34,43 @@
 #include "IO/Writer.h"
 
 
+// Scratch storage and partial averages for one block (z-slab) of cubes in TwoPhase::ComputeLocal
+struct TwoPhaseBlock{
+	TwoPhaseBlock();
+	void Reset();
+	//...........................................................................
+	int n_nw_pts,n_ns_pts,n_ws_pts,n_nws_pts,n_local_sol_pts,n_local_nws_pts;
+	int n_nw_tris,n_ns_tris,n_ws_tris,n_nws_seg,n_local_sol_tris;
+	DTMutableList<Point> nw_pts;
+	DTMutableList<Point> ns_pts;
+	DTMutableList<Point> ws_pts;
+	DTMutableList<Point> nws_pts;
+	DTMutableList<Point> local_sol_pts;
+	DTMutableList<Point> local_nws_pts;
+	IntArray nw_tris;
+	IntArray ns_tris;
+	IntArray ws_tris;
+	IntArray nws_seg;
+	IntArray local_sol_tris;
+	DoubleArray CubeValues;
+	DoubleArray Values;
+	DoubleArray DistanceValues;
+	DoubleArray KGwns_values;
+	DoubleArray KNwns_values;
+	DoubleArray InterfaceSpeed;
+	DoubleArray NormalVector;
+	//...........................................................................
+	// partial sums (same meaning as the TwoPhase members)
+	double awn,ans,aws,lwns,As,dummy;
+	double wp_volume,nwp_volume,vol_w,vol_n,pan,paw;
+	double Jwn,Kwn,KNwns,KGwns,efawns,trawn,trJwn,trRwn;
+	double wwndnw,wwnsdnwn,Jwnwwndnw;
+	double euler,Kn,Jn,An;
+	DoubleArray van,vaw,vawn,vawns;
+	DoubleArray Gwn,Gns,Gws;
+};
+
+
 class TwoPhase{
 
 	//...........................................................................
@@ -74,6 +111,11 @@ class TwoPhase{
 
 	char *TempID;
 
+	// blocks of cubes for ComputeLocal (each block is a z-slab)
+	int block_size;
+	std::vector<TwoPhaseBlock> blocks;
+	void LocalRange(int &imin, int &jmin, int &kmin, int &kmax) const;
+
 	// CSV / text file where time history of averages is saved
 	FILE *TIMELOG;
 	FILE *NWPLOG;
@@ -181,6 +223,17 @@ public:
 	void ComputeDelPhi();
 	void ColorToSignedDistance(double Beta, DoubleArray &ColorData, DoubleArray &DistData);
 	void ComputeLocal();
+	/**
+	 * \brief Blockwise evaluation of ComputeLocal
+	 * \details The cubes are split into z-slabs that can be processed concurrently
+	 *    (e.g. as separate ThreadPool work items).  ComputeLocal() is equivalent to
+	 *    calling ComputeLocalBlock(b) for b=0..LocalBlocks()-1 followed by ReduceLocalBlocks().
+	 *    The partial sums are combined in block order so the result does not depend
+	 *    on the number of threads or on the order the blocks finish.
+	 */
+	int LocalBlocks() const;
+	void ComputeLocalBlock(int block);
+	void ReduceLocalBlocks();
 	void AssignComponentLabels();
 	void ComponentAverages();
 	void Reduce();
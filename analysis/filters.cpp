@@ -15,87 +15,106 @@
   along with OPM.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include "analysis/filters.h"
+#include "common/Utilities.h"
 #include "math.h"
 #include "ProfilerApp.h"
 
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+
+void parallelSlabs( int kmin, int kmax, const std::function<void(int,int)>& fun )
+{
+	int N = kmax - kmin;
+	int Nt = std::min( Utilities::getNumThreads(), N );
+	if ( Nt <= 1 ){
+		if ( N > 0 ) fun( kmin, kmax );
+		return;
+	}
+	Utilities::parallelFor( Nt, [&]( int t ){
+		fun( kmin+(t*N)/Nt, kmin+((t+1)*N)/Nt );
+	});
+}
+
 void Mean3D( const Array<double> &Input, Array<double> &Output )
 {
 	PROFILE_START("Mean3D");
 	// Perform a 3D Mean filter on Input array
-	int i,j,k;
-
 	int Nx = int(Input.size(0));
 	int Ny = int(Input.size(1));
 	int Nz = int(Input.size(2));
 
-	for (k=1; k<Nz-1; k++){
-		for (j=1; j<Ny-1; j++){
-			for (i=1; i<Nx-1; i++){
-			  double MeanValue = Input(i,j,k);
-			  // next neighbors
-			  MeanValue += Input(i+1,j,k)+Input(i,j+1,k)+Input(i,j,k+1)+Input(i-1,j,k)+Input(i,j-1,k)+Input(i,j,k-1);
-			  MeanValue += Input(i+1,j+1,k)+Input(i-1,j+1,k)+Input(i+1,j-1,k)+Input(i-1,j-1,k);
-			  MeanValue += Input(i+1,j,k+1)+Input(i-1,j,k+1)+Input(i+1,j,k-1)+Input(i-1,j,k-1);
-			  MeanValue += Input(i,j+1,k+1)+Input(i,j-1,k+1)+Input(i,j+1,k-1)+Input(i,j-1,k-1);
-			  MeanValue += Input(i+1,j+1,k+1)+Input(i-1,j+1,k+1)+Input(i+1,j-1,k+1)+Input(i-1,j-1,k+1);
-			  MeanValue += Input(i+1,j+1,k-1)+Input(i-1,j+1,k-1)+Input(i+1,j-1,k-1)+Input(i-1,j-1,k-1);
-			  Output(i,j,k) = MeanValue/27.0;
+	parallelSlabs( 1, Nz-1, [&]( int k0, int k1 ){
+		for (int k=k0; k<k1; k++){
+			for (int j=1; j<Ny-1; j++){
+				for (int i=1; i<Nx-1; i++){
+				  double MeanValue = Input(i,j,k);
+				  // next neighbors
+				  MeanValue += Input(i+1,j,k)+Input(i,j+1,k)+Input(i,j,k+1)+Input(i-1,j,k)+Input(i,j-1,k)+Input(i,j,k-1);
+				  MeanValue += Input(i+1,j+1,k)+Input(i-1,j+1,k)+Input(i+1,j-1,k)+Input(i-1,j-1,k);
+				  MeanValue += Input(i+1,j,k+1)+Input(i-1,j,k+1)+Input(i+1,j,k-1)+Input(i-1,j,k-1);
+				  MeanValue += Input(i,j+1,k+1)+Input(i,j-1,k+1)+Input(i,j+1,k-1)+Input(i,j-1,k-1);
+				  MeanValue += Input(i+1,j+1,k+1)+Input(i-1,j+1,k+1)+Input(i+1,j-1,k+1)+Input(i-1,j-1,k+1);
+				  MeanValue += Input(i+1,j+1,k-1)+Input(i-1,j+1,k-1)+Input(i+1,j-1,k-1)+Input(i-1,j-1,k-1);
+				  Output(i,j,k) = MeanValue/27.0;
+				}
 			}
 		}
-	}
+	});
 	PROFILE_STOP("Mean3D");
 }
 
+// Median of 27 values by forgetful selection: keep 15 candidates, discard the
+// minimum and maximum, add the next value and repeat until three are left
+static inline float Median27( float *List )
+{
+	int n = 15;
+	for (int next=15; ; next++){
+		for (int m=1; m<n; m++){
+			float a = List[0], b = List[m];
+			List[0] = std::min(a,b);
+			List[m] = std::max(a,b);
+		}
+		for (int m=1; m<n-1; m++){
+			float a = List[m], b = List[n-1];
+			List[m] = std::min(a,b);
+			List[n-1] = std::max(a,b);
+		}
+		if (next == 27) break;
+		List[0] = List[next];
+		n--;
+	}
+	return List[1];
+}
+
 void Med3D( const Array<float> &Input, Array<float> &Output )
 {
 	PROFILE_START("Med3D");
-	// Perform a 3D Median filter on Input array with specified width
-	int i,j,k,ii,jj,kk;
-	int imin,jmin,kmin,imax,jmax,kmax;
-
-	float *List;
-	List=new float[27];
-
+	// Perform a 3D Median filter on Input array with a 3x3x3 window (hit recursively if needed)
 	int Nx = int(Input.size(0));
 	int Ny = int(Input.size(1));
 	int Nz = int(Input.size(2));
 
-	for (k=1; k<Nz-1; k++){
-		for (j=1; j<Ny-1; j++){
-			for (i=1; i<Nx-1; i++){
-
-				// Just use a 3x3x3 window (hit recursively if needed)
-				imin = i-1;
-				jmin = j-1;
-				kmin = k-1;
-				imax = i+2;
-				jmax = j+2;
-				kmax = k+2;
-
-				// Populate the list with values in the window
-				int Number=0;
-				for (kk=kmin; kk<kmax; kk++){
-					for (jj=jmin; jj<jmax; jj++){
-						for (ii=imin; ii<imax; ii++){
-							List[Number++] = Input(ii,jj,kk);
-						}
-					}
-				}
-				// Sort the first 5 entries and return the median
-				for (ii=0; ii<14; ii++){
-					for (jj=ii+1; jj<27; jj++){
-						if (List[jj] < List[ii]){
-							float tmp = List[ii];
-							List[ii] = List[jj];
-							List[jj] = tmp;
+	parallelSlabs( 1, Nz-1, [&]( int k0, int k1 ){
+		float List[27];
+		for (int k=k0; k<k1; k++){
+			for (int j=1; j<Ny-1; j++){
+				for (int i=1; i<Nx-1; i++){
+					// Populate the list with values in the window
+					int Number=0;
+					for (int kk=k-1; kk<k+2; kk++){
+						for (int jj=j-1; jj<j+2; jj++){
+							for (int ii=i-1; ii<i+2; ii++){
+								List[Number++] = Input(ii,jj,kk);
+							}
 						}
 					}
+					Output(i,j,k) = Median27( List );
 				}
-				// Return the median
-				Output(i,j,k) = List[13];
 			}
 		}
-	}
+	});
 	PROFILE_STOP("Med3D");
 }
 
@@ -111,81 +130,103 @@ int NLM3D( const Array<float> &Input, Array<float> &Mean,
 	// 		If Distance(i,j,k) > THRESHOLD_DIST then don't compute NLM
 
 	float THRESHOLD_DIST = float(d);
-	float weight, sum;
-	int i,j,k,ii,jj,kk;
-	int imin,jmin,kmin,imax,jmax,kmax;
-	int returnCount=0;
 
 	int Nx = int(Input.size(0));
 	int Ny = int(Input.size(1));
 	int Nz = int(Input.size(2));
 
-	// Compute the local means
-	for (k=1; k<Nz-1; k++){
-		for (j=1; j<Ny-1; j++){
-			for (i=1; i<Nx-1; i++){
-
-				imin = std::max(0,i-d);
-				jmin = std::max(0,j-d);
-				kmin = std::max(0,k-d);
-				imax = std::min(Nx-1,i+d);
-				jmax = std::min(Ny-1,j+d);
-				kmax = std::min(Nz-1,k+d);
-
-				// Populate the list with values in the window
-				sum = 0; weight=0;
-				for (kk=kmin; kk<kmax; kk++){
-					for (jj=jmin; jj<jmax; jj++){
-						for (ii=imin; ii<imax; ii++){
-							sum += Input(ii,jj,kk);
-							weight++;
-						}
-					}
+	// Compute the local means over the window [i-d,i+d) (clipped to [0,N-1))
+	// The box sums are separable, so use running sums (1D integral images) in each direction
+	Array<double> Sum(Nx,Ny,Nz);
+	auto window = [d]( int i, int N, int &imin, int &imax ) {
+		imin = std::max(0,i-d);
+		imax = std::min(N-1,i+d);
+	};
+	parallelSlabs( 0, Nz, [&]( int k0, int k1 ){
+		std::vector<double> prefix(Nx+1);
+		for (int k=k0; k<k1; k++){
+			for (int j=0; j<Ny; j++){
+				prefix[0] = 0.0;
+				for (int i=0; i<Nx; i++) prefix[i+1] = prefix[i] + Input(i,j,k);
+				for (int i=0; i<Nx; i++){
+					int imin, imax;
+					window( i, Nx, imin, imax );
+					Sum(i,j,k) = prefix[imax] - prefix[imin];
 				}
-
-				Mean(i,j,k) = sum / weight;
 			}
 		}
-	}
+	});
+	parallelSlabs( 0, Nz, [&]( int k0, int k1 ){
+		std::vector<double> prefix((Ny+1)*Nx);
+		for (int k=k0; k<k1; k++){
+			for (int i=0; i<Nx; i++) prefix[i] = 0.0;
+			for (int j=0; j<Ny; j++)
+				for (int i=0; i<Nx; i++) prefix[(j+1)*Nx+i] = prefix[j*Nx+i] + Sum(i,j,k);
+			for (int j=0; j<Ny; j++){
+				int jmin, jmax;
+				window( j, Ny, jmin, jmax );
+				for (int i=0; i<Nx; i++) Sum(i,j,k) = prefix[jmax*Nx+i] - prefix[jmin*Nx+i];
+			}
+		}
+	});
+	parallelSlabs( 1, Ny-1, [&]( int j0, int j1 ){
+		std::vector<double> prefix((Nz+1)*Nx);
+		for (int j=j0; j<j1; j++){
+			for (int i=0; i<Nx; i++) prefix[i] = 0.0;
+			for (int k=0; k<Nz; k++)
+				for (int i=0; i<Nx; i++) prefix[(k+1)*Nx+i] = prefix[k*Nx+i] + Sum(i,j,k);
+			for (int k=1; k<Nz-1; k++){
+				int imin, imax, jmin, jmax, kmin, kmax;
+				window( j, Ny, jmin, jmax );
+				window( k, Nz, kmin, kmax );
+				for (int i=1; i<Nx-1; i++){
+					window( i, Nx, imin, imax );
+					double weight = double((imax-imin)*(jmax-jmin)*(kmax-kmin));
+					Mean(i,j,k) = (prefix[kmax*Nx+i] - prefix[kmin*Nx+i]) / weight;
+				}
+			}
+		}
+	});
 
 	// Compute the non-local means
-	for (k=1; k<Nz-1; k++){
-		for (j=1; j<Ny-1; j++){
-			for (i=1; i<Nx-1; i++){
-
-
-				if (fabs(Distance(i,j,k)) < THRESHOLD_DIST){
-					// compute the expensive non-local means
-					sum = 0; weight=0;
-
-					imin = std::max(0,i-d);
-					jmin = std::max(0,j-d);
-					kmin = std::max(0,k-d);
-					imax = std::min(Nx-1,i+d);
-					jmax = std::min(Ny-1,j+d);
-					kmax = std::min(Nz-1,k+d);
-
-					for (kk=kmin; kk<kmax; kk++){
-						for (jj=jmin; jj<jmax; jj++){
-							for (ii=imin; ii<imax; ii++){
-								float tmp = Mean(i,j,k) - Mean(ii,jj,kk);
-								sum += exp(-tmp*tmp*h)*Input(ii,jj,kk);
-								weight += exp(-tmp*tmp*h);
+	std::atomic<int> returnCount(0);
+	parallelSlabs( 1, Nz-1, [&]( int k0, int k1 ){
+		int count = 0;
+		for (int k=k0; k<k1; k++){
+			for (int j=1; j<Ny-1; j++){
+				for (int i=1; i<Nx-1; i++){
+					if (fabs(Distance(i,j,k)) < THRESHOLD_DIST){
+						// compute the expensive non-local means
+						int imin, imax, jmin, jmax, kmin, kmax;
+						window( i, Nx, imin, imax );
+						window( j, Ny, jmin, jmax );
+						window( k, Nz, kmin, kmax );
+						float center = Mean(i,j,k);
+						float sum = 0, weight = 0;
+						for (int kk=kmin; kk<kmax; kk++){
+							for (int jj=jmin; jj<jmax; jj++){
+								const float *mean = &Mean(0,jj,kk);
+								const float *input = &Input(0,jj,kk);
+								for (int ii=imin; ii<imax; ii++){
+									float tmp = center - mean[ii];
+									float w = expf(-tmp*tmp*h);
+									sum += w*input[ii];
+									weight += w;
+								}
 							}
 						}
+						count++;
+						Output(i,j,k) = sum / weight;
+					}
+					else{
+						// Just return the mean
+						Output(i,j,k) = Mean(i,j,k);
 					}
-
-					returnCount++;
-					//Output(i,j,k) = Mean(i,j,k);
-					Output(i,j,k) = sum / weight;
-				}
-				else{
-					// Just return the mean
-					Output(i,j,k) = Mean(i,j,k);
 				}
 			}
 		}
-	}
+		returnCount += count;
+	});
 	// Return the number of sites where NLM was applied
 	PROFILE_STOP("NLM3D");
 	return returnCount;
@@ -20,6 +20,20 @@
 
 #include "common/Array.h"
 
+#include <functional>
+
+
+/*!
+ * @brief  Loop over slabs in parallel
+ * @details  This routine splits [kmin,kmax) into one contiguous slab per thread
+ *    (Utilities::getNumThreads) and calls fun(k0,k1) for each slab with Utilities::parallelFor
+ * @param[in] kmin      First index
+ * @param[in] kmax      Last index (exclusive)
+ * @param[in] fun       Function to call for each slab
+ */
+void parallelSlabs( int kmin, int kmax, const std::function<void(int,int)>& fun );
+
+
 /*!
  * @brief  Filter image
  * @details  This routine performs a mean filter
@@ -30,7 +44,7 @@ void Mean3D( const Array<double> &Input, Array<double> &Output );
 
 /*!
  * @brief  Filter image
- * @details  This routine performs a median filter
+ * @details  This routine performs a 3x3x3 median filter (forgetful selection)
  * @param[in] Input     Input image
  * @param[out] Output   Output image
  */
@@ -38,7 +52,9 @@ void Med3D( const Array<float> &Input, Array<float> &Output );
 
 /*!
  * @brief  Filter image
- * @details  This routine performs a non-linear local means filter
+ * @details  This routine performs a non-linear local means filter.
+ *    The local means are computed from a summed volume table, and the weighted
+ *    average is only computed where |Distance| < d
  * @param[in] Input     Input image
  * @param[in] Mean      Mean value
  * @param[out] Output   Output image
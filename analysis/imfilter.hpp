@@ -31,6 +31,7 @@
   along with OPM.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include "analysis/imfilter.h"
+#include "analysis/filters.h"
 #include "ProfilerApp.h"
 #include <math.h>
 #include <string.h>
@@ -91,10 +92,13 @@ static void filter_direction( int Ns, int N, int Ne, int Nh, const TYPE *H,
             A[i] *= H[0];
         return;
     }
-    TYPE *tmp = new TYPE[N+2*Nh];
-    for (int j=0; j<Ne; j++) {
-        for (int i=0; i<Ns; i++) {
-            copy_array( N, Ns, Nh, &A[i+j*Ns*N], boundary, X, tmp );
+    // the Ns*Ne lines are independent and are split over the filter threads
+    parallelSlabs( 0, Ns*Ne, [=]( int line0, int line1 ) {
+        std::vector<TYPE> tmp(N+2*Nh);
+        for (int line=line0; line<line1; line++) {
+            int i = line % Ns;
+            int j = line / Ns;
+            copy_array( N, Ns, Nh, &A[i+j*Ns*N], boundary, X, tmp.data() );
             for (int k=0; k<N; k++) {
                 TYPE tmp2 = 0;
                 for (int m=0; m<=2*Nh; m++)
@@ -102,8 +106,7 @@ static void filter_direction( int Ns, int N, int Ne, int Nh, const TYPE *H,
                 A[i+k*Ns+j*Ns*N] = tmp2;
             }
         }
-    }
-    delete[] tmp;
+    } );
 }
 template<class TYPE>
 static void filter_direction( int Ns, int N, int Ne, int Nh,
@@ -111,19 +114,20 @@ static void filter_direction( int Ns, int N, int Ne, int Nh,
 {
     if ( Nh < 0 )
         IMFILTER_ERROR("Invalid filter size");
-    TYPE *tmp = new TYPE[N+2*Nh];
-    Array<TYPE> tmp2(2*Nh+1);
-    for (int j=0; j<Ne; j++) {
-        for (int i=0; i<Ns; i++) {
-            copy_array( N, Ns, Nh, &A[i+j*Ns*N], boundary, X, tmp );
+    parallelSlabs( 0, Ns*Ne, [=]( int line0, int line1 ) {
+        std::vector<TYPE> tmp(N+2*Nh);
+        Array<TYPE> tmp2(2*Nh+1);
+        for (int line=line0; line<line1; line++) {
+            int i = line % Ns;
+            int j = line / Ns;
+            copy_array( N, Ns, Nh, &A[i+j*Ns*N], boundary, X, tmp.data() );
             for (int k=0; k<N; k++) {
                 for (int m=0; m<=2*Nh; m++)
                     tmp2(m) = tmp[k+m];
                 A[i+k*Ns+j*Ns*N] = H(tmp2);
             }
         }
-    }
-    delete[] tmp;
+    } );
 }
 template<class TYPE>
 static void filter_direction( int Ns, int N, int Ne, int Nh,
@@ -131,16 +135,17 @@ static void filter_direction( int Ns, int N, int Ne, int Nh,
 {
     if ( Nh < 0 )
         IMFILTER_ERROR("Invalid filter size");
-    TYPE *tmp = new TYPE[N+2*Nh];
     int Nh2 = 2*Nh+1;
-    for (int j=0; j<Ne; j++) {
-        for (int i=0; i<Ns; i++) {
-            copy_array( N, Ns, Nh, &A[i+j*Ns*N], boundary, X, tmp );
+    parallelSlabs( 0, Ns*Ne, [=]( int line0, int line1 ) {
+        std::vector<TYPE> tmp(N+2*Nh);
+        for (int line=line0; line<line1; line++) {
+            int i = line % Ns;
+            int j = line / Ns;
+            copy_array( N, Ns, Nh, &A[i+j*Ns*N], boundary, X, tmp.data() );
             for (int k=0; k<N; k++)
                 A[i+k*Ns+j*Ns*N] = H(Nh2,&tmp[k]);
         }
-    }
-    delete[] tmp;
+    } );
 }
 
 
@@ -189,6 +194,53 @@ Array<TYPE> imfilter::create_filter( const std::vector<int>& N0, const std::stri
 }
 
 
+// Check if a 2-D or 3-D filter is separable, H(i,j,k) = Hx(i)*Hy(j)*Hz(k),
+// and return the 1-D filters if it is
+template<class TYPE>
+static bool separate_filter( const Array<TYPE>& H, std::vector<Array<TYPE>>& H1 )
+{
+    int ndim = H.ndim();
+    if ( ndim < 2 || ndim > 3 )
+        return false;
+    int N[3] = { (int) H.size(0), (int) H.size(1), ndim==3 ? (int) H.size(2) : 1 };
+    // factor through the largest entry
+    size_t imax = 0;
+    for (size_t n=1; n<H.length(); n++) {
+        if ( fabs(H(n)) > fabs(H(imax)) )
+            imax = n;
+    }
+    TYPE Hmax = H(imax);
+    if ( Hmax == 0 )
+        return false;
+    int i0 = imax % N[0];
+    int j0 = (imax / N[0]) % N[1];
+    int k0 = imax / (N[0]*N[1]);
+    H1.resize( ndim );
+    for (int d=0; d<ndim; d++)
+        H1[d].resize( N[d] );
+    for (int i=0; i<N[0]; i++)
+        H1[0](i) = H(i+j0*N[0]+k0*N[0]*N[1]);
+    for (int j=0; j<N[1]; j++)
+        H1[1](j) = H(i0+j*N[0]+k0*N[0]*N[1]) / Hmax;
+    if ( ndim == 3 ) {
+        for (int k=0; k<N[2]; k++)
+            H1[2](k) = H(i0+j0*N[0]+k*N[0]*N[1]) / Hmax;
+    }
+    // check the factorization
+    TYPE tol = 1e-6 * fabs(Hmax);
+    for (int k=0; k<N[2]; k++) {
+        for (int j=0; j<N[1]; j++) {
+            for (int i=0; i<N[0]; i++) {
+                TYPE Hk = ndim==3 ? H1[2](k) : 1;
+                if ( fabs( H(i+j*N[0]+k*N[0]*N[1]) - H1[0](i)*H1[1](j)*Hk ) > tol )
+                    return false;
+            }
+        }
+    }
+    return true;
+}
+
+
 // Perform 2-D filtering
 template<class TYPE>
 void imfilter_2D( int Nx, int Ny, const TYPE *A, int Nhx, int Nhy, const TYPE *H,
@@ -197,7 +249,8 @@ void imfilter_2D( int Nx, int Ny, const TYPE *A, int Nhx, int Nhy, const TYPE *H
     IMFILTER_ASSERT( A != B );
     PROFILE_START( "imfilter_2D" );
     memset( B, 0, Nx * Ny * sizeof( TYPE ) );
-    for ( int j1 = 0; j1 < Ny; j1++ ) {
+    parallelSlabs( 0, Ny, [=]( int jmin, int jmax ) {
+    for ( int j1 = jmin; j1 < jmax; j1++ ) {
         for ( int i1 = 0; i1 < Nx; i1++ ) {
             TYPE tmp = 0;
             if ( i1 >= Nhx && i1 < Nx - Nhx && j1 >= Nhy && j1 < Ny - Nhy ) {
@@ -222,6 +275,7 @@ void imfilter_2D( int Nx, int Ny, const TYPE *A, int Nhx, int Nhy, const TYPE *H
             B[i1 + j1 * Nx] = tmp;
         }
     }
+    } );
     PROFILE_STOP( "imfilter_2D" );
 }
 
@@ -235,7 +289,8 @@ void imfilter_3D( int Nx, int Ny, int Nz, const TYPE *A, int Nhx, int Nhy, int N
     IMFILTER_ASSERT( A != B );
     PROFILE_START( "imfilter_3D" );
     memset( B, 0, Nx * Ny * Nz * sizeof( TYPE ) );
-    for ( int k1 = 0; k1 < Nz; k1++ ) {
+    parallelSlabs( 0, Nz, [=]( int kmin, int kmax ) {
+    for ( int k1 = kmin; k1 < kmax; k1++ ) {
         for ( int j1 = 0; j1 < Ny; j1++ ) {
             for ( int i1 = 0; i1 < Nx; i1++ ) {
                 TYPE tmp = 0;
@@ -257,6 +312,7 @@ void imfilter_3D( int Nx, int Ny, int Nz, const TYPE *A, int Nhx, int Nhy, int N
             }
         }
     }
+    } );
     PROFILE_STOP( "imfilter_3D" );
 }
 
@@ -270,11 +326,19 @@ Array<TYPE> imfilter::imfilter( const Array<TYPE>& A,
 {
     IMFILTER_ASSERT( A.ndim() == H.ndim() );
     IMFILTER_ASSERT( A.ndim() == BC.size() );
-    std::vector<size_t> Nh = H.size();
+    std::vector<size_t> Nh( H.ndim() );
     for (int d=0; d<A.ndim(); d++) {
         Nh[d] = (H.size(d)-1)/2;
         IMFILTER_INSIST(2*Nh[d]+1==H.size(d),"Filter must be of size 2*N+1");
     }
+    // Separable filters are applied one direction at a time.  With fixed boundary conditions
+    // this is only equivalent if the boundary value is zero.
+    std::vector<Array<TYPE>> H1;
+    bool fixed = false;
+    for (size_t d=0; d<BC.size(); d++)
+        fixed = fixed || BC[d] == imfilter::BC::fixed;
+    if ( ( !fixed || X == 0 ) && separate_filter( H, H1 ) )
+        return imfilter_separable( A, H1, BC, X );
     auto B = A;
     if ( A.ndim() == 1 ) {
         PROFILE_START( "imfilter_1D" );
@@ -298,19 +362,21 @@ Array<TYPE> imfilter::imfilter( const Array<TYPE>& A, const std::vector<int>& Nh
     PROFILE_START( "imfilter (lambda)" );
     IMFILTER_ASSERT( A.ndim() == Nh0.size() );
     IMFILTER_ASSERT( A.ndim() == BC0.size() );
-    std::vector<size_t> Nh2( A.size() );
+    std::vector<size_t> Nh2( A.ndim() );
     for (int d=0; d<A.ndim(); d++)
         Nh2[d] = 2*Nh0[d]+1;
     auto B = A;
-    Array<TYPE> data(Nh2);
     IMFILTER_INSIST(A.ndim()<=3,"Not programmed for more than 3 dimensions yet");
-    auto N = A.size();
+    std::vector<int> N( 3, 1 );
+    for (int d=0; d<A.ndim(); d++)
+        N[d] = A.size(d);
     auto Nh = Nh0;
     auto BC = BC0;
-    N.resize(3,1);
     Nh.resize(3,0);
     BC.resize(3,imfilter::BC::fixed);
-    for ( int k1 = 0; k1 < N[2]; k1++ ) {
+    parallelSlabs( 0, N[2], [&]( int kmin, int kmax ) {
+    Array<TYPE> data(Nh2);
+    for ( int k1 = kmin; k1 < kmax; k1++ ) {
         for ( int j1 = 0; j1 < N[1]; j1++ ) {
             for ( int i1 = 0; i1 < N[0]; i1++ ) {
                 for ( int kh = -Nh[2]; kh <= Nh[2]; kh++ ) {
@@ -328,6 +394,7 @@ Array<TYPE> imfilter::imfilter( const Array<TYPE>& A, const std::vector<int>& Nh
             }
         }
     }
+    } );
     PROFILE_STOP( "imfilter (lambda)" );
     return B;
 }
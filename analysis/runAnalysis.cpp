@@ -356,12 +356,16 @@ private:
 
 // Helper class to run the analysis from within a thread
 // Note: Averages will be modified after the constructor is called
+// Note: the local averages are computed by ComputeLocalWorkItem (one per block) between
+//    the two stages of the analysis
 class AnalysisWorkItem : public ThreadPool::WorkItemRet<void>
 {
 public:
-    AnalysisWorkItem( AnalysisType type_, int timestep_, TwoPhase &Averages_, BlobIDstruct ids,
-        BlobIDList id_list_, double beta_ )
-        : type( type_ ),
+    enum class Stage { Setup, Finish };
+    AnalysisWorkItem( Stage stage_, AnalysisType type_, int timestep_, TwoPhase &Averages_,
+        BlobIDstruct ids, BlobIDList id_list_, double beta_ )
+        : stage( stage_ ),
+          type( type_ ),
           timestep( timestep_ ),
           Averages( Averages_ ),
           blob_ids( ids ),
@@ -372,35 +376,41 @@ public:
     ~AnalysisWorkItem() {}
     virtual void run()
     {
-        Averages.NumberComponents_NWP = blob_ids->first;
-        Averages.Label_NWP            = blob_ids->second;
-        Averages.Label_NWP_map        = *id_list;
-        Averages.NumberComponents_WP  = 1;
-        Averages.Label_WP.fill( 0.0 );
-        if ( matches( type, AnalysisType::CopyPhaseIndicator ) ) {
-            // Averages.ColorToSignedDistance(beta,Averages.Phase,Averages.Phase_tplus);
-        }
-        if ( matches( type, AnalysisType::ComputeAverages ) ) {
-            PROFILE_START( "Compute dist", 1 );
-            Averages.Initialize();
-            Averages.ComputeDelPhi();
-            Averages.ColorToSignedDistance( beta, Averages.Phase, Averages.SDn );
-            Averages.ColorToSignedDistance( beta, Averages.Phase_tminus, Averages.Phase_tminus );
-            Averages.ColorToSignedDistance( beta, Averages.Phase_tplus, Averages.Phase_tplus );
-            Averages.UpdateMeshValues();
-            Averages.ComputeLocal();
+        if ( stage == Stage::Setup ) {
+            Averages.NumberComponents_NWP = blob_ids->first;
+            Averages.Label_NWP            = blob_ids->second;
+            Averages.Label_NWP_map        = *id_list;
+            Averages.NumberComponents_WP  = 1;
+            Averages.Label_WP.fill( 0.0 );
+            if ( matches( type, AnalysisType::CopyPhaseIndicator ) ) {
+                // Averages.ColorToSignedDistance(beta,Averages.Phase,Averages.Phase_tplus);
+            }
+            if ( matches( type, AnalysisType::ComputeAverages ) ) {
+                PROFILE_START( "Compute dist", 1 );
+                Averages.Initialize();
+                Averages.ComputeDelPhi();
+                Averages.ColorToSignedDistance( beta, Averages.Phase, Averages.SDn );
+                Averages.ColorToSignedDistance( beta, Averages.Phase_tminus, Averages.Phase_tminus );
+                Averages.ColorToSignedDistance( beta, Averages.Phase_tplus, Averages.Phase_tplus );
+                Averages.UpdateMeshValues();
+                PROFILE_STOP( "Compute dist", 1 );
+            }
+        } else if ( matches( type, AnalysisType::ComputeAverages ) ) {
+            PROFILE_START( "Compute averages", 1 );
+            Averages.ReduceLocalBlocks();
             Averages.Reduce();
             Averages.PrintAll( timestep );
             Averages.Initialize();
             Averages.ComponentAverages();
             Averages.SortBlobs();
             Averages.PrintComponents( timestep );
-            PROFILE_STOP( "Compute dist", 1 );
+            PROFILE_STOP( "Compute averages", 1 );
         }
     }
 
 private:
     AnalysisWorkItem();
+    Stage stage;
     AnalysisType type;
     int timestep;
     TwoPhase &Averages;
@@ -410,6 +420,28 @@ private:
 };
 
 
+// Helper class to compute the local averages for one block (z-slab) of cubes
+class ComputeLocalWorkItem : public ThreadPool::WorkItemRet<void>
+{
+public:
+    ComputeLocalWorkItem( TwoPhase &Averages_, int block_ ) : Averages( Averages_ ), block( block_ )
+    {
+    }
+    ~ComputeLocalWorkItem() {}
+    virtual void run()
+    {
+        PROFILE_START( "Compute local block", 1 );
+        Averages.ComputeLocalBlock( block );
+        PROFILE_STOP( "Compute local block", 1 );
+    }
+
+private:
+    ComputeLocalWorkItem();
+    TwoPhase &Averages;
+    int block;
+};
+
+
 class TCATWorkItem : public ThreadPool::WorkItemRet<void>
 {
 public:
@@ -736,6 +768,12 @@ runAnalysis::runAnalysis( std::shared_ptr<Database> input_db, const RankInfoStru
         d_meshData[0].vars.push_back( BlobIDVar );
     }
 
+    // The copies of the fields for visualization are part of the memory report
+    {
+        ScaLBL_MemoryTag tag( "analysis copies" );
+        for ( auto &var : d_meshData[0].vars )
+            ScaLBL_RecordAllocation( var->data.data(), var->data.length() * sizeof( double ) );
+    }
 
     // Initialize the comms
     for ( int i = 0; i < 1024; i++ )
@@ -868,6 +906,12 @@ runAnalysis::runAnalysis(  ScaLBL_ColorModel &ColorModel)
         d_meshData[0].vars.push_back( BlobIDVar );
     }
 
+    // The copies of the fields for visualization are part of the memory report
+    {
+        ScaLBL_MemoryTag tag( "analysis copies" );
+        for ( auto &var : d_meshData[0].vars )
+            ScaLBL_RecordAllocation( var->data.data(), var->data.length() * sizeof( double ) );
+    }
 
     // Initialize the comms
     for ( int i = 0; i < 1024; i++ )
@@ -881,6 +925,8 @@ runAnalysis::~runAnalysis()
 {
     // Finish processing analysis
     finish();
+    for ( auto &var : d_meshData[0].vars )
+        ScaLBL_RecordFree( var->data.data() );
 }
 void runAnalysis::finish()
 {
@@ -1137,12 +1183,25 @@ void runAnalysis::run( int timestep, std::shared_ptr<Database> input_db, TwoPhas
     // if (timestep%d_restart_interval==0){
     // if ( matches(type,AnalysisType::ComputeAverages) ) {
     if ( timestep % d_analysis_interval == 0 ) {
-        auto work =
-            new AnalysisWorkItem( type, timestep, Averages, d_last_index, d_last_id_map, d_beta );
-        work->add_dependency( d_wait_blobID );
-        work->add_dependency( d_wait_analysis );
-        work->add_dependency( d_wait_vis ); // Make sure we are done using analysis before modifying
-        d_wait_analysis = d_tpool.add_work( work );
+        auto work1 = new AnalysisWorkItem( AnalysisWorkItem::Stage::Setup, type, timestep,
+            Averages, d_last_index, d_last_id_map, d_beta );
+        work1->add_dependency( d_wait_blobID );
+        work1->add_dependency( d_wait_analysis );
+        work1->add_dependency( d_wait_vis ); // Make sure we are done using analysis before modifying
+        auto id1   = d_tpool.add_work( work1 );
+        auto work2 = new AnalysisWorkItem( AnalysisWorkItem::Stage::Finish, type, timestep,
+            Averages, d_last_index, d_last_id_map, d_beta );
+        work2->add_dependency( id1 );
+        if ( matches( type, AnalysisType::ComputeAverages ) ) {
+            // The blocks of the local averages can run on any of the worker threads
+            std::vector<ThreadPool::WorkItem *> blocks( Averages.LocalBlocks() );
+            for ( size_t b = 0; b < blocks.size(); b++ ) {
+                blocks[b] = new ComputeLocalWorkItem( Averages, b );
+                blocks[b]->add_dependency( id1 );
+            }
+            work2->add_dependencies( d_tpool.add_work( blocks ) );
+        }
+        d_wait_analysis = d_tpool.add_work( work2 );
     }
 
     // Spawn a thread to write the restart file
@@ -106,6 +106,113 @@ void InterpolateMesh( const Array<float> &Coarse, Array<float> &Fine )
 }
 
 
+// Interpolation weights for each of the r fine nodes in a coarse interval
+// (stencil i0-1,i0,i0+1,i0+2 where i0 is the coarse node below the fine node;
+// beyond the ghost cell the value is extrapolated linearly)
+static void RefineWeights( int r, bool hermite, std::vector<double> &weights )
+{
+	weights.resize( 4*r );
+	for (int m=0; m<r; m++){
+		double t = double(m)/double(r);
+		double *w = &weights[4*m];
+		if ( hermite ){
+			w[0] = 0.5*( -t*t*t + 2.0*t*t - t );
+			w[1] = 0.5*( 3.0*t*t*t - 5.0*t*t + 2.0 );
+			w[2] = 0.5*( -3.0*t*t*t + 4.0*t*t + t );
+			w[3] = 0.5*( t*t*t - t*t );
+		}
+		else {
+			w[0] = 0.0;
+			w[1] = 1.0 - t;
+			w[2] = t;
+			w[3] = 0.0;
+		}
+	}
+}
+
+// Refine the first dimension of a (n+2,ny,nz) array: Out(f,j,k) for f=1..r*n
+static void RefineDim0( const Array<double> &In, Array<double> &Out, int r, const std::vector<double> &weights )
+{
+	int n = int(In.size(0))-2;
+	int Ny = int(In.size(1));
+	int Nz = int(In.size(2));
+	parallelSlabs( 0, Nz, [&]( int kmin, int kmax ){
+		for (int k=kmin; k<kmax; k++){
+			for (int j=0; j<Ny; j++){
+				for (int f=1; f<=r*n; f++){
+					int i0 = (f-1)/r + 1;
+					const double *w = &weights[4*((f-1)%r)];
+					double fp = ( i0+2 <= n+1 ) ? In(i0+2,j,k) : 2.0*In(n+1,j,k) - In(n,j,k);
+					Out(f,j,k) = w[0]*In(i0-1,j,k) + w[1]*In(i0,j,k) + w[2]*In(i0+1,j,k) + w[3]*fp;
+				}
+			}
+		}
+	} );
+}
+
+// Refine the second dimension of a (nx,n+2,nz) array: Out(i,f,k) for f=1..r*n
+static void RefineDim1( const Array<double> &In, Array<double> &Out, int r, const std::vector<double> &weights )
+{
+	int Nx = int(In.size(0));
+	int n = int(In.size(1))-2;
+	int Nz = int(In.size(2));
+	parallelSlabs( 0, Nz, [&]( int kmin, int kmax ){
+		for (int k=kmin; k<kmax; k++){
+			for (int f=1; f<=r*n; f++){
+				int j0 = (f-1)/r + 1;
+				const double *w = &weights[4*((f-1)%r)];
+				for (int i=0; i<Nx; i++){
+					double fp = ( j0+2 <= n+1 ) ? In(i,j0+2,k) : 2.0*In(i,n+1,k) - In(i,n,k);
+					Out(i,f,k) = w[0]*In(i,j0-1,k) + w[1]*In(i,j0,k) + w[2]*In(i,j0+1,k) + w[3]*fp;
+				}
+			}
+		}
+	} );
+}
+
+// Refine the third dimension of a (nx,ny,n+2) array: Out(i,j,f) for f=1..r*n
+static void RefineDim2( const Array<double> &In, Array<double> &Out, int r, const std::vector<double> &weights )
+{
+	int Nx = int(In.size(0));
+	int Ny = int(In.size(1));
+	int n = int(In.size(2))-2;
+	parallelSlabs( 1, r*n+1, [&]( int fmin, int fmax ){
+		for (int f=fmin; f<fmax; f++){
+			int k0 = (f-1)/r + 1;
+			const double *w = &weights[4*((f-1)%r)];
+			for (int j=0; j<Ny; j++){
+				for (int i=0; i<Nx; i++){
+					double fp = ( k0+2 <= n+1 ) ? In(i,j,k0+2) : 2.0*In(i,j,n+1) - In(i,j,n);
+					Out(i,j,f) = w[0]*In(i,j,k0-1) + w[1]*In(i,j,k0) + w[2]*In(i,j,k0+1) + w[3]*fp;
+				}
+			}
+		}
+	} );
+}
+
+void RefineMesh( const Array<double> &Coarse, Array<double> &Fine, int r, const std::string &method )
+{
+	PROFILE_START("RefineMesh");
+	INSIST( method == "trilinear" || method == "hermite", "Unknown interpolation method: " + method );
+	int nx = int(Coarse.size(0))-2;
+	int ny = int(Coarse.size(1))-2;
+	int nz = int(Coarse.size(2))-2;
+	ASSERT( r > 0 );
+	ASSERT( Fine.size(0) == size_t(r*nx+2) && Fine.size(1) == size_t(r*ny+2) && Fine.size(2) == size_t(r*nz+2) );
+	std::vector<double> weights;
+	RefineWeights( r, method == "hermite", weights );
+	// the interpolation is separable: refine x, then y, then z
+	Array<double> Fx( r*nx+2, ny+2, nz+2 );
+	Array<double> Fxy( r*nx+2, r*ny+2, nz+2 );
+	Fx.fill( 0 );
+	Fxy.fill( 0 );
+	RefineDim0( Coarse, Fx, r, weights );
+	RefineDim1( Fx, Fxy, r, weights );
+	RefineDim2( Fxy, Fine, r, weights );
+	PROFILE_STOP("RefineMesh");
+}
+
+
 // Smooth the data using the distance
 void smooth( const Array<float>& VOL, const Array<float>& Dist, float sigma, Array<float>& MultiScaleSmooth, fillHalo<float>& fillFloat )
 {
@@ -275,8 +382,7 @@ void filter_final( Array<char>& ID, Array<float>& Dist,
     //Array<float> Dist2 = Dist;
 	CalcDist( Dist1, ID1, Dm );
 	CalcDist( Dist2, ID2, Dm );
-    fillFloat.fill(Dist1);
-    fillFloat.fill(Dist2);
+    fillFloat.fill(Dist1,Dist2);
     // Keep those regions that are within dx2 of the new volumes
     Mean = Dist;
     for (size_t i=0; i<ID.length(); i++) {
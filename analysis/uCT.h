@@ -32,6 +32,21 @@
 void InterpolateMesh( const Array<float> &Coarse, Array<float> &Fine );
 
 
+/*!
+ * @brief  Refine a mesh by an integer factor
+ * @details  This routine interpolates a field with 1 ghost cell to a mesh that is
+ *    refined by the factor r in each direction.  Fine node i (1 <= i <= r*nx) is located
+ *    at the coarse position 1+(i-1)/r, so the first node of each subdomain matches exactly.
+ *    The interpolation is applied one direction at a time and the z-slabs are processed
+ *    with parallelSlabs (Utilities::setNumThreads).  The ghost cells of Fine are not set.
+ * @param[in] Coarse    Coarse mesh solution (nx+2,ny+2,nz+2)
+ * @param[out] Fine     Fine mesh solution (r*nx+2,r*ny+2,r*nz+2)
+ * @param[in] r         Refinement factor
+ * @param[in] method    Interpolation: "trilinear" or "hermite" (cubic, Catmull-Rom)
+ */
+void RefineMesh( const Array<double> &Coarse, Array<double> &Fine, int r, const std::string &method );
+
+
 // Smooth the data using the distance
 void smooth( const Array<float>& VOL, const Array<float>& Dist, float sigma, Array<float>& MultiScaleSmooth, fillHalo<float>& fillFloat );
 
@@ -0,0 +1,643 @@
+/*
+  Copyright 2013--2018 James E. McClure, Virginia Polytechnic & State University
+  Copyright Equnior ASA
+
+  This file is part of the Open Porous Media project (OPM).
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/* ColorCombined.hpp
+ *  Site update of the color model collision combined with the phase field update
+ *  (ScaLBL_D3Q19_AA*_Color_Combined). The cpu, cuda and hip kernels only differ in
+ *  how they loop over the sites and in the AA streaming pattern, so they share this body.
+ */
+#ifndef ScaLBL_ColorCombined_HPP
+#define ScaLBL_ColorCombined_HPP
+
+#include <math.h>
+
+#if defined( __CUDACC__ ) || defined( __HIPCC__ )
+#define SCALBL_COLOR_INLINE __device__ __forceinline__
+#elif defined( __GNUC__ )
+#define SCALBL_COLOR_INLINE inline __attribute__( ( always_inline ) )
+#else
+#define SCALBL_COLOR_INLINE inline
+#endif
+
+// AA streaming pattern: slot(q) is where the site writes direction q, and direction q is
+// read from the slot of the opposite direction (the directions come in pairs 1-2, 3-4, ...).
+// The first seven slots are also the D3Q7 slots of the mass transport distributions Aq/Bq.
+struct ScaLBL_AAevenSlot {
+	int n, Np;
+	SCALBL_COLOR_INLINE int operator()( int q ) const { return q*Np + n; }
+};
+struct ScaLBL_AAoddSlot {
+	const int *neighborList;
+	int n, Np;
+	SCALBL_COLOR_INLINE int operator()( int q ) const { return q == 0 ? n : neighborList[n + ((q-1)^1)*Np]; }
+};
+
+// The number densities are computed by streaming Aq/Bq (as in ScaLBL_D3Q7_AA*_PhaseField)
+// instead of reading Den, and the new phase indicator is written to PhiOut. The color
+// gradient is taken from Phi, the phase field from the previous half-step, so Phi and
+// PhiOut must be different arrays.
+template<class SLOT>
+SCALBL_COLOR_INLINE void ScaLBL_D3Q19_Color_Combined_Site(int n, const SLOT &slot, int *Map, double *dist,
+		double *Aq, double *Bq, double *Den, double *Phi, double *PhiOut, double *Vel,
+		double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int Np){
+	int ijk,nn;
+	double fq;
+	// conserved momemnts
+	double rho,jx,jy,jz;
+	// non-conserved moments
+	double m1,m2,m4,m6,m8,m9,m10,m11,m12,m13,m14,m15,m16,m17,m18;
+	double m3,m5,m7;
+	double nA,nB; // number density
+	double a1,b1,a2,b2,nAB,delta;
+	double C,nx,ny,nz; //color gradient magnitude and direction
+	double ux,uy,uz;
+	double phi,tau,rho0,rlx_setA,rlx_setB;
+	
+	const double mrt_V1=0.05263157894736842;
+	const double mrt_V2=0.012531328320802;
+	const double mrt_V3=0.04761904761904762;
+	const double mrt_V4=0.004594820384294068;
+	const double mrt_V5=0.01587301587301587;
+	const double mrt_V6=0.0555555555555555555555555;
+	const double mrt_V7=0.02777777777777778;
+	const double mrt_V8=0.08333333333333333;
+	const double mrt_V9=0.003341687552213868;
+	const double mrt_V10=0.003968253968253968;
+	const double mrt_V11=0.01388888888888889;
+	const double mrt_V12=0.04166666666666666;
+
+
+	// stream the mass transport distributions to get the number densities
+	nA = Aq[slot(0)];
+	nB = Bq[slot(0)];
+	nA += Aq[slot(2)];
+	nB += Bq[slot(2)];
+	nA += Aq[slot(1)];
+	nB += Bq[slot(1)];
+	nA += Aq[slot(4)];
+	nB += Bq[slot(4)];
+	nA += Aq[slot(3)];
+	nB += Bq[slot(3)];
+	nA += Aq[slot(6)];
+	nB += Bq[slot(6)];
+	nA += Aq[slot(5)];
+	nB += Bq[slot(5)];
+	Den[n] = nA;
+	Den[Np+n] = nB;
+
+	// compute phase indicator field
+	phi=(nA-nB)/(nA+nB);
+
+	// local density
+	rho0=rhoA + 0.5*(1.0-phi)*(rhoB-rhoA);
+	// local relaxation time
+	tau=tauA + 0.5*(1.0-phi)*(tauB-tauA);
+	rlx_setA = 1.f/tau;
+	rlx_setB = 8.f*(2.f-rlx_setA)/(8.f-rlx_setA);
+
+	// Get the 1D index based on regular data layout
+	ijk = Map[n];
+	PhiOut[ijk] = phi;
+	//					COMPUTE THE COLOR GRADIENT
+	//........................................................................
+	//.................Read Phase Indicator Values............................
+	//........................................................................
+	nn = ijk-1;							// neighbor index (get convention)
+	m1 = Phi[nn];						// get neighbor for phi - 1
+	//........................................................................
+	nn = ijk+1;							// neighbor index (get convention)
+	m2 = Phi[nn];						// get neighbor for phi - 2
+	//........................................................................
+	nn = ijk-strideY;							// neighbor index (get convention)
+	m3 = Phi[nn];					// get neighbor for phi - 3
+	//........................................................................
+	nn = ijk+strideY;							// neighbor index (get convention)
+	m4 = Phi[nn];					// get neighbor for phi - 4
+	//........................................................................
+	nn = ijk-strideZ;						// neighbor index (get convention)
+	m5 = Phi[nn];					// get neighbor for phi - 5
+	//........................................................................
+	nn = ijk+strideZ;						// neighbor index (get convention)
+	m6 = Phi[nn];					// get neighbor for phi - 6
+	//........................................................................
+	nn = ijk-strideY-1;						// neighbor index (get convention)
+	m7 = Phi[nn];					// get neighbor for phi - 7
+	//........................................................................
+	nn = ijk+strideY+1;						// neighbor index (get convention)
+	m8 = Phi[nn];					// get neighbor for phi - 8
+	//........................................................................
+	nn = ijk+strideY-1;						// neighbor index (get convention)
+	m9 = Phi[nn];					// get neighbor for phi - 9
+	//........................................................................
+	nn = ijk-strideY+1;						// neighbor index (get convention)
+	m10 = Phi[nn];					// get neighbor for phi - 10
+	//........................................................................
+	nn = ijk-strideZ-1;						// neighbor index (get convention)
+	m11 = Phi[nn];					// get neighbor for phi - 11
+	//........................................................................
+	nn = ijk+strideZ+1;						// neighbor index (get convention)
+	m12 = Phi[nn];					// get neighbor for phi - 12
+	//........................................................................
+	nn = ijk+strideZ-1;						// neighbor index (get convention)
+	m13 = Phi[nn];					// get neighbor for phi - 13
+	//........................................................................
+	nn = ijk-strideZ+1;						// neighbor index (get convention)
+	m14 = Phi[nn];					// get neighbor for phi - 14
+	//........................................................................
+	nn = ijk-strideZ-strideY;					// neighbor index (get convention)
+	m15 = Phi[nn];					// get neighbor for phi - 15
+	//........................................................................
+	nn = ijk+strideZ+strideY;					// neighbor index (get convention)
+	m16 = Phi[nn];					// get neighbor for phi - 16
+	//........................................................................
+	nn = ijk+strideZ-strideY;					// neighbor index (get convention)
+	m17 = Phi[nn];					// get neighbor for phi - 17
+	//........................................................................
+	nn = ijk-strideZ+strideY;					// neighbor index (get convention)
+	m18 = Phi[nn];					// get neighbor for phi - 18
+	//............Compute the Color Gradient...................................
+	nx = -(m1-m2+0.5*(m7-m8+m9-m10+m11-m12+m13-m14));
+	ny = -(m3-m4+0.5*(m7-m8-m9+m10+m15-m16+m17-m18));
+	nz = -(m5-m6+0.5*(m11-m12-m13+m14+m15-m16-m17+m18));
+
+	//...........Normalize the Color Gradient.................................
+	C = sqrt(nx*nx+ny*ny+nz*nz);
+	double ColorMag = C;
+	if (C==0.0) ColorMag=1.0;
+	nx = nx/ColorMag;
+	ny = ny/ColorMag;
+	nz = nz/ColorMag;		
+	
+	// q=0
+	fq = dist[slot(0)];
+	rho = fq;
+	m1  = -30.0*fq;
+	m2  = 12.0*fq;
+
+	// q=1
+	fq = dist[slot(2)];
+	rho += fq;
+	m1 -= 11.0*fq;
+	m2 -= 4.0*fq;
+	jx = fq;
+	m4 = -4.0*fq;
+	m9 = 2.0*fq;
+	m10 = -4.0*fq;
+
+	// f2 = dist[slot(10)];
+	fq = dist[slot(1)];
+	rho += fq;
+	m1 -= 11.0*(fq);
+	m2 -= 4.0*(fq);
+	jx -= fq;
+	m4 += 4.0*(fq);
+	m9 += 2.0*(fq);
+	m10 -= 4.0*(fq);
+
+	// q=3
+	fq = dist[slot(4)];
+	rho += fq;
+	m1 -= 11.0*fq;
+	m2 -= 4.0*fq;
+	jy = fq;
+	m6 = -4.0*fq;
+	m9 -= fq;
+	m10 += 2.0*fq;
+	m11 = fq;
+	m12 = -2.0*fq;
+
+	// q = 4
+	fq = dist[slot(3)];
+	rho+= fq;
+	m1 -= 11.0*fq;
+	m2 -= 4.0*fq;
+	jy -= fq;
+	m6 += 4.0*fq;
+	m9 -= fq;
+	m10 += 2.0*fq;
+	m11 += fq;
+	m12 -= 2.0*fq;
+
+	// q=5
+	fq = dist[slot(6)];
+	rho += fq;
+	m1 -= 11.0*fq;
+	m2 -= 4.0*fq;
+	jz = fq;
+	m8 = -4.0*fq;
+	m9 -= fq;
+	m10 += 2.0*fq;
+	m11 -= fq;
+	m12 += 2.0*fq;
+
+	// q = 6
+	fq = dist[slot(5)];
+	rho+= fq;
+	m1 -= 11.0*fq;
+	m2 -= 4.0*fq;
+	jz -= fq;
+	m8 += 4.0*fq;
+	m9 -= fq;
+	m10 += 2.0*fq;
+	m11 -= fq;
+	m12 += 2.0*fq;
+
+	// q=7
+	fq = dist[slot(8)];
+	rho += fq;
+	m1 += 8.0*fq;
+	m2 += fq;
+	jx += fq;
+	m4 += fq;
+	jy += fq;
+	m6 += fq;
+	m9  += fq;
+	m10 += fq;
+	m11 += fq;
+	m12 += fq;
+	m13 = fq;
+	m16 = fq;
+	m17 = -fq;
+
+	// q = 8
+	fq = dist[slot(7)];
+	rho += fq;
+	m1 += 8.0*fq;
+	m2 += fq;
+	jx -= fq;
+	m4 -= fq;
+	jy -= fq;
+	m6 -= fq;
+	m9 += fq;
+	m10 += fq;
+	m11 += fq;
+	m12 += fq;
+	m13 += fq;
+	m16 -= fq;
+	m17 += fq;
+
+	// q=9
+	fq = dist[slot(10)];
+	rho += fq;
+	m1 += 8.0*fq;
+	m2 += fq;
+	jx += fq;
+	m4 += fq;
+	jy -= fq;
+	m6 -= fq;
+	m9 += fq;
+	m10 += fq;
+	m11 += fq;
+	m12 += fq;
+	m13 -= fq;
+	m16 += fq;
+	m17 += fq;
+
+	// q = 10
+	fq = dist[slot(9)];
+	rho += fq;
+	m1 += 8.0*fq;
+	m2 += fq;
+	jx -= fq;
+	m4 -= fq;
+	jy += fq;
+	m6 += fq;
+	m9 += fq;
+	m10 += fq;
+	m11 += fq;
+	m12 += fq;
+	m13 -= fq;
+	m16 -= fq;
+	m17 -= fq;
+
+	// q=11
+	fq = dist[slot(12)];
+	rho += fq;
+	m1 += 8.0*fq;
+	m2 += fq;
+	jx += fq;
+	m4 += fq;
+	jz += fq;
+	m8 += fq;
+	m9 += fq;
+	m10 += fq;
+	m11 -= fq;
+	m12 -= fq;
+	m15 = fq;
+	m16 -= fq;
+	m18 = fq;
+
+	// q=12
+	fq = dist[slot(11)];
+	rho += fq;
+	m1 += 8.0*fq;
+	m2 += fq;
+	jx -= fq;
+	m4 -= fq;
+	jz -= fq;
+	m8 -= fq;
+	m9 += fq;
+	m10 += fq;
+	m11 -= fq;
+	m12 -= fq;
+	m15 += fq;
+	m16 += fq;
+	m18 -= fq;
+
+	// q=13
+	fq = dist[slot(14)];
+	rho += fq;
+	m1 += 8.0*fq;
+	m2 += fq;
+	jx += fq;
+	m4 += fq;
+	jz -= fq;
+	m8 -= fq;
+	m9 += fq;
+	m10 += fq;
+	m11 -= fq;
+	m12 -= fq;
+	m15 -= fq;
+	m16 -= fq;
+	m18 -= fq;
+
+	// q=14
+	fq = dist[slot(13)];
+	rho += fq;
+	m1 += 8.0*fq;
+	m2 += fq;
+	jx -= fq;
+	m4 -= fq;
+	jz += fq;
+	m8 += fq;
+	m9 += fq;
+	m10 += fq;
+	m11 -= fq;
+	m12 -= fq;
+	m15 -= fq;
+	m16 += fq;
+	m18 += fq;
+
+	// q=15
+	fq = dist[slot(16)];
+	rho += fq;
+	m1 += 8.0*fq;
+	m2 += fq;
+	jy += fq;
+	m6 += fq;
+	jz += fq;
+	m8 += fq;
+	m9 -= 2.0*fq;
+	m10 -= 2.0*fq;
+	m14 = fq;
+	m17 += fq;
+	m18 -= fq;
+
+	// q=16
+	fq = dist[slot(15)];
+	rho += fq;
+	m1 += 8.0*fq;
+	m2 += fq;
+	jy -= fq;
+	m6 -= fq;
+	jz -= fq;
+	m8 -= fq;
+	m9 -= 2.0*fq;
+	m10 -= 2.0*fq;
+	m14 += fq;
+	m17 -= fq;
+	m18 += fq;
+
+	// q=17
+	fq = dist[slot(18)];
+	rho += fq;
+	m1 += 8.0*fq;
+	m2 += fq;
+	jy += fq;
+	m6 += fq;
+	jz -= fq;
+	m8 -= fq;
+	m9 -= 2.0*fq;
+	m10 -= 2.0*fq;
+	m14 -= fq;
+	m17 += fq;
+	m18 += fq;
+
+	// q=18
+	fq = dist[slot(17)];
+	rho += fq;
+	m1 += 8.0*fq;
+	m2 += fq;
+	jy -= fq;
+	m6 -= fq;
+	jz += fq;
+	m8 += fq;
+	m9 -= 2.0*fq;
+	m10 -= 2.0*fq;
+	m14 -= fq;
+	m17 -= fq;
+	m18 -= fq;
+
+	//........................................................................
+	//..............carry out relaxation process..............................
+	//..........Toelke, Fruediger et. al. 2006................................
+	if (C == 0.0)	nx = ny = nz = 0.0;
+	m1 = m1 + rlx_setA*((19*(jx*jx+jy*jy+jz*jz)/rho0 - 11*rho) -19*alpha*C - m1);
+	m2 = m2 + rlx_setA*((3*rho - 5.5*(jx*jx+jy*jy+jz*jz)/rho0)- m2);
+	m4 = m4 + rlx_setB*((-0.6666666666666666*jx)- m4);
+	m6 = m6 + rlx_setB*((-0.6666666666666666*jy)- m6);
+	m8 = m8 + rlx_setB*((-0.6666666666666666*jz)- m8);
+	m9 = m9 + rlx_setA*(((2*jx*jx-jy*jy-jz*jz)/rho0) + 0.5*alpha*C*(2*nx*nx-ny*ny-nz*nz) - m9);
+	m10 = m10 + rlx_setA*( - m10);
+	m11 = m11 + rlx_setA*(((jy*jy-jz*jz)/rho0) + 0.5*alpha*C*(ny*ny-nz*nz)- m11);
+	m12 = m12 + rlx_setA*( - m12);
+	m13 = m13 + rlx_setA*( (jx*jy/rho0) + 0.5*alpha*C*nx*ny - m13);
+	m14 = m14 + rlx_setA*( (jy*jz/rho0) + 0.5*alpha*C*ny*nz - m14);
+	m15 = m15 + rlx_setA*( (jx*jz/rho0) + 0.5*alpha*C*nx*nz - m15);
+	m16 = m16 + rlx_setB*( - m16);
+	m17 = m17 + rlx_setB*( - m17);
+	m18 = m18 + rlx_setB*( - m18);
+
+	//.......................................................................................................
+	//.................inverse transformation......................................................
+
+	// q=0
+	fq = mrt_V1*rho-mrt_V2*m1+mrt_V3*m2;
+	dist[slot(0)] = fq;
+
+	// q = 1
+	fq = mrt_V1*rho-mrt_V4*m1-mrt_V5*m2+0.1*(jx-m4)+mrt_V6*(m9-m10) + 0.16666666*Fx;
+	dist[slot(1)] = fq;
+
+	// q=2
+	fq = mrt_V1*rho-mrt_V4*m1-mrt_V5*m2+0.1*(m4-jx)+mrt_V6*(m9-m10) -  0.16666666*Fx;
+	dist[slot(2)] = fq;
+
+	// q = 3
+	fq = mrt_V1*rho-mrt_V4*m1-mrt_V5*m2+0.1*(jy-m6)+mrt_V7*(m10-m9)+mrt_V8*(m11-m12) + 0.16666666*Fy;
+	dist[slot(3)] = fq;
+
+	// q = 4
+	fq = mrt_V1*rho-mrt_V4*m1-mrt_V5*m2+0.1*(m6-jy)+mrt_V7*(m10-m9)+mrt_V8*(m11-m12) - 0.16666666*Fy;
+	dist[slot(4)] = fq;
+
+	// q = 5
+	fq = mrt_V1*rho-mrt_V4*m1-mrt_V5*m2+0.1*(jz-m8)+mrt_V7*(m10-m9)+mrt_V8*(m12-m11) + 0.16666666*Fz;
+	dist[slot(5)] = fq;
+
+	// q = 6
+	fq = mrt_V1*rho-mrt_V4*m1-mrt_V5*m2+0.1*(m8-jz)+mrt_V7*(m10-m9)+mrt_V8*(m12-m11) - 0.16666666*Fz;
+	dist[slot(6)] = fq;
+
+	// q = 7
+	fq = mrt_V1*rho+mrt_V9*m1+mrt_V10*m2+0.1*(jx+jy)+0.025*(m4+m6)+
+			mrt_V7*m9+mrt_V11*m10+mrt_V8*m11+mrt_V12*m12+0.25*m13+0.125*(m16-m17) + 0.08333333333*(Fx+Fy);
+	dist[slot(7)] = fq;
+
+
+	// q = 8
+	fq = mrt_V1*rho+mrt_V9*m1+mrt_V10*m2-0.1*(jx+jy)-0.025*(m4+m6) +mrt_V7*m9+mrt_V11*m10+mrt_V8*m11
+			+mrt_V12*m12+0.25*m13+0.125*(m17-m16) - 0.08333333333*(Fx+Fy);
+	dist[slot(8)] = fq;
+
+	// q = 9
+	fq = mrt_V1*rho+mrt_V9*m1+mrt_V10*m2+0.1*(jx-jy)+0.025*(m4-m6)+
+			mrt_V7*m9+mrt_V11*m10+mrt_V8*m11+mrt_V12*m12-0.25*m13+0.125*(m16+m17) + 0.08333333333*(Fx-Fy);
+	dist[slot(9)] = fq;
+
+	// q = 10
+	fq = mrt_V1*rho+mrt_V9*m1+mrt_V10*m2+0.1*(jy-jx)+0.025*(m6-m4)+
+			mrt_V7*m9+mrt_V11*m10+mrt_V8*m11+mrt_V12*m12-0.25*m13-0.125*(m16+m17)- 0.08333333333*(Fx-Fy);
+	dist[slot(10)] = fq;
+
+
+	// q = 11
+	fq = mrt_V1*rho+mrt_V9*m1
+			+mrt_V10*m2+0.1*(jx+jz)+0.025*(m4+m8)
+			+mrt_V7*m9+mrt_V11*m10-mrt_V8*m11
+			-mrt_V12*m12+0.25*m15+0.125*(m18-m16) + 0.08333333333*(Fx+Fz);
+	dist[slot(11)] = fq;
+
+	// q = 12
+	fq = mrt_V1*rho+mrt_V9*m1+mrt_V10*m2-0.1*(jx+jz)-0.025*(m4+m8)+
+			mrt_V7*m9+mrt_V11*m10-mrt_V8*m11-mrt_V12*m12+0.25*m15+0.125*(m16-m18)-0.08333333333*(Fx+Fz);
+	dist[slot(12)] = fq;
+
+	// q = 13
+	fq = mrt_V1*rho+mrt_V9*m1
+			+mrt_V10*m2+0.1*(jx-jz)+0.025*(m4-m8)
+			+mrt_V7*m9+mrt_V11*m10-mrt_V8*m11
+			-mrt_V12*m12-0.25*m15-0.125*(m16+m18) + 0.08333333333*(Fx-Fz);
+	dist[slot(13)] = fq;
+
+	// q= 14
+	fq = mrt_V1*rho+mrt_V9*m1
+			+mrt_V10*m2+0.1*(jz-jx)+0.025*(m8-m4)
+			+mrt_V7*m9+mrt_V11*m10-mrt_V8*m11
+			-mrt_V12*m12-0.25*m15+0.125*(m16+m18) - 0.08333333333*(Fx-Fz);
+
+	dist[slot(14)] = fq;
+
+	// q = 15
+	fq = mrt_V1*rho+mrt_V9*m1
+			+mrt_V10*m2+0.1*(jy+jz)+0.025*(m6+m8)
+			-mrt_V6*m9-mrt_V7*m10+0.25*m14+0.125*(m17-m18) + 0.08333333333*(Fy+Fz);
+	dist[slot(15)] = fq;
+
+	// q = 16
+	fq =  mrt_V1*rho+mrt_V9*m1
+			+mrt_V10*m2-0.1*(jy+jz)-0.025*(m6+m8)
+			-mrt_V6*m9-mrt_V7*m10+0.25*m14+0.125*(m18-m17)- 0.08333333333*(Fy+Fz);
+	dist[slot(16)] = fq;
+
+
+	// q = 17
+	fq = mrt_V1*rho+mrt_V9*m1
+			+mrt_V10*m2+0.1*(jy-jz)+0.025*(m6-m8)
+			-mrt_V6*m9-mrt_V7*m10-0.25*m14+0.125*(m17+m18) + 0.08333333333*(Fy-Fz);
+	dist[slot(17)] = fq;
+
+	// q = 18
+	fq = mrt_V1*rho+mrt_V9*m1
+			+mrt_V10*m2+0.1*(jz-jy)+0.025*(m8-m6)
+			-mrt_V6*m9-mrt_V7*m10-0.25*m14-0.125*(m17+m18) - 0.08333333333*(Fy-Fz);
+	dist[slot(18)] = fq;
+
+	//........................................................................
+
+	// write the velocity 
+	ux = jx / rho0;
+	uy = jy / rho0;
+	uz = jz / rho0;
+	Vel[n] = ux;
+	Vel[Np+n] = uy;
+	Vel[2*Np+n] = uz;
+
+	// Instantiate mass transport distributions
+	// Stationary value - distribution 0
+
+	nAB = 1.0/(nA+nB);
+	Aq[slot(0)] = 0.3333333333333333*nA;
+	Bq[slot(0)] = 0.3333333333333333*nB;
+
+	//...............................................
+	// q = 0,2,4
+	// Cq = {1,0,0}, {0,1,0}, {0,0,1}
+	delta = beta*nA*nB*nAB*0.1111111111111111*nx;
+	if (!(nA*nB*nAB>0)) delta=0;
+	a1 = nA*(0.1111111111111111*(1+4.5*ux))+delta;
+	b1 = nB*(0.1111111111111111*(1+4.5*ux))-delta;
+	a2 = nA*(0.1111111111111111*(1-4.5*ux))-delta;
+	b2 = nB*(0.1111111111111111*(1-4.5*ux))+delta;
+
+	Aq[slot(1)] = a1;
+	Bq[slot(1)] = b1;
+	Aq[slot(2)] = a2;
+	Bq[slot(2)] = b2;
+
+	//...............................................
+	// q = 2
+	// Cq = {0,1,0}
+	delta = beta*nA*nB*nAB*0.1111111111111111*ny;
+	if (!(nA*nB*nAB>0)) delta=0;
+	a1 = nA*(0.1111111111111111*(1+4.5*uy))+delta;
+	b1 = nB*(0.1111111111111111*(1+4.5*uy))-delta;
+	a2 = nA*(0.1111111111111111*(1-4.5*uy))-delta;
+	b2 = nB*(0.1111111111111111*(1-4.5*uy))+delta;
+
+	Aq[slot(3)] = a1;
+	Bq[slot(3)] = b1;
+	Aq[slot(4)] = a2;
+	Bq[slot(4)] = b2;
+	//...............................................
+	// q = 4
+	// Cq = {0,0,1}
+	delta = beta*nA*nB*nAB*0.1111111111111111*nz;
+	if (!(nA*nB*nAB>0)) delta=0;
+	a1 = nA*(0.1111111111111111*(1+4.5*uz))+delta;
+	b1 = nB*(0.1111111111111111*(1+4.5*uz))-delta;
+	a2 = nA*(0.1111111111111111*(1-4.5*uz))-delta;
+	b2 = nB*(0.1111111111111111*(1-4.5*uz))+delta;
+
+	Aq[slot(5)] = a1;
+	Bq[slot(5)] = b1;
+	Aq[slot(6)] = a2;
+	Bq[slot(6)] = b2;
+	//...............................................
+}
+
+#endif
@@ -22,6 +22,8 @@
 #include "common/Array.h"
 
 #include <array>
+#include <functional>
+#include <vector>
 
 // ********** COMMUNICTION **************************************
 /*
@@ -93,6 +95,16 @@ public:
      */
     void fill( Array<TYPE>& array );
 
+    /*!
+     * @brief  Communicate the halos of several arrays
+     * @details  The arrays may have different types and depths.  Their halos are packed
+     *    together and exchanged with one message per neighbor (instead of one per array),
+     *    packing and unpacking with Utilities::parallelFor.
+     * @param[in] arrays        The arrays on which we fill the halos
+     */
+    template<class TYPE1, class TYPE2, class... TYPES>
+    void fill( Array<TYPE1>& array1, Array<TYPE2>& array2, Array<TYPES>&... arrays );
+
     /*!
      * @brief  Copy data from the src array to the dst array
      * @param[in] src           The src array with or without halos
@@ -113,8 +125,19 @@ private:
     TYPE *mem;
     TYPE *send[3][3][3], *recv[3][3][3];
     MPI_Request send_req[3][3][3], recv_req[3][3][3];
-    void pack( const Array<TYPE>& array, int i, int j, int k, TYPE *buffer );
-    void unpack( Array<TYPE>& array, int i, int j, int k, const TYPE *buffer );
+    std::vector<double> mem_fields;
+    template<class TYPE2>
+    void pack( const Array<TYPE2>& array, int i, int j, int k, TYPE2 *buffer );
+    template<class TYPE2>
+    void unpack( Array<TYPE2>& array, int i, int j, int k, const TYPE2 *buffer );
+    // An array in a multi-array fill: bytes per cell and its pack/unpack
+    struct HaloField {
+        size_t bytes;
+        std::function<void(int,int,int,char*)> pack;
+        std::function<void(int,int,int,const char*)> unpack;
+    };
+    template<class TYPE2>
+    HaloField field( Array<TYPE2>& array );
 };
 
 
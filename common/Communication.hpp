@@ -306,7 +306,92 @@ void fillHalo<TYPE>::fill( Array<TYPE>& data )
     //PROFILE_STOP("fillHalo::fill",1);
 }
 template<class TYPE>
-void fillHalo<TYPE>::pack( const Array<TYPE>& data, int i0, int j0, int k0, TYPE *buffer )
+template<class TYPE2>
+typename fillHalo<TYPE>::HaloField fillHalo<TYPE>::field( Array<TYPE2>& data )
+{
+    ASSERT((int)data.size(0)==n[0]+2*ng[0]);
+    ASSERT((int)data.size(1)==n[1]+2*ng[1]);
+    ASSERT((int)data.size(2)==n[2]+2*ng[2]);
+    ASSERT(data.ndim()==3||data.ndim()==4);
+    HaloField field;
+    field.bytes = data.size(3)*sizeof(TYPE2);
+    field.pack = [this,&data]( int i, int j, int k, char *buffer ) {
+        pack( data, i, j, k, reinterpret_cast<TYPE2*>( buffer ) );
+    };
+    field.unpack = [this,&data]( int i, int j, int k, const char *buffer ) {
+        unpack( data, i, j, k, reinterpret_cast<const TYPE2*>( buffer ) );
+    };
+    return field;
+}
+template<class TYPE>
+template<class TYPE1, class TYPE2, class... TYPES>
+void fillHalo<TYPE>::fill( Array<TYPE1>& array1, Array<TYPE2>& array2, Array<TYPES>&... arrays )
+{
+    std::vector<HaloField> fields = { field( array1 ), field( array2 ), field( arrays )... };
+    // Each array starts on a double boundary in the message
+    auto blockBytes = []( const HaloField& f, int N ) {
+        return sizeof(double)*( ( N*f.bytes + sizeof(double) - 1 ) / sizeof(double) );
+    };
+    // The neighbors we exchange with, the size of the messages and the offset of their send/recv buffers
+    std::vector<std::array<int,3>> neighbors;
+    std::vector<size_t> bytes;
+    std::vector<size_t> offset( 1, 0 );
+    for (int i=0; i<3; i++) {
+        for (int j=0; j<3; j++) {
+            for (int k=0; k<3; k++) {
+                if ( !fill_pattern[i][j][k] )
+                    continue;
+                size_t N_bytes = 0;
+                for (const auto& f : fields)
+                    N_bytes += blockBytes( f, N_send_recv[i][j][k] );
+                neighbors.push_back( { i, j, k } );
+                bytes.push_back( N_bytes );
+                offset.push_back( offset.back() + 2*N_bytes/sizeof(double) );
+            }
+        }
+    }
+    int N_neighbors = neighbors.size();
+    if ( mem_fields.size() < offset.back() )
+        mem_fields.resize( offset.back() );
+    auto sendBuffer = [&]( int m ) { return reinterpret_cast<char*>( &mem_fields[offset[m]] ); };
+    auto recvBuffer = [&]( int m ) { return sendBuffer( m ) + bytes[m]; };
+    // Start the recieves
+    std::vector<MPI_Request> send_reqs( N_neighbors ), recv_reqs( N_neighbors );
+    for (int m=0; m<N_neighbors; m++) {
+        int i = neighbors[m][0], j = neighbors[m][1], k = neighbors[m][2];
+        recv_reqs[m] = comm.IrecvBytes( recvBuffer( m ), bytes[m],
+            info.rank[i][j][k], tag[2-i][2-j][2-k] );
+    }
+    // Pack the arrays one after the other in the message for each neighbor and start the sends
+    Utilities::parallelFor( N_neighbors, [&]( int m ) {
+        int i = neighbors[m][0], j = neighbors[m][1], k = neighbors[m][2];
+        char *buffer = sendBuffer( m );
+        for (const auto& f : fields) {
+            f.pack( i-1, j-1, k-1, buffer );
+            buffer += blockBytes( f, N_send_recv[i][j][k] );
+        }
+    } );
+    for (int m=0; m<N_neighbors; m++) {
+        int i = neighbors[m][0], j = neighbors[m][1], k = neighbors[m][2];
+        send_reqs[m] = comm.IsendBytes( sendBuffer( m ), bytes[m],
+            info.rank[i][j][k], tag[i][j][k] );
+    }
+    // Recv and unpack the arrays
+    comm.waitAll( N_neighbors, recv_reqs.data() );
+    Utilities::parallelFor( N_neighbors, [&]( int m ) {
+        int i = neighbors[m][0], j = neighbors[m][1], k = neighbors[m][2];
+        const char *buffer = recvBuffer( m );
+        for (const auto& f : fields) {
+            f.unpack( i-1, j-1, k-1, buffer );
+            buffer += blockBytes( f, N_send_recv[i][j][k] );
+        }
+    } );
+    // Wait until all sends have completed
+    comm.waitAll( N_neighbors, send_reqs.data() );
+}
+template<class TYPE>
+template<class TYPE2>
+void fillHalo<TYPE>::pack( const Array<TYPE2>& data, int i0, int j0, int k0, TYPE2 *buffer )
 {
     int depth2 = data.size(3);
     int ni = i0==0 ? n[0]:ng[0];
@@ -326,7 +411,8 @@ void fillHalo<TYPE>::pack( const Array<TYPE>& data, int i0, int j0, int k0, TYPE
     }
 }
 template<class TYPE>
-void fillHalo<TYPE>::unpack( Array<TYPE>& data, int i0, int j0, int k0, const TYPE *buffer )
+template<class TYPE2>
+void fillHalo<TYPE>::unpack( Array<TYPE2>& data, int i0, int j0, int k0, const TYPE2 *buffer )
 {
     int depth2 = data.size(3);
     int ni = i0==0 ? n[0]:ng[0];
@@ -24,6 +24,8 @@
 #include <time.h>
 #include <exception>      // std::exception
 #include <stdexcept>
+#include <algorithm>
+#include <cctype>
 
 #include "common/Domain.h"
 #include "common/Array.h"
@@ -640,6 +642,158 @@ void Domain::Decomp( const std::string& Filename )
     delete [] SegData;
 }
 
+/********************************************************
+ * Read the part of the image needed by this rank        *
+ ********************************************************/
+// Same labels as Decomp, but each rank reads the bounding box of its subdomain
+// (including the halo) from the global image with MPI-IO instead of having rank 0
+// read and scatter the full image.  The mixed reflection layers need planes that
+// belong to other ranks, so that layout falls back to Decomp
+void Domain::ReadSubdomain( const std::string& Filename )
+{
+	int64_t xStart=0, yStart=0, zStart=0;
+	int checkerSize;
+	bool USE_CHECKER = false;
+	inlet_layers_x = inlet_layers_y = inlet_layers_z = 0;
+	outlet_layers_x = outlet_layers_y = outlet_layers_z = 0;
+	inlet_layers_phase=1;
+	outlet_layers_phase=2;
+	auto size = database->getVector<int>( "n" );
+	auto SIZE = database->getVector<int>( "N" );
+	auto nproc = database->getVector<int>( "nproc" );
+	if (database->keyExists( "offset" )){
+		auto offset = database->getVector<int>( "offset" );
+		xStart = offset[0];
+		yStart = offset[1];
+		zStart = offset[2];
+	}
+	if (database->keyExists( "InletLayers" )){
+		auto InletCount = database->getVector<int>( "InletLayers" );
+		inlet_layers_x = InletCount[0];
+		inlet_layers_y = InletCount[1];
+		inlet_layers_z = InletCount[2];
+	}
+	if (database->keyExists( "OutletLayers" )){
+		auto OutletCount = database->getVector<int>( "OutletLayers" );
+		outlet_layers_x = OutletCount[0];
+		outlet_layers_y = OutletCount[1];
+		outlet_layers_z = OutletCount[2];
+	}
+	if (database->keyExists( "checkerSize" )){
+		checkerSize = database->getScalar<int>( "checkerSize" );
+		USE_CHECKER = true;
+	}
+	else {
+		checkerSize = SIZE[0];
+	}
+	if (database->keyExists( "InletLayersPhase" )){
+		inlet_layers_phase = database->getScalar<int>( "InletLayersPhase" );
+	}
+	if (database->keyExists( "OutletLayersPhase" )){
+		outlet_layers_phase = database->getScalar<int>( "OutletLayersPhase" );
+	}
+	if ( !USE_CHECKER && ( inlet_layers_z > 0 || outlet_layers_z > 0 ) ){
+		Decomp( Filename );
+		return;
+	}
+	auto ReadValues = database->getVector<int>( "ReadValues" );
+	auto WriteValues = database->getVector<int>( "WriteValues" );
+	auto ReadType = database->getScalar<std::string>( "ReadType" );
+	int nx = size[0];
+	int ny = size[1];
+	int nz = size[2];
+	int64_t global_Nx = SIZE[0];
+	int64_t global_Ny = SIZE[1];
+	int64_t global_Nz = SIZE[2];
+	int64_t z_transition_size = (nproc[2]*nz - (global_Nz - zStart))/2;
+	if (z_transition_size < 0) z_transition_size=0;
+
+	// global coordinates of the local sites (the halo is clamped to the image)
+	auto GlobalX = [&]( int64_t i ){ return std::min( std::max( xStart + iproc()*nx + i-1, xStart ), global_Nx-1 ); };
+	auto GlobalY = [&]( int64_t j ){ return std::min( std::max( yStart + jproc()*ny + j-1, yStart ), global_Ny-1 ); };
+	auto GlobalZ = [&]( int64_t k ){ return std::min( std::max( zStart + kproc()*nz + k-1 - z_transition_size, zStart ), global_Nz-1 ); };
+	int64_t x0 = GlobalX(0), y0 = GlobalY(0), z0 = GlobalZ(0);
+	int bx = GlobalX(nx+1) - x0 + 1;
+	int by = GlobalY(ny+1) - y0 + 1;
+	int bz = GlobalZ(nz+1) - z0 + 1;
+	size_t box_size = size_t(bx)*size_t(by)*size_t(bz);
+	std::vector<signed char> Box( box_size );
+	if (rank()==0) printf("Reading subdomains of %s \n",Filename.c_str());
+
+	int bytes = ( ReadType == "16bit" ) ? 2 : 1;
+	std::vector<short int> InputData( bytes == 2 ? box_size : 0 );
+	void *buffer = ( bytes == 2 ) ? (void*) InputData.data() : (void*) Box.data();
+#ifdef USE_MPI
+	MPI_Datatype etype = ( bytes == 2 ) ? MPI_SHORT : MPI_SIGNED_CHAR;
+	MPI_File fh;
+	int err = MPI_File_open( Comm.getCommunicator(), Filename.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &fh );
+	INSIST( err == MPI_SUCCESS, "ReadSubdomain: failed to open " + Filename );
+	int gsizes[3] = { (int) global_Nz, (int) global_Ny, (int) global_Nx };
+	int lsizes[3] = { bz, by, bx };
+	int starts[3] = { (int) z0, (int) y0, (int) x0 };
+	MPI_Datatype filetype;
+	MPI_Type_create_subarray( 3, gsizes, lsizes, starts, MPI_ORDER_C, etype, &filetype );
+	MPI_Type_commit( &filetype );
+	MPI_File_set_view( fh, 0, etype, filetype, "native", MPI_INFO_NULL );
+	MPI_File_read_all( fh, buffer, (int) box_size, etype, MPI_STATUS_IGNORE );
+	MPI_Type_free( &filetype );
+	MPI_File_close( &fh );
+#else
+	FILE *SEGDAT = fopen(Filename.c_str(),"rb");
+	INSIST( SEGDAT, "ReadSubdomain: failed to open " + Filename );
+	for (int k=0; k<bz; k++){
+		for (int j=0; j<by; j++){
+			fseek( SEGDAT, ((z0+k)*global_Ny*global_Nx + (y0+j)*global_Nx + x0)*bytes, SEEK_SET );
+			size_t ReadSeg = fread( (char*) buffer + (size_t(k)*by+j)*bx*bytes, bytes, bx, SEGDAT );
+			if (ReadSeg != size_t(bx)) printf("Domain.cpp: Error reading segmented data \n");
+		}
+	}
+	fclose(SEGDAT);
+#endif
+	if ( bytes == 2 ){
+		for (size_t n=0; n<box_size; n++)
+			Box[n] = char(InputData[n]);
+	}
+
+	// relabel (the first matching entry of ReadValues is used)
+	signed char NewValue[256];
+	for (int c=0; c<256; c++) NewValue[c] = (signed char) c;
+	for (int idx=int(ReadValues.size())-1; idx>=0; idx--)
+		NewValue[(unsigned char)(signed char) ReadValues[idx]] = WriteValues[idx];
+	// checkerboard inlet / outlet layers (applied in the same order as Decomp)
+	auto Checker = [checkerSize]( int64_t a, int64_t b, signed char phase ){
+		return (signed char)( ((a/checkerSize + b/checkerSize)%2 == 0) ? phase : 0 );
+	};
+	for (int k=0; k<bz; k++){
+		for (int j=0; j<by; j++){
+			for (int i=0; i<bx; i++){
+				int64_t x = x0+i, y = y0+j, z = z0+k;
+				size_t n = (size_t(k)*by+j)*bx+i;
+				signed char value = NewValue[(unsigned char) Box[n]];
+				if (USE_CHECKER){
+					if (x >= xStart && x < xStart+inlet_layers_x) value = Checker(y,z,2);
+					if (y >= yStart && y < yStart+inlet_layers_y) value = Checker(x,z,2);
+					if (z >= zStart && z < zStart+inlet_layers_z) value = Checker(x,y,inlet_layers_phase);
+					if (x >= xStart+nx*nproc[0]-outlet_layers_x && x < xStart+nx*nproc[0]) value = Checker(y,z,2);
+					if (y >= yStart+ny*nproc[1]-outlet_layers_y && y < yStart+ny*nproc[1]) value = Checker(x,z,2);
+					if (z >= zStart+nz*nproc[2]-outlet_layers_z && z < zStart+nz*nproc[2]) value = Checker(x,y,outlet_layers_phase);
+				}
+				Box[n] = value;
+			}
+		}
+	}
+	for (int k=0; k<nz+2; k++){
+		for (int j=0; j<ny+2; j++){
+			for (int i=0; i<nx+2; i++){
+				size_t n = (size_t(GlobalZ(k)-z0)*by + GlobalY(j)-y0)*bx + GlobalX(i)-x0;
+				id[k*(nx+2)*(ny+2) + j*(nx+2) + i] = Box[n];
+			}
+		}
+	}
+	Comm.barrier();
+	ComputePorosity();
+}
+
 void Domain::ComputePorosity(){
 	// Compute the porosity
 	double sum;
@@ -669,88 +823,123 @@ void Domain::AggregateLabels( const std::string& filename ){
 	int nx = Nx;
 	int ny = Ny;
 	int nz = Nz;
-	
-	int npx = nprocx();
-	int npy = nprocy();
-	int npz = nprocz();
-	
-	int ipx = iproc();
-	int ipy = jproc();
-	int ipz = kproc();		
-	
-	int nprocs = nprocx()*nprocy()*nprocz();
-		
-	int full_nx = npx*(nx-2);
-	int full_ny = npy*(ny-2);
-	int full_nz = npz*(nz-2);
-	int local_size = (nx-2)*(ny-2)*(nz-2);
-	long int full_size = long(full_nx)*long(full_ny)*long(full_nz);
-	
-	auto LocalID = new signed char [local_size];
-		
-	//printf("aggregate labels: local size=%i, global size = %i",local_size, full_size);
+	size_t local_size = size_t(nx-2)*size_t(ny-2)*size_t(nz-2);
+	std::vector<signed char> LocalID( local_size );
 	// assign the ID for the local sub-region
 	for (int k=1; k<nz-1; k++){
 		for (int j=1; j<ny-1; j++){
 			for (int i=1; i<nx-1; i++){
 				int n = k*nx*ny+j*nx+i;
-				signed char local_id_val = id[n]; 
-				LocalID[(k-1)*(nx-2)*(ny-2) + (j-1)*(nx-2) + i-1] = local_id_val;
+				LocalID[(k-1)*(nx-2)*(ny-2) + (j-1)*(nx-2) + i-1] = id[n];
 			}
 		}
 	}
-	Comm.barrier();
+	WriteGlobalRaw( filename, LocalID.data() );
+}
 
-	// populate the FullID 
-	if (rank() == 0){
-		auto FullID = new signed char [full_size];
-		// first handle local ID for rank 0
-		for (int k=1; k<nz-1; k++){
-			for (int j=1; j<ny-1; j++){
-				for (int i=1; i<nx-1; i++){
-					int x = i-1;
-					int y = j-1;
-					int z = k-1;
-					int n_local = (k-1)*(nx-2)*(ny-2) + (j-1)*(nx-2) + i-1;
-					int n_full = z*full_nx*full_ny + y*full_nx + x;
-					FullID[n_full] = LocalID[n_local];
-				}
-			}
-		}
-		// next get the local ID from the other ranks
-		for (int rnk = 1; rnk<nprocs; rnk++){
-			ipz = rnk / (npx*npy);
-			ipy = (rnk - ipz*npx*npy) / npx;
-			ipx = (rnk - ipz*npx*npy - ipy*npx); 
-			//printf("ipx=%i ipy=%i ipz=%i\n", ipx, ipy, ipz);
-			int tag = 15+rnk;
-			Comm.recv(LocalID,local_size,rnk,tag);
-			for (int k=1; k<nz-1; k++){
-				for (int j=1; j<ny-1; j++){
-					for (int i=1; i<nx-1; i++){
-						int x = i-1 + ipx*(nx-2);
-						int y = j-1 + ipy*(ny-2);
-						int z = k-1 + ipz*(nz-2);
-						int n_local = (k-1)*(nx-2)*(ny-2) + (j-1)*(nx-2) + i-1;
-						int n_full = z*full_nx*full_ny + y*full_nx + x;
-						FullID[n_full] = LocalID[n_local];
+/********************************************************
+ * Write the interior of each subdomain to a global file *
+ ********************************************************/
+// Each rank writes its own hyperslab of the global raw file using MPI-IO.
+// With aggregate_io = "plane" the ranks that share a z-plane of the process
+// grid first gather to the plane leader, which writes its contiguous slab
+// (fewer writers for filesystems that dislike many small requests)
+#ifdef USE_MPI
+template<class TYPE> static MPI_Datatype getRawType();
+template<> MPI_Datatype getRawType<signed char>() { return MPI_SIGNED_CHAR; }
+template<> MPI_Datatype getRawType<float>() { return MPI_FLOAT; }
+template<> MPI_Datatype getRawType<double>() { return MPI_DOUBLE; }
+#endif
+template<class TYPE>
+void Domain::WriteGlobalRaw( const std::string& filename, const TYPE *LocalData ){
+
+	int nx = Nx-2;
+	int ny = Ny-2;
+	int nz = Nz-2;
+	int full_nx = nprocx()*nx;
+	int full_ny = nprocy()*ny;
+	int full_nz = nprocz()*nz;
+	size_t local_size = size_t(nx)*size_t(ny)*size_t(nz);
+	size_t full_size = size_t(full_nx)*size_t(full_ny)*size_t(full_nz);
+	std::string mode = "collective";
+	if (d_db && d_db->keyExists( "aggregate_io" )){
+		mode = d_db->getScalar<std::string>( "aggregate_io" );
+	}
+	INSIST( mode == "collective" || mode == "plane", "aggregate_io must be collective or plane" );
+#ifdef USE_MPI
+	MPI_Datatype etype = getRawType<TYPE>();
+	MPI_File fh;
+	int err = MPI_File_open( Comm.getCommunicator(), filename.c_str(), MPI_MODE_WRONLY | MPI_MODE_CREATE,
+	                         MPI_INFO_NULL, &fh );
+	INSIST( err == MPI_SUCCESS, "AggregateLabels: failed to open " + filename );
+	// the write errors are reduced after the collective calls, so all ranks fail together
+	int write_err = MPI_File_set_size( fh, full_size*sizeof(TYPE) );
+	if ( mode == "collective" ){
+		int gsizes[3] = { full_nz, full_ny, full_nx };
+		int lsizes[3] = { nz, ny, nx };
+		int starts[3] = { kproc()*nz, jproc()*ny, iproc()*nx };
+		MPI_Datatype filetype;
+		MPI_Type_create_subarray( 3, gsizes, lsizes, starts, MPI_ORDER_C, etype, &filetype );
+		MPI_Type_commit( &filetype );
+		MPI_File_set_view( fh, 0, etype, filetype, "native", MPI_INFO_NULL );
+		err = MPI_File_write_all( fh, LocalData, (int) local_size, etype, MPI_STATUS_IGNORE );
+		if ( err != MPI_SUCCESS ) write_err = err;
+		MPI_Type_free( &filetype );
+	}
+	else {
+		// gather the z-slab on the first rank of each plane of the process grid
+		auto PlaneComm = Comm.split( kproc(), rank() );
+		int plane_size = PlaneComm.getSize();
+		int plane_rank = PlaneComm.getRank();
+		auto ipxy = PlaneComm.allGather( iproc() + nprocx()*jproc() );
+		std::vector<TYPE> Slab;
+		int count = 0;
+		if ( plane_rank == 0 ){
+			std::vector<TYPE> Recv( local_size*plane_size );
+			std::vector<MPI_Request> request( plane_size-1 );
+			for (int p=1; p<plane_size; p++)
+				request[p-1] = PlaneComm.Irecv( &Recv[p*local_size], (int) local_size, p, 27 );
+			std::copy( LocalData, LocalData+local_size, Recv.begin() );
+			if ( plane_size > 1 )
+				Utilities::MPI::waitAll( plane_size-1, request.data() );
+			Slab.resize( size_t(full_nx)*size_t(full_ny)*size_t(nz) );
+			for (int p=0; p<plane_size; p++){
+				int ipx = ipxy[p] % nprocx();
+				int ipy = ipxy[p] / nprocx();
+				for (int k=0; k<nz; k++){
+					for (int j=0; j<ny; j++){
+						size_t n_full = k*size_t(full_nx)*size_t(full_ny) + size_t(j+ipy*ny)*full_nx + ipx*nx;
+						const TYPE *src = &Recv[p*local_size + (k*size_t(ny)+j)*nx];
+						std::copy( src, src+nx, &Slab[n_full] );
 					}
 				}
 			}
+			count = nz;
 		}
-		// write the output
-		FILE *OUTFILE = fopen(filename.c_str(),"wb");
-		fwrite(FullID,1,full_size,OUTFILE);
-		fclose(OUTFILE);
-        delete [] FullID;
-	}
-	else{
-		// send LocalID to rank=0
-		int tag = 15+ rank();
-		int dstrank = 0;
-		Comm.send(LocalID,local_size,dstrank,tag);
+		else {
+			PlaneComm.send( LocalData, (int) local_size, 0, 27 );
+		}
+		// each slab is contiguous in the file, write one xy-plane per element to keep counts small
+		MPI_Datatype planetype;
+		MPI_Type_contiguous( full_nx*full_ny, etype, &planetype );
+		MPI_Type_commit( &planetype );
+		MPI_Offset offset = MPI_Offset(kproc())*nz*full_nx*MPI_Offset(full_ny)*sizeof(TYPE);
+		err = MPI_File_write_at_all( fh, offset, Slab.data(), count, planetype, MPI_STATUS_IGNORE );
+		if ( err != MPI_SUCCESS ) write_err = err;
+		MPI_Type_free( &planetype );
 	}
-    delete [] LocalID;
+	err = MPI_File_close( &fh );
+	if ( err != MPI_SUCCESS ) write_err = err;
+	int failed = Comm.sumReduce( write_err != MPI_SUCCESS ? 1 : 0 );
+	INSIST( failed == 0, "AggregateLabels: failed to write " + filename );
+#else
+	NULL_USE( local_size );
+	FILE *OUTFILE = fopen(filename.c_str(),"wb");
+	INSIST( OUTFILE, "AggregateLabels: failed to open " + filename );
+	size_t count = fwrite(LocalData,sizeof(TYPE),full_size,OUTFILE);
+	fclose(OUTFILE);
+	INSIST( count == full_size, "AggregateLabels: failed to write " + filename );
+#endif
 	Comm.barrier();
 }
 
@@ -1068,118 +1257,51 @@ int Domain::PoreCount(){
 
 void Domain::CommunicateMeshHalo(DoubleArray &Mesh)
 {
-	int sendtag, recvtag;
-	sendtag = recvtag = 7;
-	double *MeshData = Mesh.data();
-	// send buffers
-	auto sendData_x = new double [sendCount("x")];
-	auto sendData_y = new double [sendCount("y")];
-	auto sendData_z = new double [sendCount("z")];
-	auto sendData_X = new double [sendCount("X")];
-	auto sendData_Y = new double [sendCount("Y")];
-	auto sendData_Z = new double [sendCount("Z")];
-	auto sendData_xy = new double [sendCount("xy")];
-	auto sendData_yz = new double [sendCount("yz")];
-	auto sendData_xz = new double [sendCount("xz")];
-	auto sendData_Xy = new double [sendCount("Xy")];
-	auto sendData_Yz = new double [sendCount("Yz")];
-	auto sendData_xZ = new double [sendCount("xZ")];
-	auto sendData_xY = new double [sendCount("xY")];
-	auto sendData_yZ = new double [sendCount("yZ")];
-	auto sendData_Xz = new double [sendCount("Xz")];
-	auto sendData_XY = new double [sendCount("XY")];
-	auto sendData_YZ = new double [sendCount("YZ")];
-	auto sendData_XZ = new double [sendCount("XZ")];
-	// recv buffers
-	auto recvData_x = new double [recvCount("x")];
-	auto recvData_y = new double [recvCount("y")];
-	auto recvData_z = new double [recvCount("z")];
-	auto recvData_X = new double [recvCount("X")];
-	auto recvData_Y = new double [recvCount("Y")];
-	auto recvData_Z = new double [recvCount("Z")];
-	auto recvData_xy = new double [recvCount("xy")];
-	auto recvData_yz = new double [recvCount("yz")];
-	auto recvData_xz = new double [recvCount("xz")];
-	auto recvData_Xy = new double [recvCount("Xy")];
-	auto recvData_xZ = new double [recvCount("xZ")];
-	auto recvData_xY = new double [recvCount("xY")];
-	auto recvData_yZ = new double [recvCount("yZ")];
-	auto recvData_Yz = new double [recvCount("Yz")];
-	auto recvData_Xz = new double [recvCount("Xz")];
-	auto recvData_XY = new double [recvCount("XY")];
-	auto recvData_YZ = new double [recvCount("YZ")];
-	auto recvData_XZ = new double [recvCount("XZ")];
+	CommunicateMeshHalo( std::vector<DoubleArray*>( 1, &Mesh ) );
+}
+
+void Domain::CommunicateMeshHalo(const std::vector<DoubleArray*> &Mesh)
+{
+	// The message for each neighbor carries the halo of all of the arrays
+	const char *dir[18] = { "x", "X", "y", "Y", "z", "Z", "xy", "XY", "xY", "Xy",
+			"xz", "XZ", "xZ", "Xz", "yz", "YZ", "yZ", "Yz" };
+	// data sent to dir[d] is received from the neighbor in the opposite direction
+	const int opposite[18] = { 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14, 17, 16 };
+	auto neighbor = [this]( const char *d ){
+		int ijk[3] = { 1, 1, 1 };
+		for (; *d; d++){
+			int m = tolower(*d) - 'x';
+			ijk[m] = isupper(*d) ? 2 : 0;
+		}
+		return rank_info.rank[ijk[0]][ijk[1]][ijk[2]];
+	};
+	const int nmesh = Mesh.size();
+	std::vector<size_t> sendOffset( 19, 0 ), recvOffset( 19, 0 );
+	for (int d=0; d<18; d++){
+		sendOffset[d+1] = sendOffset[d] + nmesh*sendCount(dir[d]);
+		recvOffset[d+1] = recvOffset[d] + nmesh*recvCount(dir[d]);
+	}
+	std::vector<double> sendData( sendOffset[18] ), recvData( recvOffset[18] );
+	std::vector<MPI_Request> req1( 18 ), req2( 18 );
+	int tag = 7;
+	for (int d=0; d<18; d++){
+		int r = opposite[d];
+		req2[r] = Comm.Irecv( &recvData[recvOffset[r]], nmesh*recvCount(dir[r]), neighbor(dir[r]), tag+d );
+	}
 	// Pack data
-	PackMeshData(sendList("x"), sendCount("x"), sendData_x, MeshData);
-	PackMeshData(sendList("X"), sendCount("X"), sendData_X, MeshData);
-	PackMeshData(sendList("y"), sendCount("y"), sendData_y, MeshData);
-	PackMeshData(sendList("Y"), sendCount("Y"), sendData_Y, MeshData);
-	PackMeshData(sendList("z"), sendCount("z"), sendData_z, MeshData);
-	PackMeshData(sendList("Z"), sendCount("Z"), sendData_Z, MeshData);
-	PackMeshData(sendList("xy"), sendCount("xy"), sendData_xy, MeshData);
-	PackMeshData(sendList("Xy"), sendCount("Xy"), sendData_Xy, MeshData);
-	PackMeshData(sendList("xY"), sendCount("xY"), sendData_xY, MeshData);
-	PackMeshData(sendList("XY"), sendCount("XY"), sendData_XY, MeshData);
-	PackMeshData(sendList("xz"), sendCount("xz"), sendData_xz, MeshData);
-	PackMeshData(sendList("Xz"), sendCount("Xz"), sendData_Xz, MeshData);
-	PackMeshData(sendList("xZ"), sendCount("xZ"), sendData_xZ, MeshData);
-	PackMeshData(sendList("XZ"), sendCount("XZ"), sendData_XZ, MeshData);
-	PackMeshData(sendList("yz"), sendCount("yz"), sendData_yz, MeshData);
-	PackMeshData(sendList("Yz"), sendCount("Yz"), sendData_Yz, MeshData);
-	PackMeshData(sendList("yZ"), sendCount("yZ"), sendData_yZ, MeshData);
-	PackMeshData(sendList("YZ"), sendCount("YZ"), sendData_YZ, MeshData);
-	// send/recv
-	Comm.sendrecv(sendData_x,sendCount("x"),rank_x(),sendtag,recvData_X,recvCount("X"),rank_X(),recvtag);
-	Comm.sendrecv(sendData_X,sendCount("X"),rank_X(),sendtag,recvData_x,recvCount("x"),rank_x(),recvtag);
-	Comm.sendrecv(sendData_y,sendCount("y"),rank_y(),sendtag,recvData_Y,recvCount("Y"),rank_Y(),recvtag);
-	Comm.sendrecv(sendData_Y,sendCount("Y"),rank_Y(),sendtag,recvData_y,recvCount("y"),rank_y(),recvtag);
-	Comm.sendrecv(sendData_z,sendCount("z"),rank_z(),sendtag,recvData_Z,recvCount("Z"),rank_Z(),recvtag);
-	Comm.sendrecv(sendData_Z,sendCount("Z"),rank_Z(),sendtag,recvData_z,recvCount("z"),rank_z(),recvtag);
-	Comm.sendrecv(sendData_xy,sendCount("xy"),rank_xy(),sendtag,recvData_XY,recvCount("XY"),rank_XY(),recvtag);
-	Comm.sendrecv(sendData_XY,sendCount("XY"),rank_XY(),sendtag,recvData_xy,recvCount("xy"),rank_xy(),recvtag);
-	Comm.sendrecv(sendData_Xy,sendCount("Xy"),rank_Xy(),sendtag,recvData_xY,recvCount("xY"),rank_xY(),recvtag);
-	Comm.sendrecv(sendData_xY,sendCount("xY"),rank_xY(),sendtag,recvData_Xy,recvCount("Xy"),rank_Xy(),recvtag);
-	Comm.sendrecv(sendData_xz,sendCount("xz"),rank_xz(),sendtag,recvData_XZ,recvCount("XZ"),rank_XZ(),recvtag);
-	Comm.sendrecv(sendData_XZ,sendCount("XZ"),rank_XZ(),sendtag,recvData_xz,recvCount("xz"),rank_xz(),recvtag);
-	Comm.sendrecv(sendData_Xz,sendCount("Xz"),rank_Xz(),sendtag,recvData_xZ,recvCount("xZ"),rank_xZ(),recvtag);
-	Comm.sendrecv(sendData_xZ,sendCount("xZ"),rank_xZ(),sendtag,recvData_Xz,recvCount("Xz"),rank_Xz(),recvtag);
-	Comm.sendrecv(sendData_yz,sendCount("yz"),rank_yz(),sendtag,recvData_YZ,recvCount("YZ"),rank_YZ(),recvtag);
-	Comm.sendrecv(sendData_YZ,sendCount("YZ"),rank_YZ(),sendtag,recvData_yz,recvCount("yz"),rank_yz(),recvtag);
-	Comm.sendrecv(sendData_Yz,sendCount("Yz"),rank_Yz(),sendtag,recvData_yZ,recvCount("yZ"),rank_yZ(),recvtag);
-	Comm.sendrecv(sendData_yZ,sendCount("yZ"),rank_yZ(),sendtag,recvData_Yz,recvCount("Yz"),rank_Yz(),recvtag);
+	Utilities::parallelFor( 18, [&]( int d ){
+		for (int m=0; m<nmesh; m++)
+			PackMeshData( sendList(dir[d]), sendCount(dir[d]), &sendData[sendOffset[d]+m*sendCount(dir[d])], Mesh[m]->data() );
+	} );
+	for (int d=0; d<18; d++)
+		req1[d] = Comm.Isend( &sendData[sendOffset[d]], nmesh*sendCount(dir[d]), neighbor(dir[d]), tag+d );
+	Comm.waitAll( 18, req2.data() );
 	// unpack data
-	UnpackMeshData(recvList("x"), recvCount("x") ,recvData_x, MeshData);
-	UnpackMeshData(recvList("X"), recvCount("X") ,recvData_X, MeshData);
-	UnpackMeshData(recvList("y"), recvCount("y") ,recvData_y, MeshData);
-	UnpackMeshData(recvList("Y"), recvCount("Y") ,recvData_Y, MeshData);
-	UnpackMeshData(recvList("z"), recvCount("z") ,recvData_z, MeshData);
-	UnpackMeshData(recvList("Z"), recvCount("Z") ,recvData_Z, MeshData);
-	UnpackMeshData(recvList("xy"), recvCount("xy") ,recvData_xy, MeshData);
-	UnpackMeshData(recvList("Xy"), recvCount("Xy") ,recvData_Xy, MeshData);
-	UnpackMeshData(recvList("xY"), recvCount("xY") ,recvData_xY, MeshData);
-	UnpackMeshData(recvList("XY"), recvCount("XY") ,recvData_XY, MeshData);
-	UnpackMeshData(recvList("xz"), recvCount("xz") ,recvData_xz, MeshData);
-	UnpackMeshData(recvList("Xz"), recvCount("Xz") ,recvData_Xz, MeshData);
-	UnpackMeshData(recvList("xZ"), recvCount("xZ") ,recvData_xZ, MeshData);
-	UnpackMeshData(recvList("XZ"), recvCount("XZ") ,recvData_XZ, MeshData);
-	UnpackMeshData(recvList("yz"), recvCount("yz") ,recvData_yz, MeshData);
-	UnpackMeshData(recvList("Yz"), recvCount("Yz") ,recvData_Yz, MeshData);
-	UnpackMeshData(recvList("yZ"), recvCount("yZ") ,recvData_yZ, MeshData);
-	UnpackMeshData(recvList("YZ"), recvCount("YZ") ,recvData_YZ, MeshData);
-	// Free sendData
-	delete [] sendData_x;   delete [] sendData_y;   delete [] sendData_z;
-	delete [] sendData_X;   delete [] sendData_Y;   delete [] sendData_Z;
-	delete [] sendData_xy;  delete [] sendData_xY;  delete [] sendData_Xy;
-	delete [] sendData_XY;  delete [] sendData_xz;  delete [] sendData_xZ;
-	delete [] sendData_Xz;  delete [] sendData_XZ;  delete [] sendData_yz;
-	delete [] sendData_yZ;  delete [] sendData_Yz;  delete [] sendData_YZ;
-	// Free recvData
-	delete [] recvData_x;   delete [] recvData_y;   delete [] recvData_z;
-	delete [] recvData_X;   delete [] recvData_Y;   delete [] recvData_Z;
-	delete [] recvData_xy;  delete [] recvData_xY;  delete [] recvData_Xy;
-	delete [] recvData_XY;  delete [] recvData_xz;  delete [] recvData_xZ;
-	delete [] recvData_Xz;  delete [] recvData_XZ;  delete [] recvData_yz;
-	delete [] recvData_yZ;  delete [] recvData_Yz;  delete [] recvData_YZ;
+	Utilities::parallelFor( 18, [&]( int d ){
+		for (int m=0; m<nmesh; m++)
+			UnpackMeshData( recvList(dir[d]), recvCount(dir[d]), &recvData[recvOffset[d]+m*recvCount(dir[d])], Mesh[m]->data() );
+	} );
+	Comm.waitAll( 18, req1.data() );
 }
 
 // Ideally stuff below here should be moved somewhere else -- doesn't really belong here
@@ -1378,95 +1500,33 @@ void Domain::ReadFromFile(const std::string& Filename,const std::string& Datatyp
 	Comm.barrier();
 }
 
-void Domain::AggregateLabels( const std::string& filename, DoubleArray &UserData ){
-	
-	int nx = Nx;
-	int ny = Ny;
-	int nz = Nz;
-	
-	int npx = nprocx();
-	int npy = nprocy();
-	int npz = nprocz();
-	
-	int ipx = iproc();
-	int ipy = jproc();
-	int ipz = kproc();		
-	
-	int nprocs = nprocx()*nprocy()*nprocz();
-		
-	int full_nx = npx*(nx-2);
-	int full_ny = npy*(ny-2);
-	int full_nz = npz*(nz-2);
-	int local_size = (nx-2)*(ny-2)*(nz-2);
-	unsigned long int full_size = long(full_nx)*long(full_ny)*long(full_nz);
-	
-	double *LocalID;
-	LocalID = new double [local_size];
-		
-	//printf("aggregate labels: local size=%i, global size = %i",local_size, full_size);
-	// assign the ID for the local sub-region
+// copy the interior of a field with 1 ghost cell
+template<class TYPE>
+static std::vector<TYPE> InteriorData( const Array<TYPE> &UserData ){
+	int nx = UserData.size(0);
+	int ny = UserData.size(1);
+	int nz = UserData.size(2);
+	size_t local_size = size_t(nx-2)*size_t(ny-2)*size_t(nz-2);
+	std::vector<TYPE> LocalData( local_size );
+	// assign the values for the local sub-region
 	for (int k=1; k<nz-1; k++){
 		for (int j=1; j<ny-1; j++){
 			for (int i=1; i<nx-1; i++){
-				double local_id_val = UserData(i,j,k); 
-				LocalID[(k-1)*(nx-2)*(ny-2) + (j-1)*(nx-2) + i-1] = local_id_val;
+				LocalData[(k-1)*(nx-2)*(ny-2) + (j-1)*(nx-2) + i-1] = UserData(i,j,k);
 			}
 		}
 	}
-	Comm.barrier();
+	return LocalData;
+}
 
-	// populate the FullID 
-	if (rank() == 0){
-		double *FullID;
-		FullID = new double [full_size];
-		// first handle local ID for rank 0
-		for (int k=1; k<nz-1; k++){
-			for (int j=1; j<ny-1; j++){
-				for (int i=1; i<nx-1; i++){
-					int x = i-1;
-					int y = j-1;
-					int z = k-1;
-					int n_local = (k-1)*(nx-2)*(ny-2) + (j-1)*(nx-2) + i-1;
-					unsigned long int n_full = z*long(full_nx)*long(full_ny) + y*long(full_nx) + x;
-					FullID[n_full] = LocalID[n_local];
-				}
-			}
-		}
-		// next get the local ID from the other ranks
-		for (int rnk = 1; rnk<nprocs; rnk++){
-			ipz = rnk / (npx*npy);
-			ipy = (rnk - ipz*npx*npy) / npx;
-			ipx = (rnk - ipz*npx*npy - ipy*npx); 
-			//printf("ipx=%i ipy=%i ipz=%i\n", ipx, ipy, ipz);
-			int tag = 15+rnk;
-			//MPI_Recv(LocalID,local_size,MPI_DOUBLE,rnk,tag,Comm,MPI_STATUS_IGNORE);
-			Comm.recv(LocalID,local_size,rnk,tag);
-
-			for (int k=1; k<nz-1; k++){
-				for (int j=1; j<ny-1; j++){
-					for (int i=1; i<nx-1; i++){
-						int x = i-1 + ipx*(nx-2);
-						int y = j-1 + ipy*(ny-2);
-						int z = k-1 + ipz*(nz-2);
-						int n_local = (k-1)*(nx-2)*(ny-2) + (j-1)*(nx-2) + i-1;
-						unsigned long int n_full = z*long(full_nx)*long(full_ny) + y*long(full_nx) + x;
-						FullID[n_full] = LocalID[n_local];
-					}
-				}
-			}
-		}
-		// write the output
-		FILE *OUTFILE = fopen(filename.c_str(),"wb");
-		fwrite(FullID,8,full_size,OUTFILE);
-		fclose(OUTFILE);
-	}
-	else{
-		// send LocalID to rank=0
-		int tag = 15+ rank();
-		int dstrank = 0;
-		//MPI_Send(LocalID,local_size,MPI_DOUBLE,dstrank,tag,Comm);
-		Comm.send(LocalID,local_size,dstrank,tag);
-	}
-	Comm.barrier();
+void Domain::AggregateLabels( const std::string& filename, DoubleArray &UserData ){
+	ASSERT( (int) UserData.size(0) == Nx && (int) UserData.size(1) == Ny && (int) UserData.size(2) == Nz );
+	auto LocalData = InteriorData( UserData );
+	WriteGlobalRaw( filename, LocalData.data() );
+}
 
+void Domain::AggregateLabels( const std::string& filename, Array<float> &UserData ){
+	ASSERT( (int) UserData.size(0) == Nx && (int) UserData.size(1) == Ny && (int) UserData.size(2) == Nz );
+	auto LocalData = InteriorData( UserData );
+	WriteGlobalRaw( filename, LocalData.data() );
 }
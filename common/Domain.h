@@ -184,19 +184,42 @@ public: // Public variables (need to create accessors instead)
     void ReadIDs();
     void ComputePorosity();
     void Decomp( const std::string& filename );
+    /**
+     * \brief  Read the labels of this subdomain directly from the global image
+     * \details  Gives the same id as Decomp, but every rank reads its own part of the
+     *    image (MPI-IO) and no ID.xxxxx files are written.
+     */
+    void ReadSubdomain( const std::string& filename );
     void CommunicateMeshHalo(DoubleArray &Mesh);
+    /**
+     * \brief  Fill the halo of several arrays
+     * \details  The arrays are exchanged together with one message per neighbor,
+     *    packing and unpacking with Utilities::parallelFor.
+     */
+    void CommunicateMeshHalo(const std::vector<DoubleArray*> &Mesh);
+    template<class... ARRAYS>
+    void CommunicateMeshHalo(DoubleArray &Mesh1, DoubleArray &Mesh2, ARRAYS&... Mesh) {
+        CommunicateMeshHalo( std::vector<DoubleArray*>{ &Mesh1, &Mesh2, &Mesh... } );
+    }
     void CommInit(); 
     int PoreCount();
     
     void ReadFromFile(const std::string& Filename,const std::string& Datatype, double *UserData);
+    /**
+     * \brief  Write the labels of the full domain to a single raw file
+     * \details  Each rank writes its own hyperslab using MPI-IO. Setting aggregate_io = "plane"
+     *    in the Domain database gathers each z-plane of the process grid on one writer first.
+     */
     void AggregateLabels( const std::string& filename );
     void AggregateLabels( const std::string& filename, DoubleArray &UserData );
+    void AggregateLabels( const std::string& filename, Array<float> &UserData );
 
 private:
 
     void PackID(int *list, int count, signed char *sendbuf, signed char *ID);
     void UnpackID(int *list, int count, signed char *recvbuf, signed char *ID);
     void CommHaloIDs();
+    template<class TYPE> void WriteGlobalRaw( const std::string& filename, const TYPE *LocalData );
     
 	//......................................................................................
 	MPI_Request req1[18], req2[18];
@@ -12,6 +12,7 @@
 #include <algorithm>
 #include <chrono>
 #include <climits>
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -2791,6 +2792,63 @@ MPI_Request MPI_CLASS::IrecvBytes(
 }
 
 
+/************************************************************************
+ *  Persistent communication                                             *
+ ************************************************************************/
+#ifdef USE_MPI
+MPI_Request MPI_CLASS::SendInitBytes(
+    const void *buf, const int number_bytes, const int recv_proc, const int tag ) const
+{
+    MPI_INSIST( tag <= d_maxTag, "Maximum tag value exceeded" );
+    MPI_INSIST( tag >= 0, "tag must be >= 0" );
+    MPI_Request request;
+    check_MPI( MPI_Send_init(
+        (void *) buf, number_bytes, MPI_CHAR, recv_proc, tag, communicator, &request ) );
+    return request;
+}
+MPI_Request MPI_CLASS::RecvInitBytes(
+    void *buf, const int number_bytes, const int send_proc, const int tag ) const
+{
+    MPI_INSIST( tag <= d_maxTag, "Maximum tag value exceeded" );
+    MPI_INSIST( tag >= 0, "tag must be >= 0" );
+    MPI_Request request;
+    check_MPI(
+        MPI_Recv_init( buf, number_bytes, MPI_CHAR, send_proc, tag, communicator, &request ) );
+    return request;
+}
+void MPI_CLASS::startAll( int count, MPI_Request *request )
+{
+    if ( count == 0 )
+        return;
+    PROFILE_START( "startAll", profile_level );
+    check_MPI( MPI_Startall( count, request ) );
+    PROFILE_STOP( "startAll", profile_level );
+}
+void MPI_CLASS::freeRequests( int count, MPI_Request *request )
+{
+    for ( int i = 0; i < count; i++ )
+        check_MPI( MPI_Request_free( &request[i] ) );
+}
+#else
+MPI_Request MPI_CLASS::SendInitBytes( const void *, const int, const int, const int ) const
+{
+    MPI_ERROR( "Persistent communication requires MPI" );
+    return MPI_Request();
+}
+MPI_Request MPI_CLASS::RecvInitBytes( void *, const int, const int, const int ) const
+{
+    MPI_ERROR( "Persistent communication requires MPI" );
+    return MPI_Request();
+}
+void MPI_CLASS::startAll( int count, MPI_Request * )
+{
+    if ( count > 0 )
+        MPI_ERROR( "Persistent communication requires MPI" );
+}
+void MPI_CLASS::freeRequests( int, MPI_Request * ) {}
+#endif
+
+
 /************************************************************************
  *  sendrecv                                                             *
  ************************************************************************/
@@ -3787,6 +3845,137 @@ void MPI_CLASS::stop_MPI()
 }
 
 
+/****************************************************************************
+ * Batched sum reduction                                                     *
+ ****************************************************************************/
+MPI::Accumulator::Accumulator( const MPI &comm )
+    : d_comm( comm ), d_request( 0 ), d_pending( false ), d_complete( false )
+{
+}
+MPI::Accumulator::~Accumulator()
+{
+    if ( d_pending )
+        finish();
+}
+int MPI::Accumulator::add( int length )
+{
+    MPI_INSIST( !d_pending, "Cannot add values while a reduction is pending" );
+    if ( d_complete )
+        clear();
+    int offset = static_cast<int>( d_send.size() );
+    d_send.resize( offset + length, 0.0 );
+    return offset;
+}
+void MPI::Accumulator::sum( double &result, double local )
+{
+    int offset     = add( 1 );
+    d_send[offset] = local;
+    d_entries.push_back( { offset, 1, &result, nullptr } );
+}
+void MPI::Accumulator::sum( int &result, int local )
+{
+    int offset     = add( 1 );
+    d_send[offset] = local;
+    d_entries.push_back( { offset, 1, nullptr, &result } );
+}
+void MPI::Accumulator::sum( double *result, const double *local, int n )
+{
+    int offset = add( n );
+    for ( int i = 0; i < n; i++ )
+        d_send[offset + i] = local[i];
+    d_entries.push_back( { offset, n, result, nullptr } );
+}
+void MPI::Accumulator::sum( const std::string &name, double local )
+{
+    int offset     = add( 1 );
+    d_send[offset] = local;
+    d_names[name]  = offset;
+}
+double MPI::Accumulator::get( const std::string &name ) const
+{
+    MPI_INSIST( d_complete, "The reduction has not completed" );
+    auto it = d_names.find( name );
+    MPI_INSIST( it != d_names.end(), "Unknown sum: " + name );
+    return d_recv[it->second];
+}
+void MPI::Accumulator::reduce()
+{
+    if ( d_pending ) {
+        finish();
+        return;
+    }
+    PROFILE_START( "Accumulator::reduce", profile_level );
+    int n = size();
+    d_recv.resize( n );
+#ifdef USE_MPI
+    if ( n > 0 )
+        MPI_Allreduce( d_send.data(), d_recv.data(), n, MPI_DOUBLE, MPI_SUM, d_comm.communicator );
+#else
+    d_recv = d_send;
+#endif
+    store();
+    PROFILE_STOP( "Accumulator::reduce", profile_level );
+}
+void MPI::Accumulator::start()
+{
+    MPI_INSIST( !d_pending, "A reduction is already pending" );
+#if defined( USE_MPI ) && MPI_VERSION >= 3
+    PROFILE_START( "Accumulator::start", profile_level );
+    int n = size();
+    d_recv.resize( n );
+    if ( n > 0 ) {
+        MPI_Iallreduce( d_send.data(), d_recv.data(), n, MPI_DOUBLE, MPI_SUM,
+            d_comm.communicator, &d_request );
+        d_pending = true;
+    } else {
+        store();
+    }
+    PROFILE_STOP( "Accumulator::start", profile_level );
+#else
+    // No nonblocking collectives, complete the sums now
+    reduce();
+#endif
+}
+void MPI::Accumulator::finish()
+{
+    if ( d_complete )
+        return;
+    if ( !d_pending ) {
+        reduce();
+        return;
+    }
+#ifdef USE_MPI
+    PROFILE_START( "Accumulator::finish", profile_level );
+    MPI_Status status;
+    MPI_Wait( &d_request, &status );
+    PROFILE_STOP( "Accumulator::finish", profile_level );
+#endif
+    d_pending = false;
+    store();
+}
+void MPI::Accumulator::store()
+{
+    for ( const auto &entry : d_entries ) {
+        for ( int i = 0; i < entry.length; i++ ) {
+            if ( entry.result )
+                entry.result[i] = d_recv[entry.offset + i];
+            else
+                entry.iresult[i] = static_cast<int>( std::lround( d_recv[entry.offset + i] ) );
+        }
+    }
+    d_complete = true;
+}
+void MPI::Accumulator::clear()
+{
+    MPI_INSIST( !d_pending, "Cannot clear while a reduction is pending" );
+    d_send.clear();
+    d_recv.clear();
+    d_entries.clear();
+    d_names.clear();
+    d_complete = false;
+}
+
+
 /****************************************************************************
  * Function to perform load balancing                                        *
  ****************************************************************************/
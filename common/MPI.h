@@ -479,6 +479,10 @@ public: // Member functions
     void sumReduce( const type *x, type *y, const int n = 1 ) const;
 
 
+    //! Accumulate many sums and reduce them together (see MPI::Accumulator below)
+    class Accumulator;
+
+
     /**
      * \brief   Min Reduce
      * \details This function performs a min all reduce across all processor.
@@ -798,6 +802,37 @@ public: // Member functions
         void *buf, const int N_bytes, const int send_proc, const int tag ) const;
 
 
+    /*!
+     * @brief Create a persistent request to send an array of bytes.
+     * @details  This creates (but does not start) a send of N_bytes bytes to
+     *   recv_proc.  The request is started with startAll, completed with
+     *   waitAll and may be reused until it is released with freeRequests.
+     *   Note: persistent requests are only supported when using MPI.
+     *
+     * @param buf       Void pointer to an array of number_bytes bytes to send.
+     * @param N_bytes   Integer number of bytes to send.
+     * @param recv_proc Receiving processor number.
+     * @param tag       Integer argument specifying an integer tag
+     *                  to be sent with this message.
+     */
+    MPI_Request SendInitBytes(
+        const void *buf, const int N_bytes, const int recv_proc, const int tag ) const;
+
+
+    /*!
+     * @brief Create a persistent request to receive an array of bytes.
+     * @details  The matching receive for SendInitBytes (see SendInitBytes).
+     *
+     * @param buf       Void pointer to a buffer of size number_bytes bytes.
+     * @param N_bytes   Integer number specifying size of buf in bytes.
+     * @param send_proc Processor number of sender.
+     * @param tag       Integer argument specifying a tag which must
+     *                  be matched by the tag of the incoming message.
+     */
+    MPI_Request RecvInitBytes(
+        void *buf, const int N_bytes, const int send_proc, const int tag ) const;
+
+
     /*!
      * @brief This function sends and recieves data using a blocking call
      */
@@ -975,6 +1010,27 @@ public: // Member functions
     static void waitAll( int count, MPI_Request *request );
 
 
+    /*!
+     * \brief   Start persistent communications.
+     * \details This function starts the given persistent requests
+     *    (created with SendInitBytes or RecvInitBytes).
+     *    Note: this does not require a communicator.
+     * \param count      Number of communications to start
+     * \param request    Array of persistent communication requests
+     */
+    static void startAll( int count, MPI_Request *request );
+
+
+    /*!
+     * \brief   Free persistent communications.
+     * \details This function releases the given (inactive) persistent requests.
+     *    Note: this does not require a communicator.
+     * \param count      Number of communications to free
+     * \param request    Array of persistent communication requests
+     */
+    static void freeRequests( int count, MPI_Request *request );
+
+
     /*!
      * \brief   Wait for some communications to finish.
      * \details This function waits for one (or more) communications to finish.
@@ -1158,6 +1214,101 @@ private: // data members
 };
 
 
+/**
+ * \class MPI::Accumulator
+ *
+ * @brief Batched sum reduction.
+ *
+ * The accumulator collects the local contributions to many sums (scalars and arrays)
+ * and completes them with a single allreduce instead of one allreduce per value.
+ * The local values are copied when they are added, and the results are written to the
+ * given locations when the reduction completes.  reduce() completes the sums immediately;
+ * start() posts a nonblocking allreduce (MPI-3) so that local work can be done before
+ * finish() writes the results.  All processors must add the same sequence of values.
+ * Example:
+ *    Utilities::MPI::Accumulator sums( comm );
+ *    sums.sum( gV, V );
+ *    sums.sum( gA, A );
+ *    sums.reduce();
+ */
+class MPI::Accumulator final
+{
+public:
+    //! Create an accumulator for the given communicator
+    explicit Accumulator( const MPI &comm );
+
+    //! Destructor (completes any pending reduction)
+    ~Accumulator();
+
+    Accumulator( const Accumulator & ) = delete;
+    Accumulator &operator=( const Accumulator & ) = delete;
+
+    /**
+     * \brief   Add a sum
+     * \details Queue the local value, the global sum is written to result
+     *    when the reduction completes.  result must remain valid until then.
+     * \param result  The global sum
+     * \param local   The local value
+     */
+    void sum( double &result, double local );
+
+    //! Add a sum of integers (exact up to 2^53)
+    void sum( int &result, int local );
+
+    /**
+     * \brief   Add an array sum
+     * \details Queue the element-wise sum of an array
+     * \param result  The global sums (n values)
+     * \param local   The local values (n values)
+     * \param n       The number of values
+     */
+    void sum( double *result, const double *local, int n );
+
+    //! Add a named sum, the result is returned by get(name)
+    void sum( const std::string &name, double local );
+
+    //! Return the named sum (after the reduction completed)
+    double get( const std::string &name ) const;
+
+    //! Complete all sums with one blocking allreduce
+    void reduce();
+
+    //! Start a nonblocking allreduce of all sums
+    void start();
+
+    //! Wait for the reduction posted by start() and write the results
+    void finish();
+
+    //! Is a reduction posted by start() pending
+    bool pending() const { return d_pending; }
+
+    //! The number of values in the accumulator
+    int size() const { return static_cast<int>( d_send.size() ); }
+
+    //! Remove all values (a completed accumulator is cleared by the next sum)
+    void clear();
+
+private:
+    struct Entry {
+        int offset;
+        int length;
+        double *result;
+        int *iresult;
+    };
+    int add( int length );
+    void store();
+
+    MPI d_comm;
+    std::vector<double> d_send;
+    std::vector<double> d_recv;
+    std::vector<Entry> d_entries;
+    std::map<std::string, int> d_names;
+    MPI_Request d_request;
+    bool d_pending;
+    bool d_complete;
+};
+
+
 } // namespace Utilities
 
 
@@ -0,0 +1,225 @@
+/*
+  Copyright Equnior ASA
+
+  This file is part of the Open Porous Media project (OPM).
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/* Memory accounting for the allocations of the ScaLBL device API
+ *  The backends (cpu/cuda/hip Extras) call ScaLBL_RecordAllocation and ScaLBL_RecordFree,
+ *  the bytes are kept for each tag so that a model can report what it allocated
+ */
+#include "common/ScaLBL.h"
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+
+
+namespace {
+
+struct TagUsage {
+	size_t current = 0;
+	size_t peak = 0;
+};
+
+struct MemoryTracker {
+	std::mutex lock;
+	std::map<void*, std::pair<size_t,std::string>> allocations;
+	std::map<std::string, TagUsage> tags;
+	TagUsage total;
+};
+
+MemoryTracker& getTracker(){
+	static MemoryTracker tracker;
+	return tracker;
+}
+
+// tag of the allocations of this thread
+thread_local std::string current_tag = "other";
+
+}
+
+
+extern "C" void ScaLBL_RecordAllocation(void* address, size_t size){
+	if (address == NULL) return;
+	auto &tracker = getTracker();
+	std::lock_guard<std::mutex> guard( tracker.lock );
+	tracker.allocations[address] = std::make_pair( size, current_tag );
+	auto &tag = tracker.tags[current_tag];
+	tag.current += size;
+	tag.peak = std::max( tag.peak, tag.current );
+	tracker.total.current += size;
+	tracker.total.peak = std::max( tracker.total.peak, tracker.total.current );
+}
+
+extern "C" void ScaLBL_RecordFree(void* address){
+	if (address == NULL) return;
+	auto &tracker = getTracker();
+	std::lock_guard<std::mutex> guard( tracker.lock );
+	auto it = tracker.allocations.find( address );
+	if (it == tracker.allocations.end()) return;
+	tracker.tags[it->second.second].current -= it->second.first;
+	tracker.total.current -= it->second.first;
+	tracker.allocations.erase( it );
+}
+
+void ScaLBL_AllocateDeviceMemory(void** address, size_t size, const char *name){
+	ScaLBL_MemoryTag tag( name );
+	ScaLBL_AllocateDeviceMemory( address, size );
+}
+
+ScaLBL_MemoryTag::ScaLBL_MemoryTag(const std::string &name): previous(current_tag){
+	current_tag = name;
+}
+
+ScaLBL_MemoryTag::~ScaLBL_MemoryTag(){
+	current_tag = previous;
+}
+
+std::vector<ScaLBL_MemoryUsage> ScaLBL_GetMemoryUsage(){
+	auto &tracker = getTracker();
+	std::lock_guard<std::mutex> guard( tracker.lock );
+	std::vector<ScaLBL_MemoryUsage> usage;
+	for (const auto &tag : tracker.tags)
+		usage.push_back( { tag.first, tag.second.current, tag.second.peak } );
+	usage.push_back( { "total", tracker.total.current, tracker.total.peak } );
+	return usage;
+}
+
+
+/********************************************************
+ * Footprint of a model without allocating              *
+ ********************************************************/
+// Buffers allocated by the constructor of ScaLBL_Communicator
+static size_t CommunicatorBytes( const std::vector<size_t> &sendCount, const std::vector<size_t> &recvCount ){
+	INSIST( sendCount.size() == 18 && recvCount.size() == 18, "ScaLBL_PredictMemory: 18 send and recieve counts are required" );
+	size_t bytes = 0;
+	for (int d=0; d<18; d++){
+		// faces carry 5 distributions (twice for the D3Q7 pairs), edges one
+		size_t q = (d < 6) ? 5 : 1;
+		bytes += 2*q*(sendCount[d] + recvCount[d])*sizeof(double);
+		bytes += (sendCount[d] + recvCount[d] + q*recvCount[d])*sizeof(int);
+	}
+	return bytes;
+}
+
+std::vector<ScaLBL_MemoryUsage> ScaLBL_PredictMemory(const std::string &model, size_t Np, size_t N,
+		const std::vector<size_t> &sendCount, const std::vector<size_t> &recvCount){
+	const size_t dist = Np*sizeof(double);
+	const size_t grid = N*sizeof(double);
+	const size_t neighbors = 18*Np*sizeof(int);
+	const size_t map = Np*sizeof(int);
+	const size_t comm = CommunicatorBytes( sendCount, recvCount );
+	// arrays in the order of the Create() of each model
+	std::vector<std::pair<std::string,size_t>> arrays;
+	if (model == "mrt"){
+		arrays = { {"NeighborList",neighbors}, {"fq",19*dist}, {"Pressure",dist}, {"Velocity",3*dist},
+				{"FlowStats",SCALBL_MRT_STATS*sizeof(double)}, {"comm buffers",comm} };
+	}
+	else if (model == "nonnewtonian"){
+		arrays = { {"NeighborList",neighbors}, {"fq",19*dist}, {"Viscosity",dist}, {"Velocity",3*dist},
+				{"FlowStats",SCALBL_NONNEWTONIAN_STATS*sizeof(double)}, {"comm buffers",comm} };
+	}
+	else if (model == "color"){
+		arrays = { {"NeighborList",neighbors}, {"dvcMap",map}, {"fq",19*dist}, {"Aq",7*dist}, {"Bq",7*dist},
+				{"Den",2*dist}, {"Phi",grid}, {"Pressure",dist}, {"Velocity",3*dist}, {"ColorGrad",3*dist},
+				{"comm buffers",2*comm} };
+	}
+	else if (model == "freelee"){
+		// the phase field is on the grid with the wide halo, its buffers are not included
+		arrays = { {"NeighborList",neighbors}, {"dvcMap",map}, {"gqbar",19*dist}, {"hq",7*dist}, {"mu_phi",dist},
+				{"Den",dist}, {"Phi",grid}, {"Pressure",dist}, {"Velocity",3*dist}, {"ColorGrad",3*dist},
+				{"comm buffers",comm} };
+	}
+	else if (model == "greyscale"){
+		arrays = { {"NeighborList",neighbors}, {"fq",19*dist}, {"Permeability",dist}, {"Porosity",dist},
+				{"Pressure_dvc",dist}, {"Velocity",3*dist}, {"comm buffers",comm} };
+	}
+	else if (model == "ion"){
+		// one ion species
+		arrays = { {"NeighborList",neighbors}, {"fq",7*dist}, {"Ci",dist}, {"ChargeDensity",dist},
+				{"IonSolid",grid}, {"comm buffers",comm} };
+	}
+	else if (model == "poisson"){
+		arrays = { {"NeighborList",neighbors}, {"dvcMap",map}, {"fq",7*dist}, {"Psi",grid},
+				{"ElectricField",3*dist}, {"comm buffers",2*comm} };
+	}
+	else {
+		ERROR( "ScaLBL_PredictMemory: no footprint for model " + model );
+	}
+	std::vector<ScaLBL_MemoryUsage> usage;
+	size_t total = 0;
+	for (const auto &array : arrays){
+		usage.push_back( { array.first, array.second, array.second } );
+		total += array.second;
+	}
+	usage.push_back( { "total", total, total } );
+	return usage;
+}
+
+std::vector<ScaLBL_MemoryUsage> ScaLBL_PredictMemory(const std::string &model, const Domain &Dm, size_t Np){
+	const char *dir[18] = { "x", "X", "y", "Y", "z", "Z", "xy", "XY", "xY", "Xy",
+			"xz", "XZ", "xZ", "Xz", "yz", "YZ", "yZ", "Yz" };
+	std::vector<size_t> sendCount( 18 ), recvCount( 18 );
+	for (int d=0; d<18; d++){
+		sendCount[d] = Dm.sendCount( dir[d] );
+		recvCount[d] = Dm.recvCount( dir[d] );
+	}
+	size_t N = (size_t) Dm.Nx*Dm.Ny*Dm.Nz;
+	return ScaLBL_PredictMemory( model, Np, N, sendCount, recvCount );
+}
+
+
+/********************************************************
+ * Report                                               *
+ ********************************************************/
+void ScaLBL_MemoryReport(const Utilities::MPI &comm, const std::string &title,
+		const std::vector<ScaLBL_MemoryUsage> &usage){
+	// the tags of all ranks, in the order of the first rank that has them
+	std::string local;
+	for (const auto &tag : usage)
+		if (tag.name != "total") local += tag.name + "\n";
+	std::vector<std::string> gathered( comm.getSize() );
+	comm.allGather( local, gathered.data() );
+	std::vector<std::string> names;
+	std::set<std::string> known;
+	for (const auto &list : gathered){
+		std::istringstream stream( list );
+		std::string name;
+		while (std::getline( stream, name ))
+			if (known.insert( name ).second) names.push_back( name );
+	}
+	names.push_back( "total" );
+	// current and peak of each tag, largest and sum over the ranks
+	const int n = names.size();
+	std::vector<double> values( 2*n, 0.0 ), largest( 2*n ), sum( 2*n );
+	for (int i=0; i<n; i++){
+		for (const auto &tag : usage){
+			if (tag.name == names[i]){
+				values[2*i] = tag.current;
+				values[2*i+1] = tag.peak;
+			}
+		}
+	}
+	comm.maxReduce( values.data(), largest.data(), 2*n );
+	comm.sumReduce( values.data(), sum.data(), 2*n );
+	if (comm.getRank() == 0){
+		const double MB = 1024.0*1024.0;
+		printf("Memory (%s, MB on %i ranks) \n", title.c_str(), comm.getSize());
+		printf("   %-20s %14s %14s %14s \n", "", "current/rank", "peak/rank", "current total");
+		for (int i=0; i<n; i++){
+			printf("   %-20s %14.2f %14.2f %14.2f \n", names[i].c_str(),
+					largest[2*i]/MB, largest[2*i+1]/MB, sum[2*i]/MB);
+		}
+	}
+}
@@ -16,15 +16,27 @@
 */
 #include "common/ScaLBL.h"
 
+#include <algorithm>
 #include <chrono>
+#include <sched.h>
 
 
 ScaLBL_Communicator::ScaLBL_Communicator(std::shared_ptr <Domain> Dm){
 	//......................................................................................
 	Lock=false; // unlock the communicator
 	//......................................................................................
+	ScaLBL_MemoryTag tag("comm buffers");	// the buffers and lists allocated below
 	// Create a separate copy of the communicator for the device
     MPI_COMM_SCALBL = Dm->Comm.dup();
+	InletPlane = false;
+	InletArea = 0.0;
+	HaloFlags = NULL;
+	HaloWindow = MPI_WIN_NULL;
+	for (int d=0; d<18; d++){
+		HaloShared[d] = false;
+		HaloStep[d] = 0;
+		HaloNeighborFlags[d] = NULL;
+	}
 	//......................................................................................
 	// Copy the domain size and communication information directly from Dm
 	Nx = Dm->Nx;
@@ -96,6 +108,23 @@ ScaLBL_Communicator::ScaLBL_Communicator(std::shared_ptr <Domain> Dm){
 	nprocz = Dm->nprocz();
 	BoundaryCondition = Dm->BoundaryCondition;
 	//......................................................................................
+	// Ordering used for the interior sites of the sparse layout
+	interior_ordering = "raster";
+	interior_tile[0] = 16; interior_tile[1] = 4; interior_tile[2] = 4;
+	auto domain_db = Dm->getDatabase();
+	if (domain_db && domain_db->keyExists( "interior_ordering" )){
+		interior_ordering = domain_db->getScalar<std::string>( "interior_ordering" );
+	}
+	if (domain_db && domain_db->keyExists( "interior_tile" )){
+		auto tile = domain_db->getVector<int>( "interior_tile" );
+		INSIST( tile.size() == 3, "interior_tile must have three entries" );
+		for (int d=0; d<3; d++) interior_tile[d] = tile[d];
+	}
+	INSIST( interior_ordering == "raster" || interior_ordering == "tile" ||
+			interior_ordering == "morton" || interior_ordering == "hilbert",
+			"interior_ordering must be raster, tile, morton or hilbert" );
+	INSIST( interior_tile[0] > 0 && interior_tile[1] > 0 && interior_tile[2] > 0, "interior_tile must be positive" );
+	//......................................................................................
 
 	ScaLBL_AllocateZeroCopy((void **) &sendbuf_x, 2*5*sendCount_x*sizeof(double));	// Allocate device memory
 	ScaLBL_AllocateZeroCopy((void **) &sendbuf_X, 2*5*sendCount_X*sizeof(double));	// Allocate device memory
@@ -321,12 +350,19 @@ ScaLBL_Communicator::ScaLBL_Communicator(std::shared_ptr <Domain> Dm){
 
 	CommunicationCount = SendCount+RecvCount;
 	//......................................................................................
+	// Exchange the halo with the neighbors on the same node through shared memory
+	if (domain_db && domain_db->keyExists( "halo_shared_memory" )){
+		if (domain_db->getScalar<bool>( "halo_shared_memory" ))
+			SetupSharedHalo();
+	}
+	//......................................................................................
 
 }
 
 
 ScaLBL_Communicator::~ScaLBL_Communicator()
 {
+	FreeSharedHalo();
 
 	ScaLBL_FreeDeviceMemory( sendbuf_x );
 	ScaLBL_FreeDeviceMemory( sendbuf_X );
@@ -419,10 +455,10 @@ ScaLBL_Communicator::~ScaLBL_Communicator()
 	ScaLBL_FreeDeviceMemory( dvcRecvDist_Yz );
 	ScaLBL_FreeDeviceMemory( dvcRecvDist_YZ );
 }
-double ScaLBL_Communicator::GetPerformance(int *NeighborList, double *fq, int Np){
+double ScaLBL_Communicator::GetPerformance(int *NeighborList, double *fq, int Np, int timesteps){
 	/* EACH MPI PROCESS GETS ITS OWN MEASUREMENT*/
 	/* use MRT kernels to check performance without communication / synchronization */
-	int TIMESTEPS=500;
+	int TIMESTEPS=timesteps;
 	double RLX_SETA=1.0;
 	double RLX_SETB = 8.f*(2.f-RLX_SETA)/(8.f-RLX_SETA);
 	double FX = 0.0;
@@ -457,6 +493,12 @@ int ScaLBL_Communicator::FirstInterior(){
 int ScaLBL_Communicator::LastInterior(){
 	return last_interior;
 }
+int ScaLBL_Communicator::ExteriorSplit(){
+	return exterior_split;
+}
+int ScaLBL_Communicator::InteriorSplit(){
+	return interior_split;
+}
 
 void ScaLBL_Communicator::D3Q19_MapRecv(int Cqx, int Cqy, int Cqz, const int *list,  int start, int count,
 		int *d3q19_recvlist){
@@ -489,7 +531,91 @@ void ScaLBL_Communicator::D3Q19_MapRecv(int Cqx, int Cqy, int Cqz, const int *li
 	delete [] ReturnDist;
 }
 
-int ScaLBL_Communicator::MemoryOptimizedLayoutAA(IntArray &Map, int *neighborList, signed char *id, int Np, int width){
+// Interleave the bits of (x,y,z) so that nearby sites have nearby keys
+static unsigned long long MortonKey(unsigned int x, unsigned int y, unsigned int z){
+	unsigned long long key = 0;
+	for (int b=0; b<21; b++){
+		key |= (unsigned long long)((x >> b) & 1) << (3*b);
+		key |= (unsigned long long)((y >> b) & 1) << (3*b+1);
+		key |= (unsigned long long)((z >> b) & 1) << (3*b+2);
+	}
+	return key;
+}
+
+// Position of (x,y,z) along the 3D Hilbert curve of order bits (Skilling, AIP Conf. Proc. 707, 2004)
+static unsigned long long HilbertKey(unsigned int x, unsigned int y, unsigned int z, int bits){
+	unsigned int X[3] = {x, y, z};
+	unsigned int M = 1u << (bits-1);
+	// inverse undo
+	for (unsigned int Q=M; Q>1; Q>>=1){
+		unsigned int P = Q-1;
+		for (int d=0; d<3; d++){
+			if (X[d] & Q) X[0] ^= P;
+			else {
+				unsigned int t = (X[0]^X[d]) & P;
+				X[0] ^= t; X[d] ^= t;
+			}
+		}
+	}
+	// Gray encode
+	for (int d=1; d<3; d++) X[d] ^= X[d-1];
+	unsigned int t = 0;
+	for (unsigned int Q=M; Q>1; Q>>=1){
+		if (X[2] & Q) t ^= Q-1;
+	}
+	for (int d=0; d<3; d++) X[d] ^= t;
+	// the transposed form interleaves into the index with x as the most significant bit
+	return MortonKey(X[2], X[1], X[0]);
+}
+
+void ScaLBL_Communicator::OrderInteriorSites(std::vector<int> &sites, int width){
+	/*
+	 * Reorder the interior sites (regular layout indices in raster order) so that sites that
+	 * are close in space are also close in memory. Only the interior is reordered, so the
+	 * exterior / interior split used to overlap communication with computation is preserved.
+	 */
+	if (interior_ordering == "raster" || sites.empty())
+		return;
+	int bits = 1;
+	while ((1 << bits) < std::max(Nx,std::max(Ny,Nz))) bits++;
+	std::vector<std::pair<unsigned long long,int>> keys(sites.size());
+	for (size_t s=0; s<sites.size(); s++){
+		int n = sites[s];
+		int kk = n/(Nx*Ny);
+		int jj = (n-kk*Nx*Ny)/Nx;
+		int ii = n-kk*Nx*Ny-jj*Nx;
+		unsigned int x = ii-width-1;
+		unsigned int y = jj-width-1;
+		unsigned int z = kk-width-1;
+		unsigned long long key;
+		if (interior_ordering == "tile"){
+			// tile-major: tiles in raster order, raster order within each tile
+			unsigned long long ntx = (Nx+interior_tile[0]-1)/interior_tile[0];
+			unsigned long long nty = (Ny+interior_tile[1]-1)/interior_tile[1];
+			unsigned long long tile = ((z/interior_tile[2])*nty + y/interior_tile[1])*ntx + x/interior_tile[0];
+			key = tile*N + n;
+		}
+		else if (interior_ordering == "morton")
+			key = MortonKey(x,y,z);
+		else
+			key = HilbertKey(x,y,z,bits);
+		keys[s] = std::make_pair(key,n);
+	}
+	std::sort(keys.begin(),keys.end());
+	for (size_t s=0; s<sites.size(); s++)
+		sites[s] = keys[s].second;
+}
+
+// Move the sites of class 0 to the front (keeping their order), returns the number of class 0 sites
+static size_t PartitionSites(std::vector<int> &sites, const signed char *site_class){
+	if (site_class == NULL)
+		return sites.size();
+	auto split = std::stable_partition(sites.begin(), sites.end(), [site_class](int n){ return site_class[n] == 0; });
+	return split - sites.begin();
+}
+
+int ScaLBL_Communicator::MemoryOptimizedLayoutAA(IntArray &Map, int *neighborList, signed char *id, int Np, int width,
+		const signed char *site_class){
 	/*
 	 * Generate a memory optimized layout
 	 *   id[n] == 0 implies that site n should be ignored (treat as a mask)
@@ -523,6 +649,7 @@ int ScaLBL_Communicator::MemoryOptimizedLayoutAA(IntArray &Map, int *neighborLis
 	// ********* Exterior **********
 	// Step 1/2: Index the outer walls of the grid only
 	idx=0;	next=0;
+	std::vector<int> exterior_sites;
 	for (k=1; k<Nz-1; k++){
 		for (j=1; j<Ny-1; j++){
 			for (i=1; i<Nx-1; i++){
@@ -532,16 +659,20 @@ int ScaLBL_Communicator::MemoryOptimizedLayoutAA(IntArray &Map, int *neighborLis
 				n = k*Nx*Ny+j*Nx+i;
 				if (id[n] > 0){
 					// Counts for the six faces
-					if (i>0 && i<=width)              Map(n)=idx++;
-					else if (j>0 && j<=width)         Map(n)=idx++;
-					else if (k>0 && k<=width) 		  Map(n)=idx++;
-					else if (i>Nx-width-2 && i<Nx-1)  Map(n)=idx++;
-					else if (j>Ny-width-2 && j<Ny-1)  Map(n)=idx++;
-					else if (k>Nz-width-2 && k<Nz-1)  Map(n)=idx++;
+					if (i>0 && i<=width)              exterior_sites.push_back(n);
+					else if (j>0 && j<=width)         exterior_sites.push_back(n);
+					else if (k>0 && k<=width) 		  exterior_sites.push_back(n);
+					else if (i>Nx-width-2 && i<Nx-1)  exterior_sites.push_back(n);
+					else if (j>Ny-width-2 && j<Ny-1)  exterior_sites.push_back(n);
+					else if (k>Nz-width-2 && k<Nz-1)  exterior_sites.push_back(n);
 				}
 			}
 		}
 	}
+	exterior_split = PartitionSites(exterior_sites, site_class);
+	for (size_t s=0; s<exterior_sites.size(); s++){
+		Map(exterior_sites[s]) = idx++;
+	}
 	next=idx;
 
 	// ********* Interior **********
@@ -549,18 +680,24 @@ int ScaLBL_Communicator::MemoryOptimizedLayoutAA(IntArray &Map, int *neighborLis
 	first_interior=(next/16 + 1)*16;
 	idx = first_interior;
 	// Step 2/2: Next loop over the domain interior in block-cyclic fashion
+	std::vector<int> interior_sites;
 	for (k=width+1; k<Nz-width-1; k++){
 		for (j=width+1; j<Ny-width-1; j++){
 			for (i=width+1; i<Nx-width-1; i++){
 				// Local index (regular layout)
 				n = k*Nx*Ny + j*Nx + i;
 				if (id[n] > 0 ){
-					Map(n) = idx++;
-					//neighborList[idx++] = n; // index of self in regular layout
+					interior_sites.push_back(n);
 				}
 			}
 		}
 	}
+	// only the interior is reordered in space (the exterior stays in raster order)
+	OrderInteriorSites(interior_sites, width);
+	interior_split = first_interior + PartitionSites(interior_sites, site_class);
+	for (size_t s=0; s<interior_sites.size(); s++){
+		Map(interior_sites[s]) = idx++;
+	}
 	last_interior=idx;
 	
 	Np = (last_interior/16 + 1)*16;
@@ -988,6 +1125,59 @@ int ScaLBL_Communicator::MemoryOptimizedLayoutAA(IntArray &Map, int *neighborLis
 	return(Np);
 }
 
+int ScaLBL_Communicator::CompactNeighborList(const int *neighborList, short *neighborDelta, std::vector<int> &escapeList, int Np){
+	/*
+	 * Encode the D3Q19 neighbor list generated by MemoryOptimizedLayoutAA as 16-bit offsets
+	 *   fluid neighbor:   neighborList[q*Np+n] = (q+1)*Np + n + base[q] + neighborDelta[q*Np+n]
+	 *   solid neighbor:   neighborDelta[q*Np+n] = D3Q19_COMPACT_BOUNCEBACK  (self, opposite direction)
+	 *   large offsets:    neighborDelta[q*Np+n] = D3Q19_COMPACT_ESCAPE (value stored in escapeList)
+	 *   escapeList = { base[0..17], sorted keys q*Np+n (count), values (count) }
+	 *   base[q] is the median offset for direction q, so that regular strides are stored as small values
+	 * returns the number of escaped entries
+	 */
+	std::vector<std::pair<int,int>> sites;
+	sites.push_back(std::make_pair(0,next));
+	sites.push_back(std::make_pair(first_interior,last_interior));
+	std::vector<int> base(18,0);
+	for (int q=0; q<18; q++){
+		std::vector<int> offsets;
+		for (auto range : sites){
+			for (int n=range.first; n<range.second; n++){
+				int offset = neighborList[q*Np+n] - (q+1)*Np - n;
+				if (offset != ((q^1)-q)*Np) offsets.push_back(offset);
+			}
+		}
+		if (!offsets.empty()){
+			std::nth_element(offsets.begin(), offsets.begin()+offsets.size()/2, offsets.end());
+			base[q] = offsets[offsets.size()/2];
+		}
+	}
+	std::vector<int> keys, values;
+	for (int q=0; q<18; q++){
+		for (int n=0; n<Np; n++) neighborDelta[q*Np+n] = D3Q19_COMPACT_BOUNCEBACK;
+		for (auto range : sites){
+			for (int n=range.first; n<range.second; n++){
+				int value = neighborList[q*Np+n];
+				long int delta = long(value) - (q+1)*long(Np) - n - base[q];
+				if (value == ((q^1)+1)*Np + n)
+					neighborDelta[q*Np+n] = D3Q19_COMPACT_BOUNCEBACK;
+				else if (delta > D3Q19_COMPACT_ESCAPE && delta <= 32767)
+					neighborDelta[q*Np+n] = short(delta);
+				else {
+					neighborDelta[q*Np+n] = D3Q19_COMPACT_ESCAPE;
+					keys.push_back(q*Np+n);
+					values.push_back(value);
+				}
+			}
+		}
+	}
+	// keys are generated in increasing order
+	escapeList = base;
+	escapeList.insert(escapeList.end(), keys.begin(), keys.end());
+	escapeList.insert(escapeList.end(), values.begin(), values.end());
+	return int(keys.size());
+}
+
 
 void ScaLBL_Communicator::SetupBounceBackList(IntArray &Map, signed char *id, int Np, bool SlippingVelBC)
 {
@@ -1065,6 +1255,7 @@ void ScaLBL_Communicator::SetupBounceBackList(IntArray &Map, signed char *id, in
 
 	int *bb_dist_tmp = new int [local_count];	
 	int *bb_interactions_tmp = new int [local_count];	
+	ScaLBL_MemoryTag tag("boundary lists");
 	ScaLBL_AllocateDeviceMemory((void **) &bb_dist, sizeof(int)*local_count);
 	ScaLBL_AllocateDeviceMemory((void **) &bb_interactions, sizeof(int)*local_count);
 	int *fluid_boundary_tmp;
@@ -1380,6 +1571,151 @@ void ScaLBL_Communicator::SolidSlippingVelocityBCD3Q19(double *fq, double *zeta_
                                           bb_dist,bb_interactions,fluid_boundary,lattice_weight,lattice_cx,lattice_cy,lattice_cz,n_bb_d3q19,N);
 }
 
+void ScaLBL_Communicator::HaloBuffers(double **send[18], double **recv[18], int sendCount[18], int recvCount[18], int neighbor[18]){
+	double **sendbuf[18] = { &sendbuf_x, &sendbuf_X, &sendbuf_y, &sendbuf_Y, &sendbuf_z, &sendbuf_Z,
+		&sendbuf_xy, &sendbuf_XY, &sendbuf_Xy, &sendbuf_xY, &sendbuf_xz, &sendbuf_XZ, &sendbuf_Xz, &sendbuf_xZ,
+		&sendbuf_yz, &sendbuf_YZ, &sendbuf_Yz, &sendbuf_yZ };
+	double **recvbuf[18] = { &recvbuf_x, &recvbuf_X, &recvbuf_y, &recvbuf_Y, &recvbuf_z, &recvbuf_Z,
+		&recvbuf_xy, &recvbuf_XY, &recvbuf_Xy, &recvbuf_xY, &recvbuf_xz, &recvbuf_XZ, &recvbuf_Xz, &recvbuf_xZ,
+		&recvbuf_yz, &recvbuf_YZ, &recvbuf_Yz, &recvbuf_yZ };
+	int scount[18] = { sendCount_x, sendCount_X, sendCount_y, sendCount_Y, sendCount_z, sendCount_Z,
+		sendCount_xy, sendCount_XY, sendCount_Xy, sendCount_xY, sendCount_xz, sendCount_XZ, sendCount_Xz, sendCount_xZ,
+		sendCount_yz, sendCount_YZ, sendCount_Yz, sendCount_yZ };
+	int rcount[18] = { recvCount_x, recvCount_X, recvCount_y, recvCount_Y, recvCount_z, recvCount_Z,
+		recvCount_xy, recvCount_XY, recvCount_Xy, recvCount_xY, recvCount_xz, recvCount_XZ, recvCount_Xz, recvCount_xZ,
+		recvCount_yz, recvCount_YZ, recvCount_Yz, recvCount_yZ };
+	int nbr[18] = { rank_x, rank_X, rank_y, rank_Y, rank_z, rank_Z,
+		rank_xy, rank_XY, rank_Xy, rank_xY, rank_xz, rank_XZ, rank_Xz, rank_xZ,
+		rank_yz, rank_YZ, rank_Yz, rank_yZ };
+	for (int d=0; d<18; d++){
+		send[d] = sendbuf[d];
+		recv[d] = recvbuf[d];
+		sendCount[d] = scount[d];
+		recvCount[d] = rcount[d];
+		neighbor[d] = nbr[d];
+	}
+}
+
+void ScaLBL_Communicator::SetupSharedHalo(){
+#if MPI_VERSION >= 3 && !defined(USE_CUDA) && !defined(USE_HIP)
+	double **send[18], **recv[18];
+	int sendCount[18], recvCount[18], neighbor[18];
+	HaloBuffers(send,recv,sendCount,recvCount,neighbor);
+	MPI_COMM_NODE = MPI_COMM_SCALBL.splitByNode();
+	auto node_ranks = MPI_COMM_NODE.allGather( rank );
+	// segment: ready[18], done[18], offsets[18], send buffers (64 byte aligned)
+	// the buffers are as large as the ones they replace (2*5*count faces, 2*count edges)
+	const size_t header = 3*18*sizeof(long long);
+	size_t offset[18], bytes = header;
+	for (int d=0; d<18; d++){
+		bytes = 64*((bytes+63)/64);
+		offset[d] = bytes;
+		bytes += (d < 6 ? 10 : 2)*sendCount[d]*sizeof(double);
+	}
+	MPI_Info info;
+	MPI_Info_create( &info );
+	MPI_Info_set( info, "alloc_shared_noncontig", "true" );
+	void *base;
+	MPI_Win_allocate_shared( bytes, 1, info, MPI_COMM_NODE.getCommunicator(), &base, &HaloWindow );
+	MPI_Info_free( &info );
+	HaloFlags = (long long *) base;
+	for (int d=0; d<18; d++){
+		HaloFlags[d] = HaloFlags[18+d] = 0;
+		HaloFlags[36+d] = offset[d];
+	}
+	MPI_COMM_NODE.barrier();
+	for (int d=0; d<18; d++){
+		auto it = std::find( node_ranks.begin(), node_ranks.end(), neighbor[d] );
+		if (it == node_ranks.end()) continue;
+		MPI_Aint size;
+		int disp;
+		void *remote;
+		MPI_Win_shared_query( HaloWindow, (int) (it-node_ranks.begin()), &size, &disp, &remote );
+		HaloShared[d] = true;
+		HaloNeighborFlags[d] = (long long *) remote;
+		// send from this segment, recieve directly from the send buffer of the neighbor
+		ScaLBL_FreeDeviceMemory( *send[d] );
+		ScaLBL_FreeDeviceMemory( *recv[d] );
+		*send[d] = (double *) ((char *) base + offset[d]);
+		*recv[d] = (double *) ((char *) remote + HaloNeighborFlags[d][36+(d^1)]);
+	}
+	int shared = SharedMemoryNeighbors();
+	shared = MPI_COMM_SCALBL.sumReduce( shared );
+	if (rank == 0) printf("ScaLBL_Communicator: %i of %i halo messages through shared memory \n",
+			shared, 18*MPI_COMM_SCALBL.getSize());
+#else
+	if (rank == 0) printf("ScaLBL_Communicator: halo_shared_memory is not supported in this build \n");
+#endif
+}
+
+void ScaLBL_Communicator::FreeSharedHalo(){
+	if (HaloWindow == MPI_WIN_NULL) return;
+	double **send[18], **recv[18];
+	int sendCount[18], recvCount[18], neighbor[18];
+	HaloBuffers(send,recv,sendCount,recvCount,neighbor);
+	// the buffers belong to the window
+	for (int d=0; d<18; d++){
+		if (HaloShared[d]){
+			*send[d] = NULL;
+			*recv[d] = NULL;
+		}
+	}
+	MPI_Win_free( &HaloWindow );
+	HaloFlags = NULL;
+}
+
+int ScaLBL_Communicator::SharedMemoryNeighbors() const{
+	int count = 0;
+	for (int d=0; d<18; d++) count += HaloShared[d] ? 1 : 0;
+	return count;
+}
+
+// wait until a flag written by another rank on the node reaches value
+static inline void HaloWaitFlag( const long long *flag, long long value ){
+	while (__atomic_load_n( flag, __ATOMIC_ACQUIRE ) < value)
+		sched_yield();
+}
+
+void ScaLBL_Communicator::HaloSendBegin(int ndir){
+	// the first ndir directions take part in the exchange (6 faces or all 18)
+	// wait until the neighbor has unpacked the previous exchange before packing
+	for (int d=0; d<ndir; d++){
+		HaloStep[d]++;
+		if (HaloShared[d])
+			HaloWaitFlag( &HaloNeighborFlags[d][18+(d^1)], HaloStep[d]-1 );
+	}
+}
+
+MPI_Request ScaLBL_Communicator::HaloIsend(int d, double *buf, int count, int dest, int tag){
+	if (!HaloShared[d])
+		return MPI_COMM_SCALBL.Isend(buf,count,dest,tag);
+	ScaLBL_DeviceBarrier();
+	__atomic_store_n( &HaloFlags[d], HaloStep[d], __ATOMIC_RELEASE );
+	return MPI_REQUEST_NULL;
+}
+
+MPI_Request ScaLBL_Communicator::HaloIrecv(int d, double *buf, int count, int source, int tag){
+	if (!HaloShared[d])
+		return MPI_COMM_SCALBL.Irecv(buf,count,source,tag);
+	return MPI_REQUEST_NULL;
+}
+
+void ScaLBL_Communicator::HaloRecvWait(int ndir){
+	// wait until the neighbor has packed this exchange
+	for (int d=0; d<ndir; d++){
+		if (HaloShared[d])
+			HaloWaitFlag( &HaloNeighborFlags[d][d^1], HaloStep[d] );
+	}
+}
+
+void ScaLBL_Communicator::HaloRecvDone(int ndir){
+	ScaLBL_DeviceBarrier();
+	for (int d=0; d<ndir; d++){
+		if (HaloShared[d])
+			__atomic_store_n( &HaloFlags[18+d], HaloStep[d], __ATOMIC_RELEASE );
+	}
+}
+
 void ScaLBL_Communicator::SendD3Q19AA(double *dist){
 
 	// NOTE: the center distribution f0 must NOT be at the start of feven, provide offset to start of f2
@@ -1392,6 +1728,7 @@ void ScaLBL_Communicator::SendD3Q19AA(double *dist){
 	// assign tag of 19 to D3Q19 communication
 	sendtag = recvtag = 19;
 	ScaLBL_DeviceBarrier();
+	HaloSendBegin(18);
 	// Pack the distributions
 	//...Packing for x face(2,8,10,12,14)................................
 	ScaLBL_D3Q19_Pack(2,dvcSendList_x,0,sendCount_x,sendbuf_x,dist,N);
@@ -1400,8 +1737,8 @@ void ScaLBL_Communicator::SendD3Q19AA(double *dist){
 	ScaLBL_D3Q19_Pack(12,dvcSendList_x,3*sendCount_x,sendCount_x,sendbuf_x,dist,N);
 	ScaLBL_D3Q19_Pack(14,dvcSendList_x,4*sendCount_x,sendCount_x,sendbuf_x,dist,N);
 	
-	req1[0] = MPI_COMM_SCALBL.Isend(sendbuf_x, 5*sendCount_x,rank_x,sendtag);
-	req2[0] = MPI_COMM_SCALBL.Irecv(recvbuf_X, 5*recvCount_X,rank_X,recvtag);
+	req1[0] = HaloIsend(halo_x,sendbuf_x, 5*sendCount_x,rank_x,sendtag);
+	req2[0] = HaloIrecv(halo_X,recvbuf_X, 5*recvCount_X,rank_X,recvtag);
 	//...Packing for X face(1,7,9,11,13)................................
 	ScaLBL_D3Q19_Pack(1,dvcSendList_X,0,sendCount_X,sendbuf_X,dist,N);
 	ScaLBL_D3Q19_Pack(7,dvcSendList_X,sendCount_X,sendCount_X,sendbuf_X,dist,N);
@@ -1409,8 +1746,8 @@ void ScaLBL_Communicator::SendD3Q19AA(double *dist){
 	ScaLBL_D3Q19_Pack(11,dvcSendList_X,3*sendCount_X,sendCount_X,sendbuf_X,dist,N);
 	ScaLBL_D3Q19_Pack(13,dvcSendList_X,4*sendCount_X,sendCount_X,sendbuf_X,dist,N);
 	
-	req1[1] = MPI_COMM_SCALBL.Isend(sendbuf_X, 5*sendCount_X,rank_X,sendtag);
-	req2[1] = MPI_COMM_SCALBL.Irecv(recvbuf_x, 5*recvCount_x,rank_x,recvtag);
+	req1[1] = HaloIsend(halo_X,sendbuf_X, 5*sendCount_X,rank_X,sendtag);
+	req2[1] = HaloIrecv(halo_x,recvbuf_x, 5*recvCount_x,rank_x,recvtag);
 	//...Packing for y face(4,8,9,16,18).................................
 	ScaLBL_D3Q19_Pack(4,dvcSendList_y,0,sendCount_y,sendbuf_y,dist,N);
 	ScaLBL_D3Q19_Pack(8,dvcSendList_y,sendCount_y,sendCount_y,sendbuf_y,dist,N);
@@ -1418,8 +1755,8 @@ void ScaLBL_Communicator::SendD3Q19AA(double *dist){
 	ScaLBL_D3Q19_Pack(16,dvcSendList_y,3*sendCount_y,sendCount_y,sendbuf_y,dist,N);
 	ScaLBL_D3Q19_Pack(18,dvcSendList_y,4*sendCount_y,sendCount_y,sendbuf_y,dist,N);
 	
-	req1[2] = MPI_COMM_SCALBL.Isend(sendbuf_y, 5*sendCount_y,rank_y,sendtag);
-	req2[2] = MPI_COMM_SCALBL.Irecv(recvbuf_Y, 5*recvCount_Y,rank_Y,recvtag);
+	req1[2] = HaloIsend(halo_y,sendbuf_y, 5*sendCount_y,rank_y,sendtag);
+	req2[2] = HaloIrecv(halo_Y,recvbuf_Y, 5*recvCount_Y,rank_Y,recvtag);
 	//...Packing for Y face(3,7,10,15,17).................................
 	ScaLBL_D3Q19_Pack(3,dvcSendList_Y,0,sendCount_Y,sendbuf_Y,dist,N);
 	ScaLBL_D3Q19_Pack(7,dvcSendList_Y,sendCount_Y,sendCount_Y,sendbuf_Y,dist,N);
@@ -1427,8 +1764,8 @@ void ScaLBL_Communicator::SendD3Q19AA(double *dist){
 	ScaLBL_D3Q19_Pack(15,dvcSendList_Y,3*sendCount_Y,sendCount_Y,sendbuf_Y,dist,N);
 	ScaLBL_D3Q19_Pack(17,dvcSendList_Y,4*sendCount_Y,sendCount_Y,sendbuf_Y,dist,N);
 	
-	req1[3] = MPI_COMM_SCALBL.Isend(sendbuf_Y, 5*sendCount_Y,rank_Y,sendtag);
-	req2[3] = MPI_COMM_SCALBL.Irecv(recvbuf_y, 5*recvCount_y,rank_y,recvtag);
+	req1[3] = HaloIsend(halo_Y,sendbuf_Y, 5*sendCount_Y,rank_Y,sendtag);
+	req2[3] = HaloIrecv(halo_y,recvbuf_y, 5*recvCount_y,rank_y,recvtag);
 	//...Packing for z face(6,12,13,16,17)................................
 	ScaLBL_D3Q19_Pack(6,dvcSendList_z,0,sendCount_z,sendbuf_z,dist,N);
 	ScaLBL_D3Q19_Pack(12,dvcSendList_z,sendCount_z,sendCount_z,sendbuf_z,dist,N);
@@ -1436,8 +1773,8 @@ void ScaLBL_Communicator::SendD3Q19AA(double *dist){
 	ScaLBL_D3Q19_Pack(16,dvcSendList_z,3*sendCount_z,sendCount_z,sendbuf_z,dist,N);
 	ScaLBL_D3Q19_Pack(17,dvcSendList_z,4*sendCount_z,sendCount_z,sendbuf_z,dist,N);
 	
-	req1[4] = MPI_COMM_SCALBL.Isend(sendbuf_z, 5*sendCount_z,rank_z,sendtag);
-	req2[4] = MPI_COMM_SCALBL.Irecv(recvbuf_Z, 5*recvCount_Z,rank_Z,recvtag);
+	req1[4] = HaloIsend(halo_z,sendbuf_z, 5*sendCount_z,rank_z,sendtag);
+	req2[4] = HaloIrecv(halo_Z,recvbuf_Z, 5*recvCount_Z,rank_Z,recvtag);
 	
 	//...Packing for Z face(5,11,14,15,18)................................
 	ScaLBL_D3Q19_Pack(5,dvcSendList_Z,0,sendCount_Z,sendbuf_Z,dist,N);
@@ -1446,57 +1783,57 @@ void ScaLBL_Communicator::SendD3Q19AA(double *dist){
 	ScaLBL_D3Q19_Pack(15,dvcSendList_Z,3*sendCount_Z,sendCount_Z,sendbuf_Z,dist,N);
 	ScaLBL_D3Q19_Pack(18,dvcSendList_Z,4*sendCount_Z,sendCount_Z,sendbuf_Z,dist,N);
 	
-	req1[5] = MPI_COMM_SCALBL.Isend(sendbuf_Z, 5*sendCount_Z,rank_Z,sendtag);
-	req2[5] = MPI_COMM_SCALBL.Irecv(recvbuf_z, 5*recvCount_z,rank_z,recvtag);
+	req1[5] = HaloIsend(halo_Z,sendbuf_Z, 5*sendCount_Z,rank_Z,sendtag);
+	req2[5] = HaloIrecv(halo_z,recvbuf_z, 5*recvCount_z,rank_z,recvtag);
 	
 	//...Pack the xy edge (8)................................
 	ScaLBL_D3Q19_Pack(8,dvcSendList_xy,0,sendCount_xy,sendbuf_xy,dist,N);
-	req1[6] = MPI_COMM_SCALBL.Isend(sendbuf_xy, sendCount_xy,rank_xy,sendtag);
-	req2[6] = MPI_COMM_SCALBL.Irecv(recvbuf_XY, recvCount_XY,rank_XY,recvtag);
+	req1[6] = HaloIsend(halo_xy,sendbuf_xy, sendCount_xy,rank_xy,sendtag);
+	req2[6] = HaloIrecv(halo_XY,recvbuf_XY, recvCount_XY,rank_XY,recvtag);
 	//...Pack the Xy edge (9)................................
 	ScaLBL_D3Q19_Pack(9,dvcSendList_Xy,0,sendCount_Xy,sendbuf_Xy,dist,N);
-	req1[8] = MPI_COMM_SCALBL.Isend(sendbuf_Xy, sendCount_Xy,rank_Xy,sendtag);
-	req2[8] = MPI_COMM_SCALBL.Irecv(recvbuf_xY, recvCount_xY,rank_xY,recvtag);
+	req1[8] = HaloIsend(halo_Xy,sendbuf_Xy, sendCount_Xy,rank_Xy,sendtag);
+	req2[8] = HaloIrecv(halo_xY,recvbuf_xY, recvCount_xY,rank_xY,recvtag);
 	//...Pack the xY edge (10)................................
 	ScaLBL_D3Q19_Pack(10,dvcSendList_xY,0,sendCount_xY,sendbuf_xY,dist,N);
-	req1[9] = MPI_COMM_SCALBL.Isend(sendbuf_xY, sendCount_xY,rank_xY,sendtag);
-	req2[9] = MPI_COMM_SCALBL.Irecv(recvbuf_Xy, recvCount_Xy,rank_Xy,recvtag);
+	req1[9] = HaloIsend(halo_xY,sendbuf_xY, sendCount_xY,rank_xY,sendtag);
+	req2[9] = HaloIrecv(halo_Xy,recvbuf_Xy, recvCount_Xy,rank_Xy,recvtag);
 	//...Pack the XY edge (7)................................
 	ScaLBL_D3Q19_Pack(7,dvcSendList_XY,0,sendCount_XY,sendbuf_XY,dist,N);
-	req1[7] = MPI_COMM_SCALBL.Isend(sendbuf_XY, sendCount_XY,rank_XY,sendtag);
-	req2[7] = MPI_COMM_SCALBL.Irecv(recvbuf_xy, recvCount_xy,rank_xy,recvtag);
+	req1[7] = HaloIsend(halo_XY,sendbuf_XY, sendCount_XY,rank_XY,sendtag);
+	req2[7] = HaloIrecv(halo_xy,recvbuf_xy, recvCount_xy,rank_xy,recvtag);
 	//...Pack the xz edge (12)................................
 	ScaLBL_D3Q19_Pack(12,dvcSendList_xz,0,sendCount_xz,sendbuf_xz,dist,N);
-	req1[10] = MPI_COMM_SCALBL.Isend(sendbuf_xz, sendCount_xz,rank_xz,sendtag);
-	req2[10] = MPI_COMM_SCALBL.Irecv(recvbuf_XZ, recvCount_XZ,rank_XZ,recvtag);
+	req1[10] = HaloIsend(halo_xz,sendbuf_xz, sendCount_xz,rank_xz,sendtag);
+	req2[10] = HaloIrecv(halo_XZ,recvbuf_XZ, recvCount_XZ,rank_XZ,recvtag);
 	//...Pack the xZ edge (14)................................
 	ScaLBL_D3Q19_Pack(14,dvcSendList_xZ,0,sendCount_xZ,sendbuf_xZ,dist,N);
-	req1[13] = MPI_COMM_SCALBL.Isend(sendbuf_xZ, sendCount_xZ,rank_xZ,sendtag);
-	req2[13] = MPI_COMM_SCALBL.Irecv(recvbuf_Xz, recvCount_Xz,rank_Xz,recvtag);
+	req1[13] = HaloIsend(halo_xZ,sendbuf_xZ, sendCount_xZ,rank_xZ,sendtag);
+	req2[13] = HaloIrecv(halo_Xz,recvbuf_Xz, recvCount_Xz,rank_Xz,recvtag);
 	//...Pack the Xz edge (13)................................
 	ScaLBL_D3Q19_Pack(13,dvcSendList_Xz,0,sendCount_Xz,sendbuf_Xz,dist,N);
-	req1[12] = MPI_COMM_SCALBL.Isend(sendbuf_Xz, sendCount_Xz,rank_Xz,sendtag);
-	req2[12] = MPI_COMM_SCALBL.Irecv(recvbuf_xZ, recvCount_xZ,rank_xZ,recvtag);
+	req1[12] = HaloIsend(halo_Xz,sendbuf_Xz, sendCount_Xz,rank_Xz,sendtag);
+	req2[12] = HaloIrecv(halo_xZ,recvbuf_xZ, recvCount_xZ,rank_xZ,recvtag);
 	//...Pack the XZ edge (11)................................
 	ScaLBL_D3Q19_Pack(11,dvcSendList_XZ,0,sendCount_XZ,sendbuf_XZ,dist,N);
-	req1[11] = MPI_COMM_SCALBL.Isend(sendbuf_XZ, sendCount_XZ,rank_XZ,sendtag);
-	req2[11] = MPI_COMM_SCALBL.Irecv(recvbuf_xz, recvCount_xz,rank_xz,recvtag);
+	req1[11] = HaloIsend(halo_XZ,sendbuf_XZ, sendCount_XZ,rank_XZ,sendtag);
+	req2[11] = HaloIrecv(halo_xz,recvbuf_xz, recvCount_xz,rank_xz,recvtag);
 	//...Pack the yz edge (16)................................
 	ScaLBL_D3Q19_Pack(16,dvcSendList_yz,0,sendCount_yz,sendbuf_yz,dist,N);
-	req1[14] = MPI_COMM_SCALBL.Isend(sendbuf_yz, sendCount_yz,rank_yz,sendtag);
-	req2[14] = MPI_COMM_SCALBL.Irecv(recvbuf_YZ, recvCount_YZ,rank_YZ,recvtag);
+	req1[14] = HaloIsend(halo_yz,sendbuf_yz, sendCount_yz,rank_yz,sendtag);
+	req2[14] = HaloIrecv(halo_YZ,recvbuf_YZ, recvCount_YZ,rank_YZ,recvtag);
 	//...Pack the yZ edge (18)................................
 	ScaLBL_D3Q19_Pack(18,dvcSendList_yZ,0,sendCount_yZ,sendbuf_yZ,dist,N);
-	req1[17] = MPI_COMM_SCALBL.Isend(sendbuf_yZ, sendCount_yZ,rank_yZ,sendtag);
-	req2[17] = MPI_COMM_SCALBL.Irecv(recvbuf_Yz, recvCount_Yz,rank_Yz,recvtag);
+	req1[17] = HaloIsend(halo_yZ,sendbuf_yZ, sendCount_yZ,rank_yZ,sendtag);
+	req2[17] = HaloIrecv(halo_Yz,recvbuf_Yz, recvCount_Yz,rank_Yz,recvtag);
 	//...Pack the Yz edge (17)................................
 	ScaLBL_D3Q19_Pack(17,dvcSendList_Yz,0,sendCount_Yz,sendbuf_Yz,dist,N);
-	req1[16] = MPI_COMM_SCALBL.Isend(sendbuf_Yz, sendCount_Yz,rank_Yz,sendtag);
-	req2[16] = MPI_COMM_SCALBL.Irecv(recvbuf_yZ, recvCount_yZ,rank_yZ,recvtag);
+	req1[16] = HaloIsend(halo_Yz,sendbuf_Yz, sendCount_Yz,rank_Yz,sendtag);
+	req2[16] = HaloIrecv(halo_yZ,recvbuf_yZ, recvCount_yZ,rank_yZ,recvtag);
 	//...Pack the YZ edge (15)................................
 	ScaLBL_D3Q19_Pack(15,dvcSendList_YZ,0,sendCount_YZ,sendbuf_YZ,dist,N);
-	req1[15] = MPI_COMM_SCALBL.Isend(sendbuf_YZ, sendCount_YZ,rank_YZ,sendtag);
-	req2[15] = MPI_COMM_SCALBL.Irecv(recvbuf_yz, recvCount_yz,rank_yz,recvtag);
+	req1[15] = HaloIsend(halo_YZ,sendbuf_YZ, sendCount_YZ,rank_YZ,sendtag);
+	req2[15] = HaloIrecv(halo_yz,recvbuf_yz, recvCount_yz,rank_yz,recvtag);
 	//...................................................................................
 
 }
@@ -1509,6 +1846,7 @@ void ScaLBL_Communicator::RecvD3Q19AA(double *dist){
 	MPI_COMM_SCALBL.waitAll(18,req1);
 	MPI_COMM_SCALBL.waitAll(18,req2);
 	ScaLBL_DeviceBarrier();
+	HaloRecvWait(18);
 
 	//...................................................................................
 	// NOTE: AA Routine writes to opposite 
@@ -1580,6 +1918,7 @@ void ScaLBL_Communicator::RecvD3Q19AA(double *dist){
 	//...Pack the YZ edge (15)................................
 	ScaLBL_D3Q19_Unpack(15,dvcRecvDist_YZ,0,recvCount_YZ,recvbuf_YZ,dist,N);
 	//...................................................................................
+	HaloRecvDone(18);
 	Lock=false; // unlock the communicator after communications complete
 	//...................................................................................
 
@@ -1593,6 +1932,7 @@ void ScaLBL_Communicator::RecvGrad(double *phi, double *grad){
 	MPI_COMM_SCALBL.waitAll(18,req1);
 	MPI_COMM_SCALBL.waitAll(18,req2);
 	ScaLBL_DeviceBarrier();
+	HaloRecvWait(18);
 
 	//...................................................................................
 	// Unpack the gradributions on the device
@@ -1662,6 +2002,7 @@ void ScaLBL_Communicator::RecvGrad(double *phi, double *grad){
 	//...Pack the YZ edge (15)................................
 	ScaLBL_Gradient_Unpack(0.5,0,1,1,dvcRecvDist_YZ,0,recvCount_YZ,recvbuf_YZ,phi,grad,N);
 	//...................................................................................
+	HaloRecvDone(18);
 	Lock=false; // unlock the communicator after communications complete
 	//...................................................................................
 
@@ -1679,41 +2020,42 @@ void ScaLBL_Communicator::BiSendD3Q7AA(double *Aq, double *Bq){
 	// assign tag of 19 to D3Q19 communication
 	sendtag = recvtag = 14;
 	ScaLBL_DeviceBarrier();
+	HaloSendBegin(6);
 	// Pack the distributions
 	//...Packing for x face(2,8,10,12,14)................................
 	ScaLBL_D3Q19_Pack(2,dvcSendList_x,0,sendCount_x,sendbuf_x,Aq,N);
 	ScaLBL_D3Q19_Pack(2,dvcSendList_x,sendCount_x,sendCount_x,sendbuf_x,Bq,N);
 
-	req1[0] = MPI_COMM_SCALBL.Isend(sendbuf_x, 2*sendCount_x,rank_x,sendtag);
-	req2[0] = MPI_COMM_SCALBL.Irecv(recvbuf_X, 2*recvCount_X,rank_X,recvtag);
+	req1[0] = HaloIsend(halo_x,sendbuf_x, 2*sendCount_x,rank_x,sendtag);
+	req2[0] = HaloIrecv(halo_X,recvbuf_X, 2*recvCount_X,rank_X,recvtag);
 	
 	//...Packing for X face(1,7,9,11,13)................................
 	ScaLBL_D3Q19_Pack(1,dvcSendList_X,0,sendCount_X,sendbuf_X,Aq,N);
 	ScaLBL_D3Q19_Pack(1,dvcSendList_X,sendCount_X,sendCount_X,sendbuf_X,Bq,N);
 	
-	req1[1] = MPI_COMM_SCALBL.Isend(sendbuf_X, 2*sendCount_X,rank_X,sendtag);
-	req2[1] = MPI_COMM_SCALBL.Irecv(recvbuf_x, 2*recvCount_x,rank_x,recvtag);
+	req1[1] = HaloIsend(halo_X,sendbuf_X, 2*sendCount_X,rank_X,sendtag);
+	req2[1] = HaloIrecv(halo_x,recvbuf_x, 2*recvCount_x,rank_x,recvtag);
 
 	//...Packing for y face(4,8,9,16,18).................................
 	ScaLBL_D3Q19_Pack(4,dvcSendList_y,0,sendCount_y,sendbuf_y,Aq,N);
 	ScaLBL_D3Q19_Pack(4,dvcSendList_y,sendCount_y,sendCount_y,sendbuf_y,Bq,N);
 
-	req1[2] = MPI_COMM_SCALBL.Isend(sendbuf_y, 2*sendCount_y,rank_y,sendtag);
-	req2[2] = MPI_COMM_SCALBL.Irecv(recvbuf_Y, 2*recvCount_Y,rank_Y,recvtag);
+	req1[2] = HaloIsend(halo_y,sendbuf_y, 2*sendCount_y,rank_y,sendtag);
+	req2[2] = HaloIrecv(halo_Y,recvbuf_Y, 2*recvCount_Y,rank_Y,recvtag);
 	
 	//...Packing for Y face(3,7,10,15,17).................................
 	ScaLBL_D3Q19_Pack(3,dvcSendList_Y,0,sendCount_Y,sendbuf_Y,Aq,N);
 	ScaLBL_D3Q19_Pack(3,dvcSendList_Y,sendCount_Y,sendCount_Y,sendbuf_Y,Bq,N);
 
-	req1[3] = MPI_COMM_SCALBL.Isend(sendbuf_Y, 2*sendCount_Y,rank_Y,sendtag);
-	req2[3] = MPI_COMM_SCALBL.Irecv(recvbuf_y, 2*recvCount_y,rank_y,recvtag);
+	req1[3] = HaloIsend(halo_Y,sendbuf_Y, 2*sendCount_Y,rank_Y,sendtag);
+	req2[3] = HaloIrecv(halo_y,recvbuf_y, 2*recvCount_y,rank_y,recvtag);
 	
 	//...Packing for z face(6,12,13,16,17)................................
 	ScaLBL_D3Q19_Pack(6,dvcSendList_z,0,sendCount_z,sendbuf_z,Aq,N);
 	ScaLBL_D3Q19_Pack(6,dvcSendList_z,sendCount_z,sendCount_z,sendbuf_z,Bq,N);
 	
-	req1[4] = MPI_COMM_SCALBL.Isend(sendbuf_z, 2*sendCount_z,rank_z,sendtag);
-	req2[4] = MPI_COMM_SCALBL.Irecv(recvbuf_Z, 2*recvCount_Z,rank_Z,recvtag);
+	req1[4] = HaloIsend(halo_z,sendbuf_z, 2*sendCount_z,rank_z,sendtag);
+	req2[4] = HaloIrecv(halo_Z,recvbuf_Z, 2*recvCount_Z,rank_Z,recvtag);
 	
 	//...Packing for Z face(5,11,14,15,18)................................
 	ScaLBL_D3Q19_Pack(5,dvcSendList_Z,0,sendCount_Z,sendbuf_Z,Aq,N);
@@ -1721,8 +2063,8 @@ void ScaLBL_Communicator::BiSendD3Q7AA(double *Aq, double *Bq){
 
 	//...................................................................................
 	// Send all the distributions
-	req1[5] = MPI_COMM_SCALBL.Isend(sendbuf_Z, 2*sendCount_Z,rank_Z,sendtag);
-	req2[5] = MPI_COMM_SCALBL.Irecv(recvbuf_z, 2*recvCount_z,rank_z,recvtag);
+	req1[5] = HaloIsend(halo_Z,sendbuf_Z, 2*sendCount_Z,rank_Z,sendtag);
+	req2[5] = HaloIrecv(halo_z,recvbuf_z, 2*recvCount_z,rank_z,recvtag);
 
 }
 
@@ -1735,6 +2077,7 @@ void ScaLBL_Communicator::BiRecvD3Q7AA(double *Aq, double *Bq){
 	MPI_COMM_SCALBL.waitAll(6,req1);
 	MPI_COMM_SCALBL.waitAll(6,req2);
 	ScaLBL_DeviceBarrier();
+	HaloRecvWait(6);
 
 	//...................................................................................
 	// NOTE: AA Routine writes to opposite
@@ -1779,6 +2122,7 @@ void ScaLBL_Communicator::BiRecvD3Q7AA(double *Aq, double *Bq){
 	}
 	
 	//...................................................................................
+	HaloRecvDone(6);
 	Lock=false; // unlock the communicator after communications complete
 	//...................................................................................
 
@@ -1796,36 +2140,37 @@ void ScaLBL_Communicator::SendD3Q7AA(double *Aq, int Component){
 	// assign tag of 19 to D3Q19 communication
 	sendtag = recvtag = 7;
 	ScaLBL_DeviceBarrier();
+	HaloSendBegin(6);
 	// Pack the distributions
 	//...Packing for x face(2,8,10,12,14)................................
 	ScaLBL_D3Q19_Pack(2,dvcSendList_x,0,sendCount_x,sendbuf_x,&Aq[Component*7*N],N);
-	req1[0] = MPI_COMM_SCALBL.Isend(sendbuf_x, sendCount_x,rank_x,sendtag);
-	req2[0] = MPI_COMM_SCALBL.Irecv(recvbuf_X, recvCount_X,rank_X,recvtag);
+	req1[0] = HaloIsend(halo_x,sendbuf_x, sendCount_x,rank_x,sendtag);
+	req2[0] = HaloIrecv(halo_X,recvbuf_X, recvCount_X,rank_X,recvtag);
 	
 	//...Packing for X face(1,7,9,11,13)................................
 	ScaLBL_D3Q19_Pack(1,dvcSendList_X,0,sendCount_X,sendbuf_X,&Aq[Component*7*N],N);
-	req1[1] = MPI_COMM_SCALBL.Isend(sendbuf_X, sendCount_X,rank_X,sendtag);
-	req2[1] = MPI_COMM_SCALBL.Irecv(recvbuf_x, recvCount_x,rank_x,recvtag);
+	req1[1] = HaloIsend(halo_X,sendbuf_X, sendCount_X,rank_X,sendtag);
+	req2[1] = HaloIrecv(halo_x,recvbuf_x, recvCount_x,rank_x,recvtag);
 	
 	//...Packing for y face(4,8,9,16,18).................................
 	ScaLBL_D3Q19_Pack(4,dvcSendList_y,0,sendCount_y,sendbuf_y,&Aq[Component*7*N],N);
-	req1[2] = MPI_COMM_SCALBL.Isend(sendbuf_y, sendCount_y,rank_y,sendtag);
-	req2[2] = MPI_COMM_SCALBL.Irecv(recvbuf_Y, recvCount_Y,rank_Y,recvtag);
+	req1[2] = HaloIsend(halo_y,sendbuf_y, sendCount_y,rank_y,sendtag);
+	req2[2] = HaloIrecv(halo_Y,recvbuf_Y, recvCount_Y,rank_Y,recvtag);
 	
 	//...Packing for Y face(3,7,10,15,17).................................
 	ScaLBL_D3Q19_Pack(3,dvcSendList_Y,0,sendCount_Y,sendbuf_Y,&Aq[Component*7*N],N);
-	req1[3] = MPI_COMM_SCALBL.Isend(sendbuf_Y, sendCount_Y,rank_Y,sendtag);
-	req2[3] = MPI_COMM_SCALBL.Irecv(recvbuf_y, recvCount_y,rank_y,recvtag);
+	req1[3] = HaloIsend(halo_Y,sendbuf_Y, sendCount_Y,rank_Y,sendtag);
+	req2[3] = HaloIrecv(halo_y,recvbuf_y, recvCount_y,rank_y,recvtag);
 	
 	//...Packing for z face(6,12,13,16,17)................................
 	ScaLBL_D3Q19_Pack(6,dvcSendList_z,0,sendCount_z,sendbuf_z,&Aq[Component*7*N],N);
-	req1[4] = MPI_COMM_SCALBL.Isend(sendbuf_z, sendCount_z,rank_z,sendtag);
-	req2[4] = MPI_COMM_SCALBL.Irecv(recvbuf_Z, recvCount_Z,rank_Z,recvtag);
+	req1[4] = HaloIsend(halo_z,sendbuf_z, sendCount_z,rank_z,sendtag);
+	req2[4] = HaloIrecv(halo_Z,recvbuf_Z, recvCount_Z,rank_Z,recvtag);
 	
 	//...Packing for Z face(5,11,14,15,18)................................
 	ScaLBL_D3Q19_Pack(5,dvcSendList_Z,0,sendCount_Z,sendbuf_Z,&Aq[Component*7*N],N);
-	req1[5] = MPI_COMM_SCALBL.Isend(sendbuf_Z, sendCount_Z,rank_Z,sendtag);
-	req2[5] = MPI_COMM_SCALBL.Irecv(recvbuf_z, recvCount_z,rank_z,recvtag);
+	req1[5] = HaloIsend(halo_Z,sendbuf_Z, sendCount_Z,rank_Z,sendtag);
+	req2[5] = HaloIrecv(halo_z,recvbuf_z, recvCount_z,rank_z,recvtag);
 }
 
 
@@ -1837,6 +2182,7 @@ void ScaLBL_Communicator::RecvD3Q7AA(double *Aq, int Component){
 	MPI_COMM_SCALBL.waitAll(6,req1);
 	MPI_COMM_SCALBL.waitAll(6,req2);
 	ScaLBL_DeviceBarrier();
+	HaloRecvWait(6);
 
 	//...................................................................................
 	// NOTE: AA Routine writes to opposite
@@ -1873,6 +2219,7 @@ void ScaLBL_Communicator::RecvD3Q7AA(double *Aq, int Component){
 	}
 
 	//...................................................................................
+	HaloRecvDone(6);
 	Lock=false; // unlock the communicator after communications complete
 	//...................................................................................
 
@@ -1890,6 +2237,7 @@ void ScaLBL_Communicator::TriSendD3Q7AA(double *Aq, double *Bq, double *Cq){
 	// assign tag of 19 to D3Q19 communication
 	sendtag = recvtag = 15;
 	ScaLBL_DeviceBarrier();
+	HaloSendBegin(6);
 	// Pack the distributions
 	//...Packing for x face(2,8,10,12,14)................................
 	ScaLBL_D3Q19_Pack(2,dvcSendList_x,0,sendCount_x,sendbuf_x,Aq,N);
@@ -1918,18 +2266,18 @@ void ScaLBL_Communicator::TriSendD3Q7AA(double *Aq, double *Bq, double *Cq){
 
 	//...................................................................................
 	// Send all the distributions
-	req1[0] = MPI_COMM_SCALBL.Isend(sendbuf_x, 3*sendCount_x,rank_x,sendtag);
-	req2[0] = MPI_COMM_SCALBL.Irecv(recvbuf_X, 3*recvCount_X,rank_X,recvtag);
-	req1[1] = MPI_COMM_SCALBL.Isend(sendbuf_X, 3*sendCount_X,rank_X,sendtag);
-	req2[1] = MPI_COMM_SCALBL.Irecv(recvbuf_x, 3*recvCount_x,rank_x,recvtag);
-	req1[2] = MPI_COMM_SCALBL.Isend(sendbuf_y, 3*sendCount_y,rank_y,sendtag);
-	req2[2] = MPI_COMM_SCALBL.Irecv(recvbuf_Y, 3*recvCount_Y,rank_Y,recvtag);
-	req1[3] = MPI_COMM_SCALBL.Isend(sendbuf_Y, 3*sendCount_Y,rank_Y,sendtag);
-	req2[3] = MPI_COMM_SCALBL.Irecv(recvbuf_y, 3*recvCount_y,rank_y,recvtag);
-	req1[4] = MPI_COMM_SCALBL.Isend(sendbuf_z, 3*sendCount_z,rank_z,sendtag);
-	req2[4] = MPI_COMM_SCALBL.Irecv(recvbuf_Z, 3*recvCount_Z,rank_Z,recvtag);
-	req1[5] = MPI_COMM_SCALBL.Isend(sendbuf_Z, 3*sendCount_Z,rank_Z,sendtag);
-	req2[5] = MPI_COMM_SCALBL.Irecv(recvbuf_z, 3*recvCount_z,rank_z,recvtag);
+	req1[0] = HaloIsend(halo_x,sendbuf_x, 3*sendCount_x,rank_x,sendtag);
+	req2[0] = HaloIrecv(halo_X,recvbuf_X, 3*recvCount_X,rank_X,recvtag);
+	req1[1] = HaloIsend(halo_X,sendbuf_X, 3*sendCount_X,rank_X,sendtag);
+	req2[1] = HaloIrecv(halo_x,recvbuf_x, 3*recvCount_x,rank_x,recvtag);
+	req1[2] = HaloIsend(halo_y,sendbuf_y, 3*sendCount_y,rank_y,sendtag);
+	req2[2] = HaloIrecv(halo_Y,recvbuf_Y, 3*recvCount_Y,rank_Y,recvtag);
+	req1[3] = HaloIsend(halo_Y,sendbuf_Y, 3*sendCount_Y,rank_Y,sendtag);
+	req2[3] = HaloIrecv(halo_y,recvbuf_y, 3*recvCount_y,rank_y,recvtag);
+	req1[4] = HaloIsend(halo_z,sendbuf_z, 3*sendCount_z,rank_z,sendtag);
+	req2[4] = HaloIrecv(halo_Z,recvbuf_Z, 3*recvCount_Z,rank_Z,recvtag);
+	req1[5] = HaloIsend(halo_Z,sendbuf_Z, 3*sendCount_Z,rank_Z,sendtag);
+	req2[5] = HaloIrecv(halo_z,recvbuf_z, 3*recvCount_z,rank_z,recvtag);
 
 }
 
@@ -1942,6 +2290,7 @@ void ScaLBL_Communicator::TriRecvD3Q7AA(double *Aq, double *Bq, double *Cq){
 	MPI_COMM_SCALBL.waitAll(6,req1);
 	MPI_COMM_SCALBL.waitAll(6,req2);
 	ScaLBL_DeviceBarrier();
+	HaloRecvWait(6);
 
 	//...................................................................................
 	// NOTE: AA Routine writes to opposite
@@ -1994,6 +2343,7 @@ void ScaLBL_Communicator::TriRecvD3Q7AA(double *Aq, double *Bq, double *Cq){
 	}
 	
 	//...................................................................................
+	HaloRecvDone(6);
 	Lock=false; // unlock the communicator after communications complete
 	//...................................................................................
 
@@ -2009,6 +2359,7 @@ void ScaLBL_Communicator::SendHalo(double *data){
 		Lock=true;
 	}
 	ScaLBL_DeviceBarrier();
+	HaloSendBegin(18);
 	//...................................................................................
 	sendtag = recvtag = 1;
 	//...................................................................................
@@ -2034,42 +2385,42 @@ void ScaLBL_Communicator::SendHalo(double *data){
 	// Send / Recv all the phase indcator field values
 	//...................................................................................
 
-	req1[0]  = MPI_COMM_SCALBL.Isend(sendbuf_x, sendCount_x,rank_x,sendtag);
-	req2[0]  = MPI_COMM_SCALBL.Irecv(recvbuf_X, recvCount_X,rank_X,recvtag);
-	req1[1]  = MPI_COMM_SCALBL.Isend(sendbuf_X, sendCount_X,rank_X,sendtag);
-	req2[1]  = MPI_COMM_SCALBL.Irecv(recvbuf_x, recvCount_x,rank_x,recvtag);
-	req1[2]  = MPI_COMM_SCALBL.Isend(sendbuf_y, sendCount_y,rank_y,sendtag);
-	req2[2]  = MPI_COMM_SCALBL.Irecv(recvbuf_Y, recvCount_Y,rank_Y,recvtag);
-	req1[3]  = MPI_COMM_SCALBL.Isend(sendbuf_Y, sendCount_Y,rank_Y,sendtag);
-	req2[3]  = MPI_COMM_SCALBL.Irecv(recvbuf_y, recvCount_y,rank_y,recvtag);
-	req1[4]  = MPI_COMM_SCALBL.Isend(sendbuf_z, sendCount_z,rank_z,sendtag);
-	req2[4]  = MPI_COMM_SCALBL.Irecv(recvbuf_Z, recvCount_Z,rank_Z,recvtag);
-	req1[5]  = MPI_COMM_SCALBL.Isend(sendbuf_Z, sendCount_Z,rank_Z,sendtag);
-	req2[5]  = MPI_COMM_SCALBL.Irecv(recvbuf_z, recvCount_z,rank_z,recvtag);
-	req1[6]  = MPI_COMM_SCALBL.Isend(sendbuf_xy, sendCount_xy,rank_xy,sendtag);
-	req2[6]  = MPI_COMM_SCALBL.Irecv(recvbuf_XY, recvCount_XY,rank_XY,recvtag);
-	req1[7]  = MPI_COMM_SCALBL.Isend(sendbuf_XY, sendCount_XY,rank_XY,sendtag);
-	req2[7]  = MPI_COMM_SCALBL.Irecv(recvbuf_xy, recvCount_xy,rank_xy,recvtag);
-	req1[8]  = MPI_COMM_SCALBL.Isend(sendbuf_Xy, sendCount_Xy,rank_Xy,sendtag);
-	req2[8]  = MPI_COMM_SCALBL.Irecv(recvbuf_xY, recvCount_xY,rank_xY,recvtag);
-	req1[9]  = MPI_COMM_SCALBL.Isend(sendbuf_xY, sendCount_xY,rank_xY,sendtag);
-	req2[9]  = MPI_COMM_SCALBL.Irecv(recvbuf_Xy, recvCount_Xy,rank_Xy,recvtag);
-	req1[10] = MPI_COMM_SCALBL.Isend(sendbuf_xz, sendCount_xz,rank_xz,sendtag);
-	req2[10] = MPI_COMM_SCALBL.Irecv(recvbuf_XZ, recvCount_XZ,rank_XZ,recvtag);
-	req1[11] = MPI_COMM_SCALBL.Isend(sendbuf_XZ, sendCount_XZ,rank_XZ,sendtag);
-	req2[11] = MPI_COMM_SCALBL.Irecv(recvbuf_xz, recvCount_xz,rank_xz,recvtag);
-	req1[12] = MPI_COMM_SCALBL.Isend(sendbuf_Xz, sendCount_Xz,rank_Xz,sendtag);
-	req2[12] = MPI_COMM_SCALBL.Irecv(recvbuf_xZ, recvCount_xZ,rank_xZ,recvtag);
-	req1[13] = MPI_COMM_SCALBL.Isend(sendbuf_xZ, sendCount_xZ,rank_xZ,sendtag);
-	req2[13] = MPI_COMM_SCALBL.Irecv(recvbuf_Xz, recvCount_Xz,rank_Xz,recvtag);
-	req1[14] = MPI_COMM_SCALBL.Isend(sendbuf_yz, sendCount_yz,rank_yz,sendtag);
-	req2[14] = MPI_COMM_SCALBL.Irecv(recvbuf_YZ, recvCount_YZ,rank_YZ,recvtag);
-	req1[15] = MPI_COMM_SCALBL.Isend(sendbuf_YZ, sendCount_YZ,rank_YZ,sendtag);
-	req2[15] = MPI_COMM_SCALBL.Irecv(recvbuf_yz, recvCount_yz,rank_yz,recvtag);
-	req1[16] = MPI_COMM_SCALBL.Isend(sendbuf_Yz, sendCount_Yz,rank_Yz,sendtag);
-	req2[16] = MPI_COMM_SCALBL.Irecv(recvbuf_yZ, recvCount_yZ,rank_yZ,recvtag);
-	req1[17] = MPI_COMM_SCALBL.Isend(sendbuf_yZ, sendCount_yZ,rank_yZ,sendtag);
-	req2[17] = MPI_COMM_SCALBL.Irecv(recvbuf_Yz, recvCount_Yz,rank_Yz,recvtag);
+	req1[0]  = HaloIsend(halo_x,sendbuf_x, sendCount_x,rank_x,sendtag);
+	req2[0]  = HaloIrecv(halo_X,recvbuf_X, recvCount_X,rank_X,recvtag);
+	req1[1]  = HaloIsend(halo_X,sendbuf_X, sendCount_X,rank_X,sendtag);
+	req2[1]  = HaloIrecv(halo_x,recvbuf_x, recvCount_x,rank_x,recvtag);
+	req1[2]  = HaloIsend(halo_y,sendbuf_y, sendCount_y,rank_y,sendtag);
+	req2[2]  = HaloIrecv(halo_Y,recvbuf_Y, recvCount_Y,rank_Y,recvtag);
+	req1[3]  = HaloIsend(halo_Y,sendbuf_Y, sendCount_Y,rank_Y,sendtag);
+	req2[3]  = HaloIrecv(halo_y,recvbuf_y, recvCount_y,rank_y,recvtag);
+	req1[4]  = HaloIsend(halo_z,sendbuf_z, sendCount_z,rank_z,sendtag);
+	req2[4]  = HaloIrecv(halo_Z,recvbuf_Z, recvCount_Z,rank_Z,recvtag);
+	req1[5]  = HaloIsend(halo_Z,sendbuf_Z, sendCount_Z,rank_Z,sendtag);
+	req2[5]  = HaloIrecv(halo_z,recvbuf_z, recvCount_z,rank_z,recvtag);
+	req1[6]  = HaloIsend(halo_xy,sendbuf_xy, sendCount_xy,rank_xy,sendtag);
+	req2[6]  = HaloIrecv(halo_XY,recvbuf_XY, recvCount_XY,rank_XY,recvtag);
+	req1[7]  = HaloIsend(halo_XY,sendbuf_XY, sendCount_XY,rank_XY,sendtag);
+	req2[7]  = HaloIrecv(halo_xy,recvbuf_xy, recvCount_xy,rank_xy,recvtag);
+	req1[8]  = HaloIsend(halo_Xy,sendbuf_Xy, sendCount_Xy,rank_Xy,sendtag);
+	req2[8]  = HaloIrecv(halo_xY,recvbuf_xY, recvCount_xY,rank_xY,recvtag);
+	req1[9]  = HaloIsend(halo_xY,sendbuf_xY, sendCount_xY,rank_xY,sendtag);
+	req2[9]  = HaloIrecv(halo_Xy,recvbuf_Xy, recvCount_Xy,rank_Xy,recvtag);
+	req1[10] = HaloIsend(halo_xz,sendbuf_xz, sendCount_xz,rank_xz,sendtag);
+	req2[10] = HaloIrecv(halo_XZ,recvbuf_XZ, recvCount_XZ,rank_XZ,recvtag);
+	req1[11] = HaloIsend(halo_XZ,sendbuf_XZ, sendCount_XZ,rank_XZ,sendtag);
+	req2[11] = HaloIrecv(halo_xz,recvbuf_xz, recvCount_xz,rank_xz,recvtag);
+	req1[12] = HaloIsend(halo_Xz,sendbuf_Xz, sendCount_Xz,rank_Xz,sendtag);
+	req2[12] = HaloIrecv(halo_xZ,recvbuf_xZ, recvCount_xZ,rank_xZ,recvtag);
+	req1[13] = HaloIsend(halo_xZ,sendbuf_xZ, sendCount_xZ,rank_xZ,sendtag);
+	req2[13] = HaloIrecv(halo_Xz,recvbuf_Xz, recvCount_Xz,rank_Xz,recvtag);
+	req1[14] = HaloIsend(halo_yz,sendbuf_yz, sendCount_yz,rank_yz,sendtag);
+	req2[14] = HaloIrecv(halo_YZ,recvbuf_YZ, recvCount_YZ,rank_YZ,recvtag);
+	req1[15] = HaloIsend(halo_YZ,sendbuf_YZ, sendCount_YZ,rank_YZ,sendtag);
+	req2[15] = HaloIrecv(halo_yz,recvbuf_yz, recvCount_yz,rank_yz,recvtag);
+	req1[16] = HaloIsend(halo_Yz,sendbuf_Yz, sendCount_Yz,rank_Yz,sendtag);
+	req2[16] = HaloIrecv(halo_yZ,recvbuf_yZ, recvCount_yZ,rank_yZ,recvtag);
+	req1[17] = HaloIsend(halo_yZ,sendbuf_yZ, sendCount_yZ,rank_yZ,sendtag);
+	req2[17] = HaloIrecv(halo_Yz,recvbuf_Yz, recvCount_Yz,rank_Yz,recvtag);
 	//...................................................................................
 }
 void ScaLBL_Communicator::RecvHalo(double *data){
@@ -2078,6 +2429,7 @@ void ScaLBL_Communicator::RecvHalo(double *data){
 	MPI_COMM_SCALBL.waitAll(18,req1);
 	MPI_COMM_SCALBL.waitAll(18,req2);
 	ScaLBL_DeviceBarrier();
+	HaloRecvWait(18);
 	//...................................................................................
 	//...................................................................................
 	ScaLBL_Scalar_Unpack(dvcRecvList_x, recvCount_x,recvbuf_x, data, N);
@@ -2099,6 +2451,7 @@ void ScaLBL_Communicator::RecvHalo(double *data){
 	ScaLBL_Scalar_Unpack(dvcRecvList_Yz, recvCount_Yz,recvbuf_Yz, data, N);
 	ScaLBL_Scalar_Unpack(dvcRecvList_YZ, recvCount_YZ,recvbuf_YZ, data, N);
 	//...................................................................................
+	HaloRecvDone(18);
 	Lock=false; // unlock the communicator after communications complete
 	//...................................................................................
 }
@@ -2184,43 +2537,39 @@ void ScaLBL_Communicator::D3Q19_Pressure_BC_Z(int *neighborList, double *fq, dou
 	}
 }
 
+void ScaLBL_Communicator::SetupInletPlane(){
+	// The inlet area does not change, compute it once and split off
+	// the ranks that touch the inlet plane
+	double LocInletArea = (kproc == 0) ? double(sendCount_z) : 0.0;
+	InletArea = MPI_COMM_SCALBL.sumReduce( LocInletArea );
+	MPI_COMM_INLET = MPI_COMM_SCALBL.split( (kproc == 0) ? 0 : -1, rank );
+	InletPlane = true;
+}
+
 double ScaLBL_Communicator::D3Q19_Flux_BC_z(int *neighborList, double *fq, double flux, int time){
 	double sum, locsum, din;
-	double LocInletArea, InletArea;
 	
 	// Note that flux = rho_0 * Q
-	
-	// Compute the inlet area
-	if (kproc == 0) 
-		LocInletArea = double(sendCount_z);
-	else LocInletArea = 0.f;
-	
-	InletArea = MPI_COMM_SCALBL.sumReduce( LocInletArea );
+	if (!InletPlane) SetupInletPlane();
 	//printf("Inlet area = %f \n", InletArea);
 
-	// Set the flux BC
-	locsum = 0.f;
-	if (time%2==0){
-		if (kproc == 0) 
+	// Set the flux BC (only the ranks on the inlet plane take part)
+	din = 0.f;
+	if (kproc == 0){
+		if (time%2==0){
 			locsum = ScaLBL_D3Q19_AAeven_Flux_BC_z(dvcSendList_z, fq, flux, InletArea, sendCount_z, N);
-		
-		sum = MPI_COMM_SCALBL.sumReduce( locsum );
-
-		din = flux/InletArea + sum;
-		//if (rank==0) printf("computed din (even) =%f \n",din);
-		if (kproc == 0)
+			sum = MPI_COMM_INLET.sumReduce( locsum );
+			din = flux/InletArea + sum;
+			//if (rank==0) printf("computed din (even) =%f \n",din);
 			ScaLBL_D3Q19_AAeven_Pressure_BC_z(dvcSendList_z, fq, din, sendCount_z, N);
-	}
-	else{
-		if (kproc == 0) 
+		}
+		else{
 			locsum = ScaLBL_D3Q19_AAodd_Flux_BC_z(neighborList, dvcSendList_z, fq, flux, InletArea, sendCount_z, N);
-
-		sum = MPI_COMM_SCALBL.sumReduce( locsum );
-		din = flux/InletArea + sum;
-		
-		//if (rank==0) printf("computed din (odd)=%f \n",din);
-		if (kproc == 0) 
+			sum = MPI_COMM_INLET.sumReduce( locsum );
+			din = flux/InletArea + sum;
+			//if (rank==0) printf("computed din (odd)=%f \n",din);
 			ScaLBL_D3Q19_AAodd_Pressure_BC_z(neighborList, dvcSendList_z, fq, din, sendCount_z, N);
+		}
 	}
 	//printf("Inlet pressure = %f \n", din);
 	return din;
@@ -27,6 +27,10 @@
 #define ScalLBL_H
 #include "common/Domain.h"
 
+// Reserved values in the 16-bit neighbor list (see ScaLBL_Communicator::CompactNeighborList)
+#define D3Q19_COMPACT_BOUNCEBACK -32768
+#define D3Q19_COMPACT_ESCAPE -32767
+
 extern "C" int ScaLBL_SetDevice(int rank);
 
 extern "C" void ScaLBL_AllocateDeviceMemory(void** address, size_t size);
@@ -43,6 +47,45 @@ extern "C" void ScaLBL_CopyToZeroCopy(void* dest, const void* source, size_t siz
 
 extern "C" void ScaLBL_DeviceBarrier();
 
+// Memory accounting (common/MemoryReport.cpp)
+//   the backends record every allocation of ScaLBL_AllocateDeviceMemory and ScaLBL_AllocateZeroCopy
+//   under a tag: the name given to the allocation, else the innermost ScaLBL_MemoryTag, else "other"
+extern "C" void ScaLBL_RecordAllocation(void* address, size_t size);
+
+extern "C" void ScaLBL_RecordFree(void* address);
+
+void ScaLBL_AllocateDeviceMemory(void** address, size_t size, const char *name);
+
+// Allocations made while a tag exists are recorded under its name
+class ScaLBL_MemoryTag{
+public:
+	explicit ScaLBL_MemoryTag(const std::string &name);
+	~ScaLBL_MemoryTag();
+	ScaLBL_MemoryTag(const ScaLBL_MemoryTag&) = delete;
+	ScaLBL_MemoryTag& operator=(const ScaLBL_MemoryTag&) = delete;
+private:
+	std::string previous;
+};
+
+struct ScaLBL_MemoryUsage{
+	std::string name;
+	size_t current, peak;	// bytes
+};
+
+// Current and peak bytes of each tag on this rank, the last entry is the "total"
+std::vector<ScaLBL_MemoryUsage> ScaLBL_GetMemoryUsage();
+
+// Footprint of a model ("mrt", "nonnewtonian", "color", "freelee", "greyscale", "ion" or "poisson") without allocating:
+//   the arrays of its Create() for Np sites of the layout and N sites of the grid, and the buffers of
+//   its ScaLBL_Communicators for the send / recieve counts of the 18 directions (faces first)
+std::vector<ScaLBL_MemoryUsage> ScaLBL_PredictMemory(const std::string &model, size_t Np, size_t N,
+		const std::vector<size_t> &sendCount, const std::vector<size_t> &recvCount);
+std::vector<ScaLBL_MemoryUsage> ScaLBL_PredictMemory(const std::string &model, const Domain &Dm, size_t Np);
+
+// Print the bytes of each tag on rank 0: largest and total over the ranks of comm
+void ScaLBL_MemoryReport(const Utilities::MPI &comm, const std::string &title,
+		const std::vector<ScaLBL_MemoryUsage> &usage = ScaLBL_GetMemoryUsage());
+
 extern "C" void ScaLBL_D3Q19_Pack(int q, int *list, int start, int count, double *sendbuf, double *dist, int N);
 
 extern "C" void ScaLBL_D3Q19_Unpack(int q, int *list, int start, int count, double *recvbuf, double *dist, int N);
@@ -72,6 +115,7 @@ extern "C" void ScaLBL_D3Q19_AAeven_BGK(double *dist, int start, int finish, int
 extern "C" void ScaLBL_D3Q19_AAodd_BGK(int *neighborList, double *dist, int start, int finish, int Np, double rlx, double Fx, double Fy, double Fz);
 
 // GREYSCALE MODEL (Single-component)
+//   Poros = Perm = NULL: all sites in [start,finish) are open (porosity 1) and the drag terms are skipped
 
 extern "C" void ScaLBL_D3Q19_GreyIMRT_Init(double *Dist, int Np, double Den);
 
@@ -169,6 +213,51 @@ extern "C" void ScaLBL_D3Q19_AAeven_MRT(double *dist, int start, int finish, int
 extern "C" void ScaLBL_D3Q19_AAodd_MRT(int *d_neighborList, double *dist, int start, int finish, int Np,
 		double rlx_setA, double rlx_setB, double Fx, double Fy, double Fz);
 
+// Flow statistics accumulated by the collision kernels: the *_Stats variants add the sums over
+// the sites [start,finish) to stats (on the device), so that a model can check convergence with
+// one small copy and reduction instead of converting the velocity to the regular layout
+//   MRT:   0 sites, 1 mass, 2-4 momentum (after collision), 5 kinetic energy
+//   Color: 0-5 as for MRT (momentum before the force is applied), 6 volume of phase A (phi > 0),
+//          7-9 momentum of A, 10 volume of phase B, 11-13 momentum of B
+#define SCALBL_MRT_STATS 6
+#define SCALBL_COLOR_STATS 14
+
+extern "C" void ScaLBL_D3Q19_AAeven_MRT_Stats(double *dist, int start, int finish, int Np, double rlx_setA, double rlx_setB, double Fx,
+		double Fy, double Fz, double *stats);
+
+extern "C" void ScaLBL_D3Q19_AAodd_MRT_Stats(int *d_neighborList, double *dist, int start, int finish, int Np,
+		double rlx_setA, double rlx_setB, double Fx, double Fy, double Fz, double *stats);
+
+// MRT odd step using the 16-bit neighbor list from ScaLBL_Communicator::CompactNeighborList
+extern "C" void ScaLBL_D3Q19_AAodd_MRT_Compact(short *neighborDelta, int *escapeList, int escapeCount, double *dist,
+		int start, int finish, int Np, double rlx_setA, double rlx_setB, double Fx, double Fy, double Fz);
+
+// NON-NEWTONIAN MODEL
+// MRT collision with the viscosity of a generalized Newtonian fluid at the local shear rate. The
+// shear rate comes from the non-equilibrium moments relaxed with the viscosity of the previous
+// timestep, Viscosity (Np values) holds the viscosity of each site and is updated by the collision
+//   rheology 0 (power law):  nu = nu_0 * rate^(n_index-1)
+//   rheology 1 (Carreau):    nu = nu_inf + (nu_0-nu_inf) * (1 + (lambda*rate)^2)^((n_index-1)/2)
+// the viscosity is limited to [nu_min,nu_max]. The _Stats variants add the SCALBL_MRT_STATS values
+// followed by the sum of the viscosity to stats
+#define SCALBL_NONNEWTONIAN_STATS 7
+
+extern "C" void ScaLBL_D3Q19_AAeven_NonNewtonianMRT(double *dist, double *Viscosity, int start, int finish, int Np,
+		int rheology, double nu_0, double nu_inf, double lambda, double n_index, double nu_min, double nu_max,
+		double Fx, double Fy, double Fz);
+
+extern "C" void ScaLBL_D3Q19_AAodd_NonNewtonianMRT(int *neighborList, double *dist, double *Viscosity, int start, int finish,
+		int Np, int rheology, double nu_0, double nu_inf, double lambda, double n_index, double nu_min, double nu_max,
+		double Fx, double Fy, double Fz);
+
+extern "C" void ScaLBL_D3Q19_AAeven_NonNewtonianMRT_Stats(double *dist, double *Viscosity, int start, int finish, int Np,
+		int rheology, double nu_0, double nu_inf, double lambda, double n_index, double nu_min, double nu_max,
+		double Fx, double Fy, double Fz, double *stats);
+
+extern "C" void ScaLBL_D3Q19_AAodd_NonNewtonianMRT_Stats(int *neighborList, double *dist, double *Viscosity, int start, int finish,
+		int Np, int rheology, double nu_0, double nu_inf, double lambda, double n_index, double nu_min, double nu_max,
+		double Fx, double Fy, double Fz, double *stats);
+
 // COLOR MODEL
 extern "C" void ScaLBL_D3Q19_AAeven_Color(int *Map, double *dist, double *Aq, double *Bq, double *Den, double *Phi,
 		double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
@@ -178,6 +267,25 @@ extern "C" void ScaLBL_D3Q19_AAodd_Color(int *d_neighborList, int *Map, double *
 		double *Phi, double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
 		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np);
 
+// Color collision that also accumulates SCALBL_COLOR_STATS flow statistics (see the MRT model)
+extern "C" void ScaLBL_D3Q19_AAeven_Color_Stats(int *Map, double *dist, double *Aq, double *Bq, double *Den, double *Phi,
+		double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np, double *stats);
+
+extern "C" void ScaLBL_D3Q19_AAodd_Color_Stats(int *d_neighborList, int *Map, double *dist, double *Aq, double *Bq, double *Den, 
+		double *Phi, double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np, double *stats);
+
+// Color collision with the D3Q7 phase field update folded in: Den and PhiOut are computed from Aq/Bq,
+// the color gradient uses Phi from the previous half-step (Phi and PhiOut must not alias)
+extern "C" void ScaLBL_D3Q19_AAeven_Color_Combined(int *Map, double *dist, double *Aq, double *Bq, double *Den, double *Phi, double *PhiOut,
+		double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np);
+
+extern "C" void ScaLBL_D3Q19_AAodd_Color_Combined(int *d_neighborList, int *Map, double *dist, double *Aq, double *Bq, double *Den,
+		double *Phi, double *PhiOut, double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np);
+
 extern "C" void ScaLBL_D3Q7_AAodd_PhaseField(int *NeighborList, int *Map, double *Aq, double *Bq, 
 			double *Den, double *Phi, int start, int finish, int Np);
 
@@ -360,6 +468,11 @@ public:
 	
 	int next;
 	int first_interior,last_interior;
+	int exterior_split,interior_split;	// first site of the second class (see MemoryOptimizedLayoutAA)
+	// Ordering of the interior sites in MemoryOptimizedLayoutAA
+	//   "raster" (default), "tile", "morton" or "hilbert" (Domain { interior_ordering })
+	std::string interior_ordering;
+	int interior_tile[3];	// tile size for "tile" ordering (Domain { interior_tile })
 	//......................................................................................
 	//  Set up for D319 distributions
 	// 		- determines how much memory is allocated
@@ -377,9 +490,20 @@ public:
 	int LastExterior();
 	int FirstInterior();
 	int LastInterior();
+	int ExteriorSplit();
+	int InteriorSplit();
 	
-	double GetPerformance(int *NeighborList, double *fq, int Np);
-	int MemoryOptimizedLayoutAA(IntArray &Map, int *neighborList, signed char *id, int Np, int width);
+	// MLUPS of the MRT kernels alone (no communication), timed over timesteps odd/even step pairs
+	double GetPerformance(int *NeighborList, double *fq, int Np, int timesteps=500);
+	/*
+	 * site_class (optional, regular layout): within the exterior and the interior, the sites with
+	 *   site_class[n] == 0 are stored first, followed by the sites with site_class[n] != 0
+	 *   i.e. [0,ExteriorSplit()) and [FirstInterior(),InteriorSplit()) are class 0,
+	 *   [ExteriorSplit(),LastExterior()) and [InteriorSplit(),LastInterior()) are class 1
+	 */
+	int MemoryOptimizedLayoutAA(IntArray &Map, int *neighborList, signed char *id, int Np, int width,
+			const signed char *site_class=NULL);
+	int CompactNeighborList(const int *neighborList, short *neighborDelta, std::vector<int> &escapeList, int Np);
 	void Barrier(){
 		ScaLBL_DeviceBarrier();
 		MPI_COMM_SCALBL.barrier();
@@ -395,6 +519,8 @@ public:
 	void SendHalo(double *data);
 	void RecvHalo(double *data);
 	void RecvGrad(double *Phi, double *Gradient);
+	// number of neighbors exchanged through shared memory (Domain { halo_shared_memory = true })
+	int SharedMemoryNeighbors() const;
 	void RegularLayout(IntArray map, const double *data, DoubleArray &regdata);
 	void SetupBounceBackList(IntArray &Map, signed char *id, int Np, bool SlippingVelBC=false);
     void SolidDirichletD3Q7(double *fq, double *BoundaryValue);
@@ -409,6 +535,7 @@ public:
     void D3Q19_Pressure_BC_Z(int *neighborList, double *fq, double dout, int time);
     void D3Q19_Reflection_BC_z(double *fq);
     void D3Q19_Reflection_BC_Z(double *fq);
+    // returns the inlet pressure on the inlet plane (kproc == 0), 0 on the other ranks
     double D3Q19_Flux_BC_z(int *neighborList, double *fq, double flux, int time);
     void D3Q7_Poisson_Potential_BC_z(int *neighborList, double *fq, double Vin, int time);
     void D3Q7_Poisson_Potential_BC_Z(int *neighborList, double *fq, double Vout, int time);
@@ -431,6 +558,20 @@ public:
 
 private:
 	void D3Q19_MapRecv(int Cqx, int Cqy, int Cqz, const int *list,  int start, int count, int *d3q19_recvlist);
+	void OrderInteriorSites(std::vector<int> &sites, int width);
+	void SetupInletPlane();
+	// Halo exchange with the neighbors on the same node through an MPI-3 shared memory window
+	//   the directions are numbered as the requests (req1, req2), the opposite of d is d^1
+	enum HaloDirection { halo_x, halo_X, halo_y, halo_Y, halo_z, halo_Z, halo_xy, halo_XY, halo_Xy, halo_xY,
+		halo_xz, halo_XZ, halo_Xz, halo_xZ, halo_yz, halo_YZ, halo_Yz, halo_yZ };
+	void SetupSharedHalo();
+	void FreeSharedHalo();
+	void HaloBuffers(double **send[18], double **recv[18], int sendCount[18], int recvCount[18], int neighbor[18]);
+	void HaloSendBegin(int ndir);
+	void HaloRecvWait(int ndir);
+	void HaloRecvDone(int ndir);
+	MPI_Request HaloIsend(int d, double *buf, int count, int dest, int tag);
+	MPI_Request HaloIrecv(int d, double *buf, int count, int source, int tag);
 
 	bool Lock; 	// use Lock to make sure only one call at a time to protect data in transit
 	// only one set of Send requests can be active at any time (per instance)
@@ -442,7 +583,22 @@ private:
 	// Give the object it's own MPI communicator
 	RankInfoStruct rank_info;
 	Utilities::MPI MPI_COMM_SCALBL;		// MPI Communicator for this domain
+	// Inlet plane (kproc == 0) for the flux boundary condition, set up by the
+	// first call that needs it (collective over MPI_COMM_SCALBL)
+	bool InletPlane;
+	double InletArea;
+	Utilities::MPI MPI_COMM_INLET;		// ranks on the inlet plane only
 	MPI_Request req1[18],req2[18];
+	// Shared memory halo: each rank owns one segment of HaloWindow with the flags
+	//   ready[18] (last exchange packed) and done[18] (last exchange unpacked),
+	//   the offsets of the 18 send buffers and the send buffers; recvbuf_d of an
+	//   on-node neighbor points to the send buffer of that neighbor
+	bool HaloShared[18];
+	long long HaloStep[18];
+	long long *HaloFlags;
+	long long *HaloNeighborFlags[18];
+	MPI_Win HaloWindow;
+	Utilities::MPI MPI_COMM_NODE;
 	//......................................................................................
 	// MPI ranks for all 18 neighbors
 	//......................................................................................
@@ -46,6 +46,10 @@
 #include "common/Database.h"
 #include "common/SpherePack.h"
 
+#include <algorithm>
+#include <functional>
+#include <vector>
+
 // Inline function to read line without a return argument
 static inline void fgetl( char * str, int num, FILE * stream )
 {
@@ -105,22 +109,138 @@ void ReadSpherePacking(int nspheres, double *List_cx, double *List_cy, double *L
 	// .............................................................
 }
 
+/********************************************************
+ * Spatial index of the spheres                         *
+ ********************************************************/
+// Sphere mapped to the local sub-domain and the (non-empty) range of grid points it touches
+struct SphereBox {
+	double cx, cy, cz, r;
+	int imin, imax, jmin, jmax, kmin, kmax;
+};
+
+static inline int ClipIndex(int i, int N)
+{
+	return std::min( std::max( i, 0 ), N );
+}
+
+static void AddSphereBox(std::vector<SphereBox> &boxes, double cx, double cy, double cz, double r,
+		int imin, int imax, int jmin, int jmax, int kmin, int kmax, int Nx, int Ny, int Nz)
+{
+	SphereBox box = { cx, cy, cz, r, ClipIndex(imin,Nx), ClipIndex(imax,Nx),
+		ClipIndex(jmin,Ny), ClipIndex(jmax,Ny), ClipIndex(kmin,Nz), ClipIndex(kmax,Nz) };
+	// spheres that miss this sub-domain are dropped here
+	if (box.imin < box.imax && box.jmin < box.jmax && box.kmin < box.kmax)
+		boxes.push_back( box );
+}
+
+// Bucket the boxes into slabs of z-planes (a uniform grid in z) and call fun(box,k0,k1)
+// for each box clipped to each slab it overlaps.  The slabs are handed out to the threads
+// (Utilities::parallelFor), so a grid point is only written by the thread that owns its slab.
+static void ForEachSlab(int Nz, const std::vector<SphereBox> &boxes,
+		const std::function<void(const SphereBox&,int,int)> &fun)
+{
+	const int slab = 4;
+	int nslabs = (Nz+slab-1)/slab;
+	std::vector<std::vector<int>> bucket( nslabs );
+	for (size_t b=0; b<boxes.size(); b++){
+		for (int s=boxes[b].kmin/slab; s<=(boxes[b].kmax-1)/slab; s++)
+			bucket[s].push_back( b );
+	}
+	Utilities::parallelFor( nslabs, [&]( int s ){
+		for (int b : bucket[s]){
+			const auto &box = boxes[b];
+			fun( box, std::max( box.kmin, s*slab ), std::min( box.kmax, (s+1)*slab ) );
+		}
+	});
+}
+
+// Range of sub-domains in one direction that may be touched by SignedDistance for a sphere
+// at x with radius r (a superset: the band is 2r plus two grid points on each side)
+static void RankRange(double x, double r, double h, int N, int nproc, int &pmin, int &pmax)
+{
+	// sub-domain p spans [(p*(N-2)-1)*h, (p*(N-2)+N-2)*h]
+	pmin = int( floor( ((x-2*r)/h - N) / (N-2) ) );
+	pmax = int( floor( ((x+2*r)/h + 4) / (N-2) ) );
+	pmin = std::max( pmin, 0 );
+	pmax = std::min( pmax, nproc-1 );
+}
+
+void DistributeSpherePacking(const Utilities::MPI &comm, int nspheres,
+		const double *List_cx, const double *List_cy, const double *List_cz, const double *List_rad,
+		double Lx, double Ly, double Lz, int Nx, int Ny, int Nz, int nprocx, int nprocy, int nprocz,
+		std::vector<double> &cx, std::vector<double> &cy, std::vector<double> &cz, std::vector<double> &rad)
+{
+	int rank = comm.getRank();
+	int nprocs = comm.getSize();
+	INSIST( nprocs == nprocx*nprocy*nprocz, "DistributeSpherePacking: communicator does not match the process grid" );
+	double hx = Lx/((Nx-2)*nprocx-1);
+	double hy = Ly/((Ny-2)*nprocy-1);
+	double hz = Lz/((Nz-2)*nprocz-1);
+	std::vector<int> send_count( nprocs, 0 ), send_disp( nprocs, 0 );
+	std::vector<double> send;
+	if (rank == 0){
+		// count the spheres of each rank, then pack them in the order of the list
+		auto forEachRank = [&]( int p, const std::function<void(int)> &fun ){
+			int imin, imax, jmin, jmax, kmin, kmax;
+			RankRange( List_cx[p], List_rad[p], hx, Nx, nprocx, imin, imax );
+			RankRange( List_cy[p], List_rad[p], hy, Ny, nprocy, jmin, jmax );
+			RankRange( List_cz[p], List_rad[p], hz, Nz, nprocz, kmin, kmax );
+			for (int kp=kmin; kp<=kmax; kp++)
+				for (int jp=jmin; jp<=jmax; jp++)
+					for (int ip=imin; ip<=imax; ip++)
+						fun( kp*nprocx*nprocy + jp*nprocx + ip );
+		};
+		for (int p=0; p<nspheres; p++)
+			forEachRank( p, [&]( int rnk ){ send_count[rnk] += 4; } );
+		for (int rnk=1; rnk<nprocs; rnk++)
+			send_disp[rnk] = send_disp[rnk-1] + send_count[rnk-1];
+		send.resize( send_disp[nprocs-1] + send_count[nprocs-1] );
+		std::vector<int> offset( send_disp );
+		for (int p=0; p<nspheres; p++){
+			forEachRank( p, [&]( int rnk ){
+				double *sphere = &send[offset[rnk]];
+				sphere[0] = List_cx[p];
+				sphere[1] = List_cy[p];
+				sphere[2] = List_cz[p];
+				sphere[3] = List_rad[p];
+				offset[rnk] += 4;
+			} );
+		}
+	}
+	std::vector<int> recv_count( nprocs ), recv_disp( nprocs, 0 );
+	comm.allToAll( 1, send_count.data(), recv_count.data() );
+	for (int rnk=1; rnk<nprocs; rnk++)
+		recv_disp[rnk] = recv_disp[rnk-1] + recv_count[rnk-1];
+	std::vector<double> recv( recv_disp[nprocs-1] + recv_count[nprocs-1] );
+	comm.allToAll( send.data(), send_count.data(), send_disp.data(),
+		recv.data(), recv_count.data(), recv_disp.data(), true );
+	size_t count = recv.size()/4;
+	cx.resize( count );
+	cy.resize( count );
+	cz.resize( count );
+	rad.resize( count );
+	for (size_t p=0; p<count; p++){
+		cx[p] = recv[4*p];
+		cy[p] = recv[4*p+1];
+		cz[p] = recv[4*p+2];
+		rad[p] = recv[4*p+3];
+	}
+}
+
+
+/********************************************************
+ * Voxelization and signed distance                     *
+ ********************************************************/
 void AssignLocalSolidID(char *ID, int nspheres, double *List_cx, double *List_cy, double *List_cz, double *List_rad,
 		double Lx, double Ly, double Lz, int Nx, int Ny, int Nz, 
 		int iproc, int jproc, int kproc, int nprocx, int nprocy, int nprocz)
 {
 	// Use sphere lists to determine which nodes are in porespace
 	// Write out binary file for nodes
-	char value;
 	int N = Nx*Ny*Nz;     // Domain size, including the halo
 	double hx,hy,hz;
-	double x,y,z;
-	double cx,cy,cz,r;
-	int imin,imax,jmin,jmax,kmin,kmax;
-	int p,i,j,k,n;
 	//............................................
 	double min_x,min_y,min_z;
-	//    double max_x,max_y,max_z;
 	//............................................
 	// Lattice spacing for the entire domain
 	// It should generally be true that hx=hy=hz
@@ -134,69 +254,45 @@ void AssignLocalSolidID(char *ID, int nspheres, double *List_cx, double *List_cy
 	min_x = double(iproc*Nx-1)*hx;
 	min_y = double(jproc*Ny-1)*hy;
 	min_z = double(kproc*Nz-1)*hz;
-	//    max_x = ((iproc+1)*Nx+1)*hx;
-	//    max_y = ((jproc+1)*Ny+1)*hy;
-	//    max_z = ((kproc+1)*Nz+1)*hz;
 	//............................................
 
 	//............................................
 	// Pre-initialize local ID 
-	for (n=0;n<N;n++){
+	for (int n=0;n<N;n++){
 		ID[n]=1;
 	}
 	//............................................
 
 	//............................................
-	// .........Loop over the spheres.............
-	for (p=0;p<nspheres;p++){
+	// Range of each sphere on the local grid
+	std::vector<SphereBox> boxes;
+	for (int p=0;p<nspheres;p++){
 		// Get the sphere from the list, map to local min
-		cx = List_cx[p] - min_x;
-		cy = List_cy[p] - min_y;
-		cz = List_cz[p] - min_z;
-		r = List_rad[p];
-		// Check if
-		// Range for this sphere in global indexing
-		imin = int ((cx-r)/hx)-1;
-		imax = int ((cx+r)/hx)+1;
-		jmin = int ((cy-r)/hy)-1;
-		jmax = int ((cy+r)/hy)+1;
-		kmin = int ((cz-r)/hz)-1;
-		kmax = int ((cz+r)/hz)+1;
-		// Obviously we have to do something at the edges
-		if (imin<0)        imin = 0;
-		if (imin>Nx)    imin = Nx;
-		if (imax<0)        imax = 0;
-		if (imax>Nx)    imax = Nx;
-		if (jmin<0)        jmin = 0;
-		if (jmin>Ny)    jmin = Ny;
-		if (jmax<0)        jmax = 0;
-		if (jmax>Ny)    jmax = Ny;
-		if (kmin<0)        kmin = 0;
-		if (kmin>Nz)    kmin = Nz;
-		if (kmax<0)        kmax = 0;
-		if (kmax>Nz)    kmax = Nz;
-		// Loop over the domain for this sphere (may be null)
-		for (i=imin;i<imax;i++){
-			for (j=jmin;j<jmax;j++){
-				for (k=kmin;k<kmax;k++){
-					// Initialize ID value to 'fluid (=1)'
-					x = i*hx;
-					y = j*hy;
-					z = k*hz;
-					value = 1;
-					// if inside sphere, set to zero
-					if ( (cx-x)*(cx-x)+(cy-y)*(cy-y)+(cz-z)*(cz-z) < r*r){
-						value=0;
-					}
-					// get the position in the list
-					n = k*Nx*Ny+j*Nx+i;
-					if ( ID[n] != 0 ){
-						ID[n] = value;
+		double cx = List_cx[p] - min_x;
+		double cy = List_cy[p] - min_y;
+		double cz = List_cz[p] - min_z;
+		double r = List_rad[p];
+		AddSphereBox( boxes, cx, cy, cz, r,
+			int ((cx-r)/hx)-1, int ((cx+r)/hx)+1,
+			int ((cy-r)/hy)-1, int ((cy+r)/hy)+1,
+			int ((cz-r)/hz)-1, int ((cz+r)/hz)+1, Nx, Ny, Nz );
+	}
+	// Nodes inside any sphere are solid (=0)
+	ForEachSlab( Nz, boxes, [&]( const SphereBox &box, int kmin, int kmax ){
+		double r2 = box.r*box.r;
+		for (int k=kmin;k<kmax;k++){
+			double dz = box.cz - k*hz;
+			for (int j=box.jmin;j<box.jmax;j++){
+				double dy = box.cy - j*hy;
+				for (int i=box.imin;i<box.imax;i++){
+					double dx = box.cx - i*hx;
+					if ( dx*dx+dy*dy+dz*dz < r2 ){
+						ID[k*Nx*Ny+j*Nx+i] = 0;
 					}
 				}
 			}
 		}
-	}
+	} );
 }
 
 void SignedDistance(double *Distance, int nspheres, double *List_cx, double *List_cy, double *List_cz, double *List_rad,
@@ -207,13 +303,8 @@ void SignedDistance(double *Distance, int nspheres, double *List_cx, double *Lis
 	// Write out binary file for nodes
 	int N = Nx*Ny*Nz;     // Domain size, including the halo
 	double hx,hy,hz;
-	double x,y,z;
-	double cx,cy,cz,r;
-	int imin,imax,jmin,jmax,kmin,kmax;
-	int p,i,j,k,n;
 	//............................................
 	double min_x,min_y,min_z;
-	double distance;
 	//............................................
 	// Lattice spacing for the entire domain
 	// It should generally be true that hx=hy=hz
@@ -231,61 +322,41 @@ void SignedDistance(double *Distance, int nspheres, double *List_cx, double *Lis
 
 	//............................................
 	// Pre-initialize Distance 
-	for (n=0;n<N;n++){
+	for (int n=0;n<N;n++){
 		Distance[n]=100.0;
 	}
 	//............................................
 
 	//............................................
-	// .........Loop over the spheres.............
-	for (p=0;p<nspheres;p++){
+	// Range of each sphere on the local grid
+	std::vector<SphereBox> boxes;
+	for (int p=0;p<nspheres;p++){
 		// Get the sphere from the list, map to local min
-		cx = List_cx[p] - min_x;
-		cy = List_cy[p] - min_y;
-		cz = List_cz[p] - min_z;
-		r = List_rad[p];
-		// Check if
-		// Range for this sphere in global indexing
-		imin = int ((cx-2*r)/hx);
-		imax = int ((cx+2*r)/hx)+2;
-		jmin = int ((cy-2*r)/hy);
-		jmax = int ((cy+2*r)/hy)+2;
-		kmin = int ((cz-2*r)/hz);
-		kmax = int ((cz+2*r)/hz)+2;
-		// Obviously we have to do something at the edges
-		if (imin<0)        imin = 0;
-		if (imin>Nx)    imin = Nx;
-		if (imax<0)        imax = 0;
-		if (imax>Nx)    imax = Nx;
-		if (jmin<0)        jmin = 0;
-		if (jmin>Ny)    jmin = Ny;
-		if (jmax<0)        jmax = 0;
-		if (jmax>Ny)    jmax = Ny;
-		if (kmin<0)        kmin = 0;
-		if (kmin>Nz)    kmin = Nz;
-		if (kmax<0)        kmax = 0;
-		if (kmax>Nz)    kmax = Nz;
-		// Loop over the domain for this sphere (may be null)
-		for (i=imin;i<imax;i++){
-			for (j=jmin;j<jmax;j++){
-				for (k=kmin;k<kmax;k++){
-					// x,y,z is distance in physical units
-					x = i*hx;
-					y = j*hy;
-					z = k*hz;
-					// if inside sphere, set to zero
-					// get the position in the list
-					n = k*Nx*Ny+j*Nx+i;            
-					// Compute the distance
-					distance = sqrt((cx-x)*(cx-x)+(cy-y)*(cy-y)+(cz-z)*(cz-z)) - r;
-					// Assign the minimum distance
+		double cx = List_cx[p] - min_x;
+		double cy = List_cy[p] - min_y;
+		double cz = List_cz[p] - min_z;
+		double r = List_rad[p];
+		AddSphereBox( boxes, cx, cy, cz, r,
+			int ((cx-2*r)/hx), int ((cx+2*r)/hx)+2,
+			int ((cy-2*r)/hy), int ((cy+2*r)/hy)+2,
+			int ((cz-2*r)/hz), int ((cz+2*r)/hz)+2, Nx, Ny, Nz );
+	}
+	// Assign the minimum distance (in physical units) over the spheres
+	ForEachSlab( Nz, boxes, [&]( const SphereBox &box, int kmin, int kmax ){
+		for (int k=kmin;k<kmax;k++){
+			double dz = box.cz - k*hz;
+			for (int j=box.jmin;j<box.jmax;j++){
+				double dy = box.cy - j*hy;
+				for (int i=box.imin;i<box.imax;i++){
+					double dx = box.cx - i*hx;
+					int n = k*Nx*Ny+j*Nx+i;
+					double distance = sqrt(dx*dx+dy*dy+dz*dz) - box.r;
 					if (distance < Distance[n])        Distance[n] = distance;
-
 				}
 			}
 		}
-	}
+	} );
 
 	// Map the distance to lattice units
-	for (n=0; n<N; n++)    Distance[n] = Distance[n]/hx;
+	for (int n=0; n<N; n++)    Distance[n] = Distance[n]/hx;
 }
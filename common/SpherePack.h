@@ -32,6 +32,8 @@
 #include "common/Communication.h"
 #include "common/Database.h"
 
+#include <vector>
+
 /*
 Simple tools to work with sphere packs
  */
@@ -42,6 +44,21 @@ void WriteLocalSolidDistance(char *FILENAME, double *Distance, int N);
 
 void ReadSpherePacking(int nspheres, double *List_cx, double *List_cy, double *List_cz, double *List_rad);
 
+/*!
+ * @brief  Send each rank the spheres that overlap its sub-domain
+ * @details  The sphere list is only needed on rank 0.  Each sphere is sent to the
+ *    ranks whose sub-domain (Nx,Ny,Nz include the halo, as for SignedDistance)
+ *    overlaps the sphere and its signed distance band, instead of broadcasting the
+ *    full list.  The spheres keep the order of the list.
+ * @param[in] comm      Communicator with nprocx*nprocy*nprocz ranks
+ * @param[in] nspheres  Number of spheres in the list (rank 0)
+ * @param[out] cx,cy,cz,rad     Local spheres
+ */
+void DistributeSpherePacking(const Utilities::MPI &comm, int nspheres,
+			const double *List_cx, const double *List_cy, const double *List_cz, const double *List_rad,
+			double Lx, double Ly, double Lz, int Nx, int Ny, int Nz, int nprocx, int nprocy, int nprocz,
+			std::vector<double> &cx, std::vector<double> &cy, std::vector<double> &cz, std::vector<double> &rad);
+
 void AssignLocalSolidID(char *ID, int nspheres, double *List_cx, double *List_cy, double *List_cz, double *List_rad,
 			double Lx, double Ly, double Lz, int Nx, int Ny, int Nz, 
 			int iproc, int jproc, int kproc, int nprocx, int nprocy, int nprocz);
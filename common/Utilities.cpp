@@ -17,6 +17,7 @@
 #include "common/Utilities.h"
 #include "StackTrace/StackTrace.h"
 #include "StackTrace/ErrorHandlers.h"
+#include "threadpool/thread_pool.h"
 
 #ifdef USE_TIMER
 #include "MemoryApp.h"
@@ -28,7 +29,10 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
+#include <cstdlib>
 #include <math.h>
+#include <memory>
 #include <mutex>
 
 
@@ -82,6 +86,8 @@ void Utilities::startup( int argc, char **argv, bool multiple )
 }
 void Utilities::shutdown()
 {
+    // Stop the threads of parallelFor
+    Utilities::setNumThreads( 1 );
     // Clear the error handlers
     Utilities::clearErrorHandlers();
     StackTrace::clearSignals();
@@ -204,3 +210,66 @@ void Utilities::nullUse( void* data )
 
 
 
+
+
+/****************************************************************************
+ *  Threads used by parallelFor                                              *
+ ****************************************************************************/
+static std::mutex parallel_mutex;
+static std::unique_ptr<ThreadPool> parallel_tpool;
+static thread_local bool in_parallelFor = false;
+static int &numThreads()
+{
+    static int N = std::max( atoi( Utilities::getenv( "LBPM_NUM_THREADS" ).data() ), 1 );
+    return N;
+}
+class ParallelForWorkItem : public ThreadPool::WorkItemRet<void>
+{
+public:
+    ParallelForWorkItem( const std::function<void()> &run ) : d_run( run ) {}
+    virtual void run() override { d_run(); }
+private:
+    const std::function<void()> &d_run;
+};
+void Utilities::setNumThreads( int N )
+{
+    std::lock_guard<std::mutex> lock( parallel_mutex );
+    numThreads() = std::max( N, 1 );
+    if ( numThreads() == 1 )
+        parallel_tpool.reset();
+    else if ( parallel_tpool )
+        parallel_tpool->setNumThreads( numThreads()-1 );
+}
+int Utilities::getNumThreads()
+{
+    return numThreads();
+}
+void Utilities::parallelFor( int N, const std::function<void(int)> &fun )
+{
+    int Nt = std::min( numThreads(), N );
+    if ( Nt <= 1 || in_parallelFor ) {
+        for (int i=0; i<N; i++)
+            fun( i );
+        return;
+    }
+    ThreadPool *tpool;
+    {
+        std::lock_guard<std::mutex> lock( parallel_mutex );
+        if ( !parallel_tpool )
+            parallel_tpool.reset( new ThreadPool( numThreads()-1 ) );
+        tpool = parallel_tpool.get();
+    }
+    std::atomic<int> next( 0 );
+    std::function<void()> run = [&]() {
+        in_parallelFor = true;
+        for (int i=next++; i<N; i=next++)
+            fun( i );
+        in_parallelFor = false;
+    };
+    std::vector<ThreadPool::WorkItem *> work;
+    for (int t=1; t<Nt; t++)
+        work.push_back( new ParallelForWorkItem( run ) );
+    auto ids = tpool->add_work( work );
+    run();
+    tpool->wait_all( ids );
+}
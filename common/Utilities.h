@@ -18,6 +18,7 @@
 #define included_Utilities
 
 #include <cstdarg>
+#include <functional>
 #include <vector>
 
 #include "StackTrace/Utilities.h"
@@ -84,6 +85,31 @@ std::vector<int> factor(size_t number);
 void nullUse( void* );
 
 
+/*!
+ * \brief Set the number of threads used by parallelFor
+ * \details  This is the one thread count of the process for the threaded loops of
+ *    the library.  The default is read from the environmental variable LBPM_NUM_THREADS
+ *    (1, no threads, if it is not set).
+ * \param N                 Number of threads (including the calling thread)
+ */
+void setNumThreads( int N );
+
+
+//! Get the number of threads used by parallelFor
+int getNumThreads();
+
+
+/*!
+ * \brief Call fun(i) for each i in [0,N)
+ * \details  The indices are handed out one at a time to the calling thread and the
+ *    workers of a thread pool with getNumThreads()-1 threads.  Calls of parallelFor
+ *    from inside fun run serially on the calling thread.
+ * \param N                 Number of indices
+ * \param fun               Function to call, it may run concurrently for different i
+ */
+void parallelFor( int N, const std::function<void(int)> &fun );
+
+
 } // namespace Utilities
 
 
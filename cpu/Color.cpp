@@ -15,6 +15,7 @@
   along with OPM.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include <math.h>
+#include "common/ColorCombined.hpp"
 
 #define STOKES
 
@@ -1264,9 +1265,12 @@ extern "C" void ScaLBL_SetSlice_z(double *Phi, double value, int Nx, int Ny, int
 //extern "C" void ScaLBL_D3Q19_AAeven_Color(double *dist, double *Aq, double *Bq, double *Den, double *Velocity,
 //		double *ColorGrad, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
 //		double Fx, double Fy, double Fz, int start, int finish, int Np){
-extern "C" void ScaLBL_D3Q19_AAeven_Color(int *Map, double *dist, double *Aq, double *Bq, double *Den, double *Phi,
+template<bool STATS>
+static void AAeven_Color(int *Map, double *dist, double *Aq, double *Bq, double *Den, double *Phi,
 		double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
-		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np){
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np, double *stats){
+	double mass = 0.0, mom_x = 0.0, mom_y = 0.0, mom_z = 0.0, energy = 0.0;
+	double vol_A = 0.0, vol_B = 0.0, mom_A[3] = {0.0,0.0,0.0}, mom_B[3] = {0.0,0.0,0.0};
 
 	int ijk,nn;
 	double fq;
@@ -1840,16 +1844,67 @@ extern "C" void ScaLBL_D3Q19_AAeven_Color(int *Map, double *dist, double *Aq, do
 		Bq[6*Np+n] = b2;
 		//...............................................
 
+		if (STATS){
+			// phase A where phi > 0, as in SubPhase::Basic
+			mass += rho;
+			mom_x += jx;
+			mom_y += jy;
+			mom_z += jz;
+			energy += 0.5*rho0*(ux*ux+uy*uy+uz*uz);
+			if (phi > 0.0){
+				vol_A += 1.0;
+				mom_A[0] += rhoA*ux;
+				mom_A[1] += rhoA*uy;
+				mom_A[2] += rhoA*uz;
+			}
+			else{
+				vol_B += 1.0;
+				mom_B[0] += rhoB*ux;
+				mom_B[1] += rhoB*uy;
+				mom_B[2] += rhoB*uz;
+			}
+		}
 	}
 	
+	if (STATS && finish > start){
+		stats[0] += double(finish-start);
+		stats[1] += mass;
+		stats[2] += mom_x;
+		stats[3] += mom_y;
+		stats[4] += mom_z;
+		stats[5] += energy;
+		stats[6] += vol_A;
+		stats[10] += vol_B;
+		for (int d=0; d<3; d++){
+			stats[7+d] += mom_A[d];
+			stats[11+d] += mom_B[d];
+		}
+	}
+}
+
+extern "C" void ScaLBL_D3Q19_AAeven_Color(int *Map, double *dist, double *Aq, double *Bq, double *Den, double *Phi,
+		double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np){
+	AAeven_Color<false>(Map, dist, Aq, Bq, Den, Phi, Vel, rhoA, rhoB, tauA, tauB, alpha, beta,
+			Fx, Fy, Fz, strideY, strideZ, start, finish, Np, NULL);
+}
+
+extern "C" void ScaLBL_D3Q19_AAeven_Color_Stats(int *Map, double *dist, double *Aq, double *Bq, double *Den, double *Phi,
+		double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np, double *stats){
+	AAeven_Color<true>(Map, dist, Aq, Bq, Den, Phi, Vel, rhoA, rhoB, tauA, tauB, alpha, beta,
+			Fx, Fy, Fz, strideY, strideZ, start, finish, Np, stats);
 }
 
 //extern "C" void ScaLBL_D3Q19_AAodd_Color(int *neighborList, double *dist, double *Aq, double *Bq, double *Den, double *Velocity,
 //		double *ColorGrad, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
 //		double Fx, double Fy, double Fz, int start, int finish, int Np){
-extern "C" void ScaLBL_D3Q19_AAodd_Color(int *neighborList, int *Map, double *dist, double *Aq, double *Bq, double *Den, 
+template<bool STATS>
+static void AAodd_Color(int *neighborList, int *Map, double *dist, double *Aq, double *Bq, double *Den, 
 		double *Phi, double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
-		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np){
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np, double *stats){
+	double mass = 0.0, mom_x = 0.0, mom_y = 0.0, mom_z = 0.0, energy = 0.0;
+	double vol_A = 0.0, vol_B = 0.0, mom_A[3] = {0.0,0.0,0.0}, mom_B[3] = {0.0,0.0,0.0};
 	
 	int nn,ijk,nread;
 	int nr1,nr2,nr3,nr4,nr5,nr6;
@@ -2499,7 +2554,76 @@ extern "C" void ScaLBL_D3Q19_AAodd_Color(int *neighborList, int *Map, double *di
 		Aq[nr5] = a2;
 		Bq[nr5] = b2;
 		//...............................................
+		if (STATS){
+			// phase A where phi > 0, as in SubPhase::Basic
+			mass += rho;
+			mom_x += jx;
+			mom_y += jy;
+			mom_z += jz;
+			energy += 0.5*rho0*(ux*ux+uy*uy+uz*uz);
+			if (phi > 0.0){
+				vol_A += 1.0;
+				mom_A[0] += rhoA*ux;
+				mom_A[1] += rhoA*uy;
+				mom_A[2] += rhoA*uz;
+			}
+			else{
+				vol_B += 1.0;
+				mom_B[0] += rhoB*ux;
+				mom_B[1] += rhoB*uy;
+				mom_B[2] += rhoB*uz;
+			}
+		}
 	}	
+	if (STATS && finish > start){
+		stats[0] += double(finish-start);
+		stats[1] += mass;
+		stats[2] += mom_x;
+		stats[3] += mom_y;
+		stats[4] += mom_z;
+		stats[5] += energy;
+		stats[6] += vol_A;
+		stats[10] += vol_B;
+		for (int d=0; d<3; d++){
+			stats[7+d] += mom_A[d];
+			stats[11+d] += mom_B[d];
+		}
+	}
+}
+
+extern "C" void ScaLBL_D3Q19_AAodd_Color(int *neighborList, int *Map, double *dist, double *Aq, double *Bq, double *Den, 
+		double *Phi, double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np){
+	AAodd_Color<false>(neighborList, Map, dist, Aq, Bq, Den, Phi, Vel, rhoA, rhoB, tauA, tauB, alpha, beta,
+			Fx, Fy, Fz, strideY, strideZ, start, finish, Np, NULL);
+}
+
+extern "C" void ScaLBL_D3Q19_AAodd_Color_Stats(int *neighborList, int *Map, double *dist, double *Aq, double *Bq, double *Den, 
+		double *Phi, double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np, double *stats){
+	AAodd_Color<true>(neighborList, Map, dist, Aq, Bq, Den, Phi, Vel, rhoA, rhoB, tauA, tauB, alpha, beta,
+			Fx, Fy, Fz, strideY, strideZ, start, finish, Np, stats);
+}
+
+// Color model collision combined with the phase field update (see common/ColorCombined.hpp)
+extern "C" void ScaLBL_D3Q19_AAeven_Color_Combined(int *Map, double *dist, double *Aq, double *Bq, double *Den, double *Phi, double *PhiOut,
+		double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np){
+	for (int n=start; n<finish; n++){
+		ScaLBL_AAevenSlot slot = { n, Np };
+		ScaLBL_D3Q19_Color_Combined_Site(n, slot, Map, dist, Aq, Bq, Den, Phi, PhiOut, Vel, rhoA, rhoB, tauA, tauB,
+			alpha, beta, Fx, Fy, Fz, strideY, strideZ, Np);
+	}
+}
+
+extern "C" void ScaLBL_D3Q19_AAodd_Color_Combined(int *neighborList, int *Map, double *dist, double *Aq, double *Bq, double *Den, 
+		double *Phi, double *PhiOut, double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np){
+	for (int n=start; n<finish; n++){
+		ScaLBL_AAoddSlot slot = { neighborList, n, Np };
+		ScaLBL_D3Q19_Color_Combined_Site(n, slot, Map, dist, Aq, Bq, Den, Phi, PhiOut, Vel, rhoA, rhoB, tauA, tauB,
+			alpha, beta, Fx, Fy, Fz, strideY, strideZ, Np);
+	}
 }
 
 
@@ -19,6 +19,10 @@
 #include <string.h>
 #include <mm_malloc.h>
 
+// memory accounting (common/MemoryReport.cpp)
+extern "C" void ScaLBL_RecordAllocation(void* address, size_t size);
+extern "C" void ScaLBL_RecordFree(void* address);
+
 extern "C" int ScaLBL_SetDevice(int rank){
 	return 0;
 }
@@ -31,6 +35,7 @@ extern "C" void ScaLBL_AllocateZeroCopy(void** address, size_t size){
 	if (*address==NULL){
 		printf("Memory allocation failed! \n");
 	}
+	ScaLBL_RecordAllocation(*address,size);
 }
 
 extern "C" void ScaLBL_AllocateDeviceMemory(void** address, size_t size){
@@ -41,9 +46,11 @@ extern "C" void ScaLBL_AllocateDeviceMemory(void** address, size_t size){
 	if (*address==NULL){
 		printf("Memory allocation failed! \n");
 	}
+	ScaLBL_RecordAllocation(*address,size);
 }
 
 extern "C" void ScaLBL_FreeDeviceMemory(void* pointer){
+	ScaLBL_RecordFree(pointer);
 	_mm_free(pointer);
 }
 
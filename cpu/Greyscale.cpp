@@ -15,7 +15,11 @@
 */
 #include <math.h>
 
-extern "C" void ScaLBL_D3Q19_AAeven_Greyscale(double *dist, int start, int finish, int Np, double rlx, double rlx_eff, double Gx, double Gy, double Gz,
+// The kernels are instantiated for open sites (OPEN = true, porosity 1, no Brinkman /
+// Forchheimer drag) and grey sites.  The open variant is selected by passing Poros = NULL.
+
+template<bool OPEN>
+static void AAeven_Greyscale(double *dist, int start, int finish, int Np, double rlx, double rlx_eff, double Gx, double Gy, double Gz,
                                               double *Poros,double *Perm, double *Velocity, double *Pressure){
 	// conserved momemnts
 	double rho,vx,vy,vz,v_mag;
@@ -53,8 +57,8 @@ extern "C" void ScaLBL_D3Q19_AAeven_Greyscale(double *dist, int start, int finis
 		f17 = dist[18*Np+n];
 		f18 = dist[17*Np+n];
         
-        porosity = Poros[n];
-        perm = Perm[n];
+        porosity = OPEN ? 1.0 : Poros[n];
+        perm = OPEN ? 1.0 : Perm[n];
 
         c0 = 0.5*(1.0+porosity*0.5*mu_eff/perm);
         if (porosity==1.0) c0 = 0.5;//i.e. apparent pore nodes
@@ -68,9 +72,16 @@ extern "C" void ScaLBL_D3Q19_AAeven_Greyscale(double *dist, int start, int finis
 		vy = (f3-f4+f7-f8-f9+f10+f15-f16+f17-f18)/rho+0.5*porosity*Gy;
 		vz = (f5-f6+f11-f12-f13+f14+f15-f16-f17+f18)/rho+0.5*porosity*Gz;
         v_mag=sqrt(vx*vx+vy*vy+vz*vz);
-        ux = vx/(c0+sqrt(c0*c0+c1*v_mag));
-        uy = vy/(c0+sqrt(c0*c0+c1*v_mag));
-        uz = vz/(c0+sqrt(c0*c0+c1*v_mag));
+        if (OPEN){
+            ux = vx;
+            uy = vy;
+            uz = vz;
+        }
+        else {
+            ux = vx/(c0+sqrt(c0*c0+c1*v_mag));
+            uy = vy/(c0+sqrt(c0*c0+c1*v_mag));
+            uz = vz/(c0+sqrt(c0*c0+c1*v_mag));
+        }
         u_mag=sqrt(ux*ux+uy*uy+uz*uz);
 
         //Update the total force to include linear (Darcy) and nonlinear (Forchheimer) drags due to the porous medium
@@ -259,7 +270,16 @@ extern "C" void ScaLBL_D3Q19_AAeven_Greyscale(double *dist, int start, int finis
 	}
 }
 
-extern "C" void ScaLBL_D3Q19_AAodd_Greyscale(int *neighborList, double *dist, int start, int finish, int Np, double rlx,  double rlx_eff, double Gx, double Gy, double Gz, 
+extern "C" void ScaLBL_D3Q19_AAeven_Greyscale(double *dist, int start, int finish, int Np, double rlx, double rlx_eff, double Gx, double Gy, double Gz,
+                                              double *Poros,double *Perm, double *Velocity, double *Pressure){
+	if (Poros == NULL)
+		AAeven_Greyscale<true>(dist,start,finish,Np,rlx,rlx_eff,Gx,Gy,Gz,Poros,Perm,Velocity,Pressure);
+	else
+		AAeven_Greyscale<false>(dist,start,finish,Np,rlx,rlx_eff,Gx,Gy,Gz,Poros,Perm,Velocity,Pressure);
+}
+
+template<bool OPEN>
+static void AAodd_Greyscale(int *neighborList, double *dist, int start, int finish, int Np, double rlx,  double rlx_eff, double Gx, double Gy, double Gz, 
                                              double *Poros,double *Perm, double *Velocity,double *Pressure){
 	// conserved momemnts
 	double rho,vx,vy,vz,v_mag;
@@ -352,8 +372,8 @@ extern "C" void ScaLBL_D3Q19_AAodd_Greyscale(int *neighborList, double *dist, in
 		nr18 = neighborList[n+17*Np];
 		f18 = dist[nr18];
 
-        porosity = Poros[n];
-        perm = Perm[n];
+        porosity = OPEN ? 1.0 : Poros[n];
+        perm = OPEN ? 1.0 : Perm[n];
 
         c0 = 0.5*(1.0+porosity*0.5*mu_eff/perm);
         if (porosity==1.0) c0 = 0.5;//i.e. apparent pore nodes
@@ -367,9 +387,16 @@ extern "C" void ScaLBL_D3Q19_AAodd_Greyscale(int *neighborList, double *dist, in
 		vy = (f3-f4+f7-f8-f9+f10+f15-f16+f17-f18)/rho+0.5*porosity*Gy;
 		vz = (f5-f6+f11-f12-f13+f14+f15-f16-f17+f18)/rho+0.5*porosity*Gz;
         v_mag=sqrt(vx*vx+vy*vy+vz*vz);
-        ux = vx/(c0+sqrt(c0*c0+c1*v_mag));
-        uy = vy/(c0+sqrt(c0*c0+c1*v_mag));
-        uz = vz/(c0+sqrt(c0*c0+c1*v_mag));
+        if (OPEN){
+            ux = vx;
+            uy = vy;
+            uz = vz;
+        }
+        else {
+            ux = vx/(c0+sqrt(c0*c0+c1*v_mag));
+            uy = vy/(c0+sqrt(c0*c0+c1*v_mag));
+            uz = vz/(c0+sqrt(c0*c0+c1*v_mag));
+        }
         u_mag=sqrt(ux*ux+uy*uy+uz*uz);
 
         //Update the total force to include linear (Darcy) and nonlinear (Forchheimer) drags due to the porous medium
@@ -562,8 +589,17 @@ extern "C" void ScaLBL_D3Q19_AAodd_Greyscale(int *neighborList, double *dist, in
 	}
 }
 
+extern "C" void ScaLBL_D3Q19_AAodd_Greyscale(int *neighborList, double *dist, int start, int finish, int Np, double rlx,  double rlx_eff, double Gx, double Gy, double Gz, 
+                                             double *Poros,double *Perm, double *Velocity,double *Pressure){
+	if (Poros == NULL)
+		AAodd_Greyscale<true>(neighborList,dist,start,finish,Np,rlx,rlx_eff,Gx,Gy,Gz,Poros,Perm,Velocity,Pressure);
+	else
+		AAodd_Greyscale<false>(neighborList,dist,start,finish,Np,rlx,rlx_eff,Gx,Gy,Gz,Poros,Perm,Velocity,Pressure);
+}
 
-extern "C" void ScaLBL_D3Q19_AAeven_Greyscale_IMRT(double *dist, int start, int finish, int Np, double rlx,  double rlx_eff, double Gx, double Gy, double Gz,
+
+template<bool OPEN>
+static void AAeven_Greyscale_IMRT(double *dist, int start, int finish, int Np, double rlx,  double rlx_eff, double Gx, double Gy, double Gz,
                                               double *Poros,double *Perm, double *Velocity, double Den,double *Pressure){
 	double vx,vy,vz,v_mag;
     double ux,uy,uz,u_mag;
@@ -872,8 +908,8 @@ extern "C" void ScaLBL_D3Q19_AAeven_Greyscale_IMRT(double *dist, int start, int
 		m18 -= fq;
         //---------------------------------------------------------------------//
 
-        porosity = Poros[n];
-        perm = Perm[n];
+        porosity = OPEN ? 1.0 : Poros[n];
+        perm = OPEN ? 1.0 : Perm[n];
 
         c0 = 0.5*(1.0+porosity*0.5*mu_eff/perm);
         if (porosity==1.0) c0 = 0.5;//i.e. apparent pore nodes
@@ -885,9 +921,16 @@ extern "C" void ScaLBL_D3Q19_AAeven_Greyscale_IMRT(double *dist, int start, int
 		vy = jy/Den+0.5*porosity*Gy;
 		vz = jz/Den+0.5*porosity*Gz;
         v_mag=sqrt(vx*vx+vy*vy+vz*vz);
-        ux = vx/(c0+sqrt(c0*c0+c1*v_mag));
-        uy = vy/(c0+sqrt(c0*c0+c1*v_mag));
-        uz = vz/(c0+sqrt(c0*c0+c1*v_mag));
+        if (OPEN){
+            ux = vx;
+            uy = vy;
+            uz = vz;
+        }
+        else {
+            ux = vx/(c0+sqrt(c0*c0+c1*v_mag));
+            uy = vy/(c0+sqrt(c0*c0+c1*v_mag));
+            uz = vz/(c0+sqrt(c0*c0+c1*v_mag));
+        }
         u_mag=sqrt(ux*ux+uy*uy+uz*uz);
 
         //Update the total force to include linear (Darcy) and nonlinear (Forchheimer) drags due to the porous medium
@@ -1051,7 +1094,16 @@ extern "C" void ScaLBL_D3Q19_AAeven_Greyscale_IMRT(double *dist, int start, int
 	}
 }
 
-extern "C" void ScaLBL_D3Q19_AAodd_Greyscale_IMRT(int *neighborList, double *dist, int start, int finish, int Np, double rlx,  double rlx_eff, double Gx, double Gy, double Gz, 
+extern "C" void ScaLBL_D3Q19_AAeven_Greyscale_IMRT(double *dist, int start, int finish, int Np, double rlx,  double rlx_eff, double Gx, double Gy, double Gz,
+                                              double *Poros,double *Perm, double *Velocity, double Den,double *Pressure){
+	if (Poros == NULL)
+		AAeven_Greyscale_IMRT<true>(dist,start,finish,Np,rlx,rlx_eff,Gx,Gy,Gz,Poros,Perm,Velocity,Den,Pressure);
+	else
+		AAeven_Greyscale_IMRT<false>(dist,start,finish,Np,rlx,rlx_eff,Gx,Gy,Gz,Poros,Perm,Velocity,Den,Pressure);
+}
+
+template<bool OPEN>
+static void AAodd_Greyscale_IMRT(int *neighborList, double *dist, int start, int finish, int Np, double rlx,  double rlx_eff, double Gx, double Gy, double Gz, 
                                              double *Poros,double *Perm, double *Velocity, double Den,double *Pressure){
 	int nread;
 	double vx,vy,vz,v_mag;
@@ -1380,8 +1432,8 @@ extern "C" void ScaLBL_D3Q19_AAodd_Greyscale_IMRT(int *neighborList, double *dis
 		m18 -= fq;
         //---------------------------------------------------------------------//
 
-        porosity = Poros[n];
-        perm = Perm[n];
+        porosity = OPEN ? 1.0 : Poros[n];
+        perm = OPEN ? 1.0 : Perm[n];
 
         c0 = 0.5*(1.0+porosity*0.5*mu_eff/perm);
         if (porosity==1.0) c0 = 0.5;//i.e. apparent pore nodes
@@ -1393,9 +1445,16 @@ extern "C" void ScaLBL_D3Q19_AAodd_Greyscale_IMRT(int *neighborList, double *dis
 		vy = jy/Den+0.5*porosity*Gy;
 		vz = jz/Den+0.5*porosity*Gz;
         v_mag=sqrt(vx*vx+vy*vy+vz*vz);
-        ux = vx/(c0+sqrt(c0*c0+c1*v_mag));
-        uy = vy/(c0+sqrt(c0*c0+c1*v_mag));
-        uz = vz/(c0+sqrt(c0*c0+c1*v_mag));
+        if (OPEN){
+            ux = vx;
+            uy = vy;
+            uz = vz;
+        }
+        else {
+            ux = vx/(c0+sqrt(c0*c0+c1*v_mag));
+            uy = vy/(c0+sqrt(c0*c0+c1*v_mag));
+            uz = vz/(c0+sqrt(c0*c0+c1*v_mag));
+        }
         u_mag=sqrt(ux*ux+uy*uy+uz*uz);
 
         //Update the total force to include linear (Darcy) and nonlinear (Forchheimer) drags due to the porous medium
@@ -1577,8 +1636,17 @@ extern "C" void ScaLBL_D3Q19_AAodd_Greyscale_IMRT(int *neighborList, double *dis
 	}
 }
 
+extern "C" void ScaLBL_D3Q19_AAodd_Greyscale_IMRT(int *neighborList, double *dist, int start, int finish, int Np, double rlx,  double rlx_eff, double Gx, double Gy, double Gz, 
+                                             double *Poros,double *Perm, double *Velocity, double Den,double *Pressure){
+	if (Poros == NULL)
+		AAodd_Greyscale_IMRT<true>(neighborList,dist,start,finish,Np,rlx,rlx_eff,Gx,Gy,Gz,Poros,Perm,Velocity,Den,Pressure);
+	else
+		AAodd_Greyscale_IMRT<false>(neighborList,dist,start,finish,Np,rlx,rlx_eff,Gx,Gy,Gz,Poros,Perm,Velocity,Den,Pressure);
+}
+
 
-extern "C" void ScaLBL_D3Q19_AAodd_Greyscale_MRT(int *neighborList, double *dist, int start, int finish, int Np, double rlx, double rlx_eff, double Gx, double Gy, double Gz,double *Poros,double *Perm, double *Velocity,double rho0,double *Pressure){
+template<bool OPEN>
+static void AAodd_Greyscale_MRT(int *neighborList, double *dist, int start, int finish, int Np, double rlx, double rlx_eff, double Gx, double Gy, double Gz,double *Poros,double *Perm, double *Velocity,double rho0,double *Pressure){
 
 	int nread;
 	int nr1,nr2,nr3,nr4,nr5,nr6;
@@ -1943,8 +2011,8 @@ extern "C" void ScaLBL_D3Q19_AAodd_Greyscale_MRT(int *neighborList, double *dist
 		m18 -= fq;
         //---------------------------------------------------------------------//
 
-        porosity = Poros[n];
-        perm = Perm[n];
+        porosity = OPEN ? 1.0 : Poros[n];
+        perm = OPEN ? 1.0 : Perm[n];
 
         c0 = 0.5*(1.0+porosity*0.5*mu_eff/perm);
         if (porosity==1.0) c0 = 0.5;//i.e. apparent pore nodes
@@ -1956,9 +2024,16 @@ extern "C" void ScaLBL_D3Q19_AAodd_Greyscale_MRT(int *neighborList, double *dist
         vy = jy/rho0+0.5*porosity*Gy;
         vz = jz/rho0+0.5*porosity*Gz;
         v_mag=sqrt(vx*vx+vy*vy+vz*vz);
-        ux = vx/(c0+sqrt(c0*c0+c1*v_mag));
-        uy = vy/(c0+sqrt(c0*c0+c1*v_mag));
-        uz = vz/(c0+sqrt(c0*c0+c1*v_mag));
+        if (OPEN){
+            ux = vx;
+            uy = vy;
+            uz = vz;
+        }
+        else {
+            ux = vx/(c0+sqrt(c0*c0+c1*v_mag));
+            uy = vy/(c0+sqrt(c0*c0+c1*v_mag));
+            uz = vz/(c0+sqrt(c0*c0+c1*v_mag));
+        }
         u_mag=sqrt(ux*ux+uy*uy+uz*uz);
 
         //Update the total force to include linear (Darcy) and nonlinear (Forchheimer) drags due to the porous medium
@@ -2132,7 +2207,15 @@ extern "C" void ScaLBL_D3Q19_AAodd_Greyscale_MRT(int *neighborList, double *dist
 	}
 }
 
-extern "C" void ScaLBL_D3Q19_AAeven_Greyscale_MRT(double *dist, int start, int finish, int Np, double rlx, double rlx_eff, double Gx, double Gy, double Gz,double *Poros,double *Perm, double *Velocity,double rho0,double *Pressure){
+extern "C" void ScaLBL_D3Q19_AAodd_Greyscale_MRT(int *neighborList, double *dist, int start, int finish, int Np, double rlx, double rlx_eff, double Gx, double Gy, double Gz,double *Poros,double *Perm, double *Velocity,double rho0,double *Pressure){
+	if (Poros == NULL)
+		AAodd_Greyscale_MRT<true>(neighborList,dist,start,finish,Np,rlx,rlx_eff,Gx,Gy,Gz,Poros,Perm,Velocity,rho0,Pressure);
+	else
+		AAodd_Greyscale_MRT<false>(neighborList,dist,start,finish,Np,rlx,rlx_eff,Gx,Gy,Gz,Poros,Perm,Velocity,rho0,Pressure);
+}
+
+template<bool OPEN>
+static void AAeven_Greyscale_MRT(double *dist, int start, int finish, int Np, double rlx, double rlx_eff, double Gx, double Gy, double Gz,double *Poros,double *Perm, double *Velocity,double rho0,double *Pressure){
 
 	double vx,vy,vz,v_mag;
     double ux,uy,uz,u_mag;
@@ -2442,8 +2525,8 @@ extern "C" void ScaLBL_D3Q19_AAeven_Greyscale_MRT(double *dist, int start, int f
 		m18 -= fq;
         //---------------------------------------------------------------------//
 
-        porosity = Poros[n];
-        perm = Perm[n];
+        porosity = OPEN ? 1.0 : Poros[n];
+        perm = OPEN ? 1.0 : Perm[n];
 
         c0 = 0.5*(1.0+porosity*0.5*mu_eff/perm);
         if (porosity==1.0) c0 = 0.5;//i.e. apparent pore nodes
@@ -2455,9 +2538,16 @@ extern "C" void ScaLBL_D3Q19_AAeven_Greyscale_MRT(double *dist, int start, int f
         vy = jy/rho0+0.5*porosity*Gy;
         vz = jz/rho0+0.5*porosity*Gz;
         v_mag=sqrt(vx*vx+vy*vy+vz*vz);
-        ux = vx/(c0+sqrt(c0*c0+c1*v_mag));
-        uy = vy/(c0+sqrt(c0*c0+c1*v_mag));
-        uz = vz/(c0+sqrt(c0*c0+c1*v_mag));
+        if (OPEN){
+            ux = vx;
+            uy = vy;
+            uz = vz;
+        }
+        else {
+            ux = vx/(c0+sqrt(c0*c0+c1*v_mag));
+            uy = vy/(c0+sqrt(c0*c0+c1*v_mag));
+            uz = vz/(c0+sqrt(c0*c0+c1*v_mag));
+        }
         u_mag=sqrt(ux*ux+uy*uy+uz*uz);
 
         //Update the total force to include linear (Darcy) and nonlinear (Forchheimer) drags due to the porous medium
@@ -2613,6 +2703,13 @@ extern "C" void ScaLBL_D3Q19_AAeven_Greyscale_MRT(double *dist, int start, int f
 	}
 }
 
+extern "C" void ScaLBL_D3Q19_AAeven_Greyscale_MRT(double *dist, int start, int finish, int Np, double rlx, double rlx_eff, double Gx, double Gy, double Gz,double *Poros,double *Perm, double *Velocity,double rho0,double *Pressure){
+	if (Poros == NULL)
+		AAeven_Greyscale_MRT<true>(dist,start,finish,Np,rlx,rlx_eff,Gx,Gy,Gz,Poros,Perm,Velocity,rho0,Pressure);
+	else
+		AAeven_Greyscale_MRT<false>(dist,start,finish,Np,rlx,rlx_eff,Gx,Gy,Gz,Poros,Perm,Velocity,rho0,Pressure);
+}
+
 
 extern "C" void ScaLBL_D3Q19_GreyIMRT_Init(double *dist, int Np, double Den)
 {
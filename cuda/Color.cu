@@ -1,10 +1,37 @@
 #include <math.h>
 #include <stdio.h>
 #include <cuda_profiler_api.h>
+#include "common/ColorCombined.hpp"
 
 #define NBLOCKS 1024
 #define NTHREADS 256
 
+#if !defined(__CUDA_ARCH__) || __CUDA_ARCH__ >= 600
+#else
+__device__ double atomicAdd(double* address, double val) { 
+   unsigned long long int* address_as_ull = (unsigned long long int*)address;
+   unsigned long long int old = *address_as_ull, assumed;
+
+   do {
+      assumed = old;
+      old = atomicCAS(address_as_ull, assumed, __double_as_longlong(val+__longlong_as_double(assumed)));
+   } while (assumed != old);
+   return __longlong_as_double(old);
+}
+#endif
+
+// Add the sum of val over the thread block to *sum (temp holds blockDim.x doubles)
+static __device__ void dvc_AccumulateBlockSum(double *temp, double val, double *sum){
+	int lane = threadIdx.x;
+	for (int i = blockDim.x/2; i > 0; i /= 2){
+		temp[lane] = val;
+		__syncthreads();
+		if (lane < i) val += temp[lane+i];
+		__syncthreads();
+	}
+	if (lane == 0) atomicAdd(sum, val);
+}
+
 __global__  void dvc_ScaLBL_Color_Init(char *ID, double *Den, double *Phi, double das, double dbs, int Nx, int Ny, int Nz)
 {
 	//int i,j,k;
@@ -1250,9 +1277,12 @@ __global__  void dvc_ScaLBL_CopySlice_z(double *Phi, int Nx, int Ny, int Nz, int
 }
 
 
+template<bool STATS>
 __global__  void dvc_ScaLBL_D3Q19_AAeven_Color(int *Map, double *dist, double *Aq, double *Bq, double *Den, double *Phi,
 		double *Velocity, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
-		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np){
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np, double *stats){
+	double sums[14];	// flow statistics (see ScaLBL.h)
+	for (int m=0; m<14; m++) sums[m] = 0.0;
 	int ijk,nn,n;
 	double fq;
 	// conserved momemnts
@@ -1828,14 +1858,37 @@ __global__  void dvc_ScaLBL_D3Q19_AAeven_Color(int *Map, double *dist, double *A
 			Bq[6*Np+n] = b2;
 			//...............................................
 
+			if (STATS){
+				// phase A where phi > 0, as in SubPhase::Basic
+				sums[0] += 1.0;
+				sums[1] += rho;
+				sums[2] += jx;
+				sums[3] += jy;
+				sums[4] += jz;
+				sums[5] += 0.5*rho0*(ux*ux+uy*uy+uz*uz);
+				int p = (phi > 0.0) ? 6 : 10;
+				double rhoP = (phi > 0.0) ? rhoA : rhoB;
+				sums[p] += 1.0;
+				sums[p+1] += rhoP*ux;
+				sums[p+2] += rhoP*uy;
+				sums[p+3] += rhoP*uz;
+			}
 		}
 	}
+	if (STATS){
+		// per-thread partial sums, one atomic add per block
+		extern __shared__ double temp[];
+		for (int m=0; m<14; m++) dvc_AccumulateBlockSum(temp, sums[m], &stats[m]);
+	}
 }
 
 
+template<bool STATS>
 __global__ void dvc_ScaLBL_D3Q19_AAodd_Color(int *neighborList, int *Map, double *dist, double *Aq, double *Bq, double *Den,
 		 double *Phi, double *Velocity, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
-		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np){
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np, double *stats){
+	double sums[14];	// flow statistics (see ScaLBL.h)
+	for (int m=0; m<14; m++) sums[m] = 0.0;
 
 	int n,nn,ijk,nread;
 	int nr1,nr2,nr3,nr4,nr5,nr6;
@@ -2488,6 +2541,59 @@ __global__ void dvc_ScaLBL_D3Q19_AAodd_Color(int *neighborList, int *Map, double
 			Aq[nr5] = a2;
 			Bq[nr5] = b2;
 			//...............................................
+			if (STATS){
+				// phase A where phi > 0, as in SubPhase::Basic
+				sums[0] += 1.0;
+				sums[1] += rho;
+				sums[2] += jx;
+				sums[3] += jy;
+				sums[4] += jz;
+				sums[5] += 0.5*rho0*(ux*ux+uy*uy+uz*uz);
+				int p = (phi > 0.0) ? 6 : 10;
+				double rhoP = (phi > 0.0) ? rhoA : rhoB;
+				sums[p] += 1.0;
+				sums[p+1] += rhoP*ux;
+				sums[p+2] += rhoP*uy;
+				sums[p+3] += rhoP*uz;
+			}
+		}
+	}
+	if (STATS){
+		// per-thread partial sums, one atomic add per block
+		extern __shared__ double temp[];
+		for (int m=0; m<14; m++) dvc_AccumulateBlockSum(temp, sums[m], &stats[m]);
+	}
+}
+
+// Color model collision combined with the phase field update (see common/ColorCombined.hpp)
+__global__  void dvc_ScaLBL_D3Q19_AAeven_Color_Combined(int *Map, double *dist, double *Aq, double *Bq, double *Den, double *Phi, double *PhiOut,
+		double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np){
+	int n;
+	int S = Np/NBLOCKS/NTHREADS + 1;
+	for (int s=0; s<S; s++){
+		//........Get 1-D index for this thread....................
+		n =  S*blockIdx.x*blockDim.x + s*blockDim.x + threadIdx.x + start;
+		if (n<finish) {
+			ScaLBL_AAevenSlot slot = { n, Np };
+			ScaLBL_D3Q19_Color_Combined_Site(n, slot, Map, dist, Aq, Bq, Den, Phi, PhiOut, Vel, rhoA, rhoB, tauA, tauB,
+				alpha, beta, Fx, Fy, Fz, strideY, strideZ, Np);
+		}
+	}
+}
+
+__global__ void dvc_ScaLBL_D3Q19_AAodd_Color_Combined(int *neighborList, int *Map, double *dist, double *Aq, double *Bq, double *Den,
+		 double *Phi, double *PhiOut, double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np){
+	int n;
+	int S = Np/NBLOCKS/NTHREADS + 1;
+	for (int s=0; s<S; s++){
+		//........Get 1-D index for this thread....................
+		n =  S*blockIdx.x*blockDim.x + s*blockDim.x + threadIdx.x + start;
+		if (n<finish) {
+			ScaLBL_AAoddSlot slot = { neighborList, n, Np };
+			ScaLBL_D3Q19_Color_Combined_Site(n, slot, Map, dist, Aq, Bq, Den, Phi, PhiOut, Vel, rhoA, rhoB, tauA, tauB,
+				alpha, beta, Fx, Fy, Fz, strideY, strideZ, Np);
 		}
 	}
 }
@@ -3996,10 +4102,10 @@ extern "C" void ScaLBL_D3Q19_AAeven_Color(int *Map, double *dist, double *Aq, do
 		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np){
 
 	cudaProfilerStart();
-	cudaFuncSetCacheConfig(dvc_ScaLBL_D3Q19_AAeven_Color, cudaFuncCachePreferL1);
+	cudaFuncSetCacheConfig(dvc_ScaLBL_D3Q19_AAeven_Color<false>, cudaFuncCachePreferL1);
 
-	dvc_ScaLBL_D3Q19_AAeven_Color<<<NBLOCKS,NTHREADS >>>(Map, dist, Aq, Bq, Den, Phi, Vel, rhoA, rhoB, tauA, tauB, 
-			alpha, beta, Fx, Fy, Fz, strideY, strideZ, start, finish, Np);
+	dvc_ScaLBL_D3Q19_AAeven_Color<false><<<NBLOCKS,NTHREADS>>>(Map, dist, Aq, Bq, Den, Phi, Vel, rhoA, rhoB, tauA, tauB, 
+			alpha, beta, Fx, Fy, Fz, strideY, strideZ, start, finish, Np,NULL);
 	cudaError_t err = cudaGetLastError();
 	if (cudaSuccess != err){
 		printf("CUDA error in ScaLBL_D3Q19_AAeven_Color: %s \n",cudaGetErrorString(err));
@@ -4008,15 +4114,32 @@ extern "C" void ScaLBL_D3Q19_AAeven_Color(int *Map, double *dist, double *Aq, do
 
 }
 
+extern "C" void ScaLBL_D3Q19_AAeven_Color_Stats(int *Map, double *dist, double *Aq, double *Bq, double *Den, double *Phi,
+		double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np, double *stats){
+
+	cudaProfilerStart();
+	cudaFuncSetCacheConfig(dvc_ScaLBL_D3Q19_AAeven_Color<true>, cudaFuncCachePreferL1);
+
+	dvc_ScaLBL_D3Q19_AAeven_Color<true><<<NBLOCKS,NTHREADS,NTHREADS*sizeof(double)>>>(Map, dist, Aq, Bq, Den, Phi, Vel, rhoA, rhoB, tauA, tauB, 
+			alpha, beta, Fx, Fy, Fz, strideY, strideZ, start, finish, Np,stats);
+	cudaError_t err = cudaGetLastError();
+	if (cudaSuccess != err){
+		printf("CUDA error in ScaLBL_D3Q19_AAeven_Color_Stats: %s \n",cudaGetErrorString(err));
+	}
+	cudaProfilerStop();
+
+}
+
 extern "C" void ScaLBL_D3Q19_AAodd_Color(int *d_neighborList, int *Map, double *dist, double *Aq, double *Bq, double *Den, 
 		double *Phi, double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
 		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np){
 
 	cudaProfilerStart();
-	cudaFuncSetCacheConfig(dvc_ScaLBL_D3Q19_AAodd_Color, cudaFuncCachePreferL1);
+	cudaFuncSetCacheConfig(dvc_ScaLBL_D3Q19_AAodd_Color<false>, cudaFuncCachePreferL1);
 	
-	dvc_ScaLBL_D3Q19_AAodd_Color<<<NBLOCKS,NTHREADS >>>(d_neighborList, Map, dist, Aq, Bq, Den, Phi, Vel, 
-			rhoA, rhoB, tauA, tauB, alpha, beta, Fx, Fy, Fz, strideY, strideZ, start, finish, Np);
+	dvc_ScaLBL_D3Q19_AAodd_Color<false><<<NBLOCKS,NTHREADS>>>(d_neighborList, Map, dist, Aq, Bq, Den, Phi, Vel, 
+			rhoA, rhoB, tauA, tauB, alpha, beta, Fx, Fy, Fz, strideY, strideZ, start, finish, Np,NULL);
 
 	cudaError_t err = cudaGetLastError();
 	if (cudaSuccess != err){
@@ -4025,6 +4148,48 @@ extern "C" void ScaLBL_D3Q19_AAodd_Color(int *d_neighborList, int *Map, double *
 	cudaProfilerStop();
 }
 
+extern "C" void ScaLBL_D3Q19_AAodd_Color_Stats(int *d_neighborList, int *Map, double *dist, double *Aq, double *Bq, double *Den, 
+		double *Phi, double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np, double *stats){
+
+	cudaProfilerStart();
+	cudaFuncSetCacheConfig(dvc_ScaLBL_D3Q19_AAodd_Color<true>, cudaFuncCachePreferL1);
+	
+	dvc_ScaLBL_D3Q19_AAodd_Color<true><<<NBLOCKS,NTHREADS,NTHREADS*sizeof(double)>>>(d_neighborList, Map, dist, Aq, Bq, Den, Phi, Vel, 
+			rhoA, rhoB, tauA, tauB, alpha, beta, Fx, Fy, Fz, strideY, strideZ, start, finish, Np,stats);
+
+	cudaError_t err = cudaGetLastError();
+	if (cudaSuccess != err){
+		printf("CUDA error in ScaLBL_D3Q19_AAodd_Color_Stats: %s \n",cudaGetErrorString(err));
+	}
+	cudaProfilerStop();
+}
+
+extern "C" void ScaLBL_D3Q19_AAeven_Color_Combined(int *Map, double *dist, double *Aq, double *Bq, double *Den, double *Phi, double *PhiOut,
+		double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np){
+
+	dvc_ScaLBL_D3Q19_AAeven_Color_Combined<<<NBLOCKS,NTHREADS >>>(Map, dist, Aq, Bq, Den, Phi, PhiOut, Vel, rhoA, rhoB, tauA, tauB,
+			alpha, beta, Fx, Fy, Fz, strideY, strideZ, start, finish, Np);
+	cudaError_t err = cudaGetLastError();
+	if (cudaSuccess != err){
+		printf("CUDA error in ScaLBL_D3Q19_AAeven_Color_Combined: %s \n",cudaGetErrorString(err));
+	}
+}
+
+extern "C" void ScaLBL_D3Q19_AAodd_Color_Combined(int *d_neighborList, int *Map, double *dist, double *Aq, double *Bq, double *Den,
+		double *Phi, double *PhiOut, double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np){
+
+	dvc_ScaLBL_D3Q19_AAodd_Color_Combined<<<NBLOCKS,NTHREADS >>>(d_neighborList, Map, dist, Aq, Bq, Den, Phi, PhiOut, Vel,
+			rhoA, rhoB, tauA, tauB, alpha, beta, Fx, Fy, Fz, strideY, strideZ, start, finish, Np);
+	cudaError_t err = cudaGetLastError();
+	if (cudaSuccess != err){
+		printf("CUDA error in ScaLBL_D3Q19_AAodd_Color_Combined: %s \n",cudaGetErrorString(err));
+	}
+}
+
+
 extern "C" void ScaLBL_D3Q7_AAodd_PhaseField(int *NeighborList, int *Map, double *Aq, double *Bq, 
 		double *Den, double *Phi, int start, int finish, int Np){
 
@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <cooperative_groups.h>
+#include "common/ScaLBL.h"
 
 #define NBLOCKS 1024
 #define NTHREADS 256
@@ -45,6 +46,18 @@ __device__ double atomicAdd(double* address, double val) {
 #endif
 
 using namespace cooperative_groups;
+// Add the sum of val over the thread block to *sum (temp holds blockDim.x doubles)
+static __device__ void dvc_AccumulateBlockSum(double *temp, double val, double *sum){
+	int lane = threadIdx.x;
+	for (int i = blockDim.x/2; i > 0; i /= 2){
+		temp[lane] = val;
+		__syncthreads();
+		if (lane < i) val += temp[lane+i];
+		__syncthreads();
+	}
+	if (lane == 0) atomicAdd(sum, val);
+}
+
 __device__ double reduce_sum(thread_group g, double *temp, double val)
 {
     int lane = g.thread_rank();
@@ -429,8 +442,10 @@ dvc_ScaLBL_AAodd_Compact(char * ID, int *d_neighborList, double *dist, int Np) {
 }
 
 
+template<bool STATS>
 __global__ void 
-dvc_ScaLBL_AAodd_MRT(int *neighborList, double *dist, int start, int finish, int Np, double rlx_setA, double rlx_setB, double Fx, double Fy, double Fz) {
+dvc_ScaLBL_AAodd_MRT(int *neighborList, double *dist, int start, int finish, int Np, double rlx_setA, double rlx_setB, double Fx, double Fy, double Fz, double *stats) {
+	double sums[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};	// flow statistics (see ScaLBL.h)
 
 	int n;
 	double fq;
@@ -892,14 +907,517 @@ dvc_ScaLBL_AAodd_MRT(int *neighborList, double *dist, int start, int finish, int
 			nread = neighborList[n+16*Np];
 			dist[nread] = fq;
 
+			if (STATS){
+				// post-collision momentum (the force is added by the collision)
+				double px = jx + Fx, py = jy + Fy, pz = jz + Fz;
+				sums[0] += 1.0;
+				sums[1] += rho;
+				sums[2] += px;
+				sums[3] += py;
+				sums[4] += pz;
+				sums[5] += 0.5*(px*px+py*py+pz*pz)/rho;
+			}
+		}
+	}
+	if (STATS){
+		// per-thread partial sums, one atomic add per block
+		extern __shared__ double temp[];
+		for (int m=0; m<6; m++) dvc_AccumulateBlockSum(temp, sums[m], &stats[m]);
+	}
+}
+
+// Decode an entry of the 16-bit neighbor list built by ScaLBL_Communicator::CompactNeighborList
+__device__ inline int CompactNeighbor(const short *neighborDelta, const int *escapeList, int escapeCount, int n, int q, int Np){
+	int delta = neighborDelta[q*Np+n];
+	if (delta == D3Q19_COMPACT_BOUNCEBACK) return ((q^1)+1)*Np + n;
+	if (delta == D3Q19_COMPACT_ESCAPE){
+		// binary search the sorted keys of the escape table
+		const int *keys = &escapeList[18];
+		int key = q*Np + n;
+		int lo = 0, hi = escapeCount-1;
+		while (lo < hi){
+			int mid = (lo+hi)/2;
+			if (keys[mid] < key) lo = mid+1;
+			else hi = mid;
+		}
+		return keys[escapeCount+lo];
+	}
+	return (q+1)*Np + n + escapeList[q] + delta;
+}
+
+__global__ void 
+dvc_ScaLBL_AAodd_MRT_Compact(short *neighborDelta, int *escapeList, int escapeCount, double *dist, int start, int finish, int Np, double rlx_setA, double rlx_setB, double Fx, double Fy, double Fz) {
+
+	int n;
+	double fq;
+	// conserved momemnts
+	double rho,jx,jy,jz;
+	// non-conserved moments
+	double m1,m2,m4,m6,m8,m9,m10,m11,m12,m13,m14,m15,m16,m17,m18;
+
+	int nread;
+	int S = Np/NBLOCKS/NTHREADS+1;
+
+	for (int s=0; s<S; s++){
+		//........Get 1-D index for this thread....................
+		n =  S*blockIdx.x*blockDim.x + s*blockDim.x + threadIdx.x + start;
+		if (n<finish) {
+			// q=0
+			fq = dist[n];
+			rho = fq;
+			m1  = -30.0*fq;
+			m2  = 12.0*fq;
+
+			// q=1
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 0, Np); // neighbor 2 ( > 10Np => odd part of dist)
+			fq = dist[nread]; // reading the f1 data into register fq
+			//fp = dist[10*Np+n];
+			rho += fq;
+			m1 -= 11.0*fq;
+			m2 -= 4.0*fq;
+			jx = fq;
+			m4 = -4.0*fq;
+			m9 = 2.0*fq;
+			m10 = -4.0*fq;
+
+			// f2 = dist[10*Np+n];
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 1, Np); // neighbor 1 ( < 10Np => even part of dist)
+			fq = dist[nread];  // reading the f2 data into register fq
+			//fq = dist[Np+n];
+			rho += fq;
+			m1 -= 11.0*(fq);
+			m2 -= 4.0*(fq);
+			jx -= fq;
+			m4 += 4.0*(fq);
+			m9 += 2.0*(fq);
+			m10 -= 4.0*(fq);
+
+			// q=3
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 2, Np); // neighbor 4
+			fq = dist[nread];
+			//fq = dist[11*Np+n];
+			rho += fq;
+			m1 -= 11.0*fq;
+			m2 -= 4.0*fq;
+			jy = fq;
+			m6 = -4.0*fq;
+			m9 -= fq;
+			m10 += 2.0*fq;
+			m11 = fq;
+			m12 = -2.0*fq;
+
+			// q = 4
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 3, Np); // neighbor 3
+			fq = dist[nread];
+			//fq = dist[2*Np+n];
+			rho+= fq;
+			m1 -= 11.0*fq;
+			m2 -= 4.0*fq;
+			jy -= fq;
+			m6 += 4.0*fq;
+			m9 -= fq;
+			m10 += 2.0*fq;
+			m11 += fq;
+			m12 -= 2.0*fq;
+
+			// q=5
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 4, Np);
+			fq = dist[nread];
+			//fq = dist[12*Np+n];
+			rho += fq;
+			m1 -= 11.0*fq;
+			m2 -= 4.0*fq;
+			jz = fq;
+			m8 = -4.0*fq;
+			m9 -= fq;
+			m10 += 2.0*fq;
+			m11 -= fq;
+			m12 += 2.0*fq;
+
+
+			// q = 6
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 5, Np);
+			fq = dist[nread];
+			//fq = dist[3*Np+n];
+			rho+= fq;
+			m1 -= 11.0*fq;
+			m2 -= 4.0*fq;
+			jz -= fq;
+			m8 += 4.0*fq;
+			m9 -= fq;
+			m10 += 2.0*fq;
+			m11 -= fq;
+			m12 += 2.0*fq;
+
+			// q=7
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 6, Np);
+			fq = dist[nread];
+			//fq = dist[13*Np+n];
+			rho += fq;
+			m1 += 8.0*fq;
+			m2 += fq;
+			jx += fq;
+			m4 += fq;
+			jy += fq;
+			m6 += fq;
+			m9  += fq;
+			m10 += fq;
+			m11 += fq;
+			m12 += fq;
+			m13 = fq;
+			m16 = fq;
+			m17 = -fq;
+
+			// q = 8
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 7, Np);
+			fq = dist[nread];
+			//fq = dist[4*Np+n];
+			rho += fq;
+			m1 += 8.0*fq;
+			m2 += fq;
+			jx -= fq;
+			m4 -= fq;
+			jy -= fq;
+			m6 -= fq;
+			m9 += fq;
+			m10 += fq;
+			m11 += fq;
+			m12 += fq;
+			m13 += fq;
+			m16 -= fq;
+			m17 += fq;
+
+			// q=9
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 8, Np);
+			fq = dist[nread];
+			//fq = dist[14*Np+n];
+			rho += fq;
+			m1 += 8.0*fq;
+			m2 += fq;
+			jx += fq;
+			m4 += fq;
+			jy -= fq;
+			m6 -= fq;
+			m9 += fq;
+			m10 += fq;
+			m11 += fq;
+			m12 += fq;
+			m13 -= fq;
+			m16 += fq;
+			m17 += fq;
+
+			// q = 10
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 9, Np);
+			fq = dist[nread];
+			//fq = dist[5*Np+n];
+			rho += fq;
+			m1 += 8.0*fq;
+			m2 += fq;
+			jx -= fq;
+			m4 -= fq;
+			jy += fq;
+			m6 += fq;
+			m9 += fq;
+			m10 += fq;
+			m11 += fq;
+			m12 += fq;
+			m13 -= fq;
+			m16 -= fq;
+			m17 -= fq;
+
+			// q=11
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 10, Np);
+			fq = dist[nread];
+			//fq = dist[15*Np+n];
+			rho += fq;
+			m1 += 8.0*fq;
+			m2 += fq;
+			jx += fq;
+			m4 += fq;
+			jz += fq;
+			m8 += fq;
+			m9 += fq;
+			m10 += fq;
+			m11 -= fq;
+			m12 -= fq;
+			m15 = fq;
+			m16 -= fq;
+			m18 = fq;
+
+			// q=12
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 11, Np);
+			fq = dist[nread];
+			//fq = dist[6*Np+n];
+			rho += fq;
+			m1 += 8.0*fq;
+			m2 += fq;
+			jx -= fq;
+			m4 -= fq;
+			jz -= fq;
+			m8 -= fq;
+			m9 += fq;
+			m10 += fq;
+			m11 -= fq;
+			m12 -= fq;
+			m15 += fq;
+			m16 += fq;
+			m18 -= fq;
+
+			// q=13
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 12, Np);
+			fq = dist[nread];
+			//fq = dist[16*Np+n];
+			rho += fq;
+			m1 += 8.0*fq;
+			m2 += fq;
+			jx += fq;
+			m4 += fq;
+			jz -= fq;
+			m8 -= fq;
+			m9 += fq;
+			m10 += fq;
+			m11 -= fq;
+			m12 -= fq;
+			m15 -= fq;
+			m16 -= fq;
+			m18 -= fq;
+
+			// q=14
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 13, Np);
+			fq = dist[nread];
+			//fq = dist[7*Np+n];
+			rho += fq;
+			m1 += 8.0*fq;
+			m2 += fq;
+			jx -= fq;
+			m4 -= fq;
+			jz += fq;
+			m8 += fq;
+			m9 += fq;
+			m10 += fq;
+			m11 -= fq;
+			m12 -= fq;
+			m15 -= fq;
+			m16 += fq;
+			m18 += fq;
+
+			// q=15
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 14, Np);
+			fq = dist[nread];
+			//fq = dist[17*Np+n];
+			rho += fq;
+			m1 += 8.0*fq;
+			m2 += fq;
+			jy += fq;
+			m6 += fq;
+			jz += fq;
+			m8 += fq;
+			m9 -= 2.0*fq;
+			m10 -= 2.0*fq;
+			m14 = fq;
+			m17 += fq;
+			m18 -= fq;
+
+			// q=16
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 15, Np);
+			fq = dist[nread];
+			//fq = dist[8*Np+n];
+			rho += fq;
+			m1 += 8.0*fq;
+			m2 += fq;
+			jy -= fq;
+			m6 -= fq;
+			jz -= fq;
+			m8 -= fq;
+			m9 -= 2.0*fq;
+			m10 -= 2.0*fq;
+			m14 += fq;
+			m17 -= fq;
+			m18 += fq;
+
+			// q=17
+			//fq = dist[18*Np+n];
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 16, Np);
+			fq = dist[nread];
+			rho += fq;
+			m1 += 8.0*fq;
+			m2 += fq;
+			jy += fq;
+			m6 += fq;
+			jz -= fq;
+			m8 -= fq;
+			m9 -= 2.0*fq;
+			m10 -= 2.0*fq;
+			m14 -= fq;
+			m17 += fq;
+			m18 += fq;
+
+			// q=18
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 17, Np);
+			fq = dist[nread];
+			//fq = dist[9*Np+n];
+			rho += fq;
+			m1 += 8.0*fq;
+			m2 += fq;
+			jy -= fq;
+			m6 -= fq;
+			jz += fq;
+			m8 += fq;
+			m9 -= 2.0*fq;
+			m10 -= 2.0*fq;
+			m14 -= fq;
+			m17 -= fq;
+			m18 -= fq;
+
+			//..............incorporate external force................................................
+			//..............carry out relaxation process...............................................
+			m1 = m1 + rlx_setA*((19*(jx*jx+jy*jy+jz*jz)/rho - 11*rho) - m1);
+			m2 = m2 + rlx_setA*((3*rho - 5.5*(jx*jx+jy*jy+jz*jz)/rho) - m2);
+			m4 = m4 + rlx_setB*((-0.6666666666666666*jx) - m4);
+			m6 = m6 + rlx_setB*((-0.6666666666666666*jy) - m6);
+			m8 = m8 + rlx_setB*((-0.6666666666666666*jz) - m8);
+			m9 = m9 + rlx_setA*(((2*jx*jx-jy*jy-jz*jz)/rho) - m9);
+			m10 = m10 + rlx_setA*(-0.5*((2*jx*jx-jy*jy-jz*jz)/rho) - m10);
+			m11 = m11 + rlx_setA*(((jy*jy-jz*jz)/rho) - m11);
+			m12 = m12 + rlx_setA*(-0.5*((jy*jy-jz*jz)/rho) - m12);
+			m13 = m13 + rlx_setA*((jx*jy/rho) - m13);
+			m14 = m14 + rlx_setA*((jy*jz/rho) - m14);
+			m15 = m15 + rlx_setA*((jx*jz/rho) - m15);
+			m16 = m16 + rlx_setB*( - m16);
+			m17 = m17 + rlx_setB*( - m17);
+			m18 = m18 + rlx_setB*( - m18);
+			//.......................................................................................................
+			//.................inverse transformation......................................................
+
+			// q=0
+			fq = mrt_V1*rho-mrt_V2*m1+mrt_V3*m2;
+			dist[n] = fq;
+
+			// q = 1
+			fq = mrt_V1*rho-mrt_V4*m1-mrt_V5*m2+0.1*(jx-m4)+mrt_V6*(m9-m10)+0.16666666*Fx;
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 1, Np);
+			dist[nread] = fq;
+
+			// q=2
+			fq = mrt_V1*rho-mrt_V4*m1-mrt_V5*m2+0.1*(m4-jx)+mrt_V6*(m9-m10) -  0.16666666*Fx;
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 0, Np);
+			dist[nread] = fq;
+
+			// q = 3
+			fq = mrt_V1*rho-mrt_V4*m1-mrt_V5*m2+0.1*(jy-m6)+mrt_V7*(m10-m9)+mrt_V8*(m11-m12) + 0.16666666*Fy;
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 3, Np);
+			dist[nread] = fq;
+
+			// q = 4
+			fq = mrt_V1*rho-mrt_V4*m1-mrt_V5*m2+0.1*(m6-jy)+mrt_V7*(m10-m9)+mrt_V8*(m11-m12) - 0.16666666*Fy;
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 2, Np);
+			dist[nread] = fq;
+
+			// q = 5
+			fq = mrt_V1*rho-mrt_V4*m1-mrt_V5*m2+0.1*(jz-m8)+mrt_V7*(m10-m9)+mrt_V8*(m12-m11) + 0.16666666*Fz;
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 5, Np);
+			dist[nread] = fq;
+
+			// q = 6
+			fq = mrt_V1*rho-mrt_V4*m1-mrt_V5*m2+0.1*(m8-jz)+mrt_V7*(m10-m9)+mrt_V8*(m12-m11) - 0.16666666*Fz;
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 4, Np);
+			dist[nread] = fq;
+
+			// q = 7
+			fq = mrt_V1*rho+mrt_V9*m1+mrt_V10*m2+0.1*(jx+jy)+0.025*(m4+m6)+mrt_V7*m9+mrt_V11*m10+
+					mrt_V8*m11+mrt_V12*m12+0.25*m13+0.125*(m16-m17) + 0.08333333333*(Fx+Fy);
+			
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 7, Np);
+			dist[nread] = fq;
+
+			// q = 8
+			fq = mrt_V1*rho+mrt_V9*m1+mrt_V10*m2-0.1*(jx+jy)-0.025*(m4+m6) +mrt_V7*m9+mrt_V11*m10+mrt_V8*m11
+					+mrt_V12*m12+0.25*m13+0.125*(m17-m16) - 0.08333333333*(Fx+Fy);
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 6, Np);
+			dist[nread] = fq;
+
+			// q = 9
+			fq = mrt_V1*rho+mrt_V9*m1+mrt_V10*m2+0.1*(jx-jy)+0.025*(m4-m6)+mrt_V7*m9+mrt_V11*m10+
+					mrt_V8*m11+mrt_V12*m12-0.25*m13+0.125*(m16+m17) + 0.08333333333*(Fx-Fy);
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 9, Np);
+			dist[nread] = fq;
+
+			// q = 10
+			fq = mrt_V1*rho+mrt_V9*m1+mrt_V10*m2+0.1*(jy-jx)+0.025*(m6-m4)+mrt_V7*m9+mrt_V11*m10+
+					mrt_V8*m11+mrt_V12*m12-0.25*m13-0.125*(m16+m17)- 0.08333333333*(Fx-Fy);
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 8, Np);
+			dist[nread] = fq;
+
+			// q = 11
+			fq = mrt_V1*rho+mrt_V9*m1
+					+mrt_V10*m2+0.1*(jx+jz)+0.025*(m4+m8)
+					+mrt_V7*m9+mrt_V11*m10-mrt_V8*m11
+					-mrt_V12*m12+0.25*m15+0.125*(m18-m16) + 0.08333333333*(Fx+Fz);
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 11, Np);
+			dist[nread] = fq;
+
+			// q = 12
+			fq = mrt_V1*rho+mrt_V9*m1+mrt_V10*m2-0.1*(jx+jz)-0.025*(m4+m8)+
+					mrt_V7*m9+mrt_V11*m10-mrt_V8*m11-mrt_V12*m12+0.25*m15+0.125*(m16-m18) - 0.08333333333*(Fx+Fz);
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 10, Np);
+			dist[nread]= fq;
+
+			// q = 13
+			fq = mrt_V1*rho+mrt_V9*m1
+					+mrt_V10*m2+0.1*(jx-jz)+0.025*(m4-m8)
+					+mrt_V7*m9+mrt_V11*m10-mrt_V8*m11
+					-mrt_V12*m12-0.25*m15-0.125*(m16+m18) + 0.08333333333*(Fx-Fz);
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 13, Np);
+			dist[nread] = fq;
+
+			// q= 14
+			fq = mrt_V1*rho+mrt_V9*m1
+					+mrt_V10*m2+0.1*(jz-jx)+0.025*(m8-m4)
+					+mrt_V7*m9+mrt_V11*m10-mrt_V8*m11
+					-mrt_V12*m12-0.25*m15+0.125*(m16+m18) - 0.08333333333*(Fx-Fz);
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 12, Np);
+			dist[nread] = fq;
+
+
+			// q = 15
+			fq = mrt_V1*rho+mrt_V9*m1
+					+mrt_V10*m2+0.1*(jy+jz)+0.025*(m6+m8)
+					-mrt_V6*m9-mrt_V7*m10+0.25*m14+0.125*(m17-m18) + 0.08333333333*(Fy+Fz);
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 15, Np);
+			dist[nread] = fq;
+
+			// q = 16
+			fq =  mrt_V1*rho+mrt_V9*m1
+					+mrt_V10*m2-0.1*(jy+jz)-0.025*(m6+m8)
+					-mrt_V6*m9-mrt_V7*m10+0.25*m14+0.125*(m18-m17)- 0.08333333333*(Fy+Fz);
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 14, Np);
+			dist[nread] = fq;
+
+
+			// q = 17
+			fq = mrt_V1*rho+mrt_V9*m1
+					+mrt_V10*m2+0.1*(jy-jz)+0.025*(m6-m8)
+					-mrt_V6*m9-mrt_V7*m10-0.25*m14+0.125*(m17+m18) + 0.08333333333*(Fy-Fz);
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 17, Np);
+			dist[nread] = fq;
+
+			// q = 18
+			fq = mrt_V1*rho+mrt_V9*m1
+					+mrt_V10*m2+0.1*(jz-jy)+0.025*(m8-m6)
+					-mrt_V6*m9-mrt_V7*m10-0.25*m14-0.125*(m17+m18) - 0.08333333333*(Fy-Fz);
+			nread = CompactNeighbor(neighborDelta, escapeList, escapeCount, n, 16, Np);
+			dist[nread] = fq;
+
 		}
 	}
 }
 
 
 //__launch_bounds__(512,1)
+template<bool STATS>
 __global__ void 
-dvc_ScaLBL_AAeven_MRT(double *dist, int start, int finish, int Np, double rlx_setA, double rlx_setB, double Fx, double Fy, double Fz) {
+dvc_ScaLBL_AAeven_MRT(double *dist, int start, int finish, int Np, double rlx_setA, double rlx_setB, double Fx, double Fy, double Fz, double *stats) {
+	double sums[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};	// flow statistics (see ScaLBL.h)
 
 	int n;
 	double fq;
@@ -1315,8 +1833,23 @@ dvc_ScaLBL_AAeven_MRT(double *dist, int start, int finish, int Np, double rlx_se
 					-mrt_V6*m9-mrt_V7*m10-0.25*m14-0.125*(m17+m18) - 0.08333333333*(Fy-Fz);
 			dist[18*Np+n] = fq;
 			//........................................................................
+			if (STATS){
+				// post-collision momentum (the force is added by the collision)
+				double px = jx + Fx, py = jy + Fy, pz = jz + Fz;
+				sums[0] += 1.0;
+				sums[1] += rho;
+				sums[2] += px;
+				sums[3] += py;
+				sums[4] += pz;
+				sums[5] += 0.5*(px*px+py*py+pz*pz)/rho;
+			}
 		}
 	}
+	if (STATS){
+		// per-thread partial sums, one atomic add per block
+		extern __shared__ double temp[];
+		for (int m=0; m<6; m++) dvc_AccumulateBlockSum(temp, sums[m], &stats[m]);
+	}
 }
 
 //__launch_bounds__(512,4)
@@ -2672,7 +3205,7 @@ extern "C" void ScaLBL_D3Q19_Reflection_BC_Z(int *list, double *dist, int count,
 extern "C" void ScaLBL_D3Q19_AAeven_MRT(double *dist, int start, int finish, int Np, double rlx_setA, double rlx_setB, double Fx,
        double Fy, double Fz){
        
-       dvc_ScaLBL_AAeven_MRT<<<NBLOCKS,NTHREADS >>>(dist,start,finish,Np,rlx_setA,rlx_setB,Fx,Fy,Fz);
+       dvc_ScaLBL_AAeven_MRT<false><<<NBLOCKS,NTHREADS>>>(dist,start,finish,Np,rlx_setA,rlx_setB,Fx,Fy,Fz,NULL);
 
        cudaError_t err = cudaGetLastError();
 	if (cudaSuccess != err){
@@ -2680,10 +3213,21 @@ extern "C" void ScaLBL_D3Q19_AAeven_MRT(double *dist, int start, int finish, int
 	}
 }
 
+extern "C" void ScaLBL_D3Q19_AAeven_MRT_Stats(double *dist, int start, int finish, int Np, double rlx_setA, double rlx_setB, double Fx,
+       double Fy, double Fz, double *stats){
+       
+       dvc_ScaLBL_AAeven_MRT<true><<<NBLOCKS,NTHREADS,NTHREADS*sizeof(double)>>>(dist,start,finish,Np,rlx_setA,rlx_setB,Fx,Fy,Fz,stats);
+
+       cudaError_t err = cudaGetLastError();
+	if (cudaSuccess != err){
+		printf("CUDA error in ScaLBL_D3Q19_AAeven_MRT_Stats: %s \n",cudaGetErrorString(err));
+	}
+}
+
 extern "C" void ScaLBL_D3Q19_AAodd_MRT(int *neighborlist, double *dist, int start, int finish, int Np, double rlx_setA, double rlx_setB, double Fx,
        double Fy, double Fz){
        
-       dvc_ScaLBL_AAodd_MRT<<<NBLOCKS,NTHREADS >>>(neighborlist,dist,start,finish,Np,rlx_setA,rlx_setB,Fx,Fy,Fz);
+       dvc_ScaLBL_AAodd_MRT<false><<<NBLOCKS,NTHREADS>>>(neighborlist,dist,start,finish,Np,rlx_setA,rlx_setB,Fx,Fy,Fz,NULL);
 
        cudaError_t err = cudaGetLastError();
 	if (cudaSuccess != err){
@@ -2691,3 +3235,25 @@ extern "C" void ScaLBL_D3Q19_AAodd_MRT(int *neighborlist, double *dist, int star
 	}
 }
 
+extern "C" void ScaLBL_D3Q19_AAodd_MRT_Stats(int *neighborlist, double *dist, int start, int finish, int Np, double rlx_setA, double rlx_setB, double Fx,
+       double Fy, double Fz, double *stats){
+       
+       dvc_ScaLBL_AAodd_MRT<true><<<NBLOCKS,NTHREADS,NTHREADS*sizeof(double)>>>(neighborlist,dist,start,finish,Np,rlx_setA,rlx_setB,Fx,Fy,Fz,stats);
+
+       cudaError_t err = cudaGetLastError();
+	if (cudaSuccess != err){
+		printf("CUDA error in ScaLBL_D3Q19_AAodd_MRT_Stats: %s \n",cudaGetErrorString(err));
+	}
+}
+
+extern "C" void ScaLBL_D3Q19_AAodd_MRT_Compact(short *neighborDelta, int *escapeList, int escapeCount, double *dist, int start, int finish, int Np, double rlx_setA, double rlx_setB, double Fx,
+       double Fy, double Fz){
+       
+       dvc_ScaLBL_AAodd_MRT_Compact<<<NBLOCKS,NTHREADS >>>(neighborDelta,escapeList,escapeCount,dist,start,finish,Np,rlx_setA,rlx_setB,Fx,Fy,Fz);
+
+       cudaError_t err = cudaGetLastError();
+	if (cudaSuccess != err){
+		printf("CUDA error in ScaLBL_D3Q19_AAodd_MRT_Compact: %s \n",cudaGetErrorString(err));
+	}
+}
+
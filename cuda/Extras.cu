@@ -17,6 +17,10 @@
 #include <cuda.h>
 #include <stdio.h>
 
+// memory accounting (common/MemoryReport.cpp)
+extern "C" void ScaLBL_RecordAllocation(void* address, size_t size);
+extern "C" void ScaLBL_RecordFree(void* address);
+
 extern "C" int ScaLBL_SetDevice(int rank){
 	int n_devices; 
 	//int local_rank = atoi(getenv("MV2_COMM_WORLD_LOCAL_RANK"));
@@ -33,10 +37,14 @@ extern "C" void ScaLBL_AllocateDeviceMemory(void** address, size_t size){
 	cudaError_t err = cudaGetLastError();
 	if (cudaSuccess != err){
 		printf("Error in cudaMalloc: %s \n",cudaGetErrorString(err));
-	}	
+	}
+	else {
+		ScaLBL_RecordAllocation(*address,size);
+	}
 }
 
 extern "C" void ScaLBL_FreeDeviceMemory(void* pointer){
+	ScaLBL_RecordFree(pointer);
        cudaFree(pointer);
 }
 
@@ -55,6 +63,9 @@ extern "C" void ScaLBL_AllocateZeroCopy(void** address, size_t size){
 	if (cudaSuccess != err){
 		printf("Error in cudaMallocHost: %s \n",cudaGetErrorString(err));
 	}
+	else {
+		ScaLBL_RecordAllocation(*address,size);
+	}
 }
 
 extern "C" void ScaLBL_CopyToZeroCopy(void* dest, const void* source, size_t size){
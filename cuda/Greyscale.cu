@@ -3,6 +3,10 @@
 #define NBLOCKS 1024
 #define NTHREADS 256
 
+// The kernels are instantiated for open sites (OPEN = true, porosity 1, no Brinkman /
+// Forchheimer drag) and grey sites.  The open variant is selected by passing Poros = NULL.
+
+template<bool OPEN>
 __global__ void dvc_ScaLBL_D3Q19_AAeven_Greyscale(double *dist, int start, int finish, int Np, double rlx,  double rlx_eff, double Gx, double Gy, double Gz,
                                                   double *Poros,double *Perm, double *Velocity, double *Pressure){
 	int n;
@@ -47,8 +51,8 @@ __global__ void dvc_ScaLBL_D3Q19_AAeven_Greyscale(double *dist, int start, int f
 		f17 = dist[18*Np+n];
 		f18 = dist[17*Np+n];
 
-        porosity = Poros[n];
-        perm = Perm[n];
+        porosity = OPEN ? 1.0 : Poros[n];
+        perm = OPEN ? 1.0 : Perm[n];
 
         c0 = 0.5*(1.0+porosity*0.5*mu_eff/perm);
         if (porosity==1.0) c0 = 0.5;//i.e. apparent pore nodes
@@ -62,9 +66,16 @@ __global__ void dvc_ScaLBL_D3Q19_AAeven_Greyscale(double *dist, int start, int f
 		vy = (f3-f4+f7-f8-f9+f10+f15-f16+f17-f18)/rho+0.5*porosity*Gy;
 		vz = (f5-f6+f11-f12-f13+f14+f15-f16-f17+f18)/rho+0.5*porosity*Gz;
         v_mag=sqrt(vx*vx+vy*vy+vz*vz);
-        ux = vx/(c0+sqrt(c0*c0+c1*v_mag));
-        uy = vy/(c0+sqrt(c0*c0+c1*v_mag));
-        uz = vz/(c0+sqrt(c0*c0+c1*v_mag));
+        if (OPEN){
+            ux = vx;
+            uy = vy;
+            uz = vz;
+        }
+        else {
+            ux = vx/(c0+sqrt(c0*c0+c1*v_mag));
+            uy = vy/(c0+sqrt(c0*c0+c1*v_mag));
+            uz = vz/(c0+sqrt(c0*c0+c1*v_mag));
+        }
         u_mag=sqrt(ux*ux+uy*uy+uz*uz);
 
         //Update the total force to include linear (Darcy) and nonlinear (Forchheimer) drags due to the porous medium
@@ -256,6 +267,7 @@ __global__ void dvc_ScaLBL_D3Q19_AAeven_Greyscale(double *dist, int start, int f
 	}
 }
 
+template<bool OPEN>
 __global__ void dvc_ScaLBL_D3Q19_AAodd_Greyscale(int *neighborList, double *dist, int start, int finish, int Np, double rlx,  double rlx_eff, double Gx, double Gy, double Gz,
                                                  double *Poros,double *Perm, double *Velocity, double *Pressure){
 	int n;
@@ -354,8 +366,8 @@ __global__ void dvc_ScaLBL_D3Q19_AAodd_Greyscale(int *neighborList, double *dist
 		nr18 = neighborList[n+17*Np];
 		f18 = dist[nr18];
 
-        porosity = Poros[n];
-        perm = Perm[n];
+        porosity = OPEN ? 1.0 : Poros[n];
+        perm = OPEN ? 1.0 : Perm[n];
 
         c0 = 0.5*(1.0+porosity*0.5*mu_eff/perm);
         if (porosity==1.0) c0 = 0.5;//i.e. apparent pore nodes
@@ -369,9 +381,16 @@ __global__ void dvc_ScaLBL_D3Q19_AAodd_Greyscale(int *neighborList, double *dist
 		vy = (f3-f4+f7-f8-f9+f10+f15-f16+f17-f18)/rho+0.5*porosity*Gy;
 		vz = (f5-f6+f11-f12-f13+f14+f15-f16-f17+f18)/rho+0.5*porosity*Gz;
         v_mag=sqrt(vx*vx+vy*vy+vz*vz);
-        ux = vx/(c0+sqrt(c0*c0+c1*v_mag));
-        uy = vy/(c0+sqrt(c0*c0+c1*v_mag));
-        uz = vz/(c0+sqrt(c0*c0+c1*v_mag));
+        if (OPEN){
+            ux = vx;
+            uy = vy;
+            uz = vz;
+        }
+        else {
+            ux = vx/(c0+sqrt(c0*c0+c1*v_mag));
+            uy = vy/(c0+sqrt(c0*c0+c1*v_mag));
+            uz = vz/(c0+sqrt(c0*c0+c1*v_mag));
+        }
         u_mag=sqrt(ux*ux+uy*uy+uz*uz);
 
         //Update the body force to include linear (Darcy) and nonlinear (Forchheimer) drags due to the porous medium
@@ -563,6 +582,7 @@ __global__ void dvc_ScaLBL_D3Q19_AAodd_Greyscale(int *neighborList, double *dist
 	}
 }
 
+template<bool OPEN>
 __global__ void dvc_ScaLBL_D3Q19_AAeven_Greyscale_IMRT(double *dist, int start, int finish, int Np, double rlx,  double rlx_eff, double Gx, double Gy, double Gz,
                                                   double *Poros,double *Perm, double *Velocity, double Den, double *Pressure){
 
@@ -880,8 +900,8 @@ __global__ void dvc_ScaLBL_D3Q19_AAeven_Greyscale_IMRT(double *dist, int start,
             m18 -= fq;
             //---------------------------------------------------------------------//
 
-            porosity = Poros[n];
-            perm = Perm[n];
+            porosity = OPEN ? 1.0 : Poros[n];
+            perm = OPEN ? 1.0 : Perm[n];
 
             c0 = 0.5*(1.0+porosity*0.5*mu_eff/perm);
             if (porosity==1.0) c0 = 0.5;//i.e. apparent pore nodes
@@ -893,9 +913,16 @@ __global__ void dvc_ScaLBL_D3Q19_AAeven_Greyscale_IMRT(double *dist, int start,
             vy = jy/Den+0.5*porosity*Gy;
             vz = jz/Den+0.5*porosity*Gz;
             v_mag=sqrt(vx*vx+vy*vy+vz*vz);
-            ux = vx/(c0+sqrt(c0*c0+c1*v_mag));
-            uy = vy/(c0+sqrt(c0*c0+c1*v_mag));
-            uz = vz/(c0+sqrt(c0*c0+c1*v_mag));
+            if (OPEN){
+                ux = vx;
+                uy = vy;
+                uz = vz;
+            }
+            else {
+                ux = vx/(c0+sqrt(c0*c0+c1*v_mag));
+                uy = vy/(c0+sqrt(c0*c0+c1*v_mag));
+                uz = vz/(c0+sqrt(c0*c0+c1*v_mag));
+            }
             u_mag=sqrt(ux*ux+uy*uy+uz*uz);
 
             //Update the total force to include linear (Darcy) and nonlinear (Forchheimer) drags due to the porous medium
@@ -1059,6 +1086,7 @@ __global__ void dvc_ScaLBL_D3Q19_AAeven_Greyscale_IMRT(double *dist, int start,
 }
 
 
+template<bool OPEN>
 __global__ void dvc_ScaLBL_D3Q19_AAodd_Greyscale_IMRT(int *neighborList, double *dist, int start, int finish, int Np, double rlx,  double rlx_eff, double Gx, double Gy, double Gz,
                                                  double *Poros,double *Perm, double *Velocity,double Den, double *Pressure){
 
@@ -1393,8 +1421,8 @@ __global__ void dvc_ScaLBL_D3Q19_AAodd_Greyscale_IMRT(int *neighborList, double
             m18 -= fq;
             //---------------------------------------------------------------------//
 
-            porosity = Poros[n];
-            perm = Perm[n];
+            porosity = OPEN ? 1.0 : Poros[n];
+            perm = OPEN ? 1.0 : Perm[n];
 
             c0 = 0.5*(1.0+porosity*0.5*mu_eff/perm);
             if (porosity==1.0) c0 = 0.5;//i.e. apparent pore nodes
@@ -1406,9 +1434,16 @@ __global__ void dvc_ScaLBL_D3Q19_AAodd_Greyscale_IMRT(int *neighborList, double
             vy = jy/Den+0.5*porosity*Gy;
             vz = jz/Den+0.5*porosity*Gz;
             v_mag=sqrt(vx*vx+vy*vy+vz*vz);
-            ux = vx/(c0+sqrt(c0*c0+c1*v_mag));
-            uy = vy/(c0+sqrt(c0*c0+c1*v_mag));
-            uz = vz/(c0+sqrt(c0*c0+c1*v_mag));
+            if (OPEN){
+                ux = vx;
+                uy = vy;
+                uz = vz;
+            }
+            else {
+                ux = vx/(c0+sqrt(c0*c0+c1*v_mag));
+                uy = vy/(c0+sqrt(c0*c0+c1*v_mag));
+                uz = vz/(c0+sqrt(c0*c0+c1*v_mag));
+            }
             u_mag=sqrt(ux*ux+uy*uy+uz*uz);
 
             //Update the total force to include linear (Darcy) and nonlinear (Forchheimer) drags due to the porous medium
@@ -1590,6 +1625,7 @@ __global__ void dvc_ScaLBL_D3Q19_AAodd_Greyscale_IMRT(int *neighborList, double
 	}
 }
 
+template<bool OPEN>
 __global__ void dvc_ScaLBL_D3Q19_AAodd_Greyscale_MRT(int *neighborList, double *dist, int start, int finish, int Np, double rlx,  double rlx_eff, double Gx, double Gy, double Gz,
                                                  double *Poros,double *Perm, double *Velocity,double rho0, double *Pressure){
 
@@ -1961,8 +1997,8 @@ __global__ void dvc_ScaLBL_D3Q19_AAodd_Greyscale_MRT(int *neighborList, double *
 			m18 -= fq;
             //---------------------------------------------------------------------//
 
-            porosity = Poros[n];
-            perm = Perm[n];
+            porosity = OPEN ? 1.0 : Poros[n];
+            perm = OPEN ? 1.0 : Perm[n];
 
             c0 = 0.5*(1.0+porosity*0.5*mu_eff/perm);
             if (porosity==1.0) c0 = 0.5;//i.e. apparent pore nodes
@@ -1974,9 +2010,16 @@ __global__ void dvc_ScaLBL_D3Q19_AAodd_Greyscale_MRT(int *neighborList, double *
             vy = jy/rho0+0.5*porosity*Gy;
             vz = jz/rho0+0.5*porosity*Gz;
             v_mag=sqrt(vx*vx+vy*vy+vz*vz);
-            ux = vx/(c0+sqrt(c0*c0+c1*v_mag));
-            uy = vy/(c0+sqrt(c0*c0+c1*v_mag));
-            uz = vz/(c0+sqrt(c0*c0+c1*v_mag));
+            if (OPEN){
+                ux = vx;
+                uy = vy;
+                uz = vz;
+            }
+            else {
+                ux = vx/(c0+sqrt(c0*c0+c1*v_mag));
+                uy = vy/(c0+sqrt(c0*c0+c1*v_mag));
+                uz = vz/(c0+sqrt(c0*c0+c1*v_mag));
+            }
             u_mag=sqrt(ux*ux+uy*uy+uz*uz);
 
             //Update the total force to include linear (Darcy) and nonlinear (Forchheimer) drags due to the porous medium
@@ -2150,6 +2193,7 @@ __global__ void dvc_ScaLBL_D3Q19_AAodd_Greyscale_MRT(int *neighborList, double *
 	}
 }
 
+template<bool OPEN>
 __global__ void dvc_ScaLBL_D3Q19_AAeven_Greyscale_MRT(double *dist, int start, int finish, int Np, double rlx,  double rlx_eff, double Gx, double Gy, double Gz,
                                                   double *Poros,double *Perm, double *Velocity,double rho0, double *Pressure){
 
@@ -2468,8 +2512,8 @@ __global__ void dvc_ScaLBL_D3Q19_AAeven_Greyscale_MRT(double *dist, int start, i
 			m18 -= fq;
             //---------------------------------------------------------------------//
 
-            porosity = Poros[n];
-            perm = Perm[n];
+            porosity = OPEN ? 1.0 : Poros[n];
+            perm = OPEN ? 1.0 : Perm[n];
 
             c0 = 0.5*(1.0+porosity*0.5*mu_eff/perm);
             if (porosity==1.0) c0 = 0.5;//i.e. apparent pore nodes
@@ -2481,9 +2525,16 @@ __global__ void dvc_ScaLBL_D3Q19_AAeven_Greyscale_MRT(double *dist, int start, i
             vy = jy/rho0+0.5*porosity*Gy;
             vz = jz/rho0+0.5*porosity*Gz;
             v_mag=sqrt(vx*vx+vy*vy+vz*vz);
-            ux = vx/(c0+sqrt(c0*c0+c1*v_mag));
-            uy = vy/(c0+sqrt(c0*c0+c1*v_mag));
-            uz = vz/(c0+sqrt(c0*c0+c1*v_mag));
+            if (OPEN){
+                ux = vx;
+                uy = vy;
+                uz = vz;
+            }
+            else {
+                ux = vx/(c0+sqrt(c0*c0+c1*v_mag));
+                uy = vy/(c0+sqrt(c0*c0+c1*v_mag));
+                uz = vz/(c0+sqrt(c0*c0+c1*v_mag));
+            }
             u_mag=sqrt(ux*ux+uy*uy+uz*uz);
 
             //Update the total force to include linear (Darcy) and nonlinear (Forchheimer) drags due to the porous medium
@@ -2676,7 +2727,10 @@ __global__ void dvc_ScaLBL_D3Q19_GreyIMRT_Init(double *dist, int Np, double Den)
 
 extern "C" void ScaLBL_D3Q19_AAeven_Greyscale(double *dist, int start, int finish, int Np, double rlx, double rlx_eff, double Fx, double Fy, double Fz,double *Poros,double *Perm, double *Velocity,double *Pressure){
 	
-    dvc_ScaLBL_D3Q19_AAeven_Greyscale<<<NBLOCKS,NTHREADS >>>(dist,start,finish,Np,rlx,rlx_eff,Fx,Fy,Fz,Poros,Perm,Velocity,Pressure);
+    if (Poros == NULL)
+        dvc_ScaLBL_D3Q19_AAeven_Greyscale<true><<<NBLOCKS,NTHREADS >>>(dist,start,finish,Np,rlx,rlx_eff,Fx,Fy,Fz,Poros,Perm,Velocity,Pressure);
+    else
+        dvc_ScaLBL_D3Q19_AAeven_Greyscale<false><<<NBLOCKS,NTHREADS >>>(dist,start,finish,Np,rlx,rlx_eff,Fx,Fy,Fz,Poros,Perm,Velocity,Pressure);
 
     cudaError_t err = cudaGetLastError();
 	if (cudaSuccess != err){
@@ -2686,7 +2740,10 @@ extern "C" void ScaLBL_D3Q19_AAeven_Greyscale(double *dist, int start, int finis
 
 extern "C" void ScaLBL_D3Q19_AAodd_Greyscale(int *neighborList, double *dist, int start, int finish, int Np, double rlx, double rlx_eff, double Fx, double Fy, double Fz,double *Poros,double *Perm, double *Velocity,double *Pressure){
 
-    dvc_ScaLBL_D3Q19_AAodd_Greyscale<<<NBLOCKS,NTHREADS >>>(neighborList,dist,start,finish,Np,rlx,rlx_eff,Fx,Fy,Fz,Poros,Perm,Velocity,Pressure);
+    if (Poros == NULL)
+        dvc_ScaLBL_D3Q19_AAodd_Greyscale<true><<<NBLOCKS,NTHREADS >>>(neighborList,dist,start,finish,Np,rlx,rlx_eff,Fx,Fy,Fz,Poros,Perm,Velocity,Pressure);
+    else
+        dvc_ScaLBL_D3Q19_AAodd_Greyscale<false><<<NBLOCKS,NTHREADS >>>(neighborList,dist,start,finish,Np,rlx,rlx_eff,Fx,Fy,Fz,Poros,Perm,Velocity,Pressure);
 
     cudaError_t err = cudaGetLastError();
 	if (cudaSuccess != err){
@@ -2696,7 +2753,10 @@ extern "C" void ScaLBL_D3Q19_AAodd_Greyscale(int *neighborList, double *dist, in
 
 extern "C" void ScaLBL_D3Q19_AAeven_Greyscale_IMRT(double *dist, int start, int finish, int Np, double rlx, double rlx_eff, double Fx, double Fy, double Fz,double *Poros,double *Perm, double *Velocity,double Den,double *Pressure){
 	
-    dvc_ScaLBL_D3Q19_AAeven_Greyscale_IMRT<<<NBLOCKS,NTHREADS >>>(dist,start,finish,Np,rlx,rlx_eff,Fx,Fy,Fz,Poros,Perm,Velocity,Den,Pressure);
+    if (Poros == NULL)
+        dvc_ScaLBL_D3Q19_AAeven_Greyscale_IMRT<true><<<NBLOCKS,NTHREADS >>>(dist,start,finish,Np,rlx,rlx_eff,Fx,Fy,Fz,Poros,Perm,Velocity,Den,Pressure);
+    else
+        dvc_ScaLBL_D3Q19_AAeven_Greyscale_IMRT<false><<<NBLOCKS,NTHREADS >>>(dist,start,finish,Np,rlx,rlx_eff,Fx,Fy,Fz,Poros,Perm,Velocity,Den,Pressure);
 
     cudaError_t err = cudaGetLastError();
 	if (cudaSuccess != err){
@@ -2706,7 +2766,10 @@ extern "C" void ScaLBL_D3Q19_AAeven_Greyscale_IMRT(double *dist, int start, int
 
 extern "C" void ScaLBL_D3Q19_AAodd_Greyscale_IMRT(int *neighborList, double *dist, int start, int finish, int Np, double rlx, double rlx_eff, double Fx, double Fy, double Fz,double *Poros,double *Perm, double *Velocity,double Den,double *Pressure){
 
-    dvc_ScaLBL_D3Q19_AAodd_Greyscale_IMRT<<<NBLOCKS,NTHREADS >>>(neighborList,dist,start,finish,Np,rlx,rlx_eff,Fx,Fy,Fz,Poros,Perm,Velocity,Den,Pressure);
+    if (Poros == NULL)
+        dvc_ScaLBL_D3Q19_AAodd_Greyscale_IMRT<true><<<NBLOCKS,NTHREADS >>>(neighborList,dist,start,finish,Np,rlx,rlx_eff,Fx,Fy,Fz,Poros,Perm,Velocity,Den,Pressure);
+    else
+        dvc_ScaLBL_D3Q19_AAodd_Greyscale_IMRT<false><<<NBLOCKS,NTHREADS >>>(neighborList,dist,start,finish,Np,rlx,rlx_eff,Fx,Fy,Fz,Poros,Perm,Velocity,Den,Pressure);
 
     cudaError_t err = cudaGetLastError();
 	if (cudaSuccess != err){
@@ -2716,7 +2779,10 @@ extern "C" void ScaLBL_D3Q19_AAodd_Greyscale_IMRT(int *neighborList, double *dis
 
 extern "C" void ScaLBL_D3Q19_AAodd_Greyscale_MRT(int *neighborList, double *dist, int start, int finish, int Np, double rlx, double rlx_eff, double Fx, double Fy, double Fz,double *Poros,double *Perm, double *Velocity,double rho0,double *Pressure){
 
-    dvc_ScaLBL_D3Q19_AAodd_Greyscale_MRT<<<NBLOCKS,NTHREADS >>>(neighborList,dist,start,finish,Np,rlx,rlx_eff,Fx,Fy,Fz,Poros,Perm,Velocity,rho0,Pressure);
+    if (Poros == NULL)
+        dvc_ScaLBL_D3Q19_AAodd_Greyscale_MRT<true><<<NBLOCKS,NTHREADS >>>(neighborList,dist,start,finish,Np,rlx,rlx_eff,Fx,Fy,Fz,Poros,Perm,Velocity,rho0,Pressure);
+    else
+        dvc_ScaLBL_D3Q19_AAodd_Greyscale_MRT<false><<<NBLOCKS,NTHREADS >>>(neighborList,dist,start,finish,Np,rlx,rlx_eff,Fx,Fy,Fz,Poros,Perm,Velocity,rho0,Pressure);
 
     cudaError_t err = cudaGetLastError();
 	if (cudaSuccess != err){
@@ -2726,7 +2792,10 @@ extern "C" void ScaLBL_D3Q19_AAodd_Greyscale_MRT(int *neighborList, double *dist
 
 extern "C" void ScaLBL_D3Q19_AAeven_Greyscale_MRT(double *dist, int start, int finish, int Np, double rlx, double rlx_eff, double Fx, double Fy, double Fz,double *Poros,double *Perm, double *Velocity,double rho0,double *Pressure){
 	
-    dvc_ScaLBL_D3Q19_AAeven_Greyscale_MRT<<<NBLOCKS,NTHREADS >>>(dist,start,finish,Np,rlx,rlx_eff,Fx,Fy,Fz,Poros,Perm,Velocity,rho0,Pressure);
+    if (Poros == NULL)
+        dvc_ScaLBL_D3Q19_AAeven_Greyscale_MRT<true><<<NBLOCKS,NTHREADS >>>(dist,start,finish,Np,rlx,rlx_eff,Fx,Fy,Fz,Poros,Perm,Velocity,rho0,Pressure);
+    else
+        dvc_ScaLBL_D3Q19_AAeven_Greyscale_MRT<false><<<NBLOCKS,NTHREADS >>>(dist,start,finish,Np,rlx,rlx_eff,Fx,Fy,Fz,Poros,Perm,Velocity,rho0,Pressure);
 
     cudaError_t err = cudaGetLastError();
 	if (cudaSuccess != err){
@@ -0,0 +1,314 @@
+/*
+  Copyright Equnior ASA
+
+  This file is part of the Open Porous Media project (OPM).
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/* Non-Newtonian MRT collision for the AA layout
+ *  The relaxation rate of the viscous moments follows from the viscosity of the rheology model
+ *  at the shear rate of the site, which is computed from the non-equilibrium moments with the
+ *  viscosity of the previous timestep (stored in Viscosity)
+ */
+#include <stdio.h>
+#include <math.h>
+#include "common/ScaLBL.h"
+
+#define NBLOCKS 1024
+#define NTHREADS 256
+
+#if !defined(__CUDA_ARCH__) || __CUDA_ARCH__ >= 600
+#else
+__device__ double atomicAdd(double* address, double val) { 
+   unsigned long long int* address_as_ull = (unsigned long long int*)address;
+   unsigned long long int old = *address_as_ull, assumed;
+
+   do {
+      assumed = old;
+      old = atomicCAS(address_as_ull, assumed, __double_as_longlong(val+__longlong_as_double(assumed)));
+   } while (assumed != old);
+   return __longlong_as_double(old);
+}
+#endif
+
+// Add the sum of val over the thread block to *sum (temp holds blockDim.x doubles)
+static __device__ void dvc_AccumulateBlockSum(double *temp, double val, double *sum){
+	int lane = threadIdx.x;
+	for (int i = blockDim.x/2; i > 0; i /= 2){
+		temp[lane] = val;
+		__syncthreads();
+		if (lane < i) val += temp[lane+i];
+		__syncthreads();
+	}
+	if (lane == 0) atomicAdd(sum, val);
+}
+
+// Apparent viscosity for the shear rate (see ScaLBL.h for the rheology models)
+static __device__ inline double NonNewtonianViscosity(double shear_rate, int rheology, double nu_0, double nu_inf,
+		double lambda, double n_index, double nu_min, double nu_max){
+	double nu;
+	if (rheology == 1)
+		nu = nu_inf + (nu_0-nu_inf)*pow(1.0+lambda*lambda*shear_rate*shear_rate, 0.5*(n_index-1.0));
+	else
+		nu = nu_0*pow(shear_rate, n_index-1.0);
+	if (!(nu > nu_min)) nu = nu_min;
+	if (nu > nu_max) nu = nu_max;
+	return nu;
+}
+
+// Collision of the distributions f (D3Q19 order) at one site, returns the density and the momentum
+static __device__ inline void NonNewtonianCollision(double *f, double &nu, int rheology, double nu_0, double nu_inf,
+		double lambda, double n_index, double nu_min, double nu_max, double Fx, double Fy, double Fz,
+		double &rho, double &jx, double &jy, double &jz)
+{
+	constexpr double mrt_V1=0.05263157894736842;
+	constexpr double mrt_V2=0.012531328320802;
+	constexpr double mrt_V3=0.04761904761904762;
+	constexpr double mrt_V4=0.004594820384294068;
+	constexpr double mrt_V5=0.01587301587301587;
+	constexpr double mrt_V6=0.0555555555555555555555555;
+	constexpr double mrt_V7=0.02777777777777778;
+	constexpr double mrt_V8=0.08333333333333333;
+	constexpr double mrt_V9=0.003341687552213868;
+	constexpr double mrt_V10=0.003968253968253968;
+	constexpr double mrt_V11=0.01388888888888889;
+	constexpr double mrt_V12=0.04166666666666666;
+
+	//..............moments (d'Humieres D3Q19 basis)...............................................
+	double fx = f[1]+f[2], fy = f[3]+f[4], fz = f[5]+f[6];
+	double exy = f[7]+f[8]+f[9]+f[10];
+	double exz = f[11]+f[12]+f[13]+f[14];
+	double eyz = f[15]+f[16]+f[17]+f[18];
+	double faces = fx+fy+fz;
+	double edges = exy+exz+eyz;
+	rho = f[0]+faces+edges;
+	double m1 = -30.0*f[0] - 11.0*faces + 8.0*edges;
+	double m2 = 12.0*f[0] - 4.0*faces + edges;
+	jx = f[1]-f[2]+f[7]-f[8]+f[9]-f[10]+f[11]-f[12]+f[13]-f[14];
+	jy = f[3]-f[4]+f[7]-f[8]-f[9]+f[10]+f[15]-f[16]+f[17]-f[18];
+	jz = f[5]-f[6]+f[11]-f[12]-f[13]+f[14]+f[15]-f[16]-f[17]+f[18];
+	double m4 = jx-5.0*(f[1]-f[2]);
+	double m6 = jy-5.0*(f[3]-f[4]);
+	double m8 = jz-5.0*(f[5]-f[6]);
+	double m9 = 2.0*fx-fy-fz+exy+exz-2.0*eyz;
+	double m10 = -4.0*fx+2.0*(fy+fz)+exy+exz-2.0*eyz;
+	double m11 = fy-fz+exy-exz;
+	double m12 = -2.0*(fy-fz)+exy-exz;
+	double m13 = f[7]+f[8]-f[9]-f[10];
+	double m14 = f[15]+f[16]-f[17]-f[18];
+	double m15 = f[11]+f[12]-f[13]-f[14];
+	double m16 = f[7]-f[8]+f[9]-f[10]-f[11]+f[12]-f[13]+f[14];
+	double m17 = -f[7]+f[8]+f[9]-f[10]+f[15]-f[16]+f[17]-f[18];
+	double m18 = f[11]-f[12]-f[13]+f[14]-f[15]+f[16]+f[17]-f[18];
+
+	//..............equilibrium of the viscous moments...............................................
+	double usq = (jx*jx+jy*jy+jz*jz)/rho;
+	double m1eq = 19.0*usq - 11.0*rho;
+	double m9eq = (2.0*jx*jx-jy*jy-jz*jz)/rho;
+	double m11eq = (jy*jy-jz*jz)/rho;
+	double m13eq = jx*jy/rho;
+	double m14eq = jy*jz/rho;
+	double m15eq = jx*jz/rho;
+
+	//..............shear rate from the non-equilibrium momentum flux.................................
+	double trace = (m1-m1eq)/19.0;
+	double Pxx = (trace+m9-m9eq)/3.0;
+	double Pyy = 0.5*(trace-Pxx+m11-m11eq);
+	double Pzz = 0.5*(trace-Pxx-m11+m11eq);
+	double Pxy = m13-m13eq;
+	double Pyz = m14-m14eq;
+	double Pxz = m15-m15eq;
+	double PP = Pxx*Pxx+Pyy*Pyy+Pzz*Pzz+2.0*(Pxy*Pxy+Pyz*Pyz+Pxz*Pxz);
+	double rlx = 1.0/(3.0*nu+0.5);
+	double shear_rate = 1.5*rlx/rho*sqrt(2.0*PP);
+	nu = NonNewtonianViscosity(shear_rate, rheology, nu_0, nu_inf, lambda, n_index, nu_min, nu_max);
+	double rlx_setA = 1.0/(3.0*nu+0.5);
+	double rlx_setB = 8.0*(2.0-rlx_setA)/(8.0-rlx_setA);
+
+	//..............carry out relaxation process...............................................
+	m1 = m1 + rlx_setA*(m1eq - m1);
+	m2 = m2 + rlx_setA*((3*rho - 5.5*usq) - m2);
+	m4 = m4 + rlx_setB*((-0.6666666666666666*jx) - m4);
+	m6 = m6 + rlx_setB*((-0.6666666666666666*jy) - m6);
+	m8 = m8 + rlx_setB*((-0.6666666666666666*jz) - m8);
+	m9 = m9 + rlx_setA*(m9eq - m9);
+	m10 = m10 + rlx_setA*(-0.5*m9eq - m10);
+	m11 = m11 + rlx_setA*(m11eq - m11);
+	m12 = m12 + rlx_setA*(-0.5*m11eq - m12);
+	m13 = m13 + rlx_setA*(m13eq - m13);
+	m14 = m14 + rlx_setA*(m14eq - m14);
+	m15 = m15 + rlx_setA*(m15eq - m15);
+	m16 = m16 + rlx_setB*( - m16);
+	m17 = m17 + rlx_setB*( - m17);
+	m18 = m18 + rlx_setB*( - m18);
+
+	//.................inverse transformation......................................................
+	f[0] = mrt_V1*rho-mrt_V2*m1+mrt_V3*m2;
+	f[1] = mrt_V1*rho-mrt_V4*m1-mrt_V5*m2+0.1*(jx-m4)+mrt_V6*(m9-m10) + 0.16666666*Fx;
+	f[2] = mrt_V1*rho-mrt_V4*m1-mrt_V5*m2+0.1*(m4-jx)+mrt_V6*(m9-m10) - 0.16666666*Fx;
+	f[3] = mrt_V1*rho-mrt_V4*m1-mrt_V5*m2+0.1*(jy-m6)+mrt_V7*(m10-m9)+mrt_V8*(m11-m12) + 0.16666666*Fy;
+	f[4] = mrt_V1*rho-mrt_V4*m1-mrt_V5*m2+0.1*(m6-jy)+mrt_V7*(m10-m9)+mrt_V8*(m11-m12) - 0.16666666*Fy;
+	f[5] = mrt_V1*rho-mrt_V4*m1-mrt_V5*m2+0.1*(jz-m8)+mrt_V7*(m10-m9)+mrt_V8*(m12-m11) + 0.16666666*Fz;
+	f[6] = mrt_V1*rho-mrt_V4*m1-mrt_V5*m2+0.1*(m8-jz)+mrt_V7*(m10-m9)+mrt_V8*(m12-m11) - 0.16666666*Fz;
+	f[7] = mrt_V1*rho+mrt_V9*m1+mrt_V10*m2+0.1*(jx+jy)+0.025*(m4+m6)+mrt_V7*m9+mrt_V11*m10+mrt_V8*m11
+			+mrt_V12*m12+0.25*m13+0.125*(m16-m17) + 0.08333333333*(Fx+Fy);
+	f[8] = mrt_V1*rho+mrt_V9*m1+mrt_V10*m2-0.1*(jx+jy)-0.025*(m4+m6)+mrt_V7*m9+mrt_V11*m10+mrt_V8*m11
+			+mrt_V12*m12+0.25*m13+0.125*(m17-m16) - 0.08333333333*(Fx+Fy);
+	f[9] = mrt_V1*rho+mrt_V9*m1+mrt_V10*m2+0.1*(jx-jy)+0.025*(m4-m6)+mrt_V7*m9+mrt_V11*m10+mrt_V8*m11
+			+mrt_V12*m12-0.25*m13+0.125*(m16+m17) + 0.08333333333*(Fx-Fy);
+	f[10] = mrt_V1*rho+mrt_V9*m1+mrt_V10*m2+0.1*(jy-jx)+0.025*(m6-m4)+mrt_V7*m9+mrt_V11*m10+mrt_V8*m11
+			+mrt_V12*m12-0.25*m13-0.125*(m16+m17) - 0.08333333333*(Fx-Fy);
+	f[11] = mrt_V1*rho+mrt_V9*m1+mrt_V10*m2+0.1*(jx+jz)+0.025*(m4+m8)+mrt_V7*m9+mrt_V11*m10-mrt_V8*m11
+			-mrt_V12*m12+0.25*m15+0.125*(m18-m16) + 0.08333333333*(Fx+Fz);
+	f[12] = mrt_V1*rho+mrt_V9*m1+mrt_V10*m2-0.1*(jx+jz)-0.025*(m4+m8)+mrt_V7*m9+mrt_V11*m10-mrt_V8*m11
+			-mrt_V12*m12+0.25*m15+0.125*(m16-m18) - 0.08333333333*(Fx+Fz);
+	f[13] = mrt_V1*rho+mrt_V9*m1+mrt_V10*m2+0.1*(jx-jz)+0.025*(m4-m8)+mrt_V7*m9+mrt_V11*m10-mrt_V8*m11
+			-mrt_V12*m12-0.25*m15-0.125*(m16+m18) + 0.08333333333*(Fx-Fz);
+	f[14] = mrt_V1*rho+mrt_V9*m1+mrt_V10*m2+0.1*(jz-jx)+0.025*(m8-m4)+mrt_V7*m9+mrt_V11*m10-mrt_V8*m11
+			-mrt_V12*m12-0.25*m15+0.125*(m16+m18) - 0.08333333333*(Fx-Fz);
+	f[15] = mrt_V1*rho+mrt_V9*m1+mrt_V10*m2+0.1*(jy+jz)+0.025*(m6+m8)
+			-mrt_V6*m9-mrt_V7*m10+0.25*m14+0.125*(m17-m18) + 0.08333333333*(Fy+Fz);
+	f[16] = mrt_V1*rho+mrt_V9*m1+mrt_V10*m2-0.1*(jy+jz)-0.025*(m6+m8)
+			-mrt_V6*m9-mrt_V7*m10+0.25*m14+0.125*(m18-m17) - 0.08333333333*(Fy+Fz);
+	f[17] = mrt_V1*rho+mrt_V9*m1+mrt_V10*m2+0.1*(jy-jz)+0.025*(m6-m8)
+			-mrt_V6*m9-mrt_V7*m10-0.25*m14+0.125*(m17+m18) + 0.08333333333*(Fy-Fz);
+	f[18] = mrt_V1*rho+mrt_V9*m1+mrt_V10*m2+0.1*(jz-jy)+0.025*(m8-m6)
+			-mrt_V6*m9-mrt_V7*m10-0.25*m14-0.125*(m17+m18) - 0.08333333333*(Fy-Fz);
+}
+
+template<bool STATS>
+__global__ void
+dvc_ScaLBL_AAeven_NonNewtonianMRT(double *dist, double *Viscosity, int start, int finish, int Np, int rheology,
+		double nu_0, double nu_inf, double lambda, double n_index, double nu_min, double nu_max,
+		double Fx, double Fy, double Fz, double *stats)
+{
+	double sums[SCALBL_NONNEWTONIAN_STATS] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+	double f[19];
+	double rho,jx,jy,jz;
+	int S = Np/NBLOCKS/NTHREADS+1;
+	for (int s=0; s<S; s++){
+		//........Get 1-D index for this thread....................
+		int n = S*blockIdx.x*blockDim.x + s*blockDim.x + threadIdx.x + start;
+		if (n<finish) {
+			// the even step reads the opposite direction from the site
+			f[0] = dist[n];
+			for (int q=1; q<19; q+=2){
+				f[q] = dist[(q+1)*Np+n];
+				f[q+1] = dist[q*Np+n];
+			}
+			double nu = Viscosity[n];
+			NonNewtonianCollision(f, nu, rheology, nu_0, nu_inf, lambda, n_index, nu_min, nu_max, Fx, Fy, Fz, rho, jx, jy, jz);
+			Viscosity[n] = nu;
+			for (int q=0; q<19; q++)
+				dist[q*Np+n] = f[q];
+			if (STATS){
+				// post-collision momentum (the force is added by the collision)
+				double px = jx + Fx, py = jy + Fy, pz = jz + Fz;
+				sums[0] += 1.0;
+				sums[1] += rho;
+				sums[2] += px;
+				sums[3] += py;
+				sums[4] += pz;
+				sums[5] += 0.5*(px*px+py*py+pz*pz)/rho;
+				sums[6] += nu;
+			}
+		}
+	}
+	if (STATS){
+		// per-thread partial sums, one atomic add per block
+		extern __shared__ double temp[];
+		for (int m=0; m<SCALBL_NONNEWTONIAN_STATS; m++) dvc_AccumulateBlockSum(temp, sums[m], &stats[m]);
+	}
+}
+
+template<bool STATS>
+__global__ void
+dvc_ScaLBL_AAodd_NonNewtonianMRT(int *neighborList, double *dist, double *Viscosity, int start, int finish, int Np,
+		int rheology, double nu_0, double nu_inf, double lambda, double n_index, double nu_min, double nu_max,
+		double Fx, double Fy, double Fz, double *stats)
+{
+	double sums[SCALBL_NONNEWTONIAN_STATS] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+	double f[19];
+	double rho,jx,jy,jz;
+	int S = Np/NBLOCKS/NTHREADS+1;
+	for (int s=0; s<S; s++){
+		//........Get 1-D index for this thread....................
+		int n = S*blockIdx.x*blockDim.x + s*blockDim.x + threadIdx.x + start;
+		if (n<finish) {
+			// the odd step reads from the neighbors and writes the opposite direction to them
+			f[0] = dist[n];
+			for (int q=1; q<19; q++)
+				f[q] = dist[neighborList[(q-1)*Np+n]];
+			double nu = Viscosity[n];
+			NonNewtonianCollision(f, nu, rheology, nu_0, nu_inf, lambda, n_index, nu_min, nu_max, Fx, Fy, Fz, rho, jx, jy, jz);
+			Viscosity[n] = nu;
+			dist[n] = f[0];
+			for (int q=1; q<19; q+=2){
+				dist[neighborList[q*Np+n]] = f[q];
+				dist[neighborList[(q-1)*Np+n]] = f[q+1];
+			}
+			if (STATS){
+				double px = jx + Fx, py = jy + Fy, pz = jz + Fz;
+				sums[0] += 1.0;
+				sums[1] += rho;
+				sums[2] += px;
+				sums[3] += py;
+				sums[4] += pz;
+				sums[5] += 0.5*(px*px+py*py+pz*pz)/rho;
+				sums[6] += nu;
+			}
+		}
+	}
+	if (STATS){
+		extern __shared__ double temp[];
+		for (int m=0; m<SCALBL_NONNEWTONIAN_STATS; m++) dvc_AccumulateBlockSum(temp, sums[m], &stats[m]);
+	}
+}
+
+extern "C" void ScaLBL_D3Q19_AAeven_NonNewtonianMRT(double *dist, double *Viscosity, int start, int finish, int Np,
+		int rheology, double nu_0, double nu_inf, double lambda, double n_index, double nu_min, double nu_max,
+		double Fx, double Fy, double Fz){
+	dvc_ScaLBL_AAeven_NonNewtonianMRT<false><<<NBLOCKS,NTHREADS>>>(dist,Viscosity,start,finish,Np,rheology,nu_0,nu_inf,lambda,n_index,nu_min,nu_max,Fx,Fy,Fz,NULL);
+	cudaError_t err = cudaGetLastError();
+	if (cudaSuccess != err){
+		printf("CUDA error in ScaLBL_D3Q19_AAeven_NonNewtonianMRT: %s \n",cudaGetErrorString(err));
+	}
+}
+
+extern "C" void ScaLBL_D3Q19_AAeven_NonNewtonianMRT_Stats(double *dist, double *Viscosity, int start, int finish, int Np,
+		int rheology, double nu_0, double nu_inf, double lambda, double n_index, double nu_min, double nu_max,
+		double Fx, double Fy, double Fz, double *stats){
+	dvc_ScaLBL_AAeven_NonNewtonianMRT<true><<<NBLOCKS,NTHREADS,NTHREADS*sizeof(double)>>>(dist,Viscosity,start,finish,Np,rheology,nu_0,nu_inf,lambda,n_index,nu_min,nu_max,Fx,Fy,Fz,stats);
+	cudaError_t err = cudaGetLastError();
+	if (cudaSuccess != err){
+		printf("CUDA error in ScaLBL_D3Q19_AAeven_NonNewtonianMRT_Stats: %s \n",cudaGetErrorString(err));
+	}
+}
+
+extern "C" void ScaLBL_D3Q19_AAodd_NonNewtonianMRT(int *neighborList, double *dist, double *Viscosity, int start, int finish,
+		int Np, int rheology, double nu_0, double nu_inf, double lambda, double n_index, double nu_min, double nu_max,
+		double Fx, double Fy, double Fz){
+	dvc_ScaLBL_AAodd_NonNewtonianMRT<false><<<NBLOCKS,NTHREADS>>>(neighborList,dist,Viscosity,start,finish,Np,rheology,nu_0,nu_inf,lambda,n_index,nu_min,nu_max,Fx,Fy,Fz,NULL);
+	cudaError_t err = cudaGetLastError();
+	if (cudaSuccess != err){
+		printf("CUDA error in ScaLBL_D3Q19_AAodd_NonNewtonianMRT: %s \n",cudaGetErrorString(err));
+	}
+}
+
+extern "C" void ScaLBL_D3Q19_AAodd_NonNewtonianMRT_Stats(int *neighborList, double *dist, double *Viscosity, int start, int finish,
+		int Np, int rheology, double nu_0, double nu_inf, double lambda, double n_index, double nu_min, double nu_max,
+		double Fx, double Fy, double Fz, double *stats){
+	dvc_ScaLBL_AAodd_NonNewtonianMRT<true><<<NBLOCKS,NTHREADS,NTHREADS*sizeof(double)>>>(neighborList,dist,Viscosity,start,finish,Np,rheology,nu_0,nu_inf,lambda,n_index,nu_min,nu_max,Fx,Fy,Fz,stats);
+	cudaError_t err = cudaGetLastError();
+	if (cudaSuccess != err){
+		printf("CUDA error in ScaLBL_D3Q19_AAodd_NonNewtonianMRT_Stats: %s \n",cudaGetErrorString(err));
+	}
+}
@@ -17,10 +17,23 @@
 #include <math.h>
 #include <stdio.h>
 #include "hip/hip_runtime.h"
+#include "common/ColorCombined.hpp"
 
 #define NBLOCKS 1024
 #define NTHREADS 256
 
+// Add the sum of val over the thread block to *sum (temp holds blockDim.x doubles)
+static __device__ void dvc_AccumulateBlockSum(double *temp, double val, double *sum){
+	int lane = threadIdx.x;
+	for (int i = blockDim.x/2; i > 0; i /= 2){
+		temp[lane] = val;
+		__syncthreads();
+		if (lane < i) val += temp[lane+i];
+		__syncthreads();
+	}
+	if (lane == 0) atomicAdd(sum, val);
+}
+
 __global__  void dvc_ScaLBL_Color_Init(char *ID, double *Den, double *Phi, double das, double dbs, int Nx, int Ny, int Nz)
 {
 	//int i,j,k;
@@ -1257,9 +1270,12 @@ __global__  void dvc_ScaLBL_SetSlice_z(double *Phi, double value, int Nx, int Ny
 
 
 
+template<bool STATS>
 __global__  void dvc_ScaLBL_D3Q19_AAeven_Color(int *Map, double *dist, double *Aq, double *Bq, double *Den, double *Phi,
 		double *Velocity, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
-		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np){
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np, double *stats){
+	double sums[14];	// flow statistics (see ScaLBL.h)
+	for (int m=0; m<14; m++) sums[m] = 0.0;
 	int ijk,nn,n;
 	double fq;
 	// conserved momemnts
@@ -1835,14 +1851,37 @@ __global__  void dvc_ScaLBL_D3Q19_AAeven_Color(int *Map, double *dist, double *A
 			Bq[6*Np+n] = b2;
 			//...............................................
 
+			if (STATS){
+				// phase A where phi > 0, as in SubPhase::Basic
+				sums[0] += 1.0;
+				sums[1] += rho;
+				sums[2] += jx;
+				sums[3] += jy;
+				sums[4] += jz;
+				sums[5] += 0.5*rho0*(ux*ux+uy*uy+uz*uz);
+				int p = (phi > 0.0) ? 6 : 10;
+				double rhoP = (phi > 0.0) ? rhoA : rhoB;
+				sums[p] += 1.0;
+				sums[p+1] += rhoP*ux;
+				sums[p+2] += rhoP*uy;
+				sums[p+3] += rhoP*uz;
+			}
 		}
 	}
+	if (STATS){
+		// per-thread partial sums, one atomic add per block
+		extern __shared__ double temp[];
+		for (int m=0; m<14; m++) dvc_AccumulateBlockSum(temp, sums[m], &stats[m]);
+	}
 }
 
 
+template<bool STATS>
 __global__ void dvc_ScaLBL_D3Q19_AAodd_Color(int *neighborList, int *Map, double *dist, double *Aq, double *Bq, double *Den,
 		 double *Phi, double *Velocity, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
-		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np){
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np, double *stats){
+	double sums[14];	// flow statistics (see ScaLBL.h)
+	for (int m=0; m<14; m++) sums[m] = 0.0;
 
 	int n,nn,ijk,nread;
 	int nr1,nr2,nr3,nr4,nr5,nr6;
@@ -2495,6 +2534,59 @@ __global__ void dvc_ScaLBL_D3Q19_AAodd_Color(int *neighborList, int *Map, double
 			Aq[nr5] = a2;
 			Bq[nr5] = b2;
 			//...............................................
+			if (STATS){
+				// phase A where phi > 0, as in SubPhase::Basic
+				sums[0] += 1.0;
+				sums[1] += rho;
+				sums[2] += jx;
+				sums[3] += jy;
+				sums[4] += jz;
+				sums[5] += 0.5*rho0*(ux*ux+uy*uy+uz*uz);
+				int p = (phi > 0.0) ? 6 : 10;
+				double rhoP = (phi > 0.0) ? rhoA : rhoB;
+				sums[p] += 1.0;
+				sums[p+1] += rhoP*ux;
+				sums[p+2] += rhoP*uy;
+				sums[p+3] += rhoP*uz;
+			}
+		}
+	}
+	if (STATS){
+		// per-thread partial sums, one atomic add per block
+		extern __shared__ double temp[];
+		for (int m=0; m<14; m++) dvc_AccumulateBlockSum(temp, sums[m], &stats[m]);
+	}
+}
+
+// Color model collision combined with the phase field update (see common/ColorCombined.hpp)
+__global__  void dvc_ScaLBL_D3Q19_AAeven_Color_Combined(int *Map, double *dist, double *Aq, double *Bq, double *Den, double *Phi, double *PhiOut,
+		double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np){
+	int n;
+	int S = Np/NBLOCKS/NTHREADS + 1;
+	for (int s=0; s<S; s++){
+		//........Get 1-D index for this thread....................
+		n =  S*blockIdx.x*blockDim.x + s*blockDim.x + threadIdx.x + start;
+		if (n<finish) {
+			ScaLBL_AAevenSlot slot = { n, Np };
+			ScaLBL_D3Q19_Color_Combined_Site(n, slot, Map, dist, Aq, Bq, Den, Phi, PhiOut, Vel, rhoA, rhoB, tauA, tauB,
+				alpha, beta, Fx, Fy, Fz, strideY, strideZ, Np);
+		}
+	}
+}
+
+__global__ void dvc_ScaLBL_D3Q19_AAodd_Color_Combined(int *neighborList, int *Map, double *dist, double *Aq, double *Bq, double *Den,
+		 double *Phi, double *PhiOut, double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np){
+	int n;
+	int S = Np/NBLOCKS/NTHREADS + 1;
+	for (int s=0; s<S; s++){
+		//........Get 1-D index for this thread....................
+		n =  S*blockIdx.x*blockDim.x + s*blockDim.x + threadIdx.x + start;
+		if (n<finish) {
+			ScaLBL_AAoddSlot slot = { neighborList, n, Np };
+			ScaLBL_D3Q19_Color_Combined_Site(n, slot, Map, dist, Aq, Bq, Den, Phi, PhiOut, Vel, rhoA, rhoB, tauA, tauB,
+				alpha, beta, Fx, Fy, Fz, strideY, strideZ, Np);
 		}
 	}
 }
@@ -4002,10 +4094,10 @@ extern "C" void ScaLBL_D3Q19_AAeven_Color(int *Map, double *dist, double *Aq, do
 		double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
 		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np){
 
-	hipFuncSetCacheConfig( (void*) dvc_ScaLBL_D3Q19_AAeven_Color, hipFuncCachePreferL1);
+	hipFuncSetCacheConfig( (void*) dvc_ScaLBL_D3Q19_AAeven_Color<false>, hipFuncCachePreferL1);
 
-	dvc_ScaLBL_D3Q19_AAeven_Color<<<NBLOCKS,NTHREADS >>>(Map, dist, Aq, Bq, Den, Phi, Vel, rhoA, rhoB, tauA, tauB, 
-			alpha, beta, Fx, Fy, Fz, strideY, strideZ, start, finish, Np);
+	dvc_ScaLBL_D3Q19_AAeven_Color<false><<<NBLOCKS,NTHREADS>>>(Map, dist, Aq, Bq, Den, Phi, Vel, rhoA, rhoB, tauA, tauB, 
+			alpha, beta, Fx, Fy, Fz, strideY, strideZ, start, finish, Np,NULL);
 	hipError_t err = hipGetLastError();
 	if (hipSuccess != err){
 		printf("CUDA error in ScaLBL_D3Q19_AAeven_Color: %s \n",hipGetErrorString(err));
@@ -4013,14 +4105,29 @@ extern "C" void ScaLBL_D3Q19_AAeven_Color(int *Map, double *dist, double *Aq, do
 
 }
 
+extern "C" void ScaLBL_D3Q19_AAeven_Color_Stats(int *Map, double *dist, double *Aq, double *Bq, double *Den, double *Phi,
+		double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np, double *stats){
+
+	hipFuncSetCacheConfig( (void*) dvc_ScaLBL_D3Q19_AAeven_Color<true>, hipFuncCachePreferL1);
+
+	dvc_ScaLBL_D3Q19_AAeven_Color<true><<<NBLOCKS,NTHREADS,NTHREADS*sizeof(double)>>>(Map, dist, Aq, Bq, Den, Phi, Vel, rhoA, rhoB, tauA, tauB, 
+			alpha, beta, Fx, Fy, Fz, strideY, strideZ, start, finish, Np,stats);
+	hipError_t err = hipGetLastError();
+	if (hipSuccess != err){
+		printf("CUDA error in ScaLBL_D3Q19_AAeven_Color_Stats: %s \n",hipGetErrorString(err));
+	}
+
+}
+
 extern "C" void ScaLBL_D3Q19_AAodd_Color(int *d_neighborList, int *Map, double *dist, double *Aq, double *Bq, double *Den, 
 		double *Phi, double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
 		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np){
 
-	hipFuncSetCacheConfig( (void*) dvc_ScaLBL_D3Q19_AAodd_Color, hipFuncCachePreferL1);
+	hipFuncSetCacheConfig( (void*) dvc_ScaLBL_D3Q19_AAodd_Color<false>, hipFuncCachePreferL1);
 	
-	dvc_ScaLBL_D3Q19_AAodd_Color<<<NBLOCKS,NTHREADS >>>(d_neighborList, Map, dist, Aq, Bq, Den, Phi, Vel, 
-			rhoA, rhoB, tauA, tauB, alpha, beta, Fx, Fy, Fz, strideY, strideZ, start, finish, Np);
+	dvc_ScaLBL_D3Q19_AAodd_Color<false><<<NBLOCKS,NTHREADS>>>(d_neighborList, Map, dist, Aq, Bq, Den, Phi, Vel, 
+			rhoA, rhoB, tauA, tauB, alpha, beta, Fx, Fy, Fz, strideY, strideZ, start, finish, Np,NULL);
 
 	hipError_t err = hipGetLastError();
 	if (hipSuccess != err){
@@ -4029,6 +4136,47 @@ extern "C" void ScaLBL_D3Q19_AAodd_Color(int *d_neighborList, int *Map, double *
 	hipProfilerStop();
 }
 
+extern "C" void ScaLBL_D3Q19_AAodd_Color_Stats(int *d_neighborList, int *Map, double *dist, double *Aq, double *Bq, double *Den, 
+		double *Phi, double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np, double *stats){
+
+	hipFuncSetCacheConfig( (void*) dvc_ScaLBL_D3Q19_AAodd_Color<true>, hipFuncCachePreferL1);
+	
+	dvc_ScaLBL_D3Q19_AAodd_Color<true><<<NBLOCKS,NTHREADS,NTHREADS*sizeof(double)>>>(d_neighborList, Map, dist, Aq, Bq, Den, Phi, Vel, 
+			rhoA, rhoB, tauA, tauB, alpha, beta, Fx, Fy, Fz, strideY, strideZ, start, finish, Np,stats);
+
+	hipError_t err = hipGetLastError();
+	if (hipSuccess != err){
+		printf("CUDA error in ScaLBL_D3Q19_AAodd_Color_Stats: %s \n",hipGetErrorString(err));
+	}
+	hipProfilerStop();
+}
+
+extern "C" void ScaLBL_D3Q19_AAeven_Color_Combined(int *Map, double *dist, double *Aq, double *Bq, double *Den, double *Phi, double *PhiOut,
+		double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np){
+
+	dvc_ScaLBL_D3Q19_AAeven_Color_Combined<<<NBLOCKS,NTHREADS >>>(Map, dist, Aq, Bq, Den, Phi, PhiOut, Vel, rhoA, rhoB, tauA, tauB,
+			alpha, beta, Fx, Fy, Fz, strideY, strideZ, start, finish, Np);
+	hipError_t err = hipGetLastError();
+	if (hipSuccess != err){
+		printf("CUDA error in ScaLBL_D3Q19_AAeven_Color_Combined: %s \n",hipGetErrorString(err));
+	}
+}
+
+extern "C" void ScaLBL_D3Q19_AAodd_Color_Combined(int *d_neighborList, int *Map, double *dist, double *Aq, double *Bq, double *Den,
+		double *Phi, double *PhiOut, double *Vel, double rhoA, double rhoB, double tauA, double tauB, double alpha, double beta,
+		double Fx, double Fy, double Fz, int strideY, int strideZ, int start, int finish, int Np){
+
+	dvc_ScaLBL_D3Q19_AAodd_Color_Combined<<<NBLOCKS,NTHREADS >>>(d_neighborList, Map, dist, Aq, Bq, Den, Phi, PhiOut, Vel,
+			rhoA, rhoB, tauA, tauB, alpha, beta, Fx, Fy, Fz, strideY, strideZ, start, finish, Np);
+	hipError_t err = hipGetLastError();
+	if (hipSuccess != err){
+		printf("CUDA error in ScaLBL_D3Q19_AAodd_Color_Combined: %s \n",hipGetErrorString(err));
+	}
+}
+
+
 extern "C" void ScaLBL_D3Q7_AAodd_PhaseField(int *NeighborList, int *Map, double *Aq, double *Bq, 
 		double *Den, double *Phi, int start, int finish, int Np){
 
@@ -2,6 +2,10 @@
 #include "hip/hip_runtime.h"
 #include <stdio.h>
 
+// memory accounting (common/MemoryReport.cpp)
+extern "C" void ScaLBL_RecordAllocation(void* address, size_t size);
+extern "C" void ScaLBL_RecordFree(void* address);
+
 extern "C" int ScaLBL_SetDevice(int rank){
 	int n_devices; 
 	//int local_rank = atoi(getenv("MV2_COMM_WORLD_LOCAL_RANK"));
@@ -18,10 +22,14 @@ extern "C" void ScaLBL_AllocateDeviceMemory(void** address, size_t size){
 	hipError_t err = hipGetLastError();
 	if (hipSuccess != err){
 		printf("Error in hipMalloc: %s \n",hipGetErrorString(err));
-	}	
+	}
+	else {
+		ScaLBL_RecordAllocation(*address,size);
+	}
 }
 
 extern "C" void ScaLBL_FreeDeviceMemory(void* pointer){
+	ScaLBL_RecordFree(pointer);
        hipFree(pointer);
 }
 
@@ -40,6 +48,9 @@ extern "C" void ScaLBL_AllocateZeroCopy(void** address, size_t size){
 	if (hipSuccess != err){
 		printf("Error in hipMallocHost: %s \n",hipGetErrorString(err));
 	}
+	else {
+		ScaLBL_RecordAllocation(*address,size);
+	}
 }
 
 extern "C" void ScaLBL_CopyToZeroCopy(void* dest, const void* source, size_t size){
@@ -34,10 +34,12 @@ ScaLBL_ColorModel::ScaLBL_ColorModel(int RANK, int NP, const Utilities::MPI& COM
     Nx(0), Ny(0), Nz(0), N(0), Np(0), nprocx(0), nprocy(0), nprocz(0),
     BoundaryCondition(0), Lx(0), Ly(0), Lz(0), id(nullptr),
     NeighborList(nullptr), dvcMap(nullptr), fq(nullptr), Aq(nullptr), Bq(nullptr),
-    Den(nullptr), Phi(nullptr), ColorGrad(nullptr), Velocity(nullptr), Pressure(nullptr),
+    Den(nullptr), Phi(nullptr), PhiNew(nullptr), ColorGrad(nullptr), Velocity(nullptr), Pressure(nullptr),
     comm(COMM)
 {
 	REVERSE_FLOW_DIRECTION = false;
+	COMBINED_KERNEL = false;
+	INCREMENTAL_IMAGE_INIT = false;
 }
 ScaLBL_ColorModel::~ScaLBL_ColorModel()
 {
@@ -49,6 +51,7 @@ ScaLBL_ColorModel::~ScaLBL_ColorModel()
 	ScaLBL_FreeDeviceMemory( Bq );
 	ScaLBL_FreeDeviceMemory( Den );
 	ScaLBL_FreeDeviceMemory( Phi );		
+	ScaLBL_FreeDeviceMemory( PhiNew );
 	ScaLBL_FreeDeviceMemory( Pressure );
 	ScaLBL_FreeDeviceMemory( Velocity );
 	ScaLBL_FreeDeviceMemory( ColorGrad );
@@ -92,7 +95,10 @@ void ScaLBL_ColorModel::ReadCheckpoint(char *FILENAME, double *cPhi, double *cfq
  */
 void ScaLBL_ColorModel::ReadParams(string filename){
 	// read the input database 
-	db = std::make_shared<Database>( filename );
+	ReadParams( std::make_shared<Database>( filename ) );
+}
+void ScaLBL_ColorModel::ReadParams(std::shared_ptr<Database> db0){
+	db = db0;
 	domain_db = db->getDatabase( "Domain" );
 	color_db =  db->getDatabase( "Color" );
 	analysis_db = db->getDatabase( "Analysis" );
@@ -231,6 +237,15 @@ void ScaLBL_ColorModel::ReadParams(string filename){
 		}
 		color_db->putScalar<double>( "flux", flux );
 	} 
+
+	// Combined collision + phase field kernel (the color gradient lags by a half-step, opt-in)
+	COMBINED_KERNEL = color_db->getWithDefault<bool>( "combined_kernel", false );
+	if (COMBINED_KERNEL && BoundaryCondition > 0 && BoundaryCondition < 5){
+		// the inlet/outlet color BCs modify Den between the phase field update and the collision
+		ERROR("ScaLBL_ColorModel: combined_kernel supports only periodic or reflection boundary conditions (BC = 0, 5)");
+	}
+	// Re-initialize only the fluid labels and phase populations when loading the next image
+	INCREMENTAL_IMAGE_INIT = color_db->getWithDefault<bool>( "incremental_image_init", false );
 }
 
 void ScaLBL_ColorModel::SetDomain(){
@@ -273,12 +288,12 @@ void ScaLBL_ColorModel::ReadInput(){
 	}
 	else if (domain_db->keyExists( "GridFile" )){
         // Read the local domain data
-	    auto input_id = readMicroCT( *domain_db, MPI_COMM_WORLD );
+	    auto input_id = readMicroCT( *domain_db, comm );
         // Fill the halo (assuming GCW of 1)
         array<int,3> size0 = { (int) input_id.size(0), (int) input_id.size(1), (int) input_id.size(2) };
         ArraySize size1 = { (size_t) Mask->Nx, (size_t) Mask->Ny, (size_t) Mask->Nz };
         ASSERT( (int) size1[0] == size0[0]+2 && (int) size1[1] == size0[1]+2 && (int) size1[2] == size0[2]+2 );
-        fillHalo<signed char> fill( MPI_COMM_WORLD, Mask->rank_info, size0, { 1, 1, 1 }, 0, 1 );
+        fillHalo<signed char> fill( comm, Mask->rank_info, size0, { 1, 1, 1 }, 0, 1 );
         Array<signed char> id_view;
         id_view.viewRaw( size1, Mask->id.data() );
         fill.copy( input_id, id_view );
@@ -448,16 +463,18 @@ void ScaLBL_ColorModel::Create(){
 	dist_mem_size = Np*sizeof(double);
 	neighborSize=18*(Np*sizeof(int));
 	//...........................................................................
-	ScaLBL_AllocateDeviceMemory((void **) &NeighborList, neighborSize);
-	ScaLBL_AllocateDeviceMemory((void **) &dvcMap, sizeof(int)*Np);
-	ScaLBL_AllocateDeviceMemory((void **) &fq, 19*dist_mem_size);
-	ScaLBL_AllocateDeviceMemory((void **) &Aq, 7*dist_mem_size);
-	ScaLBL_AllocateDeviceMemory((void **) &Bq, 7*dist_mem_size);
-	ScaLBL_AllocateDeviceMemory((void **) &Den, 2*dist_mem_size);
-	ScaLBL_AllocateDeviceMemory((void **) &Phi, sizeof(double)*Nx*Ny*Nz);		
-	ScaLBL_AllocateDeviceMemory((void **) &Pressure, sizeof(double)*Np);
-	ScaLBL_AllocateDeviceMemory((void **) &Velocity, 3*sizeof(double)*Np);
-	ScaLBL_AllocateDeviceMemory((void **) &ColorGrad, 3*sizeof(double)*Np);
+	ScaLBL_AllocateDeviceMemory((void **) &NeighborList, neighborSize, "NeighborList");
+	ScaLBL_AllocateDeviceMemory((void **) &dvcMap, sizeof(int)*Np, "dvcMap");
+	ScaLBL_AllocateDeviceMemory((void **) &fq, 19*dist_mem_size, "fq");
+	ScaLBL_AllocateDeviceMemory((void **) &Aq, 7*dist_mem_size, "Aq");
+	ScaLBL_AllocateDeviceMemory((void **) &Bq, 7*dist_mem_size, "Bq");
+	ScaLBL_AllocateDeviceMemory((void **) &Den, 2*dist_mem_size, "Den");
+	ScaLBL_AllocateDeviceMemory((void **) &Phi, sizeof(double)*Nx*Ny*Nz, "Phi");		
+	if (COMBINED_KERNEL)
+		ScaLBL_AllocateDeviceMemory((void **) &PhiNew, sizeof(double)*Nx*Ny*Nz, "PhiNew");
+	ScaLBL_AllocateDeviceMemory((void **) &Pressure, sizeof(double)*Np, "Pressure");
+	ScaLBL_AllocateDeviceMemory((void **) &Velocity, 3*sizeof(double)*Np, "Velocity");
+	ScaLBL_AllocateDeviceMemory((void **) &ColorGrad, 3*sizeof(double)*Np, "ColorGrad");
 	//...........................................................................
 	// Update GPU data structures
 	if (rank==0)	printf ("Setting up device map and neighbor list \n");
@@ -501,6 +518,7 @@ void ScaLBL_ColorModel::Create(){
 	AssignComponentLabels(PhaseLabel);
 	ScaLBL_CopyToDevice(Phi, PhaseLabel, N*sizeof(double));
     delete [] PhaseLabel;
+	ScaLBL_MemoryReport(comm, "color model");
 }        
 
 /********************************************************
@@ -627,91 +645,17 @@ double ScaLBL_ColorModel::Run(int returntime){
 	}
 	
 	runAnalysis analysis( current_db, rank_info, ScaLBL_Comm, Dm, Np, Regular, Map );
+	if (COMBINED_KERNEL) InitCombined();
 	auto t1 = std::chrono::system_clock::now();
 	int CURRENT_TIMESTEP = 0;
 	int EXIT_TIMESTEP = min(timestepMax,returntime);
 	while (timestep < EXIT_TIMESTEP ) {
 		//if ( rank==0 ) { printf("Running timestep %i (%i MB)\n",timestep+1,(int)(Utilities::getMemoryUsage()/1048576)); }
 		PROFILE_START("Update");
-		// *************ODD TIMESTEP*************
-		timestep++;
-		// Compute the Phase indicator field
-		// Read for Aq, Bq happens in this routine (requires communication)
-		ScaLBL_Comm->BiSendD3Q7AA(Aq,Bq); //READ FROM NORMAL
-		ScaLBL_D3Q7_AAodd_PhaseField(NeighborList, dvcMap, Aq, Bq, Den, Phi, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np);
-		ScaLBL_Comm->BiRecvD3Q7AA(Aq,Bq); //WRITE INTO OPPOSITE
-		ScaLBL_Comm->Barrier();
-		ScaLBL_D3Q7_AAodd_PhaseField(NeighborList, dvcMap, Aq, Bq, Den, Phi, 0, ScaLBL_Comm->LastExterior(), Np);
-
-		// Perform the collision operation
-		ScaLBL_Comm->SendD3Q19AA(fq); //READ FROM NORMAL
-		if (BoundaryCondition > 0 && BoundaryCondition < 5){
-			ScaLBL_Comm->Color_BC_z(dvcMap, Phi, Den, inletA, inletB);
-			ScaLBL_Comm->Color_BC_Z(dvcMap, Phi, Den, outletA, outletB);
-		}
-		// Halo exchange for phase field
-		ScaLBL_Comm_Regular->SendHalo(Phi);
-
-		ScaLBL_D3Q19_AAodd_Color(NeighborList, dvcMap, fq, Aq, Bq, Den, Phi, Velocity, rhoA, rhoB, tauA, tauB,
-				alpha, beta, Fx, Fy, Fz, Nx, Nx*Ny, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np);
-		ScaLBL_Comm_Regular->RecvHalo(Phi);
-		ScaLBL_Comm->RecvD3Q19AA(fq); //WRITE INTO OPPOSITE
-		ScaLBL_Comm->Barrier();
-		// Set BCs
-		if (BoundaryCondition == 3){
-			ScaLBL_Comm->D3Q19_Pressure_BC_z(NeighborList, fq, din, timestep);
-			ScaLBL_Comm->D3Q19_Pressure_BC_Z(NeighborList, fq, dout, timestep);
-		}
-		if (BoundaryCondition == 4){
-			din = ScaLBL_Comm->D3Q19_Flux_BC_z(NeighborList, fq, flux, timestep);
-			ScaLBL_Comm->D3Q19_Pressure_BC_Z(NeighborList, fq, dout, timestep);
-		}
-		else if (BoundaryCondition == 5){
-			ScaLBL_Comm->D3Q19_Reflection_BC_z(fq);
-			ScaLBL_Comm->D3Q19_Reflection_BC_Z(fq);
-		}
-		ScaLBL_D3Q19_AAodd_Color(NeighborList, dvcMap, fq, Aq, Bq, Den, Phi, Velocity, rhoA, rhoB, tauA, tauB,
-				alpha, beta, Fx, Fy, Fz, Nx, Nx*Ny, 0, ScaLBL_Comm->LastExterior(), Np);
-		ScaLBL_Comm->Barrier(); 
-
-		// *************EVEN TIMESTEP*************
-		timestep++;
-		// Compute the Phase indicator field
-		ScaLBL_Comm->BiSendD3Q7AA(Aq,Bq); //READ FROM NORMAL
-		ScaLBL_D3Q7_AAeven_PhaseField(dvcMap, Aq, Bq, Den, Phi, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np);
-		ScaLBL_Comm->BiRecvD3Q7AA(Aq,Bq); //WRITE INTO OPPOSITE
-		ScaLBL_Comm->Barrier();
-		ScaLBL_D3Q7_AAeven_PhaseField(dvcMap, Aq, Bq, Den, Phi, 0, ScaLBL_Comm->LastExterior(), Np);
-
-		// Perform the collision operation
-		ScaLBL_Comm->SendD3Q19AA(fq); //READ FORM NORMAL
-		// Halo exchange for phase field
-		if (BoundaryCondition > 0 && BoundaryCondition < 5){
-			ScaLBL_Comm->Color_BC_z(dvcMap, Phi, Den, inletA, inletB);
-			ScaLBL_Comm->Color_BC_Z(dvcMap, Phi, Den, outletA, outletB);
-		}
-		ScaLBL_Comm_Regular->SendHalo(Phi);
-		ScaLBL_D3Q19_AAeven_Color(dvcMap, fq, Aq, Bq, Den, Phi, Velocity, rhoA, rhoB, tauA, tauB,
-				alpha, beta, Fx, Fy, Fz,  Nx, Nx*Ny, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np);
-		ScaLBL_Comm_Regular->RecvHalo(Phi);
-		ScaLBL_Comm->RecvD3Q19AA(fq); //WRITE INTO OPPOSITE
-		ScaLBL_Comm->Barrier();
-		// Set boundary conditions
-		if (BoundaryCondition == 3){
-			ScaLBL_Comm->D3Q19_Pressure_BC_z(NeighborList, fq, din, timestep);
-			ScaLBL_Comm->D3Q19_Pressure_BC_Z(NeighborList, fq, dout, timestep);
-		}
-		else if (BoundaryCondition == 4){
-			din = ScaLBL_Comm->D3Q19_Flux_BC_z(NeighborList, fq, flux, timestep);
-			ScaLBL_Comm->D3Q19_Pressure_BC_Z(NeighborList, fq, dout, timestep);
-		}
-		else if (BoundaryCondition == 5){
-			ScaLBL_Comm->D3Q19_Reflection_BC_z(fq);
-			ScaLBL_Comm->D3Q19_Reflection_BC_Z(fq);
-		}
-		ScaLBL_D3Q19_AAeven_Color(dvcMap, fq, Aq, Bq, Den, Phi, Velocity, rhoA, rhoB, tauA, tauB,
-				alpha, beta, Fx, Fy, Fz, Nx, Nx*Ny, 0, ScaLBL_Comm->LastExterior(), Np);
-		ScaLBL_Comm->Barrier(); 
+		if (COMBINED_KERNEL)
+			UpdateCombined();
+		else
+			Update();
 		//************************************************************************
 		analysis.basic(timestep, current_db, *Averages, Phi, Pressure, Velocity, fq, Den );		// allow initial ramp-up to get closer to steady state
 
@@ -931,6 +875,145 @@ double ScaLBL_ColorModel::Run(int returntime){
 
 }
 
+void ScaLBL_ColorModel::Update(){
+	// *************ODD TIMESTEP*************
+	timestep++;
+	// Compute the Phase indicator field
+	// Read for Aq, Bq happens in this routine (requires communication)
+	ScaLBL_Comm->BiSendD3Q7AA(Aq,Bq); //READ FROM NORMAL
+	ScaLBL_D3Q7_AAodd_PhaseField(NeighborList, dvcMap, Aq, Bq, Den, Phi, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np);
+	ScaLBL_Comm->BiRecvD3Q7AA(Aq,Bq); //WRITE INTO OPPOSITE
+	ScaLBL_Comm->Barrier();
+	ScaLBL_D3Q7_AAodd_PhaseField(NeighborList, dvcMap, Aq, Bq, Den, Phi, 0, ScaLBL_Comm->LastExterior(), Np);
+
+	// Perform the collision operation
+	ScaLBL_Comm->SendD3Q19AA(fq); //READ FROM NORMAL
+	if (BoundaryCondition > 0 && BoundaryCondition < 5){
+		ScaLBL_Comm->Color_BC_z(dvcMap, Phi, Den, inletA, inletB);
+		ScaLBL_Comm->Color_BC_Z(dvcMap, Phi, Den, outletA, outletB);
+	}
+	// Halo exchange for phase field
+	ScaLBL_Comm_Regular->SendHalo(Phi);
+
+	ScaLBL_D3Q19_AAodd_Color(NeighborList, dvcMap, fq, Aq, Bq, Den, Phi, Velocity, rhoA, rhoB, tauA, tauB,
+			alpha, beta, Fx, Fy, Fz, Nx, Nx*Ny, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np);
+	ScaLBL_Comm_Regular->RecvHalo(Phi);
+	ScaLBL_Comm->RecvD3Q19AA(fq); //WRITE INTO OPPOSITE
+	ScaLBL_Comm->Barrier();
+	// Set BCs
+	if (BoundaryCondition == 3){
+		ScaLBL_Comm->D3Q19_Pressure_BC_z(NeighborList, fq, din, timestep);
+		ScaLBL_Comm->D3Q19_Pressure_BC_Z(NeighborList, fq, dout, timestep);
+	}
+	if (BoundaryCondition == 4){
+		din = ScaLBL_Comm->D3Q19_Flux_BC_z(NeighborList, fq, flux, timestep);
+		ScaLBL_Comm->D3Q19_Pressure_BC_Z(NeighborList, fq, dout, timestep);
+	}
+	else if (BoundaryCondition == 5){
+		ScaLBL_Comm->D3Q19_Reflection_BC_z(fq);
+		ScaLBL_Comm->D3Q19_Reflection_BC_Z(fq);
+	}
+	ScaLBL_D3Q19_AAodd_Color(NeighborList, dvcMap, fq, Aq, Bq, Den, Phi, Velocity, rhoA, rhoB, tauA, tauB,
+			alpha, beta, Fx, Fy, Fz, Nx, Nx*Ny, 0, ScaLBL_Comm->LastExterior(), Np);
+	ScaLBL_Comm->Barrier(); 
+
+	// *************EVEN TIMESTEP*************
+	timestep++;
+	// Compute the Phase indicator field
+	ScaLBL_Comm->BiSendD3Q7AA(Aq,Bq); //READ FROM NORMAL
+	ScaLBL_D3Q7_AAeven_PhaseField(dvcMap, Aq, Bq, Den, Phi, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np);
+	ScaLBL_Comm->BiRecvD3Q7AA(Aq,Bq); //WRITE INTO OPPOSITE
+	ScaLBL_Comm->Barrier();
+	ScaLBL_D3Q7_AAeven_PhaseField(dvcMap, Aq, Bq, Den, Phi, 0, ScaLBL_Comm->LastExterior(), Np);
+
+	// Perform the collision operation
+	ScaLBL_Comm->SendD3Q19AA(fq); //READ FORM NORMAL
+	// Halo exchange for phase field
+	if (BoundaryCondition > 0 && BoundaryCondition < 5){
+		ScaLBL_Comm->Color_BC_z(dvcMap, Phi, Den, inletA, inletB);
+		ScaLBL_Comm->Color_BC_Z(dvcMap, Phi, Den, outletA, outletB);
+	}
+	ScaLBL_Comm_Regular->SendHalo(Phi);
+	ScaLBL_D3Q19_AAeven_Color(dvcMap, fq, Aq, Bq, Den, Phi, Velocity, rhoA, rhoB, tauA, tauB,
+			alpha, beta, Fx, Fy, Fz,  Nx, Nx*Ny, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np);
+	ScaLBL_Comm_Regular->RecvHalo(Phi);
+	ScaLBL_Comm->RecvD3Q19AA(fq); //WRITE INTO OPPOSITE
+	ScaLBL_Comm->Barrier();
+	// Set boundary conditions
+	if (BoundaryCondition == 3){
+		ScaLBL_Comm->D3Q19_Pressure_BC_z(NeighborList, fq, din, timestep);
+		ScaLBL_Comm->D3Q19_Pressure_BC_Z(NeighborList, fq, dout, timestep);
+	}
+	else if (BoundaryCondition == 4){
+		din = ScaLBL_Comm->D3Q19_Flux_BC_z(NeighborList, fq, flux, timestep);
+		ScaLBL_Comm->D3Q19_Pressure_BC_Z(NeighborList, fq, dout, timestep);
+	}
+	else if (BoundaryCondition == 5){
+		ScaLBL_Comm->D3Q19_Reflection_BC_z(fq);
+		ScaLBL_Comm->D3Q19_Reflection_BC_Z(fq);
+	}
+	ScaLBL_D3Q19_AAeven_Color(dvcMap, fq, Aq, Bq, Den, Phi, Velocity, rhoA, rhoB, tauA, tauB,
+			alpha, beta, Fx, Fy, Fz, Nx, Nx*Ny, 0, ScaLBL_Comm->LastExterior(), Np);
+	ScaLBL_Comm->Barrier(); 
+}
+
+/*
+ * Same as Update(), but the D3Q7 phase field kernel is folded into the collision kernel.
+ * The color gradient is computed from the phase field of the previous half-step and the
+ * new phase field is written to the second buffer (PhiNew), then the buffers are swapped.
+ */
+void ScaLBL_ColorModel::UpdateCombined(){
+	// *************ODD TIMESTEP*************
+	timestep++;
+	// Aq, Bq are streamed inside the collision kernel, so the D3Q7 exchange has to complete first
+	ScaLBL_Comm->BiSendD3Q7AA(Aq,Bq); //READ FROM NORMAL
+	ScaLBL_Comm->BiRecvD3Q7AA(Aq,Bq); //WRITE INTO OPPOSITE
+	ScaLBL_Comm->SendD3Q19AA(fq); //READ FROM NORMAL
+	// Halo exchange for phase field (from the previous half-step)
+	ScaLBL_Comm_Regular->SendHalo(Phi);
+	ScaLBL_D3Q19_AAodd_Color_Combined(NeighborList, dvcMap, fq, Aq, Bq, Den, Phi, PhiNew, Velocity, rhoA, rhoB, tauA, tauB,
+			alpha, beta, Fx, Fy, Fz, Nx, Nx*Ny, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np);
+	ScaLBL_Comm_Regular->RecvHalo(Phi);
+	ScaLBL_Comm->RecvD3Q19AA(fq); //WRITE INTO OPPOSITE
+	ScaLBL_Comm->Barrier();
+	if (BoundaryCondition == 5){
+		ScaLBL_Comm->D3Q19_Reflection_BC_z(fq);
+		ScaLBL_Comm->D3Q19_Reflection_BC_Z(fq);
+	}
+	ScaLBL_D3Q19_AAodd_Color_Combined(NeighborList, dvcMap, fq, Aq, Bq, Den, Phi, PhiNew, Velocity, rhoA, rhoB, tauA, tauB,
+			alpha, beta, Fx, Fy, Fz, Nx, Nx*Ny, 0, ScaLBL_Comm->LastExterior(), Np);
+	ScaLBL_Comm->Barrier();
+	std::swap(Phi,PhiNew);
+
+	// *************EVEN TIMESTEP*************
+	timestep++;
+	ScaLBL_Comm->BiSendD3Q7AA(Aq,Bq); //READ FROM NORMAL
+	ScaLBL_Comm->BiRecvD3Q7AA(Aq,Bq); //WRITE INTO OPPOSITE
+	ScaLBL_Comm->SendD3Q19AA(fq); //READ FORM NORMAL
+	ScaLBL_Comm_Regular->SendHalo(Phi);
+	ScaLBL_D3Q19_AAeven_Color_Combined(dvcMap, fq, Aq, Bq, Den, Phi, PhiNew, Velocity, rhoA, rhoB, tauA, tauB,
+			alpha, beta, Fx, Fy, Fz, Nx, Nx*Ny, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np);
+	ScaLBL_Comm_Regular->RecvHalo(Phi);
+	ScaLBL_Comm->RecvD3Q19AA(fq); //WRITE INTO OPPOSITE
+	ScaLBL_Comm->Barrier();
+	if (BoundaryCondition == 5){
+		ScaLBL_Comm->D3Q19_Reflection_BC_z(fq);
+		ScaLBL_Comm->D3Q19_Reflection_BC_Z(fq);
+	}
+	ScaLBL_D3Q19_AAeven_Color_Combined(dvcMap, fq, Aq, Bq, Den, Phi, PhiNew, Velocity, rhoA, rhoB, tauA, tauB,
+			alpha, beta, Fx, Fy, Fz, Nx, Nx*Ny, 0, ScaLBL_Comm->LastExterior(), Np);
+	ScaLBL_Comm->Barrier();
+	std::swap(Phi,PhiNew);
+}
+
+void ScaLBL_ColorModel::InitCombined(){
+	// both phase field buffers need the solid (component label) values
+	double *cPhi = new double[N];
+	ScaLBL_CopyToHost(cPhi, Phi, N*sizeof(double));
+	ScaLBL_CopyToDevice(PhiNew, cPhi, N*sizeof(double));
+	delete [] cPhi;
+}
+
 void ScaLBL_ColorModel::Run(){
 	int nprocs=nprocx*nprocy*nprocz;
 	const RankInfoStruct rank_info(rank,nprocx,nprocy,nprocz);
@@ -1140,89 +1223,16 @@ void ScaLBL_ColorModel::Run(){
 	auto current_db = db->cloneDatabase();
 	runAnalysis analysis( current_db, rank_info, ScaLBL_Comm, Dm, Np, Regular, Map );
 	//analysis.createThreads( analysis_method, 4 );
+	ScaLBL_MemoryReport(comm, "color model and analysis");
+	if (COMBINED_KERNEL) InitCombined();
     auto t1 = std::chrono::system_clock::now();
 	while (timestep < timestepMax ) {
 		//if ( rank==0 ) { printf("Running timestep %i (%i MB)\n",timestep+1,(int)(Utilities::getMemoryUsage()/1048576)); }
 		PROFILE_START("Update");
-		// *************ODD TIMESTEP*************
-		timestep++;
-		// Compute the Phase indicator field
-		// Read for Aq, Bq happens in this routine (requires communication)
-		ScaLBL_Comm->BiSendD3Q7AA(Aq,Bq); //READ FROM NORMAL
-		ScaLBL_D3Q7_AAodd_PhaseField(NeighborList, dvcMap, Aq, Bq, Den, Phi, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np);
-		ScaLBL_Comm->BiRecvD3Q7AA(Aq,Bq); //WRITE INTO OPPOSITE
-		ScaLBL_Comm->Barrier();
-		ScaLBL_D3Q7_AAodd_PhaseField(NeighborList, dvcMap, Aq, Bq, Den, Phi, 0, ScaLBL_Comm->LastExterior(), Np);
-
-		// Perform the collision operation
-		ScaLBL_Comm->SendD3Q19AA(fq); //READ FROM NORMAL
-		if (BoundaryCondition > 0 && BoundaryCondition < 5){
-			ScaLBL_Comm->Color_BC_z(dvcMap, Phi, Den, inletA, inletB);
-			ScaLBL_Comm->Color_BC_Z(dvcMap, Phi, Den, outletA, outletB);
-		}
-		// Halo exchange for phase field
-		ScaLBL_Comm_Regular->SendHalo(Phi);
-
-		ScaLBL_D3Q19_AAodd_Color(NeighborList, dvcMap, fq, Aq, Bq, Den, Phi, Velocity, rhoA, rhoB, tauA, tauB,
-				alpha, beta, Fx, Fy, Fz, Nx, Nx*Ny, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np);
-		ScaLBL_Comm_Regular->RecvHalo(Phi);
-		ScaLBL_Comm->RecvD3Q19AA(fq); //WRITE INTO OPPOSITE
-		ScaLBL_Comm->Barrier();
-		// Set BCs
-		if (BoundaryCondition == 3){
-			ScaLBL_Comm->D3Q19_Pressure_BC_z(NeighborList, fq, din, timestep);
-			ScaLBL_Comm->D3Q19_Pressure_BC_Z(NeighborList, fq, dout, timestep);
-		}
-		if (BoundaryCondition == 4){
-			din = ScaLBL_Comm->D3Q19_Flux_BC_z(NeighborList, fq, flux, timestep);
-			ScaLBL_Comm->D3Q19_Pressure_BC_Z(NeighborList, fq, dout, timestep);
-		}
-		else if (BoundaryCondition == 5){
-			ScaLBL_Comm->D3Q19_Reflection_BC_z(fq);
-			ScaLBL_Comm->D3Q19_Reflection_BC_Z(fq);
-		}
-		ScaLBL_D3Q19_AAodd_Color(NeighborList, dvcMap, fq, Aq, Bq, Den, Phi, Velocity, rhoA, rhoB, tauA, tauB,
-				alpha, beta, Fx, Fy, Fz, Nx, Nx*Ny, 0, ScaLBL_Comm->LastExterior(), Np);
-		ScaLBL_Comm->Barrier(); 
-
-		// *************EVEN TIMESTEP*************
-		timestep++;
-		// Compute the Phase indicator field
-		ScaLBL_Comm->BiSendD3Q7AA(Aq,Bq); //READ FROM NORMAL
-		ScaLBL_D3Q7_AAeven_PhaseField(dvcMap, Aq, Bq, Den, Phi, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np);
-		ScaLBL_Comm->BiRecvD3Q7AA(Aq,Bq); //WRITE INTO OPPOSITE
-		ScaLBL_Comm->Barrier();
-		ScaLBL_D3Q7_AAeven_PhaseField(dvcMap, Aq, Bq, Den, Phi, 0, ScaLBL_Comm->LastExterior(), Np);
-
-		// Perform the collision operation
-		ScaLBL_Comm->SendD3Q19AA(fq); //READ FORM NORMAL
-		// Halo exchange for phase field
-		if (BoundaryCondition > 0 && BoundaryCondition < 5){
-			ScaLBL_Comm->Color_BC_z(dvcMap, Phi, Den, inletA, inletB);
-			ScaLBL_Comm->Color_BC_Z(dvcMap, Phi, Den, outletA, outletB);
-		}
-		ScaLBL_Comm_Regular->SendHalo(Phi);
-		ScaLBL_D3Q19_AAeven_Color(dvcMap, fq, Aq, Bq, Den, Phi, Velocity, rhoA, rhoB, tauA, tauB,
-				alpha, beta, Fx, Fy, Fz,  Nx, Nx*Ny, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np);
-		ScaLBL_Comm_Regular->RecvHalo(Phi);
-		ScaLBL_Comm->RecvD3Q19AA(fq); //WRITE INTO OPPOSITE
-		ScaLBL_Comm->Barrier();
-		// Set boundary conditions
-		if (BoundaryCondition == 3){
-			ScaLBL_Comm->D3Q19_Pressure_BC_z(NeighborList, fq, din, timestep);
-			ScaLBL_Comm->D3Q19_Pressure_BC_Z(NeighborList, fq, dout, timestep);
-		}
-		else if (BoundaryCondition == 4){
-			din = ScaLBL_Comm->D3Q19_Flux_BC_z(NeighborList, fq, flux, timestep);
-			ScaLBL_Comm->D3Q19_Pressure_BC_Z(NeighborList, fq, dout, timestep);
-		}
-		else if (BoundaryCondition == 5){
-			ScaLBL_Comm->D3Q19_Reflection_BC_z(fq);
-			ScaLBL_Comm->D3Q19_Reflection_BC_Z(fq);
-		}
-		ScaLBL_D3Q19_AAeven_Color(dvcMap, fq, Aq, Bq, Den, Phi, Velocity, rhoA, rhoB, tauA, tauB,
-				alpha, beta, Fx, Fy, Fz, Nx, Nx*Ny, 0, ScaLBL_Comm->LastExterior(), Np);
-		ScaLBL_Comm->Barrier(); 
+		if (COMBINED_KERNEL)
+			UpdateCombined();
+		else
+			Update();
 		//************************************************************************
 		PROFILE_STOP("Update");
 
@@ -1493,7 +1503,23 @@ void ScaLBL_ColorModel::Run(){
 double ScaLBL_ColorModel::ImageInit(std::string Filename){
 	
 	if (rank==0) printf("Re-initializing fluids from file: %s \n", Filename.c_str());
-	Mask->Decomp(Filename);
+	if (INCREMENTAL_IMAGE_INIT){
+		// The solid (and therefore Map / NeighborList) must be the same for every image in
+		// the sequence, so each rank only reads its own labels
+		Mask->ReadSubdomain(Filename);
+		double changed = 0.0;
+		for (int i=0; i<Nx*Ny*Nz; i++){
+			if ( (Mask->id[i] > 0) != (id[i] > 0) ) changed++;
+		}
+		changed = Dm->Comm.sumReduce( changed );
+		if (changed > 0.0){
+			if (rank==0) printf("   solid differs from the previous image at %.0f sites \n", changed);
+			ERROR("ImageInit: incremental_image_init requires the same solid for every image in the sequence");
+		}
+	}
+	else {
+		Mask->Decomp(Filename);
+	}
 	for (int i=0; i<Nx*Ny*Nz; i++) id[i] = Mask->id[i];  // save what was read
 	for (int i=0; i<Nx*Ny*Nz; i++) Dm->id[i] = Mask->id[i];  // save what was read
 
@@ -1523,8 +1549,10 @@ double ScaLBL_ColorModel::ImageInit(std::string Filename){
 	if (rank==0) printf("   new saturation: %f (%f / %f) \n", Count / PoreCount, Count, PoreCount);
 	ScaLBL_CopyToDevice(Phi, PhaseLabel, Nx*Ny*Nz*sizeof(double));
 	comm.barrier();
+	delete [] PhaseLabel;
 	
-	ScaLBL_D3Q19_Init(fq, Np);
+	// the incremental path keeps the flow field and only resets the phase populations
+	if (!INCREMENTAL_IMAGE_INIT) ScaLBL_D3Q19_Init(fq, Np);
 	ScaLBL_PhaseField_Init(dvcMap, Phi, Den, Aq, Bq, 0, ScaLBL_Comm->LastExterior(), Np);
 	ScaLBL_PhaseField_Init(dvcMap, Phi, Den, Aq, Bq, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np);
 	comm.barrier();
@@ -2063,49 +2091,7 @@ FlowAdaptor::~FlowAdaptor(){
 }
 
 double FlowAdaptor::ImageInit(ScaLBL_ColorModel &M, std::string Filename){
-	int rank = M.rank;
-	int Nx = M.Nx;  int Ny = M.Ny;  int Nz = M.Nz;
-	if (rank==0) printf("Re-initializing fluids from file: %s \n", Filename.c_str());
-	M.Mask->Decomp(Filename);
-	for (int i=0; i<Nx*Ny*Nz; i++) M.id[i] = M.Mask->id[i];  // save what was read
-	for (int i=0; i<Nx*Ny*Nz; i++) M.Dm->id[i] = M.Mask->id[i];  // save what was read
-
-	double *PhaseLabel;
-	PhaseLabel = new double[Nx*Ny*Nz];
-	M.AssignComponentLabels(PhaseLabel);
-
-	double Count = 0.0;
-	double PoreCount = 0.0;
-	for (int k=1; k<Nz-1; k++){
-		for (int j=1; j<Ny-1; j++){
-			for (int i=1; i<Nx-1; i++){
-				if (M.id[Nx*Ny*k+Nx*j+i] == 2){
-					PoreCount++;
-					Count++;
-				}
-				else if (M.id[Nx*Ny*k+Nx*j+i] == 1){
-					PoreCount++;						
-				}
-			}
-		}
-	}
-
-	Count=M.Dm->Comm.sumReduce(  Count);
-	PoreCount=M.Dm->Comm.sumReduce(  PoreCount);
-	
-	if (rank==0) printf("   new saturation: %f (%f / %f) \n", Count / PoreCount, Count, PoreCount);
-	ScaLBL_CopyToDevice(M.Phi, PhaseLabel, Nx*Ny*Nz*sizeof(double));
-	M.Dm->Comm.barrier();
-	
-	ScaLBL_D3Q19_Init(M.fq, M.Np);
-	ScaLBL_PhaseField_Init(M.dvcMap, M.Phi, M.Den, M.Aq, M.Bq, 0, M.ScaLBL_Comm->LastExterior(), M.Np);
-	ScaLBL_PhaseField_Init(M.dvcMap, M.Phi, M.Den, M.Aq, M.Bq, M.ScaLBL_Comm->FirstInterior(), M.ScaLBL_Comm->LastInterior(), M.Np);
-	M.Dm->Comm.barrier();
-	
-	ScaLBL_CopyToHost(M.Averages->Phi.data(),M.Phi,Nx*Ny*Nz*sizeof(double));
-
-	double saturation = Count/PoreCount;
-	return saturation;
+	return M.ImageInit(Filename);
 }
 
 
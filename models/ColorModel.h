@@ -55,6 +55,8 @@ public:
 	
 	bool Restart,pBC;
 	bool REVERSE_FLOW_DIRECTION;
+	bool COMBINED_KERNEL; // fold the phase field update into the collision kernel
+	bool INCREMENTAL_IMAGE_INIT; // ImageInit reads labels per rank and keeps fq
 	int timestep,timestepMax;
 	int BoundaryCondition;
 	double tauA,tauB,rhoA,rhoB,alpha,beta;
@@ -85,11 +87,13 @@ public:
 	int *dvcMap;
 	double *fq, *Aq, *Bq;
 	double *Den, *Phi;
+	double *PhiNew; // second phase field buffer used by the combined kernel
 	double *ColorGrad;
 	double *Velocity;
 	double *Pressure;
 
 	void AssignComponentLabels(double *phase);
+	double ImageInit(std::string filename);
 		
 private:
 	Utilities::MPI comm;
@@ -103,7 +107,9 @@ private:
    
     //int rank,nprocs;
     void LoadParams(std::shared_ptr<Database> db0);
-    double ImageInit(std::string filename);
+    void Update();
+    void UpdateCombined();
+    void InitCombined();
     double MorphInit(const double beta, const double morph_delta);
     double SeedPhaseField(const double seed_water_in_oil);
     double MorphOpenConnected(double target_volume_change);
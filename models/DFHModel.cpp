@@ -224,17 +224,17 @@ void ScaLBL_DFHModel::Create(){
 	neighborSize=18*(Np*sizeof(int));
 
 	//...........................................................................
-	ScaLBL_AllocateDeviceMemory((void **) &NeighborList, neighborSize);
-	ScaLBL_AllocateDeviceMemory((void **) &dvcMap, sizeof(int)*Np);
-	ScaLBL_AllocateDeviceMemory((void **) &fq, 19*dist_mem_size);
-	ScaLBL_AllocateDeviceMemory((void **) &Aq, 7*dist_mem_size);
-	ScaLBL_AllocateDeviceMemory((void **) &Bq, 7*dist_mem_size);
-	ScaLBL_AllocateDeviceMemory((void **) &Den, 2*dist_mem_size);
-	ScaLBL_AllocateDeviceMemory((void **) &Phi, sizeof(double)*Np);        
-	ScaLBL_AllocateDeviceMemory((void **) &Pressure, sizeof(double)*Np);
-	ScaLBL_AllocateDeviceMemory((void **) &Velocity, 3*sizeof(double)*Np);
-	ScaLBL_AllocateDeviceMemory((void **) &Gradient, 3*sizeof(double)*Np);
-	ScaLBL_AllocateDeviceMemory((void **) &SolidPotential, 3*sizeof(double)*Np);
+	ScaLBL_AllocateDeviceMemory((void **) &NeighborList, neighborSize, "NeighborList");
+	ScaLBL_AllocateDeviceMemory((void **) &dvcMap, sizeof(int)*Np, "dvcMap");
+	ScaLBL_AllocateDeviceMemory((void **) &fq, 19*dist_mem_size, "fq");
+	ScaLBL_AllocateDeviceMemory((void **) &Aq, 7*dist_mem_size, "Aq");
+	ScaLBL_AllocateDeviceMemory((void **) &Bq, 7*dist_mem_size, "Bq");
+	ScaLBL_AllocateDeviceMemory((void **) &Den, 2*dist_mem_size, "Den");
+	ScaLBL_AllocateDeviceMemory((void **) &Phi, sizeof(double)*Np, "Phi");        
+	ScaLBL_AllocateDeviceMemory((void **) &Pressure, sizeof(double)*Np, "Pressure");
+	ScaLBL_AllocateDeviceMemory((void **) &Velocity, 3*sizeof(double)*Np, "Velocity");
+	ScaLBL_AllocateDeviceMemory((void **) &Gradient, 3*sizeof(double)*Np, "Gradient");
+	ScaLBL_AllocateDeviceMemory((void **) &SolidPotential, 3*sizeof(double)*Np, "SolidPotential");
 
 	//...........................................................................
 	// Update GPU data structures
@@ -256,6 +256,7 @@ void ScaLBL_DFHModel::Create(){
 	ScaLBL_CopyToDevice(dvcMap, TmpMap, sizeof(int)*Np);
 	ScaLBL_DeviceBarrier();
 	delete [] TmpMap;
+	ScaLBL_MemoryReport(comm, "DFH model");
 }        
 
 /********************************************************
@@ -301,16 +301,16 @@ void ScaLBL_FreeLeeModel::Create_TwoFluid(){
 	dist_mem_size = Np*sizeof(double);
 	neighborSize=18*(Np*sizeof(int));
 	//...........................................................................
-	ScaLBL_AllocateDeviceMemory((void **) &NeighborList, neighborSize);
-	ScaLBL_AllocateDeviceMemory((void **) &dvcMap, sizeof(int)*Np);
-	ScaLBL_AllocateDeviceMemory((void **) &gqbar, 19*dist_mem_size);
-	ScaLBL_AllocateDeviceMemory((void **) &hq, 7*dist_mem_size);
-	ScaLBL_AllocateDeviceMemory((void **) &mu_phi, dist_mem_size);
-	ScaLBL_AllocateDeviceMemory((void **) &Den, dist_mem_size);
-	ScaLBL_AllocateDeviceMemory((void **) &Phi, sizeof(double)*Nh);		
-	ScaLBL_AllocateDeviceMemory((void **) &Pressure, sizeof(double)*Np);
-	ScaLBL_AllocateDeviceMemory((void **) &Velocity, 3*sizeof(double)*Np);
-	ScaLBL_AllocateDeviceMemory((void **) &ColorGrad, 3*sizeof(double)*Np);
+	ScaLBL_AllocateDeviceMemory((void **) &NeighborList, neighborSize, "NeighborList");
+	ScaLBL_AllocateDeviceMemory((void **) &dvcMap, sizeof(int)*Np, "dvcMap");
+	ScaLBL_AllocateDeviceMemory((void **) &gqbar, 19*dist_mem_size, "gqbar");
+	ScaLBL_AllocateDeviceMemory((void **) &hq, 7*dist_mem_size, "hq");
+	ScaLBL_AllocateDeviceMemory((void **) &mu_phi, dist_mem_size, "mu_phi");
+	ScaLBL_AllocateDeviceMemory((void **) &Den, dist_mem_size, "Den");
+	ScaLBL_AllocateDeviceMemory((void **) &Phi, sizeof(double)*Nh, "Phi");		
+	ScaLBL_AllocateDeviceMemory((void **) &Pressure, sizeof(double)*Np, "Pressure");
+	ScaLBL_AllocateDeviceMemory((void **) &Velocity, 3*sizeof(double)*Np, "Velocity");
+	ScaLBL_AllocateDeviceMemory((void **) &ColorGrad, 3*sizeof(double)*Np, "ColorGrad");
 	//...........................................................................
 	// Update GPU data structures
 	if (rank==0)	printf ("Setting up device map and neighbor list \n");
@@ -348,6 +348,7 @@ void ScaLBL_FreeLeeModel::Create_TwoFluid(){
 	comm.barrier();
 	delete [] TmpMap;
 	delete [] neighborList;
+	ScaLBL_MemoryReport(comm, "free energy Lee model");
 }        
 
 void ScaLBL_FreeLeeModel::Create_SingleFluid(){
@@ -382,10 +383,10 @@ void ScaLBL_FreeLeeModel::Create_SingleFluid(){
 	dist_mem_size = Np*sizeof(double);
 	neighborSize=18*(Np*sizeof(int));
 	//...........................................................................
-	ScaLBL_AllocateDeviceMemory((void **) &NeighborList, neighborSize);
-	ScaLBL_AllocateDeviceMemory((void **) &gqbar, 19*dist_mem_size);
-	ScaLBL_AllocateDeviceMemory((void **) &Pressure, sizeof(double)*Np);
-	ScaLBL_AllocateDeviceMemory((void **) &Velocity, 3*sizeof(double)*Np);
+	ScaLBL_AllocateDeviceMemory((void **) &NeighborList, neighborSize, "NeighborList");
+	ScaLBL_AllocateDeviceMemory((void **) &gqbar, 19*dist_mem_size, "gqbar");
+	ScaLBL_AllocateDeviceMemory((void **) &Pressure, sizeof(double)*Np, "Pressure");
+	ScaLBL_AllocateDeviceMemory((void **) &Velocity, 3*sizeof(double)*Np, "Velocity");
 	//...........................................................................
 	// Update GPU data structures
 	if (rank==0)	printf ("Setting up device map and neighbor list \n");
@@ -393,6 +394,7 @@ void ScaLBL_FreeLeeModel::Create_SingleFluid(){
 	ScaLBL_CopyToDevice(NeighborList, neighborList, neighborSize);
 	comm.barrier();
 	delete [] neighborList;
+	ScaLBL_MemoryReport(comm, "free energy Lee model");
 }        
 
 void ScaLBL_FreeLeeModel::AssignComponentLabels_ChemPotential_ColorGrad()
@@ -1148,15 +1150,15 @@ void ScaLBL_FreeLeeModel::Create_DummyPhase_MGTest(){
 	neighborSize=18*(Np*sizeof(int));
 	//...........................................................................
 	//ScaLBL_AllocateDeviceMemory((void **) &NeighborList, neighborSize);
-	ScaLBL_AllocateDeviceMemory((void **) &dvcMap, sizeof(int)*Np);
+	ScaLBL_AllocateDeviceMemory((void **) &dvcMap, sizeof(int)*Np, "dvcMap");
 	//ScaLBL_AllocateDeviceMemory((void **) &gqbar, 19*dist_mem_size);
 	//ScaLBL_AllocateDeviceMemory((void **) &hq, 7*dist_mem_size);
 	//ScaLBL_AllocateDeviceMemory((void **) &mu_phi, dist_mem_size);
 	//ScaLBL_AllocateDeviceMemory((void **) &Den, dist_mem_size);
-	ScaLBL_AllocateDeviceMemory((void **) &Phi, sizeof(double)*Nh);		
+	ScaLBL_AllocateDeviceMemory((void **) &Phi, sizeof(double)*Nh, "Phi");		
 	//ScaLBL_AllocateDeviceMemory((void **) &Pressure, sizeof(double)*Np);
 	//ScaLBL_AllocateDeviceMemory((void **) &Velocity, 3*sizeof(double)*Np);
-	ScaLBL_AllocateDeviceMemory((void **) &ColorGrad, 3*sizeof(double)*Np);
+	ScaLBL_AllocateDeviceMemory((void **) &ColorGrad, 3*sizeof(double)*Np, "ColorGrad");
 	//...........................................................................
 	// Update GPU data structures
 	if (rank==0)	printf ("Setting up device map and neighbor list \n");
@@ -625,26 +625,26 @@ void ScaLBL_GreyscaleColorModel::Create(){
 	dist_mem_size = Np*sizeof(double);
 	neighborSize=18*(Np*sizeof(int));
 	//...........................................................................
-	ScaLBL_AllocateDeviceMemory((void **) &NeighborList, neighborSize);
-	ScaLBL_AllocateDeviceMemory((void **) &dvcMap, sizeof(int)*Np);
-	ScaLBL_AllocateDeviceMemory((void **) &fq, 19*dist_mem_size);
-	ScaLBL_AllocateDeviceMemory((void **) &Aq, 7*dist_mem_size);
-	ScaLBL_AllocateDeviceMemory((void **) &Bq, 7*dist_mem_size);
-	ScaLBL_AllocateDeviceMemory((void **) &Den, 2*dist_mem_size);
-	ScaLBL_AllocateDeviceMemory((void **) &Phi, sizeof(double)*Nx*Ny*Nz);		
+	ScaLBL_AllocateDeviceMemory((void **) &NeighborList, neighborSize, "NeighborList");
+	ScaLBL_AllocateDeviceMemory((void **) &dvcMap, sizeof(int)*Np, "dvcMap");
+	ScaLBL_AllocateDeviceMemory((void **) &fq, 19*dist_mem_size, "fq");
+	ScaLBL_AllocateDeviceMemory((void **) &Aq, 7*dist_mem_size, "Aq");
+	ScaLBL_AllocateDeviceMemory((void **) &Bq, 7*dist_mem_size, "Bq");
+	ScaLBL_AllocateDeviceMemory((void **) &Den, 2*dist_mem_size, "Den");
+	ScaLBL_AllocateDeviceMemory((void **) &Phi, sizeof(double)*Nx*Ny*Nz, "Phi");		
 	//ScaLBL_AllocateDeviceMemory((void **) &Psi, sizeof(double)*Nx*Ny*Nz);//greyscale potential		
-	ScaLBL_AllocateDeviceMemory((void **) &Pressure, sizeof(double)*Np);
-	ScaLBL_AllocateDeviceMemory((void **) &Velocity, 3*sizeof(double)*Np);
+	ScaLBL_AllocateDeviceMemory((void **) &Pressure, sizeof(double)*Np, "Pressure");
+	ScaLBL_AllocateDeviceMemory((void **) &Velocity, 3*sizeof(double)*Np, "Velocity");
 	//ScaLBL_AllocateDeviceMemory((void **) &ColorGrad, 3*sizeof(double)*Np);
     //ScaLBL_AllocateDeviceMemory((void **) &GreySolidPhi, sizeof(double)*Nx*Ny*Nz);		
     //ScaLBL_AllocateDeviceMemory((void **) &GreySolidGrad, 3*sizeof(double)*Np);		
-    ScaLBL_AllocateDeviceMemory((void **) &GreySolidW, sizeof(double)*Np);		
-    ScaLBL_AllocateDeviceMemory((void **) &GreySn, sizeof(double)*Np);		
-    ScaLBL_AllocateDeviceMemory((void **) &GreySw, sizeof(double)*Np);	
-    ScaLBL_AllocateDeviceMemory((void **) &GreyKn, sizeof(double)*Np);		
-    ScaLBL_AllocateDeviceMemory((void **) &GreyKw, sizeof(double)*Np);	
-    ScaLBL_AllocateDeviceMemory((void **) &Porosity_dvc, sizeof(double)*Np);
-    ScaLBL_AllocateDeviceMemory((void **) &Permeability_dvc, sizeof(double)*Np);
+    ScaLBL_AllocateDeviceMemory((void **) &GreySolidW, sizeof(double)*Np, "GreySolidW");		
+    ScaLBL_AllocateDeviceMemory((void **) &GreySn, sizeof(double)*Np, "GreySn");		
+    ScaLBL_AllocateDeviceMemory((void **) &GreySw, sizeof(double)*Np, "GreySw");	
+    ScaLBL_AllocateDeviceMemory((void **) &GreyKn, sizeof(double)*Np, "GreyKn");		
+    ScaLBL_AllocateDeviceMemory((void **) &GreyKw, sizeof(double)*Np, "GreyKw");	
+    ScaLBL_AllocateDeviceMemory((void **) &Porosity_dvc, sizeof(double)*Np, "Porosity_dvc");
+    ScaLBL_AllocateDeviceMemory((void **) &Permeability_dvc, sizeof(double)*Np, "Permeability_dvc");
 	//...........................................................................
 	// Update GPU data structures
 	if (rank==0)	printf ("Setting up device map and neighbor list \n");
@@ -689,6 +689,7 @@ void ScaLBL_GreyscaleColorModel::Create(){
     //AssignGreyscalePotential(); 
 	Averages->SetParams(rhoA,rhoB,tauA,tauB,Fx,Fy,Fz,alpha,beta,GreyPorosity);
 	ScaLBL_Comm->RegularLayout(Map,Porosity_dvc,Averages->Porosity);//porosity doesn't change over time
+	ScaLBL_MemoryReport(comm, "greyscale color model");
 }        
 
 void ScaLBL_GreyscaleColorModel::Initialize(){
@@ -42,7 +42,10 @@ ScaLBL_GreyscaleModel::~ScaLBL_GreyscaleModel(){
 
 void ScaLBL_GreyscaleModel::ReadParams(string filename){
 	// read the input database 
-	db = std::make_shared<Database>( filename );
+	ReadParams( std::make_shared<Database>( filename ) );
+}
+void ScaLBL_GreyscaleModel::ReadParams(std::shared_ptr<Database> db0){
+	db = db0;
 	domain_db = db->getDatabase( "Domain" );
 	greyscale_db =  db->getDatabase( "Greyscale" );
 	analysis_db = db->getDatabase( "Analysis" );
@@ -60,6 +63,7 @@ void ScaLBL_GreyscaleModel::ReadParams(string filename){
 	flux=0.0;
     dp = 10.0; //unit of 'dp': voxel
     CollisionType = 1; //1: IMRT; 2: BGK; 3: MRT
+    SplitOpenSites = true;
 	
 	// ---------------------- Greyscale Model parameters -----------------------//
 	if (greyscale_db->keyExists( "timestepMax" )){
@@ -95,6 +99,7 @@ void ScaLBL_GreyscaleModel::ReadParams(string filename){
 	if (greyscale_db->keyExists( "tolerance" )){
 		tolerance = greyscale_db->getScalar<double>( "tolerance" );
 	}
+	SplitOpenSites = greyscale_db->getWithDefault<bool>( "split_open_sites", true );
 	auto collision = greyscale_db->getWithDefault<std::string>( "collision", "IMRT" );
 	if (collision == "BGK"){
         CollisionType=2;
@@ -235,13 +240,12 @@ void ScaLBL_GreyscaleModel::AssignComponentLabels(double *Porosity, double *Perm
 						//Mask->id[n] = 0; // set mask to zero since this is an immobile component
 					}
 				}
-				int idx = Map(i,j,k);
-				if (!(idx < 0)){
+				if (IsSite(i,j,k)){
                     if (POROSITY<=0.0){
                         ERROR("Error: Porosity for grey voxels must be 0.0 < Porosity <= 1.0 !\n");
                     }
                     else{
-					    Porosity[idx] = POROSITY;
+					    Porosity[n] = POROSITY;
                     }
                 }
 			}
@@ -265,13 +269,12 @@ void ScaLBL_GreyscaleModel::AssignComponentLabels(double *Porosity, double *Perm
 						//Mask->id[n] = 0; // set mask to zero since this is an immobile component
 					}
 				}
-				int idx = Map(i,j,k);
-				if (!(idx < 0)){
+				if (IsSite(i,j,k)){
                     if (PERMEABILITY<=0.0){
                         ERROR("Error: Permeability for grey voxel must be > 0.0 ! \n");
                     }
                     else{
-					    Permeability[idx] = PERMEABILITY/Dm->voxel_length/Dm->voxel_length;
+					    Permeability[n] = PERMEABILITY/Dm->voxel_length/Dm->voxel_length;
                     }
                 }
 			}
@@ -308,9 +311,6 @@ void ScaLBL_GreyscaleModel::AssignComponentLabels(double *Porosity, double *Perm
 
 void ScaLBL_GreyscaleModel::AssignComponentLabels(double *Porosity,double *Permeability,const vector<std::string> &File_poro,const vector<std::string> &File_perm)
 {
-    double *Porosity_host, *Permeability_host;
-    Porosity_host = new double[N];
-    Permeability_host = new double[N];
 	double POROSITY=0.f;
 	double PERMEABILITY=0.f;
     //Initialize a weighted porosity after considering grey voxels
@@ -319,17 +319,16 @@ void ScaLBL_GreyscaleModel::AssignComponentLabels(double *Porosity,double *Perme
     //double label_count_loc = 0.0;
     //double label_count_glb = 0.0;
 
-    Mask->ReadFromFile(File_poro[0],File_poro[1],Porosity_host);
-    Mask->ReadFromFile(File_perm[0],File_perm[1],Permeability_host);
+    Mask->ReadFromFile(File_poro[0],File_poro[1],Porosity);
+    Mask->ReadFromFile(File_perm[0],File_perm[1],Permeability);
 
 	for (int k=0;k<Nz;k++){
 		for (int j=0;j<Ny;j++){
 			for (int i=0;i<Nx;i++){
-				int idx = Map(i,j,k);
-				if (!(idx < 0)){
+				if (IsSite(i,j,k)){
 				    int n = k*Nx*Ny+j*Nx+i;
-                    POROSITY = Porosity_host[n];
-                    PERMEABILITY = Permeability_host[n];
+                    POROSITY = Porosity[n];
+                    PERMEABILITY = Permeability[n];
                     if (POROSITY<=0.0){
                         ERROR("Error: Porosity for grey voxels must be 0.0 < Porosity <= 1.0 !\n");
                     }
@@ -337,8 +336,6 @@ void ScaLBL_GreyscaleModel::AssignComponentLabels(double *Porosity,double *Perme
                         ERROR("Error: Permeability for grey voxel must be > 0.0 ! \n");
                     }
                     else{
-                        Porosity[idx] = POROSITY;
-                        Permeability[idx] = PERMEABILITY;
                         GreyPorosity_loc += POROSITY;
                         //label_count_loc += 1.0;
                     }
@@ -353,8 +350,6 @@ void ScaLBL_GreyscaleModel::AssignComponentLabels(double *Porosity,double *Perme
         printf("Image resolution: %.5g [um/voxel]\n",Dm->voxel_length);
         printf("The weighted porosity, considering both open and grey voxels, is %.3g\n",GreyPorosity);
 	}
-    delete [] Porosity_host;
-    delete [] Permeability_host;
 }
 
 void ScaLBL_GreyscaleModel::Create(){
@@ -377,12 +372,46 @@ void ScaLBL_GreyscaleModel::Create(){
 	// ScaLBL_Communicator ScaLBL_Comm(Mask); // original
 	ScaLBL_Comm  = std::shared_ptr<ScaLBL_Communicator>(new ScaLBL_Communicator(Mask));
 
+	// porosity and permeability of each voxel (regular layout)
+	double *Poros, *Perm;
+	Poros = new double[N];
+	Perm  = new double[N];
+	for (int n=0; n<N; n++){
+		Poros[n] = 1.0;
+		Perm[n] = 1.0;
+	}
+    if (greyscale_db->keyExists("FileVoxelPorosityMap")){
+        //NOTE: FileVoxel**Map is a vector, including "file_name, datatype"
+		auto File_poro = greyscale_db->getVector<std::string>( "FileVoxelPorosityMap" );
+		auto File_perm = greyscale_db->getVector<std::string>( "FileVoxelPermeabilityMap" );
+	    AssignComponentLabels(Poros,Perm,File_poro,File_perm);
+    }
+    else if (greyscale_db->keyExists("PorosityList")){
+        //initialize voxel porosity and perm from the input list
+	    AssignComponentLabels(Poros,Perm);
+    }
+    else {
+		ERROR("Error: PorosityList or FilenameVoxelPorosityMap cannot be found! \n");
+    }
+	// open voxels (porosity 1) are stored before the grey voxels so that the
+	// drag terms are only evaluated on the grey part of each range
+	// (split_open_sites = false: every site is treated as grey)
+	std::vector<signed char> grey(N,1);
+	for (int n=0; n<N; n++){
+		if (SplitOpenSites && Poros[n] == 1.0) grey[n] = 0;
+	}
+
 	int Npad=(Np/16 + 2)*16;
 	if (rank==0)    printf ("Set up memory efficient layout, %i | %i | %i \n", Np, Npad, N);
 	Map.resize(Nx,Ny,Nz);       Map.fill(-2);
 	auto neighborList= new int[18*Npad];
-	Np = ScaLBL_Comm->MemoryOptimizedLayoutAA(Map,neighborList,Mask->id.data(),Np,1);
+	Np = ScaLBL_Comm->MemoryOptimizedLayoutAA(Map,neighborList,Mask->id.data(),Np,1,grey.data());
 	comm.barrier();
+	double open_count = (ScaLBL_Comm->ExteriorSplit() + ScaLBL_Comm->InteriorSplit() - ScaLBL_Comm->FirstInterior());
+	double site_count = (ScaLBL_Comm->LastExterior() + ScaLBL_Comm->LastInterior() - ScaLBL_Comm->FirstInterior());
+	open_count = comm.sumReduce( open_count );
+	site_count = comm.sumReduce( site_count );
+	if (rank==0)    printf ("Open (porosity = 1) sites: %.0f of %.0f \n", open_count, site_count);
 
 	//...........................................................................
 	//                MAIN  VARIABLES ALLOCATED HERE
@@ -393,39 +422,41 @@ void ScaLBL_GreyscaleModel::Create(){
 	dist_mem_size = Np*sizeof(double);
 	neighborSize=18*(Np*sizeof(int));
 	//...........................................................................
-	ScaLBL_AllocateDeviceMemory((void **) &NeighborList, neighborSize);
-	ScaLBL_AllocateDeviceMemory((void **) &fq, 19*dist_mem_size);
-	ScaLBL_AllocateDeviceMemory((void **) &Permeability, sizeof(double)*Np);		
-	ScaLBL_AllocateDeviceMemory((void **) &Porosity, sizeof(double)*Np);		
-	ScaLBL_AllocateDeviceMemory((void **) &Pressure_dvc, sizeof(double)*Np);
-	ScaLBL_AllocateDeviceMemory((void **) &Velocity, 3*sizeof(double)*Np);
+	ScaLBL_AllocateDeviceMemory((void **) &NeighborList, neighborSize, "NeighborList");
+	ScaLBL_AllocateDeviceMemory((void **) &fq, 19*dist_mem_size, "fq");
+	ScaLBL_AllocateDeviceMemory((void **) &Permeability, sizeof(double)*Np, "Permeability");		
+	ScaLBL_AllocateDeviceMemory((void **) &Porosity, sizeof(double)*Np, "Porosity");		
+	ScaLBL_AllocateDeviceMemory((void **) &Pressure_dvc, sizeof(double)*Np, "Pressure_dvc");
+	ScaLBL_AllocateDeviceMemory((void **) &Velocity, 3*sizeof(double)*Np, "Velocity");
 	//...........................................................................
 	// Update GPU data structures
 	if (rank==0)	printf ("Setting up device neighbor list \n");
 	fflush(stdout);
 	// copy the neighbor list 
 	ScaLBL_CopyToDevice(NeighborList, neighborList, neighborSize);
-	// initialize phi based on PhaseLabel (include solid component labels)
-	double *Poros, *Perm;
-	Poros = new double[Np];
-	Perm  = new double[Np];
-    if (greyscale_db->keyExists("FileVoxelPorosityMap")){
-        //NOTE: FileVoxel**Map is a vector, including "file_name, datatype"
-		auto File_poro = greyscale_db->getVector<std::string>( "FileVoxelPorosityMap" );
-		auto File_perm = greyscale_db->getVector<std::string>( "FileVoxelPermeabilityMap" );
-	    AssignComponentLabels(Poros,Perm,File_poro,File_perm);
-    }
-    else if (greyscale_db->keyExists("PorosityList")){
-        //initialize voxel porosity and perm from the input list
-	    AssignComponentLabels(Poros,Perm);
-    }
-    else {
-		ERROR("Error: PorosityList or FilenameVoxelPorosityMap cannot be found! \n");
-    }
-	ScaLBL_CopyToDevice(Porosity, Poros, Np*sizeof(double));
-	ScaLBL_CopyToDevice(Permeability, Perm, Np*sizeof(double));
+	delete [] neighborList;
+	// porosity and permeability in the sparse layout
+	double *Poros_sparse, *Perm_sparse;
+	Poros_sparse = new double[Np];
+	Perm_sparse  = new double[Np];
+	for (int n=0; n<Np; n++){
+		Poros_sparse[n] = 1.0;
+		Perm_sparse[n] = 1.0;
+	}
+	for (int n=0; n<N; n++){
+		int idx = Map(n);
+		if (!(idx < 0)){
+			Poros_sparse[idx] = Poros[n];
+			Perm_sparse[idx] = Perm[n];
+		}
+	}
+	ScaLBL_CopyToDevice(Porosity, Poros_sparse, Np*sizeof(double));
+	ScaLBL_CopyToDevice(Permeability, Perm_sparse, Np*sizeof(double));
     delete [] Poros;
     delete [] Perm;
+    delete [] Poros_sparse;
+    delete [] Perm_sparse;
+    ScaLBL_MemoryReport(comm, "greyscale model");
 }        
 
 
@@ -478,6 +509,53 @@ void ScaLBL_GreyscaleModel::Initialize(){
 	}
 }
 
+void ScaLBL_GreyscaleModel::CollideOdd(int start, int split, int finish){
+	double rlx = 1.0/tau;
+	double rlx_eff = 1.0/tau_eff;
+	// open sites [start,split) use the kernels without porosity / permeability (Poros = NULL)
+	for (int part=0; part<2; part++){
+		int first = (part == 0) ? start : split;
+		int last = (part == 0) ? split : finish;
+		double *Poros = (part == 0) ? NULL : Porosity;
+		double *Perm = (part == 0) ? NULL : Permeability;
+		if (first == last) continue;
+        switch (CollisionType){
+            case 2: 
+                    ScaLBL_D3Q19_AAodd_Greyscale(NeighborList, fq, first, last, Np, rlx, rlx_eff, Fx, Fy, Fz,Poros,Perm,Velocity,Pressure_dvc);
+                    break;
+            case 3: 
+                    ScaLBL_D3Q19_AAodd_Greyscale_MRT(NeighborList, fq, first, last, Np, rlx, rlx_eff, Fx, Fy, Fz,Poros,Perm,Velocity,Den,Pressure_dvc);
+                    break;
+            default: 
+                    ScaLBL_D3Q19_AAodd_Greyscale_IMRT(NeighborList, fq, first, last, Np, rlx, rlx_eff, Fx, Fy, Fz,Poros,Perm,Velocity,Den,Pressure_dvc);
+                    break;
+        }
+	}
+}
+
+void ScaLBL_GreyscaleModel::CollideEven(int start, int split, int finish){
+	double rlx = 1.0/tau;
+	double rlx_eff = 1.0/tau_eff;
+	for (int part=0; part<2; part++){
+		int first = (part == 0) ? start : split;
+		int last = (part == 0) ? split : finish;
+		double *Poros = (part == 0) ? NULL : Porosity;
+		double *Perm = (part == 0) ? NULL : Permeability;
+		if (first == last) continue;
+        switch (CollisionType){
+            case 2: 
+                    ScaLBL_D3Q19_AAeven_Greyscale(fq, first, last, Np, rlx, rlx_eff, Fx, Fy, Fz,Poros,Perm,Velocity,Pressure_dvc);
+                    break;
+            case 3: 
+                    ScaLBL_D3Q19_AAeven_Greyscale_MRT(fq, first, last, Np, rlx, rlx_eff, Fx, Fy, Fz,Poros,Perm,Velocity,Den,Pressure_dvc);
+                    break;
+            default: 
+                    ScaLBL_D3Q19_AAeven_Greyscale_IMRT(fq, first, last, Np, rlx, rlx_eff, Fx, Fy, Fz,Poros,Perm,Velocity,Den,Pressure_dvc);
+                    break;
+        }
+	}
+}
+
 void ScaLBL_GreyscaleModel::Run(){
 	int nprocs=nprocx*nprocy*nprocz;
 	const RankInfoStruct rank_info(rank,nprocx,nprocy,nprocz);
@@ -514,8 +592,6 @@ void ScaLBL_GreyscaleModel::Run(){
 	//************ MAIN ITERATION LOOP ***************************************/
 	PROFILE_START("Loop");
 	auto current_db = db->cloneDatabase();
-	double rlx = 1.0/tau;
-    double rlx_eff = 1.0/tau_eff;
 	double error = 1.0;
 	double flow_rate_previous = 0.0;
     auto t1 = std::chrono::system_clock::now();
@@ -524,20 +600,7 @@ void ScaLBL_GreyscaleModel::Run(){
 		// *************ODD TIMESTEP*************//
 		timestep++;
 		ScaLBL_Comm->SendD3Q19AA(fq); //READ FROM NORMAL
-        switch (CollisionType){
-            case 1: 
-                    ScaLBL_D3Q19_AAodd_Greyscale_IMRT(NeighborList, fq,  ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np, rlx, rlx_eff, Fx, Fy, Fz,Porosity,Permeability,Velocity,Den,Pressure_dvc);
-                    break;
-            case 2: 
-                    ScaLBL_D3Q19_AAodd_Greyscale(NeighborList, fq,  ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np, rlx, rlx_eff, Fx, Fy, Fz,Porosity,Permeability,Velocity,Pressure_dvc);
-                    break;
-            case 3: 
-                    ScaLBL_D3Q19_AAodd_Greyscale_MRT(NeighborList, fq,  ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np, rlx, rlx_eff, Fx, Fy, Fz,Porosity,Permeability,Velocity,Den,Pressure_dvc);
-                    break;
-            default: 
-                    ScaLBL_D3Q19_AAodd_Greyscale_IMRT(NeighborList, fq,  ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np, rlx, rlx_eff, Fx, Fy, Fz,Porosity,Permeability,Velocity,Den,Pressure_dvc);
-                    break;
-        }
+		CollideOdd(ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->InteriorSplit(), ScaLBL_Comm->LastInterior());
 		ScaLBL_Comm->RecvD3Q19AA(fq); //WRITE INTO OPPOSITE
 		ScaLBL_DeviceBarrier();
 		// Set BCs
@@ -545,61 +608,22 @@ void ScaLBL_GreyscaleModel::Run(){
 			ScaLBL_Comm->D3Q19_Pressure_BC_z(NeighborList, fq, din, timestep);
 			ScaLBL_Comm->D3Q19_Pressure_BC_Z(NeighborList, fq, dout, timestep);
 		}
-        switch (CollisionType){
-            case 1: 
-		            ScaLBL_D3Q19_AAodd_Greyscale_IMRT(NeighborList, fq, 0, ScaLBL_Comm->LastExterior(), Np, rlx, rlx_eff, Fx, Fy, Fz,Porosity,Permeability,Velocity,Den,Pressure_dvc);
-                    break;
-            case 2: 
-		            ScaLBL_D3Q19_AAodd_Greyscale(NeighborList, fq, 0, ScaLBL_Comm->LastExterior(), Np, rlx, rlx_eff, Fx, Fy, Fz,Porosity,Permeability,Velocity,Pressure_dvc);
-                    break;
-            case 3: 
-		            ScaLBL_D3Q19_AAodd_Greyscale_MRT(NeighborList, fq, 0, ScaLBL_Comm->LastExterior(), Np, rlx, rlx_eff, Fx, Fy, Fz,Porosity,Permeability,Velocity,Den,Pressure_dvc);
-                    break;
-            default: 
-		            ScaLBL_D3Q19_AAodd_Greyscale_IMRT(NeighborList, fq, 0, ScaLBL_Comm->LastExterior(), Np, rlx, rlx_eff, Fx, Fy, Fz,Porosity,Permeability,Velocity,Den,Pressure_dvc);
-                    break;
-        }
+		CollideOdd(0, ScaLBL_Comm->ExteriorSplit(), ScaLBL_Comm->LastExterior());
 		ScaLBL_DeviceBarrier(); comm.barrier();
 
 		// *************EVEN TIMESTEP*************//
 		timestep++;
 		ScaLBL_Comm->SendD3Q19AA(fq); //READ FORM NORMAL
-        switch (CollisionType){
-            case 1: 
-		            ScaLBL_D3Q19_AAeven_Greyscale_IMRT(fq, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np, rlx, rlx_eff, Fx, Fy, Fz,Porosity,Permeability,Velocity,Den,Pressure_dvc);
-                    break;
-            case 2: 
-		            ScaLBL_D3Q19_AAeven_Greyscale(fq, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np, rlx, rlx_eff, Fx, Fy, Fz,Porosity,Permeability,Velocity,Pressure_dvc);
-                    break;
-            case 3: 
-		            ScaLBL_D3Q19_AAeven_Greyscale_MRT(fq, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np, rlx, rlx_eff, Fx, Fy, Fz,Porosity,Permeability,Velocity,Den,Pressure_dvc);
-                    break;
-            default: 
-		            ScaLBL_D3Q19_AAeven_Greyscale_IMRT(fq, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np, rlx, rlx_eff, Fx, Fy, Fz,Porosity,Permeability,Velocity,Den,Pressure_dvc);
-                    break;
-        }
-        ScaLBL_Comm->RecvD3Q19AA(fq); //WRITE INTO OPPOSITE
+		CollideEven(ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->InteriorSplit(), ScaLBL_Comm->LastInterior());
+		ScaLBL_Comm->RecvD3Q19AA(fq); //WRITE INTO OPPOSITE
 		ScaLBL_DeviceBarrier();
 		// Set BCs
 		if (BoundaryCondition == 3){
 			ScaLBL_Comm->D3Q19_Pressure_BC_z(NeighborList, fq, din, timestep);
 			ScaLBL_Comm->D3Q19_Pressure_BC_Z(NeighborList, fq, dout, timestep);
 		}
-        switch (CollisionType){
-            case 1: 
-		            ScaLBL_D3Q19_AAeven_Greyscale_IMRT(fq, 0, ScaLBL_Comm->LastExterior(), Np, rlx, rlx_eff, Fx, Fy, Fz,Porosity,Permeability,Velocity,Den,Pressure_dvc);
-                    break;
-            case 2: 
-		            ScaLBL_D3Q19_AAeven_Greyscale(fq, 0, ScaLBL_Comm->LastExterior(), Np, rlx, rlx_eff, Fx, Fy, Fz,Porosity,Permeability,Velocity,Pressure_dvc);
-                    break;
-            case 3: 
-		            ScaLBL_D3Q19_AAeven_Greyscale_MRT(fq, 0, ScaLBL_Comm->LastExterior(), Np, rlx, rlx_eff, Fx, Fy, Fz,Porosity,Permeability,Velocity,Den,Pressure_dvc);
-                    break;
-            default: 
-		            ScaLBL_D3Q19_AAeven_Greyscale_IMRT(fq, 0, ScaLBL_Comm->LastExterior(), Np, rlx, rlx_eff, Fx, Fy, Fz,Porosity,Permeability,Velocity,Den,Pressure_dvc);
-                    break;
-        }
-        ScaLBL_DeviceBarrier(); comm.barrier();
+		CollideEven(0, ScaLBL_Comm->ExteriorSplit(), ScaLBL_Comm->LastExterior());
+		ScaLBL_DeviceBarrier(); comm.barrier();
 		//************************************************************************/
 		
 		if (timestep%analysis_interval==0){
@@ -668,10 +692,16 @@ void ScaLBL_GreyscaleModel::Run(){
 					}
 				}
 			}
-	    vax  = Dm->Comm.sumReduce(  vax_loc);
-	    vay  = Dm->Comm.sumReduce(  vay_loc);
-	    vaz  = Dm->Comm.sumReduce(  vaz_loc);
-	    count  = Dm->Comm.sumReduce(  count_loc);
+			// the velocity sums complete while the Minkowski functionals are computed
+			Utilities::MPI::Accumulator sums( Dm->Comm );
+			sums.sum( vax, vax_loc );
+			sums.sum( vay, vay_loc );
+			sums.sum( vaz, vaz_loc );
+			sums.sum( count, count_loc );
+			sums.start();
+			//if (rank==0) printf("Computing Minkowski functionals \n");
+			Morphology.ComputeScalar(SignDist,0.f);
+			sums.finish();
 
 			vax /= count;
 			vay /= count;
@@ -694,18 +724,12 @@ void ScaLBL_GreyscaleModel::Run(){
 			error = fabs(flow_rate - flow_rate_previous) / fabs(flow_rate);
 			flow_rate_previous = flow_rate;
 			
-			//if (rank==0) printf("Computing Minkowski functionals \n");
-			Morphology.ComputeScalar(SignDist,0.f);
 			//Morphology.PrintAll();
 			double mu = (tau-0.5)/3.f;
-			double Vs = Morphology.V();
-			double As = Morphology.A();
-			double Hs = Morphology.H();
-			double Xs = Morphology.X();
-			Vs = Dm->Comm.sumReduce(  Vs);
-			As = Dm->Comm.sumReduce(  As);
-			Hs = Dm->Comm.sumReduce(  Hs);
-			Xs = Dm->Comm.sumReduce(  Xs);
+			double Vs = Morphology.Vi_global;
+			double As = Morphology.Ai_global;
+			double Hs = Morphology.Ji_global;
+			double Xs = Morphology.Xi_global;
 
 			double h = Dm->voxel_length;
 			//double absperm = h*h*mu*Mask->Porosity()*flow_rate / force_mag;
@@ -51,6 +51,7 @@ public:
 	int timestep,timestepMax;
 	int BoundaryCondition;
     int CollisionType;
+    bool SplitOpenSites;	// run the open (porosity 1) sites with the drag-free kernels
 	double tau;
     double tau_eff;
     double Den;//constant density
@@ -100,7 +101,15 @@ private:
     char LocalRankFilename[40];
     char LocalRestartFile[40];
    
+    // porosity and permeability are set in the regular layout
     void AssignComponentLabels(double *Porosity, double *Permeablity);
     void AssignComponentLabels(double *Porosity,double *Permeability,const vector<std::string> &File_poro,const vector<std::string> &File_perm);
+    // voxel (i,j,k) is a lattice site (interior of the subdomain and not solid)
+    bool IsSite(int i, int j, int k) const {
+        return i>0 && j>0 && k>0 && i<Nx-1 && j<Ny-1 && k<Nz-1 && Mask->id[k*Nx*Ny+j*Nx+i] > 0;
+    }
+    // collision on [start,finish): open sites (porosity 1) in [start,split), grey sites in [split,finish)
+    void CollideOdd(int start, int split, int finish);
+    void CollideEven(int start, int split, int finish);
 };
 
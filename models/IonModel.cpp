@@ -468,9 +468,35 @@ void ScaLBL_IonModel::ReadParams(string filename){
 	}
 }
 
+void ScaLBL_IonModel::AttachLattice(std::shared_ptr<ScaLBL_LatticeTopology> lattice){
+	Lattice = lattice;
+}
+
 void ScaLBL_IonModel::SetDomain(){
-	Dm  = std::shared_ptr<Domain>(new Domain(domain_db,comm));      // full domain for analysis
-	Mask  = std::shared_ptr<Domain>(new Domain(domain_db,comm));    // mask domain removes immobile phases
+    int BoundaryCondition = 0;
+    unsigned short int BC_inlet_min  = *min_element(BoundaryConditionInlet.begin(),BoundaryConditionInlet.end());
+    unsigned short int BC_outlet_min = *min_element(BoundaryConditionOutlet.begin(),BoundaryConditionOutlet.end());
+    if (BC_inlet_min==0 && BC_outlet_min==0){
+        BoundaryCondition = 0;
+    }
+    else if (BC_inlet_min>0 && BC_outlet_min>0){
+        BoundaryCondition = 1;
+    }
+    else { //i.e. periodic and non-periodic BCs are mixed
+        ERROR("Error: check the type of inlet and outlet boundary condition! Mixed periodic and non-periodic BCs are found. \n");
+    }
+	if (Lattice && !Lattice->Compatible(domain_db,BoundaryCondition)){
+		if (rank==0) printf("LB Ion Solver: domain or boundary condition differs from the shared lattice \n");
+		Lattice.reset();
+	}
+	if (Lattice){
+		Dm = Lattice->Dm;
+		Mask = Lattice->Mask;
+	}
+	else {
+		Dm  = std::shared_ptr<Domain>(new Domain(domain_db,comm));      // full domain for analysis
+		Mask  = std::shared_ptr<Domain>(new Domain(domain_db,comm));    // mask domain removes immobile phases
+	}
 
 	// domain parameters
 	Nx = Dm->Nx;
@@ -481,27 +507,16 @@ void ScaLBL_IonModel::SetDomain(){
 	Lz = Dm->Lz;
 	
 	N = Nx*Ny*Nz;
-	Distance.resize(Nx,Ny,Nz);
 	
-	for (int i=0; i<Nx*Ny*Nz; i++) Dm->id[i] = 1;               // initialize this way
-	//Averages = std::shared_ptr<TwoPhase> ( new TwoPhase(Dm) ); // TwoPhase analysis object
-	comm.barrier();
-    
-    unsigned short int BC_inlet_min  = *min_element(BoundaryConditionInlet.begin(),BoundaryConditionInlet.end());
-    unsigned short int BC_outlet_min = *min_element(BoundaryConditionOutlet.begin(),BoundaryConditionOutlet.end());
-    if (BC_inlet_min==0 && BC_outlet_min==0){
-        Dm->BoundaryCondition   = 0;
-        Mask->BoundaryCondition = 0;
-    }
-    else if (BC_inlet_min>0 && BC_outlet_min>0){
-        Dm->BoundaryCondition   = 1;
-        Mask->BoundaryCondition = 1;
-    }
-    else { //i.e. periodic and non-periodic BCs are mixed
-        ERROR("Error: check the type of inlet and outlet boundary condition! Mixed periodic and non-periodic BCs are found. \n");
-    }
-    
-	Dm->CommInit();
+	if (!Lattice){
+		Distance.resize(Nx,Ny,Nz);
+		for (int i=0; i<Nx*Ny*Nz; i++) Dm->id[i] = 1;               // initialize this way
+		//Averages = std::shared_ptr<TwoPhase> ( new TwoPhase(Dm) ); // TwoPhase analysis object
+		comm.barrier();
+		Dm->BoundaryCondition   = BoundaryCondition;
+		Mask->BoundaryCondition = BoundaryCondition;
+		Dm->CommInit();
+	}
 	comm.barrier();
 	
 	rank = Dm->rank();	
@@ -516,6 +531,11 @@ void ScaLBL_IonModel::ReadInput(){
     sprintf(LocalRankFilename,"%s%s","ID.",LocalRankString);
     sprintf(LocalRestartFile,"%s%s","Restart.",LocalRankString);
 
+    if (Lattice){
+    	// the image and signed distance are read once by the shared lattice
+    	Distance.view2(Lattice->Distance);
+    	return;
+    }
     
     if (domain_db->keyExists( "Filename" )){
     	auto Filename = domain_db->getScalar<std::string>( "Filename" );
@@ -661,23 +681,41 @@ void ScaLBL_IonModel::Create(){
 	 *  This function creates the variables needed to run a LBM 
 	 */
 	int rank=Mask->rank();
-	//.........................................................
-	// Initialize communication structures in averaging domain
-	for (int i=0; i<Nx*Ny*Nz; i++) Dm->id[i] = Mask->id[i];
-	Mask->CommInit();
-	Np=Mask->PoreCount();
-	//...........................................................................
-	if (rank==0)    printf ("LB Ion Solver: Create ScaLBL_Communicator \n");
-	// Create a communicator for the device (will use optimized layout)
-	// ScaLBL_Communicator ScaLBL_Comm(Mask); // original
-	ScaLBL_Comm  = std::shared_ptr<ScaLBL_Communicator>(new ScaLBL_Communicator(Mask));
-
-	int Npad=(Np/16 + 2)*16;
-	if (rank==0)    printf ("LB Ion Solver: Set up memory efficient layout \n");
-	Map.resize(Nx,Ny,Nz);       Map.fill(-2);
-	auto neighborList= new int[18*Npad];
-	Np = ScaLBL_Comm->MemoryOptimizedLayoutAA(Map,neighborList,Mask->id.data(),Np,1);
-	comm.barrier();
+	if (Lattice){
+		// communicator, layout and neighbor list are shared with the other models
+		if (rank==0)    printf ("LB Ion Solver: Using the shared lattice topology \n");
+		Np = Lattice->Np;
+		ScaLBL_Comm = Lattice->ScaLBL_Comm;
+		Map.view2(Lattice->Map);
+		NeighborList = Lattice->NeighborList;
+	}
+	else {
+		//.........................................................
+		// Initialize communication structures in averaging domain
+		for (int i=0; i<Nx*Ny*Nz; i++) Dm->id[i] = Mask->id[i];
+		Mask->CommInit();
+		Np=Mask->PoreCount();
+		//...........................................................................
+		if (rank==0)    printf ("LB Ion Solver: Create ScaLBL_Communicator \n");
+		// Create a communicator for the device (will use optimized layout)
+		// ScaLBL_Communicator ScaLBL_Comm(Mask); // original
+		ScaLBL_Comm  = std::shared_ptr<ScaLBL_Communicator>(new ScaLBL_Communicator(Mask));
+
+		int Npad=(Np/16 + 2)*16;
+		if (rank==0)    printf ("LB Ion Solver: Set up memory efficient layout \n");
+		Map.resize(Nx,Ny,Nz);       Map.fill(-2);
+		auto neighborList= new int[18*Npad];
+		Np = ScaLBL_Comm->MemoryOptimizedLayoutAA(Map,neighborList,Mask->id.data(),Np,1);
+		comm.barrier();
+		int neighborSize=18*(Np*sizeof(int));
+		ScaLBL_AllocateDeviceMemory((void **) &NeighborList, neighborSize, "NeighborList");
+		// Update GPU data structures
+		if (rank==0)    printf ("LB Ion Solver: Setting up device map and neighbor list \n");
+		// copy the neighbor list 
+		ScaLBL_CopyToDevice(NeighborList, neighborList, neighborSize);
+		delete [] neighborList;
+		comm.barrier();
+	}
 
 	//...........................................................................
 	//                MAIN  VARIABLES ALLOCATED HERE
@@ -686,25 +724,19 @@ void ScaLBL_IonModel::Create(){
 	if (rank==0)    printf ("LB Ion Solver: Allocating distributions \n");
 	//......................device distributions.................................
 	int dist_mem_size = Np*sizeof(double);
-	int neighborSize=18*(Np*sizeof(int));
 	//...........................................................................
-	ScaLBL_AllocateDeviceMemory((void **) &NeighborList, neighborSize);
-	ScaLBL_AllocateDeviceMemory((void **) &fq, number_ion_species*7*dist_mem_size);  
-	ScaLBL_AllocateDeviceMemory((void **) &Ci, number_ion_species*sizeof(double)*Np);
-	ScaLBL_AllocateDeviceMemory((void **) &ChargeDensity, sizeof(double)*Np);
-	//...........................................................................
-	// Update GPU data structures
-	if (rank==0)    printf ("LB Ion Solver: Setting up device map and neighbor list \n");
-	// copy the neighbor list 
-	ScaLBL_CopyToDevice(NeighborList, neighborList, neighborSize);
+	ScaLBL_AllocateDeviceMemory((void **) &fq, number_ion_species*7*dist_mem_size, "fq");  
+	ScaLBL_AllocateDeviceMemory((void **) &Ci, number_ion_species*sizeof(double)*Np, "Ci");
+	ScaLBL_AllocateDeviceMemory((void **) &ChargeDensity, sizeof(double)*Np, "ChargeDensity");
 	comm.barrier();
 	
     //Initialize solid boundary for electrical potential
     //if ion concentration at solid surface is specified
     if (BoundaryConditionSolid==1){
 
-	ScaLBL_AllocateDeviceMemory((void **) &IonSolid, sizeof(double)*Nx*Ny*Nz);
-        ScaLBL_Comm->SetupBounceBackList(Map, Mask->id.data(), Np);
+	ScaLBL_AllocateDeviceMemory((void **) &IonSolid, sizeof(double)*Nx*Ny*Nz, "IonSolid");
+        if (Lattice) Lattice->SetupBounceBackList();
+        else ScaLBL_Comm->SetupBounceBackList(Map, Mask->id.data(), Np);
         comm.barrier();
 
         double *IonSolid_host;
@@ -714,6 +746,7 @@ void ScaLBL_IonModel::Create(){
         ScaLBL_Comm->Barrier();
         delete [] IonSolid_host;
     }
+    ScaLBL_MemoryReport(comm, "ion model");
 }        
 
 void ScaLBL_IonModel::Initialize(){
@@ -1016,7 +1049,7 @@ void ScaLBL_IonModel::DummyFluidVelocity(){
             }
         }
     }
-	ScaLBL_AllocateDeviceMemory((void **) &FluidVelocityDummy, sizeof(double)*3*Np);
+	ScaLBL_AllocateDeviceMemory((void **) &FluidVelocityDummy, sizeof(double)*3*Np, "FluidVelocityDummy");
 	ScaLBL_CopyToDevice(FluidVelocityDummy, FluidVelocity_host, sizeof(double)*3*Np);
 	ScaLBL_Comm->Barrier();
 	delete [] FluidVelocity_host;
@@ -1037,7 +1070,7 @@ void ScaLBL_IonModel::DummyElectricField(){
             }
         }
     }
-	ScaLBL_AllocateDeviceMemory((void **) &ElectricFieldDummy, sizeof(double)*3*Np);
+	ScaLBL_AllocateDeviceMemory((void **) &ElectricFieldDummy, sizeof(double)*3*Np, "ElectricFieldDummy");
 	ScaLBL_CopyToDevice(ElectricFieldDummy, ElectricField_host, sizeof(double)*3*Np);
 	ScaLBL_Comm->Barrier();
 	delete [] ElectricField_host;
@@ -1048,29 +1081,31 @@ double ScaLBL_IonModel::CalIonDenConvergence(vector<double> &ci_avg_previous){
     Ci_host = new double[Np];
     vector<double> error(number_ion_species,0.0);
 
+	// one reduction for the averages of all species
+	vector<double> ci_loc(number_ion_species,0.0), ci_avg(number_ion_species,0.0);
+	double count_loc=0;
+	double count;
 	for (size_t ic=0; ic<number_ion_species; ic++){
 
 	    ScaLBL_CopyToHost(Ci_host,&Ci[ic*Np],Np*sizeof(double));
-		double count_loc=0;
-		double count;
-        double ci_avg;
-        double ci_loc=0.f;
-
         for (int idx=0; idx<ScaLBL_Comm->LastExterior(); idx++){
-            ci_loc +=Ci_host[idx];
-            count_loc+=1.0;
+            ci_loc[ic] +=Ci_host[idx];
         }
         for (int idx=ScaLBL_Comm->FirstInterior(); idx<ScaLBL_Comm->LastInterior(); idx++){
-            ci_loc +=Ci_host[idx];
-            count_loc+=1.0;
+            ci_loc[ic] +=Ci_host[idx];
         }
-		ci_avg = Mask->Comm.sumReduce( ci_loc);
-		count = Mask->Comm.sumReduce(  count_loc);
-		ci_avg /= count;
-        double ci_avg_mag=ci_avg;
-		if (ci_avg==0.0) ci_avg_mag=1.0;
-        error[ic] = fabs(ci_avg-ci_avg_previous[ic])/fabs(ci_avg_mag);
-		ci_avg_previous[ic] = ci_avg;
+    }
+    count_loc = double(ScaLBL_Comm->LastExterior() + ScaLBL_Comm->LastInterior() - ScaLBL_Comm->FirstInterior());
+	Utilities::MPI::Accumulator sums( Mask->Comm );
+	sums.sum( ci_avg.data(), ci_loc.data(), number_ion_species );
+	sums.sum( count, count_loc );
+	sums.reduce();
+	for (size_t ic=0; ic<number_ion_species; ic++){
+		ci_avg[ic] /= count;
+        double ci_avg_mag=ci_avg[ic];
+		if (ci_avg[ic]==0.0) ci_avg_mag=1.0;
+        error[ic] = fabs(ci_avg[ic]-ci_avg_previous[ic])/fabs(ci_avg_mag);
+		ci_avg_previous[ic] = ci_avg[ic];
     }
     double error_max;
     error_max = *max_element(error.begin(),error.end());
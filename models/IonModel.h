@@ -18,6 +18,7 @@
 #include "common/Communication.h"
 #include "common/MPI.h"
 #include "analysis/Minkowski.h"
+#include "models/LatticeTopology.h"
 #include "ProfilerApp.h"
 
 class ScaLBL_IonModel{
@@ -29,6 +30,7 @@ public:
 	void ReadParams(string filename,vector<int> &num_iter);
 	void ReadParams(string filename);
 	void ReadParams(std::shared_ptr<Database> db0);
+	void AttachLattice(std::shared_ptr<ScaLBL_LatticeTopology> lattice);//call before SetDomain to share the image and layout
 	void SetDomain();
 	void ReadInput();
 	void Create();
@@ -69,6 +71,7 @@ public:
 	std::shared_ptr<Domain> Dm;   // this domain is for analysis
 	std::shared_ptr<Domain> Mask; // this domain is for lbm
 	std::shared_ptr<ScaLBL_Communicator> ScaLBL_Comm;
+	std::shared_ptr<ScaLBL_LatticeTopology> Lattice;
     // input database
     std::shared_ptr<Database> db;
     std::shared_ptr<Database> domain_db;
@@ -0,0 +1,111 @@
+/*
+ * Lattice topology shared between coupled models
+ */
+#include <sstream>
+
+#include "models/LatticeTopology.h"
+#include "analysis/distance.h"
+#include "common/ReadMicroCT.h"
+
+ScaLBL_LatticeTopology::ScaLBL_LatticeTopology(std::shared_ptr<Database> domain_db0, int BC, const Utilities::MPI& COMM):
+Nx(0),Ny(0),Nz(0),N(0),Np(0),BoundaryCondition(BC),domain_db(domain_db0),NeighborList(NULL),comm(COMM),BounceBackList(false)
+{
+	Dm  = std::shared_ptr<Domain>(new Domain(domain_db,comm));      // full domain for analysis
+	Mask  = std::shared_ptr<Domain>(new Domain(domain_db,comm));    // mask domain removes immobile phases
+	Nx = Dm->Nx;
+	Ny = Dm->Ny;
+	Nz = Dm->Nz;
+	N = Nx*Ny*Nz;
+	Distance.resize(Nx,Ny,Nz);
+	for (int i=0; i<N; i++) Dm->id[i] = 1;               // initialize this way
+	Dm->BoundaryCondition = BoundaryCondition;
+	Mask->BoundaryCondition = BoundaryCondition;
+	Dm->CommInit();
+	comm.barrier();
+
+	ReadInput();
+	Create();
+}
+
+ScaLBL_LatticeTopology::~ScaLBL_LatticeTopology(){
+	if (NeighborList) ScaLBL_FreeDeviceMemory(NeighborList);
+}
+
+bool ScaLBL_LatticeTopology::Compatible(std::shared_ptr<Database> domain_db0, int BC) const{
+	// the communicator only distinguishes periodic and non-periodic z boundaries
+	if ((BC > 0) != (BoundaryCondition > 0)) return false;
+	if (domain_db0 == domain_db) return true;
+	std::ostringstream text1, text2;
+	domain_db->print(text1);
+	domain_db0->print(text2);
+	return text1.str() == text2.str();
+}
+
+void ScaLBL_LatticeTopology::ReadInput(){
+	int rank = Dm->rank();
+	if (domain_db->keyExists( "Filename" )){
+		auto Filename = domain_db->getScalar<std::string>( "Filename" );
+		Mask->Decomp(Filename);
+	}
+	else if (domain_db->keyExists( "GridFile" )){
+		// Read the local domain data
+		auto input_id = readMicroCT( *domain_db, comm );
+		// Fill the halo (assuming GCW of 1)
+		array<int,3> size0 = { (int) input_id.size(0), (int) input_id.size(1), (int) input_id.size(2) };
+		ArraySize size1 = { (size_t) Mask->Nx, (size_t) Mask->Ny, (size_t) Mask->Nz };
+		ASSERT( (int) size1[0] == size0[0]+2 && (int) size1[1] == size0[1]+2 && (int) size1[2] == size0[2]+2 );
+		fillHalo<signed char> fill( comm, Mask->rank_info, size0, { 1, 1, 1 }, 0, 1 );
+		Array<signed char> id_view;
+		id_view.viewRaw( size1, Mask->id.data() );
+		fill.copy( input_id, id_view );
+		fill.fill( id_view );
+	}
+	else{
+		Mask->ReadIDs();
+	}
+
+	// Generate the signed distance map
+	Array<char> id_solid(Nx,Ny,Nz);
+	for (int k=0;k<Nz;k++){
+		for (int j=0;j<Ny;j++){
+			for (int i=0;i<Nx;i++){
+				int n = k*Nx*Ny+j*Nx+i;
+				id_solid(i,j,k) = (Mask->id[n] > 0) ? 1 : 0;
+				Distance(i,j,k) = 2.0*double(id_solid(i,j,k))-1.0;
+			}
+		}
+	}
+	if (rank==0) printf("LB lattice topology: initialized solid phase & converting to Signed Distance function \n");
+	CalcDist(Distance,id_solid,*Dm);
+}
+
+void ScaLBL_LatticeTopology::Create(){
+	int rank = Mask->rank();
+	for (int i=0; i<N; i++) Dm->id[i] = Mask->id[i];
+	Mask->CommInit();
+	Np = Mask->PoreCount();
+	if (rank==0)    printf ("LB lattice topology: Create ScaLBL_Communicator \n");
+	ScaLBL_Comm  = std::shared_ptr<ScaLBL_Communicator>(new ScaLBL_Communicator(Mask));
+
+	int Npad=(Np/16 + 2)*16;
+	if (rank==0)    printf ("LB lattice topology: Set up memory efficient layout \n");
+	Map.resize(Nx,Ny,Nz);       Map.fill(-2);
+	auto neighborList= new int[18*Npad];
+	Np = ScaLBL_Comm->MemoryOptimizedLayoutAA(Map,neighborList,Mask->id.data(),Np,1);
+	comm.barrier();
+
+	int neighborSize=18*(Np*sizeof(int));
+	ScaLBL_AllocateDeviceMemory((void **) &NeighborList, neighborSize, "NeighborList");
+	ScaLBL_CopyToDevice(NeighborList, neighborList, neighborSize);
+	delete [] neighborList;
+	comm.barrier();
+}
+
+void ScaLBL_LatticeTopology::SetupBounceBackList(){
+	// the bounce-back lists depend only on the layout
+	if (!BounceBackList){
+		ScaLBL_Comm->SetupBounceBackList(Map, Mask->id.data(), Np);
+		comm.barrier();
+		BounceBackList = true;
+	}
+}
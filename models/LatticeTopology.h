@@ -0,0 +1,49 @@
+/*
+ * Lattice topology shared between coupled models
+ */
+#ifndef ScaLBL_LatticeTopology_INC
+#define ScaLBL_LatticeTopology_INC
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <iostream>
+
+#include "common/ScaLBL.h"
+#include "common/Communication.h"
+#include "common/MPI.h"
+
+/*
+ * The image, signed distance, sparse layout (Map, NeighborList) and ScaLBL_Communicator
+ * for one Domain section.  Models that solve on the same geometry (e.g. Stokes, Ion and
+ * Poisson in the electrokinetic solver) attach to one instance instead of each reading
+ * the image and building the layout.  Models use it only if their domain section is the
+ * same and they agree on periodic (BC = 0) or non-periodic z boundaries.
+ */
+class ScaLBL_LatticeTopology{
+public:
+	ScaLBL_LatticeTopology(std::shared_ptr<Database> domain_db0, int BC, const Utilities::MPI& COMM);
+	~ScaLBL_LatticeTopology();
+
+	bool Compatible(std::shared_ptr<Database> domain_db0, int BC) const;
+	void SetupBounceBackList();	// done once for all the attached models
+
+	int Nx,Ny,Nz,N,Np;
+	int BoundaryCondition;
+
+	std::shared_ptr<Domain> Dm;   // this domain is for analysis
+	std::shared_ptr<Domain> Mask; // this domain is for lbm
+	std::shared_ptr<ScaLBL_Communicator> ScaLBL_Comm;
+	std::shared_ptr<Database> domain_db;
+
+	IntArray Map;
+	DoubleArray Distance;
+	int *NeighborList;
+
+private:
+	Utilities::MPI comm;
+	bool BounceBackList;
+
+	void ReadInput();
+	void Create();
+};
+#endif
@@ -20,20 +20,33 @@
 #include "models/MRTModel.h"
 #include "analysis/distance.h"
 #include "common/ReadMicroCT.h"
+#include "analysis/uCT.h"
 ScaLBL_MRTModel::ScaLBL_MRTModel(int RANK, int NP, const Utilities::MPI& COMM):
-rank(RANK), nprocs(NP), Restart(0),timestep(0),timestepMax(0),tau(0),
-Fx(0),Fy(0),Fz(0),flux(0),din(0),dout(0),mu(0),
-Nx(0),Ny(0),Nz(0),N(0),Np(0),nprocx(0),nprocy(0),nprocz(0),BoundaryCondition(0),Lx(0),Ly(0),Lz(0),comm(COMM)
+rank(RANK), nprocs(NP), Restart(0),timestep(0),timestepMax(0),analysis_interval(1000),tau(0),
+Fx(0),Fy(0),Fz(0),flux(0),din(0),dout(0),mu(0),absperm(0),vax(0),vay(0),vaz(0),converged(false),
+CollisionType(0),sweep_levels(0),sweep_factor(2.0),sweep_Reynolds(0),
+Nx(0),Ny(0),Nz(0),N(0),Np(0),nprocx(0),nprocy(0),nprocz(0),BoundaryCondition(0),Lx(0),Ly(0),Lz(0),
+NeighborList(NULL),COMPACT_NEIGHBORS(false),NeighborDelta(NULL),EscapeList(NULL),EscapeCount(0),coarse_levels(0),
+fq(NULL),Velocity(NULL),Pressure(NULL),FlowStats(NULL),comm(COMM),level(0)
 {
 
 }
 ScaLBL_MRTModel::~ScaLBL_MRTModel(){
-
+	ScaLBL_FreeDeviceMemory( NeighborList );
+	ScaLBL_FreeDeviceMemory( NeighborDelta );
+	ScaLBL_FreeDeviceMemory( EscapeList );
+	ScaLBL_FreeDeviceMemory( fq );
+	ScaLBL_FreeDeviceMemory( Velocity );
+	ScaLBL_FreeDeviceMemory( Pressure );
+	ScaLBL_FreeDeviceMemory( FlowStats );
 }
 
 void ScaLBL_MRTModel::ReadParams(string filename){
 	// read the input database 
-	db = std::make_shared<Database>( filename );
+	ReadParams( std::make_shared<Database>( filename ) );
+}
+void ScaLBL_MRTModel::ReadParams(std::shared_ptr<Database> db0){
+	db = db0;
 	domain_db = db->getDatabase( "Domain" );
 	mrt_db = db->getDatabase( "MRT" );
 	
@@ -72,6 +85,38 @@ void ScaLBL_MRTModel::ReadParams(string filename){
 	if (mrt_db->keyExists( "flux" )){
 		flux = mrt_db->getScalar<double>( "flux" );
 	}	
+	if (mrt_db->keyExists( "compact_neighbor_list" )){
+		COMPACT_NEIGHBORS = mrt_db->getScalar<bool>( "compact_neighbor_list" );
+	}
+	if (mrt_db->keyExists( "analysis_interval" )){
+		analysis_interval = mrt_db->getScalar<int>( "analysis_interval" );
+	}
+	if (mrt_db->keyExists( "coarse_levels" )){
+		coarse_levels = mrt_db->getScalar<int>( "coarse_levels" );
+	}
+	if (mrt_db->keyExists( "collision" )){
+		auto collision = mrt_db->getScalar<std::string>( "collision" );
+		if (collision == "MRT")
+			CollisionType = 0;
+		else if (collision == "BGK")
+			CollisionType = 1;
+		else
+			ERROR( "Unknown collision " + collision + " (MRT or BGK)" );
+	}
+	if (CollisionType == 1 && COMPACT_NEIGHBORS){
+		// there is no BGK kernel for the 16-bit neighbor list
+		if (rank==0) printf("compact_neighbor_list is not used with the BGK collision \n");
+		COMPACT_NEIGHBORS = false;
+	}
+	if (mrt_db->keyExists( "sweep_levels" )){
+		sweep_levels = mrt_db->getScalar<int>( "sweep_levels" );
+	}
+	if (mrt_db->keyExists( "sweep_factor" )){
+		sweep_factor = mrt_db->getScalar<double>( "sweep_factor" );
+	}
+	if (mrt_db->keyExists( "sweep_Reynolds" )){
+		sweep_Reynolds = mrt_db->getScalar<double>( "sweep_Reynolds" );
+	}
 	
 	// Read domain parameters
 	if (mrt_db->keyExists( "BoundaryCondition" )){
@@ -140,7 +185,11 @@ void ScaLBL_MRTModel::ReadInput(){
     else{
     	Mask->ReadIDs();
     }
+	ComputeDistance();
+    if (rank == 0) cout << "Domain set." << endl;
+}
 
+void ScaLBL_MRTModel::ComputeDistance(){
     // Generate the signed distance map
 	// Initialize the domain and communication
 	Array<char> id_solid(Nx,Ny,Nz);
@@ -167,7 +216,6 @@ void ScaLBL_MRTModel::ReadInput(){
 //	MeanFilter(Averages->SDs);
 	if (rank==0) printf("Initialized solid phase -- Converting to Signed Distance function \n");
 	CalcDist(Distance,id_solid,*Dm);
-    if (rank == 0) cout << "Domain set." << endl;
 }
 
 void ScaLBL_MRTModel::Create(){
@@ -202,18 +250,40 @@ void ScaLBL_MRTModel::Create(){
 	int dist_mem_size = Np*sizeof(double);
 	int neighborSize=18*(Np*sizeof(int));
 	//...........................................................................
-	ScaLBL_AllocateDeviceMemory((void **) &NeighborList, neighborSize);
-	ScaLBL_AllocateDeviceMemory((void **) &fq, 19*dist_mem_size);  
-	ScaLBL_AllocateDeviceMemory((void **) &Pressure, sizeof(double)*Np);
-	ScaLBL_AllocateDeviceMemory((void **) &Velocity, 3*sizeof(double)*Np);
+	// the pressure and flux boundary conditions need the full neighbor list
+	bool FullNeighborList = !COMPACT_NEIGHBORS || BoundaryCondition == 3 || BoundaryCondition == 4;
+	if (FullNeighborList)
+		ScaLBL_AllocateDeviceMemory((void **) &NeighborList, neighborSize, "NeighborList");
+	ScaLBL_AllocateDeviceMemory((void **) &fq, 19*dist_mem_size, "fq");  
+	ScaLBL_AllocateDeviceMemory((void **) &Pressure, sizeof(double)*Np, "Pressure");
+	ScaLBL_AllocateDeviceMemory((void **) &Velocity, 3*sizeof(double)*Np, "Velocity");
+	ScaLBL_AllocateDeviceMemory((void **) &FlowStats, SCALBL_MRT_STATS*sizeof(double), "FlowStats");
 	//...........................................................................
 	// Update GPU data structures
 	if (rank==0)    printf ("Setting up device map and neighbor list \n");
 	// copy the neighbor list 
-	ScaLBL_CopyToDevice(NeighborList, neighborList, neighborSize);
+	if (FullNeighborList)
+		ScaLBL_CopyToDevice(NeighborList, neighborList, neighborSize);
+	if (COMPACT_NEIGHBORS){
+		std::vector<int> escapeList;
+		auto neighborDelta = new short[18*Np];
+		EscapeCount = ScaLBL_Comm->CompactNeighborList(neighborList, neighborDelta, escapeList, Np);
+		ScaLBL_AllocateDeviceMemory((void **) &NeighborDelta, 18*Np*sizeof(short), "NeighborDelta");
+		ScaLBL_AllocateDeviceMemory((void **) &EscapeList, escapeList.size()*sizeof(int), "EscapeList");
+		ScaLBL_CopyToDevice(NeighborDelta, neighborDelta, 18*Np*sizeof(short));
+		ScaLBL_CopyToDevice(EscapeList, escapeList.data(), escapeList.size()*sizeof(int));
+		delete [] neighborDelta;
+		int escaped = comm.sumReduce( EscapeCount );
+		int total = comm.sumReduce( Np );
+		if (rank==0) printf ("Compact neighbor list: %i of %i links stored in the escape table \n",escaped,18*total);
+	}
+	delete [] neighborList;
 	comm.barrier();
-	double MLUPS = ScaLBL_Comm->GetPerformance(NeighborList,fq,Np);
-	printf("  MLPUS=%f from rank %i\n",MLUPS,rank);
+	if (FullNeighborList){
+		double MLUPS = ScaLBL_Comm->GetPerformance(NeighborList,fq,Np);
+		printf("  MLPUS=%f from rank %i\n",MLUPS,rank);
+	}
+	ScaLBL_MemoryReport(comm, "MRT model");
 }        
 
 void ScaLBL_MRTModel::Initialize(){
@@ -222,15 +292,162 @@ void ScaLBL_MRTModel::Initialize(){
 	 */
     if (rank==0)    printf ("Initializing distributions \n");
     ScaLBL_D3Q19_Init(fq, Np);
+    if (coarse_levels > 0){
+    	if (BoundaryCondition == 0 || BoundaryCondition == 5)
+    		CoarseInitialize();
+    	else if (rank==0)
+    		printf("coarse_levels is only used with BC = 0 or 5, starting from rest \n");
+    }
 }
 
-void ScaLBL_MRTModel::Run(){
+/*
+ * Solve the steady flow on a grid coarsened by 2 in each direction (recursively for
+ * coarse_levels > 1) and use it as the initial condition.  With the same relaxation time
+ * the coarse grid has twice the spacing and four times the timestep, so the body force is
+ * scaled by 8 and the velocity of the coarse solution by 1/2 (density deviation by 1/4).
+ */
+void ScaLBL_MRTModel::CoarseInitialize(){
+	int nx = Nx-2, ny = Ny-2, nz = Nz-2;
+	INSIST( nx%2 == 0 && ny%2 == 0 && nz%2 == 0, "coarse_levels requires subdomain sizes divisible by 2 for each level" );
+	int cnx = nx/2, cny = ny/2, cnz = nz/2;
+	if (rank==0) printf("Coarse level %i: solving on %i x %i x %i subdomains \n",level+1,cnx,cny,cnz);
+
+	auto coarse_db = db->cloneDatabase();
+	coarse_db->getDatabase( "Domain" )->putVector<int>( "n", { cnx, cny, cnz } );
+	coarse_db->getDatabase( "Domain" )->putScalar<double>( "voxel_length", 2.0*Dm->voxel_length );
+	auto coarse_mrt_db = coarse_db->getDatabase( "MRT" );
+	coarse_mrt_db->putVector<double>( "F", { 8.0*Fx, 8.0*Fy, 8.0*Fz } );
+	coarse_mrt_db->putScalar<int>( "coarse_levels", coarse_levels-1 );
+	ScaLBL_MRTModel Coarse( rank, nprocs, comm );
+	Coarse.level = level + 1;
+	Coarse.ReadParams( coarse_db );
+	Coarse.SetDomain();
+
+	// restriction: a coarse site is fluid if at least half of its fine sites are fluid
+	Array<signed char> coarse_id( cnx+2, cny+2, cnz+2 );
+	coarse_id.fill( 0 );
+	for (int k=1; k<=cnz; k++){
+		for (int j=1; j<=cny; j++){
+			for (int i=1; i<=cnx; i++){
+				int count = 0;
+				for (int c=0; c<2; c++)
+					for (int b=0; b<2; b++)
+						for (int a=0; a<2; a++)
+							if (Mask->id[(2*k-1+c)*Nx*Ny + (2*j-1+b)*Nx + 2*i-1+a] > 0) count++;
+				coarse_id(i,j,k) = ( count >= 4 ) ? 1 : 0;
+			}
+		}
+	}
+	fillHalo<signed char> fillID( comm, Mask->rank_info, { cnx, cny, cnz }, { 1, 1, 1 }, 0, 1 );
+	fillID.fill( coarse_id );
+	for (size_t n=0; n<coarse_id.length(); n++) Coarse.Mask->id[n] = coarse_id(n);
+	Coarse.Mask->ComputePorosity();
+	Coarse.ComputeDistance();
+	Coarse.Create();
+	Coarse.Initialize();
+	Coarse.Run();
+
+	// coarse velocity and density in the regular layout (zero in the solid)
+	ScaLBL_D3Q19_Momentum( Coarse.fq, Coarse.Velocity, Coarse.Np );
+	ScaLBL_D3Q19_Pressure( Coarse.fq, Coarse.Pressure, Coarse.Np );
+	ScaLBL_DeviceBarrier(); comm.barrier();
+	std::vector<DoubleArray> coarse_fields( 4, DoubleArray( cnx+2, cny+2, cnz+2 ) );
+	Coarse.ScaLBL_Comm->RegularLayout( Coarse.Map, &Coarse.Velocity[0], coarse_fields[0] );
+	Coarse.ScaLBL_Comm->RegularLayout( Coarse.Map, &Coarse.Velocity[Coarse.Np], coarse_fields[1] );
+	Coarse.ScaLBL_Comm->RegularLayout( Coarse.Map, &Coarse.Velocity[2*Coarse.Np], coarse_fields[2] );
+	Coarse.ScaLBL_Comm->RegularLayout( Coarse.Map, Coarse.Pressure, coarse_fields[3] );
+	for (size_t n=0; n<coarse_fields[3].length(); n++){
+		// density deviation (pressure = rho/3)
+		if (coarse_id(n) > 0) coarse_fields[3](n) = 3.0*coarse_fields[3](n) - 1.0;
+	}
+
+	// prolongation to this grid
+	fillHalo<double> fillData( comm, Mask->rank_info, { cnx, cny, cnz }, { 1, 1, 1 }, 0, 1 );
+	std::vector<DoubleArray> fields( 4, DoubleArray( Nx, Ny, Nz ) );
+	const double scale[4] = { 0.5, 0.5, 0.5, 0.25 };
+	for (int m=0; m<4; m++){
+		fillData.fill( coarse_fields[m] );
+		fields[m].fill( 0 );
+		RefineMesh( coarse_fields[m], fields[m], 2, "trilinear" );
+	}
+
+	// equilibrium distributions
+	const int ex[19] = { 0, 1,-1, 0, 0, 0, 0, 1,-1, 1,-1, 1,-1, 1,-1, 0, 0, 0, 0 };
+	const int ey[19] = { 0, 0, 0, 1,-1, 0, 0, 1,-1,-1, 1, 0, 0, 0, 0, 1,-1, 1,-1 };
+	const int ez[19] = { 0, 0, 0, 0, 0, 1,-1, 0, 0, 0, 0, 1,-1,-1, 1, 1,-1,-1, 1 };
+	const double wq[19] = { 1.0/3.0, 1.0/18.0, 1.0/18.0, 1.0/18.0, 1.0/18.0, 1.0/18.0, 1.0/18.0,
+		1.0/36.0, 1.0/36.0, 1.0/36.0, 1.0/36.0, 1.0/36.0, 1.0/36.0, 1.0/36.0, 1.0/36.0, 1.0/36.0, 1.0/36.0, 1.0/36.0, 1.0/36.0 };
+	std::vector<double> dist( 19*size_t(Np) );
+	ScaLBL_CopyToHost( dist.data(), fq, 19*Np*sizeof(double) );
+	for (int k=1; k<Nz-1; k++){
+		for (int j=1; j<Ny-1; j++){
+			for (int i=1; i<Nx-1; i++){
+				int idx = Map(i,j,k);
+				if (idx < 0) continue;
+				double ux = scale[0]*fields[0](i,j,k);
+				double uy = scale[1]*fields[1](i,j,k);
+				double uz = scale[2]*fields[2](i,j,k);
+				double rho = 1.0 + scale[3]*fields[3](i,j,k);
+				double usq = ux*ux + uy*uy + uz*uz;
+				for (int q=0; q<19; q++){
+					double eu = ex[q]*ux + ey[q]*uy + ez[q]*uz;
+					dist[q*size_t(Np)+idx] = wq[q]*( rho + 3.0*eu + 4.5*eu*eu - 1.5*usq );
+				}
+			}
+		}
+	}
+	ScaLBL_CopyToDevice( fq, dist.data(), 19*Np*sizeof(double) );
+	comm.barrier();
+}
+
+void ScaLBL_MRTModel::CollideOdd(int start, int finish, bool STATS){
 	double rlx_setA=1.0/tau;
 	double rlx_setB = 8.f*(2.f-rlx_setA)/(8.f-rlx_setA);
-	
+	if (CollisionType == 1)
+		ScaLBL_D3Q19_AAodd_BGK(NeighborList, fq, start, finish, Np, rlx_setA, Fx, Fy, Fz);
+	else if (COMPACT_NEIGHBORS)
+		ScaLBL_D3Q19_AAodd_MRT_Compact(NeighborDelta, EscapeList, EscapeCount, fq, start, finish, Np, rlx_setA, rlx_setB, Fx, Fy, Fz);
+	else if (STATS)
+		ScaLBL_D3Q19_AAodd_MRT_Stats(NeighborList, fq, start, finish, Np, rlx_setA, rlx_setB, Fx, Fy, Fz, FlowStats);
+	else
+		ScaLBL_D3Q19_AAodd_MRT(NeighborList, fq, start, finish, Np, rlx_setA, rlx_setB, Fx, Fy, Fz);
+}
+
+void ScaLBL_MRTModel::CollideEven(int start, int finish, bool STATS){
+	double rlx_setA=1.0/tau;
+	double rlx_setB = 8.f*(2.f-rlx_setA)/(8.f-rlx_setA);
+	if (CollisionType == 1)
+		ScaLBL_D3Q19_AAeven_BGK(fq, start, finish, Np, rlx_setA, Fx, Fy, Fz);
+	else if (STATS)
+		ScaLBL_D3Q19_AAeven_MRT_Stats(fq, start, finish, Np, rlx_setA, rlx_setB, Fx, Fy, Fz, FlowStats);
+	else
+		ScaLBL_D3Q19_AAeven_MRT(fq, start, finish, Np, rlx_setA, rlx_setB, Fx, Fy, Fz);
+}
+
+// Site count and momentum of the pore space after an even timestep (the BGK kernels do not sum them)
+void ScaLBL_MRTModel::BGKFlowStats(double *stats){
+	ScaLBL_D3Q19_Momentum(fq, Velocity, Np);
+	ScaLBL_DeviceBarrier();
+	std::vector<double> velocity( 3*size_t(Np) );
+	ScaLBL_CopyToHost(velocity.data(), Velocity, 3*Np*sizeof(double));
+	for (int m=0; m<SCALBL_MRT_STATS; m++) stats[m] = 0.0;
+	int first[2] = { 0, ScaLBL_Comm->FirstInterior() };
+	int last[2] = { ScaLBL_Comm->LastExterior(), ScaLBL_Comm->LastInterior() };
+	for (int part=0; part<2; part++){
+		for (int n=first[part]; n<last[part]; n++){
+			stats[0] += 1.0;
+			stats[2] += velocity[n];
+			stats[3] += velocity[Np+n];
+			stats[4] += velocity[2*Np+n];
+		}
+	}
+}
+
+void ScaLBL_MRTModel::Run( double flow_rate_start ){
 	Minkowski Morphology(Mask);
 
-	if (rank==0){
+	// only the input grid is logged (not the coarse levels used for the initial condition)
+	if (rank==0 && level==0){
 		bool WriteHeader=false;
 		FILE *log_file = fopen("Permeability.csv","r");
 		if (log_file != NULL)
@@ -251,13 +468,14 @@ void ScaLBL_MRTModel::Run(){
 	if (rank==0) printf("********************************************************\n");
 	timestep=0;
 	double error = 1.0;
-	double flow_rate_previous = 0.0;
+	// the first convergence check compares against the initial state
+	double flow_rate_previous = flow_rate_start;
     auto t1 = std::chrono::system_clock::now();
 	while (timestep < timestepMax && error > tolerance) {
 		//************************************************************************/
 		timestep++;
 		ScaLBL_Comm->SendD3Q19AA(fq); //READ FROM NORMAL
-		ScaLBL_D3Q19_AAodd_MRT(NeighborList, fq,  ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np, rlx_setA, rlx_setB, Fx, Fy, Fz);
+		CollideOdd(ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), false);
 		ScaLBL_Comm->RecvD3Q19AA(fq); //WRITE INTO OPPOSITE
 		// Set boundary conditions
 		if (BoundaryCondition == 3){
@@ -272,11 +490,16 @@ void ScaLBL_MRTModel::Run(){
 			ScaLBL_Comm->D3Q19_Reflection_BC_z(fq);
 			ScaLBL_Comm->D3Q19_Reflection_BC_Z(fq);
 		}
-		ScaLBL_D3Q19_AAodd_MRT(NeighborList, fq, 0, ScaLBL_Comm->LastExterior(), Np, rlx_setA, rlx_setB, Fx, Fy, Fz);
+		CollideOdd(0, ScaLBL_Comm->LastExterior(), false);
 		ScaLBL_DeviceBarrier(); comm.barrier();
 		timestep++;
 		ScaLBL_Comm->SendD3Q19AA(fq); //READ FORM NORMAL
-		ScaLBL_D3Q19_AAeven_MRT(fq, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np, rlx_setA, rlx_setB, Fx, Fy, Fz);
+		// the collision sums the flow statistics on analysis steps
+		bool analysis = (timestep%analysis_interval==0);
+		double stats[SCALBL_MRT_STATS] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+		if (analysis)
+			ScaLBL_CopyToDevice(FlowStats, stats, SCALBL_MRT_STATS*sizeof(double));
+		CollideEven(ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), analysis);
 		ScaLBL_Comm->RecvD3Q19AA(fq); //WRITE INTO OPPOSITE
 		// Set boundary conditions
 		if (BoundaryCondition == 3){
@@ -291,38 +514,27 @@ void ScaLBL_MRTModel::Run(){
 			ScaLBL_Comm->D3Q19_Reflection_BC_z(fq);
 			ScaLBL_Comm->D3Q19_Reflection_BC_Z(fq);
 		}
-		ScaLBL_D3Q19_AAeven_MRT(fq, 0, ScaLBL_Comm->LastExterior(), Np, rlx_setA, rlx_setB, Fx, Fy, Fz);
+		CollideEven(0, ScaLBL_Comm->LastExterior(), analysis);
 		ScaLBL_DeviceBarrier(); comm.barrier();
 		//************************************************************************/
 		
-		if (timestep%1000==0){
-			ScaLBL_D3Q19_Momentum(fq,Velocity, Np);
-			ScaLBL_DeviceBarrier(); comm.barrier();
-			ScaLBL_Comm->RegularLayout(Map,&Velocity[0],Velocity_x);
-			ScaLBL_Comm->RegularLayout(Map,&Velocity[Np],Velocity_y);
-			ScaLBL_Comm->RegularLayout(Map,&Velocity[2*Np],Velocity_z);
-			
-			double count_loc=0;
+		if (analysis){
+			// momentum and site count of the pore space from the collision
+			if (CollisionType == 1)
+				BGKFlowStats(stats);
+			else
+				ScaLBL_CopyToHost(stats, FlowStats, SCALBL_MRT_STATS*sizeof(double));
 			double count;
-			double vax,vay,vaz;
-			double vax_loc,vay_loc,vaz_loc;
-			vax_loc = vay_loc = vaz_loc = 0.f;
-			for (int k=1; k<Nz-1; k++){
-				for (int j=1; j<Ny-1; j++){
-					for (int i=1; i<Nx-1; i++){
-						if (Distance(i,j,k) > 0){
-							vax_loc += Velocity_x(i,j,k);
-							vay_loc += Velocity_y(i,j,k);
-							vaz_loc += Velocity_z(i,j,k);
-							count_loc+=1.0;
-						}
-					}
-				}
-			}		
-			vax=Dm->Comm.sumReduce( vax_loc);
-			vay=Dm->Comm.sumReduce( vay_loc);
-			vaz=Dm->Comm.sumReduce( vaz_loc);
-			count=Dm->Comm.sumReduce( count_loc);
+			// the velocity sums complete while the Minkowski functionals are computed
+			Utilities::MPI::Accumulator sums( Dm->Comm );
+			sums.sum( vax, stats[2] );
+			sums.sum( vay, stats[3] );
+			sums.sum( vaz, stats[4] );
+			sums.sum( count, stats[0] );
+			sums.start();
+			//if (rank==0) printf("Computing Minkowski functionals \n");
+			Morphology.ComputeScalar(Distance,0.f);
+			sums.finish();
 			
 			vax /= count;
 			vay /= count;
@@ -344,23 +556,17 @@ void ScaLBL_MRTModel::Run(){
 			error = fabs(flow_rate - flow_rate_previous) / fabs(flow_rate);
 			flow_rate_previous = flow_rate;
 			
-			//if (rank==0) printf("Computing Minkowski functionals \n");
-			Morphology.ComputeScalar(Distance,0.f);
 			//Morphology.PrintAll();
 			double mu = (tau-0.5)/3.f;
-			double Vs = Morphology.V();
-			double As = Morphology.A();
-			double Hs = Morphology.H();
-			double Xs = Morphology.X();
-			Vs=Dm->Comm.sumReduce( Vs);
-			As=Dm->Comm.sumReduce( As);
-			Hs=Dm->Comm.sumReduce( Hs);
-			Xs=Dm->Comm.sumReduce( Xs);
+			double Vs = Morphology.Vi_global;
+			double As = Morphology.Ai_global;
+			double Hs = Morphology.Ji_global;
+			double Xs = Morphology.Xi_global;
 
 			double h = Dm->voxel_length;
-			double absperm = h*h*mu*Mask->Porosity()*flow_rate / force_mag;
-			if (rank==0) {
-				printf("     %f\n",absperm);
+			absperm = h*h*mu*Mask->Porosity()*flow_rate / force_mag;
+			if (rank==0) printf("     %f\n",absperm);
+			if (rank==0 && level==0) {
 				FILE * log_file = fopen("Permeability.csv","a");
 				fprintf(log_file,"%i %.8g %.8g %.8g %.8g %.8g %.8g %.8g %.8g %.8g %.8g %.8g %.8g\n",timestep, Fx, Fy, Fz, mu, 
 						h*h*h*Vs,h*h*As,h*Hs,Xs,vax,vay,vaz, absperm);
@@ -369,6 +575,8 @@ void ScaLBL_MRTModel::Run(){
 		}
 	}
 	//************************************************************************/
+	converged = ( error <= tolerance );
+	if (rank==0 && !converged) printf("WARNING: flow did not converge in %i timesteps (relative change %g) \n", timestep, error);
 	if (rank==0) printf("-------------------------------------------------------------------\n");
 	// Compute the walltime per timestep
     auto t2 = std::chrono::system_clock::now();
@@ -385,6 +593,80 @@ void ScaLBL_MRTModel::Run(){
 
 }
 
+/*
+ * Non-Darcy curve: steady flow for the body forces F, F*sweep_factor, F*sweep_factor^2, ... where each
+ * level starts from the steady state of the previous one.  The Stokes flow is linear in F, so the
+ * deviation of the distributions from rest is scaled by sweep_factor: only the inertial correction is
+ * left to converge.  The Reynolds and Forchheimer numbers use the Sauter mean diameter of the solid
+ * D32 = 6 Vs/As (Dye et al., Physical Review E 87, 033012)
+ *    Re = D32 v / nu,   Fo = D32^3 |F| / nu^2,   Fo = a Re + b Re^2
+ */
+void ScaLBL_MRTModel::RunSweep(){
+	INSIST( Fx*Fx+Fy*Fy+Fz*Fz > 0.0 && sweep_factor > 0.0, "The non-Darcy sweep requires a body force F and sweep_factor > 0" );
+	Minkowski Morphology(Mask);
+	Morphology.ComputeScalar(Distance,0.f);
+	double D32 = 6.0*Morphology.Vi_global/Morphology.Ai_global;
+	double nu = (tau-0.5)/3.0;
+	if (rank==0){
+		bool WriteHeader=false;
+		FILE *log_file = fopen("nondarcy.csv","r");
+		if (log_file != NULL)
+			fclose(log_file);
+		else
+			WriteHeader=true;
+		if (WriteHeader){
+			log_file = fopen("nondarcy.csv","a+");
+			fprintf(log_file,"D32 Fx Fy Fz vx vy vz Re Fo converged\n");
+			fclose(log_file);
+		}
+	}
+
+	const double F0[3] = { Fx, Fy, Fz };
+	double scale = 1.0;
+	double velocity = 0.0;
+	NonDarcy.clear();
+	for (int step=0; step<sweep_levels; step++){
+		Fx = scale*F0[0];
+		Fy = scale*F0[1];
+		Fz = scale*F0[2];
+		if (rank==0) printf("Non-Darcy sweep: level %i of %i, F = %.5g, %.5g, %.5g \n",step+1,sweep_levels,Fx,Fy,Fz);
+		if (step > 0){
+			// f = w + sweep_factor*(f - w) scales the velocity (and the pressure) of the previous level
+			// (the weights of q and its opposite are equal, so this holds for the odd and even layout)
+			std::vector<double> cfq( 19*size_t(Np) );
+			ScaLBL_CopyToHost(cfq.data(), fq, 19*size_t(Np)*sizeof(double));
+			for (int q=0; q<19; q++){
+				double w = ( q == 0 ) ? 1.0/3.0 : ( ( q < 7 ) ? 1.0/18.0 : 1.0/36.0 );
+				for (size_t n=q*size_t(Np); n<(q+1)*size_t(Np); n++)
+					cfq[n] = w + sweep_factor*(cfq[n] - w);
+			}
+			ScaLBL_CopyToDevice(fq, cfq.data(), 19*size_t(Np)*sizeof(double));
+		}
+		Run( sweep_factor*velocity );
+
+		double force_mag = sqrt(Fx*Fx+Fy*Fy+Fz*Fz);
+		velocity = (vax*Fx + vay*Fy + vaz*Fz)/force_mag;
+		NonDarcyPoint point;
+		point.Fx = Fx; point.Fy = Fy; point.Fz = Fz;
+		point.vx = vax; point.vy = vay; point.vz = vaz;
+		point.Re = D32*velocity/nu;
+		point.Fo = D32*D32*D32*force_mag/(nu*nu);
+		point.timesteps = timestep;
+		point.converged = converged;
+		NonDarcy.push_back( point );
+		if (rank==0){
+			printf("Non-Darcy sweep: D32 = %f, Re = %.5g, Fo = %.5g, Re/Fo = %.5g (%i timesteps%s) \n",
+					D32, point.Re, point.Fo, point.Re/point.Fo, timestep, converged ? "" : ", NOT converged");
+			FILE * log_file = fopen("nondarcy.csv","a");
+			fprintf(log_file,"%.5g %.5g %.5g %.5g %.5g %.5g %.5g %.5g %.5g %i\n",D32,Fx,Fy,Fz,vax,vay,vaz,point.Re,point.Fo,converged?1:0);
+			fclose(log_file);
+		}
+		if (sweep_Reynolds > 0.0 && point.Re >= sweep_Reynolds)
+			break;
+		scale *= sweep_factor;
+	}
+}
+
 void ScaLBL_MRTModel::VelocityField(){
 
 /*	Minkowski Morphology(Mask);
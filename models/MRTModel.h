@@ -43,16 +43,36 @@ public:
 	void ReadInput();
 	void Create();
 	void Initialize();
-	void Run();
+	void Run( double flow_rate_start = 0.0 );  // flow rate along F of the initial state (0 from rest)
+	void RunSweep();
 	void VelocityField();
 	
 	bool Restart,pBC;
 	int timestep,timestepMax;
+	int analysis_interval;     // timesteps between convergence checks
 	int BoundaryCondition;
 	double tau,mu;
 	double Fx,Fy,Fz,flux;
 	double din,dout;
 	double tolerance;
+	double absperm;     // permeability from the last analysis step of Run()
+	double vax,vay,vaz; // mean velocity of the pore space from the last analysis step of Run()
+	bool converged;     // the last Run() reached the tolerance before timestepMax
+	// collision (MRT { collision = "MRT" or "BGK" }), the BGK collision uses the relaxation time tau
+	int CollisionType;  // 0 MRT, 1 BGK
+	// non-Darcy sweep: RunSweep() runs sweep_levels body forces F, F*sweep_factor, ... each from the
+	// steady state of the previous one scaled by sweep_factor (the Darcy extrapolation), and stops
+	// once the Reynolds number reaches sweep_Reynolds (if > 0)
+	int sweep_levels;
+	double sweep_factor,sweep_Reynolds;
+	struct NonDarcyPoint {
+		double Fx,Fy,Fz;
+		double vx,vy,vz;
+		double Re,Fo;       // Reynolds and Forchheimer numbers (with the Sauter mean diameter of the solid)
+		int timesteps;      // timesteps to reach the steady state
+		bool converged;     // false if the level stopped at timestepMax
+	};
+	std::vector<NonDarcyPoint> NonDarcy;  // steady states from RunSweep()
 	
 	int Nx,Ny,Nz,N,Np;
 	int rank,nprocx,nprocy,nprocz,nprocs;
@@ -70,9 +90,18 @@ public:
     IntArray Map;
     DoubleArray Distance;
     int *NeighborList;
+    // 16-bit neighbor list for the odd timestep (MRT { compact_neighbor_list = true })
+    bool COMPACT_NEIGHBORS;
+    short *NeighborDelta;
+    int *EscapeList;
+    int EscapeCount;
+    // number of coarsened grids used to initialize the flow (MRT { coarse_levels = 2 })
+    int coarse_levels;
     double *fq;
     double *Velocity;
     double *Pressure;
+    // flow statistics summed by the collision on analysis steps (SCALBL_MRT_STATS values)
+    double *FlowStats;
     
     //Minkowski Morphology;
 		
@@ -89,4 +118,12 @@ private:
    
     //int rank,nprocs;
     void LoadParams(std::shared_ptr<Database> db0);    	
+    // coarsening level of this model (0 for the model that was read from the input)
+    int level;
+    void ComputeDistance();
+    void CoarseInitialize();
+    // collision of the sites [start,finish), the MRT kernels also sum the flow statistics if STATS
+    void CollideOdd(int start, int finish, bool STATS);
+    void CollideEven(int start, int finish, bool STATS);
+    void BGKFlowStats(double *stats);
 };
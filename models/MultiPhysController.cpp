@@ -2,7 +2,8 @@
 
 ScaLBL_Multiphys_Controller::ScaLBL_Multiphys_Controller(int RANK, int NP, const Utilities::MPI& COMM):
 rank(RANK),nprocs(NP),Restart(0),timestepMax(0),num_iter_Stokes(0),num_iter_Ion(0),
-analysis_interval(0),visualization_interval(0),tolerance(0),time_conv_max(0),comm(COMM)
+analysis_interval(0),visualization_interval(0),tolerance(0),time_conv_max(0),
+adaptive_coupling(false),coupling_tolerance(0),coupling_max_skip(0),shared_lattice(false),comm(COMM)
 {
 
 }
@@ -13,7 +14,12 @@ ScaLBL_Multiphys_Controller::~ScaLBL_Multiphys_Controller(){
 void ScaLBL_Multiphys_Controller::ReadParams(string filename){
     
     // read the input database 
-	db = std::make_shared<Database>( filename );
+	ReadParams( std::make_shared<Database>( filename ) );
+}
+
+void ScaLBL_Multiphys_Controller::ReadParams(std::shared_ptr<Database> db0){
+
+	db = db0;
 	study_db = db->getDatabase( "MultiphysController" );
     
 
@@ -26,6 +32,10 @@ void ScaLBL_Multiphys_Controller::ReadParams(string filename){
     visualization_interval = 10000;
     tolerance = 1.0e-6;
     time_conv_max = 0.0;
+    adaptive_coupling = false;
+    coupling_tolerance = 1.0e-4;
+    coupling_max_skip = 10;
+    shared_lattice = true;
 	
     // load input parameters
 	if (study_db->keyExists( "timestepMax" )){
@@ -40,6 +50,18 @@ void ScaLBL_Multiphys_Controller::ReadParams(string filename){
 	if (study_db->keyExists( "tolerance" )){
 		tolerance = study_db->getScalar<double>( "tolerance" );
 	}
+	if (study_db->keyExists( "adaptive_coupling" )){
+		adaptive_coupling = study_db->getScalar<bool>( "adaptive_coupling" );
+	}
+	if (study_db->keyExists( "coupling_tolerance" )){
+		coupling_tolerance = study_db->getScalar<double>( "coupling_tolerance" );
+	}
+	if (study_db->keyExists( "coupling_max_skip" )){
+		coupling_max_skip = study_db->getScalar<int>( "coupling_max_skip" );
+	}
+	if (study_db->keyExists( "shared_lattice" )){
+		shared_lattice = study_db->getScalar<bool>( "shared_lattice" );
+	}
 	//if (study_db->keyExists( "time_conv" )){
 	//	time_conv = study_db->getScalar<double>( "time_conv" );
 	//}
@@ -145,3 +167,79 @@ void ScaLBL_Multiphys_Controller::getTimeConvMax_PNP_coupling(double StokesTimeC
     TimeConv.insert(TimeConv.begin(),StokesTimeConv);
     time_conv_max = *max_element(TimeConv.begin(),TimeConv.end());
 }
+
+int ScaLBL_Multiphys_Controller::AddCoupledSolver(const std::string &name){
+    CoupledSolver solver;
+    solver.name = name;
+    solver.solved = 0;
+    solver.skipped = 0;
+    solver.steps_skipped = 0;
+    coupled_solvers.push_back(solver);
+    return coupled_solvers.size()-1;
+}
+
+void ScaLBL_Multiphys_Controller::AddCouplingInput(int solver, const double *field, size_t length){
+    auto &S = coupled_solvers[solver];
+    S.inputs.push_back(field);
+    S.lengths.push_back(length);
+    S.reference.push_back(vector<double>());
+}
+
+double ScaLBL_Multiphys_Controller::CouplingChange(const double *field, const vector<double> &reference, vector<double> &values){
+    //Return the change of a field relative to its reference value (L2 norm over all processes)
+    ScaLBL_CopyToHost(values.data(),field,values.size()*sizeof(double));
+    double diff_loc=0.0,norm_loc=0.0;
+    for (size_t n=0; n<values.size(); n++){
+        double d = values[n]-reference[n];
+        diff_loc += d*d;
+        norm_loc += reference[n]*reference[n];
+    }
+    double diff, norm;
+    Utilities::MPI::Accumulator sums(comm);
+    sums.sum(diff, diff_loc);
+    sums.sum(norm, norm_loc);
+    sums.reduce();
+    if (norm==0.0) return (diff==0.0) ? 0.0 : 1.0e300;
+    return sqrt(diff/norm);
+}
+
+bool ScaLBL_Multiphys_Controller::SolveRequired(int solver, bool force){
+    //Decide if a solver has to run in this outer step; the references are updated when it does
+    auto &S = coupled_solvers[solver];
+    bool solve = true;
+    if (adaptive_coupling){
+        solve = (force || S.solved==0 || S.steps_skipped >= coupling_max_skip);
+        vector<vector<double>> values(S.inputs.size());
+        for (size_t i=0; i<S.inputs.size(); i++){
+            values[i].resize(S.lengths[i]);
+            if (S.reference[i].size() != S.lengths[i]){
+                ScaLBL_CopyToHost(values[i].data(),S.inputs[i],S.lengths[i]*sizeof(double));
+                solve = true;
+            }
+            else if (!(CouplingChange(S.inputs[i],S.reference[i],values[i]) <= coupling_tolerance)){//NaN: solve
+                solve = true;
+            }
+        }
+        if (solve){
+            for (size_t i=0; i<S.inputs.size(); i++) S.reference[i].swap(values[i]);
+        }
+    }
+    if (solve){
+        S.solved++;
+        S.steps_skipped = 0;
+    }
+    else {
+        S.skipped++;
+        S.steps_skipped++;
+    }
+    return solve;
+}
+
+void ScaLBL_Multiphys_Controller::CouplingReport(){
+    if (rank==0){
+        for (auto &S : coupled_solvers){
+            printf("%s solver: %i solves, %i skipped (adaptive coupling %s, tolerance %g) \n",S.name.c_str(),
+                   S.solved,S.skipped,adaptive_coupling ? "on" : "off",coupling_tolerance);
+        }
+    }
+}
@@ -28,6 +28,16 @@ public:
     vector<int> getIonNumIter_PNP_coupling(double StokesTimeConv,const vector<double> &IonTimeConv);
     //void getIonNumIter_PNP_coupling(double StokesTimeConv,vector<double> &IonTimeConv,vector<int> &IonTimeMax);
     void getTimeConvMax_PNP_coupling(double StokesTimeConv,const vector<double> &IonTimeConv);
+
+    // Adaptive coupling: a solver is skipped for an outer step if none of its inputs
+    // changed by more than coupling_tolerance (relative L2 norm) since it last ran.
+    // A solver that time-marches its own state (e.g. the Stokes velocity) registers that
+    // state as an input too: it is compared with its value before the last solve, so the
+    // solver keeps running until one solve no longer changes it
+    int AddCoupledSolver(const std::string &name);
+    void AddCouplingInput(int solver, const double *field, size_t length);//field is a device array
+    bool SolveRequired(int solver, bool force=false);//force: inputs not tracked here changed (e.g. time-dependent BC)
+    void CouplingReport();
 	
 	bool Restart;
     int timestepMax;
@@ -37,6 +47,10 @@ public:
     int visualization_interval;
     double tolerance;
     double time_conv_max;
+    bool adaptive_coupling;
+    double coupling_tolerance;
+    int coupling_max_skip;//a skipped solver is run again after this many outer steps
+    bool shared_lattice;//models on the same Domain share one ScaLBL_LatticeTopology
     //double SchmidtNum;//Schmidt number = kinematic_viscosity/mass_diffusivity
 
 	int rank,nprocs;
@@ -47,6 +61,17 @@ public:
 
 private:
 	Utilities::MPI comm;
+
+    // inputs of a coupled solver and their values when it last ran
+    struct CoupledSolver {
+        std::string name;
+        vector<const double*> inputs;
+        vector<size_t> lengths;
+        vector<vector<double>> reference;
+        int solved, skipped, steps_skipped;
+    };
+    vector<CoupledSolver> coupled_solvers;
+    double CouplingChange(const double *field, const vector<double> &reference, vector<double> &values);
 	
 	// filenames
     char LocalRankString[8];
@@ -0,0 +1,492 @@
+/*
+  Copyright Equnior ASA
+
+  This file is part of the Open Porous Media project (OPM).
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*
+ * Single-phase flow of a generalized Newtonian fluid (MRT with shear-rate dependent viscosity)
+ */
+#include "models/NonNewtonianModel.h"
+#include "analysis/distance.h"
+#include "common/ReadMicroCT.h"
+
+ScaLBL_NonNewtonianModel::ScaLBL_NonNewtonianModel(int RANK, int NP, const Utilities::MPI& COMM):
+rank(RANK), nprocs(NP), Restart(0),timestep(0),timestepMax(0),analysis_interval(1000),restart_interval(0),
+BoundaryCondition(0),rheology(0),nu_0(0),nu_inf(0),lambda(0),n_index(1),nu_min(0),nu_max(0),
+Fx(0),Fy(0),Fz(0),flux(0),din(0),dout(0),tolerance(0),mean_viscosity(0),absperm(0),
+Nx(0),Ny(0),Nz(0),N(0),Np(0),nprocx(0),nprocy(0),nprocz(0),Lx(0),Ly(0),Lz(0),
+NeighborList(NULL),fq(NULL),Viscosity(NULL),Velocity(NULL),FlowStats(NULL),comm(COMM)
+{
+
+}
+ScaLBL_NonNewtonianModel::~ScaLBL_NonNewtonianModel(){
+	ScaLBL_FreeDeviceMemory( NeighborList );
+	ScaLBL_FreeDeviceMemory( fq );
+	ScaLBL_FreeDeviceMemory( Viscosity );
+	ScaLBL_FreeDeviceMemory( Velocity );
+	ScaLBL_FreeDeviceMemory( FlowStats );
+}
+
+void ScaLBL_NonNewtonianModel::ReadParams(string filename){
+	// read the input database
+	ReadParams( std::make_shared<Database>( filename ) );
+}
+void ScaLBL_NonNewtonianModel::ReadParams(std::shared_ptr<Database> db0){
+	db = db0;
+	domain_db = db->getDatabase( "Domain" );
+	nonnewtonian_db = db->getDatabase( "NonNewtonian" );
+	INSIST( nonnewtonian_db, "NonNewtonian section is missing from the input database" );
+
+	double tau = 1.0;
+	double tau_inf = 0.5;
+	double tau_min = 0.505;
+	double tau_max = 5.0;
+	timestepMax = 100000;
+	tolerance = 1.0e-8;
+	Fx = Fy = 0.0;
+	Fz = 1.0e-5;
+	dout = 1.0;
+	din = 1.0;
+
+	// rheology: nu_0 is the consistency (power law) or the zero shear viscosity (Carreau)
+	auto model = nonnewtonian_db->getWithDefault<std::string>( "rheology", "power_law" );
+	if (model == "power_law")
+		rheology = 0;
+	else if (model == "carreau")
+		rheology = 1;
+	else
+		ERROR( "Unknown rheology " + model + " (power_law or carreau)" );
+	if (nonnewtonian_db->keyExists( "tau" )){
+		tau = nonnewtonian_db->getScalar<double>( "tau" );
+	}
+	if (nonnewtonian_db->keyExists( "tau_inf" )){
+		tau_inf = nonnewtonian_db->getScalar<double>( "tau_inf" );
+	}
+	if (nonnewtonian_db->keyExists( "lambda" )){
+		lambda = nonnewtonian_db->getScalar<double>( "lambda" );
+	}
+	if (nonnewtonian_db->keyExists( "n" )){
+		n_index = nonnewtonian_db->getScalar<double>( "n" );
+	}
+	if (nonnewtonian_db->keyExists( "tau_min" )){
+		tau_min = nonnewtonian_db->getScalar<double>( "tau_min" );
+	}
+	if (nonnewtonian_db->keyExists( "tau_max" )){
+		tau_max = nonnewtonian_db->getScalar<double>( "tau_max" );
+	}
+	INSIST( tau_min > 0.5 && tau_max >= tau_min, "NonNewtonian requires 0.5 < tau_min <= tau_max" );
+
+	if (nonnewtonian_db->keyExists( "timestepMax" )){
+		timestepMax = nonnewtonian_db->getScalar<int>( "timestepMax" );
+	}
+	if (nonnewtonian_db->keyExists( "tolerance" )){
+		tolerance = nonnewtonian_db->getScalar<double>( "tolerance" );
+	}
+	if (nonnewtonian_db->keyExists( "F" )){
+		Fx = nonnewtonian_db->getVector<double>( "F" )[0];
+		Fy = nonnewtonian_db->getVector<double>( "F" )[1];
+		Fz = nonnewtonian_db->getVector<double>( "F" )[2];
+	}
+	if (nonnewtonian_db->keyExists( "Restart" )){
+		Restart = nonnewtonian_db->getScalar<bool>( "Restart" );
+	}
+	if (nonnewtonian_db->keyExists( "din" )){
+		din = nonnewtonian_db->getScalar<double>( "din" );
+	}
+	if (nonnewtonian_db->keyExists( "dout" )){
+		dout = nonnewtonian_db->getScalar<double>( "dout" );
+	}
+	if (nonnewtonian_db->keyExists( "flux" )){
+		flux = nonnewtonian_db->getScalar<double>( "flux" );
+	}
+	if (nonnewtonian_db->keyExists( "analysis_interval" )){
+		analysis_interval = nonnewtonian_db->getScalar<int>( "analysis_interval" );
+	}
+	if (db->keyExists( "Analysis" )){
+		auto analysis_db = db->getDatabase( "Analysis" );
+		analysis_interval = analysis_db->getWithDefault<int>( "analysis_interval", analysis_interval );
+		restart_interval = analysis_db->getWithDefault<int>( "restart_interval", restart_interval );
+	}
+
+	// Read domain parameters
+	if (nonnewtonian_db->keyExists( "BC" )){
+		BoundaryCondition = nonnewtonian_db->getScalar<int>( "BC" );
+	}
+	else if (domain_db->keyExists( "BC" )){
+		BoundaryCondition = domain_db->getScalar<int>( "BC" );
+	}
+
+	nu_0 = (tau-0.5)/3.0;
+	nu_inf = (tau_inf-0.5)/3.0;
+	nu_min = (tau_min-0.5)/3.0;
+	nu_max = (tau_max-0.5)/3.0;
+}
+void ScaLBL_NonNewtonianModel::SetDomain(){
+	Dm  = std::shared_ptr<Domain>(new Domain(domain_db,comm));      // full domain for analysis
+	Mask  = std::shared_ptr<Domain>(new Domain(domain_db,comm));    // mask domain removes immobile phases
+
+	// domain parameters
+	Nx = Dm->Nx;
+	Ny = Dm->Ny;
+	Nz = Dm->Nz;
+	Lx = Dm->Lx;
+	Ly = Dm->Ly;
+	Lz = Dm->Lz;
+
+	N = Nx*Ny*Nz;
+	Distance.resize(Nx,Ny,Nz);
+	Velocity_x.resize(Nx,Ny,Nz);
+	Velocity_y.resize(Nx,Ny,Nz);
+	Velocity_z.resize(Nx,Ny,Nz);
+	Viscosity_field.resize(Nx,Ny,Nz);
+
+	for (int i=0; i<Nx*Ny*Nz; i++) Dm->id[i] = 1;               // initialize this way
+	comm.barrier();
+	Dm->CommInit();
+	comm.barrier();
+
+	rank = Dm->rank();
+	nprocx = Dm->nprocx();
+	nprocy = Dm->nprocy();
+	nprocz = Dm->nprocz();
+}
+
+void ScaLBL_NonNewtonianModel::ReadInput(){
+
+    sprintf(LocalRankString,"%05d",Dm->rank());
+    sprintf(LocalRankFilename,"%s%s","ID.",LocalRankString);
+    sprintf(LocalRestartFile,"%s%s","Restart.",LocalRankString);
+
+    if (domain_db->keyExists( "Filename" )){
+    	auto Filename = domain_db->getScalar<std::string>( "Filename" );
+    	Mask->Decomp(Filename);
+    }
+    else if (domain_db->keyExists( "GridFile" )){
+    	// Read the local domain data
+    	auto input_id = readMicroCT( *domain_db, comm );
+    	// Fill the halo (assuming GCW of 1)
+    	array<int,3> size0 = { (int) input_id.size(0), (int) input_id.size(1), (int) input_id.size(2) };
+    	ArraySize size1 = { (size_t) Mask->Nx, (size_t) Mask->Ny, (size_t) Mask->Nz };
+    	ASSERT( (int) size1[0] == size0[0]+2 && (int) size1[1] == size0[1]+2 && (int) size1[2] == size0[2]+2 );
+    	fillHalo<signed char> fill( comm, Mask->rank_info, size0, { 1, 1, 1 }, 0, 1 );
+    	Array<signed char> id_view;
+    	id_view.viewRaw( size1, Mask->id.data() );
+    	fill.copy( input_id, id_view );
+    	fill.fill( id_view );
+    }
+    else{
+    	Mask->ReadIDs();
+    }
+	ComputeDistance();
+    if (rank == 0) cout << "Domain set." << endl;
+}
+
+void ScaLBL_NonNewtonianModel::ComputeDistance(){
+	// signed distance to the solid (used for the visualization)
+	Array<char> id_solid(Nx,Ny,Nz);
+	for (int k=0;k<Nz;k++){
+		for (int j=0;j<Ny;j++){
+			for (int i=0;i<Nx;i++){
+				int n = k*Nx*Ny+j*Nx+i;
+				if (Mask->id[n] > 0)	id_solid(i,j,k) = 1;
+				else	     	    id_solid(i,j,k) = 0;
+				Distance(i,j,k) = 2.0*double(id_solid(i,j,k))-1.0;
+			}
+		}
+	}
+	if (rank==0) printf("Initialized solid phase -- Converting to Signed Distance function \n");
+	CalcDist(Distance,id_solid,*Dm);
+}
+
+void ScaLBL_NonNewtonianModel::Create(){
+	/*
+	 *  This function creates the variables needed to run a LBM
+	 */
+	int rank=Mask->rank();
+	//.........................................................
+	// Initialize communication structures in averaging domain
+	for (int i=0; i<Nx*Ny*Nz; i++) Dm->id[i] = Mask->id[i];
+	Mask->CommInit();
+	Np=Mask->PoreCount();
+	//...........................................................................
+	if (rank==0)    printf ("Create ScaLBL_Communicator \n");
+	// Create a communicator for the device (will use optimized layout)
+	ScaLBL_Comm  = std::shared_ptr<ScaLBL_Communicator>(new ScaLBL_Communicator(Mask));
+
+	int Npad=(Np/16 + 2)*16;
+	if (rank==0)    printf ("Set up memory efficient layout \n");
+	Map.resize(Nx,Ny,Nz);       Map.fill(-2);
+	auto neighborList= new int[18*Npad];
+	Np = ScaLBL_Comm->MemoryOptimizedLayoutAA(Map,neighborList,Mask->id.data(),Np,1);
+	comm.barrier();
+
+	//...........................................................................
+	//                MAIN  VARIABLES ALLOCATED HERE
+	//...........................................................................
+	if (rank==0)    printf ("Allocating distributions \n");
+	int dist_mem_size = Np*sizeof(double);
+	int neighborSize=18*(Np*sizeof(int));
+	ScaLBL_AllocateDeviceMemory((void **) &NeighborList, neighborSize, "NeighborList");
+	ScaLBL_AllocateDeviceMemory((void **) &fq, 19*dist_mem_size, "fq");
+	ScaLBL_AllocateDeviceMemory((void **) &Viscosity, dist_mem_size, "Viscosity");
+	ScaLBL_AllocateDeviceMemory((void **) &Velocity, 3*dist_mem_size, "Velocity");
+	ScaLBL_AllocateDeviceMemory((void **) &FlowStats, SCALBL_NONNEWTONIAN_STATS*sizeof(double), "FlowStats");
+	//...........................................................................
+	if (rank==0)    printf ("Setting up device map and neighbor list \n");
+	ScaLBL_CopyToDevice(NeighborList, neighborList, neighborSize);
+	delete [] neighborList;
+	comm.barrier();
+	ScaLBL_MemoryReport(comm, "NonNewtonian model");
+}
+
+void ScaLBL_NonNewtonianModel::Initialize(){
+	/*
+	 * This function initializes model
+	 */
+	// the first collision sets the viscosity for the shear rate of the fluid at rest
+	double nu = std::min( std::max( nu_0, nu_min ), nu_max );
+	std::vector<double> viscosity( Np, nu );
+	if (Restart == true){
+		if (rank==0){
+			printf("Initializing distributions from Restart! \n");
+		}
+		std::vector<double> cfq( 19*size_t(Np) );
+		ifstream File(LocalRestartFile,ios::binary);
+		INSIST( File.good(), std::string("Unable to open ") + LocalRestartFile );
+		size_t bytes = 0;
+		File.read( (char*) cfq.data(), 19*size_t(Np)*sizeof(double) );
+		bytes += File.gcount();
+		File.read( (char*) viscosity.data(), size_t(Np)*sizeof(double) );
+		bytes += File.gcount();
+		File.close();
+		INSIST( bytes == 20*size_t(Np)*sizeof(double), std::string("Short read of the restart file ") + LocalRestartFile );
+		ScaLBL_CopyToDevice(fq, cfq.data(), 19*Np*sizeof(double));
+		if (nonnewtonian_db->keyExists( "timestep" )){
+			timestep = nonnewtonian_db->getScalar<int>( "timestep" );
+		}
+	}
+	else{
+		if (rank==0)    printf ("Initializing distributions \n");
+		ScaLBL_D3Q19_Init(fq, Np);
+	}
+	ScaLBL_CopyToDevice(Viscosity, viscosity.data(), Np*sizeof(double));
+	ScaLBL_DeviceBarrier();
+	comm.barrier();
+}
+
+void ScaLBL_NonNewtonianModel::WriteRestart(){
+	// rank 0 writes the input database that restarts from this timestep
+	if (rank==0){
+		auto current_db = db->cloneDatabase();
+		auto restart_db = current_db->getDatabase( "NonNewtonian" );
+		restart_db->putScalar<int>( "timestep", timestep );
+		restart_db->putScalar<bool>( "Restart", true );
+		std::ofstream OutStream("Restart.db");
+		current_db->print(OutStream, "");
+		OutStream.close();
+	}
+	// distributions followed by the viscosity of each site
+	std::vector<double> cfq( 19*size_t(Np) ), viscosity( Np );
+	ScaLBL_CopyToHost(cfq.data(), fq, 19*Np*sizeof(double));
+	ScaLBL_CopyToHost(viscosity.data(), Viscosity, Np*sizeof(double));
+	FILE *RESTARTFILE;
+	RESTARTFILE=fopen(LocalRestartFile,"wb");
+	fwrite(cfq.data(),sizeof(double),19*size_t(Np),RESTARTFILE);
+	fwrite(viscosity.data(),sizeof(double),Np,RESTARTFILE);
+	fclose(RESTARTFILE);
+	comm.barrier();
+}
+
+void ScaLBL_NonNewtonianModel::Run(){
+	int visualization_interval = 0;
+	if (db->keyExists( "Analysis" )){
+		visualization_interval = db->getDatabase( "Analysis" )->getWithDefault<int>( "visualization_interval", 0 );
+	}
+
+	if (rank==0){
+		bool WriteHeader=false;
+		FILE *log_file = fopen("NonNewtonian.csv","r");
+		if (log_file != NULL)
+			fclose(log_file);
+		else
+			WriteHeader=true;
+
+		if (WriteHeader){
+			log_file = fopen("NonNewtonian.csv","a+");
+			fprintf(log_file,"time Fx Fy Fz vx vy vz mu k\n");
+			fclose(log_file);
+		}
+	}
+
+	//.......create and start timer............
+	ScaLBL_DeviceBarrier(); comm.barrier();
+	if (rank==0) printf("Beginning AA timesteps, timestepMax = %i \n", timestepMax);
+	if (rank==0) printf("********************************************************\n");
+	int timestep_start = timestep;
+	double error = 1.0;
+	double flow_rate_previous = 0.0;
+    auto t1 = std::chrono::system_clock::now();
+	while (timestep < timestepMax && error > tolerance) {
+		//************************************************************************/
+		timestep++;
+		ScaLBL_Comm->SendD3Q19AA(fq); //READ FROM NORMAL
+		ScaLBL_D3Q19_AAodd_NonNewtonianMRT(NeighborList, fq, Viscosity, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np,
+				rheology, nu_0, nu_inf, lambda, n_index, nu_min, nu_max, Fx, Fy, Fz);
+		ScaLBL_Comm->RecvD3Q19AA(fq); //WRITE INTO OPPOSITE
+		// Set boundary conditions
+		if (BoundaryCondition == 3){
+			ScaLBL_Comm->D3Q19_Pressure_BC_z(NeighborList, fq, din, timestep);
+			ScaLBL_Comm->D3Q19_Pressure_BC_Z(NeighborList, fq, dout, timestep);
+		}
+		else if (BoundaryCondition == 4){
+			din = ScaLBL_Comm->D3Q19_Flux_BC_z(NeighborList, fq, flux, timestep);
+			ScaLBL_Comm->D3Q19_Pressure_BC_Z(NeighborList, fq, dout, timestep);
+		}
+		else if (BoundaryCondition == 5){
+			ScaLBL_Comm->D3Q19_Reflection_BC_z(fq);
+			ScaLBL_Comm->D3Q19_Reflection_BC_Z(fq);
+		}
+		ScaLBL_D3Q19_AAodd_NonNewtonianMRT(NeighborList, fq, Viscosity, 0, ScaLBL_Comm->LastExterior(), Np,
+				rheology, nu_0, nu_inf, lambda, n_index, nu_min, nu_max, Fx, Fy, Fz);
+		ScaLBL_DeviceBarrier(); comm.barrier();
+		timestep++;
+		ScaLBL_Comm->SendD3Q19AA(fq); //READ FORM NORMAL
+		// the collision sums the flow statistics on analysis steps
+		bool analysis = (timestep%analysis_interval==0);
+		double stats[SCALBL_NONNEWTONIAN_STATS] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+		if (analysis){
+			ScaLBL_CopyToDevice(FlowStats, stats, SCALBL_NONNEWTONIAN_STATS*sizeof(double));
+			ScaLBL_D3Q19_AAeven_NonNewtonianMRT_Stats(fq, Viscosity, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np,
+					rheology, nu_0, nu_inf, lambda, n_index, nu_min, nu_max, Fx, Fy, Fz, FlowStats);
+		}
+		else
+			ScaLBL_D3Q19_AAeven_NonNewtonianMRT(fq, Viscosity, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np,
+					rheology, nu_0, nu_inf, lambda, n_index, nu_min, nu_max, Fx, Fy, Fz);
+		ScaLBL_Comm->RecvD3Q19AA(fq); //WRITE INTO OPPOSITE
+		// Set boundary conditions
+		if (BoundaryCondition == 3){
+			ScaLBL_Comm->D3Q19_Pressure_BC_z(NeighborList, fq, din, timestep);
+			ScaLBL_Comm->D3Q19_Pressure_BC_Z(NeighborList, fq, dout, timestep);
+		}
+		else if (BoundaryCondition == 4){
+			din = ScaLBL_Comm->D3Q19_Flux_BC_z(NeighborList, fq, flux, timestep);
+			ScaLBL_Comm->D3Q19_Pressure_BC_Z(NeighborList, fq, dout, timestep);
+		}
+		else if (BoundaryCondition == 5){
+			ScaLBL_Comm->D3Q19_Reflection_BC_z(fq);
+			ScaLBL_Comm->D3Q19_Reflection_BC_Z(fq);
+		}
+		if (analysis)
+			ScaLBL_D3Q19_AAeven_NonNewtonianMRT_Stats(fq, Viscosity, 0, ScaLBL_Comm->LastExterior(), Np,
+					rheology, nu_0, nu_inf, lambda, n_index, nu_min, nu_max, Fx, Fy, Fz, FlowStats);
+		else
+			ScaLBL_D3Q19_AAeven_NonNewtonianMRT(fq, Viscosity, 0, ScaLBL_Comm->LastExterior(), Np,
+					rheology, nu_0, nu_inf, lambda, n_index, nu_min, nu_max, Fx, Fy, Fz);
+		ScaLBL_DeviceBarrier(); comm.barrier();
+		//************************************************************************/
+
+		if (analysis){
+			// momentum, viscosity and site count of the pore space from the collision
+			ScaLBL_CopyToHost(stats, FlowStats, SCALBL_NONNEWTONIAN_STATS*sizeof(double));
+			double sums[SCALBL_NONNEWTONIAN_STATS];
+			comm.sumReduce( stats, sums, SCALBL_NONNEWTONIAN_STATS );
+			double count = sums[0];
+			double vax = sums[2]/count;
+			double vay = sums[3]/count;
+			double vaz = sums[4]/count;
+			mean_viscosity = sums[6]/count;
+
+			double force_mag = sqrt(Fx*Fx+Fy*Fy+Fz*Fz);
+			double dir_x = Fx/force_mag;
+			double dir_y = Fy/force_mag;
+			double dir_z = Fz/force_mag;
+			if (force_mag == 0.0){
+				// default to z direction
+				dir_x = 0.0;
+				dir_y = 0.0;
+				dir_z = 1.0;
+				force_mag = 1.0;
+			}
+			double flow_rate = (vax*dir_x + vay*dir_y + vaz*dir_z);
+
+			error = fabs(flow_rate - flow_rate_previous) / fabs(flow_rate);
+			flow_rate_previous = flow_rate;
+
+			double h = Dm->voxel_length;
+			absperm = h*h*mean_viscosity*Mask->Porosity()*flow_rate / force_mag;
+			if (rank==0) printf("     %f (mean viscosity %f)\n",absperm,mean_viscosity);
+			if (rank==0) {
+				FILE * log_file = fopen("NonNewtonian.csv","a");
+				fprintf(log_file,"%i %.8g %.8g %.8g %.8g %.8g %.8g %.8g %.8g\n",timestep, Fx, Fy, Fz,
+						vax,vay,vaz, mean_viscosity, absperm);
+				fclose(log_file);
+			}
+		}
+		if (visualization_interval > 0 && timestep%visualization_interval==0){
+			VelocityField();
+		}
+		if (restart_interval > 0 && timestep%restart_interval==0){
+			WriteRestart();
+		}
+	}
+	//************************************************************************/
+	if (rank==0) printf("-------------------------------------------------------------------\n");
+	// Compute the walltime per timestep
+    auto t2 = std::chrono::system_clock::now();
+	double cputime = std::chrono::duration<double>( t2 - t1 ).count() / std::max( timestep-timestep_start, 1 );
+	// Performance obtained from each node
+	double MLUPS = double(Np)/cputime/1000000;
+
+	if (rank==0) printf("********************************************************\n");
+	if (rank==0) printf("CPU time = %f \n", cputime);
+	if (rank==0) printf("Lattice update rate (per core)= %f MLUPS \n", MLUPS);
+	MLUPS *= nprocs;
+	if (rank==0) printf("Lattice update rate (total)= %f MLUPS \n", MLUPS);
+	if (rank==0) printf("********************************************************\n");
+}
+
+void ScaLBL_NonNewtonianModel::VelocityField(){
+	// velocity and viscosity in the regular layout
+	ScaLBL_D3Q19_Momentum(fq, Velocity, Np);
+	ScaLBL_DeviceBarrier(); comm.barrier();
+	ScaLBL_Comm->RegularLayout(Map, &Velocity[0], Velocity_x);
+	ScaLBL_Comm->RegularLayout(Map, &Velocity[Np], Velocity_y);
+	ScaLBL_Comm->RegularLayout(Map, &Velocity[2*Np], Velocity_z);
+	ScaLBL_Comm->RegularLayout(Map, Viscosity, Viscosity_field);
+
+	if (!db->keyExists( "Visualization" ))
+		return;
+	vis_db = db->getDatabase( "Visualization" );
+	if (vis_db->getWithDefault<bool>( "write_silo", false )){
+		std::vector<IO::MeshDataStruct> visData;
+		fillHalo<double> fillData(Dm->Comm,Dm->rank_info,{Dm->Nx-2,Dm->Ny-2,Dm->Nz-2},{1,1,1},0,1);
+
+		IO::initialize("","silo","false");
+		// Create the MeshDataStruct
+		visData.resize(1);
+		visData[0].meshName = "domain";
+		visData[0].mesh = std::make_shared<IO::DomainMesh>( Dm->rank_info,Dm->Nx-2,Dm->Ny-2,Dm->Nz-2,Dm->Lx,Dm->Ly,Dm->Lz );
+		const char *names[5] = { "SignDist", "Velocity_x", "Velocity_y", "Velocity_z", "Viscosity" };
+		DoubleArray *fields[5] = { &Distance, &Velocity_x, &Velocity_y, &Velocity_z, &Viscosity_field };
+		for (int m=0; m<5; m++){
+			auto var = std::make_shared<IO::Variable>();
+			var->name = names[m];
+			var->type = IO::VariableType::VolumeVariable;
+			var->dim = 1;
+			var->data.resize(Dm->Nx-2,Dm->Ny-2,Dm->Nz-2);
+			fillData.copy(*fields[m],var->data);
+			visData[0].vars.push_back(var);
+		}
+		IO::writeData( timestep, visData, Dm->Comm );
+	}
+}
@@ -0,0 +1,100 @@
+/*
+  Copyright Equnior ASA
+
+  This file is part of the Open Porous Media project (OPM).
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*
+ * Single-phase flow of a generalized Newtonian fluid (MRT with shear-rate dependent viscosity)
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <iostream>
+#include <exception>
+#include <stdexcept>
+#include <fstream>
+
+#include "common/ScaLBL.h"
+#include "common/Communication.h"
+#include "common/MPI.h"
+#include "IO/MeshDatabase.h"
+#include "IO/Writer.h"
+#include "ProfilerApp.h"
+
+class ScaLBL_NonNewtonianModel{
+public:
+	ScaLBL_NonNewtonianModel(int RANK, int NP, const Utilities::MPI& COMM);
+	~ScaLBL_NonNewtonianModel();
+
+	// functions in they should be run
+	void ReadParams(string filename);
+	void ReadParams(std::shared_ptr<Database> db0);
+	void SetDomain();
+	void ReadInput();
+	void Create();
+	void Initialize();
+	void Run();
+	void VelocityField();
+
+	bool Restart;
+	int timestep,timestepMax;
+	int analysis_interval;      // timesteps between convergence checks
+	int restart_interval;       // timesteps between writing the restart files
+	int BoundaryCondition;
+	// rheology (NonNewtonian { rheology = "power_law" or "carreau" }, see ScaLBL.h)
+	int rheology;
+	double nu_0,nu_inf,lambda,n_index;
+	double nu_min,nu_max;       // limits of the viscosity (from tau_min and tau_max)
+	double Fx,Fy,Fz,flux;
+	double din,dout;
+	double tolerance;
+	double mean_viscosity;      // mean viscosity of the pore space from the last analysis step of Run()
+	double absperm;             // apparent permeability (with the mean viscosity) from the last analysis step
+
+	int Nx,Ny,Nz,N,Np;
+	int rank,nprocx,nprocy,nprocz,nprocs;
+	double Lx,Ly,Lz;
+
+	std::shared_ptr<Domain> Dm;   // this domain is for analysis
+	std::shared_ptr<Domain> Mask; // this domain is for lbm
+	std::shared_ptr<ScaLBL_Communicator> ScaLBL_Comm;
+    // input database
+    std::shared_ptr<Database> db;
+    std::shared_ptr<Database> domain_db;
+    std::shared_ptr<Database> nonnewtonian_db;
+    std::shared_ptr<Database> vis_db;
+
+    IntArray Map;
+    DoubleArray Distance;
+    int *NeighborList;
+    double *fq;
+    double *Viscosity;
+    double *Velocity;
+    // flow statistics summed by the collision on analysis steps (SCALBL_NONNEWTONIAN_STATS values)
+    double *FlowStats;
+
+    DoubleArray Velocity_x;
+    DoubleArray Velocity_y;
+    DoubleArray Velocity_z;
+    DoubleArray Viscosity_field;
+private:
+    Utilities::MPI comm;
+
+	// filenames
+    char LocalRankString[8];
+    char LocalRankFilename[40];
+    char LocalRestartFile[40];
+
+    void ComputeDistance();
+    void WriteRestart();
+};
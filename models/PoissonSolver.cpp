@@ -135,9 +135,33 @@ void ScaLBL_Poisson::ReadParams(string filename){
           break;
     }
 }
+void ScaLBL_Poisson::AttachLattice(std::shared_ptr<ScaLBL_LatticeTopology> lattice){
+	Lattice = lattice;
+}
+
 void ScaLBL_Poisson::SetDomain(){
-	Dm  = std::shared_ptr<Domain>(new Domain(domain_db,comm));      // full domain for analysis
-	Mask  = std::shared_ptr<Domain>(new Domain(domain_db,comm));    // mask domain removes immobile phases
+    int BoundaryCondition = 0;
+    if (BoundaryConditionInlet==0 && BoundaryConditionOutlet==0){
+        BoundaryCondition = 0;
+    }
+    else if (BoundaryConditionInlet>0 && BoundaryConditionOutlet>0){
+        BoundaryCondition = 1;
+    }
+    else {//i.e. non-periodic and periodic BCs are mixed
+        ERROR("Error: check the type of inlet and outlet boundary condition! Mixed periodic and non-periodic BCs are found!\n");
+    }
+	if (Lattice && !Lattice->Compatible(domain_db,BoundaryCondition)){
+		if (rank==0) printf("LB-Poisson Solver: domain or boundary condition differs from the shared lattice \n");
+		Lattice.reset();
+	}
+	if (Lattice){
+		Dm = Lattice->Dm;
+		Mask = Lattice->Mask;
+	}
+	else {
+		Dm  = std::shared_ptr<Domain>(new Domain(domain_db,comm));      // full domain for analysis
+		Mask  = std::shared_ptr<Domain>(new Domain(domain_db,comm));    // mask domain removes immobile phases
+	}
 
 	// domain parameters
 	Nx = Dm->Nx;
@@ -148,24 +172,17 @@ void ScaLBL_Poisson::SetDomain(){
 	Lz = Dm->Lz;
 	
 	N = Nx*Ny*Nz;
-	Distance.resize(Nx,Ny,Nz);
 	Psi_host.resize(Nx,Ny,Nz);
 
-	for (int i=0; i<Nx*Ny*Nz; i++) Dm->id[i] = 1;               // initialize this way
-	//Averages = std::shared_ptr<TwoPhase> ( new TwoPhase(Dm) ); // TwoPhase analysis object
-	comm.barrier();
-    if (BoundaryConditionInlet==0 && BoundaryConditionOutlet==0){
-        Dm->BoundaryCondition   = 0;
-        Mask->BoundaryCondition = 0;
-    }
-    else if (BoundaryConditionInlet>0 && BoundaryConditionOutlet>0){
-        Dm->BoundaryCondition   = 1;
-        Mask->BoundaryCondition = 1;
-    }
-    else {//i.e. non-periodic and periodic BCs are mixed
-        ERROR("Error: check the type of inlet and outlet boundary condition! Mixed periodic and non-periodic BCs are found!\n");
-    }
-	Dm->CommInit();
+	if (!Lattice){
+		Distance.resize(Nx,Ny,Nz);
+		for (int i=0; i<Nx*Ny*Nz; i++) Dm->id[i] = 1;               // initialize this way
+		//Averages = std::shared_ptr<TwoPhase> ( new TwoPhase(Dm) ); // TwoPhase analysis object
+		comm.barrier();
+		Dm->BoundaryCondition   = BoundaryCondition;
+		Mask->BoundaryCondition = BoundaryCondition;
+		Dm->CommInit();
+	}
 	comm.barrier();
 	
 	rank = Dm->rank();	
@@ -180,6 +197,11 @@ void ScaLBL_Poisson::ReadInput(){
     sprintf(LocalRankFilename,"%s%s","ID.",LocalRankString);
     sprintf(LocalRestartFile,"%s%s","Restart.",LocalRankString);
 
+    if (Lattice){
+    	// the image and signed distance are read once by the shared lattice
+    	Distance.view2(Lattice->Distance);
+    	return;
+    }
     
     if (domain_db->keyExists( "Filename" )){
     	auto Filename = domain_db->getScalar<std::string>( "Filename" );
@@ -304,24 +326,37 @@ void ScaLBL_Poisson::Create(){
 	 *  This function creates the variables needed to run a LBM 
 	 */
 	int rank=Mask->rank();
-	//.........................................................
-	// Initialize communication structures in averaging domain
-	for (int i=0; i<Nx*Ny*Nz; i++) Dm->id[i] = Mask->id[i];
-	Mask->CommInit();
-	Np=Mask->PoreCount();
-	//...........................................................................
-	if (rank==0)    printf ("LB-Poisson Solver: Create ScaLBL_Communicator \n");
-	// Create a communicator for the device (will use optimized layout)
-	// ScaLBL_Communicator ScaLBL_Comm(Mask); // original
-	ScaLBL_Comm  = std::shared_ptr<ScaLBL_Communicator>(new ScaLBL_Communicator(Mask));
-	ScaLBL_Comm_Regular  = std::shared_ptr<ScaLBL_Communicator>(new ScaLBL_Communicator(Mask));
-
-	int Npad=(Np/16 + 2)*16;
-	if (rank==0)    printf ("LB-Poisson Solver: Set up memory efficient layout \n");
-	Map.resize(Nx,Ny,Nz);       Map.fill(-2);
-	auto neighborList= new int[18*Npad];
-	Np = ScaLBL_Comm->MemoryOptimizedLayoutAA(Map,neighborList,Mask->id.data(),Np,1);
-	comm.barrier();
+	int *neighborList = NULL;
+	if (Lattice){
+		// communicator, layout and neighbor list are shared with the other models
+		if (rank==0)    printf ("LB-Poisson Solver: Using the shared lattice topology \n");
+		Np = Lattice->Np;
+		ScaLBL_Comm = Lattice->ScaLBL_Comm;
+		Map.view2(Lattice->Map);
+		NeighborList = Lattice->NeighborList;
+		ScaLBL_Comm_Regular  = std::shared_ptr<ScaLBL_Communicator>(new ScaLBL_Communicator(Mask));
+	}
+	else {
+		//.........................................................
+		// Initialize communication structures in averaging domain
+		for (int i=0; i<Nx*Ny*Nz; i++) Dm->id[i] = Mask->id[i];
+		Mask->CommInit();
+		Np=Mask->PoreCount();
+		//...........................................................................
+		if (rank==0)    printf ("LB-Poisson Solver: Create ScaLBL_Communicator \n");
+		// Create a communicator for the device (will use optimized layout)
+		// ScaLBL_Communicator ScaLBL_Comm(Mask); // original
+		ScaLBL_Comm  = std::shared_ptr<ScaLBL_Communicator>(new ScaLBL_Communicator(Mask));
+		ScaLBL_Comm_Regular  = std::shared_ptr<ScaLBL_Communicator>(new ScaLBL_Communicator(Mask));
+
+		int Npad=(Np/16 + 2)*16;
+		if (rank==0)    printf ("LB-Poisson Solver: Set up memory efficient layout \n");
+		Map.resize(Nx,Ny,Nz);       Map.fill(-2);
+		neighborList= new int[18*Npad];
+		Np = ScaLBL_Comm->MemoryOptimizedLayoutAA(Map,neighborList,Mask->id.data(),Np,1);
+		comm.barrier();
+		ScaLBL_AllocateDeviceMemory((void **) &NeighborList, 18*(Np*sizeof(int)), "NeighborList");
+	}
 
 	//...........................................................................
 	//                MAIN  VARIABLES ALLOCATED HERE
@@ -332,12 +367,11 @@ void ScaLBL_Poisson::Create(){
 	int dist_mem_size = Np*sizeof(double);
 	int neighborSize=18*(Np*sizeof(int));
 	//...........................................................................
-	ScaLBL_AllocateDeviceMemory((void **) &NeighborList, neighborSize);
-	ScaLBL_AllocateDeviceMemory((void **) &dvcMap, sizeof(int)*Np);
+	ScaLBL_AllocateDeviceMemory((void **) &dvcMap, sizeof(int)*Np, "dvcMap");
 	//ScaLBL_AllocateDeviceMemory((void **) &dvcID, sizeof(signed char)*Nx*Ny*Nz);
-	ScaLBL_AllocateDeviceMemory((void **) &fq, 7*dist_mem_size);  
-	ScaLBL_AllocateDeviceMemory((void **) &Psi, sizeof(double)*Nx*Ny*Nz);
-	ScaLBL_AllocateDeviceMemory((void **) &ElectricField, 3*sizeof(double)*Np);
+	ScaLBL_AllocateDeviceMemory((void **) &fq, 7*dist_mem_size, "fq");  
+	ScaLBL_AllocateDeviceMemory((void **) &Psi, sizeof(double)*Nx*Ny*Nz, "Psi");
+	ScaLBL_AllocateDeviceMemory((void **) &ElectricField, 3*sizeof(double)*Np, "ElectricField");
 	//...........................................................................
 	
 	// Update GPU data structures
@@ -373,17 +407,21 @@ void ScaLBL_Poisson::Create(){
 	ScaLBL_Comm->Barrier();
 	delete [] TmpMap;
 	// copy the neighbor list 
-	ScaLBL_CopyToDevice(NeighborList, neighborList, neighborSize);
-	ScaLBL_Comm->Barrier();
-	comm.barrier();
-	delete [] neighborList;
+	if (neighborList){
+		ScaLBL_CopyToDevice(NeighborList, neighborList, neighborSize);
+		ScaLBL_Comm->Barrier();
+		comm.barrier();
+		delete [] neighborList;
+	}
     // copy node ID
 	//ScaLBL_CopyToDevice(dvcID, Mask->id, sizeof(signed char)*Nx*Ny*Nz);
 	//ScaLBL_Comm->Barrier();
 	
     //Initialize solid boundary for electric potential
-    ScaLBL_Comm->SetupBounceBackList(Map, Mask->id.data(), Np);
+    if (Lattice) Lattice->SetupBounceBackList();
+    else ScaLBL_Comm->SetupBounceBackList(Map, Mask->id.data(), Np);
 	comm.barrier();
+	ScaLBL_MemoryReport(comm, "Poisson solver");
 }        
 
 void ScaLBL_Poisson::Potential_Init(double *psi_init){
@@ -578,8 +616,10 @@ void ScaLBL_Poisson::Run(double *ChargeDensity, int timestep_from_Study){
 					}
 				}
 			}
-			psi_avg=Dm->Comm.sumReduce(  psi_loc);
-			count=Dm->Comm.sumReduce(  count_loc);
+			Utilities::MPI::Accumulator sums( Dm->Comm );
+			sums.sum( psi_avg, psi_loc );
+			sums.sum( count, count_loc );
+			sums.reduce();
 
 			psi_avg /= count;
             double psi_avg_mag=psi_avg;
@@ -717,7 +757,7 @@ void ScaLBL_Poisson::DummyChargeDensity(){
             }
         }
     }
-	ScaLBL_AllocateDeviceMemory((void **) &ChargeDensityDummy, sizeof(double)*Np);
+	ScaLBL_AllocateDeviceMemory((void **) &ChargeDensityDummy, sizeof(double)*Np, "ChargeDensityDummy");
 	ScaLBL_CopyToDevice(ChargeDensityDummy, ChargeDensity_host, sizeof(double)*Np);
 	ScaLBL_Comm->Barrier();
 	delete [] ChargeDensity_host;
@@ -15,6 +15,7 @@
 #include "common/Communication.h"
 #include "common/MPI.h"
 #include "analysis/Minkowski.h"
+#include "models/LatticeTopology.h"
 #include "ProfilerApp.h"
 
 #define _USE_MATH_DEFINES
@@ -29,6 +30,7 @@ public:
 	// functions in they should be run
 	void ReadParams(string filename);
 	void ReadParams(std::shared_ptr<Database> db0);
+	void AttachLattice(std::shared_ptr<ScaLBL_LatticeTopology> lattice);//call before SetDomain to share the image and layout
 	void SetDomain();
 	void ReadInput();
 	void Create();
@@ -70,6 +72,7 @@ public:
 	std::shared_ptr<Domain> Mask; // this domain is for lbm
 	std::shared_ptr<ScaLBL_Communicator> ScaLBL_Comm;
 	std::shared_ptr<ScaLBL_Communicator> ScaLBL_Comm_Regular;
+	std::shared_ptr<ScaLBL_LatticeTopology> Lattice;
     // input database
     std::shared_ptr<Database> db;
     std::shared_ptr<Database> domain_db;
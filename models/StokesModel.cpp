@@ -197,9 +197,23 @@ void ScaLBL_StokesModel::ReadParams(string filename){
     epsilon_LB = epsilon0_LB*epsilonR;//electric permittivity 
 }
 
+void ScaLBL_StokesModel::AttachLattice(std::shared_ptr<ScaLBL_LatticeTopology> lattice){
+	Lattice = lattice;
+}
+
 void ScaLBL_StokesModel::SetDomain(){
-	Dm  = std::shared_ptr<Domain>(new Domain(domain_db,comm));      // full domain for analysis
-	Mask  = std::shared_ptr<Domain>(new Domain(domain_db,comm));    // mask domain removes immobile phases
+	if (Lattice && !Lattice->Compatible(domain_db,BoundaryCondition)){
+		if (rank==0) printf("LB Single-Fluid Solver: domain or boundary condition differs from the shared lattice \n");
+		Lattice.reset();
+	}
+	if (Lattice){
+		Dm = Lattice->Dm;
+		Mask = Lattice->Mask;
+	}
+	else {
+		Dm  = std::shared_ptr<Domain>(new Domain(domain_db,comm));      // full domain for analysis
+		Mask  = std::shared_ptr<Domain>(new Domain(domain_db,comm));    // mask domain removes immobile phases
+	}
 
 	// domain parameters
 	Nx = Dm->Nx;
@@ -210,17 +224,19 @@ void ScaLBL_StokesModel::SetDomain(){
 	Lz = Dm->Lz;
 	
 	N = Nx*Ny*Nz;
-	Distance.resize(Nx,Ny,Nz);
 	Velocity_x.resize(Nx,Ny,Nz);
 	Velocity_y.resize(Nx,Ny,Nz);
 	Velocity_z.resize(Nx,Ny,Nz);
 	
-	for (int i=0; i<Nx*Ny*Nz; i++) Dm->id[i] = 1;               // initialize this way
-	//Averages = std::shared_ptr<TwoPhase> ( new TwoPhase(Dm) ); // TwoPhase analysis object
-	comm.barrier();
-	Dm->BoundaryCondition = BoundaryCondition;
-	Mask->BoundaryCondition = BoundaryCondition;
-	Dm->CommInit();
+	if (!Lattice){
+		Distance.resize(Nx,Ny,Nz);
+		for (int i=0; i<Nx*Ny*Nz; i++) Dm->id[i] = 1;               // initialize this way
+		//Averages = std::shared_ptr<TwoPhase> ( new TwoPhase(Dm) ); // TwoPhase analysis object
+		comm.barrier();
+		Dm->BoundaryCondition = BoundaryCondition;
+		Mask->BoundaryCondition = BoundaryCondition;
+		Dm->CommInit();
+	}
 	comm.barrier();
 	
 	rank = Dm->rank();	
@@ -235,6 +251,11 @@ void ScaLBL_StokesModel::ReadInput(){
     sprintf(LocalRankFilename,"%s%s","ID.",LocalRankString);
     sprintf(LocalRestartFile,"%s%s","Restart.",LocalRankString);
 
+    if (Lattice){
+    	// the image and signed distance are read once by the shared lattice
+    	Distance.view2(Lattice->Distance);
+    	return;
+    }
     
     if (domain_db->keyExists( "Filename" )){
     	auto Filename = domain_db->getScalar<std::string>( "Filename" );
@@ -446,23 +467,41 @@ void ScaLBL_StokesModel::Create(){
 	 *  This function creates the variables needed to run a LBM 
 	 */
 	int rank=Mask->rank();
-	//.........................................................
-	// Initialize communication structures in averaging domain
-	for (int i=0; i<Nx*Ny*Nz; i++) Dm->id[i] = Mask->id[i];
-	Mask->CommInit();
-	Np=Mask->PoreCount();
-	//...........................................................................
-	if (rank==0)    printf ("LB Single-Fluid Solver: Create ScaLBL_Communicator \n");
-	// Create a communicator for the device (will use optimized layout)
-	// ScaLBL_Communicator ScaLBL_Comm(Mask); // original
-	ScaLBL_Comm  = std::shared_ptr<ScaLBL_Communicator>(new ScaLBL_Communicator(Mask));
-
-	int Npad=(Np/16 + 2)*16;
-	if (rank==0)    printf ("LB Single-Fluid Solver: Set up memory efficient layout \n");
-	Map.resize(Nx,Ny,Nz);       Map.fill(-2);
-	auto neighborList= new int[18*Npad];
-	Np = ScaLBL_Comm->MemoryOptimizedLayoutAA(Map,neighborList,Mask->id.data(),Np,1);
-	comm.barrier();
+	if (Lattice){
+		// communicator, layout and neighbor list are shared with the other models
+		if (rank==0)    printf ("LB Single-Fluid Solver: Using the shared lattice topology \n");
+		Np = Lattice->Np;
+		ScaLBL_Comm = Lattice->ScaLBL_Comm;
+		Map.view2(Lattice->Map);
+		NeighborList = Lattice->NeighborList;
+	}
+	else {
+		//.........................................................
+		// Initialize communication structures in averaging domain
+		for (int i=0; i<Nx*Ny*Nz; i++) Dm->id[i] = Mask->id[i];
+		Mask->CommInit();
+		Np=Mask->PoreCount();
+		//...........................................................................
+		if (rank==0)    printf ("LB Single-Fluid Solver: Create ScaLBL_Communicator \n");
+		// Create a communicator for the device (will use optimized layout)
+		// ScaLBL_Communicator ScaLBL_Comm(Mask); // original
+		ScaLBL_Comm  = std::shared_ptr<ScaLBL_Communicator>(new ScaLBL_Communicator(Mask));
+
+		int Npad=(Np/16 + 2)*16;
+		if (rank==0)    printf ("LB Single-Fluid Solver: Set up memory efficient layout \n");
+		Map.resize(Nx,Ny,Nz);       Map.fill(-2);
+		auto neighborList= new int[18*Npad];
+		Np = ScaLBL_Comm->MemoryOptimizedLayoutAA(Map,neighborList,Mask->id.data(),Np,1);
+		comm.barrier();
+		int neighborSize=18*(Np*sizeof(int));
+		ScaLBL_AllocateDeviceMemory((void **) &NeighborList, neighborSize, "NeighborList");
+		// Update GPU data structures
+		if (rank==0)    printf ("LB Single-Fluid Solver: Setting up device map and neighbor list \n");
+		// copy the neighbor list 
+		ScaLBL_CopyToDevice(NeighborList, neighborList, neighborSize);
+		delete [] neighborList;
+		comm.barrier();
+	}
 
 	//...........................................................................
 	//                MAIN  VARIABLES ALLOCATED HERE
@@ -471,26 +510,20 @@ void ScaLBL_StokesModel::Create(){
 	if (rank==0)    printf ("LB Single-Fluid Solver: Allocating distributions \n");
 	//......................device distributions.................................
 	int dist_mem_size = Np*sizeof(double);
-	int neighborSize=18*(Np*sizeof(int));
-	//...........................................................................
-	ScaLBL_AllocateDeviceMemory((void **) &NeighborList, neighborSize);
-	ScaLBL_AllocateDeviceMemory((void **) &fq, 19*dist_mem_size);  
-	ScaLBL_AllocateDeviceMemory((void **) &Pressure, sizeof(double)*Np);
-	ScaLBL_AllocateDeviceMemory((void **) &Velocity, 3*sizeof(double)*Np);
 	//...........................................................................
-	// Update GPU data structures
-	if (rank==0)    printf ("LB Single-Fluid Solver: Setting up device map and neighbor list \n");
-	// copy the neighbor list 
-	ScaLBL_CopyToDevice(NeighborList, neighborList, neighborSize);
+	ScaLBL_AllocateDeviceMemory((void **) &fq, 19*dist_mem_size, "fq");  
+	ScaLBL_AllocateDeviceMemory((void **) &Pressure, sizeof(double)*Np, "Pressure");
+	ScaLBL_AllocateDeviceMemory((void **) &Velocity, 3*sizeof(double)*Np, "Velocity");
 	comm.barrier();
 	
     if (UseSlippingVelBC==true){
-        ScaLBL_Comm->SetupBounceBackList(Map, Mask->id.data(), Np,1);
+        if (Lattice) Lattice->SetupBounceBackList();
+        else ScaLBL_Comm->SetupBounceBackList(Map, Mask->id.data(), Np,1);
         comm.barrier();
 
         //For slipping velocity BC, need zeta potential and solid unit normal vector
-	    ScaLBL_AllocateDeviceMemory((void **) &ZetaPotentialSolid, sizeof(double)*Nx*Ny*Nz);
-	    ScaLBL_AllocateDeviceMemory((void **) &SolidGrad, sizeof(double)*3*Np); //unit normal vector of solid nodes
+	    ScaLBL_AllocateDeviceMemory((void **) &ZetaPotentialSolid, sizeof(double)*Nx*Ny*Nz, "ZetaPotentialSolid");
+	    ScaLBL_AllocateDeviceMemory((void **) &SolidGrad, sizeof(double)*3*Np, "SolidGrad"); //unit normal vector of solid nodes
 
         double *ZetaPotentialSolid_host;
         ZetaPotentialSolid_host = new double[Nx*Ny*Nz];
@@ -504,6 +537,7 @@ void ScaLBL_StokesModel::Create(){
         delete [] ZetaPotentialSolid_host;
         delete [] SolidGrad_host;
     }
+    ScaLBL_MemoryReport(comm, "Stokes model");
 }        
 
 void ScaLBL_StokesModel::Initialize(){
@@ -684,10 +718,12 @@ vector<double> ScaLBL_StokesModel::computeElectricForceAvg(double *ChargeDensity
         count_loc+=1.0;
     }
 
-	Fx_avg=Dm->Comm.sumReduce(  Fx_loc);
-	Fy_avg=Dm->Comm.sumReduce(  Fy_loc);
-	Fz_avg=Dm->Comm.sumReduce(  Fz_loc);
-	count=Dm->Comm.sumReduce(  count_loc);
+	Utilities::MPI::Accumulator sums( Dm->Comm );
+	sums.sum( Fx_avg, Fx_loc );
+	sums.sum( Fy_avg, Fy_loc );
+	sums.sum( Fz_avg, Fz_loc );
+	sums.sum( count, count_loc );
+	sums.reduce();
 	
 	Fx_avg /= count;
 	Fy_avg /= count;
@@ -729,10 +765,12 @@ double ScaLBL_StokesModel::CalVelocityConvergence(double& flow_rate_previous,dou
 			}
 		}
 	}
-	vax=Dm->Comm.sumReduce(  vax_loc);
-	vay=Dm->Comm.sumReduce(  vay_loc);
-	vaz=Dm->Comm.sumReduce(  vaz_loc);
-	count=Dm->Comm.sumReduce(  count_loc);
+	Utilities::MPI::Accumulator sums( Dm->Comm );
+	sums.sum( vax, vax_loc );
+	sums.sum( vay, vay_loc );
+	sums.sum( vaz, vaz_loc );
+	sums.sum( count, count_loc );
+	sums.reduce();
 
 	vax /= count;
 	vay /= count;
@@ -862,10 +900,16 @@ void ScaLBL_StokesModel::Run(){
 				}
 			}
 			
-			vax=Dm->Comm.sumReduce(  vax_loc);
-			vay=Dm->Comm.sumReduce(  vay_loc);
-			vaz=Dm->Comm.sumReduce(  vaz_loc);
-			count=Dm->Comm.sumReduce(  count_loc);
+			// the velocity sums complete while the Minkowski functionals are computed
+			Utilities::MPI::Accumulator sums( Dm->Comm );
+			sums.sum( vax, vax_loc );
+			sums.sum( vay, vay_loc );
+			sums.sum( vaz, vaz_loc );
+			sums.sum( count, count_loc );
+			sums.start();
+			//if (rank==0) printf("Computing Minkowski functionals \n");
+			Morphology.ComputeScalar(Distance,0.f);
+			sums.finish();
 
 			
 			vax /= count;
@@ -888,18 +932,12 @@ void ScaLBL_StokesModel::Run(){
 			error = fabs(flow_rate - flow_rate_previous) / fabs(flow_rate);
 			flow_rate_previous = flow_rate;
 			
-			//if (rank==0) printf("Computing Minkowski functionals \n");
-			Morphology.ComputeScalar(Distance,0.f);
 			//Morphology.PrintAll();
 			double mu = (tau-0.5)/3.f;
-			double Vs = Morphology.V();
-			double As = Morphology.A();
-			double Hs = Morphology.H();
-			double Xs = Morphology.X();
-			Vs=Dm->Comm.sumReduce(  Vs);
-			As=Dm->Comm.sumReduce(  As);
-			Hs=Dm->Comm.sumReduce(  Hs);
-			Xs=Dm->Comm.sumReduce(  Xs);
+			double Vs = Morphology.Vi_global;
+			double As = Morphology.Ai_global;
+			double Hs = Morphology.Ji_global;
+			double Xs = Morphology.Xi_global;
 			double h = Dm->voxel_length;
 			double absperm = h*h*mu*Mask->Porosity()*flow_rate / force_mag;
 			if (rank==0) {
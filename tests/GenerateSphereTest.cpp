@@ -379,20 +379,22 @@ int main(int argc, char **argv)
 		// Read in sphere pack
 		//if (rank==1) printf("nspheres =%i \n",nspheres);
 		//.......................................................................
-		double *cx,*cy,*cz,*rad;
-		cx = new double[nspheres];
-		cy = new double[nspheres];
-		cz = new double[nspheres];
-		rad = new double[nspheres];
+		// The full list is only held by rank 0
+		std::vector<double> cx,cy,cz,rad;
+		if (rank == 0){
+			cx.resize(nspheres);
+			cy.resize(nspheres);
+			cz.resize(nspheres);
+			rad.resize(nspheres);
+		}
 		//.......................................................................
 		if (rank == 0)	printf("Reading the sphere packing \n");
-		if (rank == 0)	ReadSpherePacking(nspheres,cx,cy,cz,rad);
+		if (rank == 0)	ReadSpherePacking(nspheres,cx.data(),cy.data(),cz.data(),rad.data());
 		comm.barrier();
-		// Broadcast the sphere packing to all processes
-		comm.bcast(cx,nspheres,0);
-		comm.bcast(cy,nspheres,0);
-		comm.bcast(cz,nspheres,0);
-		comm.bcast(rad,nspheres,0);
+		// Send each process the spheres that overlap its sub-domain
+		std::vector<double> local_cx,local_cy,local_cz,local_rad;
+		DistributeSpherePacking(comm,nspheres,cx.data(),cy.data(),cz.data(),rad.data(),Lx,Ly,Lz,Nx,Ny,Nz,
+				nprocx,nprocy,nprocz,local_cx,local_cy,local_cz,local_rad);
 		//...........................................................................
 		comm.barrier();
 		if (rank == 0) cout << "Domain set." << endl;
@@ -411,7 +413,7 @@ int main(int argc, char **argv)
 		comm.bcast(&D,1,0);
 
 		//.......................................................................
-		SignedDistance(SignDist.data(),nspheres,cx,cy,cz,rad,Lx,Ly,Lz,Nx,Ny,Nz,
+		SignedDistance(SignDist.data(),local_rad.size(),local_cx.data(),local_cy.data(),local_cz.data(),local_rad.data(),Lx,Ly,Lz,Nx,Ny,Nz,
 				iproc,jproc,kproc,nprocx,nprocy,nprocz);
 		//.......................................................................
 		// Assign the phase ID field based on the signed distance
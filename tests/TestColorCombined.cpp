@@ -0,0 +1,174 @@
+//*************************************************************************
+// Compare the combined (phase field + collision) color kernel with the
+// two-kernel path and report the lattice update rate of both
+//*************************************************************************
+#include <stdio.h>
+#include <iostream>
+#include <math.h>
+#include "common/ScaLBL.h"
+#include "common/MPI.h"
+#include "models/ColorModel.h"
+
+using namespace std;
+
+static std::shared_ptr<Database> BubbleDatabase( int nprocs, int n, bool combined )
+{
+	int npx = 1, npy = 1;
+	if (nprocs == 2) npx = 2;
+	if (nprocs == 4) npx = npy = 2;
+	char text[2048];
+	sprintf(text,
+		"Color {\n"
+		"  tauA = 1.0; tauB = 1.0; rhoA = 1.0; rhoB = 1.0\n"
+		"  alpha = 1e-2; beta = 0.95\n"
+		"  F = 0, 0, 0\n"
+		"  Restart = false\n"
+		"  timestepMax = 100000\n"
+		"  ComponentLabels = 0\n"
+		"  ComponentAffinity = -1.0\n"
+		"  combined_kernel = %s\n"
+		"}\n"
+		"Domain {\n"
+		"  nproc = %i, %i, 1\n"
+		"  n = %i, %i, %i\n"
+		"  L = 1, 1, 1\n"
+		"  BC = 0\n"
+		"}\n"
+		"Analysis {\n"
+		"  blobid_interval = 1000000\n"
+		"  analysis_interval = 1000000\n"
+		"  subphase_analysis_interval = 1000000\n"
+		"  restart_interval = 1000000\n"
+		"  visualization_interval = 1000000\n"
+		"  restart_file = \"Restart\"\n"
+		"  N_threads = 0\n"
+		"  load_balance = \"independent\"\n"
+		"}\n"
+		"Visualization {\n"
+		"}\n"
+		"FlowAdaptor {\n"
+		"}\n",
+		combined ? "true" : "false", npx, npy, n, n, n );
+	return Database::createFromString( text );
+}
+
+static void InitializeBubble( ScaLBL_ColorModel &ColorModel, double BubbleRadius )
+{
+	int nprocx = ColorModel.Dm->nprocx();
+	int nprocy = ColorModel.Dm->nprocy();
+	int nprocz = ColorModel.Dm->nprocz();
+	int Nx = ColorModel.Dm->Nx;
+	int Ny = ColorModel.Dm->Ny;
+	int Nz = ColorModel.Dm->Nz;
+	for (int k=0;k<Nz;k++){
+		for (int j=0;j<Ny;j++){
+			for (int i=0;i<Nx;i++){
+				int n = k*Nx*Ny + j*Nx + i;
+				double iglobal= double(i+(Nx-2)*ColorModel.Dm->iproc())-double((Nx-2)*nprocx)*0.5;
+				double jglobal= double(j+(Ny-2)*ColorModel.Dm->jproc())-double((Ny-2)*nprocy)*0.5;
+				double kglobal= double(k+(Nz-2)*ColorModel.Dm->kproc())-double((Nz-2)*nprocz)*0.5;
+				if ((iglobal*iglobal)+(jglobal*jglobal)+(kglobal*kglobal) < BubbleRadius*BubbleRadius)
+					ColorModel.Mask->id[n] = 2;
+				else
+					ColorModel.Mask->id[n] = 1;
+				ColorModel.id[n] = ColorModel.Mask->id[n];
+				ColorModel.Dm->id[n] = ColorModel.Mask->id[n];
+			}
+		}
+	}
+}
+
+static void ComponentMass( const ScaLBL_ColorModel &ColorModel, const Utilities::MPI &comm, double &massA, double &massB )
+{
+	int Np = ColorModel.Np;
+	std::vector<double> Den(2*Np);
+	ScaLBL_CopyToHost( Den.data(), ColorModel.Den, 2*Np*sizeof(double) );
+	double localA = 0.0, localB = 0.0;
+	for (int idx=0; idx<ColorModel.ScaLBL_Comm->LastExterior(); idx++){
+		localA += Den[idx];
+		localB += Den[Np+idx];
+	}
+	for (int idx=ColorModel.ScaLBL_Comm->FirstInterior(); idx<ColorModel.ScaLBL_Comm->LastInterior(); idx++){
+		localA += Den[idx];
+		localB += Den[Np+idx];
+	}
+	massA = comm.sumReduce( localA );
+	massB = comm.sumReduce( localB );
+}
+
+// Run the bubble and return the lattice update rate, the final phase field and the component masses
+static double RunBubble( const Utilities::MPI &comm, int n, int timesteps, bool combined,
+	DoubleArray &phase, double *initMass, double *finalMass )
+{
+	int rank = comm.getRank();
+	int nprocs = comm.getSize();
+	ScaLBL_ColorModel ColorModel(rank,nprocs,comm);
+	ColorModel.ReadParams( BubbleDatabase( nprocs, n, combined ) );
+	ColorModel.SetDomain();
+	InitializeBubble( ColorModel, 0.25*n );
+	ColorModel.Create();
+	ColorModel.Initialize();
+	ComponentMass( ColorModel, comm, initMass[0], initMass[1] );
+	double MLUPS = ColorModel.Run( timesteps );
+	ComponentMass( ColorModel, comm, finalMass[0], finalMass[1] );
+	ScaLBL_CopyToHost( phase.data(), ColorModel.Phi, ColorModel.N*sizeof(double) );
+	return MLUPS;
+}
+
+int main(int argc, char **argv)
+{
+	// Initialize MPI
+	Utilities::startup( argc, argv );
+	Utilities::MPI comm( MPI_COMM_WORLD );
+	int rank = comm.getRank();
+	int check=0;
+	{
+		int n = 32;
+		int timesteps = 200;
+		if (argc > 1) n = atoi(argv[1]);
+		if (argc > 2) timesteps = atoi(argv[2]);
+		if (rank == 0){
+			printf("********************************************************\n");
+			printf("Running Color Model: TestColorCombined (%i^3 per rank, %i timesteps)\n",n,timesteps);
+			printf("********************************************************\n");
+		}
+
+		DoubleArray phase1(n+2,n+2,n+2), phase2(n+2,n+2,n+2);
+		double init1[2], mass1[2], init2[2], mass2[2];
+		double MLUPS_split = RunBubble( comm, n, timesteps, false, phase1, init1, mass1 );
+		double MLUPS_combined = RunBubble( comm, n, timesteps, true, phase2, init2, mass2 );
+
+		// both paths conserve the mass of each component
+		for (int c=0; c<2; c++){
+			double err1 = fabs(mass1[c]-init1[c])/init1[c];
+			double err2 = fabs(mass2[c]-init2[c])/init2[c];
+			if (rank == 0) printf("Component %i mass error: two-kernel = %g, combined = %g \n",c,err1,err2);
+			if (err2 > 1e-10){
+				if (rank == 0) printf("Combined kernel does not conserve mass \n");
+				check++;
+			}
+		}
+		// the phase field agrees with the two-kernel path up to the half-step lag in the color gradient
+		double local_diff = 0.0;
+		for (int k=1; k<n+1; k++){
+			for (int j=1; j<n+1; j++){
+				for (int i=1; i<n+1; i++){
+					local_diff = max(local_diff, fabs(phase1(i,j,k)-phase2(i,j,k)));
+				}
+			}
+		}
+		double diff = comm.maxReduce( local_diff );
+		if (rank == 0){
+			printf("Max phase field difference = %g \n",diff);
+			printf("Two-kernel path: %f MLUPS \n",MLUPS_split);
+			printf("Combined kernel: %f MLUPS (speedup %f) \n",MLUPS_combined,MLUPS_combined/MLUPS_split);
+		}
+		if (diff > 0.05){
+			if (rank == 0) printf("Combined kernel phase field differs from the two-kernel path \n");
+			check++;
+		}
+	}
+	Utilities::shutdown();
+
+	return check;
+}
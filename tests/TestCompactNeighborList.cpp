@@ -0,0 +1,172 @@
+//*************************************************************************
+// Check the 16-bit neighbor list encoding: every link decodes to the entry
+// of the full neighbor list, and the MRT odd step gives identical results
+// with the full and compact neighbor lists
+//*************************************************************************
+#include <stdio.h>
+#include <iostream>
+#include <math.h>
+#include <algorithm>
+#include "common/ScaLBL.h"
+#include "common/MPI.h"
+
+using namespace std;
+
+static std::shared_ptr<Database> DomainDatabase( int nprocs, int n, const char *ordering )
+{
+	int npx = 1, npy = 1;
+	if (nprocs == 2) npx = 2;
+	if (nprocs == 4) npx = npy = 2;
+	char text[512];
+	sprintf(text,
+		"Domain {\n"
+		"  nproc = %i, %i, 1\n"
+		"  n = %i, %i, %i\n"
+		"  L = 1, 1, 1\n"
+		"  BC = 0\n"
+		"  interior_ordering = \"%s\"\n"
+		"}\n", npx, npy, n, n, n, ordering );
+	return Database::createFromString( text )->getDatabase( "Domain" );
+}
+
+// host version of the decoding used by the compact kernels
+static int DecodeNeighbor( const short *neighborDelta, const std::vector<int> &escapeList, int escapeCount, int n, int q, int Np )
+{
+	int delta = neighborDelta[q*Np+n];
+	if (delta == D3Q19_COMPACT_BOUNCEBACK) return ((q^1)+1)*Np + n;
+	if (delta == D3Q19_COMPACT_ESCAPE){
+		auto keys = escapeList.begin()+18;
+		auto it = std::lower_bound( keys, keys+escapeCount, q*Np+n );
+		return *(it+escapeCount);
+	}
+	return (q+1)*Np + n + escapeList[q] + delta;
+}
+
+static int CheckOrdering( const Utilities::MPI &comm, int n, const char *ordering )
+{
+	int rank = comm.getRank();
+	int check = 0;
+	auto Dm = std::make_shared<Domain>( DomainDatabase( comm.getSize(), n, ordering ), comm );
+	int Nx = Dm->Nx, Ny = Dm->Ny, Nz = Dm->Nz;
+	// porous medium: solid spheres on a regular lattice
+	int Np = 0;
+	for (int k=0; k<Nz; k++){
+		for (int j=0; j<Ny; j++){
+			for (int i=0; i<Nx; i++){
+				double x = (i%12)-5.5, y = (j%12)-5.5, z = (k%12)-5.5;
+				int idx = k*Nx*Ny + j*Nx + i;
+				Dm->id[idx] = ( x*x + y*y + z*z < 20.0 ) ? 0 : 1;
+				if (Dm->id[idx] > 0 && i>0 && j>0 && k>0 && i<Nx-1 && j<Ny-1 && k<Nz-1) Np++;
+			}
+		}
+	}
+	Dm->CommInit();
+	auto ScaLBL_Comm = std::shared_ptr<ScaLBL_Communicator>( new ScaLBL_Communicator( Dm ) );
+	int Npad = (Np/16 + 2)*16;
+	IntArray Map( Nx, Ny, Nz );	Map.fill( -2 );
+	auto neighborList = new int[18*Npad];
+	Np = ScaLBL_Comm->MemoryOptimizedLayoutAA( Map, neighborList, Dm->id.data(), Np, 1 );
+
+	// encode and check that each link decodes to the full neighbor list
+	auto neighborDelta = new short[18*Np];
+	std::vector<int> escapeList;
+	int escapeCount = ScaLBL_Comm->CompactNeighborList( neighborList, neighborDelta, escapeList, Np );
+	int errors = 0;
+	for (int q=0; q<18; q++){
+		for (int idx=0; idx<ScaLBL_Comm->LastExterior(); idx++)
+			if (DecodeNeighbor( neighborDelta, escapeList, escapeCount, idx, q, Np ) != neighborList[q*Np+idx]) errors++;
+		for (int idx=ScaLBL_Comm->FirstInterior(); idx<ScaLBL_Comm->LastInterior(); idx++)
+			if (DecodeNeighbor( neighborDelta, escapeList, escapeCount, idx, q, Np ) != neighborList[q*Np+idx]) errors++;
+	}
+	errors = comm.sumReduce( errors );
+	int escaped = comm.sumReduce( escapeCount );
+	int links = comm.sumReduce( 18*Np );
+	if (rank == 0) printf("%8s: %i of %i links escaped, %i decoding errors \n", ordering, escaped, links, errors);
+	if (errors > 0) check++;
+
+	// run the MRT model with both neighbor lists
+	int *NeighborList, *EscapeList;
+	short *NeighborDelta;
+	double *fq, *fq_compact;
+	ScaLBL_AllocateDeviceMemory( (void **) &NeighborList, 18*Np*sizeof(int) );
+	ScaLBL_AllocateDeviceMemory( (void **) &NeighborDelta, 18*Np*sizeof(short) );
+	ScaLBL_AllocateDeviceMemory( (void **) &EscapeList, escapeList.size()*sizeof(int) );
+	ScaLBL_AllocateDeviceMemory( (void **) &fq, 19*Np*sizeof(double) );
+	ScaLBL_AllocateDeviceMemory( (void **) &fq_compact, 19*Np*sizeof(double) );
+	ScaLBL_CopyToDevice( NeighborList, neighborList, 18*Np*sizeof(int) );
+	ScaLBL_CopyToDevice( NeighborDelta, neighborDelta, 18*Np*sizeof(short) );
+	ScaLBL_CopyToDevice( EscapeList, escapeList.data(), escapeList.size()*sizeof(int) );
+	ScaLBL_D3Q19_Init( fq, Np );
+	ScaLBL_D3Q19_Init( fq_compact, Np );
+	double rlx_setA = 1.0/0.7;
+	double rlx_setB = 8.f*(2.f-rlx_setA)/(8.f-rlx_setA);
+	double Fx = 1e-5, Fy = 2e-5, Fz = 3e-5;
+	for (int t=0; t<10; t++){
+		ScaLBL_Comm->SendD3Q19AA(fq);
+		ScaLBL_D3Q19_AAodd_MRT(NeighborList, fq, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np, rlx_setA, rlx_setB, Fx, Fy, Fz);
+		ScaLBL_Comm->RecvD3Q19AA(fq);
+		ScaLBL_D3Q19_AAodd_MRT(NeighborList, fq, 0, ScaLBL_Comm->LastExterior(), Np, rlx_setA, rlx_setB, Fx, Fy, Fz);
+		ScaLBL_Comm->Barrier();
+		ScaLBL_Comm->SendD3Q19AA(fq);
+		ScaLBL_D3Q19_AAeven_MRT(fq, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np, rlx_setA, rlx_setB, Fx, Fy, Fz);
+		ScaLBL_Comm->RecvD3Q19AA(fq);
+		ScaLBL_D3Q19_AAeven_MRT(fq, 0, ScaLBL_Comm->LastExterior(), Np, rlx_setA, rlx_setB, Fx, Fy, Fz);
+		ScaLBL_Comm->Barrier();
+
+		ScaLBL_Comm->SendD3Q19AA(fq_compact);
+		ScaLBL_D3Q19_AAodd_MRT_Compact(NeighborDelta, EscapeList, escapeCount, fq_compact, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np, rlx_setA, rlx_setB, Fx, Fy, Fz);
+		ScaLBL_Comm->RecvD3Q19AA(fq_compact);
+		ScaLBL_D3Q19_AAodd_MRT_Compact(NeighborDelta, EscapeList, escapeCount, fq_compact, 0, ScaLBL_Comm->LastExterior(), Np, rlx_setA, rlx_setB, Fx, Fy, Fz);
+		ScaLBL_Comm->Barrier();
+		ScaLBL_Comm->SendD3Q19AA(fq_compact);
+		ScaLBL_D3Q19_AAeven_MRT(fq_compact, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np, rlx_setA, rlx_setB, Fx, Fy, Fz);
+		ScaLBL_Comm->RecvD3Q19AA(fq_compact);
+		ScaLBL_D3Q19_AAeven_MRT(fq_compact, 0, ScaLBL_Comm->LastExterior(), Np, rlx_setA, rlx_setB, Fx, Fy, Fz);
+		ScaLBL_Comm->Barrier();
+	}
+	std::vector<double> f1( 19*Np ), f2( 19*Np );
+	ScaLBL_CopyToHost( f1.data(), fq, 19*Np*sizeof(double) );
+	ScaLBL_CopyToHost( f2.data(), fq_compact, 19*Np*sizeof(double) );
+	double diff = 0.0;
+	for (int q=0; q<19; q++){
+		for (int idx=0; idx<ScaLBL_Comm->LastExterior(); idx++)
+			diff = max( diff, fabs(f1[q*Np+idx]-f2[q*Np+idx]) );
+		for (int idx=ScaLBL_Comm->FirstInterior(); idx<ScaLBL_Comm->LastInterior(); idx++)
+			diff = max( diff, fabs(f1[q*Np+idx]-f2[q*Np+idx]) );
+	}
+	diff = comm.maxReduce( diff );
+	if (rank == 0) printf("          max difference in distributions = %g \n", diff);
+	if (diff > 0.0) check++;
+
+	ScaLBL_FreeDeviceMemory( NeighborList );
+	ScaLBL_FreeDeviceMemory( NeighborDelta );
+	ScaLBL_FreeDeviceMemory( EscapeList );
+	ScaLBL_FreeDeviceMemory( fq );
+	ScaLBL_FreeDeviceMemory( fq_compact );
+	delete [] neighborList;
+	delete [] neighborDelta;
+	return check;
+}
+
+int main(int argc, char **argv)
+{
+	// Initialize MPI
+	Utilities::startup( argc, argv );
+	Utilities::MPI comm( MPI_COMM_WORLD );
+	int rank = comm.getRank();
+	int check=0;
+	{
+		if (rank == 0){
+			printf("********************************************************\n");
+			printf("Running unit test: TestCompactNeighborList	\n");
+			printf("********************************************************\n");
+		}
+		int n = 48;
+		if (argc > 1) n = atoi(argv[1]);
+		check += CheckOrdering( comm, n, "raster" );
+		check += CheckOrdering( comm, n, "hilbert" );
+	}
+	Utilities::shutdown();
+
+	return check;
+}
@@ -0,0 +1,173 @@
+//*************************************************************************
+// Check the median, non-local means and imfilter kernels against direct
+// (reference) implementations, serial and threaded
+//*************************************************************************
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include <iostream>
+#include "analysis/filters.h"
+#include "analysis/imfilter.h"
+#include "common/MPI.h"
+
+using namespace std;
+
+// Reference median filter (selection sort of the 3x3x3 window)
+static void Med3D_ref( const Array<float> &Input, Array<float> &Output )
+{
+	int Nx = Input.size(0), Ny = Input.size(1), Nz = Input.size(2);
+	float List[27];
+	for (int k=1; k<Nz-1; k++){
+		for (int j=1; j<Ny-1; j++){
+			for (int i=1; i<Nx-1; i++){
+				int Number=0;
+				for (int kk=k-1; kk<k+2; kk++)
+					for (int jj=j-1; jj<j+2; jj++)
+						for (int ii=i-1; ii<i+2; ii++)
+							List[Number++] = Input(ii,jj,kk);
+				for (int ii=0; ii<14; ii++){
+					for (int jj=ii+1; jj<27; jj++){
+						if (List[jj] < List[ii]) std::swap(List[ii],List[jj]);
+					}
+				}
+				Output(i,j,k) = List[13];
+			}
+		}
+	}
+}
+
+// Reference non-local means (direct sums over the search window)
+static int NLM3D_ref( const Array<float> &Input, Array<float> &Mean,
+	const Array<float> &Distance, Array<float> &Output, const int d, const float h )
+{
+	int Nx = Input.size(0), Ny = Input.size(1), Nz = Input.size(2);
+	int count = 0;
+	for (int k=1; k<Nz-1; k++){
+		for (int j=1; j<Ny-1; j++){
+			for (int i=1; i<Nx-1; i++){
+				double sum = 0, weight = 0;
+				for (int kk=max(0,k-d); kk<min(Nz-1,k+d); kk++)
+					for (int jj=max(0,j-d); jj<min(Ny-1,j+d); jj++)
+						for (int ii=max(0,i-d); ii<min(Nx-1,i+d); ii++){
+							sum += Input(ii,jj,kk);
+							weight++;
+						}
+				Mean(i,j,k) = sum / weight;
+			}
+		}
+	}
+	for (int k=1; k<Nz-1; k++){
+		for (int j=1; j<Ny-1; j++){
+			for (int i=1; i<Nx-1; i++){
+				if (fabs(Distance(i,j,k)) < float(d)){
+					double sum = 0, weight = 0;
+					for (int kk=max(0,k-d); kk<min(Nz-1,k+d); kk++)
+						for (int jj=max(0,j-d); jj<min(Ny-1,j+d); jj++)
+							for (int ii=max(0,i-d); ii<min(Nx-1,i+d); ii++){
+								double tmp = Mean(i,j,k) - Mean(ii,jj,kk);
+								sum += exp(-tmp*tmp*h)*Input(ii,jj,kk);
+								weight += exp(-tmp*tmp*h);
+							}
+					Output(i,j,k) = sum / weight;
+					count++;
+				}
+				else {
+					Output(i,j,k) = Mean(i,j,k);
+				}
+			}
+		}
+	}
+	return count;
+}
+
+static double MaxDiff( const Array<float> &A, const Array<float> &B, int halo )
+{
+	double diff = 0.0;
+	for (size_t k=halo; k<A.size(2)-halo; k++)
+		for (size_t j=halo; j<A.size(1)-halo; j++)
+			for (size_t i=halo; i<A.size(0)-halo; i++)
+				diff = max( diff, fabs( double(A(i,j,k)) - double(B(i,j,k)) ) );
+	return diff;
+}
+
+static double Time( std::chrono::time_point<std::chrono::system_clock> t0 )
+{
+	return std::chrono::duration<double>( std::chrono::system_clock::now() - t0 ).count();
+}
+
+int main(int argc, char **argv)
+{
+	Utilities::startup( argc, argv );
+	int check = 0;
+	{
+		printf("********************************************************\n");
+		printf("Running unit test: TestFilters	\n");
+		printf("********************************************************\n");
+		int n = 48;
+		if (argc > 1) n = atoi(argv[1]);
+		// smooth field with noise and a sharp interface
+		Array<float> VOL(n,n,n), Dist(n,n,n);
+		unsigned int state = 1;
+		for (int k=0; k<n; k++){
+			for (int j=0; j<n; j++){
+				for (int i=0; i<n; i++){
+					state = 1664525u*state + 1013904223u;
+					float noise = 0.2f*(float(state>>8)/float(1<<24) - 0.5f);
+					float r = sqrt(float((i-n/2)*(i-n/2)+(j-n/2)*(j-n/2)+(k-n/3)*(k-n/3)));
+					Dist(i,j,k) = r - 0.3f*n;
+					VOL(i,j,k) = (Dist(i,j,k) < 0 ? 1.0f : -1.0f) + noise;
+				}
+			}
+		}
+
+		// reference results
+		Array<float> Med_ref(n,n,n), Mean_ref(n,n,n), NLM_ref(n,n,n);
+		Med_ref.fill(0); Mean_ref.fill(0); NLM_ref.fill(0);
+		auto t0 = std::chrono::system_clock::now();
+		Med3D_ref( VOL, Med_ref );
+		double time_med_ref = Time(t0);
+		t0 = std::chrono::system_clock::now();
+		int count_ref = NLM3D_ref( VOL, Mean_ref, Dist, NLM_ref, 3, 0.1 );
+		double time_nlm_ref = Time(t0);
+		std::vector<imfilter::BC> BC(3,imfilter::BC::replicate);
+		float sigma[3] = { 1.0, 1.0, 1.0 };
+		auto H = imfilter::create_filter<float>( { 2, 2, 2 }, "gaussian", sigma );
+		std::function<float(const Array<float>&)> conv = [&H]( const Array<float>& data ){
+			float sum = 0;
+			for (size_t m=0; m<data.length(); m++) sum += H(m)*data(m);
+			return sum;
+		};
+		t0 = std::chrono::system_clock::now();
+		auto Conv_ref = imfilter::imfilter<float>( VOL, { 2, 2, 2 }, conv, BC );
+		double time_conv_ref = Time(t0);
+		printf("Reference: median %0.3f s, NLM %0.3f s, convolution %0.3f s \n", time_med_ref, time_nlm_ref, time_conv_ref);
+
+		for (int threads : { 1, 4 }){
+			Utilities::setNumThreads( threads );
+			Array<float> Med(n,n,n), Mean(n,n,n), NLM(n,n,n);
+			Med.fill(0); Mean.fill(0); NLM.fill(0);
+			t0 = std::chrono::system_clock::now();
+			Med3D( VOL, Med );
+			double time_med = Time(t0);
+			t0 = std::chrono::system_clock::now();
+			int count = NLM3D( VOL, Mean, Dist, NLM, 3, 0.1 );
+			double time_nlm = Time(t0);
+			t0 = std::chrono::system_clock::now();
+			auto Conv = imfilter::imfilter<float>( VOL, H, BC );
+			double time_conv = Time(t0);
+			double err_med = MaxDiff( Med, Med_ref, 1 );
+			double err_mean = MaxDiff( Mean, Mean_ref, 1 );
+			double err_nlm = MaxDiff( NLM, NLM_ref, 1 );
+			double err_conv = MaxDiff( Conv, Conv_ref, 0 );
+			printf("%i threads: median %0.3f s (err %g), NLM %0.3f s (err %g / %g), convolution %0.3f s (err %g) \n",
+				threads, time_med, err_med, time_nlm, err_mean, err_nlm, time_conv, err_conv);
+			if (err_med != 0.0 || count != count_ref || err_mean > 1e-5 || err_nlm > 1e-4 || err_conv > 1e-5){
+				printf("   filters do not match the reference \n");
+				check++;
+			}
+		}
+		Utilities::setNumThreads( 1 );
+	}
+	Utilities::shutdown();
+	return check;
+}
@@ -0,0 +1,300 @@
+//*************************************************************************
+// Check the flow statistics summed by the MRT and color collision kernels:
+// the *_Stats kernels give the same distributions as the plain kernels and
+// their sums agree with the sums over the distributions and velocity
+//*************************************************************************
+#include <stdio.h>
+#include <iostream>
+#include <math.h>
+#include "common/MPI.h"
+#include "common/Utilities.h"
+#include "common/ScaLBL.h"
+
+using namespace std;
+
+static void ProcessGrid( int nprocs, int &npx, int &npy )
+{
+	npx = npy = 1;
+	if (nprocs == 2) npx = 2;
+	if (nprocs == 4) npx = npy = 2;
+}
+
+static int Compare( int rank, const char *name, double result, double expected, double scale )
+{
+	bool wrong = !( fabs( result - expected ) <= 1e-6*( fabs( expected ) + scale ) );
+	if ( rank == 0 && wrong )
+		printf("%s: %.12g (expected %.12g) \n", name, result, expected);
+	return wrong ? 1 : 0;
+}
+
+// the sites of the layout that are updated by the collision
+static bool Site( const std::shared_ptr<ScaLBL_Communicator> &ScaLBL_Comm, int n )
+{
+	return n < ScaLBL_Comm->LastExterior() || ( n >= ScaLBL_Comm->FirstInterior() && n < ScaLBL_Comm->LastInterior() );
+}
+
+// mass and momentum of the distributions at each site (normal storage order)
+static void Moments( const std::vector<double> &f, int Np, int n, double &rho, double &jx, double &jy, double &jz )
+{
+	const int cx[19] = { 0, 1,-1, 0, 0, 0, 0, 1,-1, 1,-1, 1,-1, 1,-1, 0, 0, 0, 0 };
+	const int cy[19] = { 0, 0, 0, 1,-1, 0, 0, 1,-1,-1, 1, 0, 0, 0, 0, 1,-1, 1,-1 };
+	const int cz[19] = { 0, 0, 0, 0, 0, 1,-1, 0, 0, 0, 0, 1,-1,-1, 1, 1,-1,-1, 1 };
+	rho = jx = jy = jz = 0.0;
+	for (int q=0; q<19; q++){
+		double fq = f[q*Np+n];
+		rho += fq;
+		jx += cx[q]*fq;
+		jy += cy[q]*fq;
+		jz += cz[q]*fq;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	// Initialize MPI
+	Utilities::startup( argc, argv );
+	Utilities::MPI comm( MPI_COMM_WORLD );
+	int rank = comm.getRank();
+	int check=0;
+	{
+		if (rank == 0){
+			printf("********************************************************\n");
+			printf("Running unit test: TestFlowStatistics	\n");
+			printf("********************************************************\n");
+		}
+		int npx, npy;
+		ProcessGrid( comm.getSize(), npx, npy );
+		auto db = std::make_shared<Database>();
+		db->putScalar<int>( "BC", 0 );
+		db->putVector<int>( "nproc", { npx, npy, 1 } );
+		db->putVector<int>( "n", { 16, 14, 12 } );
+		db->putScalar<int>( "nspheres", 0 );
+		db->putVector<double>( "L", { 1, 1, 1 } );
+		auto Dm = std::make_shared<Domain>( db, comm );
+		int Nx = Dm->Nx, Ny = Dm->Ny, Nz = Dm->Nz;
+		int N = Nx*Ny*Nz;
+		// a few solid sites so that the flow is not uniform
+		for (int k=0; k<Nz; k++){
+			for (int j=0; j<Ny; j++){
+				for (int i=0; i<Nx; i++){
+					Dm->id[(k*Ny+j)*Nx+i] = ( (i+2*j+3*k) % 13 == 0 ) ? 0 : 1;
+				}
+			}
+		}
+		Dm->CommInit();
+		int Np = Dm->PoreCount();
+		auto ScaLBL_Comm = std::make_shared<ScaLBL_Communicator>( Dm );
+		IntArray Map( Nx, Ny, Nz );
+		Map.fill( -2 );
+		auto neighborList = new int[18*(Np+32)];
+		Np = ScaLBL_Comm->MemoryOptimizedLayoutAA( Map, neighborList, Dm->id.data(), Np, 1 );
+		int *NeighborList, *dvcMap;
+		double *fq, *gq, *stats;
+		ScaLBL_AllocateDeviceMemory( (void **) &NeighborList, 18*Np*sizeof(int) );
+		ScaLBL_AllocateDeviceMemory( (void **) &dvcMap, Np*sizeof(int) );
+		ScaLBL_AllocateDeviceMemory( (void **) &fq, 19*Np*sizeof(double) );
+		ScaLBL_AllocateDeviceMemory( (void **) &gq, 19*Np*sizeof(double) );
+		ScaLBL_AllocateDeviceMemory( (void **) &stats, SCALBL_COLOR_STATS*sizeof(double) );
+		ScaLBL_CopyToDevice( NeighborList, neighborList, 18*Np*sizeof(int) );
+		delete [] neighborList;
+		std::vector<int> TmpMap( Np, N-1 );
+		int count_loc = 0;
+		for (int k=1; k<Nz-1; k++){
+			for (int j=1; j<Ny-1; j++){
+				for (int i=1; i<Nx-1; i++){
+					int idx = Map(i,j,k);
+					if (!(idx < 0)){
+						TmpMap[idx] = k*Nx*Ny+j*Nx+i;
+						count_loc++;
+					}
+				}
+			}
+		}
+		ScaLBL_CopyToDevice( dvcMap, TmpMap.data(), Np*sizeof(int) );
+		int first = ScaLBL_Comm->FirstInterior(), last = ScaLBL_Comm->LastInterior(), exterior = ScaLBL_Comm->LastExterior();
+		const double zero[SCALBL_COLOR_STATS] = { 0.0 };
+		double result[SCALBL_COLOR_STATS];
+		std::vector<double> f( 19*Np ), g( 19*Np );
+
+		// MRT: develop a flow with a body force, then compare the kernels on one odd and one even step
+		double rlx_setA = 1.0/0.8, rlx_setB = 8.0*(2.0-rlx_setA)/(8.0-rlx_setA);
+		double Fx = 1.0e-4, Fy = -2.0e-5, Fz = 5.0e-5;
+		double Fmag = sqrt( Fx*Fx + Fy*Fy + Fz*Fz );
+		ScaLBL_D3Q19_Init( fq, Np );
+		for (int timestep=0; timestep<20; timestep+=2){
+			ScaLBL_Comm->SendD3Q19AA( fq );
+			ScaLBL_D3Q19_AAodd_MRT( NeighborList, fq, first, last, Np, rlx_setA, rlx_setB, Fx, Fy, Fz );
+			ScaLBL_Comm->RecvD3Q19AA( fq );
+			ScaLBL_D3Q19_AAodd_MRT( NeighborList, fq, 0, exterior, Np, rlx_setA, rlx_setB, Fx, Fy, Fz );
+			ScaLBL_Comm->SendD3Q19AA( fq );
+			ScaLBL_D3Q19_AAeven_MRT( fq, first, last, Np, rlx_setA, rlx_setB, Fx, Fy, Fz );
+			ScaLBL_Comm->RecvD3Q19AA( fq );
+			ScaLBL_D3Q19_AAeven_MRT( fq, 0, exterior, Np, rlx_setA, rlx_setB, Fx, Fy, Fz );
+		}
+		ScaLBL_CopyToDevice( gq, fq, 19*Np*sizeof(double) );
+		// odd step
+		ScaLBL_CopyToDevice( stats, zero, SCALBL_MRT_STATS*sizeof(double) );
+		ScaLBL_Comm->SendD3Q19AA( fq );
+		ScaLBL_D3Q19_AAodd_MRT( NeighborList, fq, first, last, Np, rlx_setA, rlx_setB, Fx, Fy, Fz );
+		ScaLBL_Comm->RecvD3Q19AA( fq );
+		ScaLBL_D3Q19_AAodd_MRT( NeighborList, fq, 0, exterior, Np, rlx_setA, rlx_setB, Fx, Fy, Fz );
+		ScaLBL_Comm->SendD3Q19AA( gq );
+		ScaLBL_D3Q19_AAodd_MRT_Stats( NeighborList, gq, first, last, Np, rlx_setA, rlx_setB, Fx, Fy, Fz, stats );
+		ScaLBL_Comm->RecvD3Q19AA( gq );
+		ScaLBL_D3Q19_AAodd_MRT_Stats( NeighborList, gq, 0, exterior, Np, rlx_setA, rlx_setB, Fx, Fy, Fz, stats );
+		ScaLBL_DeviceBarrier();
+		ScaLBL_CopyToHost( result, stats, SCALBL_MRT_STATS*sizeof(double) );
+		double odd_mass = comm.sumReduce( result[1] );
+		ScaLBL_CopyToHost( f.data(), fq, 19*Np*sizeof(double) );
+		ScaLBL_CopyToHost( g.data(), gq, 19*Np*sizeof(double) );
+		int errors = ( f == g ) ? 0 : 1;
+		check += Compare( rank, "MRT odd sites", result[0], count_loc, 0.0 );
+		// even step
+		ScaLBL_CopyToDevice( stats, zero, SCALBL_MRT_STATS*sizeof(double) );
+		ScaLBL_Comm->SendD3Q19AA( fq );
+		ScaLBL_D3Q19_AAeven_MRT( fq, first, last, Np, rlx_setA, rlx_setB, Fx, Fy, Fz );
+		ScaLBL_Comm->RecvD3Q19AA( fq );
+		ScaLBL_D3Q19_AAeven_MRT( fq, 0, exterior, Np, rlx_setA, rlx_setB, Fx, Fy, Fz );
+		ScaLBL_Comm->SendD3Q19AA( gq );
+		ScaLBL_D3Q19_AAeven_MRT_Stats( gq, first, last, Np, rlx_setA, rlx_setB, Fx, Fy, Fz, stats );
+		ScaLBL_Comm->RecvD3Q19AA( gq );
+		ScaLBL_D3Q19_AAeven_MRT_Stats( gq, 0, exterior, Np, rlx_setA, rlx_setB, Fx, Fy, Fz, stats );
+		ScaLBL_DeviceBarrier();
+		ScaLBL_CopyToHost( result, stats, SCALBL_MRT_STATS*sizeof(double) );
+		ScaLBL_CopyToHost( f.data(), fq, 19*Np*sizeof(double) );
+		ScaLBL_CopyToHost( g.data(), gq, 19*Np*sizeof(double) );
+		errors += ( f == g ) ? 0 : 1;
+		// after the even step the distributions are stored in the normal order
+		double expected[SCALBL_COLOR_STATS] = { 0.0 };
+		for (int n=0; n<Np; n++){
+			if ( !Site( ScaLBL_Comm, n ) ) continue;
+			double rho, jx, jy, jz;
+			Moments( f, Np, n, rho, jx, jy, jz );
+			expected[0] += 1.0;
+			expected[1] += rho;
+			expected[2] += jx;
+			expected[3] += jy;
+			expected[4] += jz;
+			expected[5] += 0.5*(jx*jx+jy*jy+jz*jz)/rho;
+		}
+		check += Compare( rank, "MRT sites", result[0], count_loc, 0.0 );
+		check += Compare( rank, "MRT mass", result[1], expected[1], 0.0 );
+		for (int d=0; d<3; d++)
+			check += Compare( rank, "MRT momentum", result[2+d], expected[2+d], count_loc*Fmag );
+		check += Compare( rank, "MRT kinetic energy", result[5], expected[5], count_loc*Fmag*Fmag );
+		// the total mass is conserved between the steps
+		check += Compare( rank, "MRT mass conservation", comm.sumReduce( result[1] ), odd_mass, 0.0 );
+		double sites = comm.sumReduce( result[0] );
+		double vx = comm.sumReduce( result[2] ) / sites;
+		double vy = comm.sumReduce( result[3] ) / sites;
+		double vz = comm.sumReduce( result[4] ) / sites;
+		if (rank == 0) printf("MRT: mass %g, mean velocity %g %g %g \n", odd_mass, vx, vy, vz);
+		if ( !( vx > 0.0 && vz > 0.0 ) ) check++;
+
+		// Color: start from the developed flow with two phases after an odd step
+		ScaLBL_Comm->SendD3Q19AA( fq );
+		ScaLBL_D3Q19_AAodd_MRT( NeighborList, fq, first, last, Np, rlx_setA, rlx_setB, Fx, Fy, Fz );
+		ScaLBL_Comm->RecvD3Q19AA( fq );
+		ScaLBL_D3Q19_AAodd_MRT( NeighborList, fq, 0, exterior, Np, rlx_setA, rlx_setB, Fx, Fy, Fz );
+		double *Aq, *Bq, *Den, *Phi, *Vel, *Ag, *Bg, *Velg;
+		ScaLBL_AllocateDeviceMemory( (void **) &Aq, 7*Np*sizeof(double) );
+		ScaLBL_AllocateDeviceMemory( (void **) &Bq, 7*Np*sizeof(double) );
+		ScaLBL_AllocateDeviceMemory( (void **) &Ag, 7*Np*sizeof(double) );
+		ScaLBL_AllocateDeviceMemory( (void **) &Bg, 7*Np*sizeof(double) );
+		ScaLBL_AllocateDeviceMemory( (void **) &Den, 2*Np*sizeof(double) );
+		ScaLBL_AllocateDeviceMemory( (void **) &Phi, N*sizeof(double) );
+		ScaLBL_AllocateDeviceMemory( (void **) &Vel, 3*Np*sizeof(double) );
+		ScaLBL_AllocateDeviceMemory( (void **) &Velg, 3*Np*sizeof(double) );
+		std::vector<double> PhaseField( N );
+		for (int n=0; n<N; n++) PhaseField[n] = sin( 0.3*(n%Nx) + 0.7*((n/Nx)%Ny) );
+		ScaLBL_CopyToDevice( Phi, PhaseField.data(), N*sizeof(double) );
+		ScaLBL_PhaseField_Init( dvcMap, Phi, Den, Aq, Bq, 0, exterior, Np );
+		ScaLBL_PhaseField_Init( dvcMap, Phi, Den, Aq, Bq, first, last, Np );
+		ScaLBL_CopyToDevice( Ag, Aq, 7*Np*sizeof(double) );
+		ScaLBL_CopyToDevice( Bg, Bq, 7*Np*sizeof(double) );
+		ScaLBL_CopyToDevice( gq, fq, 19*Np*sizeof(double) );
+		double rhoA = 1.0, rhoB = 0.8, tauA = 0.8, tauB = 1.0, alpha = 0.005, beta = 0.95;
+		// the even step reads the distributions in the opposite order
+		std::vector<double> f0( 19*Np );
+		ScaLBL_CopyToHost( f0.data(), fq, 19*Np*sizeof(double) );
+		ScaLBL_D3Q19_AAeven_Color( dvcMap, fq, Aq, Bq, Den, Phi, Vel, rhoA, rhoB, tauA, tauB,
+			alpha, beta, Fx, Fy, Fz, Nx, Nx*Ny, first, last, Np );
+		ScaLBL_D3Q19_AAeven_Color( dvcMap, fq, Aq, Bq, Den, Phi, Vel, rhoA, rhoB, tauA, tauB,
+			alpha, beta, Fx, Fy, Fz, Nx, Nx*Ny, 0, exterior, Np );
+		ScaLBL_CopyToDevice( stats, zero, SCALBL_COLOR_STATS*sizeof(double) );
+		ScaLBL_D3Q19_AAeven_Color_Stats( dvcMap, gq, Ag, Bg, Den, Phi, Velg, rhoA, rhoB, tauA, tauB,
+			alpha, beta, Fx, Fy, Fz, Nx, Nx*Ny, first, last, Np, stats );
+		ScaLBL_D3Q19_AAeven_Color_Stats( dvcMap, gq, Ag, Bg, Den, Phi, Velg, rhoA, rhoB, tauA, tauB,
+			alpha, beta, Fx, Fy, Fz, Nx, Nx*Ny, 0, exterior, Np, stats );
+		ScaLBL_DeviceBarrier();
+		ScaLBL_CopyToHost( result, stats, SCALBL_COLOR_STATS*sizeof(double) );
+		std::vector<double> A( 7*Np ), B( 7*Np ), Ahat( 7*Np ), Bhat( 7*Np ), U( 3*Np ), Uhat( 3*Np ), D( 2*Np );
+		ScaLBL_CopyToHost( f.data(), fq, 19*Np*sizeof(double) );
+		ScaLBL_CopyToHost( g.data(), gq, 19*Np*sizeof(double) );
+		ScaLBL_CopyToHost( A.data(), Aq, 7*Np*sizeof(double) );
+		ScaLBL_CopyToHost( B.data(), Bq, 7*Np*sizeof(double) );
+		ScaLBL_CopyToHost( Ahat.data(), Ag, 7*Np*sizeof(double) );
+		ScaLBL_CopyToHost( Bhat.data(), Bg, 7*Np*sizeof(double) );
+		ScaLBL_CopyToHost( U.data(), Vel, 3*Np*sizeof(double) );
+		ScaLBL_CopyToHost( Uhat.data(), Velg, 3*Np*sizeof(double) );
+		ScaLBL_CopyToHost( D.data(), Den, 2*Np*sizeof(double) );
+		for (int n=0; n<Np; n++){
+			if ( Site( ScaLBL_Comm, n ) ) continue;
+			// padding between the exterior and interior sites is not updated
+			for (int d=0; d<3; d++) U[d*Np+n] = Uhat[d*Np+n] = 0.0;
+		}
+		errors += ( f == g && A == Ahat && B == Bhat && U == Uhat ) ? 0 : 1;
+		for (int m=0; m<SCALBL_COLOR_STATS; m++) expected[m] = 0.0;
+		for (int n=0; n<Np; n++){
+			if ( !Site( ScaLBL_Comm, n ) ) continue;
+			double rho, jx, jy, jz;
+			Moments( f0, Np, n, rho, jx, jy, jz );
+			double nA = D[n], nB = D[Np+n];
+			double phi = (nA-nB)/(nA+nB);
+			double rho0 = rhoA + 0.5*(1.0-phi)*(rhoB-rhoA);
+			double ux = U[n], uy = U[Np+n], uz = U[2*Np+n];
+			expected[0] += 1.0;
+			expected[1] += rho;
+			// momentum before the collision, read in the opposite order
+			expected[2] -= jx;
+			expected[3] -= jy;
+			expected[4] -= jz;
+			expected[5] += 0.5*rho0*(ux*ux+uy*uy+uz*uz);
+			int p = (phi > 0.0) ? 6 : 10;
+			double rhoP = (phi > 0.0) ? rhoA : rhoB;
+			expected[p] += 1.0;
+			expected[p+1] += rhoP*ux;
+			expected[p+2] += rhoP*uy;
+			expected[p+3] += rhoP*uz;
+		}
+		check += Compare( rank, "Color sites", result[0], count_loc, 0.0 );
+		check += Compare( rank, "Color volume", result[6] + result[10], count_loc, 0.0 );
+		for (int m=1; m<SCALBL_COLOR_STATS; m++)
+			check += Compare( rank, "Color statistics", result[m], expected[m], count_loc*Fmag*Fmag );
+		if ( result[6] == 0.0 || result[10] == 0.0 ) check++;
+		if (rank == 0) printf("Color: volume of A %g, B %g, momentum of A %g %g %g \n",
+			result[6], result[10], result[7], result[8], result[9]);
+
+		errors = comm.sumReduce( errors );
+		if (rank == 0) printf("%i kernels differ from the plain collision \n", errors);
+		check += errors;
+		check = comm.maxReduce( check );
+
+		ScaLBL_FreeDeviceMemory( NeighborList );
+		ScaLBL_FreeDeviceMemory( dvcMap );
+		ScaLBL_FreeDeviceMemory( fq );
+		ScaLBL_FreeDeviceMemory( gq );
+		ScaLBL_FreeDeviceMemory( stats );
+		ScaLBL_FreeDeviceMemory( Aq );
+		ScaLBL_FreeDeviceMemory( Bq );
+		ScaLBL_FreeDeviceMemory( Ag );
+		ScaLBL_FreeDeviceMemory( Bg );
+		ScaLBL_FreeDeviceMemory( Den );
+		ScaLBL_FreeDeviceMemory( Phi );
+		ScaLBL_FreeDeviceMemory( Vel );
+		ScaLBL_FreeDeviceMemory( Velg );
+	}
+	Utilities::shutdown();
+
+	return check;
+}
@@ -0,0 +1,123 @@
+//*************************************************************************
+// Check the flux boundary condition with the domain split in z: only the
+// ranks on the inlet plane take part in the reduction, the flux through
+// the inlet is the prescribed flux and the inlet pressure agrees on the
+// inlet ranks
+//*************************************************************************
+#include <stdio.h>
+#include <iostream>
+#include <math.h>
+#include "common/MPI.h"
+#include "common/Utilities.h"
+#include "common/ScaLBL.h"
+
+using namespace std;
+
+// the domain is split in z so that some ranks do not touch the inlet
+static void ProcessGrid( int nprocs, int &npx, int &npz )
+{
+	npx = npz = 1;
+	if (nprocs == 2) npz = 2;
+	if (nprocs == 4) npx = npz = 2;
+}
+
+int main(int argc, char **argv)
+{
+	// Initialize MPI
+	Utilities::startup( argc, argv );
+	Utilities::MPI comm( MPI_COMM_WORLD );
+	int rank = comm.getRank();
+	int check=0;
+	{
+		if (rank == 0){
+			printf("********************************************************\n");
+			printf("Running unit test: TestFluxBCPlane	\n");
+			printf("********************************************************\n");
+		}
+		int npx, npz;
+		ProcessGrid( comm.getSize(), npx, npz );
+		auto db = std::make_shared<Database>();
+		db->putScalar<int>( "BC", 4 );
+		db->putVector<int>( "nproc", { npx, 1, npz } );
+		db->putVector<int>( "n", { 16, 16, 16 } );
+		db->putScalar<int>( "nspheres", 0 );
+		db->putVector<double>( "L", { 1, 1, 1 } );
+		auto Dm = std::make_shared<Domain>( db, comm );
+		int Nx = Dm->Nx, Ny = Dm->Ny, Nz = Dm->Nz;
+		// parallel plates in each sub-domain
+		for (int k=0; k<Nz; k++){
+			for (int j=0; j<Ny; j++){
+				for (int i=0; i<Nx; i++){
+					Dm->id[(k*Ny+j)*Nx+i] = ( i < 2 || i >= Nx-2 ) ? 0 : 1;
+				}
+			}
+		}
+		Dm->CommInit();
+		int Np = Dm->PoreCount();
+		auto ScaLBL_Comm = std::make_shared<ScaLBL_Communicator>( Dm );
+		IntArray Map( Nx, Ny, Nz );
+		auto neighborList = new int[18*(Np+32)];
+		Np = ScaLBL_Comm->MemoryOptimizedLayoutAA( Map, neighborList, Dm->id.data(), Np, 1 );
+		int *NeighborList;
+		double *fq, *Velocity;
+		ScaLBL_AllocateDeviceMemory( (void **) &NeighborList, 18*Np*sizeof(int) );
+		ScaLBL_AllocateDeviceMemory( (void **) &fq, 19*Np*sizeof(double) );
+		ScaLBL_AllocateDeviceMemory( (void **) &Velocity, 3*Np*sizeof(double) );
+		ScaLBL_CopyToDevice( NeighborList, neighborList, 18*Np*sizeof(int) );
+		delete [] neighborList;
+
+		// the flux through the inlet layer after the boundary condition is applied
+		double flux = 1.0;
+		ScaLBL_D3Q19_Init( fq, Np );
+		double din = ScaLBL_Comm->D3Q19_Flux_BC_z( NeighborList, fq, flux, 0 );
+		ScaLBL_D3Q19_Momentum( fq, Velocity, Np );
+		std::vector<double> VEL( 3*Np );
+		ScaLBL_CopyToHost( VEL.data(), Velocity, 3*Np*sizeof(double) );
+		double Q = 0.0;
+		if (Dm->kproc() == 0){
+			for (int j=1; j<Ny-1; j++){
+				for (int i=1; i<Nx-1; i++){
+					int idx = Map(i,j,1);
+					if (idx >= 0) Q += VEL[2*Np+idx];
+				}
+			}
+		}
+		Q = comm.sumReduce( Q );
+		// respect backwards read / write!!!
+		if (rank == 0) printf("Inlet flux: input=%f, output=%f, inlet pressure %f \n", flux, Q, din);
+		if ( fabs( flux + Q ) > 1e-10 ) check++;
+
+		// run odd and even steps with a pressure outlet
+		double rlx_setA = 1.0, rlx_setB = 8.0*(2.0-rlx_setA)/(8.0-rlx_setA);
+		for (int timestep=1; timestep<200; timestep+=2){
+			ScaLBL_Comm->SendD3Q19AA( fq );
+			ScaLBL_D3Q19_AAodd_MRT( NeighborList, fq, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np, rlx_setA, rlx_setB, 0, 0, 0 );
+			ScaLBL_Comm->RecvD3Q19AA( fq );
+			din = ScaLBL_Comm->D3Q19_Flux_BC_z( NeighborList, fq, flux, timestep );
+			ScaLBL_Comm->D3Q19_Pressure_BC_Z( NeighborList, fq, 1.0, timestep );
+			ScaLBL_D3Q19_AAodd_MRT( NeighborList, fq, 0, ScaLBL_Comm->LastExterior(), Np, rlx_setA, rlx_setB, 0, 0, 0 );
+			ScaLBL_Comm->Barrier();
+			ScaLBL_Comm->SendD3Q19AA( fq );
+			ScaLBL_D3Q19_AAeven_MRT( fq, ScaLBL_Comm->FirstInterior(), ScaLBL_Comm->LastInterior(), Np, rlx_setA, rlx_setB, 0, 0, 0 );
+			ScaLBL_Comm->RecvD3Q19AA( fq );
+			din = ScaLBL_Comm->D3Q19_Flux_BC_z( NeighborList, fq, flux, timestep+1 );
+			ScaLBL_Comm->D3Q19_Pressure_BC_Z( NeighborList, fq, 1.0, timestep+1 );
+			ScaLBL_D3Q19_AAeven_MRT( fq, 0, ScaLBL_Comm->LastExterior(), Np, rlx_setA, rlx_setB, 0, 0, 0 );
+			ScaLBL_Comm->Barrier();
+		}
+		// the inlet pressure is the same on all inlet ranks, 0 elsewhere
+		bool inlet = Dm->kproc() == 0;
+		double din_max = comm.maxReduce( inlet ? din : -1e300 );
+		double din_min = comm.minReduce( inlet ? din : 1e300 );
+		int errors = comm.sumReduce( ( !inlet && din != 0.0 ) || din != din ? 1 : 0 );
+		if (rank == 0) printf("Inlet pressure after 200 steps: %f (spread %g) \n", din_max, din_max - din_min);
+		if ( errors > 0 || din_max != din_min || din_max <= 0.5 ) check++;
+
+		ScaLBL_FreeDeviceMemory( NeighborList );
+		ScaLBL_FreeDeviceMemory( fq );
+		ScaLBL_FreeDeviceMemory( Velocity );
+	}
+	Utilities::shutdown();
+
+	return check;
+}
@@ -0,0 +1,146 @@
+//*************************************************************************
+// Check the greyscale model with the open (porosity 1) sites stored
+// separately and run by the drag-free kernels: the velocity and pressure
+// are identical to running every site with the grey kernels
+//*************************************************************************
+#include <stdio.h>
+#include <iostream>
+#include <math.h>
+#include "models/GreyscaleModel.h"
+#include "common/MPI.h"
+
+using namespace std;
+
+static void ProcessGrid( int nprocs, int &npx, int &npy )
+{
+	npx = npy = 1;
+	if (nprocs == 2) npx = 2;
+	if (nprocs == 4) npx = npy = 2;
+}
+
+// solid spheres (0) on a regular lattice, two grey labels (2,3) in slabs, open voxels (1) elsewhere
+static void WriteImage( const char *filename, int Nx, int Ny, int Nz )
+{
+	std::vector<signed char> data( Nx*Ny*Nz );
+	for (int z=0; z<Nz; z++){
+		for (int y=0; y<Ny; y++){
+			for (int x=0; x<Nx; x++){
+				double dx = (x%12)-5.5, dy = (y%12)-5.5, dz = (z%12)-5.5;
+				signed char label = 1;
+				if ( z%10 < 2 ) label = 2;
+				if ( x%9 == 4 ) label = 3;
+				if ( dx*dx + dy*dy + dz*dz < 12.0 ) label = 0;
+				data[(z*Ny+y)*Nx+x] = label;
+			}
+		}
+	}
+	FILE *OUT = fopen( filename, "wb" );
+	fwrite( data.data(), 1, data.size(), OUT );
+	fclose( OUT );
+}
+
+static std::shared_ptr<Database> GreyscaleDatabase( int nprocs, int n, const char *collision, bool split )
+{
+	int npx, npy;
+	ProcessGrid( nprocs, npx, npy );
+	char text[2048];
+	sprintf(text,
+		"Greyscale {\n"
+		"  tau = 0.7\n"
+		"  F = 0, 1e-5, 1e-4\n"
+		"  timestepMax = 40\n"
+		"  collision = \"%s\"\n"
+		"  split_open_sites = %s\n"
+		"  ComponentLabels = 1, 2, 3\n"
+		"  PorosityList = 1.0, 0.4, 0.8\n"
+		"  PermeabilityList = 1.0, 0.05, 0.5\n"
+		"}\n"
+		"Domain {\n"
+		"  Filename = \"TestGreyscaleOpenSites.raw\"\n"
+		"  ReadType = \"8bit\"\n"
+		"  nproc = %i, %i, 1\n"
+		"  n = %i, %i, %i\n"
+		"  N = %i, %i, %i\n"
+		"  voxel_length = 1.0\n"
+		"  ReadValues = 0, 1, 2, 3\n"
+		"  WriteValues = 0, 1, 2, 3\n"
+		"  BC = 0\n"
+		"}\n"
+		"Analysis {\n"
+		"  analysis_interval = 1000000\n"
+		"  visualization_interval = 1000000\n"
+		"  restart_interval = 1000000\n"
+		"}\n"
+		"Visualization {\n"
+		"}\n",
+		collision, split ? "true" : "false", npx, npy, n, n, n, npx*n, npy*n, n );
+	return Database::createFromString( text );
+}
+
+// Run a few timesteps, return the velocity and pressure in the regular layout
+static void RunGreyscale( const Utilities::MPI &comm, int n, const char *collision, bool split,
+	std::vector<DoubleArray> &fields, double &open_fraction )
+{
+	ScaLBL_GreyscaleModel Greyscale( comm.getRank(), comm.getSize(), comm );
+	Greyscale.ReadParams( GreyscaleDatabase( comm.getSize(), n, collision, split ) );
+	Greyscale.SetDomain();
+	Greyscale.ReadInput();
+	Greyscale.Create();
+	Greyscale.Initialize();
+	Greyscale.Run();
+	auto &ScaLBL_Comm = *Greyscale.ScaLBL_Comm;
+	int Np = Greyscale.Np;
+	fields.assign( 4, DoubleArray( Greyscale.Nx, Greyscale.Ny, Greyscale.Nz ) );
+	ScaLBL_Comm.RegularLayout( Greyscale.Map, &Greyscale.Velocity[0], fields[0] );
+	ScaLBL_Comm.RegularLayout( Greyscale.Map, &Greyscale.Velocity[Np], fields[1] );
+	ScaLBL_Comm.RegularLayout( Greyscale.Map, &Greyscale.Velocity[2*Np], fields[2] );
+	ScaLBL_Comm.RegularLayout( Greyscale.Map, Greyscale.Pressure_dvc, fields[3] );
+	double open = ScaLBL_Comm.ExteriorSplit() + ScaLBL_Comm.InteriorSplit() - ScaLBL_Comm.FirstInterior();
+	double sites = ScaLBL_Comm.LastExterior() + ScaLBL_Comm.LastInterior() - ScaLBL_Comm.FirstInterior();
+	open_fraction = comm.sumReduce( open ) / comm.sumReduce( sites );
+}
+
+int main(int argc, char **argv)
+{
+	// Initialize MPI
+	Utilities::startup( argc, argv );
+	Utilities::MPI comm( MPI_COMM_WORLD );
+	int rank = comm.getRank();
+	int check=0;
+	{
+		if (rank == 0){
+			printf("********************************************************\n");
+			printf("Running unit test: TestGreyscaleOpenSites	\n");
+			printf("********************************************************\n");
+		}
+		int n = 24;
+		if (argc > 1) n = atoi(argv[1]);
+		int npx, npy;
+		ProcessGrid( comm.getSize(), npx, npy );
+		if (rank == 0) WriteImage( "TestGreyscaleOpenSites.raw", npx*n, npy*n, n );
+		comm.barrier();
+
+		for (const char *collision : { "IMRT", "BGK", "MRT" }){
+			std::vector<DoubleArray> grey, split;
+			double grey_fraction, split_fraction;
+			RunGreyscale( comm, n, collision, false, grey, grey_fraction );
+			RunGreyscale( comm, n, collision, true, split, split_fraction );
+			double diff = 0.0, vmax = 0.0;
+			for (int m=0; m<4; m++){
+				for (size_t i=0; i<grey[m].length(); i++){
+					diff = max( diff, fabs( grey[m](i) - split[m](i) ) );
+					if (m < 3) vmax = max( vmax, fabs( grey[m](i) ) );
+				}
+			}
+			diff = comm.maxReduce( diff );
+			vmax = comm.maxReduce( vmax );
+			if (rank == 0) printf("%s: open site fraction %f (%f without split), max velocity %g, max difference %g \n",
+				collision, split_fraction, grey_fraction, vmax, diff);
+			if ( diff != 0.0 || vmax == 0.0 || grey_fraction != 0.0 || split_fraction <= 0.0 || split_fraction >= 1.0 )
+				check++;
+		}
+	}
+	Utilities::shutdown();
+
+	return check;
+}
@@ -0,0 +1,139 @@
+//*************************************************************************
+// Check the halo exchange through shared memory: every exchange of the
+// ScaLBL_Communicator gives the same result with halo_shared_memory on
+// (neighbors on the node read the send buffers directly) and off (MPI)
+//*************************************************************************
+#include <stdio.h>
+#include <iostream>
+#include <math.h>
+#include "common/MPI.h"
+#include "common/Utilities.h"
+#include "common/ScaLBL.h"
+
+using namespace std;
+
+static void ProcessGrid( int nprocs, int &npx, int &npy )
+{
+	npx = npy = 1;
+	if (nprocs == 2) npx = 2;
+	if (nprocs == 4) npx = npy = 2;
+}
+
+// Domain with a layout, a distribution for each exchange and a scalar field
+struct HaloTest {
+	std::shared_ptr<Domain> Dm;
+	std::shared_ptr<ScaLBL_Communicator> ScaLBL_Comm;
+	int Np, N;
+	std::vector<double> fq, Aq, Bq, Cq, Phi;
+
+	HaloTest( const Utilities::MPI &comm, bool shared ){
+		int npx, npy;
+		ProcessGrid( comm.getSize(), npx, npy );
+		auto db = std::make_shared<Database>();
+		db->putScalar<int>( "BC", 0 );
+		db->putVector<int>( "nproc", { npx, npy, 1 } );
+		db->putVector<int>( "n", { 12, 10, 8 } );
+		db->putScalar<int>( "nspheres", 0 );
+		db->putVector<double>( "L", { 1, 1, 1 } );
+		db->putScalar<bool>( "halo_shared_memory", shared );
+		Dm = std::make_shared<Domain>( db, comm );
+		int Nx = Dm->Nx, Ny = Dm->Ny, Nz = Dm->Nz;
+		N = Nx*Ny*Nz;
+		// a few solid sites so that the send lists differ between the directions
+		for (int k=0; k<Nz; k++){
+			for (int j=0; j<Ny; j++){
+				for (int i=0; i<Nx; i++){
+					Dm->id[(k*Ny+j)*Nx+i] = ( (i+2*j+3*k) % 11 == 0 ) ? 0 : 1;
+				}
+			}
+		}
+		Dm->CommInit();
+		Np = Dm->PoreCount();
+		ScaLBL_Comm = std::make_shared<ScaLBL_Communicator>( Dm );
+		IntArray Map( Nx, Ny, Nz );
+		auto neighborList = new int[18*(Np+32)];
+		Np = ScaLBL_Comm->MemoryOptimizedLayoutAA( Map, neighborList, Dm->id.data(), Np, 1 );
+		delete [] neighborList;
+		fq.resize( 19*Np );
+		Aq.resize( 7*Np );
+		Bq.resize( 7*Np );
+		Cq.resize( 7*Np );
+		Phi.resize( N );
+	}
+	// values that differ on each rank and for each exchange
+	void Fill( int rank, int step ){
+		double s = 1.0 + 0.001*step;
+		for (size_t n=0; n<fq.size(); n++) fq[n] = s*(rank*1.0e6 + n);
+		for (size_t n=0; n<Aq.size(); n++){
+			Aq[n] = s*(rank*1.0e6 + n + 0.25);
+			Bq[n] = s*(rank*1.0e6 + n + 0.5);
+			Cq[n] = s*(rank*1.0e6 + n + 0.75);
+		}
+		for (int n=0; n<N; n++) Phi[n] = s*(rank*1.0e6 + n);
+	}
+	void Exchange( int step ){
+		switch ( step % 5 ){
+		case 0:
+			ScaLBL_Comm->SendD3Q19AA( fq.data() );
+			ScaLBL_Comm->RecvD3Q19AA( fq.data() );
+			break;
+		case 1:
+			ScaLBL_Comm->BiSendD3Q7AA( Aq.data(), Bq.data() );
+			ScaLBL_Comm->BiRecvD3Q7AA( Aq.data(), Bq.data() );
+			break;
+		case 2:
+			ScaLBL_Comm->TriSendD3Q7AA( Aq.data(), Bq.data(), Cq.data() );
+			ScaLBL_Comm->TriRecvD3Q7AA( Aq.data(), Bq.data(), Cq.data() );
+			break;
+		case 3:
+			ScaLBL_Comm->SendD3Q7AA( Aq.data(), 0 );
+			ScaLBL_Comm->RecvD3Q7AA( Aq.data(), 0 );
+			break;
+		default:
+			ScaLBL_Comm->SendHalo( Phi.data() );
+			ScaLBL_Comm->RecvHalo( Phi.data() );
+		}
+	}
+	bool operator==( const HaloTest &rhs ) const {
+		return fq == rhs.fq && Aq == rhs.Aq && Bq == rhs.Bq && Cq == rhs.Cq && Phi == rhs.Phi;
+	}
+};
+
+int main(int argc, char **argv)
+{
+	// Initialize MPI
+	Utilities::startup( argc, argv );
+	Utilities::MPI comm( MPI_COMM_WORLD );
+	int rank = comm.getRank();
+	int check=0;
+	{
+		if (rank == 0){
+			printf("********************************************************\n");
+			printf("Running unit test: TestHaloSharedMemory	\n");
+			printf("********************************************************\n");
+		}
+		HaloTest mpi( comm, false ), shared( comm, true );
+		int neighbors = shared.ScaLBL_Comm->SharedMemoryNeighbors();
+		if ( mpi.ScaLBL_Comm->SharedMemoryNeighbors() != 0 ) check++;
+#if MPI_VERSION >= 3 && !defined(USE_CUDA) && !defined(USE_HIP)
+		// all the ranks of the test are on one node
+		if ( neighbors != 18 ) check++;
+#endif
+		// back-to-back exchanges of each kind reuse the shared send buffers
+		int errors = 0;
+		for (int step=0; step<40; step++){
+			mpi.Fill( rank, step );
+			shared.Fill( rank, step );
+			mpi.Exchange( step/2 );
+			shared.Exchange( step/2 );
+			if ( !( mpi == shared ) ) errors++;
+		}
+		errors = comm.sumReduce( errors );
+		if (rank == 0) printf("%i shared memory neighbors, %i exchanges differ \n", neighbors, errors);
+		check += errors;
+		check = comm.maxReduce( check );
+	}
+	Utilities::shutdown();
+
+	return check;
+}
@@ -0,0 +1,226 @@
+//*************************************************************************
+// Check the incremental re-initialization used by the image sequence
+// protocol: Domain::ReadSubdomain gives the same labels as Decomp, and
+// ImageInit with incremental_image_init keeps the flow distributions and
+// rejects an image with a different solid
+//*************************************************************************
+#include <stdio.h>
+#include <iostream>
+#include <math.h>
+#include "common/ScaLBL.h"
+#include "common/MPI.h"
+#include "models/ColorModel.h"
+
+using namespace std;
+
+static void ProcessGrid( int nprocs, int &npx, int &npy )
+{
+	npx = npy = 1;
+	if (nprocs == 2) npx = 2;
+	if (nprocs == 4) npx = npy = 2;
+}
+
+// solid spheres of radius R on a regular lattice, non-wetting fluid (2) below the plane x < xfluid
+static signed char Label( int x, int y, int z, int xfluid, double R )
+{
+	double dx = (x%12)-5.5, dy = (y%12)-5.5, dz = (z%12)-5.5;
+	if ( dx*dx + dy*dy + dz*dz < R*R ) return 0;
+	return ( x < xfluid ) ? 2 : 1;
+}
+
+static void WriteImage( const char *filename, int Nx, int Ny, int Nz, int xfluid, bool bits16, double R = 4.0 )
+{
+	std::vector<short int> data( Nx*Ny*Nz );
+	for (int z=0; z<Nz; z++)
+		for (int y=0; y<Ny; y++)
+			for (int x=0; x<Nx; x++)
+				data[(z*Ny+y)*Nx+x] = Label( x, y, z, xfluid, R );
+	FILE *OUT = fopen( filename, "wb" );
+	if (bits16){
+		fwrite( data.data(), 2, data.size(), OUT );
+	}
+	else {
+		std::vector<signed char> data8( data.begin(), data.end() );
+		fwrite( data8.data(), 1, data8.size(), OUT );
+	}
+	fclose( OUT );
+}
+
+// ReadSubdomain and Decomp must give the same labels, including the halo, offsets,
+// transition region and checkerboard layers
+static int CheckReadSubdomain( const Utilities::MPI &comm, int n )
+{
+	int rank = comm.getRank();
+	int npx, npy;
+	ProcessGrid( comm.getSize(), npx, npy );
+	int Nx = npx*n+5, Ny = npy*n+3, Nz = n-4;
+	if (rank == 0) WriteImage( "TestImageInit_16bit.raw", Nx, Ny, Nz, Nx/3, true );
+	comm.barrier();
+	char text[1024];
+	sprintf(text,
+		"Domain {\n"
+		"  nproc = %i, %i, 1\n"
+		"  n = %i, %i, %i\n"
+		"  N = %i, %i, %i\n"
+		"  offset = 2, 1, 1\n"
+		"  L = 1, 1, 1\n"
+		"  BC = 0\n"
+		"  ReadType = \"16bit\"\n"
+		"  ReadValues = 0, 1, 2\n"
+		"  WriteValues = 0, 2, 1\n"
+		"  InletLayers = 2, 0, 3\n"
+		"  OutletLayers = 0, 1, 2\n"
+		"  checkerSize = 5\n"
+		"}\n", npx, npy, n, n, n, Nx, Ny, Nz );
+	auto db = Database::createFromString( text )->getDatabase( "Domain" );
+	Domain Dm1( db, comm ), Dm2( db, comm );
+	Dm1.Decomp( "TestImageInit_16bit.raw" );
+	Dm2.ReadSubdomain( "TestImageInit_16bit.raw" );
+	int errors = 0;
+	for (size_t i=0; i<Dm1.id.size(); i++)
+		if (Dm1.id[i] != Dm2.id[i]) errors++;
+	errors = comm.sumReduce( errors );
+	if (rank == 0) printf("ReadSubdomain: %i sites differ from Decomp \n", errors);
+	return errors > 0 ? 1 : 0;
+}
+
+static std::shared_ptr<Database> ColorDatabase( int nprocs, int n, bool incremental )
+{
+	int npx, npy;
+	ProcessGrid( nprocs, npx, npy );
+	char text[2048];
+	sprintf(text,
+		"Color {\n"
+		"  tauA = 1.0; tauB = 1.0; rhoA = 1.0; rhoB = 1.0\n"
+		"  alpha = 1e-2; beta = 0.95\n"
+		"  F = 1e-5, 0, 0\n"
+		"  Restart = false\n"
+		"  timestepMax = 100000\n"
+		"  ComponentLabels = 0\n"
+		"  ComponentAffinity = -1.0\n"
+		"  image_sequence = \"TestImageInit_1.raw\", \"TestImageInit_2.raw\"\n"
+		"  incremental_image_init = %s\n"
+		"}\n"
+		"Domain {\n"
+		"  nproc = %i, %i, 1\n"
+		"  n = %i, %i, %i\n"
+		"  N = %i, %i, %i\n"
+		"  L = 1, 1, 1\n"
+		"  BC = 0\n"
+		"  ReadType = \"8bit\"\n"
+		"  ReadValues = 0, 1, 2\n"
+		"  WriteValues = 0, 1, 2\n"
+		"}\n"
+		"Analysis {\n"
+		"  blobid_interval = 1000000\n"
+		"  analysis_interval = 1000000\n"
+		"  subphase_analysis_interval = 1000000\n"
+		"  restart_interval = 1000000\n"
+		"  visualization_interval = 1000000\n"
+		"  restart_file = \"Restart\"\n"
+		"  N_threads = 0\n"
+		"  load_balance = \"independent\"\n"
+		"}\n"
+		"Visualization {\n"
+		"}\n"
+		"FlowAdaptor {\n"
+		"}\n",
+		incremental ? "true" : "false", npx, npy, n, n, n, npx*n, npy*n, n );
+	return Database::createFromString( text );
+}
+
+// Run the first image, then load the second; return the distributions before / after and the phase field
+static void RunSequence( const Utilities::MPI &comm, int n, bool incremental,
+	std::vector<double> &fq0, std::vector<double> &fq1, std::vector<double> &phi, double &saturation )
+{
+	ScaLBL_ColorModel ColorModel( comm.getRank(), comm.getSize(), comm );
+	ColorModel.ReadParams( ColorDatabase( comm.getSize(), n, incremental ) );
+	ColorModel.SetDomain();
+	ColorModel.ReadInput();
+	ColorModel.Create();
+	ColorModel.Initialize();
+	ColorModel.Run( 20 );
+	int Np = ColorModel.Np;
+	fq0.resize( 19*Np );
+	fq1.resize( 19*Np );
+	phi.resize( ColorModel.N );
+	ScaLBL_CopyToHost( fq0.data(), ColorModel.fq, 19*Np*sizeof(double) );
+	saturation = ColorModel.ImageInit( "TestImageInit_2.raw" );
+	ScaLBL_CopyToHost( fq1.data(), ColorModel.fq, 19*Np*sizeof(double) );
+	ScaLBL_CopyToHost( phi.data(), ColorModel.Phi, ColorModel.N*sizeof(double) );
+}
+
+// The incremental path keeps Map / NeighborList, so an image with a different solid must be an error
+static int CheckChangedSolid( const Utilities::MPI &comm, int n )
+{
+	ScaLBL_ColorModel ColorModel( comm.getRank(), comm.getSize(), comm );
+	ColorModel.ReadParams( ColorDatabase( comm.getSize(), n, true ) );
+	ColorModel.SetDomain();
+	ColorModel.ReadInput();
+	ColorModel.Create();
+	ColorModel.Initialize();
+	bool failed = false;
+	try {
+		ColorModel.ImageInit( "TestImageInit_3.raw" );
+	} catch ( const StackTrace::abort_error & ) {
+		failed = true;
+	}
+	if (comm.getRank() == 0) printf("changed solid %s \n", failed ? "rejected" : "NOT rejected");
+	return failed ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+	// Initialize MPI
+	Utilities::startup( argc, argv );
+	Utilities::MPI comm( MPI_COMM_WORLD );
+	int rank = comm.getRank();
+	int check=0;
+	{
+		if (rank == 0){
+			printf("********************************************************\n");
+			printf("Running unit test: TestImageInit	\n");
+			printf("********************************************************\n");
+		}
+		int n = 24;
+		if (argc > 1) n = atoi(argv[1]);
+		check += CheckReadSubdomain( comm, n );
+
+		int npx, npy;
+		ProcessGrid( comm.getSize(), npx, npy );
+		if (rank == 0){
+			WriteImage( "TestImageInit_1.raw", npx*n, npy*n, n, npx*n/2, false );
+			WriteImage( "TestImageInit_2.raw", npx*n, npy*n, n, npx*n/4, false );
+			WriteImage( "TestImageInit_3.raw", npx*n, npy*n, n, npx*n/4, false, 4.5 );
+		}
+		comm.barrier();
+		std::vector<double> fq0_full, fq1_full, phi_full, fq0_inc, fq1_inc, phi_inc;
+		double sat_full, sat_inc;
+		RunSequence( comm, n, false, fq0_full, fq1_full, phi_full, sat_full );
+		RunSequence( comm, n, true, fq0_inc, fq1_inc, phi_inc, sat_inc );
+
+		// same phase field and saturation from both paths
+		double diff = 0.0;
+		for (size_t i=0; i<phi_full.size(); i++)
+			diff = max( diff, fabs( phi_full[i] - phi_inc[i] ) );
+		diff = comm.maxReduce( diff );
+		if (rank == 0) printf("saturation: full = %f, incremental = %f, max phase field difference = %g \n", sat_full, sat_inc, diff);
+		if (diff > 0.0 || sat_full != sat_inc) check++;
+
+		// the incremental path keeps the flow distributions, the full path resets them
+		double kept = 0.0, reset = 0.0;
+		for (size_t i=0; i<fq0_inc.size(); i++)
+			kept = max( kept, fabs( fq0_inc[i] - fq1_inc[i] ) );
+		for (size_t i=0; i<fq0_full.size(); i++)
+			reset = max( reset, fabs( fq0_full[i] - fq1_full[i] ) );
+		kept = comm.maxReduce( kept );
+		reset = comm.maxReduce( reset );
+		if (rank == 0) printf("change in fq: full = %g, incremental = %g \n", reset, kept);
+		if (kept > 0.0 || reset == 0.0) check++;
+
+		check += CheckChangedSolid( comm, n );
+	}
+	Utilities::shutdown();
+
+	return check;
+}
@@ -0,0 +1,293 @@
+//*************************************************************************
+// Check that the interior orderings of the sparse layout (raster, tile,
+// morton, hilbert) give identical MRT and color model results, and report
+// the lattice update rate for each ordering
+//   TestInteriorOrdering                   -- unit test
+//   TestInteriorOrdering benchmark [steps] -- MLUPS for several subdomain
+//                                             sizes and porosities
+//*************************************************************************
+#include <stdio.h>
+#include <iostream>
+#include <math.h>
+#include <chrono>
+#include "common/ScaLBL.h"
+#include "common/MPI.h"
+
+using namespace std;
+
+static const char *Orderings[4] = { "raster", "tile", "morton", "hilbert" };
+
+// Sparse lattice and the device structures shared by the MRT and color updates
+struct SparseLattice {
+	std::shared_ptr<Domain> Dm;
+	std::shared_ptr<ScaLBL_Communicator> ScaLBL_Comm, ScaLBL_Comm_Regular;
+	IntArray Map;
+	int Nx, Ny, Nz, Np, Nfluid;
+	int *NeighborList, *dvcMap;
+	~SparseLattice(){
+		ScaLBL_FreeDeviceMemory( NeighborList );
+		ScaLBL_FreeDeviceMemory( dvcMap );
+	}
+};
+
+static std::shared_ptr<Database> DomainDatabase( int nprocs, int n, const char *ordering )
+{
+	int npx = 1, npy = 1;
+	if (nprocs == 2) npx = 2;
+	if (nprocs == 4) npx = npy = 2;
+	char text[512];
+	sprintf(text,
+		"Domain {\n"
+		"  nproc = %i, %i, 1\n"
+		"  n = %i, %i, %i\n"
+		"  L = 1, 1, 1\n"
+		"  BC = 0\n"
+		"  interior_ordering = \"%s\"\n"
+		"}\n", npx, npy, n, n, n, ordering );
+	return Database::createFromString( text )->getDatabase( "Domain" );
+}
+
+// Overlapping spheres placed with a fixed seed until the porosity drops below the target
+static void SpherePack( Domain &Dm, double porosity, int seed )
+{
+	int Nx = Dm.Nx, Ny = Dm.Ny, Nz = Dm.Nz;
+	for (size_t n=0; n<Dm.id.size(); n++) Dm.id[n] = 1;
+	double radius = 0.1*(Nx-2);
+	double count = double((Nx-2)*(Ny-2)*(Nz-2));
+	double solid = 0.0;
+	unsigned int state = 12345u + 7919u*seed;
+	auto uniform = [&state]() { state = 1664525u*state + 1013904223u; return double(state>>8)/double(1<<24); };
+	while (1.0 - solid/count > porosity){
+		double cx = 1.0 + uniform()*(Nx-2);
+		double cy = 1.0 + uniform()*(Ny-2);
+		double cz = 1.0 + uniform()*(Nz-2);
+		for (int k=1; k<Nz-1; k++){
+			for (int j=1; j<Ny-1; j++){
+				for (int i=1; i<Nx-1; i++){
+					int n = k*Nx*Ny + j*Nx + i;
+					double d2 = (i-cx)*(i-cx) + (j-cy)*(j-cy) + (k-cz)*(k-cz);
+					if (Dm.id[n] > 0 && d2 < radius*radius){
+						Dm.id[n] = 0;
+						solid += 1.0;
+					}
+				}
+			}
+		}
+	}
+}
+
+static void CreateLattice( SparseLattice &L, const Utilities::MPI &comm, int n, double porosity, const char *ordering )
+{
+	L.Dm = std::make_shared<Domain>( DomainDatabase( comm.getSize(), n, ordering ), comm );
+	L.Nx = L.Dm->Nx; L.Ny = L.Dm->Ny; L.Nz = L.Dm->Nz;
+	int Nx = L.Nx, Ny = L.Ny, Nz = L.Nz;
+	SpherePack( *L.Dm, porosity, comm.getRank() );
+	L.Dm->CommInit();
+	int Np = 0;
+	for (int k=1; k<Nz-1; k++)
+		for (int j=1; j<Ny-1; j++)
+			for (int i=1; i<Nx-1; i++)
+				if (L.Dm->id[k*Nx*Ny+j*Nx+i] > 0) Np++;
+	L.Nfluid = Np;
+	L.ScaLBL_Comm = std::shared_ptr<ScaLBL_Communicator>( new ScaLBL_Communicator( L.Dm ) );
+	L.ScaLBL_Comm_Regular = std::shared_ptr<ScaLBL_Communicator>( new ScaLBL_Communicator( L.Dm ) );
+	int Npad = (Np/16 + 2)*16;
+	L.Map.resize( Nx, Ny, Nz );	L.Map.fill( -2 );
+	auto neighborList = new int[18*Npad];
+	L.Np = Np = L.ScaLBL_Comm->MemoryOptimizedLayoutAA( L.Map, neighborList, L.Dm->id.data(), Np, 1 );
+	ScaLBL_AllocateDeviceMemory( (void **) &L.NeighborList, 18*Np*sizeof(int) );
+	ScaLBL_AllocateDeviceMemory( (void **) &L.dvcMap, Np*sizeof(int) );
+	ScaLBL_CopyToDevice( L.NeighborList, neighborList, 18*Np*sizeof(int) );
+	std::vector<int> TmpMap( Np, 0 );
+	for (int k=1; k<Nz-1; k++)
+		for (int j=1; j<Ny-1; j++)
+			for (int i=1; i<Nx-1; i++)
+				if (!(L.Map(i,j,k) < 0)) TmpMap[L.Map(i,j,k)] = k*Nx*Ny+j*Nx+i;
+	ScaLBL_CopyToDevice( L.dvcMap, TmpMap.data(), Np*sizeof(int) );
+	ScaLBL_DeviceBarrier();
+	delete [] neighborList;
+}
+
+// Run the MRT model for a body-force driven flow, return MLUPS and the z-velocity in the regular layout
+static double RunMRT( SparseLattice &L, int timesteps, DoubleArray &Vz )
+{
+	int Np = L.Np;
+	auto &Comm = L.ScaLBL_Comm;
+	double *fq, *Velocity;
+	ScaLBL_AllocateDeviceMemory( (void **) &fq, 19*Np*sizeof(double) );
+	ScaLBL_AllocateDeviceMemory( (void **) &Velocity, 3*Np*sizeof(double) );
+	ScaLBL_D3Q19_Init( fq, Np );
+	double rlx_setA = 1.0/0.7;
+	double rlx_setB = 8.f*(2.f-rlx_setA)/(8.f-rlx_setA);
+	double Fx = 0.0, Fy = 0.0, Fz = 1e-5;
+	Comm->Barrier();
+	auto t1 = std::chrono::system_clock::now();
+	for (int t=0; t<timesteps; t+=2){
+		Comm->SendD3Q19AA(fq);
+		ScaLBL_D3Q19_AAodd_MRT(L.NeighborList, fq, Comm->FirstInterior(), Comm->LastInterior(), Np, rlx_setA, rlx_setB, Fx, Fy, Fz);
+		Comm->RecvD3Q19AA(fq);
+		ScaLBL_D3Q19_AAodd_MRT(L.NeighborList, fq, 0, Comm->LastExterior(), Np, rlx_setA, rlx_setB, Fx, Fy, Fz);
+		Comm->Barrier();
+		Comm->SendD3Q19AA(fq);
+		ScaLBL_D3Q19_AAeven_MRT(fq, Comm->FirstInterior(), Comm->LastInterior(), Np, rlx_setA, rlx_setB, Fx, Fy, Fz);
+		Comm->RecvD3Q19AA(fq);
+		ScaLBL_D3Q19_AAeven_MRT(fq, 0, Comm->LastExterior(), Np, rlx_setA, rlx_setB, Fx, Fy, Fz);
+		Comm->Barrier();
+	}
+	auto t2 = std::chrono::system_clock::now();
+	double cputime = std::chrono::duration<double>( t2 - t1 ).count();
+	ScaLBL_D3Q19_Momentum( fq, Velocity, Np );
+	ScaLBL_DeviceBarrier();
+	Comm->RegularLayout( L.Map, &Velocity[2*Np], Vz );
+	ScaLBL_FreeDeviceMemory( fq );
+	ScaLBL_FreeDeviceMemory( Velocity );
+	return double(L.Nfluid)*timesteps/cputime/1e6;
+}
+
+// Run the color model from a planar interface, return MLUPS and the phase field
+static double RunColor( SparseLattice &L, int timesteps, DoubleArray &phase )
+{
+	int Np = L.Np;
+	int Nx = L.Nx, Ny = L.Ny, Nz = L.Nz, N = Nx*Ny*Nz;
+	auto &Comm = L.ScaLBL_Comm;
+	auto &Comm_Regular = L.ScaLBL_Comm_Regular;
+	double *fq, *Aq, *Bq, *Den, *Phi, *Velocity;
+	ScaLBL_AllocateDeviceMemory( (void **) &fq, 19*Np*sizeof(double) );
+	ScaLBL_AllocateDeviceMemory( (void **) &Aq, 7*Np*sizeof(double) );
+	ScaLBL_AllocateDeviceMemory( (void **) &Bq, 7*Np*sizeof(double) );
+	ScaLBL_AllocateDeviceMemory( (void **) &Den, 2*Np*sizeof(double) );
+	ScaLBL_AllocateDeviceMemory( (void **) &Phi, N*sizeof(double) );
+	ScaLBL_AllocateDeviceMemory( (void **) &Velocity, 3*Np*sizeof(double) );
+	std::vector<double> PhaseLabel( N, 0.0 );
+	for (int k=0; k<Nz; k++)
+		for (int j=0; j<Ny; j++)
+			for (int i=0; i<Nx; i++){
+				int n = k*Nx*Ny + j*Nx + i;
+				if (L.Dm->id[n] > 0) PhaseLabel[n] = (k < Nz/2) ? 1.0 : -1.0;
+			}
+	ScaLBL_CopyToDevice( Phi, PhaseLabel.data(), N*sizeof(double) );
+	ScaLBL_D3Q19_Init( fq, Np );
+	ScaLBL_PhaseField_Init( L.dvcMap, Phi, Den, Aq, Bq, 0, Comm->LastExterior(), Np );
+	ScaLBL_PhaseField_Init( L.dvcMap, Phi, Den, Aq, Bq, Comm->FirstInterior(), Comm->LastInterior(), Np );
+	double rhoA = 1.0, rhoB = 1.0, tauA = 0.7, tauB = 0.7, alpha = 5e-3, beta = 0.95;
+	double Fx = 0.0, Fy = 0.0, Fz = 1e-5;
+	Comm->Barrier();
+	auto t1 = std::chrono::system_clock::now();
+	for (int t=0; t<timesteps; t+=2){
+		// odd timestep
+		Comm->BiSendD3Q7AA(Aq,Bq);
+		ScaLBL_D3Q7_AAodd_PhaseField(L.NeighborList, L.dvcMap, Aq, Bq, Den, Phi, Comm->FirstInterior(), Comm->LastInterior(), Np);
+		Comm->BiRecvD3Q7AA(Aq,Bq);
+		Comm->Barrier();
+		ScaLBL_D3Q7_AAodd_PhaseField(L.NeighborList, L.dvcMap, Aq, Bq, Den, Phi, 0, Comm->LastExterior(), Np);
+		Comm->SendD3Q19AA(fq);
+		Comm_Regular->SendHalo(Phi);
+		ScaLBL_D3Q19_AAodd_Color(L.NeighborList, L.dvcMap, fq, Aq, Bq, Den, Phi, Velocity, rhoA, rhoB, tauA, tauB,
+				alpha, beta, Fx, Fy, Fz, Nx, Nx*Ny, Comm->FirstInterior(), Comm->LastInterior(), Np);
+		Comm_Regular->RecvHalo(Phi);
+		Comm->RecvD3Q19AA(fq);
+		Comm->Barrier();
+		ScaLBL_D3Q19_AAodd_Color(L.NeighborList, L.dvcMap, fq, Aq, Bq, Den, Phi, Velocity, rhoA, rhoB, tauA, tauB,
+				alpha, beta, Fx, Fy, Fz, Nx, Nx*Ny, 0, Comm->LastExterior(), Np);
+		Comm->Barrier();
+		// even timestep
+		Comm->BiSendD3Q7AA(Aq,Bq);
+		ScaLBL_D3Q7_AAeven_PhaseField(L.dvcMap, Aq, Bq, Den, Phi, Comm->FirstInterior(), Comm->LastInterior(), Np);
+		Comm->BiRecvD3Q7AA(Aq,Bq);
+		Comm->Barrier();
+		ScaLBL_D3Q7_AAeven_PhaseField(L.dvcMap, Aq, Bq, Den, Phi, 0, Comm->LastExterior(), Np);
+		Comm->SendD3Q19AA(fq);
+		Comm_Regular->SendHalo(Phi);
+		ScaLBL_D3Q19_AAeven_Color(L.dvcMap, fq, Aq, Bq, Den, Phi, Velocity, rhoA, rhoB, tauA, tauB,
+				alpha, beta, Fx, Fy, Fz, Nx, Nx*Ny, Comm->FirstInterior(), Comm->LastInterior(), Np);
+		Comm_Regular->RecvHalo(Phi);
+		Comm->RecvD3Q19AA(fq);
+		Comm->Barrier();
+		ScaLBL_D3Q19_AAeven_Color(L.dvcMap, fq, Aq, Bq, Den, Phi, Velocity, rhoA, rhoB, tauA, tauB,
+				alpha, beta, Fx, Fy, Fz, Nx, Nx*Ny, 0, Comm->LastExterior(), Np);
+		Comm->Barrier();
+	}
+	auto t2 = std::chrono::system_clock::now();
+	double cputime = std::chrono::duration<double>( t2 - t1 ).count();
+	ScaLBL_CopyToHost( phase.data(), Phi, N*sizeof(double) );
+	ScaLBL_FreeDeviceMemory( fq );
+	ScaLBL_FreeDeviceMemory( Aq );
+	ScaLBL_FreeDeviceMemory( Bq );
+	ScaLBL_FreeDeviceMemory( Den );
+	ScaLBL_FreeDeviceMemory( Phi );
+	ScaLBL_FreeDeviceMemory( Velocity );
+	return double(L.Nfluid)*timesteps/cputime/1e6;
+}
+
+static double MaxDifference( const DoubleArray &A, const DoubleArray &B )
+{
+	double diff = 0.0;
+	for (size_t n=0; n<A.length(); n++)
+		diff = max( diff, fabs(A(n)-B(n)) );
+	return diff;
+}
+
+int main(int argc, char **argv)
+{
+	// Initialize MPI
+	Utilities::startup( argc, argv );
+	Utilities::MPI comm( MPI_COMM_WORLD );
+	int rank = comm.getRank();
+	int nprocs = comm.getSize();
+	int check=0;
+	{
+		bool benchmark = ( argc > 1 && std::string(argv[1]) == "benchmark" );
+		if (rank == 0){
+			printf("********************************************************\n");
+			printf("Running unit test: TestInteriorOrdering %s\n", benchmark ? "(benchmark)" : "");
+			printf("********************************************************\n");
+		}
+		if (!benchmark){
+			// every ordering must reproduce the raster ordering results
+			int n = 32, timesteps = 20;
+			DoubleArray Vz_ref(n+2,n+2,n+2), phase_ref(n+2,n+2,n+2);
+			DoubleArray Vz(n+2,n+2,n+2), phase(n+2,n+2,n+2);
+			for (int m=0; m<4; m++){
+				SparseLattice L;
+				CreateLattice( L, comm, n, 0.6, Orderings[m] );
+				double MLUPS_MRT = RunMRT( L, timesteps, (m == 0) ? Vz_ref : Vz );
+				double MLUPS_Color = RunColor( L, timesteps, (m == 0) ? phase_ref : phase );
+				double diff_MRT = 0.0, diff_Color = 0.0;
+				if (m > 0){
+					diff_MRT = comm.maxReduce( MaxDifference( Vz_ref, Vz ) );
+					diff_Color = comm.maxReduce( MaxDifference( phase_ref, phase ) );
+				}
+				if (rank == 0) printf("%8s: MRT %f MLUPS (diff %g), Color %f MLUPS (diff %g) \n",
+					Orderings[m], MLUPS_MRT, diff_MRT, MLUPS_Color, diff_Color);
+				if (diff_MRT > 1e-14 || diff_Color > 1e-12){
+					if (rank == 0) printf("   %s ordering does not match the raster ordering \n", Orderings[m]);
+					check++;
+				}
+			}
+		}
+		else {
+			int timesteps = 100;
+			if (argc > 2) timesteps = atoi(argv[2]);
+			int sizes[3] = { 32, 64, 128 };
+			double porosities[3] = { 1.0, 0.6, 0.35 };
+			if (rank == 0) printf("MLUPS per rank (%i ranks, %i timesteps) \n", nprocs, timesteps);
+			if (rank == 0) printf("   n  porosity  ordering       MRT     Color \n");
+			for (int s=0; s<3; s++){
+				for (int p=0; p<3; p++){
+					for (int m=0; m<4; m++){
+						SparseLattice L;
+						CreateLattice( L, comm, sizes[s], porosities[p], Orderings[m] );
+						DoubleArray Vz(L.Nx,L.Ny,L.Nz), phase(L.Nx,L.Ny,L.Nz);
+						double MLUPS_MRT = comm.sumReduce( RunMRT( L, timesteps, Vz ) )/nprocs;
+						double MLUPS_Color = comm.sumReduce( RunColor( L, timesteps, phase ) )/nprocs;
+						if (rank == 0) printf("%4i  %8.2f  %8s  %8.2f  %8.2f \n",
+							sizes[s], porosities[p], Orderings[m], MLUPS_MRT, MLUPS_Color);
+					}
+				}
+			}
+		}
+	}
+	Utilities::shutdown();
+
+	return check;
+}
@@ -0,0 +1,196 @@
+//*************************************************************************
+// Check the lattice topology shared by the Stokes, Ion and Poisson models:
+// the models get the same layout and the coupled solution is identical to
+// the one with a separate layout for each model
+//*************************************************************************
+#include <stdio.h>
+#include <iostream>
+#include <math.h>
+#include "models/StokesModel.h"
+#include "models/IonModel.h"
+#include "models/PoissonSolver.h"
+#include "models/MultiPhysController.h"
+#include "common/MPI.h"
+
+using namespace std;
+
+static void ProcessGrid( int nprocs, int &npx, int &npy )
+{
+	npx = npy = 1;
+	if (nprocs == 2) npx = 2;
+	if (nprocs == 4) npx = npy = 2;
+}
+
+// solid walls at x = 0,1 and x = Nx-2,Nx-1 with a sphere in the channel
+static void WriteImage( const char *filename, int Nx, int Ny, int Nz )
+{
+	std::vector<signed char> data( Nx*Ny*Nz );
+	for (int z=0; z<Nz; z++){
+		for (int y=0; y<Ny; y++){
+			for (int x=0; x<Nx; x++){
+				double dx = x-0.5*Nx, dy = (y%16)-7.5, dz = (z%16)-7.5;
+				signed char label = 1;
+				if ( x < 2 || x >= Nx-2 ) label = 0;
+				if ( dx*dx + dy*dy + dz*dz < 9.0 ) label = 0;
+				data[(z*Ny+y)*Nx+x] = label;
+			}
+		}
+	}
+	FILE *OUT = fopen( filename, "wb" );
+	fwrite( data.data(), 1, data.size(), OUT );
+	fclose( OUT );
+}
+
+static void WriteDatabase( const char *filename, int nprocs, int n )
+{
+	int npx, npy;
+	ProcessGrid( nprocs, npx, npy );
+	FILE *OUT = fopen( filename, "w" );
+	fprintf( OUT,
+		"MultiphysController {\n"
+		"  timestepMax = 4\n"
+		"}\n"
+		"Stokes {\n"
+		"  tau = 1.0\n"
+		"  F = 0, 0, 0\n"
+		"  nu_phys = 1.0e-6\n"
+		"  rho_phys = 1000.0\n"
+		"  SolidLabels = 0\n"
+		"  ZetaPotentialSolidList = -0.05\n"
+		"}\n"
+		"Ions {\n"
+		"  number_ion_species = 2\n"
+		"  tauList = 1.0, 1.0\n"
+		"  IonDiffusivityList = 1.0e-9, 2.0e-9\n"
+		"  IonValenceList = 1, -1\n"
+		"  IonConcentrationList = 1.0e-3, 1.0e-3\n"
+		"  temperature = 298\n"
+		"}\n"
+		"Poisson {\n"
+		"  epsilonR = 78.5\n"
+		"  timestepMax = 100\n"
+		"  analysis_interval = 20\n"
+		"  tolerance = 1e-6\n"
+		"  SolidLabels = 0\n"
+		"  SolidValues = -1.0e-6\n"
+		"  BC_Solid = 2\n"
+		"}\n"
+		"Domain {\n"
+		"  Filename = \"TestLatticeTopology.raw\"\n"
+		"  ReadType = \"8bit\"\n"
+		"  nproc = %i, %i, 1\n"
+		"  n = %i, %i, %i\n"
+		"  N = %i, %i, %i\n"
+		"  voxel_length = 1.0\n"
+		"  ReadValues = 0, 1\n"
+		"  WriteValues = 0, 1\n"
+		"  BC = 0\n"
+		"}\n", npx, npy, n, n, n, npx*n, npy*n, n );
+	fclose( OUT );
+}
+
+// Run a few coupled steps, return the electric field, velocity and ion concentrations
+static void RunCoupled( const Utilities::MPI &comm, const char *filename, bool shared,
+	std::vector<double> &fields, int &Np, int &neighbor_lists )
+{
+	int rank = comm.getRank(), nprocs = comm.getSize();
+	ScaLBL_StokesModel StokesModel( rank, nprocs, comm );
+	ScaLBL_IonModel IonModel( rank, nprocs, comm );
+	ScaLBL_Poisson PoissonSolver( rank, nprocs, comm );
+	ScaLBL_Multiphys_Controller Study( rank, nprocs, comm );
+	Study.ReadParams( filename );
+	StokesModel.ReadParams( filename );
+	IonModel.ReadParams( filename );
+	PoissonSolver.ReadParams( filename );
+	if (shared){
+		auto Lattice = std::make_shared<ScaLBL_LatticeTopology>( StokesModel.domain_db, StokesModel.BoundaryCondition, comm );
+		StokesModel.AttachLattice( Lattice );
+		IonModel.AttachLattice( Lattice );
+		PoissonSolver.AttachLattice( Lattice );
+	}
+	StokesModel.SetDomain();
+	StokesModel.ReadInput();
+	StokesModel.Create();
+	IonModel.SetDomain();
+	IonModel.ReadInput();
+	IonModel.Create();
+	StokesModel.timestepMax = Study.getStokesNumIter_PNP_coupling( StokesModel.time_conv, IonModel.time_conv );
+	StokesModel.Initialize();
+	IonModel.timestepMax = Study.getIonNumIter_PNP_coupling( StokesModel.time_conv, IonModel.time_conv );
+	IonModel.Initialize();
+	Study.getTimeConvMax_PNP_coupling( StokesModel.time_conv, IonModel.time_conv );
+	PoissonSolver.SetDomain();
+	PoissonSolver.ReadInput();
+	PoissonSolver.Create();
+	PoissonSolver.Initialize( Study.time_conv_max );
+	for (int timestep=1; timestep<Study.timestepMax; timestep+=2){
+		PoissonSolver.Run( IonModel.ChargeDensity, timestep );
+		StokesModel.Run_Lite( IonModel.ChargeDensity, PoissonSolver.ElectricField );
+		IonModel.Run( StokesModel.Velocity, PoissonSolver.ElectricField );
+	}
+	Np = IonModel.Np;
+	neighbor_lists = ( StokesModel.NeighborList == IonModel.NeighborList ) + ( IonModel.NeighborList == PoissonSolver.NeighborList );
+	// compare in the regular layout so the two runs need not share a layout
+	int nfields = 3 + 3 + IonModel.number_ion_species;
+	int N = StokesModel.N;
+	fields.assign( nfields*N, 0.0 );
+	DoubleArray Values( StokesModel.Nx, StokesModel.Ny, StokesModel.Nz );
+	for (int m=0; m<nfields; m++){
+		double *field;
+		if (m < 3)      field = &PoissonSolver.ElectricField[m*PoissonSolver.Np];
+		else if (m < 6) field = &StokesModel.Velocity[(m-3)*StokesModel.Np];
+		else            field = &IonModel.Ci[(m-6)*IonModel.Np];
+		Values.fill( 0 );
+		IonModel.ScaLBL_Comm->RegularLayout( IonModel.Map, field, Values );
+		for (int n=0; n<N; n++) fields[m*N+n] = Values(n);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	// Initialize MPI
+	Utilities::startup( argc, argv );
+	Utilities::MPI comm( MPI_COMM_WORLD );
+	int rank = comm.getRank();
+	int check=0;
+	{
+		if (rank == 0){
+			printf("********************************************************\n");
+			printf("Running unit test: TestLatticeTopology	\n");
+			printf("********************************************************\n");
+		}
+		int n = 16;
+		if (argc > 1) n = atoi(argv[1]);
+		int npx, npy;
+		ProcessGrid( comm.getSize(), npx, npy );
+		if (rank == 0){
+			WriteImage( "TestLatticeTopology.raw", npx*n, npy*n, n );
+			WriteDatabase( "TestLatticeTopology.db", comm.getSize(), n );
+		}
+		comm.barrier();
+
+		std::vector<double> separate, shared;
+		int Np_separate, Np_shared, lists_separate, lists_shared;
+		RunCoupled( comm, "TestLatticeTopology.db", false, separate, Np_separate, lists_separate );
+		RunCoupled( comm, "TestLatticeTopology.db", true, shared, Np_shared, lists_shared );
+		// maximum of the electric field, velocity and concentrations
+		size_t N = separate.size()/8;
+		double diff = 0.0, vmax[3] = { 0.0, 0.0, 0.0 };
+		bool finite = true;
+		for (size_t i=0; i<shared.size(); i++){
+			int group = ( i < 3*N ) ? 0 : ( ( i < 6*N ) ? 1 : 2 );
+			diff = max( diff, fabs( shared[i] - separate[i] ) );
+			vmax[group] = max( vmax[group], fabs( separate[i] ) );
+			if ( shared[i] != shared[i] || separate[i] != separate[i] ) finite = false;
+		}
+		diff = comm.maxReduce( diff );
+		for (int g=0; g<3; g++) vmax[g] = comm.maxReduce( vmax[g] );
+		int errors = comm.sumReduce( ( Np_shared != Np_separate || lists_separate != 0 || lists_shared != 2 || !finite ) ? 1 : 0 );
+		if (rank == 0) printf("Np = %i, shared neighbor lists = %i (%i separate), max |E| %g, |u| %g, C %g, max difference %g \n",
+			Np_shared, lists_shared, lists_separate, vmax[0], vmax[1], vmax[2], diff);
+		if ( errors > 0 || diff != 0.0 || vmax[0] == 0.0 || vmax[1] == 0.0 || vmax[2] == 0.0 ) check++;
+	}
+	Utilities::shutdown();
+
+	return check;
+}
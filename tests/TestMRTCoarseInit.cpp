@@ -0,0 +1,113 @@
+//*************************************************************************
+// Check the coarse-grid initial condition of the MRT model: after a few
+// timesteps the permeability is much closer to the converged value than
+// when starting from rest, and the converged value is unchanged
+//*************************************************************************
+#include <stdio.h>
+#include <iostream>
+#include <math.h>
+#include "models/MRTModel.h"
+#include "common/MPI.h"
+
+using namespace std;
+
+static void ProcessGrid( int nprocs, int &npx, int &npy )
+{
+	npx = npy = 1;
+	if (nprocs == 2) npx = 2;
+	if (nprocs == 4) npx = npy = 2;
+}
+
+// solid spheres on a regular lattice
+static void WriteImage( const char *filename, int Nx, int Ny, int Nz )
+{
+	std::vector<signed char> data( Nx*Ny*Nz );
+	for (int z=0; z<Nz; z++){
+		for (int y=0; y<Ny; y++){
+			for (int x=0; x<Nx; x++){
+				double dx = (x%16)-7.5, dy = (y%16)-7.5, dz = (z%16)-7.5;
+				data[(z*Ny+y)*Nx+x] = ( dx*dx + dy*dy + dz*dz < 36.0 ) ? 0 : 1;
+			}
+		}
+	}
+	FILE *OUT = fopen( filename, "wb" );
+	fwrite( data.data(), 1, data.size(), OUT );
+	fclose( OUT );
+}
+
+static std::shared_ptr<Database> MRTDatabase( int nprocs, int n, int coarse_levels, int timestepMax )
+{
+	int npx, npy;
+	ProcessGrid( nprocs, npx, npy );
+	char text[1024];
+	sprintf(text,
+		"MRT {\n"
+		"  tau = 1.0\n"
+		"  F = 0, 0, 1e-5\n"
+		"  timestepMax = %i\n"
+		"  tolerance = 1e-6\n"
+		"  analysis_interval = 100\n"
+		"  coarse_levels = %i\n"
+		"}\n"
+		"Domain {\n"
+		"  Filename = \"TestMRTCoarseInit.raw\"\n"
+		"  ReadType = \"8bit\"\n"
+		"  nproc = %i, %i, 1\n"
+		"  n = %i, %i, %i\n"
+		"  N = %i, %i, %i\n"
+		"  voxel_length = 1.0\n"
+		"  ReadValues = 0, 1\n"
+		"  WriteValues = 0, 1\n"
+		"  BC = 0\n"
+		"}\n", timestepMax, coarse_levels, npx, npy, n, n, n, npx*n, npy*n, n );
+	return Database::createFromString( text );
+}
+
+static double Permeability( const Utilities::MPI &comm, int n, int coarse_levels, int timestepMax )
+{
+	ScaLBL_MRTModel MRT( comm.getRank(), comm.getSize(), comm );
+	MRT.ReadParams( MRTDatabase( comm.getSize(), n, coarse_levels, timestepMax ) );
+	MRT.SetDomain();
+	MRT.ReadInput();
+	MRT.Create();
+	MRT.Initialize();
+	MRT.Run();
+	return MRT.absperm;
+}
+
+int main(int argc, char **argv)
+{
+	// Initialize MPI
+	Utilities::startup( argc, argv );
+	Utilities::MPI comm( MPI_COMM_WORLD );
+	int rank = comm.getRank();
+	int check=0;
+	{
+		if (rank == 0){
+			printf("********************************************************\n");
+			printf("Running unit test: TestMRTCoarseInit	\n");
+			printf("********************************************************\n");
+		}
+		int n = 32;
+		if (argc > 1) n = atoi(argv[1]);
+		int npx, npy;
+		ProcessGrid( comm.getSize(), npx, npy );
+		if (rank == 0) WriteImage( "TestMRTCoarseInit.raw", npx*n, npy*n, n );
+		comm.barrier();
+		double k_ref = Permeability( comm, n, 0, 20000 );
+		double k_coarse = Permeability( comm, n, 1, 20000 );
+		double k0 = Permeability( comm, n, 0, 100 );
+		double k1 = Permeability( comm, n, 1, 100 );
+		double err0 = fabs( k0 - k_ref ) / k_ref;
+		double err1 = fabs( k1 - k_ref ) / k_ref;
+		double err_converged = fabs( k_coarse - k_ref ) / k_ref;
+		if (rank == 0){
+			printf("converged permeability: %f (from rest), %f (coarse initial condition) \n", k_ref, k_coarse);
+			printf("relative error after 100 timesteps: %g (from rest), %g (coarse initial condition) \n", err0, err1);
+		}
+		if ( err_converged > 1e-4 || err1 > 0.5*err0 ) check++;
+	}
+	Utilities::shutdown();
+
+	return check;
+}
@@ -0,0 +1,111 @@
+//*************************************************************************
+// Check the memory accounting of the ScaLBL allocations: named and scoped
+// tags, current and peak bytes, and the predicted buffers of the
+// ScaLBL_Communicator against the ones it allocates
+//*************************************************************************
+#include <stdio.h>
+#include <iostream>
+#include <math.h>
+#include "common/MPI.h"
+#include "common/Utilities.h"
+#include "common/ScaLBL.h"
+
+using namespace std;
+
+static ScaLBL_MemoryUsage GetUsage( const std::vector<ScaLBL_MemoryUsage> &usage, const std::string &name )
+{
+	for (const auto &tag : usage)
+		if (tag.name == name) return tag;
+	return { name, 0, 0 };
+}
+
+static void ProcessGrid( int nprocs, int &npx, int &npy )
+{
+	npx = npy = 1;
+	if (nprocs == 2) npx = 2;
+	if (nprocs == 4) npx = npy = 2;
+}
+
+int main(int argc, char **argv)
+{
+	// Initialize MPI
+	Utilities::startup( argc, argv );
+	Utilities::MPI comm( MPI_COMM_WORLD );
+	int rank = comm.getRank();
+	int check=0;
+	{
+		if (rank == 0){
+			printf("********************************************************\n");
+			printf("Running unit test: TestMemoryReport	\n");
+			printf("********************************************************\n");
+		}
+		// named and scoped tags
+		double *a, *b, *c;
+		ScaLBL_AllocateDeviceMemory( (void **) &a, 1000*sizeof(double), "test a" );
+		{
+			ScaLBL_MemoryTag tag( "test scope" );
+			ScaLBL_AllocateDeviceMemory( (void **) &b, 300*sizeof(double) );
+			ScaLBL_AllocateDeviceMemory( (void **) &c, 200*sizeof(double), "test a" );
+		}
+		auto usage = ScaLBL_GetMemoryUsage();
+		if ( GetUsage( usage, "test a" ).current != 1200*sizeof(double) ) check++;
+		if ( GetUsage( usage, "test scope" ).current != 300*sizeof(double) ) check++;
+		size_t total = GetUsage( usage, "total" ).current;
+		// the peak remains after the free, the tag ends with its scope
+		ScaLBL_FreeDeviceMemory( a );
+		ScaLBL_AllocateDeviceMemory( (void **) &a, 100*sizeof(double) );
+		usage = ScaLBL_GetMemoryUsage();
+		auto tag_a = GetUsage( usage, "test a" );
+		if ( tag_a.current != 200*sizeof(double) || tag_a.peak != 1200*sizeof(double) ) check++;
+		if ( GetUsage( usage, "other" ).current < 100*sizeof(double) ) check++;
+		if ( GetUsage( usage, "total" ).current + 900*sizeof(double) != total ) check++;
+		ScaLBL_FreeDeviceMemory( a );
+		ScaLBL_FreeDeviceMemory( b );
+		ScaLBL_FreeDeviceMemory( c );
+		if ( GetUsage( ScaLBL_GetMemoryUsage(), "test scope" ).current != 0 ) check++;
+		if (rank == 0) printf("Tags checked \n");
+
+		// the buffers of a communicator match the prediction from the halo of the domain
+		int npx, npy;
+		ProcessGrid( comm.getSize(), npx, npy );
+		auto db = std::make_shared<Database>();
+		db->putScalar<int>( "BC", 0 );
+		db->putVector<int>( "nproc", { npx, npy, 1 } );
+		db->putVector<int>( "n", { 16, 12, 10 } );
+		db->putScalar<int>( "nspheres", 0 );
+		db->putVector<double>( "L", { 1, 1, 1 } );
+		auto Dm = std::make_shared<Domain>( db, comm );
+		int Nx = Dm->Nx, Ny = Dm->Ny, Nz = Dm->Nz;
+		for (int k=0; k<Nz; k++){
+			for (int j=0; j<Ny; j++){
+				for (int i=0; i<Nx; i++){
+					Dm->id[(k*Ny+j)*Nx+i] = ( (i+2*j+3*k) % 7 == 0 ) ? 0 : 1;
+				}
+			}
+		}
+		Dm->CommInit();
+		int Np = Dm->PoreCount();
+		size_t before = GetUsage( ScaLBL_GetMemoryUsage(), "comm buffers" ).current;
+		auto ScaLBL_Comm = std::make_shared<ScaLBL_Communicator>( Dm );
+		size_t buffers = GetUsage( ScaLBL_GetMemoryUsage(), "comm buffers" ).current - before;
+		auto predicted = ScaLBL_PredictMemory( "mrt", *Dm, Np );
+		size_t expected = GetUsage( predicted, "comm buffers" ).current;
+		if ( buffers != expected ) check++;
+		// the model arrays scale with the number of sites
+		size_t sum = 0;
+		for (const auto &tag : predicted)
+			if (tag.name != "total") sum += tag.current;
+		if ( sum != GetUsage( predicted, "total" ).current ) check++;
+		if ( GetUsage( predicted, "fq" ).current != 19*Np*sizeof(double) ) check++;
+		ScaLBL_MemoryReport( comm, "TestMemoryReport" );
+		ScaLBL_MemoryReport( comm, "predicted MRT model", predicted );
+		if (rank == 0) printf("Communicator buffers: %zu bytes, predicted %zu \n", buffers, expected);
+		ScaLBL_Comm.reset();
+		if ( GetUsage( ScaLBL_GetMemoryUsage(), "comm buffers" ).current != before ) check++;
+		check = comm.sumReduce( check );
+		if (rank == 0) printf("%i errors \n", check);
+	}
+	Utilities::shutdown();
+
+	return check;
+}
@@ -0,0 +1,140 @@
+//*************************************************************************
+// Check the adaptive coupling of the multiphysics controller: a solver is
+// skipped while its inputs change less than coupling_tolerance, runs when
+// the accumulated change exceeds it or after coupling_max_skip steps, and
+// a solver with constant forcing keeps running while its own state evolves
+//*************************************************************************
+#include <stdio.h>
+#include <iostream>
+#include <math.h>
+#include "models/MultiPhysController.h"
+#include "common/MPI.h"
+
+using namespace std;
+
+static std::shared_ptr<Database> ControllerDatabase( bool adaptive )
+{
+	char text[1024];
+	sprintf(text,
+		"MultiphysController {\n"
+		"  timestepMax = 100\n"
+		"  adaptive_coupling = %s\n"
+		"  coupling_tolerance = 1e-3\n"
+		"  coupling_max_skip = 4\n"
+		"}\n", adaptive ? "true" : "false" );
+	return Database::createFromString( text );
+}
+
+static void SetField( double *field, std::vector<double> &host, double scale )
+{
+	for (size_t n=0; n<host.size(); n++)
+		host[n] = scale*(1.0 + 0.01*(n%7));
+	ScaLBL_CopyToDevice( field, host.data(), host.size()*sizeof(double) );
+}
+
+// Run the schedule, return the decisions of solvers A (one input) and B (two inputs)
+static void RunSchedule( const Utilities::MPI &comm, bool adaptive, std::vector<int> &A, std::vector<int> &B )
+{
+	int Np = 1000;
+	double *field1, *field2;
+	std::vector<double> host1( Np ), host2( 3*Np );
+	ScaLBL_AllocateDeviceMemory( (void **) &field1, Np*sizeof(double) );
+	ScaLBL_AllocateDeviceMemory( (void **) &field2, 3*Np*sizeof(double) );
+	ScaLBL_Multiphys_Controller Study( comm.getRank(), comm.getSize(), comm );
+	Study.ReadParams( ControllerDatabase( adaptive ) );
+	int solverA = Study.AddCoupledSolver( "A" );
+	Study.AddCouplingInput( solverA, field1, Np );
+	int solverB = Study.AddCoupledSolver( "B" );
+	Study.AddCouplingInput( solverB, field1, Np );
+	Study.AddCouplingInput( solverB, field2, 3*Np );
+	// field1 drifts by 4e-4 per step, field2 jumps at step 2
+	double scale1[] = { 1.0, 1.0004, 1.0008, 1.0012, 1.0012, 1.0012, 1.0012, 1.0012, 1.0012, 1.0012 };
+	double scale2[] = { 1.0, 1.0, 2.0, 2.0, 2.0, 2.0, 2.0, 2.0, 2.0, 2.0 };
+	A.clear();
+	B.clear();
+	for (int step=0; step<10; step++){
+		SetField( field1, host1, scale1[step] );
+		SetField( field2, host2, scale2[step] );
+		A.push_back( Study.SolveRequired( solverA ) ? 1 : 0 );
+		B.push_back( Study.SolveRequired( solverB, step == 9 ) ? 1 : 0 );
+	}
+	Study.CouplingReport();
+	ScaLBL_FreeDeviceMemory( field1 );
+	ScaLBL_FreeDeviceMemory( field2 );
+}
+
+// A solver with a constant forcing input whose state (also an input) relaxes by a factor 10 per solve
+static void RunEvolving( const Utilities::MPI &comm, std::vector<int> &C )
+{
+	int Np = 1000;
+	double *forcing, *state;
+	std::vector<double> host_forcing( Np ), host_state( 3*Np );
+	ScaLBL_AllocateDeviceMemory( (void **) &forcing, Np*sizeof(double) );
+	ScaLBL_AllocateDeviceMemory( (void **) &state, 3*Np*sizeof(double) );
+	ScaLBL_Multiphys_Controller Study( comm.getRank(), comm.getSize(), comm );
+	Study.ReadParams( ControllerDatabase( true ) );
+	int solverC = Study.AddCoupledSolver( "C" );
+	Study.AddCouplingInput( solverC, forcing, Np );
+	Study.AddCouplingInput( solverC, state, 3*Np );
+	SetField( forcing, host_forcing, 1.0 );
+	double s = 0.0;
+	SetField( state, host_state, s );
+	C.clear();
+	for (int step=0; step<10; step++){
+		bool solve = Study.SolveRequired( solverC );
+		C.push_back( solve ? 1 : 0 );
+		if (solve){
+			s = 1.0 - 0.1*(1.0-s);
+			SetField( state, host_state, s );
+		}
+	}
+	Study.CouplingReport();
+	ScaLBL_FreeDeviceMemory( forcing );
+	ScaLBL_FreeDeviceMemory( state );
+}
+
+static int Compare( int rank, const char *name, const std::vector<int> &result, const std::vector<int> &expected )
+{
+	int errors = 0;
+	for (size_t i=0; i<expected.size(); i++)
+		if ( result[i] != expected[i] ) errors++;
+	if (rank == 0){
+		printf("%s:", name);
+		for (auto r : result) printf(" %i", r);
+		printf(errors ? " (wrong) \n" : " \n");
+	}
+	return errors > 0 ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+	// Initialize MPI
+	Utilities::startup( argc, argv );
+	Utilities::MPI comm( MPI_COMM_WORLD );
+	int rank = comm.getRank();
+	int check=0;
+	{
+		if (rank == 0){
+			printf("********************************************************\n");
+			printf("Running unit test: TestMultiphysCoupling	\n");
+			printf("********************************************************\n");
+		}
+		std::vector<int> A, B;
+		RunSchedule( comm, false, A, B );
+		check += Compare( rank, "fixed coupling, solver A", A, { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 } );
+		check += Compare( rank, "fixed coupling, solver B", B, { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 } );
+		RunSchedule( comm, true, A, B );
+		// A: the change to the reference exceeds 1e-3 at step 3, max_skip forces step 8
+		check += Compare( rank, "adaptive coupling, solver A", A, { 1, 0, 0, 1, 0, 0, 0, 0, 1, 0 } );
+		// B: field2 changes at step 2, max_skip forces step 7, step 9 is forced by the caller
+		check += Compare( rank, "adaptive coupling, solver B", B, { 1, 0, 1, 0, 0, 0, 0, 1, 0, 1 } );
+		// C: the forcing is constant, the state changes by 9e-3 in the solve of step 2 and by
+		// 9e-4 in the solve of step 3, max_skip forces step 8
+		std::vector<int> C;
+		RunEvolving( comm, C );
+		check += Compare( rank, "adaptive coupling, evolving solver C", C, { 1, 1, 1, 1, 0, 0, 0, 0, 1, 0 } );
+	}
+	Utilities::shutdown();
+
+	return check;
+}
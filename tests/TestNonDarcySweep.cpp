@@ -0,0 +1,150 @@
+//*************************************************************************
+// Check the BGK collision and the non-Darcy sweep of the MRT model: BGK
+// and MRT agree on the permeability at tau = 1 (up to the viscosity
+// dependent wall location of BGK), a level of the sweep has the steady
+// state of a run started from rest with the same force in fewer timesteps,
+// and the Reynolds number grows with the force
+//*************************************************************************
+#include <stdio.h>
+#include <iostream>
+#include <math.h>
+#include "models/MRTModel.h"
+#include "common/MPI.h"
+
+using namespace std;
+
+static void ProcessGrid( int nprocs, int &npx, int &npy )
+{
+	npx = npy = 1;
+	if (nprocs == 2) npx = 2;
+	if (nprocs == 4) npx = npy = 2;
+}
+
+// solid spheres on a regular lattice
+static void WriteImage( const char *filename, int Nx, int Ny, int Nz )
+{
+	std::vector<signed char> data( Nx*Ny*Nz );
+	for (int z=0; z<Nz; z++){
+		for (int y=0; y<Ny; y++){
+			for (int x=0; x<Nx; x++){
+				double dx = (x%16)-7.5, dy = (y%16)-7.5, dz = (z%16)-7.5;
+				data[(z*Ny+y)*Nx+x] = ( dx*dx + dy*dy + dz*dz < 36.0 ) ? 0 : 1;
+			}
+		}
+	}
+	FILE *OUT = fopen( filename, "wb" );
+	fwrite( data.data(), 1, data.size(), OUT );
+	fclose( OUT );
+}
+
+static std::shared_ptr<Database> MRTDatabase( int nprocs, int n, const char *collision, double Fz, int sweep_levels )
+{
+	int npx, npy;
+	ProcessGrid( nprocs, npx, npy );
+	char text[1024];
+	sprintf(text,
+		"MRT {\n"
+		"  tau = 1.0\n"
+		"  F = 0, 0, %g\n"
+		"  timestepMax = 20000\n"
+		"  tolerance = 1e-6\n"
+		"  analysis_interval = 100\n"
+		"  collision = \"%s\"\n"
+		"  sweep_levels = %i\n"
+		"  sweep_factor = 4.0\n"
+		"}\n"
+		"Domain {\n"
+		"  Filename = \"TestNonDarcySweep.raw\"\n"
+		"  ReadType = \"8bit\"\n"
+		"  nproc = %i, %i, 1\n"
+		"  n = %i, %i, %i\n"
+		"  N = %i, %i, %i\n"
+		"  voxel_length = 1.0\n"
+		"  ReadValues = 0, 1\n"
+		"  WriteValues = 0, 1\n"
+		"  BC = 0\n"
+		"}\n", Fz, collision, sweep_levels, npx, npy, n, n, n, npx*n, npy*n, n );
+	return Database::createFromString( text );
+}
+
+static void Setup( ScaLBL_MRTModel &MRT, const Utilities::MPI &comm, int n, const char *collision, double Fz, int sweep_levels )
+{
+	MRT.ReadParams( MRTDatabase( comm.getSize(), n, collision, Fz, sweep_levels ) );
+	MRT.SetDomain();
+	MRT.ReadInput();
+	MRT.Create();
+	MRT.Initialize();
+}
+
+int main(int argc, char **argv)
+{
+	// Initialize MPI
+	Utilities::startup( argc, argv );
+	Utilities::MPI comm( MPI_COMM_WORLD );
+	int rank = comm.getRank();
+	int check=0;
+	{
+		if (rank == 0){
+			printf("********************************************************\n");
+			printf("Running unit test: TestNonDarcySweep	\n");
+			printf("********************************************************\n");
+		}
+		int n = 16;
+		int npx, npy;
+		ProcessGrid( comm.getSize(), npx, npy );
+		if (rank == 0) WriteImage( "TestNonDarcySweep.raw", npx*n, npy*n, n );
+		comm.barrier();
+		const double F0 = 1.0e-4;
+
+		// BGK and MRT permeability (the BGK permeability depends on tau, it is close to MRT at tau = 1)
+		double k_mrt, k_bgk;
+		{
+			ScaLBL_MRTModel MRT( rank, comm.getSize(), comm );
+			Setup( MRT, comm, n, "MRT", F0, 0 );
+			MRT.Run();
+			k_mrt = MRT.absperm;
+		}
+		{
+			ScaLBL_MRTModel BGK( rank, comm.getSize(), comm );
+			Setup( BGK, comm, n, "BGK", F0, 0 );
+			BGK.Run();
+			k_bgk = BGK.absperm;
+		}
+		if (rank == 0) printf("permeability: %f (MRT), %f (BGK) \n", k_mrt, k_bgk);
+		if ( !( fabs( k_bgk - k_mrt ) < 0.15*k_mrt ) ) check++;
+
+		// sweep of three forces and a run from rest with the last one
+		ScaLBL_MRTModel Sweep( rank, comm.getSize(), comm );
+		Setup( Sweep, comm, n, "MRT", F0, 3 );
+		Sweep.RunSweep();
+		ScaLBL_MRTModel Cold( rank, comm.getSize(), comm );
+		Setup( Cold, comm, n, "MRT", 16.0*F0, 0 );
+		Cold.Run();
+		if ( Sweep.NonDarcy.size() != 3 ){
+			check++;
+		}
+		else {
+			const auto &last = Sweep.NonDarcy[2];
+			double diff = fabs( last.vz - Cold.vaz ) / Cold.vaz;
+			if (rank == 0){
+				for (const auto &point : Sweep.NonDarcy)
+					printf("   Fz = %g: vz = %g, Re = %g, Fo = %g, %i timesteps%s \n", point.Fz, point.vz, point.Re, point.Fo,
+						point.timesteps, point.converged ? "" : " (NOT converged)");
+				printf("from rest: vz = %g, %i timesteps (difference %g) \n", Cold.vaz, Cold.timestep, diff);
+			}
+			if ( fabs( last.Fz - 16.0*F0 ) > 1e-12 ) check++;
+			if ( !( diff < 1e-3 ) || !Cold.converged ) check++;
+			for (int i=0; i<3; i++){
+				if ( !Sweep.NonDarcy[i].converged ) check++;
+				if ( i == 0 ) continue;
+				// the warm start pays off
+				if ( !( Sweep.NonDarcy[i].timesteps < Cold.timestep ) ) check++;
+				if ( !( Sweep.NonDarcy[i].Re > Sweep.NonDarcy[i-1].Re ) ) check++;
+			}
+		}
+		if (rank == 0) printf("%i errors \n", check);
+	}
+	Utilities::shutdown();
+
+	return check;
+}
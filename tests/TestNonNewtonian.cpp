@@ -0,0 +1,139 @@
+//*************************************************************************
+// Check the non-Newtonian model: the predicted footprint, the flow of a power
+// law fluid between two plates against the analytic velocity profile, and
+// with a flow index of one the collision is the MRT collision
+//*************************************************************************
+#include <stdio.h>
+#include <iostream>
+#include <math.h>
+#include "common/MPI.h"
+#include "common/Utilities.h"
+#include "common/ScaLBL.h"
+#include "models/NonNewtonianModel.h"
+
+using namespace std;
+
+static void ProcessGrid( int nprocs, int &npx, int &npz )
+{
+	npx = npz = 1;
+	if (nprocs == 2) npx = 2;
+	if (nprocs == 4) npx = npz = 2;
+}
+
+// Velocity of a power law fluid (consistency K, flow index n) driven by the force G
+// between plates at y = +/- h
+static double PowerLawVelocity( double y, double h, double G, double K, double n )
+{
+	return n/(n+1.0)*pow( G/K, 1.0/n )*( pow( h, 1.0+1.0/n ) - pow( fabs(y), 1.0+1.0/n ) );
+}
+
+int main(int argc, char **argv)
+{
+	// Initialize MPI
+	Utilities::startup( argc, argv );
+	Utilities::MPI comm( MPI_COMM_WORLD );
+	int rank = comm.getRank();
+	int nprocs = comm.getSize();
+	int check=0;
+	{
+		if (rank == 0){
+			printf("********************************************************\n");
+			printf("Running unit test: TestNonNewtonian	\n");
+			printf("********************************************************\n");
+		}
+		// plates normal to y in each subdomain, flow along z
+		int npx, npz;
+		ProcessGrid( nprocs, npx, npz );
+		const double K = 0.1, n = 0.7, G = 1.0e-4;
+		auto db = std::make_shared<Database>();
+		auto domain_db = std::make_shared<Database>();
+		db->putDatabase( "Domain", domain_db );
+		domain_db->putScalar<int>( "BC", 0 );
+		domain_db->putVector<int>( "nproc", { npx, 1, npz } );
+		domain_db->putVector<int>( "n", { 4, 24, 4 } );
+		domain_db->putVector<double>( "L", { 1, 1, 1 } );
+		auto nonnewtonian_db = std::make_shared<Database>();
+		db->putDatabase( "NonNewtonian", nonnewtonian_db );
+		nonnewtonian_db->putScalar<std::string>( "rheology", "power_law" );
+		nonnewtonian_db->putScalar<double>( "tau", 0.5+3.0*K );
+		nonnewtonian_db->putScalar<double>( "n", n );
+		nonnewtonian_db->putScalar<double>( "tau_max", 20.0 );
+		nonnewtonian_db->putVector<double>( "F", { 0, 0, G } );
+		nonnewtonian_db->putScalar<int>( "timestepMax", 6000 );
+		nonnewtonian_db->putScalar<double>( "tolerance", 1.0e-10 );
+		nonnewtonian_db->putScalar<int>( "analysis_interval", 500 );
+
+		ScaLBL_NonNewtonianModel Model( rank, nprocs, comm );
+		Model.ReadParams( db );
+		Model.SetDomain();
+		int Nx = Model.Nx, Ny = Model.Ny, Nz = Model.Nz;
+		for (int k=0; k<Nz; k++){
+			for (int j=0; j<Ny; j++){
+				for (int i=0; i<Nx; i++){
+					Model.Mask->id[(k*Ny+j)*Nx+i] = ( j <= 1 || j >= Ny-2 ) ? 0 : 1;
+				}
+			}
+		}
+		Model.Create();
+		Model.Initialize();
+		// the arrays of the model match the predicted footprint
+		auto usage = ScaLBL_GetMemoryUsage();
+		for (const auto &array : ScaLBL_PredictMemory( "nonnewtonian", *Model.Mask, Model.Np )){
+			if (array.name == "total") continue;
+			size_t bytes = 0;
+			for (const auto &tag : usage)
+				if (tag.name == array.name) bytes = tag.current;
+			if ( bytes != array.current ){
+				printf("%s: %zu bytes, predicted %zu \n", array.name.c_str(), bytes, array.current);
+				check++;
+			}
+		}
+		Model.Run();
+		Model.VelocityField();
+
+		// the walls are half way between the solid and the fluid sites
+		double h = 0.5*(Ny-4);
+		double yc = 0.5*(Ny-1);
+		double umax = PowerLawVelocity( 0.0, h, G, K, n );
+		double error = 0.0;
+		for (int j=2; j<Ny-2; j++){
+			double u = Model.Velocity_z( 1, j, 1 );
+			double u_exact = PowerLawVelocity( j-yc, h, G, K, n );
+			error = std::max( error, fabs( u-u_exact )/umax );
+		}
+		error = comm.maxReduce( error );
+		if (rank == 0) printf("Power law profile: umax = %g, relative error %g \n", umax, error);
+		if ( !( error < 0.02 ) ) check++;
+
+		// with n = 1 the collision is the MRT collision with the same viscosity
+		int Np = Model.Np;
+		std::vector<double> f( 19*size_t(Np) ), f_mrt( 19*size_t(Np) );
+		double *dist;
+		ScaLBL_AllocateDeviceMemory( (void **) &dist, 19*Np*sizeof(double) );
+		ScaLBL_CopyToDevice( dist, Model.fq, 19*Np*sizeof(double) );
+		double rlx_setA = 1.0/(3.0*K+0.5);
+		double rlx_setB = 8.0*(2.0-rlx_setA)/(8.0-rlx_setA);
+		ScaLBL_D3Q19_AAodd_MRT( Model.NeighborList, dist, 0, Np, Np, rlx_setA, rlx_setB, 0.0, 0.0, G );
+		ScaLBL_D3Q19_AAeven_MRT( dist, 0, Np, Np, rlx_setA, rlx_setB, 0.0, 0.0, G );
+		ScaLBL_D3Q19_AAodd_NonNewtonianMRT( Model.NeighborList, Model.fq, Model.Viscosity, 0, Np, Np,
+				0, K, 0.0, 0.0, 1.0, Model.nu_min, Model.nu_max, 0.0, 0.0, G );
+		ScaLBL_D3Q19_AAeven_NonNewtonianMRT( Model.fq, Model.Viscosity, 0, Np, Np,
+				0, K, 0.0, 0.0, 1.0, Model.nu_min, Model.nu_max, 0.0, 0.0, G );
+		ScaLBL_DeviceBarrier();
+		ScaLBL_CopyToHost( f.data(), Model.fq, 19*Np*sizeof(double) );
+		ScaLBL_CopyToHost( f_mrt.data(), dist, 19*Np*sizeof(double) );
+		ScaLBL_FreeDeviceMemory( dist );
+		double diff = 0.0;
+		for (size_t m=0; m<f.size(); m++)
+			diff = std::max( diff, fabs( f[m]-f_mrt[m] ) );
+		diff = comm.maxReduce( diff );
+		if (rank == 0) printf("Newtonian limit: largest difference to MRT %g \n", diff);
+		if ( !( diff < 1.0e-14 ) ) check++;
+
+		check = comm.sumReduce( check );
+		if (rank == 0) printf("%i errors \n", check);
+	}
+	Utilities::shutdown();
+
+	return check;
+}
@@ -0,0 +1,101 @@
+//*************************************************************************
+// Check the batched sum reduction of Utilities::MPI: scalars, arrays and
+// named sums completed by one blocking or nonblocking allreduce agree with
+// one sumReduce per value
+//*************************************************************************
+#include <stdio.h>
+#include <iostream>
+#include <math.h>
+#include "common/MPI.h"
+
+using namespace std;
+
+static int Compare( int rank, const char *name, double result, double expected )
+{
+	bool wrong = fabs( result - expected ) > 1e-12*fabs( expected );
+	if ( rank == 0 && wrong )
+		printf("%s: %.15g (expected %.15g) \n", name, result, expected);
+	return wrong ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+	// Initialize MPI
+	Utilities::startup( argc, argv );
+	Utilities::MPI comm( MPI_COMM_WORLD );
+	int rank = comm.getRank();
+	int check=0;
+	{
+		if (rank == 0){
+			printf("********************************************************\n");
+			printf("Running unit test: TestReduceAccumulator	\n");
+			printf("********************************************************\n");
+		}
+		// local values that differ on each rank
+		double a = 1.0 + 0.5*rank, b = 1.0/(rank+3.0);
+		int n = rank + 1;
+		const int length = 7;
+		std::vector<double> x( length );
+		for (int i=0; i<length; i++) x[i] = sin( 1.0 + i + 0.1*rank );
+
+		// blocking reduction
+		double ga, gb;
+		int gn;
+		std::vector<double> gx( length );
+		Utilities::MPI::Accumulator sums( comm );
+		sums.sum( ga, a );
+		sums.sum( gx.data(), x.data(), length );
+		sums.sum( gn, n );
+		sums.sum( "b", b );
+		// the local values are copied, so the result may overwrite the local value
+		double c = 2.0*rank;
+		sums.sum( c, c );
+		if ( sums.size() != length + 4 ) check++;
+		sums.reduce();
+		gb = sums.get( "b" );
+		check += Compare( rank, "scalar", ga, comm.sumReduce( a ) );
+		check += Compare( rank, "named", gb, comm.sumReduce( b ) );
+		check += Compare( rank, "in place", c, comm.sumReduce( 2.0*rank ) );
+		if ( gn != comm.sumReduce( n ) ) check++;
+		for (int i=0; i<length; i++)
+			check += Compare( rank, "array", gx[i], comm.sumReduce( x[i] ) );
+
+		// nonblocking reduction, the accumulator is cleared by the first new sum
+		double ha, hb;
+		sums.sum( ha, 3.0*a );
+		sums.sum( hb, b );
+		if ( sums.size() != 2 ) check++;
+		sums.start();
+		double local_work = 0.0;
+		for (int i=0; i<100000; i++) local_work += 1.0e-5;
+		sums.finish();
+		if ( sums.pending() ) check++;
+		check += Compare( rank, "nonblocking", ha, comm.sumReduce( 3.0*a ) );
+		check += Compare( rank, "nonblocking", hb, comm.sumReduce( b ) );
+
+		// overlapping with other collectives and a second accumulator
+		double da, db;
+		Utilities::MPI::Accumulator first( comm ), second( comm );
+		first.sum( da, a );
+		first.start();
+		double m = comm.maxReduce( a );
+		second.sum( db, b );
+		second.reduce();
+		first.finish();
+		check += Compare( rank, "overlap", da, comm.sumReduce( a ) );
+		check += Compare( rank, "overlap", db, comm.sumReduce( b ) );
+		check += Compare( rank, "overlap", m, 1.0 + 0.5*(comm.getSize()-1) );
+
+		// an empty accumulator
+		Utilities::MPI::Accumulator empty( comm );
+		empty.start();
+		empty.finish();
+		if ( empty.size() != 0 || local_work <= 0.0 ) check++;
+
+		check = comm.sumReduce( check );
+		if (rank == 0) printf("%i reductions checked, %i errors \n", 2*length + 12, check);
+	}
+	Utilities::shutdown();
+
+	return check;
+}
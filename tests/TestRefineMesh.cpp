@@ -0,0 +1,60 @@
+//*************************************************************************
+// Check RefineMesh: linear fields are reproduced exactly by both
+// interpolation methods, and the threaded result matches the serial one
+//*************************************************************************
+#include <stdio.h>
+#include <math.h>
+#include <iostream>
+#include "analysis/uCT.h"
+#include "analysis/filters.h"
+#include "common/MPI.h"
+
+using namespace std;
+
+static double Linear( double x, double y, double z )
+{
+	return 0.5 + 1.25*x - 0.75*y + 2.0*z;
+}
+
+int main(int argc, char **argv)
+{
+	Utilities::startup( argc, argv );
+	int check = 0;
+	{
+		printf("********************************************************\n");
+		printf("Running unit test: TestRefineMesh	\n");
+		printf("********************************************************\n");
+		int nx = 11, ny = 9, nz = 7;
+		Array<double> Coarse(nx+2,ny+2,nz+2);
+		for (int k=0; k<nz+2; k++)
+			for (int j=0; j<ny+2; j++)
+				for (int i=0; i<nx+2; i++)
+					Coarse(i,j,k) = Linear( i, j, k );
+		for (int r : { 2, 3 }){
+			for (std::string method : { "trilinear", "hermite" }){
+				Array<double> Serial(r*nx+2,r*ny+2,r*nz+2), Threaded(r*nx+2,r*ny+2,r*nz+2);
+				Serial.fill(0);
+				Threaded.fill(0);
+				Utilities::setNumThreads( 1 );
+				RefineMesh( Coarse, Serial, r, method );
+				Utilities::setNumThreads( 4 );
+				RefineMesh( Coarse, Threaded, r, method );
+				double err = 0.0, diff = 0.0;
+				for (int k=1; k<=r*nz; k++){
+					for (int j=1; j<=r*ny; j++){
+						for (int i=1; i<=r*nx; i++){
+							double x = 1.0 + double(i-1)/r, y = 1.0 + double(j-1)/r, z = 1.0 + double(k-1)/r;
+							err = max( err, fabs( Serial(i,j,k) - Linear( x, y, z ) ) );
+							diff = max( diff, fabs( Serial(i,j,k) - Threaded(i,j,k) ) );
+						}
+					}
+				}
+				printf("r = %i, %s: error = %g, threaded difference = %g \n", r, method.c_str(), err, diff);
+				if ( err > 1e-12 || diff != 0.0 ) check++;
+			}
+		}
+		Utilities::setNumThreads( 1 );
+	}
+	Utilities::shutdown();
+	return check;
+}
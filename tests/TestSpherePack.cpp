@@ -0,0 +1,112 @@
+//*************************************************************************
+// Check the sphere pack tools: the spheres sent to each rank and the threaded
+// voxelization and signed distance against a serial evaluation of the full list,
+// with the ranks split along x and y and along z
+//*************************************************************************
+#include <stdio.h>
+#include <iostream>
+#include <math.h>
+#include <vector>
+#include "common/MPI.h"
+#include "common/Utilities.h"
+#include "common/SpherePack.h"
+
+using namespace std;
+
+// Process layouts for the number of ranks: the ranks split along x and y, and along z
+static std::vector<std::vector<int>> ProcessLayouts( int nprocs )
+{
+	if (nprocs == 2) return { { 2, 1, 1 }, { 1, 1, 2 } };
+	if (nprocs == 4) return { { 2, 2, 1 }, { 2, 1, 2 } };
+	return { { 1, 1, 1 } };
+}
+
+static int TestLayout( const Utilities::MPI &comm, int nprocx, int nprocy, int nprocz )
+{
+	int rank = comm.getRank();
+	int check = 0;
+	if (rank == 0) printf("Process grid %i x %i x %i \n", nprocx, nprocy, nprocz);
+	int iproc = rank % nprocx;
+	int jproc = (rank / nprocx) % nprocy;
+	int kproc = rank / (nprocx*nprocy);
+	// local sub-domain including the halo
+	int Nx = 26, Ny = 22, Nz = 30;
+	int N = Nx*Ny*Nz;
+	double Lx = 1.0*nprocx, Ly = 0.8*nprocy, Lz = 1.2*nprocz;
+
+	// the same random pack on every rank for the reference
+	int nspheres = 400*nprocz;
+	std::vector<double> cx( nspheres ), cy( nspheres ), cz( nspheres ), rad( nspheres );
+	srand( 1234 );
+	for (int p=0; p<nspheres; p++){
+		cx[p] = Lx*rand()/RAND_MAX;
+		cy[p] = Ly*rand()/RAND_MAX;
+		cz[p] = Lz*rand()/RAND_MAX;
+		rad[p] = 0.01 + 0.05*rand()/RAND_MAX;
+	}
+	// spheres sent to this rank (only rank 0 needs the list)
+	std::vector<double> lx, ly, lz, lr;
+	DistributeSpherePacking( comm, nspheres, cx.data(), cy.data(), cz.data(), rad.data(),
+		Lx, Ly, Lz, Nx, Ny, Nz, nprocx, nprocy, nprocz, lx, ly, lz, lr );
+	int nlocal = lx.size();
+	int ntotal = comm.sumReduce( nlocal );
+	if (rank == 0) printf("Spheres sent to the ranks: %i of %i \n", ntotal, nspheres);
+	if ( comm.getSize() == 1 && nlocal != nspheres ) check++;
+	if ( ntotal < nspheres ) check++;
+
+	// serial evaluation of the full list
+	Utilities::setNumThreads( 1 );
+	std::vector<double> Distance( N ), Distance2( N );
+	std::vector<char> ID( N ), ID2( N );
+	SignedDistance( Distance.data(), nspheres, cx.data(), cy.data(), cz.data(), rad.data(),
+		Lx, Ly, Lz, Nx, Ny, Nz, iproc, jproc, kproc, nprocx, nprocy, nprocz );
+	AssignLocalSolidID( ID.data(), nspheres, cx.data(), cy.data(), cz.data(), rad.data(),
+		Lx, Ly, Lz, Nx, Ny, Nz, iproc, jproc, kproc, nprocx, nprocy, nprocz );
+	int solid = 0;
+	for (int n=0; n<N; n++)
+		if (ID[n] == 0) solid++;
+	if ( solid == 0 || solid == N ) check++;
+
+	// threaded evaluation of the local spheres is identical (including the halo planes)
+	for (int threads : { 1, 2, 4, 7 }){
+		Utilities::setNumThreads( threads );
+		SignedDistance( Distance2.data(), nlocal, lx.data(), ly.data(), lz.data(), lr.data(),
+			Lx, Ly, Lz, Nx, Ny, Nz, iproc, jproc, kproc, nprocx, nprocy, nprocz );
+		AssignLocalSolidID( ID2.data(), nlocal, lx.data(), ly.data(), lz.data(), lr.data(),
+			Lx, Ly, Lz, Nx, Ny, Nz, iproc, jproc, kproc, nprocx, nprocy, nprocz );
+		int errors = 0;
+		for (int n=0; n<N; n++){
+			if ( Distance2[n] != Distance[n] ) errors++;
+			if ( ID2[n] != ID[n] ) errors++;
+		}
+		if ( errors > 0 ){
+			printf("Rank %i: %i differences with %i threads \n", rank, errors, threads);
+			check++;
+		}
+	}
+	Utilities::setNumThreads( 1 );
+	return check;
+}
+
+int main(int argc, char **argv)
+{
+	// Initialize MPI
+	Utilities::startup( argc, argv );
+	Utilities::MPI comm( MPI_COMM_WORLD );
+	int rank = comm.getRank();
+	int check=0;
+	{
+		if (rank == 0){
+			printf("********************************************************\n");
+			printf("Running unit test: TestSpherePack	\n");
+			printf("********************************************************\n");
+		}
+		for (const auto &layout : ProcessLayouts( comm.getSize() ))
+			check += TestLayout( comm, layout[0], layout[1], layout[2] );
+		check = comm.sumReduce( check );
+		if (rank == 0) printf("%i errors \n", check);
+	}
+	Utilities::shutdown();
+
+	return check;
+}
@@ -0,0 +1,148 @@
+//*************************************************************************
+// Check that the blockwise evaluation of TwoPhase::ComputeLocal on a
+// thread pool reproduces the serial result exactly
+//*************************************************************************
+#include <stdio.h>
+#include <iostream>
+#include <math.h>
+#include <algorithm>
+#include "analysis/TwoPhase.h"
+#include "common/MPI.h"
+#include "threadpool/thread_pool.h"
+
+using namespace std;
+
+static std::shared_ptr<Database> DomainDatabase( int nprocs, int n )
+{
+	int npx = 1, npy = 1;
+	if (nprocs == 2) npx = 2;
+	if (nprocs == 4) npx = npy = 2;
+	char text[512];
+	sprintf(text,
+		"Domain {\n"
+		"  nproc = %i, %i, 1\n"
+		"  n = %i, %i, %i\n"
+		"  L = 1, 1, 1\n"
+		"  BC = 0\n"
+		"}\n", npx, npy, n, n, n );
+	return Database::createFromString( text )->getDatabase( "Domain" );
+}
+
+class ComputeBlockWorkItem : public ThreadPool::WorkItemRet<void>
+{
+public:
+	ComputeBlockWorkItem( TwoPhase &Averages_, int block_ ): Averages(Averages_), block(block_) {}
+	virtual void run() { Averages.ComputeLocalBlock( block ); }
+private:
+	TwoPhase &Averages;
+	int block;
+};
+
+// local averages that are compared between the serial and threaded evaluation
+static std::vector<double> LocalAverages( const TwoPhase &Averages )
+{
+	std::vector<double> values = { Averages.awn, Averages.ans, Averages.aws, Averages.lwns, Averages.As,
+		Averages.wp_volume, Averages.nwp_volume, Averages.vol_w, Averages.vol_n, Averages.pan, Averages.paw,
+		Averages.Jwn, Averages.Kwn, Averages.KNwns, Averages.KGwns, Averages.efawns,
+		Averages.trawn, Averages.trJwn, Averages.trRwn, Averages.wwndnw, Averages.wwnsdnwn, Averages.Jwnwwndnw,
+		Averages.euler, Averages.Kn, Averages.Jn, Averages.An };
+	for (int d=0; d<3; d++){
+		values.push_back( Averages.van(d) );
+		values.push_back( Averages.vaw(d) );
+		values.push_back( Averages.vawn(d) );
+		values.push_back( Averages.vawns(d) );
+	}
+	for (int d=0; d<6; d++){
+		values.push_back( Averages.Gwn(d) );
+		values.push_back( Averages.Gns(d) );
+		values.push_back( Averages.Gws(d) );
+	}
+	return values;
+}
+
+int main(int argc, char **argv)
+{
+	// Initialize MPI
+	Utilities::startup( argc, argv );
+	Utilities::MPI comm( MPI_COMM_WORLD );
+	int rank = comm.getRank();
+	int nprocs = comm.getSize();
+	int check=0;
+	{
+		if (rank == 0){
+			printf("********************************************************\n");
+			printf("Running unit test: TestTwoPhaseBlocks	\n");
+			printf("********************************************************\n");
+		}
+		int n = 40;
+		if (argc > 1) n = atoi(argv[1]);
+		auto Dm = std::make_shared<Domain>( DomainDatabase( nprocs, n ), comm );
+		int Nx = Dm->Nx, Ny = Dm->Ny, Nz = Dm->Nz;
+		double Lx = n*Dm->nprocx(), Ly = n*Dm->nprocy(), Lz = n*Dm->nprocz();
+		// non-wetting bubble resting against a solid grain
+		double R = 0.25*n, Rs = 0.2*n;
+		TwoPhase Averages(Dm);
+		for (int k=0; k<Nz; k++){
+			for (int j=0; j<Ny; j++){
+				for (int i=0; i<Nx; i++){
+					double x = Dm->iproc()*(Nx-2)+i-1 - 0.5*Lx;
+					double y = Dm->jproc()*(Ny-2)+j-1 - 0.5*Ly;
+					double z = Dm->kproc()*(Nz-2)+k-1 - 0.5*Lz;
+					double zs = z - 0.4*n;
+					double sds = sqrt(x*x+y*y+zs*zs) - Rs;
+					Dm->id[k*Nx*Ny+j*Nx+i] = sds > 0.0 ? 1 : 0;
+					Averages.SDs(i,j,k) = sds;
+					Averages.SDn(i,j,k) = R - sqrt(x*x+y*y+z*z);
+					Averages.Phase(i,j,k) = Averages.SDn(i,j,k);
+					Averages.Phase_tplus(i,j,k) = Averages.SDn(i,j,k) + 0.01;
+					Averages.Phase_tminus(i,j,k) = Averages.SDn(i,j,k) - 0.01;
+					Averages.Press(i,j,k) = Averages.SDn(i,j,k) > 0.0 ? 1.0 : 0.5;
+					Averages.Vel_x(i,j,k) = 1e-3*y;
+					Averages.Vel_y(i,j,k) = -1e-3*x;
+					Averages.Vel_z(i,j,k) = 1e-4*z;
+				}
+			}
+		}
+		Dm->CommInit();
+		Averages.UpdateSolid();
+		Averages.Initialize();
+		Averages.ComputeDelPhi();
+		Averages.UpdateMeshValues();
+
+		// serial reference
+		Averages.ComputeLocal();
+		auto serial = LocalAverages( Averages );
+
+		// blocks on a thread pool, submitted in reverse order
+		for (int threads : { 1, 4 }){
+			ThreadPool tpool( threads );
+			Averages.Initialize();
+			std::vector<ThreadPool::WorkItem *> work;
+			for (int b=Averages.LocalBlocks()-1; b>=0; b--)
+				work.push_back( new ComputeBlockWorkItem( Averages, b ) );
+			auto ids = tpool.add_work( work );
+			tpool.wait_all( ids );
+			Averages.ReduceLocalBlocks();
+			auto threaded = LocalAverages( Averages );
+			int errors = 0;
+			for (size_t m=0; m<serial.size(); m++)
+				if (serial[m] != threaded[m]) errors++;
+			errors = comm.sumReduce( errors );
+			if (rank == 0) printf("%i threads, %i blocks: %i averages differ from the serial result \n",
+				threads, Averages.LocalBlocks(), errors);
+			if (errors > 0) check++;
+		}
+
+		// sanity check on the interfacial areas
+		double awn = comm.sumReduce( serial[0] );
+		double As = comm.sumReduce( serial[4] );
+		if (rank == 0) printf("awn = %f, As = %f (sphere areas %f, %f) \n", awn, As, 4*M_PI*R*R, 4*M_PI*Rs*Rs);
+		if (awn <= 0.0 || awn > 4*M_PI*R*R || As <= 0.0 || As > 4*M_PI*Rs*Rs){
+			if (rank == 0) printf("Unexpected interfacial areas \n");
+			check++;
+		}
+	}
+	Utilities::shutdown();
+
+	return check;
+}
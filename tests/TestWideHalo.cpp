@@ -86,7 +86,12 @@ int main(int argc, char **argv)
 
 		comm.barrier();
 
-		std::shared_ptr<Domain> Dm  = std::shared_ptr<Domain>(new Domain(Nx,Ny,Nz,rank,nprocx,nprocy,nprocz,Lx,Ly,Lz,BoundaryCondition));     
+		auto domain_db = std::make_shared<Database>();
+		domain_db->putScalar<int>( "BC", BoundaryCondition );
+		domain_db->putVector<int>( "nproc", { nprocx, nprocy, nprocz } );
+		domain_db->putVector<int>( "n", { Nx, Ny, Nz } );
+		domain_db->putVector<double>( "L", { Lx, Ly, Lz } );
+		std::shared_ptr<Domain> Dm  = std::shared_ptr<Domain>(new Domain(domain_db,comm));
 		Nx += 2;
 		Ny += 2;
 		Nz += 2;
@@ -116,7 +121,7 @@ int main(int argc, char **argv)
 		//Create a second communicator based on the regular data layout
 		ScaLBL_Communicator ScaLBL_Comm_Regular(Dm);
 		ScaLBL_Communicator ScaLBL_Comm(Dm);
-		ScaLBLWideHalo_Communicator WideHalo(Dm,2);
+		ScaLBLWideHalo_Communicator WideHalo(Dm,2,2);
 
 		// LBM variables
 		if (rank==0)	printf ("Set up the neighborlist \n");
@@ -199,6 +204,53 @@ int main(int argc, char **argv)
     		}
     	}
 
+		// Check the wide halo exchange for two fields sent together
+		int width = 2;
+		int Nh = WideHalo.Nh;
+		int gnx = nprocx*(Nx-2);
+		int gny = nprocy*(Ny-2);
+		int gnz = nprocz*(Nz-2);
+		auto global_value = [&]( int ih, int jh, int kh, int field ){
+			int gx = ( Dm->iproc()*(Nx-2) + ih - width + gnx ) % gnx;
+			int gy = ( Dm->jproc()*(Ny-2) + jh - width + gny ) % gny;
+			int gz = ( Dm->kproc()*(Nz-2) + kh - width + gnz ) % gnz;
+			return double( gx + 100*gy + 10000*gz + 1000000*field );
+		};
+		double *HaloA, *HaloB;
+		ScaLBL_AllocateDeviceMemory((void **) &HaloA, sizeof(double)*Nh);
+		ScaLBL_AllocateDeviceMemory((void **) &HaloB, sizeof(double)*Nh);
+		std::vector<double> HostA(Nh,-1.0), HostB(Nh,-1.0);
+		for (k=width;k<WideHalo.Nzh-width;k++){
+			for (j=width;j<WideHalo.Nyh-width;j++){
+				for (i=width;i<WideHalo.Nxh-width;i++){
+					n = k*WideHalo.Nxh*WideHalo.Nyh+j*WideHalo.Nxh+i;
+					HostA[n] = global_value(i,j,k,0);
+					HostB[n] = global_value(i,j,k,1);
+				}
+			}
+		}
+		ScaLBL_CopyToDevice(HaloA, HostA.data(), Nh*sizeof(double));
+		ScaLBL_CopyToDevice(HaloB, HostB.data(), Nh*sizeof(double));
+		std::vector<double*> fields = { HaloA, HaloB };
+		WideHalo.Send(fields);
+		WideHalo.Recv(fields);
+		ScaLBL_CopyToHost(HostA.data(), HaloA, Nh*sizeof(double));
+		ScaLBL_CopyToHost(HostB.data(), HaloB, Nh*sizeof(double));
+		int halo_errors = 0;
+		for (k=0;k<WideHalo.Nzh;k++){
+			for (j=0;j<WideHalo.Nyh;j++){
+				for (i=0;i<WideHalo.Nxh;i++){
+					n = k*WideHalo.Nxh*WideHalo.Nyh+j*WideHalo.Nxh+i;
+					if (HostA[n] != global_value(i,j,k,0) || HostB[n] != global_value(i,j,k,1))
+						halo_errors++;
+				}
+			}
+		}
+		if (halo_errors > 0){
+			printf("Wide halo exchange: %i incorrect values \n",halo_errors);
+			check++;
+		}
+
 	}
 	// ****************************************************
 	comm.barrier();
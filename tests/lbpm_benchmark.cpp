@@ -0,0 +1,785 @@
+/*
+ * Benchmark for the LBPM kernels on synthetic geometries
+ *
+ * Times the odd/even time steps of the MRT, color, free energy Lee, greyscale, ion and
+ * Poisson kernels (with the halo exchange they need) and the D3Q19 halo exchange alone,
+ * on a random sphere pack, a tube or an open box generated in memory. No input files are read.
+ *
+ *   lbpm_benchmark [--geometry spheres|tube|box] [--n 64] [--porosity 0.4] [--radius R]
+ *                  [--steps 100] [--models mrt,color,freelee,greyscale,ion,poisson,halo]
+ *                  [--scaling none|weak|strong] [--seed 1] [--output lbpm_benchmark.json]
+ *
+ * n is the size of the sub-domain of each rank (for strong scaling, of the largest run);
+ * weak and strong scaling repeat the benchmark on 1, 2, 4, ... ranks of the job.
+ * The results (MLUPS, estimated bytes moved per site, allocated bytes per site and the
+ * scaling efficiency) are written as JSON, "-" writes to stdout.
+ *
+ *   lbpm_benchmark --predict 512,512,512 [--ranks 8,64,512] [--porosity 0.4] [--models ...]
+ *
+ * predicts the device memory of each rank for a domain of the given size on each number of
+ * ranks, from the sites and halo of a sub-domain with the given porosity, without allocating.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <array>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/ScaLBL.h"
+#include "common/WideHalo.h"
+#include "common/MPI.h"
+#include "common/Utilities.h"
+
+using namespace std;
+
+
+struct BenchmarkOptions {
+	std::string geometry = "spheres";
+	int n = 64;
+	double porosity = 0.4;
+	double radius = 0.0;	// sphere radius, 0 chooses n/8
+	int steps = 100;
+	int seed = 1;
+	std::string scaling = "none";
+	std::string output = "lbpm_benchmark.json";
+	std::vector<int> predict;	// global domain size of the memory prediction
+	std::vector<int> ranks = { 1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024 };
+	std::vector<std::string> models = { "mrt", "color", "freelee", "greyscale", "ion", "poisson", "halo" };
+};
+
+struct ModelResult {
+	std::string name;
+	double seconds;			// wall time per time step (slowest rank)
+	double sites;			// pore sites updated per time step (all ranks)
+	double bytes_per_site;	// estimated memory traffic per site update
+	double memory_per_site;	// device memory allocated per pore site
+	double kernel_MLUPS;	// MRT only: kernels without communication (per rank, GetPerformance)
+};
+
+struct RunResult {
+	int nprocs;
+	std::array<int,3> nproc, n;
+	double porosity;
+	std::vector<ModelResult> models;
+};
+
+
+static std::vector<std::string> split( const std::string &text, char delimiter )
+{
+	std::vector<std::string> items;
+	size_t start = 0;
+	while ( start <= text.size() ){
+		size_t end = text.find( delimiter, start );
+		if ( end == std::string::npos ) end = text.size();
+		if ( end > start ) items.push_back( text.substr( start, end-start ) );
+		start = end + 1;
+	}
+	return items;
+}
+
+static BenchmarkOptions ReadOptions( int argc, char **argv )
+{
+	BenchmarkOptions options;
+	for (int i=1; i<argc; i++){
+		std::string key = argv[i];
+		if ( i+1 >= argc )
+			ERROR( "lbpm_benchmark: missing value for " + key );
+		std::string value = argv[++i];
+		if ( key == "--geometry" )      options.geometry = value;
+		else if ( key == "--n" )        options.n = atoi( value.c_str() );
+		else if ( key == "--porosity" ) options.porosity = atof( value.c_str() );
+		else if ( key == "--radius" )   options.radius = atof( value.c_str() );
+		else if ( key == "--steps" )    options.steps = atoi( value.c_str() );
+		else if ( key == "--seed" )     options.seed = atoi( value.c_str() );
+		else if ( key == "--scaling" )  options.scaling = value;
+		else if ( key == "--output" )   options.output = value;
+		else if ( key == "--models" )   options.models = split( value, ',' );
+		else if ( key == "--predict" || key == "--ranks" ){
+			std::vector<int> values;
+			for (const auto &item : split( value, ',' )) values.push_back( atoi( item.c_str() ) );
+			if ( key == "--predict" ) options.predict = values;
+			else options.ranks = values;
+		}
+		else ERROR( "lbpm_benchmark: unknown option " + key );
+	}
+	INSIST( options.geometry == "spheres" || options.geometry == "tube" || options.geometry == "box",
+		"lbpm_benchmark: geometry must be spheres, tube or box" );
+	INSIST( options.scaling == "none" || options.scaling == "weak" || options.scaling == "strong",
+		"lbpm_benchmark: scaling must be none, weak or strong" );
+	INSIST( options.n >= 8 && options.steps >= 2, "lbpm_benchmark: n >= 8 and steps >= 2 are required" );
+	INSIST( options.predict.empty() || options.predict.size() == 3, "lbpm_benchmark: --predict needs the size in x, y and z" );
+	INSIST( options.porosity > 0.0 && options.porosity <= 1.0, "lbpm_benchmark: porosity must be in (0,1]" );
+	options.steps += options.steps % 2;
+	return options;
+}
+
+// Process grid for p ranks: the prime factors are assigned to the smallest dimension
+static std::array<int,3> ProcessGrid( int p )
+{
+	std::vector<int> factors;
+	for (int f=2; p>1; ){
+		if ( p % f == 0 ){ factors.push_back( f ); p /= f; }
+		else f++;
+	}
+	std::array<int,3> grid = { 1, 1, 1 };
+	for (auto it=factors.rbegin(); it!=factors.rend(); ++it){
+		int d = 0;
+		for (int m=1; m<3; m++) if ( grid[m] < grid[d] ) d = m;
+		grid[d] *= *it;
+	}
+	return grid;
+}
+
+
+/*
+ * Solid (0) and fluid (1) sites of the synthetic geometry in the sub-domain, including the halo.
+ * The geometry is periodic on the global grid, so that every rank generates the same spheres.
+ */
+static void SyntheticGeometry( Domain &Dm, const BenchmarkOptions &options )
+{
+	int Nx = Dm.Nx, Ny = Dm.Ny, Nz = Dm.Nz;
+	std::array<int,3> G = { (Nx-2)*Dm.nprocx(), (Ny-2)*Dm.nprocy(), (Nz-2)*Dm.nprocz() };
+	std::array<int,3> offset = { (Nx-2)*Dm.iproc()-1, (Ny-2)*Dm.jproc()-1, (Nz-2)*Dm.kproc()-1 };
+	std::array<int,3> size = { Nx, Ny, Nz };
+	// global coordinates of the local sites
+	std::array<std::vector<int>,3> X;
+	for (int d=0; d<3; d++){
+		X[d].resize( size[d] );
+		for (int i=0; i<size[d]; i++) X[d][i] = ( ( offset[d] + i ) % G[d] + G[d] ) % G[d];
+	}
+	for (int n=0; n<Nx*Ny*Nz; n++) Dm.id[n] = 1;
+	if ( options.geometry == "tube" ){
+		// tube along z with the cross section set by the porosity
+		double R = sqrt( options.porosity*G[0]*G[1]/3.14159265358979 );
+		R = min( R, 0.5*min( G[0], G[1] ) - 1.0 );
+		for (int k=0; k<Nz; k++){
+			for (int j=0; j<Ny; j++){
+				for (int i=0; i<Nx; i++){
+					double x = X[0][i] + 0.5 - 0.5*G[0], y = X[1][j] + 0.5 - 0.5*G[1];
+					if ( x*x + y*y > R*R ) Dm.id[(k*Ny+j)*Nx+i] = 0;
+				}
+			}
+		}
+	}
+	else if ( options.geometry == "spheres" ){
+		// overlapping spheres at random positions, the porosity of the pack is exp(-count*volume/V)
+		double R = options.radius > 0.0 ? options.radius : max( 2.0, min( G[0], min( G[1], G[2] ) )/8.0 );
+		double V = double(G[0])*G[1]*G[2];
+		int count = (int) round( -log( options.porosity )*V/( 4.0/3.0*3.14159265358979*R*R*R ) );
+		std::mt19937 generator( options.seed );
+		std::uniform_real_distribution<double> uniform( 0.0, 1.0 );
+		std::array<std::vector<int>,3> inside;
+		std::array<std::vector<double>,3> delta;
+		for (int s=0; s<count; s++){
+			double c[3];
+			for (int d=0; d<3; d++) c[d] = uniform( generator )*G[d];
+			// local sites within R of the center in each direction (periodic distance)
+			for (int d=0; d<3; d++){
+				inside[d].clear();
+				delta[d].clear();
+				for (int i=0; i<size[d]; i++){
+					double x = X[d][i] + 0.5 - c[d];
+					x -= G[d]*round( x/G[d] );
+					if ( fabs( x ) < R ){
+						inside[d].push_back( i );
+						delta[d].push_back( x*x );
+					}
+				}
+			}
+			for (size_t kk=0; kk<inside[2].size(); kk++){
+				for (size_t jj=0; jj<inside[1].size(); jj++){
+					for (size_t ii=0; ii<inside[0].size(); ii++){
+						if ( delta[0][ii] + delta[1][jj] + delta[2][kk] < R*R )
+							Dm.id[(inside[2][kk]*Ny+inside[1][jj])*Nx+inside[0][ii]] = 0;
+					}
+				}
+			}
+		}
+	}
+}
+
+
+/*
+ * Sub-domain with the synthetic geometry, the memory optimized layout and the device
+ * arrays of one model (width 2 for the wide halo of the free energy Lee model)
+ */
+class BenchmarkLattice {
+public:
+	BenchmarkLattice( const Utilities::MPI &comm, const std::array<int,3> &nproc, const std::array<int,3> &n,
+		const BenchmarkOptions &options, int width=1 ):
+		NeighborList(nullptr), dvcMap(nullptr), Np(0), sites(0), bytes(0)
+	{
+		auto db = std::make_shared<Database>();
+		db->putScalar<int>( "BC", 0 );
+		db->putVector<int>( "nproc", { nproc[0], nproc[1], nproc[2] } );
+		db->putVector<int>( "n", { n[0], n[1], n[2] } );
+		db->putScalar<int>( "nspheres", 0 );
+		db->putVector<double>( "L", { 1, 1, 1 } );
+		Dm = std::make_shared<Domain>( db, comm );
+		Nx = Dm->Nx; Ny = Dm->Ny; Nz = Dm->Nz;
+		N = Nx*Ny*Nz;
+		SyntheticGeometry( *Dm, options );
+		Dm->CommInit();
+		sites = Dm->PoreCount();
+		ScaLBL_Comm = std::make_shared<ScaLBL_Communicator>( Dm );
+		if ( width == 2 )
+			WideHalo = std::make_shared<ScaLBLWideHalo_Communicator>( Dm, 2 );
+		else
+			ScaLBL_Comm_Regular = std::make_shared<ScaLBL_Communicator>( Dm );
+		Map.resize( Nx, Ny, Nz );
+		Map.fill( -2 );
+		auto neighborList = new int[18*(sites/16+2)*16];
+		Np = ScaLBL_Comm->MemoryOptimizedLayoutAA( Map, neighborList, Dm->id.data(), sites, width );
+		NeighborList = Allocate<int>( 18*Np );
+		ScaLBL_CopyToDevice( NeighborList, neighborList, 18*Np*sizeof(int) );
+		delete [] neighborList;
+		// map from the layout to the regular (or wide halo) grid
+		std::vector<int> TmpMap( Np, 0 );
+		for (int k=1; k<Nz-1; k++){
+			for (int j=1; j<Ny-1; j++){
+				for (int i=1; i<Nx-1; i++){
+					int idx = Map(i,j,k);
+					if ( !(idx < 0) )
+						TmpMap[idx] = ( width == 2 ) ? WideHalo->Map(i,j,k) : k*Nx*Ny+j*Nx+i;
+				}
+			}
+		}
+		dvcMap = Allocate<int>( Np );
+		ScaLBL_CopyToDevice( dvcMap, TmpMap.data(), Np*sizeof(int) );
+		first = ScaLBL_Comm->FirstInterior();
+		last = ScaLBL_Comm->LastInterior();
+		exterior = ScaLBL_Comm->LastExterior();
+	}
+	~BenchmarkLattice(){
+		for (auto ptr : memory) ScaLBL_FreeDeviceMemory( ptr );
+	}
+	// zero initialized device array, counted in the memory footprint
+	template<class TYPE> TYPE *Allocate( size_t count ){
+		void *ptr = nullptr;
+		ScaLBL_AllocateDeviceMemory( &ptr, count*sizeof(TYPE) );
+		std::vector<TYPE> zero( count, 0 );
+		ScaLBL_CopyToDevice( ptr, zero.data(), count*sizeof(TYPE) );
+		memory.push_back( ptr );
+		bytes += count*sizeof(TYPE);
+		return (TYPE *) ptr;
+	}
+	BenchmarkLattice( const BenchmarkLattice& ) = delete;
+	BenchmarkLattice& operator=( const BenchmarkLattice& ) = delete;
+
+	std::shared_ptr<Domain> Dm;
+	std::shared_ptr<ScaLBL_Communicator> ScaLBL_Comm, ScaLBL_Comm_Regular;
+	std::shared_ptr<ScaLBLWideHalo_Communicator> WideHalo;
+	IntArray Map;
+	int *NeighborList, *dvcMap;
+	int Nx, Ny, Nz, N, Np, sites;
+	int first, last, exterior;
+	size_t bytes;
+private:
+	std::vector<void*> memory;
+};
+
+
+// Time the odd/even step pairs, returns the wall time per time step of the slowest rank
+static double TimeSteps( const Utilities::MPI &comm, int steps, const std::function<void()> &step )
+{
+	step();		// warm up
+	ScaLBL_DeviceBarrier();
+	comm.barrier();
+	auto t1 = std::chrono::system_clock::now();
+	for (int t=0; t<steps; t+=2) step();
+	ScaLBL_DeviceBarrier();
+	comm.barrier();
+	auto t2 = std::chrono::system_clock::now();
+	return comm.maxReduce( std::chrono::duration<double>( t2 - t1 ).count() / steps );
+}
+
+static ModelResult Result( const Utilities::MPI &comm, const std::string &name, const BenchmarkLattice &lattice,
+	double seconds, double bytes_per_site )
+{
+	ModelResult result;
+	result.name = name;
+	result.seconds = seconds;
+	result.sites = comm.sumReduce( (double) lattice.sites );
+	result.bytes_per_site = bytes_per_site;
+	result.memory_per_site = comm.sumReduce( (double) lattice.bytes ) / max( result.sites, 1.0 );
+	result.kernel_MLUPS = 0.0;
+	return result;
+}
+
+/*
+ * The estimated traffic counts each array element read or written once per site update
+ * (neighbor values of the phase fields are assumed to come from cache) and the neighbor
+ * list entries read by the odd step
+ */
+static ModelResult BenchmarkMRT( const Utilities::MPI &comm, BenchmarkLattice &L, const BenchmarkOptions &options )
+{
+	int Np = L.Np;
+	double *fq = L.Allocate<double>( 19*Np );
+	double rlx_setA = 1.0/0.7, rlx_setB = 8.0*(2.0-rlx_setA)/(8.0-rlx_setA);
+	double Fx = 0.0, Fy = 0.0, Fz = 1.0e-5;
+	// kernels without communication on each rank
+	double kernel_MLUPS = L.ScaLBL_Comm->GetPerformance( L.NeighborList, fq, Np, max( options.steps/2, 1 ) );
+	ScaLBL_D3Q19_Init( fq, Np );
+	double seconds = TimeSteps( comm, options.steps, [&](){
+		L.ScaLBL_Comm->SendD3Q19AA( fq );
+		ScaLBL_D3Q19_AAodd_MRT( L.NeighborList, fq, L.first, L.last, Np, rlx_setA, rlx_setB, Fx, Fy, Fz );
+		L.ScaLBL_Comm->RecvD3Q19AA( fq );
+		ScaLBL_D3Q19_AAodd_MRT( L.NeighborList, fq, 0, L.exterior, Np, rlx_setA, rlx_setB, Fx, Fy, Fz );
+		L.ScaLBL_Comm->SendD3Q19AA( fq );
+		ScaLBL_D3Q19_AAeven_MRT( fq, L.first, L.last, Np, rlx_setA, rlx_setB, Fx, Fy, Fz );
+		L.ScaLBL_Comm->RecvD3Q19AA( fq );
+		ScaLBL_D3Q19_AAeven_MRT( fq, 0, L.exterior, Np, rlx_setA, rlx_setB, Fx, Fy, Fz );
+	} );
+	// 19 distributions read and written, 18 neighbors on odd steps
+	auto result = Result( comm, "mrt", L, seconds, 8*38 + 4*9 );
+	result.kernel_MLUPS = kernel_MLUPS;
+	return result;
+}
+
+static ModelResult BenchmarkGreyscale( const Utilities::MPI &comm, BenchmarkLattice &L, const BenchmarkOptions &options )
+{
+	int Np = L.Np;
+	double *fq = L.Allocate<double>( 19*Np );
+	double *Porosity = L.Allocate<double>( Np );
+	double *Permeability = L.Allocate<double>( Np );
+	double *Velocity = L.Allocate<double>( 3*Np );
+	double *Pressure = L.Allocate<double>( Np );
+	std::vector<double> value( Np, 0.5 );
+	ScaLBL_CopyToDevice( Porosity, value.data(), Np*sizeof(double) );
+	ScaLBL_CopyToDevice( Permeability, value.data(), Np*sizeof(double) );
+	double rlx = 1.0/0.7, rlx_eff = rlx;
+	double Fx = 0.0, Fy = 0.0, Fz = 1.0e-5;
+	ScaLBL_D3Q19_Init( fq, Np );
+	double seconds = TimeSteps( comm, options.steps, [&](){
+		L.ScaLBL_Comm->SendD3Q19AA( fq );
+		ScaLBL_D3Q19_AAodd_Greyscale( L.NeighborList, fq, L.first, L.last, Np, rlx, rlx_eff, Fx, Fy, Fz, Porosity, Permeability, Velocity, Pressure );
+		L.ScaLBL_Comm->RecvD3Q19AA( fq );
+		ScaLBL_D3Q19_AAodd_Greyscale( L.NeighborList, fq, 0, L.exterior, Np, rlx, rlx_eff, Fx, Fy, Fz, Porosity, Permeability, Velocity, Pressure );
+		L.ScaLBL_Comm->SendD3Q19AA( fq );
+		ScaLBL_D3Q19_AAeven_Greyscale( fq, L.first, L.last, Np, rlx, rlx_eff, Fx, Fy, Fz, Porosity, Permeability, Velocity, Pressure );
+		L.ScaLBL_Comm->RecvD3Q19AA( fq );
+		ScaLBL_D3Q19_AAeven_Greyscale( fq, 0, L.exterior, Np, rlx, rlx_eff, Fx, Fy, Fz, Porosity, Permeability, Velocity, Pressure );
+	} );
+	// as MRT, plus porosity and permeability read, velocity and pressure written
+	return Result( comm, "greyscale", L, seconds, 8*44 + 4*9 );
+}
+
+static ModelResult BenchmarkColor( const Utilities::MPI &comm, BenchmarkLattice &L, const BenchmarkOptions &options )
+{
+	int Np = L.Np, Nx = L.Nx, Ny = L.Ny;
+	double *fq = L.Allocate<double>( 19*Np );
+	double *Aq = L.Allocate<double>( 7*Np );
+	double *Bq = L.Allocate<double>( 7*Np );
+	double *Den = L.Allocate<double>( 2*Np );
+	double *Phi = L.Allocate<double>( L.N );
+	double *Velocity = L.Allocate<double>( 3*Np );
+	// two slabs of fluid
+	std::vector<double> phase( L.N );
+	for (int n=0; n<L.N; n++) phase[n] = ( n % Nx < Nx/2 ) ? 1.0 : -1.0;
+	ScaLBL_CopyToDevice( Phi, phase.data(), L.N*sizeof(double) );
+	ScaLBL_D3Q19_Init( fq, Np );
+	ScaLBL_PhaseField_Init( L.dvcMap, Phi, Den, Aq, Bq, 0, L.exterior, Np );
+	ScaLBL_PhaseField_Init( L.dvcMap, Phi, Den, Aq, Bq, L.first, L.last, Np );
+	double rhoA = 1.0, rhoB = 1.0, tauA = 0.7, tauB = 0.7, alpha = 0.005, beta = 0.95;
+	double Fx = 0.0, Fy = 0.0, Fz = 1.0e-5;
+	auto &Comm = L.ScaLBL_Comm;
+	auto &Regular = L.ScaLBL_Comm_Regular;
+	double seconds = TimeSteps( comm, options.steps, [&](){
+		Comm->BiSendD3Q7AA( Aq, Bq );
+		ScaLBL_D3Q7_AAodd_PhaseField( L.NeighborList, L.dvcMap, Aq, Bq, Den, Phi, L.first, L.last, Np );
+		Comm->BiRecvD3Q7AA( Aq, Bq );
+		ScaLBL_D3Q7_AAodd_PhaseField( L.NeighborList, L.dvcMap, Aq, Bq, Den, Phi, 0, L.exterior, Np );
+		Comm->SendD3Q19AA( fq );
+		Regular->SendHalo( Phi );
+		ScaLBL_D3Q19_AAodd_Color( L.NeighborList, L.dvcMap, fq, Aq, Bq, Den, Phi, Velocity, rhoA, rhoB, tauA, tauB,
+			alpha, beta, Fx, Fy, Fz, Nx, Nx*Ny, L.first, L.last, Np );
+		Regular->RecvHalo( Phi );
+		Comm->RecvD3Q19AA( fq );
+		ScaLBL_D3Q19_AAodd_Color( L.NeighborList, L.dvcMap, fq, Aq, Bq, Den, Phi, Velocity, rhoA, rhoB, tauA, tauB,
+			alpha, beta, Fx, Fy, Fz, Nx, Nx*Ny, 0, L.exterior, Np );
+		Comm->BiSendD3Q7AA( Aq, Bq );
+		ScaLBL_D3Q7_AAeven_PhaseField( L.dvcMap, Aq, Bq, Den, Phi, L.first, L.last, Np );
+		Comm->BiRecvD3Q7AA( Aq, Bq );
+		ScaLBL_D3Q7_AAeven_PhaseField( L.dvcMap, Aq, Bq, Den, Phi, 0, L.exterior, Np );
+		Comm->SendD3Q19AA( fq );
+		Regular->SendHalo( Phi );
+		ScaLBL_D3Q19_AAeven_Color( L.dvcMap, fq, Aq, Bq, Den, Phi, Velocity, rhoA, rhoB, tauA, tauB,
+			alpha, beta, Fx, Fy, Fz, Nx, Nx*Ny, L.first, L.last, Np );
+		Regular->RecvHalo( Phi );
+		Comm->RecvD3Q19AA( fq );
+		ScaLBL_D3Q19_AAeven_Color( L.dvcMap, fq, Aq, Bq, Den, Phi, Velocity, rhoA, rhoB, tauA, tauB,
+			alpha, beta, Fx, Fy, Fz, Nx, Nx*Ny, 0, L.exterior, Np );
+	} );
+	// collision: distributions, A and B written, densities, phase, velocity; phase field: A and B read,
+	// densities and phase written; maps of both kernels and the neighbors of both odd kernels
+	return Result( comm, "color", L, seconds, 8*(38+14+2+1+3 + 14+2+1) + 4*(2 + 12) );
+}
+
+static ModelResult BenchmarkFreeLee( const Utilities::MPI &comm, BenchmarkLattice &L, const BenchmarkOptions &options )
+{
+	int Np = L.Np;
+	int Nxh = L.WideHalo->Nxh, Nyh = L.WideHalo->Nyh, Nh = L.WideHalo->Nh;
+	double *gqbar = L.Allocate<double>( 19*Np );
+	double *hq = L.Allocate<double>( 7*Np );
+	double *mu_phi = L.Allocate<double>( Np );
+	double *Den = L.Allocate<double>( Np );
+	double *Phi = L.Allocate<double>( Nh );
+	double *Pressure = L.Allocate<double>( Np );
+	double *Velocity = L.Allocate<double>( 3*Np );
+	double *ColorGrad = L.Allocate<double>( 3*Np );
+	std::vector<double> phase( Nh );
+	for (int n=0; n<Nh; n++) phase[n] = ( n % Nxh < Nxh/2 ) ? 1.0 : -1.0;
+	ScaLBL_CopyToDevice( Phi, phase.data(), Nh*sizeof(double) );
+	double rhoA = 1.0, rhoB = 1.0, tauA = 0.7, tauB = 0.7, tauM = 1.0;
+	double gamma = 1.0e-3, W = 5.0, beta = 0.75*gamma/W, kappa = 0.375*gamma*W;
+	double Fx = 0.0, Fy = 0.0, Fz = 1.0e-5;
+	ScaLBL_D3Q19_FreeLeeModel_TwoFluid_Init( gqbar, mu_phi, ColorGrad, Fx, Fy, Fz, Np );
+	ScaLBL_FreeLeeModel_PhaseField_Init( L.dvcMap, Phi, Den, hq, ColorGrad, rhoA, rhoB, tauM, W, 0, L.exterior, Np );
+	ScaLBL_FreeLeeModel_PhaseField_Init( L.dvcMap, Phi, Den, hq, ColorGrad, rhoA, rhoB, tauM, W, L.first, L.last, Np );
+	auto &Comm = L.ScaLBL_Comm;
+	auto &Halo = L.WideHalo;
+	double seconds = TimeSteps( comm, options.steps, [&](){
+		Comm->SendD3Q7AA( hq, 0 );
+		ScaLBL_D3Q7_AAodd_FreeLeeModel_PhaseField( L.NeighborList, L.dvcMap, hq, Den, Phi, rhoA, rhoB, L.first, L.last, Np );
+		Comm->RecvD3Q7AA( hq, 0 );
+		ScaLBL_D3Q7_AAodd_FreeLeeModel_PhaseField( L.NeighborList, L.dvcMap, hq, Den, Phi, rhoA, rhoB, 0, L.exterior, Np );
+		Comm->SendD3Q19AA( gqbar );
+		Halo->Send( Phi );
+		ScaLBL_D3Q19_AAodd_FreeLeeModel_Combined( L.NeighborList, L.dvcMap, gqbar, hq, Den, Phi, mu_phi, Velocity, Pressure, ColorGrad,
+			rhoA, rhoB, tauA, tauB, tauM, kappa, beta, W, Fx, Fy, Fz, Nxh, Nxh*Nyh, L.first, L.last, Np );
+		Halo->Recv( Phi );
+		Comm->RecvD3Q19AA( gqbar );
+		ScaLBL_D3Q19_AAodd_FreeLeeModel_Combined( L.NeighborList, L.dvcMap, gqbar, hq, Den, Phi, mu_phi, Velocity, Pressure, ColorGrad,
+			rhoA, rhoB, tauA, tauB, tauM, kappa, beta, W, Fx, Fy, Fz, Nxh, Nxh*Nyh, 0, L.exterior, Np );
+		Comm->SendD3Q7AA( hq, 0 );
+		ScaLBL_D3Q7_AAeven_FreeLeeModel_PhaseField( L.dvcMap, hq, Den, Phi, rhoA, rhoB, L.first, L.last, Np );
+		Comm->RecvD3Q7AA( hq, 0 );
+		ScaLBL_D3Q7_AAeven_FreeLeeModel_PhaseField( L.dvcMap, hq, Den, Phi, rhoA, rhoB, 0, L.exterior, Np );
+		Comm->SendD3Q19AA( gqbar );
+		Halo->Send( Phi );
+		ScaLBL_D3Q19_AAeven_FreeLeeModel_Combined( L.dvcMap, gqbar, hq, Den, Phi, mu_phi, Velocity, Pressure, ColorGrad,
+			rhoA, rhoB, tauA, tauB, tauM, kappa, beta, W, Fx, Fy, Fz, Nxh, Nxh*Nyh, L.first, L.last, Np );
+		Halo->Recv( Phi );
+		Comm->RecvD3Q19AA( gqbar );
+		ScaLBL_D3Q19_AAeven_FreeLeeModel_Combined( L.dvcMap, gqbar, hq, Den, Phi, mu_phi, Velocity, Pressure, ColorGrad,
+			rhoA, rhoB, tauA, tauB, tauM, kappa, beta, W, Fx, Fy, Fz, Nxh, Nxh*Nyh, 0, L.exterior, Np );
+	} );
+	// collision: distributions, phase distributions written, density, phase, chemical potential, velocity,
+	// pressure, gradient; phase field: phase distributions read, density and phase written
+	return Result( comm, "freelee", L, seconds, 8*(38+7+1+1+1+3+1+3 + 7+1+1) + 4*(2 + 12) );
+}
+
+static ModelResult BenchmarkIon( const Utilities::MPI &comm, BenchmarkLattice &L, const BenchmarkOptions &options )
+{
+	int Np = L.Np;
+	double *fq = L.Allocate<double>( 7*Np );
+	double *Ci = L.Allocate<double>( Np );
+	double *Velocity = L.Allocate<double>( 3*Np );
+	double *ElectricField = L.Allocate<double>( 3*Np );
+	double tau = 1.0, rlx = 1.0/tau, Di = (tau-0.5)/3.0, Vt = 0.0257;
+	int zi = 1;
+	ScaLBL_D3Q7_Ion_Init( fq, Ci, 1.0e-3, Np );
+	auto &Comm = L.ScaLBL_Comm;
+	double seconds = TimeSteps( comm, options.steps, [&](){
+		Comm->SendD3Q7AA( fq, 0 );
+		ScaLBL_D3Q7_AAodd_IonConcentration( L.NeighborList, fq, Ci, L.first, L.last, Np );
+		Comm->RecvD3Q7AA( fq, 0 );
+		ScaLBL_D3Q7_AAodd_IonConcentration( L.NeighborList, fq, Ci, 0, L.exterior, Np );
+		ScaLBL_D3Q7_AAodd_Ion( L.NeighborList, fq, Ci, Velocity, ElectricField, Di, zi, rlx, Vt, L.first, L.last, Np );
+		ScaLBL_D3Q7_AAodd_Ion( L.NeighborList, fq, Ci, Velocity, ElectricField, Di, zi, rlx, Vt, 0, L.exterior, Np );
+		Comm->SendD3Q7AA( fq, 0 );
+		ScaLBL_D3Q7_AAeven_IonConcentration( fq, Ci, L.first, L.last, Np );
+		Comm->RecvD3Q7AA( fq, 0 );
+		ScaLBL_D3Q7_AAeven_IonConcentration( fq, Ci, 0, L.exterior, Np );
+		ScaLBL_D3Q7_AAeven_Ion( fq, Ci, Velocity, ElectricField, Di, zi, rlx, Vt, L.first, L.last, Np );
+		ScaLBL_D3Q7_AAeven_Ion( fq, Ci, Velocity, ElectricField, Di, zi, rlx, Vt, 0, L.exterior, Np );
+	} );
+	// concentration: distributions read, concentration written; collision: distributions read and
+	// written, concentration, velocity and field read; neighbors of both odd kernels
+	return Result( comm, "ion", L, seconds, 8*(7+1 + 14+1+3+3) + 4*6 );
+}
+
+static ModelResult BenchmarkPoisson( const Utilities::MPI &comm, BenchmarkLattice &L, const BenchmarkOptions &options )
+{
+	int Np = L.Np;
+	double *fq = L.Allocate<double>( 7*Np );
+	double *Psi = L.Allocate<double>( L.N );
+	double *ElectricField = L.Allocate<double>( 3*Np );
+	double *ChargeDensity = L.Allocate<double>( Np );
+	double tau = 1.0, epsilon_LB = 1.0;
+	ScaLBL_D3Q7_Poisson_Init( L.dvcMap, fq, Psi, L.first, L.last, Np );
+	ScaLBL_D3Q7_Poisson_Init( L.dvcMap, fq, Psi, 0, L.exterior, Np );
+	auto &Comm = L.ScaLBL_Comm;
+	double seconds = TimeSteps( comm, options.steps, [&](){
+		Comm->SendD3Q7AA( fq, 0 );
+		ScaLBL_D3Q7_AAodd_Poisson_ElectricPotential( L.NeighborList, L.dvcMap, fq, Psi, L.first, L.last, Np );
+		Comm->RecvD3Q7AA( fq, 0 );
+		ScaLBL_D3Q7_AAodd_Poisson_ElectricPotential( L.NeighborList, L.dvcMap, fq, Psi, 0, L.exterior, Np );
+		ScaLBL_D3Q7_AAodd_Poisson( L.NeighborList, L.dvcMap, fq, ChargeDensity, Psi, ElectricField, tau, epsilon_LB, L.first, L.last, Np );
+		ScaLBL_D3Q7_AAodd_Poisson( L.NeighborList, L.dvcMap, fq, ChargeDensity, Psi, ElectricField, tau, epsilon_LB, 0, L.exterior, Np );
+		Comm->SendD3Q7AA( fq, 0 );
+		ScaLBL_D3Q7_AAeven_Poisson_ElectricPotential( L.dvcMap, fq, Psi, L.first, L.last, Np );
+		Comm->RecvD3Q7AA( fq, 0 );
+		ScaLBL_D3Q7_AAeven_Poisson_ElectricPotential( L.dvcMap, fq, Psi, 0, L.exterior, Np );
+		ScaLBL_D3Q7_AAeven_Poisson( L.dvcMap, fq, ChargeDensity, Psi, ElectricField, tau, epsilon_LB, L.first, L.last, Np );
+		ScaLBL_D3Q7_AAeven_Poisson( L.dvcMap, fq, ChargeDensity, Psi, ElectricField, tau, epsilon_LB, 0, L.exterior, Np );
+	} );
+	// potential: distributions read, potential written; collision: distributions read and written,
+	// charge and potential read, field written; maps and neighbors of both odd kernels
+	return Result( comm, "poisson", L, seconds, 8*(7+1 + 14+1+1+3) + 4*(2 + 6) );
+}
+
+static ModelResult BenchmarkHalo( const Utilities::MPI &comm, BenchmarkLattice &L, const BenchmarkOptions &options )
+{
+	double *fq = L.Allocate<double>( 19*L.Np );
+	ScaLBL_D3Q19_Init( fq, L.Np );
+	double seconds = TimeSteps( comm, options.steps, [&](){
+		L.ScaLBL_Comm->SendD3Q19AA( fq );
+		L.ScaLBL_Comm->RecvD3Q19AA( fq );
+		L.ScaLBL_Comm->SendD3Q19AA( fq );
+		L.ScaLBL_Comm->RecvD3Q19AA( fq );
+	} );
+	// packed and unpacked distributions, five for each site on a face
+	double exchanged = comm.sumReduce( (double) L.ScaLBL_Comm->CommunicationCount );
+	double sites = comm.sumReduce( (double) L.sites );
+	return Result( comm, "halo", L, seconds, 2*8*5*exchanged / max( sites, 1.0 ) );
+}
+
+typedef ModelResult (*BenchmarkFunction)( const Utilities::MPI&, BenchmarkLattice&, const BenchmarkOptions& );
+
+// Run the benchmark of each model on the ranks of comm
+static RunResult RunBenchmark( const Utilities::MPI &comm, const std::array<int,3> &n, const BenchmarkOptions &options )
+{
+	const std::vector<std::pair<std::string,BenchmarkFunction>> benchmarks = {
+		{ "mrt", BenchmarkMRT }, { "color", BenchmarkColor }, { "freelee", BenchmarkFreeLee },
+		{ "greyscale", BenchmarkGreyscale }, { "ion", BenchmarkIon }, { "poisson", BenchmarkPoisson },
+		{ "halo", BenchmarkHalo } };
+	RunResult run;
+	run.nprocs = comm.getSize();
+	run.nproc = ProcessGrid( run.nprocs );
+	run.n = n;
+	run.porosity = 0.0;
+	for (const auto &name : options.models){
+		auto it = benchmarks.begin();
+		while ( it != benchmarks.end() && it->first != name ) ++it;
+		INSIST( it != benchmarks.end(), "lbpm_benchmark: unknown model " + name );
+		BenchmarkLattice lattice( comm, run.nproc, n, options, name == "freelee" ? 2 : 1 );
+		run.models.push_back( it->second( comm, lattice, options ) );
+		double volume = double(n[0])*n[1]*n[2]*run.nprocs;
+		run.porosity = run.models.back().sites / volume;
+	}
+	return run;
+}
+
+
+static void WriteJSON( FILE *fid, const BenchmarkOptions &options, const std::vector<RunResult> &runs )
+{
+	fprintf( fid, "{\n" );
+	fprintf( fid, "  \"benchmark\": \"lbpm_benchmark\",\n" );
+	fprintf( fid, "  \"geometry\": \"%s\",\n", options.geometry.c_str() );
+	fprintf( fid, "  \"porosity_target\": %g,\n", options.porosity );
+	fprintf( fid, "  \"steps\": %i,\n", options.steps );
+#if defined(USE_CUDA)
+	fprintf( fid, "  \"device\": \"cuda\",\n" );
+#elif defined(USE_HIP)
+	fprintf( fid, "  \"device\": \"hip\",\n" );
+#else
+	fprintf( fid, "  \"device\": \"cpu\",\n" );
+#endif
+	fprintf( fid, "  \"scaling\": \"%s\",\n", options.scaling.c_str() );
+	fprintf( fid, "  \"runs\": [\n" );
+	for (size_t r=0; r<runs.size(); r++){
+		const auto &run = runs[r];
+		fprintf( fid, "    {\n" );
+		fprintf( fid, "      \"nprocs\": %i,\n", run.nprocs );
+		fprintf( fid, "      \"nproc\": [%i, %i, %i],\n", run.nproc[0], run.nproc[1], run.nproc[2] );
+		fprintf( fid, "      \"n\": [%i, %i, %i],\n", run.n[0], run.n[1], run.n[2] );
+		fprintf( fid, "      \"porosity\": %.6g,\n", run.porosity );
+		fprintf( fid, "      \"models\": [\n" );
+		for (size_t m=0; m<run.models.size(); m++){
+			const auto &model = run.models[m];
+			const auto &first = runs[0].models[m];
+			double MLUPS = model.sites / model.seconds / 1.0e6;
+			// weak scaling keeps the time per step, strong scaling divides it by the number of ranks
+			double efficiency = first.seconds / model.seconds;
+			if ( options.scaling == "strong" )
+				efficiency *= double(runs[0].nprocs) / run.nprocs;
+			fprintf( fid, "        { \"name\": \"%s\", \"sites\": %.0f, \"seconds_per_step\": %.6g, \"MLUPS\": %.6g, "
+				"\"MLUPS_per_rank\": %.6g, \"bytes_per_site\": %.6g, \"bandwidth_GBs\": %.6g, \"memory_per_site\": %.6g, "
+				"\"efficiency\": %.4g",
+				model.name.c_str(), model.sites, model.seconds, MLUPS, MLUPS/run.nprocs, model.bytes_per_site,
+				model.bytes_per_site*model.sites/model.seconds/1.0e9, model.memory_per_site, efficiency );
+			if ( model.kernel_MLUPS > 0.0 )
+				fprintf( fid, ", \"kernel_MLUPS_per_rank\": %.6g", model.kernel_MLUPS );
+			fprintf( fid, " }%s\n", m+1 < run.models.size() ? "," : "" );
+		}
+		fprintf( fid, "      ]\n" );
+		fprintf( fid, "    }%s\n", r+1 < runs.size() ? "," : "" );
+	}
+	fprintf( fid, "  ]\n" );
+	fprintf( fid, "}\n" );
+}
+
+
+/*
+ * Device memory per rank of each model for the domain of --predict split over each number of
+ * ranks, the sub-domains have porosity*volume sites and porosity*area sites on each face
+ */
+static void PredictMemory( const BenchmarkOptions &options )
+{
+	const double MB = 1024.0*1024.0;
+	double phi = options.porosity;
+	std::vector<std::string> models;
+	for (const auto &model : options.models)
+		if ( model != "halo" ) models.push_back( model );
+	// sub-domain and footprint of each model for each number of ranks
+	std::vector<std::array<int,3>> grids;
+	std::vector<std::array<size_t,3>> sizes;
+	std::vector<std::vector<std::vector<ScaLBL_MemoryUsage>>> usage;
+	for (int p : options.ranks){
+		auto grid = ProcessGrid( p );
+		std::array<size_t,3> n;
+		for (int d=0; d<3; d++) n[d] = ( options.predict[d] + grid[d] - 1 ) / grid[d];
+		size_t Np = phi*n[0]*n[1]*n[2];
+		size_t N = (n[0]+2)*(n[1]+2)*(n[2]+2);
+		// faces x, X, y, Y, z, Z, then the edges along z, y and x
+		std::vector<size_t> halo = {
+			(size_t) (phi*n[1]*n[2]), (size_t) (phi*n[1]*n[2]), (size_t) (phi*n[0]*n[2]),
+			(size_t) (phi*n[0]*n[2]), (size_t) (phi*n[0]*n[1]), (size_t) (phi*n[0]*n[1]) };
+		for (int d=2; d>=0; d--)
+			for (int e=0; e<4; e++) halo.push_back( phi*n[d] );
+		grids.push_back( grid );
+		sizes.push_back( n );
+		usage.emplace_back();
+		for (const auto &model : models)
+			usage.back().push_back( ScaLBL_PredictMemory( model, Np, N, halo, halo ) );
+	}
+	printf("Predicted memory per rank (MB) for %i x %i x %i, porosity %g \n",
+		options.predict[0], options.predict[1], options.predict[2], phi);
+	printf("   %-8s %-20s", "ranks", "sub-domain");
+	for (const auto &model : models) printf(" %10s", model.c_str());
+	printf("\n");
+	for (size_t r=0; r<options.ranks.size(); r++){
+		printf("   %-8i %4zu x %4zu x %4zu   ", options.ranks[r], sizes[r][0], sizes[r][1], sizes[r][2]);
+		for (size_t m=0; m<models.size(); m++) printf(" %10.1f", usage[r][m].back().current/MB);
+		printf("\n");
+	}
+	FILE *fid = ( options.output == "-" ) ? stdout : fopen( options.output.c_str(), "w" );
+	INSIST( fid != nullptr, "lbpm_benchmark: cannot open " + options.output );
+	fprintf( fid, "{\n" );
+	fprintf( fid, "  \"benchmark\": \"lbpm_benchmark\",\n" );
+	fprintf( fid, "  \"predict\": [%i, %i, %i],\n", options.predict[0], options.predict[1], options.predict[2] );
+	fprintf( fid, "  \"porosity\": %g,\n", phi );
+	fprintf( fid, "  \"runs\": [\n" );
+	for (size_t r=0; r<options.ranks.size(); r++){
+		fprintf( fid, "    {\n" );
+		fprintf( fid, "      \"nprocs\": %i,\n", options.ranks[r] );
+		fprintf( fid, "      \"nproc\": [%i, %i, %i],\n", grids[r][0], grids[r][1], grids[r][2] );
+		fprintf( fid, "      \"n\": [%zu, %zu, %zu],\n", sizes[r][0], sizes[r][1], sizes[r][2] );
+		fprintf( fid, "      \"models\": [\n" );
+		for (size_t m=0; m<models.size(); m++){
+			const auto &arrays = usage[r][m];
+			fprintf( fid, "        { \"name\": \"%s\", \"bytes_per_rank\": %zu, \"arrays\": {",
+				models[m].c_str(), arrays.back().current );
+			for (size_t t=0; t+1<arrays.size(); t++)
+				fprintf( fid, "%s\"%s\": %zu", t ? ", " : " ", arrays[t].name.c_str(), arrays[t].current );
+			fprintf( fid, " } }%s\n", m+1 < models.size() ? "," : "" );
+		}
+		fprintf( fid, "      ]\n" );
+		fprintf( fid, "    }%s\n", r+1 < options.ranks.size() ? "," : "" );
+	}
+	fprintf( fid, "  ]\n" );
+	fprintf( fid, "}\n" );
+	if ( fid != stdout ){
+		fclose( fid );
+		printf("Results written to %s \n", options.output.c_str());
+	}
+}
+
+
+int main(int argc, char **argv)
+{
+	// Initialize MPI
+	Utilities::startup( argc, argv );
+	Utilities::MPI comm( MPI_COMM_WORLD );
+	int rank = comm.getRank();
+	int nprocs = comm.getSize();
+	{
+		auto options = ReadOptions( argc, argv );
+		if ( !options.predict.empty() ){
+			// no allocation, the prediction only needs one rank
+			if (rank == 0) PredictMemory( options );
+			Utilities::shutdown();
+			return 0;
+		}
+		if (rank == 0){
+			printf("********************************************************\n");
+			printf("Running LBPM benchmark: %s, n = %i, porosity = %g, %i steps \n",
+				options.geometry.c_str(), options.n, options.porosity, options.steps);
+			printf("********************************************************\n");
+		}
+		int device=ScaLBL_SetDevice(rank);
+		NULL_USE( device );
+		ScaLBL_DeviceBarrier();
+		comm.barrier();
+
+		// number of ranks of each run (powers of two for the scaling studies)
+		std::vector<int> counts;
+		if ( options.scaling == "none" ){
+			counts.push_back( nprocs );
+		}
+		else {
+			for (int p=1; p<nprocs; p*=2) counts.push_back( p );
+			counts.push_back( nprocs );
+		}
+		// strong scaling divides the domain of the largest run
+		auto grid = ProcessGrid( nprocs );
+		std::array<int,3> global = { options.n*grid[0], options.n*grid[1], options.n*grid[2] };
+
+		std::vector<RunResult> runs;
+		for (int p : counts){
+			std::array<int,3> n = { options.n, options.n, options.n };
+			if ( options.scaling == "strong" ){
+				auto sub = ProcessGrid( p );
+				bool divides = true;
+				for (int d=0; d<3; d++){
+					n[d] = global[d] / sub[d];
+					divides = divides && n[d]*sub[d] == global[d];
+				}
+				if ( !divides ){
+					if (rank == 0) printf("Skipping %i ranks: the domain does not divide evenly \n", p);
+					continue;
+				}
+			}
+			auto group = comm.split( rank < p ? 0 : 1, rank );
+			RunResult run;
+			if ( rank < p )
+				run = RunBenchmark( group, n, options );
+			comm.barrier();
+			if (rank == 0){
+				printf("%i ranks (%i x %i x %i), sub-domain %i x %i x %i, porosity %.3f \n", p,
+					run.nproc[0], run.nproc[1], run.nproc[2], n[0], n[1], n[2], run.porosity);
+				printf("   %-10s %12s %12s %14s %14s \n", "model", "MLUPS", "s/step", "bytes/site", "memory/site");
+				for (const auto &model : run.models)
+					printf("   %-10s %12.4f %12.4e %14.1f %14.1f \n", model.name.c_str(),
+						model.sites/model.seconds/1.0e6, model.seconds, model.bytes_per_site, model.memory_per_site);
+				runs.push_back( run );
+			}
+		}
+		if (rank == 0){
+			FILE *fid = ( options.output == "-" ) ? stdout : fopen( options.output.c_str(), "w" );
+			INSIST( fid != nullptr, "lbpm_benchmark: cannot open " + options.output );
+			WriteJSON( fid, options, runs );
+			if ( fid != stdout ){
+				fclose( fid );
+				printf("Results written to %s \n", options.output.c_str());
+			}
+		}
+	}
+	Utilities::shutdown();
+}
@@ -60,6 +60,15 @@ int main(int argc, char **argv)
         // Load user input database files for Navier-Stokes and Ion solvers
         StokesModel.ReadParams(filename);
         IonModel.ReadParams(filename);
+        PoissonSolver.ReadParams(filename);
+
+        // Read the image and build the layout once for all the models
+        if (Study.shared_lattice){
+            auto Lattice = std::make_shared<ScaLBL_LatticeTopology>(StokesModel.domain_db,StokesModel.BoundaryCondition,comm);
+            StokesModel.AttachLattice(Lattice);
+            IonModel.AttachLattice(Lattice);
+            PoissonSolver.AttachLattice(Lattice);
+        }
 
         // Setup other model specific structures
         StokesModel.SetDomain();    
@@ -83,19 +92,31 @@ int main(int argc, char **argv)
         Study.getTimeConvMax_PNP_coupling(StokesModel.time_conv,IonModel.time_conv);
 
         // Initialize LB-Poisson model
-        PoissonSolver.ReadParams(filename);
         PoissonSolver.SetDomain();    
         PoissonSolver.ReadInput();    
         PoissonSolver.Create();       
         PoissonSolver.Initialize(Study.time_conv_max);   
 
 
+        // Poisson and Stokes solves are skipped while their inputs do not change (MultiphysController adaptive_coupling)
+        int Poisson_solver = Study.AddCoupledSolver("Poisson");
+        Study.AddCouplingInput(Poisson_solver,IonModel.ChargeDensity,IonModel.Np);
+        int Stokes_solver = Study.AddCoupledSolver("Stokes");
+        Study.AddCouplingInput(Stokes_solver,IonModel.ChargeDensity,IonModel.Np);
+        Study.AddCouplingInput(Stokes_solver,PoissonSolver.ElectricField,3*PoissonSolver.Np);
+        // Run_Lite time-marches the flow (body force, inlet/outlet BC), it is only skipped once the velocity is steady
+        Study.AddCouplingInput(Stokes_solver,StokesModel.Velocity,3*StokesModel.Np);
+        // periodic electric potential boundary conditions change with time
+        bool PoissonTimeDependent = (PoissonSolver.BoundaryConditionInlet==2 || PoissonSolver.BoundaryConditionOutlet==2);
+
         int timestep=0;
         while (timestep < Study.timestepMax){
             
             timestep++;
-            PoissonSolver.Run(IonModel.ChargeDensity,timestep);//solve Poisson equtaion to get steady-state electrical potental
-            StokesModel.Run_Lite(IonModel.ChargeDensity, PoissonSolver.ElectricField);// Solve the N-S equations to get velocity
+            if (Study.SolveRequired(Poisson_solver,PoissonTimeDependent))
+                PoissonSolver.Run(IonModel.ChargeDensity,timestep);//solve Poisson equtaion to get steady-state electrical potental
+            if (Study.SolveRequired(Stokes_solver))
+                StokesModel.Run_Lite(IonModel.ChargeDensity, PoissonSolver.ElectricField);// Solve the N-S equations to get velocity
             IonModel.Run(StokesModel.Velocity,PoissonSolver.ElectricField); //solve for ion transport and electric potential
             
             timestep++;//AA operations
@@ -113,6 +134,7 @@ int main(int argc, char **argv)
             }
         }
 
+        Study.CouplingReport();
         if (rank==0) printf("Save simulation raw data at maximum timestep\n");
     	Analysis.WriteVis(IonModel,PoissonSolver,StokesModel,Study.db,timestep);
 
@@ -0,0 +1,228 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <chrono>
+#include <thread>
+#include <iostream>
+#include <exception>
+#include <stdexcept>
+#include <fstream>
+
+#include "common/Utilities.h"
+#include "common/MPI.h"
+#include "models/ColorModel.h"
+#include "models/MRTModel.h"
+
+/*
+ * Ensemble driver: run many independent (small) simulations in one MPI job
+ *
+ * Ensemble {
+ *    cases = "rev_000/input.db", "rev_001/input.db", ...
+ *    ranks_per_case = 4                  // MPI processes per case (must divide the job size)
+ *    summary_file = "ensemble.csv"       // aggregated results (written by rank 0)
+ * }
+ *
+ * MPI_COMM_WORLD is split into groups of ranks_per_case processes.  Each group
+ * runs one case at a time in the directory that contains its input file and asks
+ * for the next case when it finishes.  Cases with a Color section run ScaLBL_ColorModel,
+ * cases with an MRT section run ScaLBL_MRTModel.  The product of nproc in each case
+ * must equal ranks_per_case.
+ */
+
+// Columns of the summary table
+enum { CASE_GROUP, CASE_TIMESTEPS, CASE_WALLTIME, CASE_MLUPS, CASE_SW, CASE_KN, CASE_KW, CASE_COLUMNS };
+
+static std::string DirName( const std::string &path )
+{
+	auto pos = path.find_last_of( '/' );
+	if ( pos == std::string::npos ) return ".";
+	return path.substr( 0, pos );
+}
+
+static std::string BaseName( const std::string &path )
+{
+	auto pos = path.find_last_of( '/' );
+	if ( pos == std::string::npos ) return path;
+	return path.substr( pos+1 );
+}
+
+static void ForceDirection( double Fx, double Fy, double Fz, double &dir_x, double &dir_y, double &dir_z, double &force_mag )
+{
+	force_mag = sqrt(Fx*Fx+Fy*Fy+Fz*Fz);
+	if (force_mag == 0.0){
+		// default to z direction
+		dir_x = 0.0; dir_y = 0.0; dir_z = 1.0;
+		force_mag = 1.0;
+	}
+	else {
+		dir_x = Fx/force_mag; dir_y = Fy/force_mag; dir_z = Fz/force_mag;
+	}
+}
+
+// Run one case on the group communicator, the results are set on the group leader
+static void RunCase( const std::string &filename, const Utilities::MPI &group_comm, double *result )
+{
+	int rank = group_comm.getRank();
+	int nprocs = group_comm.getSize();
+	auto db = std::make_shared<Database>( filename );
+	auto nproc = db->getDatabase( "Domain" )->getVector<int>( "nproc" );
+	INSIST( nproc[0]*nproc[1]*nproc[2] == nprocs, "Domain nproc does not match Ensemble ranks_per_case" );
+	auto t1 = std::chrono::system_clock::now();
+	if (db->keyExists( "Color" )){
+		ScaLBL_ColorModel ColorModel( rank, nprocs, group_comm );
+		ColorModel.ReadParams( db );
+		ColorModel.SetDomain();
+		ColorModel.ReadInput();
+		ColorModel.Create();
+		ColorModel.Initialize();
+		result[CASE_MLUPS] = ColorModel.Run( ColorModel.timestepMax );
+		result[CASE_TIMESTEPS] = ColorModel.timestep;
+		// steady-state measures from the last analysis step (as in lbpm_color_simulator)
+		double dir_x, dir_y, dir_z, force_mag;
+		ForceDirection( ColorModel.Fx, ColorModel.Fy, ColorModel.Fz, dir_x, dir_y, dir_z, force_mag );
+		auto &Averages = *ColorModel.Averages;
+		double h = ColorModel.Dm->voxel_length;
+		double volA = Averages.gnb.V, volB = Averages.gwb.V;
+		double muA = (ColorModel.tauA-0.5)/3.0, muB = (ColorModel.tauB-0.5)/3.0;
+		double flow_rate_A = 0.0, flow_rate_B = 0.0;
+		if (Averages.gnb.M > 0.0)
+			flow_rate_A = volA/ColorModel.Dm->Volume*(Averages.gnb.Px*dir_x + Averages.gnb.Py*dir_y + Averages.gnb.Pz*dir_z)/Averages.gnb.M;
+		if (Averages.gwb.M > 0.0)
+			flow_rate_B = volB/ColorModel.Dm->Volume*(Averages.gwb.Px*dir_x + Averages.gwb.Py*dir_y + Averages.gwb.Pz*dir_z)/Averages.gwb.M;
+		result[CASE_SW] = (volA+volB > 0.0) ? volB/(volA+volB) : 0.0;
+		result[CASE_KN] = h*h*muA*flow_rate_A/force_mag;
+		result[CASE_KW] = h*h*muB*flow_rate_B/force_mag;
+	}
+	else if (db->keyExists( "MRT" )){
+		ScaLBL_MRTModel MRT( rank, nprocs, group_comm );
+		MRT.ReadParams( db );
+		MRT.SetDomain();
+		MRT.ReadInput();
+		MRT.Create();
+		MRT.Initialize();
+		MRT.Run();
+		double cputime = std::chrono::duration<double>( std::chrono::system_clock::now() - t1 ).count();
+		result[CASE_TIMESTEPS] = MRT.timestep;
+		result[CASE_MLUPS] = group_comm.sumReduce( double(MRT.Np) )*MRT.timestep/cputime/1000000/nprocs;
+		result[CASE_SW] = 1.0;
+		result[CASE_KN] = 0.0;
+		result[CASE_KW] = MRT.absperm;
+	}
+	else {
+		ERROR( "Ensemble case " + filename + " has no Color or MRT section" );
+	}
+	group_comm.barrier();
+	result[CASE_WALLTIME] = std::chrono::duration<double>( std::chrono::system_clock::now() - t1 ).count();
+	if (rank != 0){
+		for (int m=0; m<CASE_COLUMNS; m++) result[m] = 0.0;
+	}
+}
+
+#ifdef USE_MPI
+// Hand out the case indices to the group leaders in the order they ask for them
+static void DispatchCases( const Utilities::MPI &dispatch_comm, int ncases, int ngroups, int ranks_per_case )
+{
+	int next = 0, active = ngroups;
+	while (active > 0){
+		if (dispatch_comm.Iprobe( MPI_ANY_SOURCE, 1 ) < 0){
+			std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+			continue;
+		}
+		int group;
+		dispatch_comm.recv( &group, 1, MPI_ANY_SOURCE, 1 );
+		int index = (next < ncases) ? next++ : -1;
+		if (index < 0) active--;
+		dispatch_comm.send( &index, 1, group*ranks_per_case, 2 );
+	}
+}
+#endif
+
+int main( int argc, char **argv )
+{
+	// Initialize
+	Utilities::startup( argc, argv );
+
+	{ // Limit scope so variables that contain communicators will free before MPI_Finialize
+
+		Utilities::MPI comm( MPI_COMM_WORLD );
+		int rank   = comm.getRank();
+		int nprocs = comm.getSize();
+		auto db = std::make_shared<Database>( argv[1] );
+		auto ensemble_db = db->getDatabase( "Ensemble" );
+		auto cases = ensemble_db->getVector<std::string>( "cases" );
+		int ranks_per_case = ensemble_db->getWithDefault<int>( "ranks_per_case", 1 );
+		auto summary_file = ensemble_db->getWithDefault<std::string>( "summary_file", "ensemble.csv" );
+		INSIST( ranks_per_case > 0 && nprocs % ranks_per_case == 0, "ranks_per_case must divide the number of MPI processes" );
+		int ncases = cases.size();
+		int ngroups = nprocs / ranks_per_case;
+		int group = rank / ranks_per_case;
+
+		if ( rank == 0 ) {
+			printf( "********************************************************\n" );
+			printf( "Running LBM ensemble: %i cases, %i groups of %i processes \n", ncases, ngroups, ranks_per_case );
+			printf( "********************************************************\n" );
+		}
+		// Initialize compute device
+		int device = ScaLBL_SetDevice( rank );
+		NULL_USE( device );
+		ScaLBL_DeviceBarrier();
+		comm.barrier();
+		Utilities::setErrorHandlers();
+
+		auto group_comm = comm.split( group, rank );
+		auto dispatch_comm = comm.dup();
+		char cwd[4096];
+		INSIST( getcwd( cwd, sizeof(cwd) ) != nullptr, "Unable to get the working directory" );
+
+		// cases are handed out dynamically by a thread on rank 0 if MPI allows it,
+		// otherwise group g runs cases g, g+ngroups, ...
+		bool dynamic = false;
+#ifdef USE_MPI
+		dynamic = ngroups > 1 && Utilities::MPI::queryThreadSupport() == Utilities::MPI::ThreadSupport::MULTIPLE;
+		std::thread dispatcher;
+		if ( dynamic && rank == 0 )
+			dispatcher = std::thread( DispatchCases, std::cref( dispatch_comm ), ncases, ngroups, ranks_per_case );
+#endif
+		std::vector<double> results( ncases*CASE_COLUMNS, 0.0 );
+		for (int count=0; ; count++){
+			int index = group + count*ngroups;
+			if ( dynamic ){
+				if ( group_comm.getRank() == 0 ){
+					dispatch_comm.send( &group, 1, 0, 1 );
+					dispatch_comm.recv( &index, 1, 0, 2 );
+				}
+				index = group_comm.bcast( index, 0 );
+			}
+			if ( index < 0 || index >= ncases )
+				break;
+			if ( group_comm.getRank() == 0 )
+				printf( "Group %i: running case %i (%s) \n", group, index, cases[index].c_str() );
+			// run in the directory of the input file so the outputs of the cases stay separate
+			INSIST( chdir( DirName( cases[index] ).c_str() ) == 0, "Unable to change to the directory of " + cases[index] );
+			double *result = &results[index*CASE_COLUMNS];
+			RunCase( BaseName( cases[index] ), group_comm, result );
+			result[CASE_GROUP] = ( group_comm.getRank() == 0 ) ? group : 0;
+			INSIST( chdir( cwd ) == 0, "Unable to return to the working directory" );
+		}
+#ifdef USE_MPI
+		if ( dispatcher.joinable() )
+			dispatcher.join();
+#endif
+		// each case was set by exactly one group leader
+		comm.sumReduce( results.data(), results.size() );
+		if ( rank == 0 ) {
+			FILE *SUMMARY = fopen( summary_file.c_str(), "w" );
+			fprintf( SUMMARY, "case group ranks timesteps wall_time MLUPS sat_w k_n k_w input\n" );
+			for (int c=0; c<ncases; c++){
+				const double *r = &results[c*CASE_COLUMNS];
+				fprintf( SUMMARY, "%i %i %i %i %.6g %.6g %.8g %.8g %.8g %s\n", c, int(r[CASE_GROUP]), ranks_per_case,
+					int(r[CASE_TIMESTEPS]), r[CASE_WALLTIME], r[CASE_MLUPS], r[CASE_SW], r[CASE_KN], r[CASE_KW], cases[c].c_str() );
+			}
+			fclose( SUMMARY );
+			printf( "Ensemble finished, results written to %s \n", summary_file.c_str() );
+		}
+	} // Limit scope so variables that contain communicators will free before MPI_Finialize
+
+	Utilities::shutdown();
+	return 0;
+}
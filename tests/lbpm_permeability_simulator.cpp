@@ -47,7 +47,10 @@ int main(int argc, char **argv)
 		MRT.ReadInput();
 		MRT.Create();       // creating the model will create data structure to match the pore structure and allocate variables
 		MRT.Initialize();   // initializing the model will set initial conditions for variables
-		MRT.Run();	 
+		if (MRT.sweep_levels > 0)
+			MRT.RunSweep(); // non-Darcy curve (MRT { sweep_levels = ... })
+		else
+			MRT.Run();
 		MRT.VelocityField();
 	}
     Utilities::shutdown();
@@ -1,6 +1,15 @@
 /*
  * Pre-processor to refine signed distance mesh
  * this is a good way to increase the resolution 
+ *
+ * Optional settings:
+ * Refine {
+ *    factor = 2                      // refinement factor in each direction
+ *    interpolation = "trilinear"     // or "hermite" (cubic)
+ *    dist_type = "double"            // or "float" (dist_<factor>x.raw)
+ *    write_blocks = true             // also write RefineID / RefineDist blocks for each rank
+ * }
+ * The interpolation runs with LBPM_NUM_THREADS threads per rank (Utilities::setNumThreads).
  */
 #include <stdio.h>
 #include <stdlib.h>
@@ -13,6 +22,8 @@
 #include "common/Domain.h"
 #include "analysis/pmmc.h"
 #include "analysis/distance.h"
+#include "analysis/filters.h"
+#include "analysis/uCT.h"
 
 int main(int argc, char **argv)
 {
@@ -25,9 +36,7 @@ int main(int argc, char **argv)
 		//.......................................................................
 		// Reading the domain information file
 		//.......................................................................
-		double Lx, Ly, Lz;
-        Lx = Ly = Lz = 1.0;
-		int i,j,k,n;
+		int n;
 
 		string filename;
 		if (argc > 1){
@@ -50,7 +59,21 @@ int main(int argc, char **argv)
 		int nprocx = nproc[0];
 		int nprocy = nproc[1];
 		int nprocz = nproc[2];
-		int BoundaryCondition=0;
+
+		// refinement settings
+		int r = 2;
+		std::string method = "trilinear";
+		std::string dist_type = "double";
+		bool write_blocks = true;
+		if (db->keyExists( "Refine" )){
+			auto refine_db = db->getDatabase( "Refine" );
+			r = refine_db->getWithDefault<int>( "factor", 2 );
+			method = refine_db->getWithDefault<std::string>( "interpolation", "trilinear" );
+			dist_type = refine_db->getWithDefault<std::string>( "dist_type", "double" );
+			write_blocks = refine_db->getWithDefault<bool>( "write_blocks", true );
+		}
+		INSIST( r > 0, "Refine factor must be positive" );
+		INSIST( dist_type == "double" || dist_type == "float", "dist_type must be double or float" );
 
 		// Check that the number of processors >= the number of ranks
 		if ( rank==0 ) {
@@ -76,13 +99,15 @@ int main(int argc, char **argv)
 		Mask.CommInit();
 
 		char LocalRankFilename[40];
-		int rnx=2*nx;
-		int rny=2*ny;
-		int rnz=2*nz;
+		int rnx=r*nx;
+		int rny=r*ny;
+		int rnz=r*nz;
 
 		if (rank==0) printf("Refining mesh to %i x %i x %i \n",rnx,rny,rnz);
 
-		Domain Dm(rnx,rny,rnz,rank,nprocx,nprocy,nprocz,Lx,Ly,Lz,BoundaryCondition);
+		auto refine_domain_db = domain_db->cloneDatabase();
+		refine_domain_db->putVector<int>( "n", { rnx, rny, rnz } );
+		Domain Dm(refine_domain_db,comm);
 
 		// Communication the halos
 		const RankInfoStruct rank_info(rank,nprocx,nprocy,nprocz);
@@ -90,7 +115,6 @@ int main(int argc, char **argv)
 
 		nx+=2; ny+=2; nz+=2;
 		rnx+=2; rny+=2; rnz+=2;
-		int N = nx*ny*nz;
 
 		// Define communication sub-domain -- everywhere
 		if (rank==0) printf("Initialize refined domain \n");
@@ -153,228 +177,85 @@ int main(int argc, char **argv)
 */
 		if ( rank==0 )   printf("Set up Domain, read input distance \n");
 
-		DoubleArray RefinedSignDist(rnx,rny,rnz);
-		TriLinPoly LocalApprox;
-		Point pt;
+		// scale the distance value (since it is evaluated in pixels)
+		for (size_t n=0; n<SignDist.length(); n++)
+			SignDist(n) *= r;
 
-		// double the distance value (since it is evaluated in pixels)
-		for (int k=0; k<nz; k++){
-			for (int j=0; j<ny; j++){
-				for (int i=0; i<nx; i++){
-					SignDist(i,j,k) =  2.f*SignDist(i,j,k);
-				}
-			}
-		}
+		// the interpolation stencil includes the ghost cells (edges and corners for hermite)
+		fillHalo<double> fillCoarse(comm,rank_info,{nx-2,ny-2,nz-2},{1,1,1},0,1);
+		fillCoarse.fill(SignDist);
 
-		//char *RefineLabel;
-		//RefineLabel = new char [rnx*rny*rnz];
-		Array <char> RefineLabel(rnx,rny,rnz);
-		for (int rk=1; rk<rnz-1; rk++){
-			for (int rj=1; rj<rny-1; rj++){
-				for (int ri=1; ri<rnx-1; ri++){
-					n = rk*rnx*rny+rj*rnx+ri;
-					// starting node for each processor matches exactly
-					i = (ri-1)/2+1;
-					j = (rj-1)/2+1;
-					k = (rk-1)/2+1;
+		if (rank==0) printf("Interpolate (%s) with %i threads \n",method.c_str(),Utilities::getNumThreads());
+		DoubleArray RefinedSignDist(rnx,rny,rnz);
+		RefinedSignDist.fill(0);
+		RefineMesh(SignDist,RefinedSignDist,r,method);
+		fillData.fill(RefinedSignDist);
 
-					//printf("(%i,%i,%i -> %i,%i,%i) \n",ri,rj,rk,i,j,k);
-					// Assign local tri-linear polynomial
-					LocalApprox.assign(SignDist,i,j,k);
-					pt.x=0.5*(ri-1)+1.f;
-					pt.y=0.5*(rj-1)+1.f;
-					pt.z=0.5*(rk-1)+1.f;
-					RefinedSignDist(ri,rj,rk) = LocalApprox.eval(pt);
-					RefineLabel(ri,rj,rk) = Labels(i,j,k);
-					Dm.id[n] = Labels(i,j,k);
+		// labels are copied from the coarse node at (or below) each refined node
+		Array <char> RefineLabel(rnx,rny,rnz);
+		RefineLabel.fill(0);
+		parallelSlabs(1,rnz-1,[&](int kmin, int kmax){
+			for (int rk=kmin; rk<kmax; rk++){
+				for (int rj=1; rj<rny-1; rj++){
+					for (int ri=1; ri<rnx-1; ri++){
+						int n = rk*rnx*rny+rj*rnx+ri;
+						char label = Labels((ri-1)/r+1,(rj-1)/r+1,(rk-1)/r+1);
+						RefineLabel(ri,rj,rk) = label;
+						Dm.id[n] = label;
+					}
 				}
 			}
+		});
+
+		// single output file for the refined labels and distance
+		if ( rank==0 )   printf("Write output \n");
+		char OutputFilename[100];
+		sprintf(OutputFilename,"id_%ix.raw",r);
+		Dm.AggregateLabels(OutputFilename);
+		sprintf(OutputFilename,"dist_%ix.raw",r);
+		if (dist_type == "float"){
+			Array<float> RefinedSignDistFloat(rnx,rny,rnz);
+			for (size_t n=0; n<RefinedSignDist.length(); n++)
+				RefinedSignDistFloat(n) = RefinedSignDist(n);
+			Dm.AggregateLabels(OutputFilename,RefinedSignDistFloat);
+		}
+		else {
+			Dm.AggregateLabels(OutputFilename,RefinedSignDist);
 		}
-		fillData.fill(RefinedSignDist);
-
-
 		if (domain_db->keyExists( "Filename" )){
-			auto Filename = domain_db->getScalar<std::string>( "Filename" );
-			if ( rank==0 )   printf("Write output \n");
-			Dm.AggregateLabels("id_2x.raw");
 			Mask.AggregateLabels("id.raw");
-			//FILE *WRITEID = fopen("refine.raw","wb");
-			//fwrite(RefineLabel.data(),1,rnx*rny*rnz,WRITEID);
-			//fclose(WRITEID);
 		}
-		else{
+		if (write_blocks){
+			// Write output blocks with the same sub-domain size as the original
+			// refinement increases the size of the process grid by r in each direction
 			DoubleArray BlockDist(nx,ny,nz);
-			FILE *WRITEID, *REFINEDIST;
-			char * id;
-			id = new char [N];
-			int writerank;
-
-			// Write output blocks with the same sub-domain size as origina
-			// refinement increases the size of the process grid
-			writerank = 8*Dm.kproc()*nprocx*nprocy + 4*Dm.jproc()*nprocx + 2*Dm.iproc();
-			for (int k=0; k<nz; k++){
-				for (int j=0; j<ny; j++){
-					for (int i=0; i<nx; i++){
-						BlockDist(i,j,k) = RefinedSignDist(i,j,k);
-						if (BlockDist(i,j,k) > 0) 	id[k*nx*ny + j*nx + i]=2;
-						else 						id[k*nx*ny + j*nx + i] = RefineLabel(i,j,k);
+			Array<char> BlockID(nx,ny,nz);
+			for (int c=0; c<r; c++){
+				for (int b=0; b<r; b++){
+					for (int a=0; a<r; a++){
+						int writerank = (r*Dm.kproc()+c)*r*r*nprocx*nprocy + (r*Dm.jproc()+b)*r*nprocx + r*Dm.iproc()+a;
+						for (int k=0; k<nz; k++){
+							for (int j=0; j<ny; j++){
+								for (int i=0; i<nx; i++){
+									int ri = i+a*(nx-2), rj = j+b*(ny-2), rk = k+c*(nz-2);
+									BlockDist(i,j,k) = RefinedSignDist(ri,rj,rk);
+									if (BlockDist(i,j,k) > 0) 	BlockID(i,j,k) = 2;
+									else 						BlockID(i,j,k) = RefineLabel(ri,rj,rk);
+								}
+							}
+						}
+						sprintf(LocalRankFilename,"RefineDist.%05i",writerank);
+						FILE *REFINEDIST = fopen(LocalRankFilename,"wb");
+						fwrite(BlockDist.data(),8,nx*ny*nz,REFINEDIST);
+						fclose(REFINEDIST);
+
+						sprintf(LocalRankFilename,"RefineID.%05i",writerank);
+						FILE *WRITEID = fopen(LocalRankFilename,"wb");
+						fwrite(BlockID.data(),1,nx*ny*nz,WRITEID);
+						fclose(WRITEID);
 					}
 				}
 			}
-			sprintf(LocalRankFilename,"RefineDist.%05i",writerank);
-			REFINEDIST = fopen(LocalRankFilename,"wb");
-			fwrite(BlockDist.data(),8,nx*ny*nz,REFINEDIST);
-			fclose(REFINEDIST);
-
-
-			sprintf(LocalRankFilename,"RefineID.%05i",writerank);
-			WRITEID = fopen(LocalRankFilename,"wb");
-			fwrite(id,1,nx*ny*nz,WRITEID);
-			fclose(WRITEID);
-
-			writerank = 8*Dm.kproc()*nprocx*nprocy + 4*Dm.jproc()*nprocx + 2*Dm.iproc()+1;
-			for (int k=0; k<nz; k++){
-				for (int j=0; j<ny; j++){
-					for (int i=0; i<nx; i++){
-						BlockDist(i,j,k) = RefinedSignDist(i+nx-2,j,k);
-						if (BlockDist(i,j,k) > 0) 	id[k*nx*ny + j*nx + i]=2;
-						else 						id[k*nx*ny + j*nx + i] = RefineLabel(i+nx-2,j,k);
-					}
-				}
-			}
-			sprintf(LocalRankFilename,"RefineDist.%05i",writerank);
-			REFINEDIST = fopen(LocalRankFilename,"wb");
-			fwrite(BlockDist.data(),8,nx*ny*nz,REFINEDIST);
-			fclose(REFINEDIST);
-
-
-			sprintf(LocalRankFilename,"RefineID.%05i",writerank);
-			WRITEID = fopen(LocalRankFilename,"wb");
-			fwrite(id,1,nx*ny*nz,WRITEID);
-			fclose(WRITEID);
-
-
-			writerank = (2*Dm.kproc())*4*nprocx*nprocy + (2*Dm.jproc()+1)*2*nprocx + 2*Dm.iproc()+1;
-			for (int k=0; k<nz; k++){
-				for (int j=0; j<ny; j++){
-					for (int i=0; i<nx; i++){
-						BlockDist(i,j,k) = RefinedSignDist(i+nx-2,j+ny-2,k);
-						if (BlockDist(i,j,k) > 0) 	id[k*nx*ny + j*nx + i]=2;
-						else 						id[k*nx*ny + j*nx + i] = RefineLabel(i+nx-2,j+ny-2,k);
-					}
-				}
-			}
-			sprintf(LocalRankFilename,"RefineDist.%05i",writerank);
-			REFINEDIST = fopen(LocalRankFilename,"wb");
-			fwrite(BlockDist.data(),8,nx*ny*nz,REFINEDIST);
-			fclose(REFINEDIST);
-
-
-			sprintf(LocalRankFilename,"RefineID.%05i",writerank);
-			WRITEID = fopen(LocalRankFilename,"wb");
-			fwrite(id,1,nx*ny*nz,WRITEID);
-			fclose(WRITEID);
-
-			writerank = (2*Dm.kproc())*4*nprocx*nprocy + (2*Dm.jproc()+1)*2*nprocx + 2*Dm.iproc();
-			for (int k=0; k<nz; k++){
-				for (int j=0; j<ny; j++){
-					for (int i=0; i<nx; i++){
-						BlockDist(i,j,k) = RefinedSignDist(i,j+ny-2,k);
-						if (BlockDist(i,j,k) > 0) 	id[k*nx*ny + j*nx + i]=2;
-						else 						id[k*nx*ny + j*nx + i] = RefineLabel(i,j+ny-2,k);
-					}
-				}
-			}
-			sprintf(LocalRankFilename,"RefineDist.%05i",writerank);
-			REFINEDIST = fopen(LocalRankFilename,"wb");
-			fwrite(BlockDist.data(),8,nx*ny*nz,REFINEDIST);
-			fclose(REFINEDIST);
-
-			sprintf(LocalRankFilename,"RefineID.%05i",writerank);
-			WRITEID = fopen(LocalRankFilename,"wb");
-			fwrite(id,1,nx*ny*nz,WRITEID);
-			fclose(WRITEID);
-
-			writerank = (2*Dm.kproc()+1)*4*nprocx*nprocy + (2*Dm.jproc())*2*nprocx + 2*Dm.iproc();
-			for (int k=0; k<nz; k++){
-				for (int j=0; j<ny; j++){
-					for (int i=0; i<nx; i++){
-						BlockDist(i,j,k) = RefinedSignDist(i,j,k+nz-2);
-						if (BlockDist(i,j,k) > 0) 	id[k*nx*ny + j*nx + i]=2;
-						else 						id[k*nx*ny + j*nx + i] = RefineLabel(i,j,k+nz-2);
-					}
-				}
-			}
-			sprintf(LocalRankFilename,"RefineDist.%05i",writerank);
-			REFINEDIST = fopen(LocalRankFilename,"wb");
-			fwrite(BlockDist.data(),8,nx*ny*nz,REFINEDIST);
-			fclose(REFINEDIST);
-
-			sprintf(LocalRankFilename,"RefineID.%05i",writerank);
-			WRITEID = fopen(LocalRankFilename,"wb");
-			fwrite(id,1,nx*ny*nz,WRITEID);
-			fclose(WRITEID);
-
-			writerank = (2*Dm.kproc()+1)*4*nprocx*nprocy + (2*Dm.jproc())*2*nprocx + 2*Dm.iproc()+1;
-			for (int k=0; k<nz; k++){
-				for (int j=0; j<ny; j++){
-					for (int i=0; i<nx; i++){
-						BlockDist(i,j,k) = RefinedSignDist(i+nx-2,j,k+nz-2);
-						if (BlockDist(i,j,k) > 0) 	id[k*nx*ny + j*nx + i]=2;
-						else 						id[k*nx*ny + j*nx + i] = RefineLabel(i+nx-2,j,k+nz-2);
-					}
-				}
-			}
-			sprintf(LocalRankFilename,"RefineDist.%05i",writerank);
-			REFINEDIST = fopen(LocalRankFilename,"wb");
-			fwrite(BlockDist.data(),8,nx*ny*nz,REFINEDIST);
-			fclose(REFINEDIST);
-
-			sprintf(LocalRankFilename,"RefineID.%05i",writerank);
-			WRITEID = fopen(LocalRankFilename,"wb");
-			fwrite(id,1,nx*ny*nz,WRITEID);
-			fclose(WRITEID);
-
-			writerank = (2*Dm.kproc()+1)*4*nprocx*nprocy + (2*Dm.jproc()+1)*2*nprocx + 2*Dm.iproc();
-			for (int k=0; k<nz; k++){
-				for (int j=0; j<ny; j++){
-					for (int i=0; i<nx; i++){
-						BlockDist(i,j,k) = RefinedSignDist(i,j+ny-2,k+nz-2);
-						if (BlockDist(i,j,k) > 0) 	id[k*nx*ny + j*nx + i]=2;
-						else 						id[k*nx*ny + j*nx + i] = RefineLabel(i,j+ny-2,k+nz-2);
-					}
-				}
-			}
-			sprintf(LocalRankFilename,"RefineDist.%05i",writerank);
-			REFINEDIST = fopen(LocalRankFilename,"wb");
-			fwrite(BlockDist.data(),8,nx*ny*nz,REFINEDIST);
-			fclose(REFINEDIST);
-
-			sprintf(LocalRankFilename,"RefineID.%05i",writerank);
-			WRITEID = fopen(LocalRankFilename,"wb");
-			fwrite(id,1,nx*ny*nz,WRITEID);
-			fclose(WRITEID);
-
-			writerank = (2*Dm.kproc()+1)*4*nprocx*nprocy + (2*Dm.jproc()+1)*2*nprocx + 2*Dm.iproc()+1;
-			for (int k=0; k<nz; k++){
-				for (int j=0; j<ny; j++){
-					for (int i=0; i<nx; i++){
-						BlockDist(i,j,k) = RefinedSignDist(i+nx-2,j+ny-2,k+nz-2);
-						if (BlockDist(i,j,k) > 0) 	id[k*nx*ny + j*nx + i]=2;
-						else 						id[k*nx*ny + j*nx + i] = RefineLabel(i+nx-2,j+ny-2,k+nz-2);
-					}
-				}
-			}
-
-			sprintf(LocalRankFilename,"RefineDist.%05i",writerank);
-			REFINEDIST = fopen(LocalRankFilename,"wb");
-			fwrite(BlockDist.data(),8,nx*ny*nz,REFINEDIST);
-			fclose(REFINEDIST);
-
-			sprintf(LocalRankFilename,"RefineID.%05i",writerank);
-			WRITEID = fopen(LocalRankFilename,"wb");
-			fwrite(id,1,nx*ny*nz,WRITEID);
-			fclose(WRITEID);
 		}
 	}
         Utilities::shutdown();
@@ -1,7 +1,8 @@
 /*
- * Pre-processor to generate signed distance function from segmented data
+ * Serial decomposition of a segmented image into the ID.xxxxx subdomain files
  * segmented data should be stored in a raw binary file as 1-byte integer (type char)
- * will output distance functions for phases
+ * or 2-byte integer (16bit).  The image is streamed one slab of z-planes at a time,
+ * so the memory use does not depend on the size of the global image
  */
 
 #include <stdio.h>
@@ -10,8 +11,11 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <vector>
+#include <algorithm>
 #include "common/Array.h"
 #include "common/Domain.h"
+#include "common/Utilities.h"
 
 int main(int argc, char **argv)
 {
@@ -47,7 +51,6 @@ int main(int argc, char **argv)
 	//.......................................................................
 	// Reading the domain information file
 	//.......................................................................
-	int64_t i,j,k,n;
 	int64_t xStart,yStart,zStart;
 	int checkerSize;
 	int inlet_count_x, inlet_count_y, inlet_count_z;
@@ -128,228 +131,175 @@ int main(int argc, char **argv)
 
 	int nprocs=nprocx*nprocy*nprocz;
 
-	char *SegData = NULL;
-	// Rank=0 reads the entire segmented data and distributes to worker processes
-	if (rank==0){
-		printf("Dimensions of segmented image: %ld x %ld x %ld \n",Nx,Ny,Nz);
-		int64_t SIZE = Nx*Ny*Nz;
-		SegData = new char[SIZE];
-		if (ReadType == "8bit"){
-			printf("Reading 8-bit input data \n");
-			FILE *SEGDAT = fopen(Filename.c_str(),"rb");
-			if (SEGDAT==NULL) ERROR("Error reading segmented data");
-			size_t ReadSeg;
-			ReadSeg=fread(SegData,1,SIZE,SEGDAT);
-			if (ReadSeg != size_t(SIZE)) printf("lbpm_segmented_decomp: Error reading segmented data (rank=%i)\n",rank);
-			fclose(SEGDAT);
-		}
-		else if (ReadType == "16bit"){
-			printf("Reading 16-bit input data \n");
-			short int *InputData;
-			InputData = new short int[SIZE];
-			FILE *SEGDAT = fopen(Filename.c_str(),"rb");
-			if (SEGDAT==NULL) ERROR("Error reading segmented data");
-			size_t ReadSeg;
-			ReadSeg=fread(InputData,2,SIZE,SEGDAT);
-			if (ReadSeg != size_t(SIZE)) printf("lbpm_segmented_decomp: Error reading segmented data (rank=%i)\n",rank);
-			fclose(SEGDAT);
-			for (int n=0; n<SIZE; n++){
-				SegData[n] = char(InputData[n]);
-			}
-		}
-		printf("Read segmented data from %s \n",Filename.c_str());
+	// Streaming parameters: slab_size z-planes of the global image are held in memory at a time,
+	// the subdomain files of a slab are written concurrently (Utilities::parallelFor)
+	int slab_size = 16;
+	if (domain_db->keyExists( "slab_size" )){
+		slab_size = domain_db->getScalar<int>( "slab_size" );
 	}
+	slab_size = std::max( 1, std::min( slab_size, nz+2 ) );
 
-	// relabel the data
-	std::vector<long int> LabelCount(ReadValues.size(),0);
-	for (int k = 0; k<Nz; k++){
-		for (int j = 0; j<Ny; j++){
-			for (int i = 0; i<Nx; i++){
-				n = k*Nx*Ny+j*Nx+i;
-				//char locval = loc_id[n];
-				char locval = SegData[n];
-				for (size_t idx=0; idx<ReadValues.size(); idx++){
-					signed char oldvalue=ReadValues[idx];
-					signed char newvalue=WriteValues[idx];
-					if (locval == oldvalue){
-						SegData[n] = newvalue;
-						LabelCount[idx]++;
-						idx = ReadValues.size();
-					}
-				}
-			}
-		}
-	}
-	if (rank==0){
-		for (size_t idx=0; idx<ReadValues.size(); idx++){
-			long int label=ReadValues[idx];
-			long int count=LabelCount[idx];
-			printf("Label=%ld, Count=%ld \n",label,count);
-		}
-	}
-	
-	if (inlet_count_x > 0){
-		// use checkerboard pattern
-		printf("Checkerboard pattern at x inlet for %i layers \n",inlet_count_x);
-		for (int k = 0; k<Nz; k++){
-			for (int j = 0; j<Ny; j++){
-				for (int i = xStart; i < xStart+inlet_count_x; i++){
-					if ( (j/checkerSize + k/checkerSize)%2 == 0){
-						// void checkers
-						SegData[k*Nx*Ny+j*Nx+i] = 2;
-					}
-					else{
-						// solid checkers
-						SegData[k*Nx*Ny+j*Nx+i] = 0;
-					}
-				}
-			}
-		}
+	// relabel table (the first matching entry of ReadValues is used)
+	char NewValue[256];
+	int LabelIndex[256];
+	for (int c=0; c<256; c++){
+		NewValue[c] = char(c);
+		LabelIndex[c] = -1;
 	}
-	
-	if (inlet_count_y > 0){
-		printf("Checkerboard pattern at y inlet for %i layers \n",inlet_count_y);
-		// use checkerboard pattern
-		for (int k = 0; k<Nz; k++){
-			for (int j = yStart; j < yStart+inlet_count_y; j++){
-				for (int i = 0; i<Nx; i++){
-					if ( (i/checkerSize + k/checkerSize)%2 == 0){
-						// void checkers
-						SegData[k*Nx*Ny+j*Nx+i] = 2;
-					}
-					else{
-						// solid checkers
-						SegData[k*Nx*Ny+j*Nx+i] = 0;
-					}
-				}
-			}
-		}
+	for (int idx=int(ReadValues.size())-1; idx>=0; idx--){
+		unsigned char oldvalue = (signed char) ReadValues[idx];
+		NewValue[oldvalue] = (signed char) WriteValues[idx];
+		LabelIndex[oldvalue] = idx;
 	}
+	std::vector<long int> LabelCount(ReadValues.size(),0);
 
-	if (inlet_count_z > 0){
-		printf("Checkerboard pattern at z inlet for %i layers \n",inlet_count_z);
-		// use checkerboard pattern
-		for (int k = zStart; k < zStart+inlet_count_z; k++){
-			for (int j = 0; j<Ny; j++){
-				for (int i = 0; i<Nx; i++){
-					if ( (i/checkerSize+j/checkerSize)%2 == 0){
-						// void checkers
-						SegData[k*Nx*Ny+j*Nx+i] = 2;
-					}
-					else{
-						// solid checkers
-						SegData[k*Nx*Ny+j*Nx+i] = 0;
-					}
-				}
-			}
-		}
-	}
-	
-	if (outlet_count_x > 0){
-		// use checkerboard pattern
-		printf("Checkerboard pattern at x outlet for %i layers \n",outlet_count_x);
-		for (int k = 0; k<Nz; k++){
-			for (int j = 0; j<Ny; j++){
-				for (int i = xStart + nx*nprocx - outlet_count_x; i <  xStart + nx*nprocx; i++){
-					if ( (j/checkerSize + k/checkerSize)%2 == 0){
-						// void checkers
-						SegData[k*Nx*Ny+j*Nx+i] = 2;
-					}
-					else{
-						// solid checkers
-						SegData[k*Nx*Ny+j*Nx+i] = 0;
-					}
-				}
-			}
-		}
-	}
-	
-	if (outlet_count_y > 0){
-		printf("Checkerboard pattern at y outlet for %i layers \n",outlet_count_y);
-		// use checkerboard pattern
-		for (int k = 0; k<Nz; k++){
-			for (int j = yStart + ny*nprocy - outlet_count_y; j < yStart + ny*nprocy; j++){
-				for (int i = 0; i<Nx; i++){
-					if ( (i/checkerSize + k/checkerSize)%2 == 0){
-						// void checkers
-						SegData[k*Nx*Ny+j*Nx+i] = 2;
-					}
-					else{
-						// solid checkers
-						SegData[k*Nx*Ny+j*Nx+i] = 0;
-					}
-				}
-			}
-		}
-	}
+	if (inlet_count_x > 0) printf("Checkerboard pattern at x inlet for %i layers \n",inlet_count_x);
+	if (inlet_count_y > 0) printf("Checkerboard pattern at y inlet for %i layers \n",inlet_count_y);
+	if (inlet_count_z > 0) printf("Checkerboard pattern at z inlet for %i layers \n",inlet_count_z);
+	if (outlet_count_x > 0) printf("Checkerboard pattern at x outlet for %i layers \n",outlet_count_x);
+	if (outlet_count_y > 0) printf("Checkerboard pattern at y outlet for %i layers \n",outlet_count_y);
+	if (outlet_count_z > 0) printf("Checkerboard pattern at z outlet for %i layers \n",outlet_count_z);
 
-	if (outlet_count_z > 0){
-		printf("Checkerboard pattern at z outlet for %i layers \n",outlet_count_z);
-		// use checkerboard pattern
-		for (int k = zStart + nz*nprocz - outlet_count_z; k < zStart + nz*nprocz; k++){
-			for (int j = 0; j<Ny; j++){
-				for (int i = 0; i<Nx; i++){
-					if ( (i/checkerSize+j/checkerSize)%2 == 0){
-						// void checkers
-						SegData[k*Nx*Ny+j*Nx+i] = 2;
-					}
-					else{
-						// solid checkers
-						SegData[k*Nx*Ny+j*Nx+i] = 0;
-					}
-				}
+	// relabel one plane of the global image and apply the inlet / outlet checkerboards
+	// (void checkers are 2, solid checkers are 0)
+	auto Checker = [checkerSize]( int64_t a, int64_t b ){
+		return char( ((a/checkerSize + b/checkerSize)%2 == 0) ? 2 : 0 );
+	};
+	auto ProcessPlane = [&]( char *plane, int64_t z, bool count ){
+		for (int64_t j=0; j<Ny; j++){
+			for (int64_t i=0; i<Nx; i++){
+				unsigned char locval = plane[j*Nx+i];
+				if (count && LabelIndex[locval] >= 0) LabelCount[LabelIndex[locval]]++;
+				char value = NewValue[locval];
+				if (i >= xStart && i < xStart+inlet_count_x) value = Checker(j,z);
+				if (j >= yStart && j < yStart+inlet_count_y) value = Checker(i,z);
+				if (z >= zStart && z < zStart+inlet_count_z) value = Checker(i,j);
+				if (i >= xStart+nx*nprocx-outlet_count_x && i < xStart+nx*nprocx) value = Checker(j,z);
+				if (j >= yStart+ny*nprocy-outlet_count_y && j < yStart+ny*nprocy) value = Checker(i,z);
+				if (z >= zStart+nz*nprocz-outlet_count_z && z < zStart+nz*nprocz) value = Checker(i,j);
+				plane[j*Nx+i] = value;
 			}
 		}
-	}
+	};
 
 	// number of sites to use for periodic boundary condition transition zone
 	int64_t z_transition_size = (nprocz*nz - (Nz - zStart))/2;
 	if (z_transition_size < 0) z_transition_size=0;
 
-	char LocalRankFilename[40];
-	char *loc_id;
-	loc_id = new char [(nx+2)*(ny+2)*(nz+2)];
+	// global plane that holds local plane k of the subdomains in process layer kp
+	auto GlobalZ = [&]( int kp, int64_t k ){
+		int64_t z = zStart + kp*nz + k-1 - z_transition_size;
+		if (z<zStart) 	z=zStart;
+		if (!(z<Nz))	z=Nz-1;
+		return z;
+	};
+
+	printf("Dimensions of segmented image: %ld x %ld x %ld \n",Nx,Ny,Nz);
+	FILE *SEGDAT = fopen(Filename.c_str(),"rb");
+	if (SEGDAT==NULL) ERROR("Error reading segmented data");
+	int bytes = 1;
+	if (ReadType == "16bit"){
+		printf("Reading 16-bit input data \n");
+		bytes = 2;
+	}
+	else {
+		printf("Reading 8-bit input data \n");
+	}
+	std::vector<short int> InputData( bytes == 2 ? Nx*Ny : 0 );
+	auto ReadPlanes = [&]( int64_t z0, int64_t count, char *data ){
+		fseek(SEGDAT,z0*Nx*Ny*bytes,SEEK_SET);
+		size_t ReadSeg = 0;
+		if (bytes == 1){
+			ReadSeg = fread(data,1,count*Nx*Ny,SEGDAT);
+		}
+		else {
+			for (int64_t p=0; p<count; p++){
+				ReadSeg += fread(InputData.data(),2,Nx*Ny,SEGDAT);
+				for (int64_t n=0; n<Nx*Ny; n++)
+					data[p*Nx*Ny+n] = char(InputData[n]);
+			}
+		}
+		if (ReadSeg != size_t(count*Nx*Ny)) printf("lbpm_serial_decomp: Error reading segmented data (rank=%i)\n",rank);
+	};
 
 	// Set up the sub-domains
-	if (rank==0){
-		printf("Distributing subdomains across %i processors \n",nprocs);
-		printf("Process grid: %i x %i x %i \n",nprocx,nprocy,nprocz);
-		printf("Subdomain size: %i x %i x %i \n",nx,ny,nz);
-		printf("Size of transition region: %ld \n", z_transition_size);
+	printf("Distributing subdomains across %i processors \n",nprocs);
+	printf("Process grid: %i x %i x %i \n",nprocx,nprocy,nprocz);
+	printf("Subdomain size: %i x %i x %i \n",nx,ny,nz);
+	printf("Size of transition region: %ld \n", z_transition_size);
+	printf("Streaming %i planes at a time with %i threads \n",slab_size,Utilities::getNumThreads());
+
+	std::vector<char> SegData;
+	int64_t last_counted = zStart-1;
+	for (int kp=0; kp<nprocz; kp++){
+		for (int64_t k0=0; k0<nz+2; k0+=slab_size){
+			int64_t k1 = std::min<int64_t>( nz+2, k0+slab_size );
+			// read, relabel and pad the global planes needed by this slab
+			int64_t z0 = GlobalZ(kp,k0);
+			int64_t z1 = GlobalZ(kp,k1-1);
+			SegData.resize( (z1-z0+1)*Nx*Ny );
+			ReadPlanes( z0, z1-z0+1, SegData.data() );
+			for (int64_t z=z0; z<=z1; z++)
+				ProcessPlane( &SegData[(z-z0)*Nx*Ny], z, z > last_counted );
+			last_counted = std::max( last_counted, z1 );
 
-		for (int kp=0; kp<nprocz; kp++){
-			for (int jp=0; jp<nprocy; jp++){
-				for (int ip=0; ip<nprocx; ip++){
-					// rank of the process that gets this subdomain
-					int rnk = kp*nprocx*nprocy + jp*nprocx + ip;
-					// Pack and send the subdomain for rnk
-					for (k=0;k<nz+2;k++){
-						for (j=0;j<ny+2;j++){
-							for (i=0;i<nx+2;i++){
-								int64_t x = xStart + ip*nx + i-1;
-								int64_t y = yStart + jp*ny + j-1;
-								// int64_t z = zStart + kp*nz + k-1;
-								int64_t z = zStart + kp*nz + k-1 - z_transition_size;
-								if (x<xStart) 	x=xStart;
-								if (!(x<Nx))	x=Nx-1;
-								if (y<yStart) 	y=yStart;
-								if (!(y<Ny))	y=Ny-1;
-								if (z<zStart) 	z=zStart;
-								if (!(z<Nz))	z=Nz-1;
-								int64_t nlocal = k*(nx+2)*(ny+2) + j*(nx+2) + i;
-								int64_t nglobal = z*Nx*Ny+y*Nx+x;
-								loc_id[nlocal] = SegData[nglobal];
-							}
+			// write the slab of each subdomain in this process layer (the files that
+			// could not be written are reported after all the threads are done)
+			std::vector<char> failed( nprocx*nprocy, 0 );
+			Utilities::parallelFor( nprocx*nprocy, [&]( int r ){
+				std::vector<char> loc_id( (nx+2)*(ny+2)*(k1-k0) );
+				char LocalRankFilename[40];
+				int ip = r%nprocx;
+				int jp = r/nprocx;
+				// rank of the process that gets this subdomain
+				int rnk = kp*nprocx*nprocy + jp*nprocx + ip;
+				for (int64_t k=k0; k<k1; k++){
+					int64_t z = GlobalZ(kp,k);
+					for (int64_t j=0; j<ny+2; j++){
+						for (int64_t i=0; i<nx+2; i++){
+							int64_t x = xStart + ip*nx + i-1;
+							int64_t y = yStart + jp*ny + j-1;
+							if (x<xStart) 	x=xStart;
+							if (!(x<Nx))	x=Nx-1;
+							if (y<yStart) 	y=yStart;
+							if (!(y<Ny))	y=Ny-1;
+							int64_t nlocal = (k-k0)*(nx+2)*(ny+2) + j*(nx+2) + i;
+							int64_t nglobal = (z-z0)*Nx*Ny+y*Nx+x;
+							loc_id[nlocal] = SegData[nglobal];
 						}
 					}
-
-					// Write the data for this rank data 
-					sprintf(LocalRankFilename,"ID.%05i",rnk+rank_offset);
-					FILE *ID = fopen(LocalRankFilename,"wb");
-					fwrite(loc_id,1,(nx+2)*(ny+2)*(nz+2),ID);
-					fclose(ID);
+				}
+				// Write (append) the data for this rank
+				sprintf(LocalRankFilename,"ID.%05i",rnk+rank_offset);
+				FILE *ID = fopen(LocalRankFilename, k0==0 ? "wb" : "ab");
+				if (ID==NULL || fwrite(loc_id.data(),1,loc_id.size(),ID) != loc_id.size()) failed[r] = 1;
+				if (ID!=NULL) fclose(ID);
+			});
+			for (int r=0; r<nprocx*nprocy; r++){
+				if (failed[r]){
+					char LocalRankFilename[40];
+					sprintf(LocalRankFilename,"ID.%05i",kp*nprocx*nprocy+r+rank_offset);
+					ERROR(std::string("lbpm_serial_decomp: Error writing subdomain file ")+LocalRankFilename);
 				}
 			}
 		}
 	}
+	// planes of the image that are not part of any subdomain only contribute to the label counts
+	SegData.resize( Nx*Ny );
+	for (int64_t z=0; z<Nz; z++){
+		if (z >= GlobalZ(0,0) && z <= last_counted) continue;
+		ReadPlanes( z, 1, SegData.data() );
+		for (int64_t n=0; n<Nx*Ny; n++){
+			unsigned char locval = SegData[n];
+			if (LabelIndex[locval] >= 0) LabelCount[LabelIndex[locval]]++;
+		}
+	}
+	fclose(SEGDAT);
+	printf("Read segmented data from %s \n",Filename.c_str());
+
+	for (size_t idx=0; idx<ReadValues.size(); idx++){
+		long int label=ReadValues[idx];
+		long int count=LabelCount[idx];
+		printf("Label=%ld, Count=%ld \n",label,count);
+	}
 }
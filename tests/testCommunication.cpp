@@ -6,6 +6,7 @@
 #include <fstream>
 
 #include "common/Communication.h"
+#include "common/Domain.h"
 #include "common/MPI.h"
 #include "common/Array.h"
 
@@ -248,6 +249,130 @@ int testHalo( const Utilities::MPI& comm, int nprocx, int nprocy, int nprocz, in
 }
 
 
+// Fill the interior of a local array with its global index (modulo a maximum value)
+template<class TYPE>
+void fillGlobalIndex( Array<TYPE>& array, const RankInfoStruct& rank_info, int nx, int ny, int nz, int max )
+{
+    int Nx = nx*rank_info.nx;
+    int Ny = ny*rank_info.ny;
+    int Nz = nz*rank_info.nz;
+    array.fill(-1);
+    for (size_t d=0; d<array.size(3); d++) {
+        for (int k=0; k<nz; k++) {
+            for (int j=0; j<ny; j++) {
+                for (int i=0; i<nx; i++) {
+                    int iglobal = i + rank_info.ix*nx;
+                    int jglobal = j + rank_info.jy*ny;
+                    int kglobal = k + rank_info.kz*nz;
+                    int ijk = iglobal + jglobal*Nx + kglobal*Nx*Ny + d*Nx*Ny*Nz;
+                    array(i+1,j+1,k+1,d) = ijk % max;
+                }
+            }
+        }
+    }
+}
+
+// Check the (periodic) global index of the local array including the halo
+template<class TYPE>
+bool checkGlobalIndex( const Array<TYPE>& array, const RankInfoStruct& rank_info, int nx, int ny, int nz, int max,
+    bool corners = true )
+{
+    int Nx = nx*rank_info.nx;
+    int Ny = ny*rank_info.ny;
+    int Nz = nz*rank_info.nz;
+    bool pass = true;
+    for (size_t d=0; d<array.size(3); d++) {
+        for (int k=-1; k<nz+1; k++) {
+            for (int j=-1; j<ny+1; j++) {
+                for (int i=-1; i<nx+1; i++) {
+                    bool corner = (i==-1||i==nx) && (j==-1||j==ny) && (k==-1||k==nz);
+                    if ( corner && !corners )
+                        continue;
+                    int iglobal = (i + rank_info.ix*nx + Nx)%Nx;
+                    int jglobal = (j + rank_info.jy*ny + Ny)%Ny;
+                    int kglobal = (k + rank_info.kz*nz + Nz)%Nz;
+                    int ijk = iglobal + jglobal*Nx + kglobal*Nx*Ny + d*Nx*Ny*Nz;
+                    if ( array(i+1,j+1,k+1,d) != (TYPE) ( ijk % max ) )
+                        pass = false;
+                }
+            }
+        }
+    }
+    return pass;
+}
+
+
+// Fill the halos of arrays with different types and depths in one exchange
+int testMultiHalo( const Utilities::MPI& comm, int nprocx, int nprocy, int nprocz, int threads )
+{
+    int rank = comm.getRank();
+    if ( rank==0 )
+        printf("\nRunning multi-array halo test %i %i %i (%i threads)\n",nprocx,nprocy,nprocz,threads);
+    const RankInfoStruct rank_info(rank,nprocx,nprocy,nprocz);
+    int nx = 10;
+    int ny = 11;
+    int nz = 7;
+    Array<char> array1(nx+2,ny+2,nz+2);
+    Array<double> array2(std::vector<size_t>({(size_t)nx+2,(size_t)ny+2,(size_t)nz+2,3}));
+    Array<int> array3(nx+2,ny+2,nz+2);
+    fillGlobalIndex( array1, rank_info, nx, ny, nz, 127 );
+    fillGlobalIndex( array2, rank_info, nx, ny, nz, 1<<30 );
+    fillGlobalIndex( array3, rank_info, nx, ny, nz, 1<<30 );
+    Utilities::setNumThreads( threads );
+    fillHalo<double> fillData(comm,rank_info,{nx,ny,nz},{1,1,1},0,1);
+    fillData.fill( array1, array2, array3 );
+    Utilities::setNumThreads( 1 );
+    bool pass = checkGlobalIndex( array1, rank_info, nx, ny, nz, 127 ) &&
+        checkGlobalIndex( array2, rank_info, nx, ny, nz, 1<<30 ) &&
+        checkGlobalIndex( array3, rank_info, nx, ny, nz, 1<<30 );
+    int N_errors = 0;
+    if ( !pass ) {
+        std::cout << "Failed multi-array halo test\n";
+        N_errors++;
+    }
+    return N_errors;
+}
+
+
+// Fill the halos of several arrays with Domain::CommunicateMeshHalo (the corners are not communicated)
+int testMeshHalo( const Utilities::MPI& comm, int nprocx, int nprocy, int nprocz, int threads )
+{
+    int rank = comm.getRank();
+    if ( rank==0 )
+        printf("\nRunning mesh halo test %i %i %i (%i threads)\n",nprocx,nprocy,nprocz,threads);
+    int nx = 10;
+    int ny = 11;
+    int nz = 7;
+    auto db = std::make_shared<Database>();
+    db->putScalar<int>( "BC", 0 );
+    db->putVector<int>( "nproc", { nprocx, nprocy, nprocz } );
+    db->putVector<int>( "n", { nx, ny, nz } );
+    db->putScalar<int>( "nspheres", 0 );
+    db->putVector<double>( "L", { 1, 1, 1 } );
+    Domain Dm( db, comm );
+    for (size_t n=0; n<Dm.id.size(); n++)
+        Dm.id[n] = 1;
+    Dm.CommInit();
+    DoubleArray A(nx+2,ny+2,nz+2), B(nx+2,ny+2,nz+2), C(nx+2,ny+2,nz+2);
+    fillGlobalIndex( A, Dm.rank_info, nx, ny, nz, 1<<30 );
+    fillGlobalIndex( B, Dm.rank_info, nx, ny, nz, 1<<30 );
+    fillGlobalIndex( C, Dm.rank_info, nx, ny, nz, 1<<30 );
+    Utilities::setNumThreads( threads );
+    Dm.CommunicateMeshHalo( A, B );
+    Dm.CommunicateMeshHalo( C );
+    Utilities::setNumThreads( 1 );
+    bool pass = checkGlobalIndex( A, Dm.rank_info, nx, ny, nz, 1<<30, false ) &&
+        checkGlobalIndex( B, Dm.rank_info, nx, ny, nz, 1<<30, false ) &&
+        checkGlobalIndex( C, Dm.rank_info, nx, ny, nz, 1<<30, false );
+    int N_errors = 0;
+    if ( !pass ) {
+        std::cout << "Failed mesh halo test\n";
+        N_errors++;
+    }
+    return N_errors;
+}
+
+
 int main(int argc, char **argv)
 {
     // Initialize MPI
@@ -283,6 +408,16 @@ int main(int argc, char **argv)
         N_errors += testHalo<int>( comm, 2, 2, 2, 1 );
     }
 
+    // Exchange several arrays at once
+    N_errors += testMultiHalo( comm, nprocs, 1, 1, 1 );
+    N_errors += testMultiHalo( comm, 1, 1, nprocs, 4 );
+    N_errors += testMeshHalo( comm, nprocs, 1, 1, 1 );
+    N_errors += testMeshHalo( comm, 1, nprocs, 1, 4 );
+    if ( nprocs==4 ) {
+        N_errors += testMultiHalo( comm, 2, 2, 1, 4 );
+        N_errors += testMeshHalo( comm, 2, 1, 2, 4 );
+    }
+
     // Finished
     comm.barrier();
     int N_errors_global = comm.sumReduce( N_errors );